@@ -154,7 +154,7 @@ workspace ("ouroveon_" .. _ACTION)
             "OURO_PLATFORM_LINUX=1",
 
             "OURO_HAS_ISPC=0",
-            "OURO_HAS_CLAP=0",
+            "OURO_HAS_CLAP=1",
             "OURO_HAS_NDLS_ONLINE=0",
         }
         buildoptions
@@ -623,3 +623,66 @@ project "PONY"
 
 
 group ""
+
+
+-- ==============================================================================
+
+
+group "r5-tools"
+
+-- ------------------------------------------------------------------------------
+-- headless benchmark runner for the stem, mixer and warehouse hot paths; generates all of its own data
+-- from fixed seeds and writes results as JSON, eg. `bench results.json`
+project "BENCH"
+
+    kind "ConsoleApp"
+    SetupOuroveonLayer( true, "bench" )
+    CommonAppLink()
+
+    files
+    {
+        SrcDir() .. "r5.bench/pch.cpp",
+
+        SrcDir() .. "r5.bench/**.cpp",
+        SrcDir() .. "r5.bench/**.h",
+        SrcDir() .. "r5.bench/**.inl",
+    }
+
+    AddPCH(
+        "../src/r5.bench/pch.cpp",
+        SrcDir() .. "r2.ouro/",
+        "pch.h" )
+
+
+group ""
+
+
+-- ==============================================================================
+
+
+group "r5-plugins"
+
+-- ------------------------------------------------------------------------------
+-- trivial gain / lowpass CLAP effect, built alongside the apps to exercise the CLAP host;
+-- point CLAP_PATH at the output directory to have it picked up by the plugin stash
+project "OUROGAIN"
+
+    kind "SharedLib"
+    language "C++"
+    cppdialect "C++20"
+
+    SetDefaultBuildConfiguration()
+    SetDefaultOutputDirectories( "ourogain" )
+
+    targetdir ( GetBuildRootToken() .. "../../bin/clap/%{cfg.system}_%{cfg.shortname}" )
+    targetprefix ""
+    targetextension ".clap"
+
+    ModuleRefInclude["clap"]()
+
+    files
+    {
+        SrcDir() .. "r5.ourogain/**.cpp",
+    }
+
+group ""
@@ -10,6 +10,7 @@
 #include "pch.h"
 
 #include "base/instrumentation.h"
+#include "base/memory.h"
 #include "base/operations.h"
 
 #include "data/uuid.h"
@@ -186,6 +187,7 @@ Core::Core()
     , m_networkConfiguration( std::make_shared<endlesss::api::NetConfiguration>() )
     , m_taskExecutor(        std::clamp( std::thread::hardware_concurrency(), 2U, OURO_THREAD_LIMIT ), std::make_shared<TaskFlowWorkerHook>("app")  )
     , m_taskExecutorPlugins( std::clamp( std::thread::hardware_concurrency(), 1U, 3U ),                std::make_shared<TaskFlowWorkerHook>("plug") )
+    , m_workScheduler(       std::clamp( std::thread::hardware_concurrency(), 4U, 8U ),                std::make_shared<TaskFlowWorkerHook>("io") )
 {
 }
 
@@ -256,7 +258,7 @@ int Core::Run()
 
     // configure app event bus
     {
-        m_appEventBus       = std::make_shared<base::EventBus>();
+        m_appEventBus       = std::make_shared<base::EventBus>( m_taskExecutor );
         m_appEventBusClient = base::EventBusClient( m_appEventBus );
 
         // register basic event IDs
@@ -493,6 +495,9 @@ int Core::Run()
             blog::error::core( FMTX( "app::module::Midi unable to start : {}" ), midiStatus.ToString() );
             return -2;
         }
+
+        // feed timestamped MIDI through to the mix thread alongside the usual main-thread queue
+        m_mdMidi->attachMixThreadFeed( &m_mdAudio->getMidiFeed() );
     }
 
     // plug in stem data event processor
@@ -519,6 +524,7 @@ int Core::Run()
     }
 
     // unwind started services
+    m_mdMidi->attachMixThreadFeed( nullptr );
     m_mdMidi->destroy();
     m_mdAudio->destroy();
 
@@ -677,6 +683,13 @@ void Core::tickActivityUpdate()
 
         m_avgNetRollingPerSecTimer = 1.0f;
     }
+
+    m_memoryReportTimer -= deltaTime;
+    if ( m_memoryReportTimer <= 0.0f )
+    {
+        mem::logSnapshot( mem::takeSnapshot() );
+        m_memoryReportTimer = cMemoryReportPeriodSec;
+    }
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -962,14 +975,29 @@ int CoreGUI::Entrypoint()
 
 
     addDeveloperMenuFlag( "Performance Tracing", &m_showPerformanceWindow );
+    addDeveloperMenuFlag( "Memory Usage", &m_showMemoryWindow );
 #if OURO_DEBUG
     addDeveloperMenuFlag( "ImGui Demo", &m_showImGuiDebugWindow );
 #endif // OURO_DEBUG
 
 
+    // let event traffic and mix thread state changes wake the main loop when it is sleeping between frames
+    if ( m_mdFrontEnd->isLowPowerIdleEnabled() )
+    {
+        blog::core( FMTX( "low-power frame loop enabled; idle redraw every {}ms, animation capped at {} fps" ),
+            m_configFrontend.idleRedrawIntervalMs,
+            m_configFrontend.animationFrameRate );
+
+        m_appEventBus->setMainThreadWake( &app::module::Frontend::wakeFrameLoop );
+        m_mdAudio->setStateChangeWake( m_appEventBus.get() );
+    }
+
     // run the app main loop
     int appResult = EntrypointGUI();
 
+    m_appEventBus->setMainThreadWake( nullptr );
+    m_mdAudio->setStateChangeWake( nullptr );
+
     {
         base::EventBusClient m_eventBusClient( m_appEventBus );
         APP_EVENT_UNBIND( AddToastNotification );
@@ -991,9 +1019,46 @@ void CoreGUI::activateModalPopup( const std::string_view& label, ModalPopupExecu
     m_modalsActive.emplace_back( label, std::move( executor ) );
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void CoreGUI::waitForNextFrame()
+{
+    if ( !m_mdFrontEnd->isLowPowerIdleEnabled() )
+        return;
+
+    while ( !m_mdFrontEnd->waitForNextFrame() )
+    {
+        // woken early by event traffic; it only needs a frame if something was listening for it
+        if ( dispatchMainThreadEvents() )
+            break;
+
+        const uint32_t audioStateRevision = m_mdAudio->getStateRevision();
+        if ( audioStateRevision != m_audioStateRevision )
+        {
+            m_audioStateRevision = audioStateRevision;
+            break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool CoreGUI::dispatchMainThreadEvents()
+{
+    return m_appEventBus->mainThreadDispatch() > 0;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool CoreGUI::beginInterfaceLayout( const ViewportFlags viewportFlags )
 {
+    waitForNextFrame();
+
+    // flush the main thread event bus ahead of layout, so the UI reflects everything that has arrived
+    {
+        spacetime::Moment eventBusTiming;
+        std::ignore = dispatchMainThreadEvents();
+        m_perfData.m_uiEventBus = eventBusTiming.delta< std::chrono::milliseconds >();
+    }
+    m_audioStateRevision = m_mdAudio->getStateRevision();
+
     // begin tracking perf cost of the imgui 'build' stage
     m_perfData.m_moment.setToNow();
 
@@ -1150,6 +1215,8 @@ bool CoreGUI::beginInterfaceLayout( const ViewportFlags viewportFlags )
     {
         if ( m_showPerformanceWindow )
             ImGuiPerformanceTracker();
+        if ( m_showMemoryWindow )
+            ImGuiMemoryTracker();
 
         m_mdAudio->imgui( *this );
     }
@@ -1229,14 +1296,17 @@ void CoreGUI::finishInterfaceLayoutAndRender()
     m_perfData.m_uiPreRender = m_perfData.m_moment.delta< std::chrono::milliseconds >();
     m_perfData.m_moment.setToNow();
 
-    // flush the main thread event bus #HDD move to Core:: main tick 
-    m_appEventBus->mainThreadDispatch();
-
-    // update networking averages #HDD move to Core:: main tick 
+    // update networking averages
     tickActivityUpdate();
 
-    m_perfData.m_uiEventBus = m_perfData.m_moment.delta< std::chrono::milliseconds >();
-    m_perfData.m_moment.setToNow();
+    // keep frames coming in low-power mode while anything on screen is still moving
+    if ( !m_toasts.empty() ||
+         m_asyncTaskActivityIntensity > 0.0f ||
+         m_avgNetActivityLag > 0.0 ||
+         m_mdAudio->isOutputAudible() )
+    {
+        m_mdFrontEnd->requestAnimationFrame();
+    }
 
     m_mdFrontEnd->appRenderBegin();
 
@@ -1391,6 +1461,81 @@ void CoreGUI::ImGuiPerformanceTracker()
 
             ImGui::EndTable();
         }
+
+        // per-event-type counters from the bus
+        if ( ImGui::TreeNode( "Event Bus Counters" ) )
+        {
+            static std::vector< base::EventStatistics > eventStats;
+            m_appEventBus->getStatistics( eventStats );
+
+            if ( ImGui::BeginTable( "##perf_stats_events", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg ) )
+            {
+                ImGui::PushStyleColor( ImGuiCol_Text, ImGui::GetStyleColorVec4( ImGuiCol_ResizeGripHovered ) );
+                ImGui::TableSetupColumn( "Event", ImGuiTableColumnFlags_WidthFixed, column0size );
+                ImGui::TableSetupColumn( "Sent" );
+                ImGui::TableSetupColumn( "Delivered" );
+                ImGui::TableSetupColumn( "Dropped" );
+                ImGui::TableSetupColumn( "Peak" );
+                ImGui::TableSetupColumn( "Dispatch" );
+                ImGui::TableHeadersRow();
+                ImGui::PopStyleColor();
+
+                for ( const auto& stats : eventStats )
+                {
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted( stats.m_name );
+                    ImGui::TableNextColumn(); ImGui::Text( "%" PRIu64, stats.m_sent );
+                    ImGui::TableNextColumn(); ImGui::Text( "%" PRIu64, stats.m_delivered );
+                    ImGui::TableNextColumn(); ImGui::Text( "%" PRIu64, stats.m_dropped );
+                    ImGui::TableNextColumn(); ImGui::Text( "%u / %u", stats.m_highWater, stats.m_capacity );
+                    ImGui::TableNextColumn(); ImGui::Text( "%" PRIu64 " ms", stats.m_dispatchUs / 1000 );
+                }
+
+                ImGui::EndTable();
+            }
+            ImGui::TreePop();
+        }
+    }
+    ImGui::End();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void CoreGUI::ImGuiMemoryTracker()
+{
+    if ( ImGui::Begin( ICON_FA_MEMORY " Memory Usage###coregui_memory", &m_showMemoryWindow ) )
+    {
+        const mem::Snapshot snapshot = mem::takeSnapshot();
+
+        if ( ImGui::BeginTable( "##memory_tags", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg ) )
+        {
+            ImGui::PushStyleColor( ImGuiCol_Text, ImGui::GetStyleColorVec4( ImGuiCol_ResizeGripHovered ) );
+            ImGui::TableSetupColumn( "Tag", ImGuiTableColumnFlags_WidthFixed, 90.0f );
+            ImGui::TableSetupColumn( "Live" );
+            ImGui::TableSetupColumn( "Peak" );
+            ImGui::TableSetupColumn( "Allocs" );
+            ImGui::TableSetupColumn( "Total" );
+            ImGui::TableHeadersRow();
+            ImGui::PopStyleColor();
+
+            for ( std::size_t tagI = 0; tagI < mem::cTagCount; tagI++ )
+            {
+                const mem::TagSnapshot& tagSnapshot = snapshot.m_tags[tagI];
+
+                ImGui::TableNextColumn(); ImGui::TextUnformatted( mem::cTagNames[tagI] );
+                ImGui::TableNextColumn(); ImGui::TextUnformatted( base::humaniseByteSize( "", (uint64_t)std::max< int64_t >( tagSnapshot.m_bytes, 0 ) ).c_str() );
+                ImGui::TableNextColumn(); ImGui::TextUnformatted( base::humaniseByteSize( "", (uint64_t)std::max< int64_t >( tagSnapshot.m_bytesPeak, 0 ) ).c_str() );
+                ImGui::TableNextColumn(); ImGui::Text( "%" PRIi64, tagSnapshot.m_allocations );
+                ImGui::TableNextColumn(); ImGui::Text( "%" PRIu64, tagSnapshot.m_allocationsTotal );
+            }
+
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( "Total" );
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( base::humaniseByteSize( "", (uint64_t)std::max< int64_t >( snapshot.totalBytes(), 0 ) ).c_str() );
+            ImGui::TableNextRow();
+
+            ImGui::EndTable();
+        }
+
+        if ( ImGui::Button( "Write To Log" ) )
+            mem::logSnapshot( snapshot );
     }
     ImGui::End();
 }
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "base/eventbus.h"
+#include "base/scheduler.h"
 #include "colour/preset.h"
 #include "font/icons.Fira.h"
 
@@ -104,6 +105,7 @@ struct ICoreServices : public config::IPathProvider
     ouro_nodiscard virtual const endlesss::toolkit::PopulationQuery&    getEndlesssPopulation() const = 0;
     ouro_nodiscard virtual tf::Executor&                                getTaskExecutor() = 0;
     ouro_nodiscard virtual tf::Executor&                                getTaskExecutorPlugins() = 0;
+    ouro_nodiscard virtual base::WorkScheduler&                         getWorkScheduler() = 0;
     ouro_nodiscard virtual sol::state_view&                             getLuaState() = 0;
     ouro_nodiscard virtual base::EventBusClient                         getEventBusClient() const = 0;
 };
@@ -213,6 +215,7 @@ protected:
     // multithreading bro ever heard of it
     tf::Executor                            m_taskExecutor;                 // task dispatcher for the app
     tf::Executor                            m_taskExecutorPlugins;          // task dispatcher used for plugins, both discovery and giving to CLAP thread pooling
+    base::WorkScheduler                     m_workScheduler;                // background I/O - riff loads, prefetch, sync, export - in prioritised lanes
 
     // application-wide lua state wrapper
     sol::state                              m_lua;
@@ -289,6 +292,10 @@ protected:
         m_asyncTaskActivityIntensity = 1.0f;
     }
 
+    // per-subsystem memory totals are written to the log every so often, so long sessions leave a trail to diff
+    static constexpr float                  cMemoryReportPeriodSec = 10.0f * 60.0f;
+    float                                   m_memoryReportTimer = cMemoryReportPeriodSec;
+
     template< typename TArrayType >
     std::string pulseSlotsToString( const std::string_view prefix, const TArrayType& arrayInput )
     {
@@ -341,6 +348,7 @@ public:
     ouro_nodiscard const endlesss::toolkit::PopulationQuery&    getEndlesssPopulation() const override  { return m_endlesssPopulation;}
     ouro_nodiscard tf::Executor&                                getTaskExecutor() override              { return m_taskExecutor; }
     ouro_nodiscard tf::Executor&                                getTaskExecutorPlugins() override       { return m_taskExecutorPlugins; }
+    ouro_nodiscard base::WorkScheduler&                         getWorkScheduler() override             { return m_workScheduler; }
     ouro_nodiscard sol::state_view&                             getLuaState() override                  { return m_lua; }
     ouro_nodiscard base::EventBusClient                         getEventBusClient() const override
     {
@@ -386,6 +394,9 @@ struct CoreGUI : Core,
     // ImGui panel displaying gathered performance metrics in a table
     void ImGuiPerformanceTracker();
 
+    // ImGui panel showing live / peak memory use per mem::Tag
+    void ImGuiMemoryTracker();
+
 
     enum class StatusBarAlignment
     {
@@ -480,6 +491,12 @@ protected:
     bool beginInterfaceLayout( const ViewportFlags viewportFlags );
     void finishInterfaceLayoutAndRender();
 
+    // in low-power mode, sleep until the next frame is due; main thread events are dispatched as they arrive
+    void waitForNextFrame();
+
+    // pump the main thread event bus, returning true if any listeners were called
+    bool dispatchMainThreadEvents();
+
     ouro_nodiscard constexpr bool hasViewportFlag( const ViewportFlags viewportFlags, ViewportFlags vFlag )
     {
         return ( viewportFlags & vFlag ) == vFlag;
@@ -517,6 +534,7 @@ protected:
         std::chrono::milliseconds   m_uiPostRender;
     }                       m_perfData;
     AudioLoadAverage        m_audoLoadAverage;
+    uint32_t                m_audioStateRevision = 0;     // last seen Audio::getStateRevision(), to wake on changes
 
 
     UIInjectionHandle       m_injectionHandleCounter = 0;
@@ -641,6 +659,7 @@ private:
     bool                    m_showImGuiDebugWindow      = false;
 #endif // OURO_DEBUG
     bool                    m_showPerformanceWindow     = false;
+    bool                    m_showMemoryWindow          = false;
     bool                    m_showCommandPaletteWindow  = false;
     bool                    m_resetLayoutInNextUpdate   = false;
 };
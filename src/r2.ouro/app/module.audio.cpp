@@ -364,6 +364,14 @@ absl::Status Audio::initOutput( const config::Audio& outputDevice, const config:
 
     m_mixerBuffers = new OutputBuffer( m_outMaxBufferSize );
 
+#if OURO_HAS_CLAP
+    // effect chains for each output bus, ready before the stream starts calling us
+    for ( std::size_t chainIndex = 0; chainIndex < ClapChainCount; chainIndex++ )
+        m_clapChains[chainIndex] = std::make_unique< plug::CLAPChain >( cClapChainNames[chainIndex], m_outMaxBufferSize );
+
+    memset( &m_clapProcessTransport, 0, sizeof( m_clapProcessTransport ) );
+    m_clapSteadyTime = 0;
+#endif // OURO_HAS_CLAP
 
     err = Pa_StartStream( m_paStream );
     if ( err != paNoError )
@@ -376,19 +384,6 @@ absl::Status Audio::initOutput( const config::Audio& outputDevice, const config:
     // stash the output latency reported as milliseconds, used by Ableton Link compensation
     m_outLatencyMs = ( std::chrono::microseconds( llround( outputParameters.suggestedLatency * 1.0e6 ) ) );
 
-#if OURO_HAS_CLAP
-    // setup & bind clap processing structures
-    {
-        memset( &m_clapProcess, 0, sizeof( m_clapProcess ) );
-        memset( &m_clapProcessTransport, 0, sizeof( m_clapProcessTransport ) );
-
-        m_clapProcess.transport     = &m_clapProcessTransport;
-
-        m_clapProcess.in_events     = m_clapProcessEventsIn.clapInputEvents();
-        m_clapProcess.out_events    = m_clapProcessEventsOut.clapOutputEvents();
-    }
-#endif // OURO_HAS_CLAP
-
     return absl::OkStatus();
 }
 
@@ -402,6 +397,20 @@ void Audio::termOutput()
         m_paStream = nullptr;
     }
 
+#if OURO_HAS_CLAP
+    // the stream is stopped so nothing can be processing the chains; take all the effects offline directly
+    for ( auto& clapEffect : m_clapEffects )
+    {
+        clapEffect->m_slot->m_online = nullptr;
+        if ( clapEffect->m_online )
+            clapEffect->m_runtime = plug::online::CLAP::deactivate( clapEffect->m_online );
+    }
+    m_clapEffects.clear();
+
+    for ( auto& clapChain : m_clapChains )
+        clapChain.reset();
+#endif // OURO_HAS_CLAP
+
     if ( m_mixerBuffers != nullptr )
     {
         delete m_mixerBuffers;
@@ -473,6 +482,8 @@ int Audio::PortAudioCallback(
 // ---------------------------------------------------------------------------------------------------------------------
 void Audio::ProcessMixCommandsOnMixThread()
 {
+    uint32_t commandsApplied = 0;
+
     MixThreadCommandData mixCmdData;
     while ( m_mixThreadCommandQueue.try_dequeue( mixCmdData ) )
     {
@@ -541,25 +552,60 @@ void Audio::ProcessMixCommandsOnMixThread()
                     m_sampleProcessorsInstalled.erase( new_end, m_sampleProcessorsInstalled.end() );
                 }
                 break;
+            case MixThreadCommand::ClapChainAppend:
+#if OURO_HAS_CLAP
+                {
+                    CLAPEffect* clapEffect = mixCmdData.getPtrAs<CLAPEffect>();
+                    if ( !m_clapChains[clapEffect->m_chainIndex]->append( clapEffect->m_slot.get() ) )
+                        blog::error::mix( "CLAP chain [{}] is full", cClapChainNames[clapEffect->m_chainIndex] );
+                }
+#endif // OURO_HAS_CLAP
+                break;
+            case MixThreadCommand::ClapChainRemove:
+#if OURO_HAS_CLAP
+                {
+                    CLAPEffect* clapEffect = mixCmdData.getPtrAs<CLAPEffect>();
+                    if ( !m_clapChains[clapEffect->m_chainIndex]->remove( clapEffect->m_slot.get() ) )
+                        blog::error::mix( "CLAP effect [{}] not found in chain", clapEffect->m_displayName );
+                }
+#endif // OURO_HAS_CLAP
+                break;
+            case MixThreadCommand::Synchronise:
+                // nothing to do; completing this tells the caller that any block in flight when it was issued has finished
+                break;
         }
 
         m_mixThreadCommandsComplete++;
+        commandsApplied++;
+    }
+
+    // the state revision moved; nudge a UI loop that may be sleeping between frames, once per batch
+    if ( commandsApplied > 0 )
+    {
+        if ( base::EventBus* eventBus = m_stateChangeWake.load( std::memory_order_acquire ) )
+            eventBus->requestMainThreadWake();
     }
 }
 
 #if OURO_HAS_CLAP
 
 // ---------------------------------------------------------------------------------------------------------------------
-void Audio::ProcessClapEventsOnMixThread()
+void Audio::ProcessClapChainsOnMixThread( float* inputs[], uint32_t framesPerBuffer )
 {
-    for ( uint32_t eventIndex = 0; eventIndex < static_cast<uint32_t>( m_clapProcessEventsOut.size() ); ++eventIndex )
-    {
-        clap_event_header* eventHeader = m_clapProcessEventsOut.get( eventIndex );
-        blog::plug( FMTX( "[CLAP] event-out : {} @ sample {}" ), plug::utils::clapEventTypeToString( eventHeader->type ), eventHeader->time );
-    }
+    m_clapSteadyTime += static_cast<int64_t>( framesPerBuffer );
+
+    plug::CLAPChain& monitorChain   = *m_clapChains[ClapChainMonitor];
+    plug::CLAPChain& broadcastChain = *m_clapChains[ClapChainBroadcast];
+
+    m_clapResultBroadcast = { nullptr, nullptr };
 
-    m_clapProcessEventsOut.clear();
-    m_clapProcessEventsIn.clear();
+    // both chains run here, one after the other; plugins expect process() on the thread clapIsAudioThread() reports
+    // as the audio thread, and the audio callback must never be left waiting on a worker pool that can be busy with
+    // (or preempted by) lower priority work
+    m_clapResultMonitor = monitorChain.process( inputs[0], inputs[1], framesPerBuffer, m_outSampleRate, m_clapSteadyTime, &m_clapProcessTransport );
+
+    if ( broadcastChain.hasActiveSlots() )
+        m_clapResultBroadcast = broadcastChain.process( inputs[0], inputs[1], framesPerBuffer, m_outSampleRate, m_clapSteadyTime, &m_clapProcessTransport );
 }
 
 #endif // OURO_HAS_CLAP
@@ -572,12 +618,19 @@ int Audio::PortAudioCallbackInternal( void* outputBuffer, unsigned long framesPe
 
     m_state.mark( ExposedState::ExecutionStage::Start );
 
+    // claim any MIDI that arrived during the last block, positioned within this one; always drained so nothing
+    // stale is waiting if a mixer is installed later
+    m_midiFeed.beginBlock( framesPerBuffer );
+
     // pass control to the installed mixer, if we have one
     if ( m_mixerInterface != nullptr )
     {
         OutputSignal outputSignal;
         outputSignal.m_linearGain   = m_outputSignalGain;
 
+        if ( m_midiFeed.getBlockMessageCount() > 0 )
+            m_mixerInterface->processMidi( m_midiFeed.getBlockMessages(), m_midiFeed.getBlockMessageCount(), m_state.m_samplePos );
+
         m_mixerInterface->update( *m_mixerBuffers, outputSignal, framesPerBuffer, m_state.m_samplePos );
     }
     // otherwise, ssshhh
@@ -647,9 +700,6 @@ int Audio::PortAudioCallbackInternal( void* outputBuffer, unsigned long framesPe
     {
         const app::AudioPlaybackTimeInfo* playbackTimeInfo = ( m_mixerInterface != nullptr ) ? m_mixerInterface->getPlaybackTimeInfo() : nullptr;
 
-        m_clapProcess.steady_time += static_cast<int64_t>( framesPerBuffer );
-        m_clapProcess.frames_count = static_cast<uint32_t>( framesPerBuffer );
-
         if ( playbackTimeInfo != nullptr )
         {
             m_clapProcessTransport.flags = CLAP_TRANSPORT_HAS_TEMPO 
@@ -664,38 +714,11 @@ int Audio::PortAudioCallbackInternal( void* outputBuffer, unsigned long framesPe
             m_clapProcessTransport.flags = 0;
         }
 
-        if ( m_clapEffectTest != nullptr )
-        {
-            if ( m_clapEffectTest->m_ready && m_clapEffectTest->m_online != nullptr )
-            {
-                auto& inputBuffers  = m_clapEffectTest->getRuntimeInstance().getInputAudioBuffers();
-                for ( std::size_t bI = 0U; bI < inputBuffers.size(); bI++ )
-                {
-                    inputBuffers[bI].data32 = inputs;
-                }
-                m_clapProcess.audio_inputs          = &inputBuffers[0];
-                m_clapProcess.audio_inputs_count    = static_cast< uint32_t >( inputBuffers.size() );
-
-                auto& outputBuffers = m_clapEffectTest->getRuntimeInstance().getOutputAudioBuffers();
-                for ( std::size_t bI = 0U; bI < outputBuffers.size(); bI++ )
-                {
-                    outputBuffers[bI].data32 = outputs;
-                }
-                m_clapProcess.audio_outputs         = &outputBuffers[0];
-                m_clapProcess.audio_outputs_count   = static_cast< uint32_t >( outputBuffers.size() );
-
-
-                plug::online::Processing processing( m_clapEffectTest->m_online );
-
-                int32_t processingResult = processing( m_clapProcess );
-
-                inputs[0] = outputs[0];
-                inputs[1] = outputs[1];
-                outputsWritten = true;
-            }
-        }
+        ProcessClapChainsOnMixThread( inputs, static_cast<uint32_t>( framesPerBuffer ) );
 
-        ProcessClapEventsOnMixThread();
+        outputs[0] = m_clapResultMonitor[0];
+        outputs[1] = m_clapResultMonitor[1];
+        outputsWritten = true;
     }
 #endif // OURO_HAS_CLAP
 
@@ -736,9 +759,20 @@ int Audio::PortAudioCallbackInternal( void* outputBuffer, unsigned long framesPe
 
     m_state.mark( ExposedState::ExecutionStage::Interleave );
 
+    // sample processors take the broadcast bus if its chain produced anything, otherwise the same signal as the device
+    float* broadcastChannelLeft  = resultChannelLeft;
+    float* broadcastChannelRight = resultChannelRight;
+#if OURO_HAS_CLAP
+    if ( m_clapResultBroadcast[0] != nullptr )
+    {
+        broadcastChannelLeft  = m_clapResultBroadcast[0];
+        broadcastChannelRight = m_clapResultBroadcast[1];
+    }
+#endif // OURO_HAS_CLAP
+
     for ( auto& ssp : m_sampleProcessorsInstalled )
     {
-        ssp->appendSamples( resultChannelLeft, resultChannelRight, framesPerBuffer );
+        ssp->appendSamples( broadcastChannelLeft, broadcastChannelRight, framesPerBuffer );
     }
 
     m_state.mark( ExposedState::ExecutionStage::SampleProcessing );
@@ -894,6 +928,95 @@ const void* Audio::clapGetExtension( CLAPEffect& clapEffect, const char* extensi
     return nullptr;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void Audio::clapEffectCreate( const plug::KnownPlugin& knownPlugin, const std::size_t chainIndex )
+{
+    ABSL_ASSERT( chainIndex < ClapChainCount );
+
+    auto clapEffect = std::make_unique< CLAPEffect >();
+
+    clapEffect->m_audioModule       = this;
+    clapEffect->m_host              = m_clapHost;
+    clapEffect->m_host.host_data    = clapEffect.get();
+    clapEffect->m_displayName       = knownPlugin.m_name;
+    clapEffect->m_chainIndex        = chainIndex;
+    clapEffect->m_slot              = std::make_unique< plug::CLAPChainSlot >( knownPlugin.m_name );
+
+    auto runtimeLoadStatus = plug::runtime::CLAP::load( knownPlugin, &clapEffect->m_host );
+    if ( !runtimeLoadStatus.ok() )
+    {
+        blog::error::plug( FMTX( "[CLAP:{}] failed to load, {}" ), knownPlugin.m_name, runtimeLoadStatus.status().ToString() );
+        return;
+    }
+    clapEffect->m_runtime = std::move( runtimeLoadStatus.value() );
+
+    // the slot joins the chain inactive; it only starts processing once activated and published
+    m_mixThreadCommandsIssued++;
+    m_mixThreadCommandQueue.emplace( MixThreadCommand::ClapChainAppend, clapEffect.get() );
+
+    m_clapEffects.emplace_back( std::move( clapEffect ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Audio::clapEffectDestroy( CLAPEffect* clapEffect )
+{
+    ABSL_ASSERT( clapEffect != nullptr );
+
+    // pull it from the chain and wait for that to land, then nothing on the mix thread can be referencing it
+    {
+        const uint32_t commandCounter = m_mixThreadCommandsIssued++;
+        m_mixThreadCommandQueue.emplace( MixThreadCommand::ClapChainRemove, clapEffect );
+        blockUntil( AsyncCommandCounter{ commandCounter } );
+    }
+
+    clapEffect->m_slot->m_online = nullptr;
+    if ( clapEffect->m_online )
+        clapEffect->m_runtime = plug::online::CLAP::deactivate( clapEffect->m_online );
+
+    base::erase_where( m_clapEffects, [=]( const std::unique_ptr< CLAPEffect >& entry ) { return entry.get() == clapEffect; } );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Audio::clapEffectSetActive( CLAPEffect& clapEffect, const bool active )
+{
+    if ( active )
+    {
+        if ( clapEffect.m_online )
+            return;
+
+        auto onlineActivateStatus = plug::online::CLAP::activate(
+            clapEffect.m_runtime,
+            m_outSampleRate,
+            8,
+            m_outMaxBufferSize );
+
+        if ( !onlineActivateStatus.ok() )
+        {
+            blog::error::plug( FMTX( "[CLAP:{}] activation failed, {}" ), clapEffect.m_displayName, onlineActivateStatus.status().ToString() );
+            return;
+        }
+
+        clapEffect.m_online = std::move( onlineActivateStatus.value() );
+        clapEffect.m_slot->resetOverrun();
+        clapEffect.m_slot->m_online.store( clapEffect.m_online.get(), std::memory_order_release );
+    }
+    else
+    {
+        if ( !clapEffect.m_online )
+            return;
+
+        // unpublish, then wait for a full mix block to pass so that any processing already underway has finished
+        clapEffect.m_slot->m_online.store( nullptr, std::memory_order_release );
+        {
+            const uint32_t commandCounter = m_mixThreadCommandsIssued++;
+            m_mixThreadCommandQueue.emplace( MixThreadCommand::Synchronise );
+            blockUntil( AsyncCommandCounter{ commandCounter } );
+        }
+
+        clapEffect.m_runtime = plug::online::CLAP::deactivate( clapEffect.m_online );
+    }
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 // Request the host to deactivate and then reactivate the plugin.
 // The operation may be delayed by the host.
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "app/module.h"
+#include "app/module.midi.feed.h"
 
 #include "base/utils.h"
 #include "base/id.simple.h"
@@ -26,6 +27,7 @@
 // clap plugin support
 #include "plug/stash.clap.h"
 #include "plug/plug.clap.h"
+#include "plug/chain.clap.h"
 #include "clap/clap.h"
 #include "clap/version.h"
 #include "clap/helpers/event-list.hh"
@@ -54,7 +56,6 @@ struct Audio;
 struct CLAPEffect
 {
     app::module::Audio*             m_audioModule = nullptr;        // pointer back to owning audio host
-    std::atomic_bool                m_ready = false;
     std::string                     m_displayName;
 
     plug::runtime::CLAP::Instance   m_runtime;
@@ -62,6 +63,9 @@ struct CLAPEffect
 
     clap_host                       m_host;
 
+    std::size_t                     m_chainIndex = 0;               // which output bus chain this effect sits in
+    std::unique_ptr< plug::CLAPChainSlot > m_slot;                  // processing state shared with the mix thread
+
     // depending if plugin is activated or not we may be fetching the runtime instance from the 
     // original object or from inside the activated online one; this just wraps that and there
     // should be no way for it not to return something (unless something has gone badly wrong)
@@ -100,22 +104,22 @@ struct Audio final
         OutputBuffer( const uint32_t maxSamples )
             : m_maxSamples( maxSamples )
         {
-            m_workingLR[0]      = mem::alloc16To<float>( m_maxSamples, 0.0f );
-            m_workingLR[1]      = mem::alloc16To<float>( m_maxSamples, 0.0f );
-            m_finalOutputLR[0]  = mem::alloc16To<float>( m_maxSamples, 0.0f );
-            m_finalOutputLR[1]  = mem::alloc16To<float>( m_maxSamples, 0.0f );
-            m_silence           = mem::alloc16To<float>( m_maxSamples, 0.0f );
-            m_runoff            = mem::alloc16To<float>( m_maxSamples, 0.0f );
+            m_workingLR[0]      = mem::alloc16To<float>( m_maxSamples, 0.0f, mem::Tag::Audio );
+            m_workingLR[1]      = mem::alloc16To<float>( m_maxSamples, 0.0f, mem::Tag::Audio );
+            m_finalOutputLR[0]  = mem::alloc16To<float>( m_maxSamples, 0.0f, mem::Tag::Audio );
+            m_finalOutputLR[1]  = mem::alloc16To<float>( m_maxSamples, 0.0f, mem::Tag::Audio );
+            m_silence           = mem::alloc16To<float>( m_maxSamples, 0.0f, mem::Tag::Audio );
+            m_runoff            = mem::alloc16To<float>( m_maxSamples, 0.0f, mem::Tag::Audio );
         }
 
         ~OutputBuffer()
         {
-            mem::free16( m_runoff );
-            mem::free16( m_silence );
-            mem::free16( m_finalOutputLR[1] );
-            mem::free16( m_finalOutputLR[0] );
-            mem::free16( m_workingLR[1] );
-            mem::free16( m_workingLR[0] );
+            mem::free16( m_runoff, mem::Tag::Audio );
+            mem::free16( m_silence, mem::Tag::Audio );
+            mem::free16( m_finalOutputLR[1], mem::Tag::Audio );
+            mem::free16( m_finalOutputLR[0], mem::Tag::Audio );
+            mem::free16( m_workingLR[1], mem::Tag::Audio );
+            mem::free16( m_workingLR[0], mem::Tag::Audio );
         }
 
         // blit silence into all output channels
@@ -169,6 +173,9 @@ struct Audio final
 
     ouro_nodiscard std::chrono::microseconds getOutputLatencyMs() const { return m_outLatencyMs; }
 
+    // hand this to app::module::Midi::attachMixThreadFeed to have incoming MIDI delivered sample-accurately to the mixer
+    ouro_nodiscard app::midi::MixThreadFeed& getMidiFeed() { return m_midiFeed; }
+
 
     struct ExposedState
     {
@@ -249,6 +256,15 @@ struct Audio final
     AsyncCommandCounter toggleMute();
     ouro_nodiscard constexpr bool isMuted() const { return m_mute; }
 
+    // bumped every time the mix thread applies a command (mixer swap, mute, plugin changes, ...); the UI compares this
+    // between frames to notice audio state changes that it did not initiate itself
+    ouro_nodiscard uint32_t getStateRevision() const { return m_mixThreadCommandsComplete.load(); }
+
+    // optional event bus asked to wake the main thread after the mix thread applies a batch of commands, so a frame loop
+    // blocked waiting for input can notice the revision change immediately; the bus runs its wake hook on its own
+    // notifier thread, so nothing on the mix thread blocks. must outlive the audio module or be cleared first
+    void setStateChangeWake( base::EventBus* eventBus ) { m_stateChangeWake.store( eventBus, std::memory_order_release ); }
+
     // get copy of the rolling FFT analysis of audio output
     ouro_nodiscard inline dsp::Scope8::Result getCurrentScopeResult() const
     {
@@ -256,6 +272,16 @@ struct Audio final
         return m_scope->getCurrentResult();
     }
 
+    // cheap 'is anything playing' check for the UI; true if the rolling scope shows any signal
+    ouro_nodiscard bool isOutputAudible() const
+    {
+        if ( m_scope == nullptr )
+            return false;
+
+        const dsp::Scope8::Result scopeResult = m_scope->getCurrentResult();
+        return std::any_of( scopeResult.begin(), scopeResult.end(), []( const float bucket ) { return bucket > 1e-4f; } );
+    }
+
     ouro_nodiscard bool isMainThreadID( const std::thread::id& idToCheck ) const { return m_mainThreadID == idToCheck; }
     ouro_nodiscard bool isAudioThreadID( const std::thread::id& idToCheck ) const { return m_audioThreadID == idToCheck; }
 
@@ -270,14 +296,17 @@ private:
         TogglePluginBypass,
         ToggleMute,
         AttachSampleProcessor,
-        DetatchSampleProcessor
+        DetatchSampleProcessor,
+        ClapChainAppend,
+        ClapChainRemove,
+        Synchronise
     };
     struct MixThreadCommandData : public base::BasicCommandType<MixThreadCommand> { using BasicCommandType::BasicCommandType; };
     using MixThreadCommandQueue = mcc::ReaderWriterQueue<MixThreadCommandData>;
 
     void ProcessMixCommandsOnMixThread();
 #if OURO_HAS_CLAP
-    void ProcessClapEventsOnMixThread();
+    void ProcessClapChainsOnMixThread( float* inputs[], uint32_t framesPerBuffer );
 #endif // OURO_HAS_CLAP
 
     static int PortAudioCallback(
@@ -298,6 +327,7 @@ private:
     MixThreadCommandQueue               m_mixThreadCommandQueue;
     std::atomic_uint32_t                m_mixThreadCommandsIssued   = 0;
     std::atomic_uint32_t                m_mixThreadCommandsComplete = 0;
+    std::atomic< base::EventBus* >      m_stateChangeWake           = nullptr;
 
     std::thread::id                     m_audioThreadID;
     std::thread::id                     m_mainThreadID;
@@ -327,6 +357,8 @@ private:
 
     MixerInterface*                     m_mixerInterface    = nullptr;
 
+    app::midi::MixThreadFeed            m_midiFeed;                         // timestamped MIDI, placed within each block before the mixer runs
+
 
     SampleProcessorQueue                m_sampleProcessorsToInstall;
     SampleProcessorInstances            m_sampleProcessorsInstalled;
@@ -381,16 +413,37 @@ private:
     clap_host_thread_check              m_clapHostThreadCheck;
     
 
-    CLAPEffect*                         m_clapEffectTest = nullptr;
+    // one chain per output bus; Monitor feeds the audio device, Broadcast feeds the attached sample processors
+    // (recorder, stream outputs) and falls back to the Monitor result while it has nothing active in it.
+    // both chains are processed in turn on the audio thread
+    enum ClapChainBus
+    {
+        ClapChainMonitor,
+        ClapChainBroadcast,
+        ClapChainCount
+    };
+    static constexpr std::array< const char*, ClapChainCount > cClapChainNames = { "Monitor", "Broadcast" };
+
+    using ClapChains    = std::array< std::unique_ptr< plug::CLAPChain >, ClapChainCount >;
+    using ClapEffects   = std::vector< std::unique_ptr< CLAPEffect > >;
 
+    ClapChains                          m_clapChains;                   // mix thread owns slot order
+    ClapEffects                         m_clapEffects;                  // main thread owns the effect instances, in chain order
+    std::array< float*, 2 >             m_clapResultMonitor;            // results of the last ProcessClapChainsOnMixThread
+    std::array< float*, 2 >             m_clapResultBroadcast;
 
-    clap::helpers::EventList            m_clapProcessEventsIn;
-    clap::helpers::EventList            m_clapProcessEventsOut;
     clap_event_transport                m_clapProcessTransport;
-    clap_process                        m_clapProcess;
+    int64_t                             m_clapSteadyTime = 0;
 
     plug::stash::CLAP::Instance         m_pluginStashClap;
 
+    // main thread; add a plugin to the end of a chain, or remove (deactivating) one
+    void clapEffectCreate( const plug::KnownPlugin& knownPlugin, const std::size_t chainIndex );
+    void clapEffectDestroy( CLAPEffect* clapEffect );
+    void clapEffectSetActive( CLAPEffect& clapEffect, const bool active );
+
+    void imguiClapChains( app::CoreGUI& coreGUI );
+
 
 public:
     // routed calls from clap_host function table
@@ -418,6 +471,13 @@ struct MixerInterface
         const uint32_t             samplesToWrite,
         const uint64_t             samplePosition ) = 0;
 
+    // called from the realtime audio processing thread just before update(), if any MIDI arrived since the last block;
+    // each message carries an offset into the coming block of samplesToWrite so it can be applied where it landed
+    virtual void processMidi(
+        const app::midi::TimedMessage* messages,
+        const std::size_t              messageCount,
+        const uint64_t                 samplePosition ) {}
+
     // called from the main UI thread
     virtual void imgui() {}
 
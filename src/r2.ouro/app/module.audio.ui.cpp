@@ -27,73 +27,139 @@ void Audio::imgui( app::CoreGUI& coreGUI )
 
     if ( ImGui::Begin( ICON_FA_PLUG " Signal Path###audiomodule_signal" ) )
     {
-        if ( m_clapEffectTest )
+        imguiClapChains( coreGUI );
+    }
+    ImGui::End();
+
+#endif // OURO_HAS_CLAP
+
+}
+
+#if OURO_HAS_CLAP
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Audio::imguiClapChains( app::CoreGUI& coreGUI )
+{
+    // chains only exist while the output is running
+    if ( m_clapChains[ClapChainMonitor] == nullptr )
+        return;
+
+    CLAPEffect* effectToDestroy = nullptr;
+
+    for ( std::size_t chainIndex = 0; chainIndex < ClapChainCount; chainIndex++ )
+    {
+        ImGui::PushID( static_cast<int32_t>( chainIndex ) );
+        ImGui::SeparatorBreak();
+        ImGui::TextUnformatted( cClapChainNames[chainIndex] );
+
+        for ( auto& clapEffectPtr : m_clapEffects )
         {
-            bool bIsActivated = ( m_clapEffectTest->m_online != nullptr );
-            if ( ImGui::Checkbox( m_clapEffectTest->m_displayName.c_str(), &bIsActivated ) )
-            {
-                if ( bIsActivated )
-                {
-                    auto onlineActivateStatus = plug::online::CLAP::activate(
-                        m_clapEffectTest->m_runtime,
-                        m_outSampleRate,
-                        8,
-                        m_outMaxBufferSize );
+            CLAPEffect& clapEffect = *clapEffectPtr;
+            if ( clapEffect.m_chainIndex != chainIndex )
+                continue;
 
-                    if ( onlineActivateStatus.ok() )
-                    {
-                        m_clapEffectTest->m_online = std::move( onlineActivateStatus.value() );
-                        m_clapEffectTest->m_ready = true;
-                    }
-                }
-                else
+            plug::CLAPChainSlot& chainSlot = *clapEffect.m_slot;
+
+            ImGui::PushID( &clapEffect );
+
+            bool bIsActivated = ( clapEffect.m_online != nullptr );
+            if ( ImGui::Checkbox( clapEffect.m_displayName.c_str(), &bIsActivated ) )
+            {
+                clapEffectSetActive( clapEffect, bIsActivated );
+            }
+            ImGui::SameLine();
+            {
+                ImGui::Scoped::Enabled se( clapEffect.getRuntimeInstance().canShowUI() );
+                if ( ImGui::Button( "GUI" ) )
                 {
-                    m_clapEffectTest->m_ready = false;
-                    m_clapEffectTest->m_runtime = plug::online::CLAP::deactivate( m_clapEffectTest->m_online );
+                    clapEffect.getRuntimeInstance().showUI( coreGUI );
                 }
             }
             ImGui::SameLine();
             {
-                const auto clapUIState = m_clapEffectTest->getRuntimeInstance().getUIState();
+                const bool bIsBypassed = chainSlot.m_bypass;
+                ImGui::Scoped::ToggleButton toggled( bIsBypassed );
+                if ( ImGui::Button( "Bypass" ) )
+                    chainSlot.m_bypass = !bIsBypassed;
+            }
+            ImGui::SameLine();
+            if ( ImGui::Button( ICON_FA_TRASH ) )
+            {
+                effectToDestroy = &clapEffect;
+            }
 
-                ImGui::Scoped::Enabled se( m_clapEffectTest->getRuntimeInstance().canShowUI() );
-                if ( ImGui::Button( "GUI" ) )
+            ImGui::TextDisabled( "CPU %5.1f%%  peak %5.1f%%", chainSlot.m_cpuLoad.load() * 100.0f, chainSlot.m_cpuLoadPeak.load() * 100.0f );
+            if ( chainSlot.m_overrunBypass )
+            {
+                ImGui::SameLine();
+                ImGui::TextColored( ImGui::GetErrorTextColour(), "OVERRUN (%u)", chainSlot.m_overrunTrips.load() );
+                ImGui::SameLine();
+                if ( ImGui::SmallButton( "Reset" ) )
                 {
-                    m_clapEffectTest->getRuntimeInstance().showUI( coreGUI );
+                    blog::plug( FMTX( "[CLAP:{}] overrun bypass reset" ), clapEffect.m_displayName );
+                    chainSlot.resetOverrun();
                 }
             }
-        }
 
-        if ( m_pluginStashClap->asyncAllTasksComplete() )
-        {
-            m_pluginStashClap->iterateKnownPluginsValidAndSorted( [this]( const plug::KnownPlugin& knownPlugin, plug::KnownPluginIndex index )
+            // expose the plugin's own parameters; changes are queued and applied on the mix thread
+            const clap_plugin_params* pluginParams = clapEffect.getRuntimeInstance().getPluginParams();
+            const clap_plugin* pluginInstance = clapEffect.getRuntimeInstance().getPluginInstance();
+            if ( pluginParams != nullptr && ImGui::TreeNode( "Parameters" ) )
+            {
+                const uint32_t paramCount = pluginParams->count( pluginInstance );
+                for ( uint32_t paramIndex = 0; paramIndex < paramCount; paramIndex++ )
                 {
-                    if ( ImGui::Button( knownPlugin.m_sortable.c_str() ) )
+                    clap_param_info paramInfo;
+                    if ( !pluginParams->get_info( pluginInstance, paramIndex, &paramInfo ) )
+                        continue;
+                    if ( ( paramInfo.flags & ( CLAP_PARAM_IS_HIDDEN | CLAP_PARAM_IS_READONLY ) ) != 0 )
+                        continue;
+
+                    double paramValue = paramInfo.default_value;
+                    pluginParams->get_value( pluginInstance, paramInfo.id, &paramValue );
+
+                    float paramValueF = static_cast<float>( paramValue );
+                    ImGui::PushID( static_cast<int32_t>( paramInfo.id ) );
+                    if ( ImGui::SliderFloat( paramInfo.name, &paramValueF, static_cast<float>( paramInfo.min_value ), static_cast<float>( paramInfo.max_value ) ) )
                     {
-                        CLAPEffect* clapEffect = new CLAPEffect();
+                        if ( !chainSlot.queueParameterChange( paramInfo.id, static_cast<double>( paramValueF ) ) )
+                            blog::error::plug( FMTX( "[CLAP:{}] parameter queue full" ), clapEffect.m_displayName );
+                    }
+                    ImGui::PopID();
+                }
+                ImGui::TreePop();
+            }
 
-                        clapEffect->m_audioModule = this;
-                        clapEffect->m_host = m_clapHost;
-                        clapEffect->m_host.host_data = clapEffect;
+            ImGui::PopID();
+        }
 
-                        clapEffect->m_displayName = knownPlugin.m_name;
+        ImGui::PopID();
+    }
 
-                        auto runtimeLoadStatus = plug::runtime::CLAP::load( knownPlugin, &clapEffect->m_host );
-                        if ( runtimeLoadStatus.ok() )
-                        {
-                            clapEffect->m_runtime = std::move( runtimeLoadStatus.value() );
-                        }
+    if ( effectToDestroy != nullptr )
+        clapEffectDestroy( effectToDestroy );
 
-                        m_clapEffectTest = clapEffect;
-                    }
-                });
-        }
+    ImGui::SeparatorBreak();
+    ImGui::TextUnformatted( "Plugins" );
+
+    if ( m_pluginStashClap->asyncAllTasksComplete() )
+    {
+        m_pluginStashClap->iterateKnownPluginsValidAndSorted( [this]( const plug::KnownPlugin& knownPlugin, plug::KnownPluginIndex index )
+            {
+                ImGui::PushID( static_cast<int32_t>( index.get() ) );
+                for ( std::size_t chainIndex = 0; chainIndex < ClapChainCount; chainIndex++ )
+                {
+                    if ( ImGui::SmallButton( fmt::format( FMTX( "+ {}" ), cClapChainNames[chainIndex] ).c_str() ) )
+                        clapEffectCreate( knownPlugin, chainIndex );
+                    ImGui::SameLine();
+                }
+                ImGui::TextUnformatted( knownPlugin.m_sortable.c_str() );
+                ImGui::PopID();
+            });
     }
-    ImGui::End();
+}
 
 #endif // OURO_HAS_CLAP
 
-}
-
 } // namespace module
 } // namespace app
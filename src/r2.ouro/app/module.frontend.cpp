@@ -12,6 +12,7 @@
 #include "app/core.h"
 #include "app/module.frontend.h"
 #include "app/module.frontend.fonts.h"
+#include "base/memory.h"
 #include "colour/preset.h"
 
 #include "gfx/gl/enumstring.h"
@@ -294,6 +295,7 @@ absl::Status Frontend::create( app::Core* appCore )
         blog::core( "initialising ImGui {}", IMGUI_VERSION );
 
         IMGUI_CHECKVERSION();
+        mem::installImGuiAllocator();
         ImGui::CreateContext();
         ImPlot::CreateContext();
 
@@ -306,6 +308,11 @@ absl::Status Frontend::create( app::Core* appCore )
         ImGui_ImplGlfw_InitForOpenGL( m_glfwWindow, true );
         ImGui_ImplOpenGL3_Init( nullptr );
 
+        // imgui takes the input callbacks, we only need to hear about things that need a redraw
+        glfwSetWindowUserPointer( m_glfwWindow, this );
+        glfwSetWindowRefreshCallback( m_glfwWindow, glfwWindowRedrawCallback );
+        glfwSetFramebufferSizeCallback( m_glfwWindow, glfwFramebufferSizeCallback );
+
 
         ImGuiIO& io = ImGui::GetIO();
 
@@ -507,6 +514,9 @@ void Frontend::destroy()
 // ---------------------------------------------------------------------------------------------------------------------
 bool Frontend::appTick()
 {
+    // animation requests only last for the frame they were made in
+    m_animationRequested = false;
+
     bool shouldQuit = m_quitRequested;
          shouldQuit |= ( glfwWindowShouldClose( m_glfwWindow ) != 0 );
 
@@ -523,6 +533,9 @@ bool Frontend::appTick()
         m_windowGeometryChangedDelay--;
         if ( m_windowGeometryChangedDelay == 0 )
             updateAndSaveFrontendConfig();
+
+        // keep counting down in low-power mode rather than waiting out the idle interval for each tick
+        requestAnimationFrame();
     }
 
     glfwMakeContextCurrent( m_glfwWindow );
@@ -560,7 +573,92 @@ void Frontend::appRenderImguiDispatch()
 void Frontend::appRenderFinalise()
 {
     glfwSwapBuffers( m_glfwWindow );
-    glfwPollEvents();
+
+    // in low-power mode, input is gathered while waiting for the next frame instead
+    if ( !isLowPowerIdleEnabled() )
+        glfwPollEvents();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Frontend::waitForNextFrame()
+{
+    // imgui wants a handful of frames after any input to settle hover states, tooltips and so on
+    static constexpr auto cInteractiveHold = std::chrono::milliseconds( 500 );
+
+    const auto isInputWaiting = []() { return !GImGui->InputEventsQueue.empty(); };
+
+    // anything being dragged, typed into or held down runs at full rate
+    const ImGuiIO& io = ImGui::GetIO();
+    const bool isInteracting = ImGui::IsAnyItemActive() || ImGui::IsAnyMouseDown() || io.WantTextInput;
+
+    auto timeNow = FrameClock::now();
+    if ( isInteracting || isInputWaiting() || ( timeNow - m_lastInputTime ) < cInteractiveHold )
+    {
+        glfwPollEvents();
+
+        if ( isInteracting || isInputWaiting() )
+            m_lastInputTime = timeNow;
+
+        m_redrawRequested   = false;
+        m_lastFrameTime     = timeNow;
+        return true;
+    }
+
+    // otherwise the next frame is due at either the animation rate or the idle redraw interval
+    const auto frameInterval = m_animationRequested ?
+        std::chrono::duration_cast< FrameClock::duration >( std::chrono::duration< double >( 1.0 / (double)m_feConfigCopy.animationFrameRate ) ) :
+        std::chrono::duration_cast< FrameClock::duration >( std::chrono::milliseconds( m_feConfigCopy.idleRedrawIntervalMs ) );
+
+    const auto frameDue = m_lastFrameTime + frameInterval;
+
+    if ( !m_redrawRequested && timeNow < frameDue )
+    {
+        glfwWaitEventsTimeout( std::chrono::duration< double >( frameDue - timeNow ).count() );
+        timeNow = FrameClock::now();
+    }
+    else
+    {
+        glfwPollEvents();
+    }
+
+    const bool inputArrived = isInputWaiting();
+    if ( inputArrived )
+        m_lastInputTime = timeNow;
+
+    const bool closing = m_quitRequested || ( glfwWindowShouldClose( m_glfwWindow ) != 0 );
+
+    if ( inputArrived || closing || m_redrawRequested.exchange( false ) || timeNow >= frameDue )
+    {
+        m_lastFrameTime = timeNow;
+        return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Frontend::requestRedraw()
+{
+    if ( !m_redrawRequested.exchange( true ) )
+        glfwPostEmptyEvent();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Frontend::wakeFrameLoop()
+{
+    glfwPostEmptyEvent();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Frontend::glfwWindowRedrawCallback( GLFWwindow* window )
+{
+    if ( auto* frontend = static_cast< Frontend* >( glfwGetWindowUserPointer( window ) ) )
+        frontend->requestRedraw();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Frontend::glfwFramebufferSizeCallback( GLFWwindow* window, int, int )
+{
+    glfwWindowRedrawCallback( window );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
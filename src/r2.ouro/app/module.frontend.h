@@ -45,6 +45,25 @@ struct Frontend final : public Module
     // ... and swap
     void appRenderFinalise();
 
+
+    // low-power idle, see config::Frontend::lowPowerIdle; when disabled, appRenderFinalise polls for input and the
+    // loop runs at the display refresh rate as it always has
+    ouro_nodiscard constexpr bool isLowPowerIdleEnabled() const { return m_feConfigCopy.lowPowerIdle; }
+
+    // sleep until the next frame is due - on input, a redraw request, the animation rate or the idle redraw interval -
+    // and return true; returns false if woken for any other reason (eg. event bus traffic) so the caller can handle
+    // that and decide whether it warrants a frame
+    ouro_nodiscard bool waitForNextFrame();
+
+    // safe to call from any thread; wakes the frame loop and guarantees at least one more frame
+    void requestRedraw();
+
+    // safe to call from any thread; knocks the frame loop out of its wait without forcing a frame
+    static void wakeFrameLoop();
+
+    // call during UI layout while something on screen is animating; keeps frames coming at the animation rate
+    void requestAnimationFrame() { m_animationRequested = true; }
+
     void toggleBorderless();
 
 
@@ -111,6 +130,12 @@ private:
     // push actual window attributes for borderless mode
     void applyBorderless() const;
 
+    // GLFW window callbacks that need a redraw in response; imgui installs its own for input
+    static void glfwWindowRedrawCallback( GLFWwindow* window );
+    static void glfwFramebufferSizeCallback( GLFWwindow* window, int width, int height );
+
+    using FrameClock = std::chrono::steady_clock;
+
     config::Frontend        m_feConfigCopy;
     std::string             m_appName;
 
@@ -133,6 +158,11 @@ private:
     ImGui::MarkdownConfig   m_markdownConfig;
 
     bool                    m_quitRequested = false;
+
+    std::atomic_bool        m_redrawRequested       = false;
+    bool                    m_animationRequested    = false;    // set during layout, consumed by waitForNextFrame
+    FrameClock::time_point  m_lastFrameTime;
+    FrameClock::time_point  m_lastInputTime;
 };
 
 } // namespace module
@@ -10,6 +10,7 @@
 #include "pch.h"
 #include "app/core.h"
 #include "app/module.midi.h"
+#include "app/module.midi.feed.h"
 
 #include "RtMidi.h"
 
@@ -57,10 +58,44 @@ struct Midi::State : public Midi::InputControl
         }
     }
 
+    using Clock = app::midi::MixThreadFeed::Clock;
+
+    // how far behind now() the device's own message spacing is trusted to place an arrival
+    static constexpr auto cDeviceDeltaWindow = std::chrono::milliseconds( 5 );
+
+    // the arrival time handed to the mix thread for a message RtMidi just delivered, given its timeStamp
+    //
+    // RtMidi's timeStamp is the driver's count of seconds since the previous message, 0 for the first; it has no fixed
+    // relation to the steady clock that audio blocks are stamped with, and summing the deltas drifts away from it.
+    // stamping with now() alone is right for a lone message but bunches up everything the driver hands over in one go.
+    // so an arrival is the previous one plus the device delta as long as that lands within cDeviceDeltaWindow behind
+    // now(), which keeps the spacing inside a burst; otherwise it is now(), re-anchoring the chain so drift never
+    // builds up. called for every message, including ones we don't decode, so the chain keeps pace with the device
+    Clock::time_point stampArrival( const double deviceDelta )
+    {
+        const Clock::time_point now = Clock::now();
+
+        Clock::time_point arrivalTime = m_lastArrivalTime + std::chrono::round< Clock::duration >( std::chrono::duration< double >( deviceDelta ) );
+        if ( arrivalTime > now || arrivalTime < now - cDeviceDeltaWindow )
+            arrivalTime = now;
+
+        m_lastArrivalTime = arrivalTime;
+        return arrivalTime;
+    }
+
+    // hand a copy of a decoded message to the audio engine, if it asked for them
+    void deliverToMixThread( const app::midi::Message& msg, const Clock::time_point arrivalTime )
+    {
+        if ( app::midi::MixThreadFeed* mixThreadFeed = m_mixThreadFeed.load( std::memory_order_acquire ) )
+            mixThreadFeed->enqueue( msg, arrivalTime );
+    }
+
     // decode midi message and enqueue anything we understand into our threadsafe pile of messages
     static void onMidiData( double timeStamp, std::vector<unsigned char>* message, void* userData )
     {
         Midi::State* state = (Midi::State*)userData;
+
+        const Clock::time_point arrivalTime = state->stampArrival( timeStamp );
         
         // https://www.midi.org/specifications-old/item/table-1-summary-of-midi-message
         if ( message && message->size() <= 4 )
@@ -78,6 +113,7 @@ struct Midi::State : public Midi::InputControl
 
                 const ::events::MidiEvent midiMsg( { timeStamp, midi::Message::Type::NoteOn, u7OnKey, u7OnVel }, app::module::MidiDeviceID(0) );
                 state->m_eventBusClient.Send< ::events::MidiEvent >( midiMsg );
+                state->deliverToMixThread( midiMsg.m_msg, arrivalTime );
             }
             else
             if ( channelMessage == midi::NoteOff::u7Type )
@@ -88,6 +124,7 @@ struct Midi::State : public Midi::InputControl
                 blog::core( "midi::NoteOff (#{}) [{}] [{}]", channelNumber, u7OffKey, u7OffVel );
 
                 state->m_midiMessageQueue.emplace( timeStamp, midi::Message::Type::NoteOff, u7OffKey, u7OffVel );
+                state->deliverToMixThread( { timeStamp, midi::Message::Type::NoteOff, u7OffKey, u7OffVel }, arrivalTime );
             }
             else
             if ( channelMessage == midi::ControlChange::u7Type )
@@ -98,6 +135,7 @@ struct Midi::State : public Midi::InputControl
                 blog::core( "midi::ControlChange(#{}) [{}] = {}", channelNumber, u7CtrlNum, u7CtrlVal );
 
                 state->m_midiMessageQueue.emplace( timeStamp, midi::Message::Type::ControlChange, u7CtrlNum, u7CtrlVal );
+                state->deliverToMixThread( { timeStamp, midi::Message::Type::ControlChange, u7CtrlNum, u7CtrlVal }, arrivalTime );
             }
         }
     }
@@ -177,6 +215,9 @@ struct Midi::State : public Midi::InputControl
     base::EventBusClient            m_eventBusClient;
 
     MidiMessageQueue                m_midiMessageQueue;
+
+    std::atomic< app::midi::MixThreadFeed* >  m_mixThreadFeed = nullptr;
+    Clock::time_point               m_lastArrivalTime;              // RtMidi thread only
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -237,6 +278,15 @@ Midi::InputControl* Midi::getInputControl()
     return nullptr;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void Midi::attachMixThreadFeed( app::midi::MixThreadFeed* mixThreadFeed )
+{
+    if ( m_state != nullptr )
+    {
+        m_state->m_mixThreadFeed.store( mixThreadFeed, std::memory_order_release );
+    }
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Midi::processMessages( const std::function< void( const app::midi::Message& ) >& processor )
 {
@@ -0,0 +1,73 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+//
+
+#include "pch.h"
+
+#include "app/module.midi.feed.h"
+
+namespace app {
+namespace midi {
+
+// ---------------------------------------------------------------------------------------------------------------------
+MixThreadFeed::MixThreadFeed()
+    : m_arrivals( cMaxMessagesPerBlock )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void MixThreadFeed::enqueue( const Message& msg, const Clock::time_point arrivalTime )
+{
+    m_arrivals.enqueue( { msg, arrivalTime } );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void MixThreadFeed::beginBlock( const uint32_t samplesToWrite, const Clock::time_point blockStart )
+{
+    m_blockMessageCount = 0;
+
+    // nothing to measure against on the first block; anything already waiting lands at the very start
+    if ( !m_hasPreviousBlock )
+    {
+        m_previousBlockStart = blockStart;
+        m_hasPreviousBlock   = true;
+    }
+
+    // map the wall-clock span of the previous block onto this one; using the measured span rather than the nominal
+    // buffer duration keeps everything in order even when the audio callback itself is jittery
+    const double previousBlockSpan  = std::chrono::duration< double >( blockStart - m_previousBlockStart ).count();
+    const double spanToSamples      = ( previousBlockSpan > 0 ) ? ( (double)samplesToWrite / previousBlockSpan ) : 0.0;
+    const uint32_t lastSampleOffset = ( samplesToWrite > 0 ) ? ( samplesToWrite - 1 ) : 0;
+
+    uint32_t sampleOffsetFloor = 0;
+
+    const Arrival* arrival = nullptr;
+    while ( m_blockMessageCount < cMaxMessagesPerBlock && ( arrival = m_arrivals.peek() ) != nullptr )
+    {
+        // stamped after we started this block, it belongs to the next one
+        if ( arrival->m_time > blockStart )
+            break;
+
+        const double secondsIntoBlock = std::chrono::duration< double >( arrival->m_time - m_previousBlockStart ).count();
+
+        // anything stamped before the previous block started (or overspill from it) goes first, and offsets never run
+        // backwards so messages stay in arrival order
+        uint32_t sampleOffset = (uint32_t)std::clamp( secondsIntoBlock * spanToSamples, 0.0, (double)lastSampleOffset );
+        sampleOffset          = std::max( sampleOffset, sampleOffsetFloor );
+        sampleOffsetFloor     = sampleOffset;
+
+        m_blockMessages[m_blockMessageCount++] = { arrival->m_msg, sampleOffset };
+
+        m_arrivals.pop();
+    }
+
+    m_previousBlockStart = blockStart;
+}
+
+} // namespace midi
+} // namespace app
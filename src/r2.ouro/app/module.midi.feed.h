@@ -0,0 +1,71 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  carries timestamped MIDI from whichever thread receives it to the audio mix thread, placing each message at a
+//  sample offset inside the block it gets delivered with
+//
+
+#pragma once
+
+#include "app/module.midi.msg.h"
+
+namespace app {
+namespace midi {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// a message positioned inside the block of audio currently being mixed
+struct TimedMessage
+{
+    Message     m_msg;
+    uint32_t    m_sampleOffset = 0;         // always < the block's samplesToWrite
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// messages are stamped with the host clock as they arrive (module.midi.cpp folds the device's own spacing in, see
+// stampArrival there); at the start of each block the mix thread claims everything that arrived during the previous
+// block and spreads it across the new one at the same relative spacing. that trades one buffer of fixed latency for
+// the jitter of handling MIDI on the main thread and applying it on the next block edge
+//
+// single producer (the RtMidi callback, or a FileReplay standing in for it), single consumer (the mix thread)
+//
+struct MixThreadFeed
+{
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t cMaxMessagesPerBlock = 256;    // any overspill waits for the following block
+
+    MixThreadFeed();
+
+    // producer side; arrival time defaults to now, replay sources can pass their own to reproduce recorded timing
+    void enqueue( const Message& msg, const Clock::time_point arrivalTime = Clock::now() );
+
+    // consumer side, mix thread only; call once at the start of every block, then read back the messages for it.
+    // the block start defaults to now; a replay can pass recorded block times along with recorded arrivals
+    void beginBlock( const uint32_t samplesToWrite, const Clock::time_point blockStart = Clock::now() );
+
+    ouro_nodiscard constexpr const TimedMessage* getBlockMessages() const { return m_blockMessages.data(); }
+    ouro_nodiscard constexpr std::size_t getBlockMessageCount() const { return m_blockMessageCount; }
+
+private:
+
+    struct Arrival
+    {
+        Message             m_msg;
+        Clock::time_point   m_time;
+    };
+    using ArrivalQueue = mcc::ReaderWriterQueue< Arrival >;
+
+    ArrivalQueue                                        m_arrivals;
+
+    Clock::time_point                                   m_previousBlockStart;
+    bool                                                m_hasPreviousBlock = false;
+
+    std::array< TimedMessage, cMaxMessagesPerBlock >    m_blockMessages;
+    std::size_t                                         m_blockMessageCount = 0;
+};
+
+} // namespace midi
+} // namespace app
@@ -14,6 +14,8 @@
 #include "base/id.hash.h"
 #include "base/text.h"
 
+namespace app { namespace midi { struct MixThreadFeed; } }
+
 namespace app {
 namespace module {
 
@@ -77,6 +79,10 @@ struct Midi : public Module
     // if MIDI isn't booted or there's just nothing to do, this call does nothing
     void processMessages( const std::function< void( const app::midi::Message& ) >& processor );
 
+    // additionally push every decoded message, stamped with its arrival time, into the given feed for sample-accurate
+    // delivery to the audio mix thread; pass nullptr to stop. the feed must outlive this module or be detached first
+    void attachMixThreadFeed( app::midi::MixThreadFeed* mixThreadFeed );
+
 protected:
 
     struct State;
@@ -0,0 +1,296 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+//
+
+#include "pch.h"
+
+#include "base/fio.h"
+
+#include "app/module.midi.replay.h"
+
+namespace app {
+namespace midi {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// bounds-checked big-endian reads over a chunk of the file
+struct SmfByteReader
+{
+    SmfByteReader( const uint8_t* data, const std::size_t dataSize )
+        : m_data( data )
+        , m_size( dataSize )
+    {}
+
+    ouro_nodiscard std::size_t remaining() const { return m_size - m_offset; }
+
+    bool u8( uint8_t& value )
+    {
+        if ( remaining() < 1 )
+            return false;
+        value = m_data[m_offset++];
+        return true;
+    }
+
+    bool u16( uint16_t& value )
+    {
+        if ( remaining() < 2 )
+            return false;
+        value = (uint16_t)( ( m_data[m_offset] << 8 ) | m_data[m_offset + 1] );
+        m_offset += 2;
+        return true;
+    }
+
+    bool u32( uint32_t& value )
+    {
+        if ( remaining() < 4 )
+            return false;
+        value = ( (uint32_t)m_data[m_offset] << 24 ) | ( (uint32_t)m_data[m_offset + 1] << 16 ) | ( (uint32_t)m_data[m_offset + 2] << 8 ) | (uint32_t)m_data[m_offset + 3];
+        m_offset += 4;
+        return true;
+    }
+
+    // variable-length quantity; at most 4 bytes, 28 bits
+    bool varLength( uint32_t& value )
+    {
+        value = 0;
+        for ( int32_t byteI = 0; byteI < 4; byteI++ )
+        {
+            uint8_t byte;
+            if ( !u8( byte ) )
+                return false;
+            value = ( value << 7 ) | ( byte & 0x7F );
+            if ( ( byte & 0x80 ) == 0 )
+                return true;
+        }
+        return false;
+    }
+
+    bool skip( const std::size_t bytes )
+    {
+        if ( remaining() < bytes )
+            return false;
+        m_offset += bytes;
+        return true;
+    }
+
+    const uint8_t*  m_data;
+    std::size_t     m_size;
+    std::size_t     m_offset = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< FileReplay > FileReplay::load( const fs::path& midiFile )
+{
+    const auto fileContents = base::readBinaryFile( midiFile );
+    if ( !fileContents.ok() )
+        return fileContents.status();
+
+    auto replay = parse( reinterpret_cast<const uint8_t*>( fileContents->data() ), fileContents->size() );
+    if ( !replay.ok() )
+        return absl::Status( replay.status().code(), fmt::format( FMTX( "[{}] {}" ), midiFile.string(), std::string( replay.status().message() ) ) );
+
+    return replay;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< FileReplay > FileReplay::parse( const uint8_t* data, const std::size_t dataSize )
+{
+    struct TrackEvent
+    {
+        uint64_t        m_tick;
+        Message::Type   m_type;
+        uint8_t         m_data0;
+        uint8_t         m_data1;
+    };
+    struct TempoChange
+    {
+        uint64_t        m_tick;
+        uint32_t        m_microsecondsPerQuarter;
+    };
+
+    SmfByteReader reader( data, dataSize );
+
+    uint32_t chunkID, chunkSize;
+    uint16_t format, trackCount, division;
+    if ( !reader.u32( chunkID ) || chunkID != 0x4D546864 /* MThd */ || !reader.u32( chunkSize ) || chunkSize < 6 ||
+         !reader.u16( format ) || !reader.u16( trackCount ) || !reader.u16( division ) || !reader.skip( chunkSize - 6 ) )
+    {
+        return absl::InvalidArgumentError( "not a standard MIDI file" );
+    }
+    if ( format > 1 )
+        return absl::UnimplementedError( fmt::format( FMTX( "MIDI file format {} is not supported, only 0 and 1" ), format ) );
+    if ( ( division & 0x7FFF ) == 0 )
+        return absl::InvalidArgumentError( "MIDI file has a zero time division" );
+
+    std::vector< TrackEvent >  trackEvents;
+    std::vector< TempoChange > tempoChanges;
+
+    for ( uint16_t trackI = 0; trackI < trackCount; )
+    {
+        if ( !reader.u32( chunkID ) || !reader.u32( chunkSize ) || reader.remaining() < chunkSize )
+            return absl::DataLossError( fmt::format( FMTX( "MIDI file is truncated, {} of {} tracks read" ), trackI, trackCount ) );
+
+        SmfByteReader track( reader.m_data + reader.m_offset, chunkSize );
+        reader.skip( chunkSize );
+
+        // anything that isn't a track is an unknown chunk, which the spec says to step over
+        if ( chunkID != 0x4D54726B /* MTrk */ )
+            continue;
+
+        uint64_t tick = 0;
+        uint8_t  runningStatus = 0;
+        bool     endOfTrack = false;
+        while ( !endOfTrack && track.remaining() > 0 )
+        {
+            uint32_t delta;
+            uint8_t  status;
+            if ( !track.varLength( delta ) || !track.u8( status ) )
+                return absl::DataLossError( fmt::format( FMTX( "track {} is truncated" ), trackI ) );
+            tick += delta;
+
+            // meta events; only tempo changes and the end of the track matter here
+            if ( status == 0xFF )
+            {
+                uint8_t  metaType;
+                uint32_t metaLength;
+                if ( !track.u8( metaType ) || !track.varLength( metaLength ) || track.remaining() < metaLength )
+                    return absl::DataLossError( fmt::format( FMTX( "track {} has a truncated meta event" ), trackI ) );
+
+                if ( metaType == 0x51 && metaLength == 3 )
+                {
+                    const uint8_t* tempo = track.m_data + track.m_offset;
+                    tempoChanges.emplace_back( TempoChange{ tick, ( (uint32_t)tempo[0] << 16 ) | ( (uint32_t)tempo[1] << 8 ) | (uint32_t)tempo[2] } );
+                }
+                endOfTrack = ( metaType == 0x2F );
+
+                track.skip( metaLength );
+                runningStatus = 0;
+                continue;
+            }
+            // system exclusive, skipped whole
+            if ( status == 0xF0 || status == 0xF7 )
+            {
+                uint32_t sysexLength;
+                if ( !track.varLength( sysexLength ) || !track.skip( sysexLength ) )
+                    return absl::DataLossError( fmt::format( FMTX( "track {} has a truncated sysex event" ), trackI ) );
+
+                runningStatus = 0;
+                continue;
+            }
+
+            // channel messages, where a data byte in place of a status reuses the last one
+            uint8_t data0;
+            if ( status < 0x80 )
+            {
+                if ( runningStatus == 0 )
+                    return absl::DataLossError( fmt::format( FMTX( "track {} uses running status with no status to run on" ), trackI ) );
+                data0  = status;
+                status = runningStatus;
+            }
+            else if ( status >= 0xF0 )
+            {
+                return absl::DataLossError( fmt::format( FMTX( "track {} holds system message {:#x}, not valid in a file" ), trackI, status ) );
+            }
+            else if ( !track.u8( data0 ) )
+            {
+                return absl::DataLossError( fmt::format( FMTX( "track {} is truncated" ), trackI ) );
+            }
+            runningStatus = status;
+
+            const uint8_t channelMessage = ( status & 0xF0 );
+
+            // program change and channel pressure carry one data byte, everything else two
+            uint8_t data1 = 0;
+            if ( channelMessage != 0xC0 && channelMessage != 0xD0 && !track.u8( data1 ) )
+                return absl::DataLossError( fmt::format( FMTX( "track {} is truncated" ), trackI ) );
+
+            if ( ( data0 | data1 ) & 0x80 )
+                return absl::DataLossError( fmt::format( FMTX( "track {} has a data byte with the top bit set" ), trackI ) );
+
+            if ( channelMessage == NoteOn::u7Type )
+                trackEvents.emplace_back( TrackEvent{ tick, Message::Type::NoteOn, data0, data1 } );
+            else if ( channelMessage == NoteOff::u7Type )
+                trackEvents.emplace_back( TrackEvent{ tick, Message::Type::NoteOff, data0, data1 } );
+            else if ( channelMessage == ControlChange::u7Type )
+                trackEvents.emplace_back( TrackEvent{ tick, Message::Type::ControlChange, data0, data1 } );
+        }
+
+        trackI++;
+    }
+
+    // tracks were read one after another, so a stable sort on tick alone merges them with ties kept in track order
+    std::stable_sort( trackEvents.begin(), trackEvents.end(), []( const TrackEvent& lhs, const TrackEvent& rhs ) { return lhs.m_tick < rhs.m_tick; } );
+    std::stable_sort( tempoChanges.begin(), tempoChanges.end(), []( const TempoChange& lhs, const TempoChange& rhs ) { return lhs.m_tick < rhs.m_tick; } );
+
+    // SMPTE division is a fixed number of ticks per frame, tempo plays no part; otherwise walk the tempo map, default
+    // 120 bpm until the first change
+    const bool smpteTiming = ( division & 0x8000 ) != 0;
+    double smpteSecondsPerTick = 0;
+    if ( smpteTiming )
+    {
+        const int32_t framesPerSecond = -(int32_t)(int8_t)( division >> 8 );
+        const int32_t ticksPerFrame   = division & 0xFF;
+        if ( framesPerSecond <= 0 || ticksPerFrame == 0 )
+            return absl::InvalidArgumentError( fmt::format( FMTX( "MIDI file has an invalid SMPTE division {:#x}" ), division ) );
+
+        smpteSecondsPerTick = 1.0 / ( ( framesPerSecond == 29 ? 29.97 : (double)framesPerSecond ) * (double)ticksPerFrame );
+    }
+
+    FileReplay replay;
+    replay.m_events.reserve( trackEvents.size() );
+
+    std::size_t tempoI              = 0;
+    uint64_t    segmentStartTick    = 0;
+    double      segmentStartMicros  = 0;
+    uint32_t    microsPerQuarter    = 500000;
+    double      previousSeconds     = 0;
+    for ( const TrackEvent& trackEvent : trackEvents )
+    {
+        double seconds;
+        if ( smpteTiming )
+        {
+            seconds = (double)trackEvent.m_tick * smpteSecondsPerTick;
+        }
+        else
+        {
+            while ( tempoI < tempoChanges.size() && tempoChanges[tempoI].m_tick <= trackEvent.m_tick )
+            {
+                segmentStartMicros += (double)( tempoChanges[tempoI].m_tick - segmentStartTick ) * (double)microsPerQuarter / (double)division;
+                segmentStartTick    = tempoChanges[tempoI].m_tick;
+                microsPerQuarter    = tempoChanges[tempoI].m_microsecondsPerQuarter;
+                tempoI++;
+            }
+            seconds = ( segmentStartMicros + (double)( trackEvent.m_tick - segmentStartTick ) * (double)microsPerQuarter / (double)division ) * 1e-6;
+        }
+
+        const double sincePrevious = replay.m_events.empty() ? 0.0 : ( seconds - previousSeconds );
+        previousSeconds = seconds;
+
+        replay.m_events.emplace_back( Event{ Message( sincePrevious, trackEvent.m_type, trackEvent.m_data0, trackEvent.m_data1 ), seconds } );
+    }
+
+    return replay;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void FileReplay::enqueueUntil( MixThreadFeed& feed, const Clock::time_point fileStart, const Clock::time_point until )
+{
+    while ( m_nextEvent < m_events.size() )
+    {
+        const Event& event = m_events[m_nextEvent];
+
+        const Clock::time_point arrivalTime = fileStart + std::chrono::round< Clock::duration >( std::chrono::duration< double >( event.m_seconds ) );
+        if ( arrivalTime > until )
+            break;
+
+        feed.enqueue( event.m_msg, arrivalTime );
+        m_nextEvent++;
+    }
+}
+
+} // namespace midi
+} // namespace app
@@ -0,0 +1,52 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  a null MIDI device that plays a Standard MIDI File into a MixThreadFeed, standing in for the RtMidi callback so
+//  that timing-sensitive MIDI paths can be exercised without hardware or a driver
+//
+
+#pragma once
+
+#include "app/module.midi.feed.h"
+
+namespace app {
+namespace midi {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// format 0 or 1 files, metrical or SMPTE timing, tempo changes honoured across all tracks. only the messages a live
+// device would deliver as app::midi::Message survive - notes and controller changes - and each carries the seconds
+// since the message before it in m_time, as RtMidi's timeStamp does
+//
+struct FileReplay
+{
+    using Clock = MixThreadFeed::Clock;
+
+    struct Event
+    {
+        Message     m_msg;
+        double      m_seconds = 0;      // from the start of the file
+    };
+
+    static absl::StatusOr< FileReplay > load( const fs::path& midiFile );
+    static absl::StatusOr< FileReplay > parse( const uint8_t* data, const std::size_t dataSize );
+
+    ouro_nodiscard const std::vector< Event >& getEvents() const { return m_events; }
+
+    // producer side of the feed; enqueue every event not yet played that falls at or before `until`, stamped with the
+    // arrival time the file gives it counting from `fileStart`. call as the clock moves on, as a device would deliver
+    void enqueueUntil( MixThreadFeed& feed, const Clock::time_point fileStart, const Clock::time_point until );
+
+    ouro_nodiscard bool finished() const { return m_nextEvent >= m_events.size(); }
+    void rewind() { m_nextEvent = 0; }
+
+private:
+
+    std::vector< Event >    m_events;
+    std::size_t             m_nextEvent = 0;
+};
+
+} // namespace midi
+} // namespace app
@@ -9,15 +9,28 @@
 #include "pch.h"
 
 #include "base/eventbus.h"
+#include "base/instrumentation.h"
+
+#include <bit>
 
 
 namespace base {
 
+// the worker queue currently being drained on this thread, if any; used to avoid waiting on ourselves when a worker
+// listener removes a listener on its own queue
+static thread_local uint32_t tlActiveWorkerQueue = 0;
+
+// set while the main thread is calling listeners, for the same reason
+static thread_local bool tlMainThreadDispatching = false;
+
 // ---------------------------------------------------------------------------------------------------------------------
-EventBus::EventBus()
+EventBus::EventBus( tf::Executor& workerExecutor )
+    : m_workerExecutor( workerExecutor )
 {
     m_pipes.reserve( 32 );
     m_alive = true;
+
+    m_notifierThread = std::make_unique<std::thread>( &EventBus::notifierThreadWorker, this );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -25,6 +38,16 @@ EventBus::~EventBus()
 {
     m_alive = false;
 
+    // stop the notifier first so it can't schedule any new worker drains
+    m_notifierQuit = true;
+    m_notifierSema.signal();
+    m_notifierThread->join();
+    m_notifierThread.reset();
+
+    // let any worker drains finish off what they're doing, they will stop calling listeners now we're not alive
+    while ( m_workerDrainsActive.load() > 0 )
+        std::this_thread::yield();
+
     // chew through any events in the pipe but don't notify listeners
     flushQueues( false );
 
@@ -53,14 +76,48 @@ absl::Status EventBus::registerEventID( const EventID& id, const std::size_t eve
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-EventListenerID EventBus::addListener( const EventID& id, const EventListenerFn& mainThreadFn )
+uint32_t EventBus::allocateChannelSlot()
+{
+    static std::atomic_uint32_t nextChannelSlot = 0;
+
+    const uint32_t channelSlot = nextChannelSlot++;
+    ABSL_ASSERT( channelSlot < cMaxChannels );
+    return channelSlot;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+EventListenerID EventBus::addListenerInternal( const EventID& id, const EventHandler& handler, const EventListenerFn& listenerFn, const EventDelivery& delivery )
 {
+    ABSL_ASSERT( handler.isValid() || listenerFn );
+
     EventPipe* pipe = getPipeByID( id );
     if ( pipe )
     {
+        uint32_t queueIndex = cMainThreadQueue;
+        if ( !delivery.isMainThread() )
+        {
+            queueIndex = getOrCreateWorkerQueue( delivery.m_workerQueue );
+            if ( queueIndex == cMainThreadQueue )
+            {
+                blog::error::core( FMTX( "EventBus::addListener - out of worker queues, unable to create [{}]" ), delivery.m_workerQueue );
+                return EventListenerID::invalid();
+            }
+        }
+
         EventListenerID newListenerID = EventListenerID( m_listenerUID++ );
-        pipe->m_listeners.emplace( newListenerID, mainThreadFn );
-        m_registeredListenerIDs.emplace( newListenerID, id );
+        {
+            std::scoped_lock<std::mutex> tableLock( pipe->m_listenersMutex );
+
+            auto newTable = std::make_shared< ListenerTable >( *pipe->m_listeners );
+            newTable->m_listeners.emplace_back( Listener{ newListenerID, queueIndex, handler, listenerFn } );
+            newTable->m_queueMask |= ( 1U << queueIndex );
+
+            pipe->publishListeners( std::move( newTable ) );
+        }
+        {
+            std::scoped_lock<std::mutex> registeredLock( m_registeredListenerMutex );
+            m_registeredListenerIDs.emplace( newListenerID, id );
+        }
         return newListenerID;
     }
     return EventListenerID::invalid();
@@ -69,33 +126,322 @@ EventListenerID EventBus::addListener( const EventID& id, const EventListenerFn&
 // ---------------------------------------------------------------------------------------------------------------------
 absl::Status EventBus::removeListener( const EventListenerID& listener )
 {
-    auto it = m_registeredListenerIDs.find( listener );
-    if ( it == m_registeredListenerIDs.end() )
-        return absl::NotFoundError( "EventBus::RemoveListener - no registered listener found" );
+    std::optional< EventID > listenerEventID;
+    {
+        std::scoped_lock<std::mutex> registeredLock( m_registeredListenerMutex );
+
+        auto it = m_registeredListenerIDs.find( listener );
+        if ( it == m_registeredListenerIDs.end() )
+            return absl::NotFoundError( "EventBus::RemoveListener - no registered listener found" );
+
+        listenerEventID = it->second;
+        m_registeredListenerIDs.erase( it );
+    }
 
-    EventID listenerEventID = it->second;
-    EventPipe* pipe = getPipeByID( listenerEventID );
+    EventPipe* pipe = getPipeByID( listenerEventID.value() );
     if ( !pipe )
     {
-        return absl::NotFoundError( fmt::format( FMTX( "EventBus::RemoveListener - event ID [{}] not found" ), listenerEventID.name() ) );
+        return absl::NotFoundError( fmt::format( FMTX( "EventBus::RemoveListener - event ID [{}] not found" ), listenerEventID->name() ) );
     }
 
-    pipe->m_listeners.erase( listener );
-    m_registeredListenerIDs.erase( listener );
+    uint32_t removedFromQueue = cMainThreadQueue;
+    {
+        std::scoped_lock<std::mutex> tableLock( pipe->m_listenersMutex );
+
+        auto newTable = std::make_shared< ListenerTable >();
+        newTable->m_listeners.reserve( pipe->m_listeners->m_listeners.size() );
+
+        for ( const auto& existing : pipe->m_listeners->m_listeners )
+        {
+            if ( existing.m_id == listener )
+            {
+                removedFromQueue = existing.m_queueIndex;
+                continue;
+            }
+            newTable->m_listeners.emplace_back( existing );
+            newTable->m_queueMask |= ( 1U << existing.m_queueIndex );
+        }
+
+        pipe->publishListeners( std::move( newTable ) );
+    }
+
+    // every queue fetches the listener table under its dispatch lock, so passing through it here means any
+    // in-progress call has finished and future calls will see the table without this listener in it
+    if ( removedFromQueue == cMainThreadQueue )
+    {
+        if ( !tlMainThreadDispatching )
+        {
+            std::scoped_lock<std::mutex> dispatchLock( m_mainThreadDispatchMutex );
+        }
+    }
+    else if ( removedFromQueue != tlActiveWorkerQueue )
+    {
+        std::scoped_lock<std::mutex> dispatchLock( m_workerQueues[removedFromQueue]->m_dispatchMutex );
+    }
 
     return absl::OkStatus();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void EventBus::mainThreadDispatch()
+std::size_t EventBus::mainThreadDispatch()
 {
-    flushQueues( true );
+    // clear before flushing; anything sent while we dispatch will wake the main loop again
+    m_mainThreadWakePending.store( false, std::memory_order_release );
+
+    return flushQueues( true );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void EventBus::flushQueues( bool notifyListeners )
+void EventBus::getStatistics( std::vector< EventStatistics >& result ) const
 {
-    for ( auto kv : m_pipes )
+    result.clear();
+    result.reserve( m_pipes.size() );
+
+    for ( const auto& kv : m_pipes )
+    {
+        const EventPipe* pipe = kv.second;
+
+        EventStatistics& stats = result.emplace_back();
+        stats.m_name        = pipe->m_id.name();
+        stats.m_sent        = pipe->m_statSent.load( std::memory_order_relaxed );
+        stats.m_delivered   = pipe->m_statDelivered.load( std::memory_order_relaxed );
+        stats.m_dropped     = pipe->m_statDropped.load( std::memory_order_relaxed );
+        stats.m_highWater   = pipe->m_statHighWater.load( std::memory_order_relaxed );
+        stats.m_capacity    = static_cast<uint32_t>( pipe->m_maxEvents );
+        stats.m_dispatchUs  = pipe->m_statDispatchUs.load( std::memory_order_relaxed );
+    }
+
+    std::sort( result.begin(), result.end(), []( const EventStatistics& lhs, const EventStatistics& rhs )
+        {
+            return std::strcmp( lhs.m_name, rhs.m_name ) < 0;
+        });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint8_t* EventBus::acquireEventMemory( EventPipe* pipe )
+{
+    uint8_t* eventMemoryBlock = nullptr;
+    if ( !pipe->m_eventMemoryQueue.try_dequeue( eventMemoryBlock ) )
+    {
+        // only shout about the first time a pipe runs dry, the counter tracks the rest
+        if ( pipe->m_statDropped.fetch_add( 1, std::memory_order_relaxed ) == 0 )
+        {
+            blog::error::core( FMTX( "EventBus pool for [{}] exhausted ({} events), dropping sends" ), pipe->m_id.name(), pipe->m_maxEvents );
+        }
+        return nullptr;
+    }
+
+    const uint32_t inFlight = pipe->m_statInFlight.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    uint32_t highWater = pipe->m_statHighWater.load( std::memory_order_relaxed );
+    while ( inFlight > highWater &&
+            !pipe->m_statHighWater.compare_exchange_weak( highWater, inFlight, std::memory_order_relaxed ) )
+    {
+    }
+
+    return eventMemoryBlock;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void EventBus::releaseEvent( EventPipe* pipe, IEvent* eventInstance )
+{
+    // last target out returns the block to the pool
+    if ( pipe->getPendingTargets( eventInstance ).fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+        return;
+
+    eventInstance->~IEvent();
+    pipe->m_statInFlight.fetch_sub( 1, std::memory_order_relaxed );
+    pipe->m_eventMemoryQueue.enqueue( (uint8_t*)eventInstance );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void EventBus::routeEvent( EventPipe* pipe, IEvent* eventInstance )
+{
+    pipe->m_statSent.fetch_add( 1, std::memory_order_relaxed );
+
+    // events go only to the queues that have listeners; with nobody listening at all, the main thread queue takes it
+    // so the block is still returned to the pool on the next dispatch
+    uint32_t queueMask = pipe->m_queueMask.load( std::memory_order_acquire );
+    if ( queueMask == 0 )
+        queueMask = ( 1U << cMainThreadQueue );
+
+    // set the full target count before anything is enqueued, a fast worker could otherwise release it early
+    pipe->getPendingTargets( eventInstance ).store( std::popcount( queueMask ), std::memory_order_release );
+
+    uint32_t workerMask = queueMask & ~( 1U << cMainThreadQueue );
+    while ( workerMask != 0 )
+    {
+        const uint32_t queueIndex = std::countr_zero( workerMask );
+        workerMask &= workerMask - 1;
+
+        // starting the drain may allocate and lock inside the executor, so that is left to the notifier
+        WorkerQueue* queue = m_workerQueues[queueIndex].get();
+        queue->m_queue.enqueue( { pipe, eventInstance } );
+        if ( !queue->m_drainRequested.exchange( true ) )
+            signalNotifier();
+    }
+
+    if ( ( queueMask & ( 1U << cMainThreadQueue ) ) == 0 )
+        return;
+
+    pipe->m_queue.enqueue( eventInstance );
+
+    // nudge a main loop that may be sleeping between frames, once per dispatch
+    requestMainThreadWake();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void EventBus::requestMainThreadWake()
+{
+    if ( m_mainThreadWake.load( std::memory_order_acquire ) == nullptr )
+        return;
+
+    if ( !m_mainThreadWakePending.exchange( true ) )
+    {
+        m_mainThreadWakeRequested = true;
+        signalNotifier();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void EventBus::signalNotifier()
+{
+    if ( !m_notifierPending.exchange( true ) )
+        m_notifierSema.signal();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void EventBus::notifierThreadWorker()
+{
+    OuroveonThreadScope ots( OURO_THREAD_PREFIX "EventBus::Notifier" );
+
+    for ( ;; )
+    {
+        m_notifierSema.wait();
+
+        // clear before looking at the requests; a sender arriving after this signals again
+        m_notifierPending = false;
+
+        if ( m_notifierQuit )
+            break;
+
+        const uint32_t queueCount = m_workerQueueCount.load();
+        for ( uint32_t queueIndex = 1; queueIndex < queueCount; queueIndex++ )
+        {
+            WorkerQueue* queue = m_workerQueues[queueIndex].get();
+            if ( queue->m_drainRequested.exchange( false ) )
+                scheduleWorkerDrain( queue );
+        }
+
+        if ( m_mainThreadWakeRequested.exchange( false ) )
+        {
+            if ( const MainThreadWakeFn wakeFn = m_mainThreadWake.load( std::memory_order_acquire ) )
+                wakeFn();
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint64_t EventBus::dispatchToListeners( EventPipe* pipe, const uint32_t queueIndex, const IEvent& eventInstance )
+{
+    const ListenerTablePtr listeners = pipe->getListeners();
+    if ( ( listeners->m_queueMask & ( 1U << queueIndex ) ) == 0 )
+        return 0;
+
+    const auto dispatchStart = std::chrono::steady_clock::now();
+
+    uint64_t deliveries = 0;
+    for ( const auto& lst : listeners->m_listeners )
+    {
+        if ( lst.m_queueIndex != queueIndex )
+            continue;
+
+        if ( lst.m_handler.isValid() )
+            lst.m_handler.m_thunk( lst.m_handler.m_context, eventInstance );
+        else
+            lst.m_fn( eventInstance );
+
+        deliveries++;
+    }
+
+    const auto dispatchUs = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - dispatchStart );
+
+    pipe->m_statDelivered.fetch_add( deliveries, std::memory_order_relaxed );
+    pipe->m_statDispatchUs.fetch_add( dispatchUs.count(), std::memory_order_relaxed );
+
+    return deliveries;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint32_t EventBus::getOrCreateWorkerQueue( const std::string& queueName )
+{
+    std::scoped_lock<std::mutex> queueLock( m_workerQueueMutex );
+
+    const uint32_t queueCount = m_workerQueueCount.load();
+    for ( uint32_t queueIndex = 1; queueIndex < queueCount; queueIndex++ )
+    {
+        if ( m_workerQueues[queueIndex]->m_name == queueName )
+            return queueIndex;
+    }
+
+    if ( queueCount >= cMaxQueues )
+        return cMainThreadQueue;
+
+    m_workerQueues[queueCount] = std::make_unique< WorkerQueue >( queueName, queueCount );
+    m_workerQueueCount = queueCount + 1;
+
+    blog::core( FMTX( "created event worker queue [{}]" ), queueName );
+    return queueCount;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void EventBus::scheduleWorkerDrain( WorkerQueue* queue )
+{
+    if ( queue->m_drainScheduled.exchange( true, std::memory_order_acq_rel ) )
+        return;
+
+    m_workerDrainsActive++;
+    m_workerExecutor.silent_async( [this, queue]()
+        {
+            drainWorkerQueue( queue );
+            m_workerDrainsActive--;
+        });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void EventBus::drainWorkerQueue( WorkerQueue* queue )
+{
+    tlActiveWorkerQueue = queue->m_queueIndex;
+
+    for ( ;; )
+    {
+        WorkerQueue::QueuedEvent queued;
+        while ( queue->m_queue.try_dequeue( queued ) )
+        {
+            if ( m_alive )
+            {
+                std::scoped_lock<std::mutex> dispatchLock( queue->m_dispatchMutex );
+                dispatchToListeners( queued.m_pipe, queue->m_queueIndex, *queued.m_event );
+            }
+            releaseEvent( queued.m_pipe, queued.m_event );
+        }
+
+        // clear the flag, then check nothing slipped in between the last dequeue and now; if it did, and nobody
+        // else has claimed the drain in the meantime, keep going
+        queue->m_drainScheduled.store( false, std::memory_order_release );
+        if ( queue->m_queue.size_approx() == 0 ||
+             queue->m_drainScheduled.exchange( true, std::memory_order_acq_rel ) )
+            break;
+    }
+
+    tlActiveWorkerQueue = cMainThreadQueue;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t EventBus::flushQueues( bool notifyListeners )
+{
+    std::size_t deliveries = 0;
+
+    for ( const auto& kv : m_pipes )
     {
         EventPipe* pipe = kv.second;
 
@@ -104,15 +450,31 @@ void EventBus::flushQueues( bool notifyListeners )
         {
             if ( notifyListeners )
             {
-                for ( auto lst : pipe->m_listeners )
-                {
-                    lst.second( *eventInstance );
-                }
+                std::scoped_lock<std::mutex> dispatchLock( m_mainThreadDispatchMutex );
+
+                tlMainThreadDispatching = true;
+                deliveries += dispatchToListeners( pipe, cMainThreadQueue, *eventInstance );
+                tlMainThreadDispatching = false;
+            }
+            releaseEvent( pipe, eventInstance );
+        }
+    }
+
+    // only on shutdown; worker drains have stopped so return anything still waiting in their queues
+    if ( !notifyListeners )
+    {
+        const uint32_t queueCount = m_workerQueueCount.load();
+        for ( uint32_t queueIndex = 1; queueIndex < queueCount; queueIndex++ )
+        {
+            WorkerQueue::QueuedEvent queued;
+            while ( m_workerQueues[queueIndex]->m_queue.try_dequeue( queued ) )
+            {
+                releaseEvent( queued.m_pipe, queued.m_event );
             }
-            eventInstance->~IEvent();
-            pipe->m_eventMemoryQueue.enqueue( (uint8_t*)eventInstance );
         }
     }
+
+    return deliveries;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -135,9 +497,13 @@ base::EventBus::EventPipe* EventBus::getPipeByID( const EventID& id )
 // ---------------------------------------------------------------------------------------------------------------------
 EventBus::EventPipe::EventPipe( const EventID& id, std::size_t eventSize, std::size_t maxEvents )
     : m_id( id )
+    , m_listeners( std::make_shared< ListenerTable >() )
     , m_eventMemoryQueue( maxEvents )
+    , m_eventSize( eventSize )
+    , m_maxEvents( maxEvents )
+    , m_pendingTargets( std::make_unique< std::atomic_uint32_t[] >( maxEvents ) )
 {
-    m_eventMemoryBlock = mem::alloc16To<uint8_t>( maxEvents * eventSize, 0 );
+    m_eventMemoryBlock = mem::alloc16To<uint8_t>( maxEvents * eventSize, 0, mem::Tag::EventBus );
 
     // store each of the allocated event-sized lumps in the queue
     uint8_t* blockAddress = m_eventMemoryBlock;
@@ -153,8 +519,7 @@ EventBus::EventPipe::EventPipe( const EventID& id, std::size_t eventSize, std::s
 // ---------------------------------------------------------------------------------------------------------------------
 EventBus::EventPipe::~EventPipe()
 {
-    mem::free16( m_eventMemoryBlock );
+    mem::free16( m_eventMemoryBlock, mem::Tag::EventBus );
 }
 
 } // namespace base
-
@@ -6,6 +6,13 @@
 //
 //  event bus is a simple, multithread-friendly way for app systems to exchange generic messages
 //
+//  listeners choose where they are called from; either the main thread (pumped by the main loop via mainThreadDispatch)
+//  or a named worker queue, which is drained in-order on the task executor as soon as events arrive. each event
+//  instance is shared between all the targets it was routed to and returned to its pool once the last one is done
+//
+//  sending never locks or calls out; events can be sent from the audio thread. anything that might block - starting a
+//  worker drain on the executor, waking the main loop - is handed to the bus's notifier thread via a semaphore
+//
 
 #pragma once
 #include "base/construction.h"
@@ -50,6 +57,34 @@ private:
 struct _event_listener_id {};
 using EventListenerID = base::id::Simple<_event_listener_id, uint32_t, 1, 0>;
 
+// ---------------------------------------------------------------------------------------------------------------------
+// where a listener wants to be called from; worker queues are created on first use and identified by name, all
+// listeners bound to the same queue are called serially, in the order events were sent
+//
+struct EventDelivery
+{
+    ouro_nodiscard static EventDelivery mainThread() { return EventDelivery{}; }
+    ouro_nodiscard static EventDelivery worker( std::string_view queueName ) { return EventDelivery{ std::string( queueName ) }; }
+
+    ouro_nodiscard bool isMainThread() const { return m_workerQueue.empty(); }
+
+    std::string     m_workerQueue;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// snapshot of the running counters kept for each registered event type
+//
+struct EventStatistics
+{
+    const char*     m_name          = nullptr;
+    uint64_t        m_sent          = 0;    // events successfully queued
+    uint64_t        m_delivered     = 0;    // listener invocations across all targets
+    uint64_t        m_dropped       = 0;    // send() calls that failed because the event pool was exhausted
+    uint32_t        m_highWater     = 0;    // most events alive in the pool at once
+    uint32_t        m_capacity      = 0;    // size of the event pool
+    uint64_t        m_dispatchUs    = 0;    // total time spent inside listeners
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 // base class for an event. inherit off this to define your own (or rather, use CREATE_EVENT_BEGIN / CREATE_EVENT_END)
 //
@@ -59,6 +94,20 @@ struct IEvent
     virtual const EventID& getID() const = 0;
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+// type-erased handler; a free function and an opaque context pointer, so storing one never allocates. built by
+// EventBus::addHandler from a capture-less lambda that receives the context and the event already cast to its type
+//
+struct EventHandler
+{
+    using Thunk = void(*)( void* context, const IEvent& eventRef );
+
+    ouro_nodiscard constexpr bool isValid() const { return m_thunk != nullptr; }
+
+    Thunk           m_thunk     = nullptr;
+    void*           m_context   = nullptr;
+};
+
 #define CREATE_EVENT_BEGIN(_evtname)    namespace events {                                                          \
                                         struct _evtname final : public base::IEvent                                 \
                                         {                                                                           \
@@ -76,16 +125,19 @@ struct IEvent
 
 #define APP_EVENT_REGISTER( _evtname )  APP_EVENT_REGISTER_SPECIFIC( _evtname, 2048 )
 
+// bind an event to a member function on `this` called event_<EventName>( const events::EventName* ); the handler is
+// stored as a plain function pointer and context, the event reaches it already cast to the right type
 #define APP_EVENT_BIND_TO( _eventType )                                                                             \
-    m_eventLID_##_eventType = m_eventBusClient.addListener(                                                         \
-        events::_eventType::ID,                                                                                     \
-        [this]( const base::IEvent& eventPtr )                                                                      \
-        {                                                                                                           \
-            ABSL_ASSERT( eventPtr.getID() == events::_eventType::ID );                                              \
-            const events::_eventType* riffChangeEvent = dynamic_cast<const events::_eventType*>(&eventPtr);         \
-            ABSL_ASSERT( riffChangeEvent != nullptr );                                                              \
-            event_##_eventType( riffChangeEvent );                                                                  \
-        })
+    m_eventLID_##_eventType = m_eventBusClient.addHandler< events::_eventType >(                                    \
+        this,                                                                                                       \
+        []( auto* self, const events::_eventType& eventRef ) { self->event_##_eventType( &eventRef ); } )
+
+// as above but the handler is called on the named worker queue rather than the main thread
+#define APP_EVENT_BIND_TO_WORKER( _eventType, _queueName )                                                          \
+    m_eventLID_##_eventType = m_eventBusClient.addHandler< events::_eventType >(                                    \
+        this,                                                                                                       \
+        []( auto* self, const events::_eventType& eventRef ) { self->event_##_eventType( &eventRef ); },           \
+        base::EventDelivery::worker( _queueName ) )
 
 #define APP_EVENT_UNBIND( _eventType )                                                                                   \
     checkedCoreCall( fmt::format( FMTX("{{{}}} : [{}]"), std::source_location::current().function_name(), #_eventType ), \
@@ -101,7 +153,8 @@ struct EventBus
 {
     DECLARE_NO_COPY_NO_MOVE( EventBus );
 
-    EventBus();
+    // worker queues are drained on the given executor, which must outlive the bus
+    EventBus( tf::Executor& workerExecutor );
     ~EventBus();
 
     using EventListenerFn = std::function< void( const IEvent& ) >;
@@ -116,38 +169,127 @@ struct EventBus
     template< typename _eventType, typename... Args >
     bool send( Args&&... args )
     {
-        // push event into lockfree queue
-        EventPipe* pipe = getPipeByID( _eventType::ID );
+        EventPipe* pipe = getChannelPipe< _eventType >();
         if ( pipe )
         {
-            uint8_t* eventMemoryBlock = nullptr;
-            const bool eventMemoryOk = pipe->m_eventMemoryQueue.try_dequeue( eventMemoryBlock );
-            ABSL_ASSERT( eventMemoryOk );
-
-            // queue exhausted
-            if ( !eventMemoryOk )
+            // fetch a free block from the pool; returns null (and counts the drop) if it is exhausted
+            uint8_t* eventMemoryBlock = acquireEventMemory( pipe );
+            if ( eventMemoryBlock == nullptr )
                 return false;
 
-            memset( eventMemoryBlock, 0, sizeof( _eventType ) );
             _eventType* eventInstance = new (eventMemoryBlock) _eventType( std::forward<Args>( args )... );
 
-            pipe->m_queue.enqueue( eventInstance );
+            // hand off to each delivery target with listeners attached
+            routeEvent( pipe, eventInstance );
             return true;
         }
 
         return false;
     }
 
-    // register callback that will be called on main app thread
-    ouro_nodiscard EventListenerID addListener( const EventID& id, const EventListenerFn& mainThreadFn );
+    // register a typed handler; _handlerType must be a capture-less lambda taking ( _ownerType*, const _eventType& ),
+    // eg. []( MyClass* self, const events::Thing& evt ) { self->onThing( evt ); }
+    template< typename _eventType, typename _ownerType, typename _handlerType >
+    ouro_nodiscard EventListenerID addHandler( _ownerType* owner, _handlerType, const EventDelivery& delivery = EventDelivery::mainThread() )
+    {
+        static_assert( std::is_empty_v< _handlerType > && std::is_default_constructible_v< _handlerType >,
+            "event handlers must be capture-less; state belongs in the owner" );
+
+        EventHandler handler;
+        handler.m_thunk = []( void* context, const IEvent& eventRef )
+        {
+            ABSL_ASSERT( eventRef.getID() == _eventType::ID );
+            _handlerType{}( static_cast<_ownerType*>( context ), static_cast<const _eventType&>( eventRef ) );
+        };
+        handler.m_context = const_cast<void*>( static_cast<const void*>( owner ) );
+
+        return addListenerInternal( _eventType::ID, handler, nullptr, delivery );
+    }
+
+    // register an untyped callback that will be called from the chosen delivery target; kept for existing code, prefer
+    // addHandler for anything new as this allocates a std::function and leaves the cast to the listener
+    ouro_nodiscard EventListenerID addListener( const EventID& id, const EventListenerFn& listenerFn, const EventDelivery& delivery = EventDelivery::mainThread() )
+    {
+        return addListenerInternal( id, EventHandler{}, listenerFn, delivery );
+    }
+
+    // remove a listener; once this returns the listener is guaranteed not to be called again, unless it is being
+    // removed from inside a callback on the same queue, where the current call is of course still in progress
     absl::Status removeListener( const EventListenerID& listener );
 
-    // call from main thread to pump any waiting messages
-    void mainThreadDispatch();
+    // call from main thread to pump any waiting messages; returns how many main-thread listener calls were made
+    std::size_t mainThreadDispatch();
+
+    // optional hook, called when the main thread has new events waiting, so that a main loop sleeping between frames
+    // can be woken to dispatch them; repeat calls are coalesced until the next dispatch. it runs on the bus's notifier
+    // thread rather than the sender's, so it can be something that blocks briefly, eg. glfwPostEmptyEvent
+    using MainThreadWakeFn = void(*)();
+    void setMainThreadWake( const MainThreadWakeFn wakeFn ) { m_mainThreadWake.store( wakeFn, std::memory_order_release ); }
+
+    // ask for the main thread wake hook to be run, without any events being sent; safe to call from the audio thread
+    void requestMainThreadWake();
+
+    // fill the given vector with the current counters for every registered event type
+    void getStatistics( std::vector< EventStatistics >& result ) const;
 
 private:
 
-    void flushQueues( bool notifyListeners );
+    struct EventPipe;
+    struct WorkerQueue;
+
+    // queue index 0 is always the main thread, worker queues are indexed from 1
+    static constexpr uint32_t cMainThreadQueue  = 0;
+    static constexpr uint32_t cMaxQueues        = 32;
+
+    // every event type used with send<> gets a process-wide channel slot on first use; each bus caches the pipe for
+    // that slot, so sending resolves the pipe once per type rather than hashing the ID on every call
+    static constexpr uint32_t cMaxChannels      = 128;
+
+    static uint32_t allocateChannelSlot();
+
+    template< typename _eventType >
+    static uint32_t getChannelSlot()
+    {
+        static const uint32_t channelSlot = allocateChannelSlot();
+        return channelSlot;
+    }
+
+    template< typename _eventType >
+    EventPipe* getChannelPipe()
+    {
+        if ( !m_alive )
+            return nullptr;
+
+        std::atomic< EventPipe* >& channel = m_channelPipes[ getChannelSlot< _eventType >() ];
+
+        EventPipe* pipe = channel.load( std::memory_order_acquire );
+        if ( pipe == nullptr )
+        {
+            pipe = getPipeByID( _eventType::ID );
+            channel.store( pipe, std::memory_order_release );
+        }
+        return pipe;
+    }
+
+    EventListenerID addListenerInternal( const EventID& id, const EventHandler& handler, const EventListenerFn& listenerFn, const EventDelivery& delivery );
+
+    uint8_t* acquireEventMemory( EventPipe* pipe );
+    void releaseEvent( EventPipe* pipe, IEvent* eventInstance );
+
+    void routeEvent( EventPipe* pipe, IEvent* eventInstance );
+    uint64_t dispatchToListeners( EventPipe* pipe, const uint32_t queueIndex, const IEvent& eventInstance );
+
+    uint32_t getOrCreateWorkerQueue( const std::string& queueName );
+    void scheduleWorkerDrain( WorkerQueue* queue );
+    void drainWorkerQueue( WorkerQueue* queue );
+
+    // wake the notifier thread; lock-free, coalesced until the notifier next runs
+    void signalNotifier();
+    void notifierThreadWorker();
+
+    std::size_t flushQueues( bool notifyListeners );
+
+    tf::Executor&           m_workerExecutor;
 
     // marker that denotes the bus is ready for Send()ing on
     std::atomic_bool        m_alive = false;
@@ -155,9 +297,40 @@ private:
     // simple counter that hands out new EventListenerIDs
     std::atomic_uint32_t    m_listenerUID = 0;
 
+    std::atomic< MainThreadWakeFn > m_mainThreadWake            = nullptr;
+    std::atomic_bool                m_mainThreadWakePending     = false;    // set until the next main thread dispatch
+    std::atomic_bool                m_mainThreadWakeRequested   = false;    // for the notifier to act on
+
+    // runs the work senders can't do themselves; started with the bus, stopped before anything is torn down
+    std::unique_ptr< std::thread >  m_notifierThread;
+    mcc::LightweightSemaphore       m_notifierSema;
+    std::atomic_bool                m_notifierPending           = false;
+    std::atomic_bool                m_notifierQuit              = false;
+
+    // held while the main thread dispatches a single event, the main-thread counterpart to WorkerQueue::m_dispatchMutex
+    std::mutex                      m_mainThreadDispatchMutex;
+
 
     using EventQueue   = mcc::ConcurrentQueue< IEvent* >;
-    using ListenerMap  = absl::flat_hash_map< EventListenerID, EventListenerFn >;
+
+    // either a typed handler or, for older code, a std::function
+    struct Listener
+    {
+        EventListenerID     m_id;
+        uint32_t            m_queueIndex;
+        EventHandler        m_handler;
+        EventListenerFn     m_fn;
+    };
+
+    // immutable set of listeners for one event type; modifications build a new table and swap it in, so dispatch
+    // only ever holds a reference to the table it started with and never copies the listeners themselves. senders
+    // only need the queue mask, which is published alongside in EventPipe::m_queueMask so they never take the lock
+    struct ListenerTable
+    {
+        std::vector< Listener > m_listeners;
+        uint32_t                m_queueMask = 0;        // bit per queue index that has at least one listener
+    };
+    using ListenerTablePtr = std::shared_ptr< const ListenerTable >;
 
     // structure created on Register() to manage a single ID
     // holds all data for event dispatch and is guaranteed to exist until bus dtor
@@ -171,12 +344,72 @@ private:
         EventPipe( const EventID& id, const std::size_t eventSize, const std::size_t maxEvents );
         ~EventPipe();
 
-        EventID             m_id;
-        EventQueue          m_queue;
-        ListenerMap         m_listeners;
+        ouro_nodiscard ListenerTablePtr getListeners() const
+        {
+            std::scoped_lock<std::mutex> tableLock( m_listenersMutex );
+            return m_listeners;
+        }
+
+        // number of delivery targets still holding the event in the given block
+        ouro_nodiscard std::atomic_uint32_t& getPendingTargets( const IEvent* eventInstance )
+        {
+            return m_pendingTargets[ ( reinterpret_cast<const uint8_t*>( eventInstance ) - m_eventMemoryBlock ) / m_eventSize ];
+        }
+
+        EventID                     m_id;
+        EventQueue                  m_queue;                // main thread queue
+
+        mutable std::mutex          m_listenersMutex;
+        ListenerTablePtr            m_listeners;
+        std::atomic_uint32_t        m_queueMask = 0;        // copy of m_listeners->m_queueMask, for senders
+
+        // swap in a new table; call with m_listenersMutex held
+        void publishListeners( ListenerTablePtr&& newTable )
+        {
+            m_queueMask.store( newTable->m_queueMask, std::memory_order_release );
+            m_listeners = std::move( newTable );
+        }
+
+        MemoryBlockQueue            m_eventMemoryQueue;
+        uint8_t*                    m_eventMemoryBlock;
+        std::size_t                 m_eventSize;
+        std::size_t                 m_maxEvents;
+        std::unique_ptr< std::atomic_uint32_t[] >
+                                    m_pendingTargets;
+
+        std::atomic_uint64_t        m_statSent          = 0;
+        std::atomic_uint64_t        m_statDelivered     = 0;
+        std::atomic_uint64_t        m_statDropped       = 0;
+        std::atomic_uint64_t        m_statDispatchUs    = 0;
+        std::atomic_uint32_t        m_statInFlight      = 0;
+        std::atomic_uint32_t        m_statHighWater     = 0;
+    };
+
+    // a named queue of events bound for listeners that asked to be called off the main thread; at most one drain
+    // task per queue is ever running on the executor, which keeps delivery serial and in order
+    struct WorkerQueue
+    {
+        DECLARE_NO_COPY_NO_MOVE( WorkerQueue );
 
-        MemoryBlockQueue    m_eventMemoryQueue;
-        uint8_t*            m_eventMemoryBlock;
+        WorkerQueue( const std::string& name, const uint32_t queueIndex )
+            : m_name( name )
+            , m_queueIndex( queueIndex )
+        {}
+
+        struct QueuedEvent
+        {
+            EventPipe*      m_pipe;
+            IEvent*         m_event;
+        };
+
+        std::string                             m_name;
+        uint32_t                                m_queueIndex;
+        mcc::ConcurrentQueue< QueuedEvent >     m_queue;
+        std::atomic_bool                        m_drainScheduled = false;
+        std::atomic_bool                        m_drainRequested = false;   // set by senders, for the notifier to act on
+
+        // held while a single event is being dispatched; lets removeListener wait out an in-progress call
+        std::mutex                              m_dispatchMutex;
     };
 
     EventPipe* getPipeByID( const EventID& id );
@@ -185,8 +418,18 @@ private:
     using EventIDByListenerID = absl::flat_hash_map< EventListenerID, EventID >;
 
     EventPipeByID           m_pipes;
+
+    std::array< std::atomic< EventPipe* >, cMaxChannels > m_channelPipes{};
+
+    std::mutex              m_registeredListenerMutex;
     EventIDByListenerID     m_registeredListenerIDs;
 
+    // fixed-size so queues can be looked up by index from workers without locking
+    std::mutex                                              m_workerQueueMutex;
+    std::array< std::unique_ptr< WorkerQueue >, cMaxQueues > m_workerQueues;
+    std::atomic_uint32_t                                    m_workerQueueCount = 1;     // index 0 reserved for main thread
+    std::atomic_int32_t                                     m_workerDrainsActive = 0;
+
 };
 using EventBusPtr = std::shared_ptr<EventBus>;
 using EventBusWeakPtr = std::weak_ptr<EventBus>;
@@ -213,12 +456,21 @@ struct EventBusClient
         return m_bus.lock()->send< _eventType >( std::forward<Args>( args )... );
     }
 
-    ouro_nodiscard EventListenerID addListener( const EventID& id, const EventBus::EventListenerFn& mainThreadFn )
+    ouro_nodiscard EventListenerID addListener( const EventID& id, const EventBus::EventListenerFn& listenerFn, const EventDelivery& delivery = EventDelivery::mainThread() )
+    {
+        if ( m_bus.expired() )
+            return EventListenerID::invalid();
+
+        return m_bus.lock()->addListener( id, listenerFn, delivery );
+    }
+
+    template< typename _eventType, typename _ownerType, typename _handlerType >
+    ouro_nodiscard EventListenerID addHandler( _ownerType* owner, _handlerType handlerFn, const EventDelivery& delivery = EventDelivery::mainThread() )
     {
         if ( m_bus.expired() )
             return EventListenerID::invalid();
 
-        return m_bus.lock()->addListener( id, mainThreadFn );
+        return m_bus.lock()->addHandler< _eventType >( owner, handlerFn, delivery );
     }
 
     absl::Status removeListener( const EventListenerID& listener )
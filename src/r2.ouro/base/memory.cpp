@@ -0,0 +1,87 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  per-subsystem memory accounting
+//
+
+#include "pch.h"
+
+#include "base/memory.h"
+#include "base/text.h"
+#include "base/utils.h"
+
+namespace mem {
+namespace detail {
+
+std::array< TagCounters, cTagCount > gTagCounters;
+
+} // namespace detail
+
+// ---------------------------------------------------------------------------------------------------------------------
+Snapshot takeSnapshot()
+{
+    Snapshot result;
+
+    for ( std::size_t tagI = 0; tagI < cTagCount; tagI++ )
+    {
+        const TagCounters& counters = detail::gTagCounters[tagI];
+        TagSnapshot& tagSnapshot    = result.m_tags[tagI];
+
+        tagSnapshot.m_bytes            = counters.m_bytes.load( std::memory_order_relaxed );
+        tagSnapshot.m_bytesPeak        = counters.m_bytesPeak.load( std::memory_order_relaxed );
+        tagSnapshot.m_allocations      = counters.m_allocations.load( std::memory_order_relaxed );
+        tagSnapshot.m_allocationsTotal = counters.m_allocationsTotal.load( std::memory_order_relaxed );
+    }
+
+    // the warehouse does almost all of its allocation inside sqlite, which keeps its own books
+    {
+        TagSnapshot& warehouse = result.m_tags[(size_t)Tag::Warehouse];
+        warehouse.m_bytes     += sqlite3_memory_used();
+        warehouse.m_bytesPeak += sqlite3_memory_highwater( 0 );
+    }
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void logSnapshot( const Snapshot& snapshot )
+{
+    blog::core( FMTX( "memory | {:<10} | {:>12} | {:>12} | {:>10} | {:>12}" ), "tag", "live", "peak", "allocs", "allocs ever" );
+
+    for ( std::size_t tagI = 0; tagI < cTagCount; tagI++ )
+    {
+        const TagSnapshot& tagSnapshot = snapshot.m_tags[tagI];
+        if ( tagSnapshot.m_bytesPeak == 0 && tagSnapshot.m_allocationsTotal == 0 )
+            continue;
+
+        blog::core( FMTX( "memory | {:<10} | {:>12} | {:>12} | {:>10} | {:>12}" ),
+            cTagNames[tagI],
+            base::humaniseByteSize( "", (uint64_t)std::max< int64_t >( tagSnapshot.m_bytes, 0 ) ),
+            base::humaniseByteSize( "", (uint64_t)std::max< int64_t >( tagSnapshot.m_bytesPeak, 0 ) ),
+            tagSnapshot.m_allocations,
+            tagSnapshot.m_allocationsTotal );
+    }
+
+    blog::core( FMTX( "memory | {:<10} | {:>12}" ), "total", base::humaniseByteSize( "", (uint64_t)std::max< int64_t >( snapshot.totalBytes(), 0 ) ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static void* imguiTaggedAlloc( size_t bytes, void* )
+{
+    return alloc16< uint8_t >( bytes, Tag::UI );
+}
+
+static void imguiTaggedFree( void* ptr, void* )
+{
+    free16( ptr, Tag::UI );
+}
+
+void installImGuiAllocator()
+{
+    ImGui::SetAllocatorFunctions( &imguiTaggedAlloc, &imguiTaggedFree, nullptr );
+}
+
+} // namespace mem
@@ -0,0 +1,111 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  per-subsystem memory accounting; allocations made through mem:: carry a tag and the live byte / allocation
+//  counts for each tag are kept in relaxed atomics, cheap enough to leave running in release builds
+//
+
+#pragma once
+
+namespace mem {
+
+// ---------------------------------------------------------------------------------------------------------------------
+enum class Tag : uint8_t
+{
+    General,
+    Stems,                  // decoded stem audio and per-stem working data
+    Riffs,                  // riff assembly, rendering and export
+    Warehouse,              // sampled from sqlite's own allocator rather than tracked directly
+    EventBus,
+    Sketch,                 // sketchbook CPU-side image buffers
+    Recorder,               // disk / stream recording buffers
+    Audio,                  // audio engine, effects and analysis buffers
+    UI,                     // ImGui / ImPlot
+};
+
+static constexpr std::size_t cTagCount = 9;
+static constexpr std::array< const char*, cTagCount > cTagNames{ {
+    "General",
+    "Stems",
+    "Riffs",
+    "Warehouse",
+    "EventBus",
+    "Sketch",
+    "Recorder",
+    "Audio",
+    "UI",
+} };
+inline const char* getTagName( const Tag tag )
+{
+    return cTagNames[(size_t)tag];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct TagCounters
+{
+    std::atomic_int64_t     m_bytes             = 0;
+    std::atomic_int64_t     m_bytesPeak         = 0;
+    std::atomic_int64_t     m_allocations       = 0;    // currently outstanding
+    std::atomic_uint64_t    m_allocationsTotal  = 0;    // ever made
+};
+
+namespace detail { extern std::array< TagCounters, cTagCount > gTagCounters; }
+
+inline void trackAlloc( const Tag tag, const std::size_t bytes )
+{
+    TagCounters& counters = detail::gTagCounters[(size_t)tag];
+
+    const int64_t bytesNow = counters.m_bytes.fetch_add( (int64_t)bytes, std::memory_order_relaxed ) + (int64_t)bytes;
+    counters.m_allocations.fetch_add( 1, std::memory_order_relaxed );
+    counters.m_allocationsTotal.fetch_add( 1, std::memory_order_relaxed );
+
+    int64_t bytesPeak = counters.m_bytesPeak.load( std::memory_order_relaxed );
+    while ( bytesNow > bytesPeak &&
+            !counters.m_bytesPeak.compare_exchange_weak( bytesPeak, bytesNow, std::memory_order_relaxed ) )
+    {
+    }
+}
+
+inline void trackFree( const Tag tag, const std::size_t bytes )
+{
+    TagCounters& counters = detail::gTagCounters[(size_t)tag];
+
+    counters.m_bytes.fetch_sub( (int64_t)bytes, std::memory_order_relaxed );
+    counters.m_allocations.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct TagSnapshot
+{
+    int64_t                 m_bytes             = 0;
+    int64_t                 m_bytesPeak         = 0;
+    int64_t                 m_allocations       = 0;
+    uint64_t                m_allocationsTotal  = 0;
+};
+
+struct Snapshot
+{
+    std::array< TagSnapshot, cTagCount >    m_tags;
+
+    ouro_nodiscard int64_t totalBytes() const
+    {
+        int64_t result = 0;
+        for ( const auto& tag : m_tags )
+            result += tag.m_bytes;
+        return result;
+    }
+};
+
+// read all counters; each tag is internally consistent but tags are not read atomically with respect to each other
+ouro_nodiscard Snapshot takeSnapshot();
+
+// write a table of the snapshot to the log, one line per tag that has ever seen an allocation
+void logSnapshot( const Snapshot& snapshot );
+
+// route ImGui (and so ImPlot) allocations through rpmalloc, tagged as Tag::UI; call before any context is created
+void installImGuiAllocator();
+
+} // namespace mem
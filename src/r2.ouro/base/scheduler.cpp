@@ -0,0 +1,363 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  shared scheduler for background I/O work
+//
+
+#include "pch.h"
+#include "base/scheduler.h"
+#include "base/instrumentation.h"
+
+namespace base {
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct WorkScheduler::CancellationToken::State
+{
+    std::atomic_bool                m_cancelled = false;
+    std::atomic< WorkScheduler* >   m_scheduler = nullptr;     // the last scheduler this was used with, to purge on cancel
+
+    std::mutex                      m_outstandingMutex;
+    std::condition_variable         m_outstandingCVar;
+    uint32_t                        m_outstanding = 0;
+
+    void addOutstanding()
+    {
+        std::scoped_lock< std::mutex > outstandingLock( m_outstandingMutex );
+        m_outstanding++;
+    }
+
+    void finishOutstanding()
+    {
+        {
+            std::scoped_lock< std::mutex > outstandingLock( m_outstandingMutex );
+            ABSL_ASSERT( m_outstanding > 0 );
+            m_outstanding--;
+        }
+        m_outstandingCVar.notify_all();
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::CancellationToken::CancellationToken()
+    : m_state( std::make_shared< State >() )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::CancellationToken::cancel() const
+{
+    m_state->m_cancelled = true;
+
+    if ( WorkScheduler* scheduler = m_state->m_scheduler.load() )
+        scheduler->purgeCancelled();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool WorkScheduler::CancellationToken::isCancelled() const
+{
+    return m_state->m_cancelled.load( std::memory_order_relaxed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::CancellationToken::waitForWork() const
+{
+    std::unique_lock< std::mutex > outstandingLock( m_state->m_outstandingMutex );
+    m_state->m_outstandingCVar.wait( outstandingLock, [this]() { return m_state->m_outstanding == 0; } );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::Slot::Slot( Slot&& other ) noexcept
+    : m_scheduler( other.m_scheduler )
+    , m_lane( other.m_lane )
+    , m_token( std::move( other.m_token ) )
+{
+    other.m_scheduler = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::Slot::~Slot()
+{
+    if ( m_scheduler != nullptr )
+        m_scheduler->release( m_lane, m_token );
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::WorkScheduler( const uint32_t slots, std::shared_ptr< tf::WorkerInterface > workerInterface )
+    : m_slots( std::max( slots, cReservedInteractiveSlots + 1 ) )
+    , m_executor( m_slots, std::move( workerInterface ) )
+{
+    const uint32_t quarterSlots = std::max( m_slots / 4, 1U );
+    const uint32_t halfSlots    = std::max( m_slots / 2, 1U );
+
+    // interactive work can use everything; the background lanes are held back from each other as well as from it
+    m_lanes[Lane::Interactive].m_limits = { 3, m_slots      };
+    m_lanes[Lane::Export].m_limits      = { 2, 1            };
+    m_lanes[Lane::Prefetch].m_limits    = { 1, halfSlots    };
+    m_lanes[Lane::Sync].m_limits        = { 0, quarterSlots };
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::~WorkScheduler()
+{
+    waitForIdle();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::configureLane( const Lane::Enum lane, const LaneLimits& limits )
+{
+    std::scoped_lock< std::mutex > schedulerLock( m_mutex );
+
+    m_lanes[lane].m_limits = limits;
+    m_lanes[lane].m_limits.m_concurrency = std::max( limits.m_concurrency, 1U );
+
+    // a raised cap may let waiting work start
+    dispatchLocked();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::submit( const Lane::Enum lane, JobFn&& job, const CancellationToken& token )
+{
+    ABSL_ASSERT( job );
+    enqueue( lane, { std::move( job ), nullptr, token, std::chrono::steady_clock::now() } );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::Slot WorkScheduler::acquireSlot( const Lane::Enum lane, const CancellationToken& token )
+{
+    bool granted = false;
+    enqueue( lane, { nullptr, &granted, token, std::chrono::steady_clock::now() } );
+
+    // once cancelled, the ticket may already have been taken out by purgeCancelled() or dispatchLocked(); if not, it
+    // has to be removed here as it points at (granted) on this stack
+    {
+        std::unique_lock< std::mutex > schedulerLock( m_mutex );
+        m_stateCVar.wait( schedulerLock, [&]() { return granted || token.isCancelled(); } );
+
+        if ( !granted )
+        {
+            auto& tickets = m_lanes[lane].m_tickets;
+            const auto ticketIt = std::find_if( tickets.begin(), tickets.end(), [&]( const Ticket& ticket ) { return ticket.m_granted == &granted; } );
+            if ( ticketIt != tickets.end() )
+            {
+                tickets.erase( ticketIt );
+                m_lanes[lane].m_metrics.m_queued--;
+                m_lanes[lane].m_metrics.m_cancelled++;
+                token.m_state->finishOutstanding();
+            }
+            return Slot();
+        }
+    }
+
+    Slot slot;
+    slot.m_scheduler = this;
+    slot.m_lane      = lane;
+    slot.m_token     = token;
+    return slot;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::waitForIdle()
+{
+    std::unique_lock< std::mutex > schedulerLock( m_mutex );
+    m_stateCVar.wait( schedulerLock, [this]()
+        {
+            if ( m_running > 0 )
+                return false;
+            for ( const auto& laneState : m_lanes )
+            {
+                if ( !laneState.m_tickets.empty() )
+                    return false;
+            }
+            return true;
+        });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::LaneLimits WorkScheduler::getLaneLimits( const Lane::Enum lane ) const
+{
+    std::scoped_lock< std::mutex > schedulerLock( m_mutex );
+    return m_lanes[lane].m_limits;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorkScheduler::LaneMetrics WorkScheduler::getLaneMetrics( const Lane::Enum lane ) const
+{
+    std::scoped_lock< std::mutex > schedulerLock( m_mutex );
+    return m_lanes[lane].m_metrics;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::logStatistics() const
+{
+    META_FOREACH( Lane, lane )
+    {
+        const LaneLimits  limits  = getLaneLimits( lane );
+        const LaneMetrics metrics = getLaneMetrics( lane );
+
+        const uint64_t started       = metrics.m_completed + metrics.m_running;
+        const double   averageWaitMs = ( started > 0 ) ? ( (double)metrics.m_waitMicroseconds / (double)started / 1000.0 ) : 0.0;
+
+        blog::core( FMTX( "[sched:{:<11}] p{} x{} | {} submitted, {} completed, {} cancelled | queue peak {} | avg wait {:.1f}ms" ),
+            Lane::toString( lane ),
+            limits.m_priority,
+            limits.m_concurrency,
+            metrics.m_submitted,
+            metrics.m_completed,
+            metrics.m_cancelled,
+            metrics.m_queuedPeak,
+            averageWaitMs );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::enqueue( const Lane::Enum lane, Ticket&& ticket )
+{
+    ticket.m_token.m_state->addOutstanding();
+    ticket.m_token.m_state->m_scheduler = this;
+
+    std::scoped_lock< std::mutex > schedulerLock( m_mutex );
+
+    LaneState& laneState = m_lanes[lane];
+    laneState.m_metrics.m_submitted++;
+
+    // work arriving already cancelled never joins the queue
+    if ( ticket.m_token.isCancelled() )
+    {
+        laneState.m_metrics.m_cancelled++;
+        ticket.m_token.m_state->finishOutstanding();
+
+        return;
+    }
+
+    laneState.m_tickets.emplace_back( std::move( ticket ) );
+    laneState.m_metrics.m_queued++;
+    laneState.m_metrics.m_queuedPeak = std::max( laneState.m_metrics.m_queuedPeak, laneState.m_metrics.m_queued );
+
+    dispatchLocked();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::release( const Lane::Enum lane, const CancellationToken& token )
+{
+    {
+        std::scoped_lock< std::mutex > schedulerLock( m_mutex );
+
+        ABSL_ASSERT( m_running > 0 && m_lanes[lane].m_metrics.m_running > 0 );
+        m_running--;
+        m_lanes[lane].m_metrics.m_running--;
+        m_lanes[lane].m_metrics.m_completed++;
+
+        dispatchLocked();
+    }
+    m_stateCVar.notify_all();
+
+    token.m_state->finishOutstanding();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::purgeCancelled()
+{
+    {
+        std::scoped_lock< std::mutex > schedulerLock( m_mutex );
+
+        for ( auto& laneState : m_lanes )
+        {
+            auto& tickets = laneState.m_tickets;
+            for ( auto ticketIt = tickets.begin(); ticketIt != tickets.end(); )
+            {
+                if ( ticketIt->m_token.isCancelled() )
+                {
+                    laneState.m_metrics.m_queued--;
+                    laneState.m_metrics.m_cancelled++;
+                    ticketIt->m_token.m_state->finishOutstanding();
+
+                    ticketIt = tickets.erase( ticketIt );
+                }
+                else
+                {
+                    ++ticketIt;
+                }
+            }
+        }
+    }
+    m_stateCVar.notify_all();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorkScheduler::dispatchLocked()
+{
+    bool grantedAnySlots = false;     // or woke a cancelled slot waiter
+
+    for ( ;; )
+    {
+        if ( m_running >= m_slots )
+            break;
+
+        // best lane that has something waiting and room to run it
+        LaneState* bestLane = nullptr;
+        Lane::Enum bestLaneID = Lane::Interactive;
+        META_FOREACH( Lane, lane )
+        {
+            LaneState& laneState = m_lanes[lane];
+
+            if ( laneState.m_tickets.empty() ||
+                 laneState.m_metrics.m_running >= laneState.m_limits.m_concurrency )
+                continue;
+
+            if ( lane != Lane::Interactive && m_running >= m_slots - cReservedInteractiveSlots )
+                continue;
+
+            if ( bestLane == nullptr || laneState.m_limits.m_priority > bestLane->m_limits.m_priority )
+            {
+                bestLane   = &laneState;
+                bestLaneID = lane;
+            }
+        }
+        if ( bestLane == nullptr )
+            break;
+
+        Ticket ticket = std::move( bestLane->m_tickets.front() );
+        bestLane->m_tickets.pop_front();
+        bestLane->m_metrics.m_queued--;
+
+        // cancelled while queued but not purged yet; a slot waiter wakes to find its ticket gone
+        if ( ticket.m_token.isCancelled() )
+        {
+            bestLane->m_metrics.m_cancelled++;
+            ticket.m_token.m_state->finishOutstanding();
+            grantedAnySlots |= ( ticket.m_granted != nullptr );
+            continue;
+        }
+
+        m_running++;
+        bestLane->m_metrics.m_running++;
+        bestLane->m_metrics.m_waitMicroseconds += (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - ticket.m_queuedAt ).count();
+
+        if ( ticket.m_granted != nullptr )
+        {
+            *ticket.m_granted = true;
+            grantedAnySlots = true;
+        }
+        else
+        {
+            m_executor.silent_async( [this, bestLaneID, job = std::move( ticket.m_job ), token = std::move( ticket.m_token )]()
+                {
+                    {
+                        base::instr::ScopedEvent se( "sched", Lane::toString( bestLaneID ), base::instr::PresetColour::Cyan );
+                        job();
+                    }
+                    release( bestLaneID, token );
+                });
+        }
+    }
+
+    if ( grantedAnySlots )
+        m_stateCVar.notify_all();
+}
+
+} // namespace base
@@ -0,0 +1,170 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  shared scheduler for background I/O work - riff loading, stem prefetch, database sync, exports. work is
+//  filed into named lanes that each have a priority and a concurrency cap, then run on an executor of its own so that
+//  blocking network and disk work never occupies the app's compute executor
+//
+
+#pragma once
+
+#include "base/construction.h"
+#include "base/metaenum.h"
+
+namespace base {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// whenever a slot frees up it goes to the highest priority lane that has work waiting and is under its own cap. one
+// slot is only ever given to Interactive work, so however busy the background lanes get, a riff the user asked for
+// can always start straight away.
+//
+// work arrives either as a job, run on the scheduler's executor, or as a Slot - a lane place held by code that stays
+// on its own thread (eg. the warehouse worker) for the length of one unit of work, so that it still takes its turn
+//
+class WorkScheduler
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( WorkScheduler );
+
+#define _WORK_LANES(_action)    \
+      _action(Interactive)      \
+      _action(Prefetch)         \
+      _action(Sync)             \
+      _action(Export)
+    REFLECT_ENUM( Lane, uint32_t, _WORK_LANES );
+#undef _WORK_LANES
+
+    // slots kept back for Interactive work only
+    static constexpr uint32_t cReservedInteractiveSlots = 1;
+
+    struct LaneLimits
+    {
+        int32_t         m_priority          = 0;    // higher goes first
+        uint32_t        m_concurrency       = 1;    // most jobs + slots the lane can have running at once
+    };
+
+    struct LaneMetrics
+    {
+        uint32_t        m_queued            = 0;    // waiting to start, right now
+        uint32_t        m_queuedPeak        = 0;
+        uint32_t        m_running           = 0;
+
+        uint64_t        m_submitted         = 0;
+        uint64_t        m_completed         = 0;
+        uint64_t        m_cancelled         = 0;    // dropped before they started
+        uint64_t        m_waitMicroseconds  = 0;    // total time spent queued by everything that did start
+    };
+
+    // shared by whoever submits work and the work itself. cancelling drops anything submitted with the token that
+    // hasn't started yet; running work can poll isCancelled() to stop early. the token also counts what is still
+    // outstanding against it, so an owner can cancel then wait for all of its work to be finished with.
+    // tokens must not be cancelled after the scheduler they were used with has been destroyed
+    class CancellationToken
+    {
+    public:
+        CancellationToken();
+
+        void cancel() const;
+        ouro_nodiscard bool isCancelled() const;
+
+        // block until nothing submitted with this token is queued or running
+        void waitForWork() const;
+
+    private:
+        friend class WorkScheduler;
+
+        struct State;
+        std::shared_ptr< State >    m_state;
+    };
+
+    // one place in a lane, held until destruction. invalid if the token was cancelled before the place was given
+    class Slot
+    {
+    public:
+        DECLARE_NO_COPY( Slot );
+
+        Slot( Slot&& other ) noexcept;
+        ~Slot();
+
+        ouro_nodiscard bool isValid() const { return m_scheduler != nullptr; }
+
+    private:
+        friend class WorkScheduler;
+
+        Slot() = default;
+
+        WorkScheduler*              m_scheduler = nullptr;
+        Lane::Enum                  m_lane      = Lane::Interactive;
+        CancellationToken           m_token;
+    };
+
+    using JobFn = std::function< void() >;
+
+
+    // (slots) is the total that can run at once, and so the number of executor threads; lane limits are derived
+    // from it, see configureLane() to change them
+    WorkScheduler( const uint32_t slots, std::shared_ptr< tf::WorkerInterface > workerInterface = nullptr );
+
+    // waits for everything queued or running to finish
+    ~WorkScheduler();
+
+    void configureLane( const Lane::Enum lane, const LaneLimits& limits );
+
+
+    // queue (job) on (lane); it runs on the scheduler's executor once it gets a slot, unless (token) is cancelled first
+    void submit( const Lane::Enum lane, JobFn&& job, const CancellationToken& token = {} );
+
+    // block the calling thread until it can have a place in (lane)
+    ouro_nodiscard Slot acquireSlot( const Lane::Enum lane, const CancellationToken& token = {} );
+
+
+    // block until every lane is empty and idle
+    void waitForIdle();
+
+    ouro_nodiscard uint32_t getSlotCount() const { return m_slots; }
+    ouro_nodiscard LaneLimits getLaneLimits( const Lane::Enum lane ) const;
+    ouro_nodiscard LaneMetrics getLaneMetrics( const Lane::Enum lane ) const;
+
+    void logStatistics() const;
+
+private:
+
+    struct Ticket
+    {
+        JobFn                                   m_job;              // empty for a slot waiter
+        bool*                                   m_granted;          // set for a slot waiter, flipped when it may go
+        CancellationToken                       m_token;
+        std::chrono::steady_clock::time_point   m_queuedAt;
+    };
+
+    struct LaneState
+    {
+        LaneLimits                  m_limits;
+        LaneMetrics                 m_metrics;
+        std::deque< Ticket >        m_tickets;
+    };
+
+    void enqueue( const Lane::Enum lane, Ticket&& ticket );
+    void release( const Lane::Enum lane, const CancellationToken& token );
+
+    // drop queued work whose tokens have been cancelled
+    void purgeCancelled();
+
+    // hand out free slots to waiting work, best lanes first; m_mutex must be held
+    void dispatchLocked();
+
+
+    const uint32_t                              m_slots;
+
+    mutable std::mutex                          m_mutex;
+    std::condition_variable                     m_stateCVar;        // slot waiters and waitForIdle() watch this
+    std::array< LaneState, Lane::Count >        m_lanes;
+    uint32_t                                    m_running = 0;
+
+    tf::Executor                                m_executor;
+};
+
+} // namespace base
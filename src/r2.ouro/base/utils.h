@@ -8,23 +8,28 @@
 
 #pragma once
 
+#include "base/memory.h"
+
 // ---------------------------------------------------------------------------------------------------------------------
 namespace mem {
 
 // allocate numElements of _T aligned to 16 bytes
 template< typename _T >
-inline _T* alloc16( const size_t numElements )
+inline _T* alloc16( const size_t numElements, const Tag tag = Tag::General )
 {
     _T* mblock = reinterpret_cast<_T*>( rpmalloc( sizeof( _T ) * numElements ) );
 
+    if ( mblock != nullptr )
+        trackAlloc( tag, rpmalloc_usable_size( mblock ) );
+
     return mblock;
 }
 
 // allocate numElements of _T aligned to 16 bytes
 template< typename _T >
-inline _T* alloc16To( const size_t numElements, const _T defaultValue )
+inline _T* alloc16To( const size_t numElements, const _T defaultValue, const Tag tag = Tag::General )
 {
-    _T* mblock = reinterpret_cast<_T*>( rpmalloc( sizeof( _T ) * numElements ) );
+    _T* mblock = alloc16<_T>( numElements, tag );
 
     for ( size_t kI = 0; kI < numElements; kI++ )
         mblock[kI] = defaultValue;
@@ -32,9 +37,24 @@ inline _T* alloc16To( const size_t numElements, const _T defaultValue )
     return mblock;
 }
 
-// free memory allocated with allocateAlign16
-inline void free16( void* ptr )
+// allocate numElements of _T with a larger alignment; free with free16 as usual
+template< typename _T >
+inline _T* allocAligned( const size_t alignment, const size_t numElements, const Tag tag = Tag::General )
 {
+    _T* mblock = reinterpret_cast<_T*>( rpaligned_alloc( alignment, sizeof( _T ) * numElements ) );
+
+    if ( mblock != nullptr )
+        trackAlloc( tag, rpmalloc_usable_size( mblock ) );
+
+    return mblock;
+}
+
+// free memory allocated with any of the above; tag must match the one used to allocate
+inline void free16( void* ptr, const Tag tag = Tag::General )
+{
+    if ( ptr != nullptr )
+        trackFree( tag, rpmalloc_usable_size( ptr ) );
+
     return rpfree( ptr );
 }
 
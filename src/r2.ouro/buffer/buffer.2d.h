@@ -24,16 +24,19 @@ public:
 
     Buffer2D(
         const uint32_t width,
-        const uint32_t height )
+        const uint32_t height,
+        const mem::Tag memoryTag = mem::Tag::General )
         : m_width(width)
         , m_height(height)
+        , m_memoryTag(memoryTag)
     {
-        m_buffer = mem::alloc16To<_Type>( m_width * m_height, (_Type)0 );
+        m_buffer = mem::alloc16To<_Type>( m_width * m_height, (_Type)0, m_memoryTag );
     }
 
     Buffer2D( Buffer2D&& other )
         : m_width( other.getWidth() )
         , m_height( other.getHeight() )
+        , m_memoryTag( other.m_memoryTag )
     {
         m_buffer = other.m_buffer;
         other.m_buffer = nullptr;
@@ -43,6 +46,7 @@ public:
     {
         m_width = other.getWidth();
         m_height = other.getHeight();
+        m_memoryTag = other.m_memoryTag;
         m_buffer = other.m_buffer;
         other.m_buffer = nullptr;
     }
@@ -50,7 +54,7 @@ public:
 
     ~Buffer2D()
     {
-        mem::free16( m_buffer );
+        mem::free16( m_buffer, m_memoryTag );
     }
 
     ouro_nodiscard constexpr uint32_t getWidth() const
@@ -157,6 +161,7 @@ private:
 
     uint32_t     m_width;
     uint32_t     m_height;
+    mem::Tag     m_memoryTag;
 };
 
 
@@ -30,18 +30,18 @@ struct InterleavingQuantiseBuffer
     {
         const auto totalStereoSamples = m_maximumSamples * 2;
 
-        m_interleavedFloat  = mem::alloc16< float >( totalStereoSamples );
-        m_interleavedQuant  = mem::alloc16To< _quantisedType >( totalStereoSamples, 0 );
+        m_interleavedFloat  = mem::alloc16< float >( totalStereoSamples, mem::Tag::Recorder );
+        m_interleavedQuant  = mem::alloc16To< _quantisedType >( totalStereoSamples, 0, mem::Tag::Recorder );
     }
 
     ~InterleavingQuantiseBuffer()
     {
         if ( m_interleavedFloat != nullptr )
-            mem::free16( m_interleavedFloat );
+            mem::free16( m_interleavedFloat, mem::Tag::Recorder );
         m_interleavedFloat = nullptr;
 
         if ( m_interleavedQuant != nullptr )
-            mem::free16( m_interleavedQuant );
+            mem::free16( m_interleavedQuant, mem::Tag::Recorder );
         m_interleavedQuant = nullptr;
 
         m_committed = false;
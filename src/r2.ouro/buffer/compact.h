@@ -0,0 +1,155 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  kernels for compact in-memory sample storage; 16-bit PCM against a full-scale value chosen per buffer, and an 8-bit
+//  block-floating-point format that stores one float scale per block of bfp8_block_size samples alongside int8
+//  mantissas (~1.125 bytes per sample)
+//
+//  as with buffer/mix.h these are flat loops over whole spans, written so the compiler can vectorise them
+//
+
+#pragma once
+
+namespace buffer {
+
+static constexpr int   bfp8_block_shift     = 5;
+static constexpr int   bfp8_block_size      = 1 << bfp8_block_shift;
+
+static constexpr float int16_to_float_scale = 1.0f / 32767.0f;
+
+// number of block scales required to store (sample_count) samples in bfp8
+constexpr int bfp8_block_count( const int sample_count )
+{
+    return ( sample_count + bfp8_block_size - 1 ) >> bfp8_block_shift;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// largest absolute sample value in (input)
+//
+constexpr float peak_magnitude(
+    const int    sample_count,
+    const float  input[]
+)
+{
+    float peak = 0;
+    for ( auto i = 0; i < sample_count; i++ )
+        peak = std::max( peak, std::abs( input[i] ) );
+
+    return peak;
+}
+
+// the full-scale value to store 16-bit PCM against, given the peak of the audio going in; anything within +/-1.0 keeps
+// the usual 1.0 full scale, louder audio widens it so nothing clips
+constexpr float int16_full_scale_for( const float peak )
+{
+    return std::max( 1.0f, peak );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// float -> clamped, rounded 16-bit PCM, with +/-(full_scale) mapped to +/-32767
+//
+constexpr void quantise_float_to_int16(
+    const int    sample_count,
+    const float  input[],
+    const float  full_scale,
+    int16_t      output[]
+)
+{
+    const float scaleRecp = 32767.0f / full_scale;
+
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        const float scaled = std::clamp( input[i] * scaleRecp, -32767.0f, 32767.0f );
+        output[i] = (int16_t)( scaled + ( scaled >= 0 ? 0.5f : -0.5f ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// 16-bit PCM -> float, for (sample_count) samples starting at (sample_start); (full_scale) must match what the data
+// was quantised with
+//
+constexpr void expand_int16_to_float(
+    const int     sample_start,
+    const int     sample_count,
+    const int16_t input[],
+    const float   full_scale,
+    float         output[]
+)
+{
+    const int16_t* source = input + sample_start;
+    const float    scale  = full_scale * int16_to_float_scale;
+
+    for ( auto i = 0; i < sample_count; i++ )
+        output[i] = (float)source[i] * scale;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// float -> bfp8; each block is scaled so that its peak lands on +/-127. (output_block_scale) must hold
+// bfp8_block_count( sample_count ) entries
+//
+constexpr void quantise_float_to_bfp8(
+    const int    sample_count,
+    const float  input[],
+    int8_t       output_mantissa[],
+    float        output_block_scale[]
+)
+{
+    const int blockCount = bfp8_block_count( sample_count );
+
+    for ( auto block = 0; block < blockCount; block++ )
+    {
+        const int blockStart = block << bfp8_block_shift;
+        const int blockEnd   = std::min( blockStart + bfp8_block_size, sample_count );
+
+        float blockPeak = 0;
+        for ( auto i = blockStart; i < blockEnd; i++ )
+            blockPeak = std::max( blockPeak, std::abs( input[i] ) );
+
+        // silent blocks keep a zero scale, everything in them decodes back to exactly zero
+        const float scale     = blockPeak / 127.0f;
+        const float scaleRecp = ( blockPeak > 0 ) ? ( 127.0f / blockPeak ) : 0.0f;
+
+        output_block_scale[block] = scale;
+
+        for ( auto i = blockStart; i < blockEnd; i++ )
+        {
+            const float scaled = input[i] * scaleRecp;
+            output_mantissa[i] = (int8_t)std::clamp( (int)( scaled + ( scaled >= 0 ? 0.5f : -0.5f ) ), -127, 127 );
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// bfp8 -> float, for (sample_count) samples starting at (sample_start); the span is walked a block at a time so the
+// inner loop is a straight int8 * constant-scale conversion regardless of alignment
+//
+constexpr void expand_bfp8_to_float(
+    const int     sample_start,
+    const int     sample_count,
+    const int8_t  input_mantissa[],
+    const float   input_block_scale[],
+    float         output[]
+)
+{
+    int written = 0;
+    while ( written < sample_count )
+    {
+        const int   source     = sample_start + written;
+        const int   block      = source >> bfp8_block_shift;
+        const int   runLength  = std::min( sample_count - written, ( ( block + 1 ) << bfp8_block_shift ) - source );
+        const float scale      = input_block_scale[block];
+
+        const int8_t* mantissa = input_mantissa + source;
+        float*        target   = output + written;
+
+        for ( auto i = 0; i < runLength; i++ )
+            target[i] = (float)mantissa[i] * scale;
+
+        written += runLength;
+    }
+}
+
+} // namespace buffer
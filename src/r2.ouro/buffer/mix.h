@@ -89,4 +89,149 @@ constexpr void interleave_float_to_int24(
     }
 }
 
+
+// ---------------------------------------------------------------------------------------------------------------------
+// block kernels for riff crossfading; written as flat, branch-free loops over whole blocks so the compiler can
+// vectorise them on every platform we build for
+// ---------------------------------------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------------------------------------
+// write a linear ramp of fade positions, t_start + (i * t_step), clamped to 0..1
+//
+constexpr void fade_ramp_clamped(
+    const int    sample_count,
+    const float  t_start,
+    const float  t_step,
+    float        output[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        const float t = t_start + ( (float)i * t_step );
+        output[i] = std::clamp( t, 0.0f, 1.0f );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// 1 - t, turning fade-out progress back into a fade position
+//
+constexpr void fade_shape_invert(
+    const int    sample_count,
+    float        inout[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+        inout[i] = 1.0f - inout[i];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// turn 0..1 fade-in positions into equal-power gains, sin( t * pi/2 ); pairs with fade_shape_equal_power_out below so
+// the summed power of a crossfading pair stays constant. 9th order polynomial, max error ~4e-6 across the range
+//
+constexpr void fade_shape_equal_power(
+    const int    sample_count,
+    float        inout[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        const float t  = inout[i];
+        const float t2 = t * t;
+        inout[i] = t * ( 1.5707963f - t2 * ( 0.6459641f - t2 * ( 0.0796926f - t2 * ( 0.0046818f - t2 * 0.0001604f ) ) ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// the complementary fade-out; 0..1 progress through the fade becomes cos( t * pi/2 ), so that at the same progress t
+// sin^2 + cos^2 of the in / out pair sums to 1 (within ~7e-6). 10th order polynomial, max error ~5e-7
+//
+constexpr void fade_shape_equal_power_out(
+    const int    sample_count,
+    float        inout[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        const float t2 = inout[i] * inout[i];
+        inout[i] = 1.0f - t2 * ( 1.2337006f - t2 * ( 0.2536695f - t2 * ( 0.0208635f - t2 * ( 0.0009193f - t2 * 0.0000252f ) ) ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// smoothstep S-curve, 3t^2 - 2t^3
+//
+constexpr void fade_shape_s_curve(
+    const int    sample_count,
+    float        inout[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        const float t = inout[i];
+        inout[i] = t * t * ( 3.0f - ( 2.0f * t ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// map 0..1 fade positions through a table of (table_size) evenly spaced points, linearly interpolated
+//
+constexpr void fade_shape_table(
+    const int    sample_count,
+    const float  table[],
+    const int    table_size,
+    float        inout[]
+)
+{
+    const float tableScale = (float)( table_size - 1 );
+    const int   tableLast  = table_size - 2;
+
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        const float position = inout[i] * tableScale;
+        const int   index    = std::min( (int)position, tableLast );
+        const float fraction = position - (float)index;
+
+        inout[i] = table[index] + ( ( table[index + 1] - table[index] ) * fraction );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// output += input * gain, for a stereo pair
+//
+constexpr void accumulate_stereo_scaled(
+    const int    sample_count,
+    const float  gain,
+    const float  input_left[],
+    const float  input_right[],
+    float        output_left[],
+    float        output_right[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+        output_left[i]  += input_left[i] * gain;
+
+    for ( auto i = 0; i < sample_count; i++ )
+        output_right[i] += input_right[i] * gain;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// output += input * gain * envelope[i], for a stereo pair
+//
+constexpr void accumulate_stereo_enveloped(
+    const int    sample_count,
+    const float  gain,
+    const float  envelope[],
+    const float  input_left[],
+    const float  input_right[],
+    float        output_left[],
+    float        output_right[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+        output_left[i]  += input_left[i] * ( gain * envelope[i] );
+
+    for ( auto i = 0; i < sample_count; i++ )
+        output_right[i] += input_right[i] * ( gain * envelope[i] );
+}
+
 } // namespace buffer
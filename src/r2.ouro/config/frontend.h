@@ -31,6 +31,12 @@ OURO_CONFIG( Frontend )
 
     bool            isBorderless = true;
 
+    // low-power frame loop; rather than redrawing at the display refresh rate, sleep until there is input, event bus
+    // traffic or an animation to show - and otherwise redraw only every idleRedrawIntervalMs
+    bool            lowPowerIdle            = false;
+    uint32_t        idleRedrawIntervalMs    = 250;
+    uint32_t        animationFrameRate      = 30;      // cap on redraws driven purely by animation, without input
+
     template<class Archive>
     void serialize( Archive& archive )
     {
@@ -40,6 +46,9 @@ OURO_CONFIG( Frontend )
                , CEREAL_OPTIONAL_NVP( appPositionY )
                , CEREAL_OPTIONAL_NVP( appPositionValid )
                , CEREAL_OPTIONAL_NVP( isBorderless )
+               , CEREAL_OPTIONAL_NVP( lowPowerIdle )
+               , CEREAL_OPTIONAL_NVP( idleRedrawIntervalMs )
+               , CEREAL_OPTIONAL_NVP( animationFrameRate )
         );
     }
 
@@ -53,6 +62,9 @@ OURO_CONFIG( Frontend )
             appWidth  = DefaultWidth;
             appHeight = DefaultHeight;
         }
+
+        idleRedrawIntervalMs = std::clamp( idleRedrawIntervalMs, 16U, 5000U );
+        animationFrameRate   = std::clamp( animationFrameRate, 1U, 240U );
         return true;
     }
 };
@@ -12,6 +12,7 @@
 #include "config/base.h"
 
 #include "base/utils.h"
+#include "dsp/timestretch.h"
 
 namespace config {
 
@@ -25,6 +26,20 @@ OURO_CONFIG( Performance )
     // to avoid prune-thrashing (ask your mother), set some kind of reasonable minimum cache size lower bound
     static constexpr int32_t stemCachePruneLevelMinimumMb = 200;
 
+    // upper limit for progressiveStemStartBars; beyond this there's little to be gained over waiting for the whole stem
+    static constexpr int32_t progressiveStemStartBarsMaximum = 8;
+
+    // options for stemStorageMode, in the same order as endlesss::live::Stem::SampleStorage
+    static constexpr int32_t stemStorageModeCount = 3;
+    static constexpr std::array< const char*, stemStorageModeCount > stemStorageModeNames{ {
+        "32-bit Float",
+        "16-bit PCM",
+        "8-bit Block Float"
+    } };
+
+    // libFLAC compression levels run 0 .. 8
+    static constexpr int32_t flacCompressionLevelMaximum = 8;
+
 
     // approximate size (in Mb) of live stem cache before we run some garbage collection to trim it down
     int32_t         stemCacheAutoPruneAtMemoryUsageMb = 2048;
@@ -32,6 +47,24 @@ OURO_CONFIG( Performance )
     // when possible viable, keep this number of live full riff instances alive once they are fully loaded
     int32_t         liveRiffInstancePoolSize = 64;
 
+    // how loaded stems keep their audio in memory; the compact modes halve (16-bit) or better than quarter (8-bit
+    // block float) the footprint of each stem, paying for it with a decode step whenever the mixer reads them
+    int32_t         stemStorageMode = 0;
+
+    // a dsp::TimeStretch::Preset; riffs that use stems recorded at another tempo play them resampled (shifting their
+    // pitch) when this is Off, otherwise the stems are re-timed in the background at this quality, keeping their pitch
+    int32_t         timeStretchPreset = 0;
+
+    // if non-zero, stems decode progressively and a riff starts playing once this many bars of each stem are ready,
+    // with the rest decoding in the background; 0 waits for every stem to fully decode first. (FLAC stems with the
+    // 32-bit Float memory format only, anything else still decodes in one go)
+    int32_t         progressiveStemStartBars = 0;
+
+    // libFLAC settings for multitrack FLAC recording; higher levels trade encoder CPU for smaller files, verification
+    // decodes every frame back to check it, roughly doubling the encode cost
+    int32_t         flacCompressionLevel = 4;
+    bool            flacVerify = true;
+
     // for people connecting over less reliable networks that may be lossy or take a few persistent bumps to make
     // API calls land, enabling this will ramp up the retry rates in the network layer, bump up the timeouts
     bool            enableUnstableNetworkCompensation = false;
@@ -47,6 +80,11 @@ OURO_CONFIG( Performance )
                , CEREAL_NVP( liveRiffInstancePoolSize )
                , CEREAL_OPTIONAL_NVP( enableUnstableNetworkCompensation )
                , CEREAL_OPTIONAL_NVP( enableVibesRenderer )
+               , CEREAL_OPTIONAL_NVP( stemStorageMode )
+               , CEREAL_OPTIONAL_NVP( progressiveStemStartBars )
+               , CEREAL_OPTIONAL_NVP( timeStretchPreset )
+               , CEREAL_OPTIONAL_NVP( flacCompressionLevel )
+               , CEREAL_OPTIONAL_NVP( flacVerify )
         );
     }
 
@@ -54,6 +92,10 @@ OURO_CONFIG( Performance )
     {
         stemCacheAutoPruneAtMemoryUsageMb   = std::max( stemCacheAutoPruneAtMemoryUsageMb, stemCachePruneLevelMinimumMb );
         liveRiffInstancePoolSize            = std::max( liveRiffInstancePoolSize, 1 );
+        stemStorageMode                     = std::clamp( stemStorageMode, 0, stemStorageModeCount - 1 );
+        progressiveStemStartBars            = std::clamp( progressiveStemStartBars, 0, progressiveStemStartBarsMaximum );
+        timeStretchPreset                   = std::clamp( timeStretchPreset, 0, (int32_t)dsp::TimeStretch::cPresetCount - 1 );
+        flacCompressionLevel                = std::clamp( flacCompressionLevel, 0, flacCompressionLevelMaximum );
     }
 
     // ensure nothing weird arriving
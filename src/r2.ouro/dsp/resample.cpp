@@ -0,0 +1,101 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  streaming sample-rate conversion for whole-stream jobs like stem loading
+//
+
+#include "pch.h"
+#include "dsp/resample.h"
+
+// r8brain
+#include "CDSPResampler.h"
+
+namespace dsp {
+
+namespace {
+
+// every resampler this thread has built, found by rates + lane
+struct ThreadResamplers
+{
+    struct Entry
+    {
+        uint32_t                            m_sourceRate;
+        uint32_t                            m_targetRate;
+        uint32_t                            m_lane;
+        std::unique_ptr< StreamResampler >  m_resampler;
+    };
+    std::vector< Entry >    m_entries;
+};
+
+thread_local ThreadResamplers tlResamplers;
+
+} // anonymous namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+StreamResampler& StreamResampler::acquire( const uint32_t sourceRate, const uint32_t targetRate, const uint32_t lane )
+{
+    for ( auto& entry : tlResamplers.m_entries )
+    {
+        if ( entry.m_sourceRate == sourceRate &&
+             entry.m_targetRate == targetRate &&
+             entry.m_lane       == lane )
+        {
+            entry.m_resampler->reset();
+            return *entry.m_resampler;
+        }
+    }
+
+    auto& entry = tlResamplers.m_entries.emplace_back( ThreadResamplers::Entry{
+        sourceRate,
+        targetRate,
+        lane,
+        std::unique_ptr< StreamResampler >( new StreamResampler( sourceRate, targetRate ) ) } );
+
+    return *entry.m_resampler;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StreamResampler::StreamResampler( const uint32_t sourceRate, const uint32_t targetRate )
+    : m_sourceRate( sourceRate )
+    , m_targetRate( targetRate )
+{
+    ABSL_ASSERT( sourceRate > 0 && targetRate > 0 );
+
+    m_resampler  = std::make_unique< r8b::CDSPResampler24 >( (double)sourceRate, (double)targetRate, cBlockSamples );
+    m_inputBlock = mem::alloc16<double>( cBlockSamples, mem::Tag::Audio );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StreamResampler::~StreamResampler()
+{
+    mem::free16( m_inputBlock, mem::Tag::Audio );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t StreamResampler::getOutputLength( const int32_t inputLength ) const
+{
+    return (int32_t)std::ceil( (double)inputLength * (double)m_targetRate / (double)m_sourceRate );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t StreamResampler::processBlock( const int32_t inputCount, const double*& output )
+{
+    ABSL_ASSERT( inputCount >= 0 && inputCount <= cBlockSamples );
+
+    double* produced = nullptr;
+    const int32_t producedCount = m_resampler->process( m_inputBlock, inputCount, produced );
+
+    output = produced;
+    return producedCount;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StreamResampler::reset()
+{
+    m_resampler->clear();
+}
+
+} // namespace dsp
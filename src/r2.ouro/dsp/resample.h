@@ -0,0 +1,113 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  streaming sample-rate conversion for whole-stream jobs like stem loading; r8brain does the filtering, fed and
+//  drained a block at a time so callers never need full-length double copies of their audio
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+namespace r8b { class CDSPResampler24; }
+
+namespace dsp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// r8brain works in double precision internally; this wraps it with a fixed-size input block that callers convert
+// into from whatever they have, so the only double-precision working memory is that block and r8brain's own buffers.
+//
+// building a resampler designs its filters and sizes its buffers, which is a large part of the cost of a short
+// conversion, so instead of one per stream each thread keeps every resampler it has asked for and hands it back out
+// reset. stem loading only ever sees a handful of rate pairs, so the per-thread set stays small
+//
+class StreamResampler
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( StreamResampler );
+
+    static constexpr int32_t cBlockSamples = 4096;
+
+    // this thread's resampler for (sourceRate) -> (targetRate), reset and ready for a new stream. lanes are separate
+    // instances for the same rates, for running more than one stream at once (eg. one per channel). the reference
+    // is only for use on the calling thread, and stays valid for that thread's lifetime
+    ouro_nodiscard static StreamResampler& acquire( const uint32_t sourceRate, const uint32_t targetRate, const uint32_t lane = 0 );
+
+    ~StreamResampler();
+
+    // number of samples a complete stream of (inputLength) samples converts to
+    ouro_nodiscard int32_t getOutputLength( const int32_t inputLength ) const;
+
+
+    // streaming; write up to cBlockSamples into getInputBlock() then call processBlock() with that count. returns the
+    // number of samples produced into (output), which points inside the resampler and is only good until the next call
+    ouro_nodiscard double* getInputBlock() { return m_inputBlock; }
+    ouro_nodiscard int32_t processBlock( const int32_t inputCount, const double*& output );
+
+    // drop any stream state, ready to begin another
+    void reset();
+
+
+    // convert a complete stream of (inputLength) samples, read (inputStride) apart and multiplied by (inputScale) on
+    // the way in; writes exactly (outputLength) samples, running silence through after the input to fill the tail.
+    // leaves the resampler reset
+    template< typename _Sample >
+    void convert(
+        const _Sample*      input,
+        const std::size_t   inputStride,
+        const int32_t       inputLength,
+        const double        inputScale,
+        float*              output,
+        const int32_t       outputLength );
+
+private:
+
+    StreamResampler( const uint32_t sourceRate, const uint32_t targetRate );
+
+    uint32_t                                    m_sourceRate;
+    uint32_t                                    m_targetRate;
+    std::unique_ptr< r8b::CDSPResampler24 >     m_resampler;
+    double*                                     m_inputBlock = nullptr;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _Sample >
+inline void StreamResampler::convert(
+    const _Sample*      input,
+    const std::size_t   inputStride,
+    const int32_t       inputLength,
+    const double        inputScale,
+    float*              output,
+    const int32_t       outputLength )
+{
+    int32_t inputRead       = 0;
+    int32_t outputWritten   = 0;
+
+    while ( outputWritten < outputLength )
+    {
+        // once the input runs out, the rest of each block is silence to push the filter tail through
+        const int32_t fromInput = std::min( cBlockSamples, inputLength - inputRead );
+        for ( int32_t s = 0; s < fromInput; s++ )
+        {
+            m_inputBlock[s] = static_cast<double>( input[ (std::size_t)( inputRead + s ) * inputStride ] ) * inputScale;
+        }
+        std::fill( m_inputBlock + fromInput, m_inputBlock + cBlockSamples, 0.0 );
+        inputRead += fromInput;
+
+        const double* produced = nullptr;
+        const int32_t producedCount = std::min( processBlock( cBlockSamples, produced ), outputLength - outputWritten );
+
+        for ( int32_t s = 0; s < producedCount; s++ )
+        {
+            output[outputWritten + s] = static_cast<float>( produced[s] );
+        }
+        outputWritten += producedCount;
+    }
+
+    reset();
+}
+
+} // namespace dsp
@@ -48,10 +48,10 @@ Scope8::Scope8( const float measurementLengthSeconds, const uint32_t sampleRate,
 
 
     // allocate all worker buffers, reset everything ready
-    m_inputL        = mem::alloc16<float>( m_fftWindowSize );
-    m_inputR        = mem::alloc16<float>( m_fftWindowSize );
-    m_outputL       = mem::alloc16<complexf>( m_fftWindowSize );
-    m_outputR       = mem::alloc16<complexf>( m_fftWindowSize );
+    m_inputL        = mem::alloc16<float>( m_fftWindowSize, mem::Tag::Audio );
+    m_inputR        = mem::alloc16<float>( m_fftWindowSize, mem::Tag::Audio );
+    m_outputL       = mem::alloc16<complexf>( m_fftWindowSize, mem::Tag::Audio );
+    m_outputR       = mem::alloc16<complexf>( m_fftWindowSize, mem::Tag::Audio );
 
     m_outputBucketsIndex = 0;
     m_outputBuckets[0].fill( 0.0f );
@@ -66,10 +66,10 @@ Scope8::Scope8( const float measurementLengthSeconds, const uint32_t sampleRate,
 // ---------------------------------------------------------------------------------------------------------------------
 Scope8::~Scope8()
 {
-    mem::free16( m_outputR );
-    mem::free16( m_outputL );
-    mem::free16( m_inputR );
-    mem::free16( m_inputL );
+    mem::free16( m_outputR, mem::Tag::Audio );
+    mem::free16( m_outputL, mem::Tag::Audio );
+    mem::free16( m_inputR, mem::Tag::Audio );
+    mem::free16( m_inputL, mem::Tag::Audio );
 
     pffft_destroy_setup( m_pffftPlan );
 }
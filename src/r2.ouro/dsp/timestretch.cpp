@@ -0,0 +1,174 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  pitch-preserving time-stretch for looped stereo material, via WSOLA
+//
+
+#include "pch.h"
+#include "dsp/timestretch.h"
+
+namespace dsp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+TimeStretch::TimeStretch( const Preset preset, const uint32_t sampleRate )
+{
+    double grainMs  = 40.0;
+    double searchMs = 10.0;
+    m_coarseStep    = 4;
+
+    switch ( preset )
+    {
+        case Preset::Fast:      grainMs = 20.0; searchMs =  5.0; m_coarseStep = 4; break;
+        case Preset::Off:
+        case Preset::Balanced:  grainMs = 40.0; searchMs = 10.0; m_coarseStep = 4; break;
+        case Preset::High:      grainMs = 50.0; searchMs = 15.0; m_coarseStep = 2; break;
+    }
+
+    const double samplesPerMs = (double)sampleRate * 0.001;
+
+    m_grainSamples  = std::max( (int32_t)( grainMs * samplesPerMs ) & ~1, 64 );
+    m_searchSamples = std::max( (int32_t)( searchMs * samplesPerMs ), m_coarseStep );
+
+    static constexpr double cTwoPi = 2.0 * 3.14159265358979323846;
+
+    m_window.resize( m_grainSamples );
+    for ( int32_t i = 0; i < m_grainSamples; i++ )
+    {
+        m_window[i] = (float)( 0.5 - 0.5 * std::cos( cTwoPi * (double)i / (double)m_grainSamples ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool TimeStretch::renderLoop(
+    const std::array< const float*, 2 >&    input,
+    const int32_t                           inputLength,
+    const double                            timeScale,
+    const std::array< float*, 2 >&          output,
+    const int32_t                           outputLength,
+    const ProgressFn&                       progress ) const
+{
+    ABSL_ASSERT( inputLength > 0 && outputLength > 0 );
+    ABSL_ASSERT( timeScale > 0 );
+
+    // report back every few grains; often enough that readers see the output grow smoothly
+    static constexpr int32_t cGrainsPerProgress = 8;
+
+    const int32_t hop = m_grainSamples / 2;
+
+    // build the mid signal used for alignment, padded either side with wrapped-around copies of the loop so that
+    // grain searches never need to wrap themselves
+    const int32_t pad = ( m_grainSamples * 2 ) + m_searchSamples + (int32_t)std::ceil( (double)hop * timeScale ) + 1;
+
+    const auto wrap = [inputLength]( int64_t index ) -> int32_t
+    {
+        index %= inputLength;
+        return (int32_t)( index < 0 ? index + inputLength : index );
+    };
+
+    std::vector< float > midPadded( (std::size_t)inputLength + ( (std::size_t)pad * 2 ) );
+    for ( std::size_t i = 0; i < midPadded.size(); i++ )
+    {
+        const int32_t source = wrap( (int64_t)i - pad );
+        midPadded[i] = input[0][source] + input[1][source];
+    }
+    const float* mid = midPadded.data() + pad;    // mid[0] is the start of the loop, negative indices are valid
+
+    // find the offset from (nominal), within the search range, whose overlap region looks most like the natural
+    // continuation of the previous grain - a coarse sweep first, then a full-resolution pass around the best of those
+    const auto findAlignment = [&]( const int64_t naturalStart, const int64_t nominal ) -> int32_t
+    {
+        const float* natural = mid + naturalStart;
+
+        const auto correlate = [&]( const int32_t offset, const int32_t step ) -> float
+        {
+            const float* candidate = mid + nominal + offset;
+
+            float dot    = 0;
+            float energy = 0;
+            for ( int32_t i = 0; i < hop; i += step )
+            {
+                dot    += natural[i] * candidate[i];
+                energy += candidate[i] * candidate[i];
+            }
+            return dot / std::sqrt( energy + 1e-9f );
+        };
+
+        // start from no movement, so that silence or ties leave grains where they were meant to go
+        int32_t bestOffset = 0;
+        float   bestScore  = correlate( 0, m_coarseStep );
+
+        for ( int32_t offset = -m_searchSamples; offset <= m_searchSamples; offset += m_coarseStep )
+        {
+            const float score = correlate( offset, m_coarseStep );
+            if ( score > bestScore )
+            {
+                bestScore  = score;
+                bestOffset = offset;
+            }
+        }
+
+        if ( m_coarseStep > 1 )
+        {
+            const int32_t refineFrom = std::max( bestOffset - m_coarseStep + 1, -m_searchSamples );
+            const int32_t refineTo   = std::min( bestOffset + m_coarseStep - 1,  m_searchSamples );
+
+            bestScore = correlate( bestOffset, 1 );
+            for ( int32_t offset = refineFrom; offset <= refineTo; offset++ )
+            {
+                const float score = correlate( offset, 1 );
+                if ( score > bestScore )
+                {
+                    bestScore  = score;
+                    bestOffset = offset;
+                }
+            }
+        }
+        return bestOffset;
+    };
+
+    std::fill( output[0], output[0] + outputLength, 0.0f );
+    std::fill( output[1], output[1] + outputLength, 0.0f );
+
+    // grains are laid down every (hop) output samples; the first starts a hop before the loop so that every output
+    // sample, including the very first, is covered by exactly two grains whose windows sum to 1
+    const int32_t lastGrain = ( outputLength - 1 ) / hop;
+
+    int64_t previousPosition = 0;
+    int32_t samplesComplete  = 0;
+
+    for ( int32_t grain = -1; grain <= lastGrain; grain++ )
+    {
+        const int64_t outputStart = (int64_t)grain * hop;
+        const int64_t nominal     = (int64_t)std::llround( (double)outputStart * timeScale );
+
+        const int64_t position = ( grain < 0 ) ? nominal : ( nominal + findAlignment( previousPosition + hop, nominal ) );
+
+        const int32_t grainFrom = (int32_t)std::max< int64_t >( -outputStart, 0 );
+        const int32_t grainTo   = (int32_t)std::min< int64_t >( m_grainSamples, outputLength - outputStart );
+        for ( int32_t i = grainFrom; i < grainTo; i++ )
+        {
+            const int32_t source = wrap( position + i );
+            const float   weight = m_window[i];
+
+            output[0][outputStart + i] += input[0][source] * weight;
+            output[1][outputStart + i] += input[1][source] * weight;
+        }
+        previousPosition = position;
+
+        // everything before the next grain's start now has both of its grains
+        samplesComplete = ( grain == lastGrain ) ? outputLength : (int32_t)std::min< int64_t >( outputStart + hop, outputLength );
+
+        if ( progress && ( grain == lastGrain || ( grain % cGrainsPerProgress ) == 0 ) )
+        {
+            if ( !progress( samplesComplete ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace dsp
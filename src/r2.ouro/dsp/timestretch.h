@@ -0,0 +1,84 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  pitch-preserving time-stretch for looped stereo material, via WSOLA (waveform-similarity overlap-add)
+//
+
+#pragma once
+
+namespace dsp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// stretches a whole loop to a new length without changing its pitch. the output is built front to back from windowed
+// grains of the input, each one nudged within a search range to line up with the waveform of the grain before it; the
+// input is read cyclically so the result loops as cleanly as the source did.
+//
+// grain placement is decided on a mid (L+R) signal and applied to both channels, to keep the stereo image intact
+//
+struct TimeStretch
+{
+    // quality / CPU trade-off; larger grains and a finer, wider alignment search cost more but smear transients less
+    // and handle low-frequency material better
+    enum class Preset : uint8_t
+    {
+        Off,                        // don't stretch; mismatched tempos stay on the pitch-shifting resample path
+        Fast,
+        Balanced,
+        High,
+    };
+    static constexpr std::size_t cPresetCount = 4;
+    static constexpr std::array< const char*, cPresetCount > cPresetNames{ {
+        "Off (Resample)",
+        "Fast",
+        "Balanced",
+        "High Quality",
+    } };
+
+    // beyond this range of time scales grains are either repeated or skipped so heavily that the results are worse
+    // than just resampling; callers should leave those on the resample path
+    static constexpr double cMinimumTimeScale = 0.25;
+    static constexpr double cMaximumTimeScale = 4.0;
+
+    ouro_nodiscard static constexpr bool isTimeScaleSupported( const double timeScale )
+    {
+        return timeScale >= cMinimumTimeScale && timeScale <= cMaximumTimeScale;
+    }
+
+    // timeScale is input samples consumed per output sample - the same sense as Riff::m_stemTimeScales - so > 1
+    // produces a shorter loop
+    ouro_nodiscard static int32_t getOutputLength( const int32_t inputLength, const double timeScale )
+    {
+        return std::max( (int32_t)std::lround( (double)inputLength / timeScale ), 1 );
+    }
+
+    // called as output is finalised, with the number of leading output samples that are now complete. return false
+    // to abandon the render
+    using ProgressFn = std::function< bool( const int32_t samplesComplete ) >;
+
+    TimeStretch( const Preset preset, const uint32_t sampleRate );
+
+    // stretch (inputLength) samples into (outputLength), which should come from getOutputLength(). returns false if
+    // (progress) asked to stop early, in which case the output is only valid as far as was last reported
+    bool renderLoop(
+        const std::array< const float*, 2 >&    input,
+        const int32_t                           inputLength,
+        const double                            timeScale,
+        const std::array< float*, 2 >&          output,
+        const int32_t                           outputLength,
+        const ProgressFn&                       progress ) const;
+
+    ouro_nodiscard constexpr int32_t getGrainSamples() const { return m_grainSamples; }
+    ouro_nodiscard constexpr int32_t getSearchSamples() const { return m_searchSamples; }
+
+private:
+
+    int32_t                 m_grainSamples;     // grain length, even; grains overlap by half
+    int32_t                 m_searchSamples;    // grains may move this far either side of their nominal position
+    int32_t                 m_coarseStep;       // first alignment pass tests every Nth offset, correlating every Nth sample
+    std::vector< float >    m_window;           // periodic Hann, so half-overlapped grains sum to exactly 1
+};
+
+} // namespace dsp
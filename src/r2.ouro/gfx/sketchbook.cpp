@@ -184,7 +184,7 @@ base::U32Buffer* Sketchbook::borrow( const DimensionsPow2& dimensions )
     }
 
 
-    base::U32Buffer* newBuffer = new base::U32Buffer( dimensions.width(), dimensions.height() );
+    base::U32Buffer* newBuffer = new base::U32Buffer( dimensions.width(), dimensions.height(), mem::Tag::Sketch );
     OURO_SKETCH_VERBOSE( "new buffer created [{:x}] [{}, {}]", (uint64_t)newBuffer, dimensions.width(), dimensions.height() );
 
     return newBuffer;
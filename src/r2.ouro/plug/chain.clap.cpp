@@ -0,0 +1,228 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+//
+
+#include "pch.h"
+
+#include "plug/chain.clap.h"
+
+#include "base/utils.h"
+#include "base/instrumentation.h"
+#include "spacetime/moment.h"
+
+namespace plug {
+
+// ---------------------------------------------------------------------------------------------------------------------
+CLAPChainSlot::CLAPChainSlot( std::string_view displayName )
+    : m_displayName( displayName )
+    , m_parameterQueue( cParameterQueueSize )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool CLAPChainSlot::queueParameterChange( const clap_id paramID, const double value )
+{
+    return m_parameterQueue.try_enqueue( ParameterChange{ paramID, value } );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void CLAPChainSlot::resetOverrun()
+{
+    m_cpuLoadPeak   = 0.0f;
+    m_overrunBypass = false;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+CLAPChain::CLAPChain( std::string_view name, const uint32_t maxFrames )
+    : m_name( name )
+    , m_maxFrames( maxFrames )
+{
+    // reserved upfront so that append() on the mix thread never allocates
+    m_slots.reserve( cMaxSlots );
+
+    for ( auto& flip : m_flipLR )
+    {
+        flip[0] = mem::alloc16To<float>( m_maxFrames, 0.0f, mem::Tag::Audio );
+        flip[1] = mem::alloc16To<float>( m_maxFrames, 0.0f, mem::Tag::Audio );
+    }
+    m_silence = mem::alloc16To<float>( m_maxFrames, 0.0f, mem::Tag::Audio );
+    m_runoff  = mem::alloc16To<float>( m_maxFrames, 0.0f, mem::Tag::Audio );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+CLAPChain::~CLAPChain()
+{
+    mem::free16( m_runoff, mem::Tag::Audio );
+    mem::free16( m_silence, mem::Tag::Audio );
+    for ( auto& flip : m_flipLR )
+    {
+        mem::free16( flip[1], mem::Tag::Audio );
+        mem::free16( flip[0], mem::Tag::Audio );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool CLAPChain::append( CLAPChainSlot* slot )
+{
+    if ( m_slots.size() >= cMaxSlots )
+        return false;
+
+    m_slots.push_back( slot );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool CLAPChain::remove( CLAPChainSlot* slot )
+{
+    const auto sizeBefore = m_slots.size();
+    base::erase_where( m_slots, [=]( const CLAPChainSlot* entry ) { return entry == slot; } );
+
+    return m_slots.size() != sizeBefore;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool CLAPChain::hasActiveSlots() const
+{
+    for ( const CLAPChainSlot* slot : m_slots )
+    {
+        if ( slot->m_online.load( std::memory_order_acquire ) != nullptr &&
+             !slot->m_bypass &&
+             !slot->m_overrunBypass )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::array< float*, 2 > CLAPChain::process(
+    float*                          inputLeft,
+    float*                          inputRight,
+    const uint32_t                  frameCount,
+    const uint32_t                  sampleRate,
+    const int64_t                   steadyTime,
+    const clap_event_transport*     transport )
+{
+    ABSL_ASSERT( frameCount <= m_maxFrames );
+
+    std::array< float*, 2 > currentInput = { inputLeft, inputRight };
+    std::size_t flipIndex = 0;
+
+    const double blockDurationUs = ( (double)frameCount / (double)sampleRate ) * 1000000.0;
+
+    for ( CLAPChainSlot* slot : m_slots )
+    {
+        online::CLAP* onlineInstance = slot->m_online.load( std::memory_order_acquire );
+        if ( onlineInstance == nullptr ||
+             slot->m_bypass ||
+             slot->m_overrunBypass )
+        {
+            continue;
+        }
+
+        // turn any queued automation into events at the top of the block
+        ParameterChange parameterChange;
+        while ( slot->m_parameterQueue.try_dequeue( parameterChange ) )
+        {
+            clap_event_param_value paramEvent;
+            paramEvent.header.size      = sizeof( clap_event_param_value );
+            paramEvent.header.time      = 0;
+            paramEvent.header.space_id  = CLAP_CORE_EVENT_SPACE_ID;
+            paramEvent.header.type      = CLAP_EVENT_PARAM_VALUE;
+            paramEvent.header.flags     = 0;
+            paramEvent.param_id         = parameterChange.m_paramID;
+            paramEvent.cookie           = nullptr;
+            paramEvent.note_id          = -1;
+            paramEvent.port_index       = -1;
+            paramEvent.channel          = -1;
+            paramEvent.key              = -1;
+            paramEvent.value            = parameterChange.m_value;
+
+            slot->m_eventsIn.push( &paramEvent.header );
+        }
+
+        // wire the bus into port 0 and pad any others out with silence / runoff, as the mixer does for the final stage
+        std::array< float*, cMaxChannels > channelsIn;
+        std::array< float*, cMaxChannels > channelsOut;
+        channelsIn.fill( m_silence );
+        channelsOut.fill( m_runoff );
+
+        channelsIn[0]  = currentInput[0];
+        channelsIn[1]  = currentInput[1];
+        channelsOut[0] = m_flipLR[flipIndex][0];
+        channelsOut[1] = m_flipLR[flipIndex][1];
+
+        auto& runtimeInstance = onlineInstance->getRuntimeInstance();
+
+        auto& inputBuffers = runtimeInstance.getInputAudioBuffers();
+        for ( auto& buffer : inputBuffers )
+            buffer.data32 = channelsIn.data();
+
+        auto& outputBuffers = runtimeInstance.getOutputAudioBuffers();
+        for ( auto& buffer : outputBuffers )
+            buffer.data32 = channelsOut.data();
+
+        clap_process clapProcess;
+        memset( &clapProcess, 0, sizeof( clapProcess ) );
+        clapProcess.steady_time         = steadyTime;
+        clapProcess.frames_count        = frameCount;
+        clapProcess.transport           = transport;
+        clapProcess.audio_inputs        = inputBuffers.data();
+        clapProcess.audio_inputs_count  = static_cast< uint32_t >( inputBuffers.size() );
+        clapProcess.audio_outputs       = outputBuffers.data();
+        clapProcess.audio_outputs_count = static_cast< uint32_t >( outputBuffers.size() );
+        clapProcess.in_events           = slot->m_eventsIn.clapInputEvents();
+        clapProcess.out_events          = slot->m_eventsOut.clapOutputEvents();
+
+        spacetime::Moment processTiming;
+        int32_t processingResult = CLAP_PROCESS_ERROR;
+        {
+            base::instr::ScopedEvent se( "CLAP", slot->m_displayName.c_str(), base::instr::PresetColour::Violet );
+
+            online::Processing processing( *onlineInstance );
+            if ( processing.isValid() )
+                processingResult = processing( clapProcess );
+        }
+        const double processUs = (double)processTiming.delta< std::chrono::microseconds >().count();
+
+        slot->m_eventsIn.clear();
+        slot->m_eventsOut.clear();
+
+        // track load as a share of the time this block represents; a plugin that keeps blowing its budget gets pulled
+        // out of the chain before it starts causing dropouts for everything else
+        const float blockLoad = static_cast< float >( processUs / blockDurationUs );
+        slot->m_cpuLoad     = ( slot->m_cpuLoad * 0.9f ) + ( blockLoad * 0.1f );
+        slot->m_cpuLoadPeak = std::max( slot->m_cpuLoadPeak.load(), blockLoad );
+
+        if ( blockLoad > cOverrunBudget )
+        {
+            if ( ++slot->m_consecutiveOverruns >= cOverrunTripCount )
+            {
+                slot->m_overrunBypass       = true;
+                slot->m_consecutiveOverruns = 0;
+                slot->m_overrunTrips++;
+            }
+        }
+        else
+        {
+            slot->m_consecutiveOverruns = 0;
+        }
+
+        if ( processingResult == CLAP_PROCESS_ERROR )
+            continue;
+
+        currentInput = m_flipLR[flipIndex];
+        flipIndex ^= 1;
+    }
+
+    return currentInput;
+}
+
+} // namespace plug
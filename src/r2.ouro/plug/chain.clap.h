@@ -0,0 +1,114 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  ordered chain of activated CLAP effects run over one stereo bus; slots are owned by the host, the chain only
+//  references them and its slot list is only ever modified from the mix thread
+//
+
+#pragma once
+#include "base/construction.h"
+
+#include "plug/plug.clap.h"
+
+#include "clap/clap.h"
+#include "clap/helpers/event-list.hh"
+
+namespace plug {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// a parameter change pushed from the main thread, turned into a CLAP_EVENT_PARAM_VALUE at the start of the next block
+struct ParameterChange
+{
+    clap_id     m_paramID   = CLAP_INVALID_ID;
+    double      m_value     = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// one plugin's place in a chain, carrying its automation queue and performance tracking
+struct CLAPChainSlot
+{
+    DECLARE_NO_COPY_NO_MOVE( CLAPChainSlot );
+
+    static constexpr std::size_t cParameterQueueSize = 256;
+
+    CLAPChainSlot( std::string_view displayName );
+
+    // main thread; returns false if the queue is full and the change was dropped
+    bool queueParameterChange( const clap_id paramID, const double value );
+
+    // clear the overrun bypass and start measuring again
+    void resetOverrun();
+
+    ouro_nodiscard constexpr const std::string& getDisplayName() const { return m_displayName; }
+
+
+    std::atomic< online::CLAP* >    m_online            = nullptr;      // published by the host once activated; nullptr means skip
+    std::atomic_bool                m_bypass            = false;        // user bypass
+    std::atomic_bool                m_overrunBypass     = false;        // tripped automatically when the plugin keeps blowing its time budget
+
+    std::atomic< float >            m_cpuLoad           = 0.0f;         // smoothed share of each block's real-time spent in process()
+    std::atomic< float >            m_cpuLoadPeak       = 0.0f;
+    std::atomic_uint32_t            m_overrunTrips      = 0;
+
+private:
+    friend class CLAPChain;
+
+    std::string                                 m_displayName;
+
+    mcc::ReaderWriterQueue< ParameterChange >   m_parameterQueue;
+    clap::helpers::EventList                    m_eventsIn;
+    clap::helpers::EventList                    m_eventsOut;
+
+    uint32_t                                    m_consecutiveOverruns = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+class CLAPChain
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( CLAPChain );
+
+    static constexpr std::size_t    cMaxSlots           = 16;
+    static constexpr std::size_t    cMaxChannels        = 16;       // widest port we pad out with silence / runoff buffers
+
+    static constexpr float          cOverrunBudget      = 0.5f;     // share of a block's duration one plugin may take
+    static constexpr uint32_t       cOverrunTripCount   = 8;        // consecutive blocks over budget before auto-bypass
+
+    CLAPChain( std::string_view name, const uint32_t maxFrames );
+    ~CLAPChain();
+
+    ouro_nodiscard constexpr const std::string& getName() const { return m_name; }
+
+    // mix thread only
+    bool append( CLAPChainSlot* slot );
+    bool remove( CLAPChainSlot* slot );
+
+    // true if there is at least one slot that would currently process audio
+    ouro_nodiscard bool hasActiveSlots() const;
+
+    // run every active slot in order; returns the pair of buffers holding the result, which is the input pair if
+    // nothing ran. safe to call for different chains concurrently
+    std::array< float*, 2 > process(
+        float*                          inputLeft,
+        float*                          inputRight,
+        const uint32_t                  frameCount,
+        const uint32_t                  sampleRate,
+        const int64_t                   steadyTime,
+        const clap_event_transport*     transport );
+
+private:
+
+    std::string                         m_name;
+    uint32_t                            m_maxFrames;
+
+    std::vector< CLAPChainSlot* >       m_slots;
+
+    std::array< float*, 2 >             m_flipLR[2];        // ping-pong buffers between successive plugins
+    float*                              m_silence           = nullptr;
+    float*                              m_runoff            = nullptr;
+};
+
+} // namespace plug
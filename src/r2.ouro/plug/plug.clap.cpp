@@ -129,6 +129,7 @@ absl::Status CLAP::load( clap_host* clapHost ) noexcept
             getExtension( m_pluginGui,                  CLAP_EXT_GUI );
             getExtension( m_pluginLatency,              CLAP_EXT_LATENCY );
             getExtension( m_pluginState,                CLAP_EXT_STATE );
+            getExtension( m_pluginParams,               CLAP_EXT_PARAMS );
 
             // check that we can scan the audio ports
             if ( m_pluginAudioPorts == nullptr ||
@@ -541,7 +542,13 @@ plug::runtime::CLAP::Instance CLAP::deactivate(
 
 // ---------------------------------------------------------------------------------------------------------------------
 Processing::Processing( const online::CLAP::Instance& onlineInstance )
-    : m_pluginInstance( onlineInstance->getRuntimeInstance().m_pluginInstance )
+    : Processing( *onlineInstance )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Processing::Processing( online::CLAP& onlineInstance )
+    : m_pluginInstance( onlineInstance.getRuntimeInstance().m_pluginInstance )
 {
     // attempt to start_processing; if that fails, null the plugin instance to mark the Processing block is invalid
     if ( m_pluginInstance->start_processing( m_pluginInstance ) == false )
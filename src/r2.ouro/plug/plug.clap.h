@@ -75,6 +75,7 @@ private:
     const clap_plugin_gui*          m_pluginGui                  = nullptr;
     const clap_plugin_latency*      m_pluginLatency              = nullptr;
     const clap_plugin_state*        m_pluginState                = nullptr;
+    const clap_plugin_params*       m_pluginParams               = nullptr;
 
     uint32_t                        m_pluginInputPortCount       = 0;
     uint32_t                        m_pluginOutputPortCount      = 0;
@@ -90,6 +91,12 @@ public:
 
     constexpr bool portsVerifiedOk() const { return m_pluginPortsVerifiedOk; }
 
+    constexpr const plug::KnownPlugin& getKnownPlugin() const { return m_knownPlugin; }
+
+    // parameter extension, if the plugin provides one; only the main-thread functions should be called through this
+    constexpr const clap_plugin* getPluginInstance() const { return m_pluginInstance; }
+    constexpr const clap_plugin_params* getPluginParams() const { return m_pluginParams; }
+
     constexpr AudioBufferConfigs& getInputAudioBuffers() { return m_pluginInputBuffers; }
     constexpr AudioBufferConfigs& getOutputAudioBuffers() { return m_pluginOutputBuffers; }
 
@@ -158,6 +165,7 @@ struct Processing
 {
     Processing() = delete;
     Processing( const online::CLAP::Instance& onlineInstance );
+    Processing( online::CLAP& onlineInstance );
     ~Processing();
 
     bool isValid() const { return m_pluginInstance != nullptr; }
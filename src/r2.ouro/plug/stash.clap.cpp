@@ -11,6 +11,8 @@
 
 #include "platform_folders.h"
 
+#include "absl/strings/str_split.h"
+
 #include "base/construction.h"
 #include "base/text.transform.h"
 #include "plug/stash.clap.h"
@@ -139,6 +141,20 @@ void CLAP::beginPopulateAsync( tf::Executor& taskExecutor )
         //   - /Library/Audio/Plug-Ins/CLAP
         //   - ~/Library/Audio/Plug-Ins/CLAP
         //
+        // .. plus any paths listed in CLAP_PATH, separated as per the platform's PATH; this is also how
+        // locally built plugins (like the bundled OUROGAIN test effect) can be picked up without installing them
+        //
+        if ( const char* clapPathEnv = std::getenv( "CLAP_PATH" ); clapPathEnv != nullptr )
+        {
+#if OURO_PLATFORM_WIN
+            constexpr char cPathSeparator = ';';
+#else
+            constexpr char cPathSeparator = ':';
+#endif
+            for ( const absl::string_view envPath : absl::StrSplit( clapPathEnv, cPathSeparator, absl::SkipWhitespace() ) )
+                clapSearchPaths.emplace_back( std::string( envPath ) );
+        }
+
 #if OURO_PLATFORM_LINUX
         {
             const fs::path linuxHomePath{ sago::getNixHome() };
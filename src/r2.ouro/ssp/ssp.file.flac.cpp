@@ -119,7 +119,8 @@ struct FLACWriter::StreamInstance final : public FLAC::Encoder::File,
 std::shared_ptr<FLACWriter> FLACWriter::Create(
     const fs::path&     outputFile,
     const uint32_t      sampleRate,
-    const float         writeBufferInSeconds )
+    const float         writeBufferInSeconds,
+    const FLACEncoderOptions& encoderOptions )
 {
     // produce a 8 and 16-bit encoded version of the filename, supporting utf8 characters in the input
     const std::u16string outputFileU16 = outputFile.u16string();
@@ -130,8 +131,8 @@ std::shared_ptr<FLACWriter> FLACWriter::Create(
     std::unique_ptr< FLACWriter::StreamInstance > newState = std::make_unique< FLACWriter::StreamInstance >( writeBufferInSamples );
 
     bool flacConfig = true;
-    flacConfig &= newState->set_verify( true );
-    flacConfig &= newState->set_compression_level( 4 );
+    flacConfig &= newState->set_verify( encoderOptions.m_verify );
+    flacConfig &= newState->set_compression_level( std::clamp( encoderOptions.m_compressionLevel, 0, 8 ) );
     flacConfig &= newState->set_channels( 2 );
     flacConfig &= newState->set_bits_per_sample( 24 );
     flacConfig &= newState->set_sample_rate( sampleRate );
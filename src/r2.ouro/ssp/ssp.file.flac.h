@@ -13,6 +13,14 @@
 
 namespace ssp {
 
+// ---------------------------------------------------------------------------------------------------------------------
+// libFLAC encoder knobs shared by the single-file writer and the multitrack recorder
+struct FLACEncoderOptions
+{
+    int32_t     m_compressionLevel  = 4;        // 0 .. 8
+    bool        m_verify            = true;     // decode every frame back and compare; roughly doubles encode cost
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 // 
 class FLACWriter : public ISampleStreamProcessor
@@ -25,7 +33,8 @@ public:
     static std::shared_ptr<FLACWriter> Create(
         const fs::path&     outputFile,
         const uint32_t      sampleRate,
-        const float         writeBufferInSeconds );
+        const float         writeBufferInSeconds,
+        const FLACEncoderOptions& encoderOptions = {} );
 
     void appendSamples( float* buffer0, float* buffer1, const uint32_t sampleCount ) override;
     uint64_t getStorageUsageInBytes() const override;
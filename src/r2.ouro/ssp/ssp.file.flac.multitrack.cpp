@@ -0,0 +1,661 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+//
+
+#include "pch.h"
+
+#include "ssp/ssp.file.flac.multitrack.h"
+
+#include "base/construction.h"
+#include "base/utils.h"
+#include "base/instrumentation.h"
+
+#include "buffer/buffer.iquant.h"
+#include "math/rng.h"
+#include "spacetime/moment.h"
+
+#include "FLAC++/encoder.h"
+
+
+namespace ssp {
+
+// STREAMINFO is always the first metadata block, directly after the "fLaC" marker and its 4 byte block header
+static constexpr long       cStreamInfoFileOffset   = 8;
+static constexpr std::size_t cStreamInfoBytes       = 34;
+
+using StreamInfoBlock = std::array< uint8_t, cStreamInfoBytes >;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// pack a STREAMINFO block as it appears on disk; we encode through the stream API without a seek callback, so libFLAC
+// cannot go back and fill in the final sample count & MD5 itself - the writer patches this over the header instead
+static StreamInfoBlock encodeStreamInfo( const FLAC__StreamMetadata_StreamInfo& info )
+{
+    StreamInfoBlock block;
+
+    const auto put16 = [&]( std::size_t offset, uint32_t value )
+    {
+        block[offset + 0] = static_cast<uint8_t>( value >> 8 );
+        block[offset + 1] = static_cast<uint8_t>( value );
+    };
+    const auto put24 = [&]( std::size_t offset, uint32_t value )
+    {
+        block[offset + 0] = static_cast<uint8_t>( value >> 16 );
+        block[offset + 1] = static_cast<uint8_t>( value >> 8 );
+        block[offset + 2] = static_cast<uint8_t>( value );
+    };
+
+    put16( 0, info.min_blocksize );
+    put16( 2, info.max_blocksize );
+    put24( 4, info.min_framesize );
+    put24( 7, info.max_framesize );
+
+    // sample rate : 20 | channels - 1 : 3 | bits per sample - 1 : 5 | total samples : 36
+    const uint64_t packed =
+        ( (uint64_t)( info.sample_rate & 0xFFFFF )           << 44 ) |
+        ( (uint64_t)( ( info.channels - 1 ) & 0x7 )          << 41 ) |
+        ( (uint64_t)( ( info.bits_per_sample - 1 ) & 0x1F )  << 36 ) |
+        ( (uint64_t)( info.total_samples & 0xFFFFFFFFFull ) );
+
+    for ( std::size_t byte = 0; byte < 8; byte++ )
+        block[10 + byte] = static_cast<uint8_t>( packed >> ( 56 - ( byte * 8 ) ) );
+
+    std::memcpy( &block[18], info.md5sum, 16 );
+    return block;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static FILE* openOutputFile( const fs::path& outputFile )
+{
+#if OURO_PLATFORM_WIN
+    return _wfopen( reinterpret_cast<const wchar_t*>( outputFile.u16string().c_str() ), L"w+b" );
+#else
+    return fopen( utf8::utf16to8( outputFile.u16string() ).c_str(), "w+b" );
+#endif
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// one recorded track; a libFLAC stream encoder whose output is gathered in memory and handed on to the writer thread
+struct FLACTrackEncoder final : public FLAC::Encoder::Stream
+{
+    FLACTrackEncoder( const uint32_t index, const uint32_t bufferSizeInSamples, const uint32_t bufferCount )
+        : m_index( index )
+    {
+        m_bufferStorage.reserve( bufferCount );
+        for ( uint32_t bI = 0; bI < bufferCount; bI++ )
+        {
+            m_bufferStorage.emplace_back( std::make_unique< base::IQ24Buffer >( bufferSizeInSamples ) );
+            m_freeBuffers.enqueue( m_bufferStorage.back().get() );
+        }
+    }
+
+    // FLAC::Encoder::Stream
+    FLAC__StreamEncoderWriteStatus write_callback( const FLAC__byte buffer[], size_t bytes, uint32_t samples, uint32_t current_frame ) override
+    {
+        m_encodedBytes.insert( m_encodedBytes.end(), buffer, buffer + bytes );
+        return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+    }
+
+    // called once from finish() with the completed STREAMINFO
+    void metadata_callback( const FLAC__StreamMetadata* metadata ) override
+    {
+        if ( metadata->type == FLAC__METADATA_TYPE_STREAMINFO )
+        {
+            m_finalStreamInfo = encodeStreamInfo( metadata->data.stream_info );
+            m_hasFinalStreamInfo = true;
+        }
+    }
+
+    // audio thread; returns false if the buffer rotation has run dry
+    bool acquireActiveBuffer()
+    {
+        if ( m_activeBuffer != nullptr )
+            return true;
+
+        if ( !m_freeBuffers.try_dequeue( m_activeBuffer ) )
+            return false;
+
+        m_activeBuffer->m_currentSamples = 0;
+        m_activeBuffer->m_committed      = false;
+        return true;
+    }
+
+
+    const uint32_t                                  m_index;
+
+    std::vector< std::unique_ptr< base::IQ24Buffer > > m_bufferStorage;
+    base::IQ24Buffer*                               m_activeBuffer          = nullptr;      // only touched by the audio thread
+    mcc::ConcurrentQueue< base::IQ24Buffer* >       m_freeBuffers;
+    mcc::ConcurrentQueue< base::IQ24Buffer* >       m_filledBuffers;
+
+    // set while this track is queued for, or being drained by, an encoder thread; ensures only one worker ever
+    // touches the encoder at a time and buffers are encoded in order
+    std::atomic_bool                                m_encodeScheduled       = false;
+
+    std::vector< uint8_t >                          m_encodedBytes;                         // libFLAC output not yet passed to the writer
+    StreamInfoBlock                                 m_finalStreamInfo;
+    bool                                            m_hasFinalStreamInfo    = false;
+
+    bool                                            m_overrunReported       = false;
+
+    std::atomic_uint64_t                            m_statEncodeTimeUs      = 0;
+    std::atomic_uint32_t                            m_statLastEncodeTimeUs  = 0;
+    std::atomic_uint64_t                            m_statSamplesEncoded    = 0;
+    std::atomic_uint64_t                            m_statBytesEncoded      = 0;
+    std::atomic_uint64_t                            m_statBytesWritten      = 0;
+    std::atomic_uint64_t                            m_statSamplesDropped    = 0;
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct FLACMultiTrackRecorder::State
+{
+    static constexpr uint32_t cTerminate = std::numeric_limits<uint32_t>::max();
+
+    struct WriteRequest
+    {
+        uint32_t                m_track     = cTerminate;
+        std::vector< uint8_t >  m_bytes;
+        bool                    m_finalise  = false;
+        StreamInfoBlock         m_streamInfo;
+        bool                    m_hasStreamInfo = false;
+    };
+
+    // the writer thread's view of one output file
+    struct OutputFile
+    {
+        ~OutputFile()
+        {
+            if ( m_file != nullptr )
+                fclose( m_file );
+            if ( m_staging != nullptr )
+                mem::free16( m_staging, mem::Tag::Recorder );
+        }
+
+        std::string     m_filenameU8;
+        FILE*           m_file          = nullptr;
+        uint8_t*        m_staging       = nullptr;      // cWriteAlignment aligned, m_writeBlockBytes long
+        std::size_t     m_stagingUsed   = 0;
+    };
+
+
+    State( const Config& config )
+        : m_config( config )
+        , m_readyTracks( 64 )
+    {
+        m_writeBlockBytes = std::max( cWriteAlignment, ( config.m_writeBlockBytes / cWriteAlignment ) * cWriteAlignment );
+    }
+
+    ~State()
+    {
+        // anything left in a partially filled buffer goes out as the final work item for each track
+        for ( auto& track : m_tracks )
+        {
+            if ( track->m_activeBuffer != nullptr &&
+                 track->m_activeBuffer->m_currentSamples > 0 )
+            {
+                track->m_filledBuffers.enqueue( track->m_activeBuffer );
+                track->m_activeBuffer = nullptr;
+                scheduleEncode( *track );
+            }
+        }
+
+        // wait for the encoders to run dry before stopping them
+        for ( auto& track : m_tracks )
+        {
+            while ( track->m_encodeScheduled.load( std::memory_order_acquire ) )
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        for ( std::size_t wI = 0; wI < m_encoderThreads.size(); wI++ )
+            m_readyTracks.enqueue( cTerminate );
+        for ( auto& encoderThread : m_encoderThreads )
+            encoderThread->join();
+        m_encoderThreads.clear();
+
+        // finish each stream here; libFLAC emits the last frames and the completed STREAMINFO, which then go to
+        // the writer as the final request for that file
+        for ( auto& track : m_tracks )
+        {
+            if ( track->is_valid() )
+                track->finish();
+
+            WriteRequest finalRequest;
+            finalRequest.m_track            = track->m_index;
+            finalRequest.m_bytes            = std::move( track->m_encodedBytes );
+            finalRequest.m_finalise         = true;
+            finalRequest.m_streamInfo       = track->m_finalStreamInfo;
+            finalRequest.m_hasStreamInfo    = track->m_hasFinalStreamInfo;
+            submitWrite( std::move( finalRequest ) );
+        }
+
+        if ( m_writerThread )
+        {
+            m_writeRequests.enqueue( WriteRequest{} );
+            m_writerThread->join();
+            m_writerThread = nullptr;
+        }
+    }
+
+    void launchThreads()
+    {
+        m_writerThread = std::make_unique<std::thread>( &State::writerThreadWorker, this );
+
+        for ( uint32_t eI = 0; eI < m_encoderThreadCount; eI++ )
+            m_encoderThreads.emplace_back( std::make_unique<std::thread>( &State::encoderThreadWorker, this, eI ) );
+    }
+
+    // from the audio thread (or the destructor) once a track has a full buffer waiting
+    void scheduleEncode( FLACTrackEncoder& track )
+    {
+        if ( !track.m_encodeScheduled.exchange( true, std::memory_order_acq_rel ) )
+            m_readyTracks.enqueue( track.m_index );
+    }
+
+    void submitWrite( WriteRequest&& request )
+    {
+        m_writeBacklogBytes[request.m_track] += request.m_bytes.size();
+        m_writeRequests.enqueue( std::move( request ) );
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    void drainTrack( FLACTrackEncoder& track )
+    {
+        for ( ;; )
+        {
+            base::IQ24Buffer* filledBuffer = nullptr;
+            while ( track.m_filledBuffers.try_dequeue( filledBuffer ) )
+            {
+                base::instr::ScopedEvent se( "FLAC", "encode", base::instr::PresetColour::Orange );
+
+                spacetime::Moment encodeTimer;
+
+                filledBuffer->quantise();
+                if ( !track.process_interleaved( filledBuffer->m_interleavedQuant, filledBuffer->m_currentSamples ) )
+                {
+                    blog::error::core( FMTX( "FLAC track {} processing failed ({})" ), track.m_index, track.get_state().as_cstring() );
+                }
+
+                const auto encodeUs = static_cast<uint32_t>( encodeTimer.delta< std::chrono::microseconds >().count() );
+
+                track.m_statEncodeTimeUs     += encodeUs;
+                track.m_statLastEncodeTimeUs  = encodeUs;
+                track.m_statSamplesEncoded   += filledBuffer->m_currentSamples;
+
+                filledBuffer->m_committed = true;
+                track.m_freeBuffers.enqueue( filledBuffer );
+            }
+
+            if ( !track.m_encodedBytes.empty() )
+            {
+                track.m_statBytesEncoded += track.m_encodedBytes.size();
+
+                WriteRequest request;
+                request.m_track = track.m_index;
+                request.m_bytes.swap( track.m_encodedBytes );
+                submitWrite( std::move( request ) );
+            }
+
+            // release the track; if the audio thread filled another buffer between our last dequeue and the release
+            // then it may have seen the flag still set and not scheduled it, so check again and claim it back
+            track.m_encodeScheduled.store( false, std::memory_order_release );
+            if ( track.m_filledBuffers.size_approx() == 0 ||
+                 track.m_encodeScheduled.exchange( true, std::memory_order_acq_rel ) )
+            {
+                break;
+            }
+        }
+    }
+
+    void encoderThreadWorker( const uint32_t workerIndex )
+    {
+        const auto threadName = fmt::format( FMTX( "{}FLAC:Encoder:{}" ), OURO_THREAD_PREFIX, workerIndex );
+        OuroveonThreadScope ots( threadName.c_str() );
+
+        for ( ;; )
+        {
+            uint32_t trackIndex = cTerminate;
+            m_readyTracks.wait_dequeue( trackIndex );
+
+            if ( trackIndex == cTerminate )
+                break;
+
+            drainTrack( *m_tracks[trackIndex] );
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    void writeStagingBlock( OutputFile& output, FLACTrackEncoder& track, const std::size_t bytes )
+    {
+        if ( bytes == 0 )
+            return;
+
+        const std::size_t written = fwrite( output.m_staging, 1, bytes, output.m_file );
+        if ( written != bytes && !m_writeErrorReported )
+        {
+            blog::error::core( FMTX( "FLAC write failed for [{}] ({})" ), output.m_filenameU8, std::strerror( errno ) );
+            m_writeErrorReported = true;
+        }
+
+        track.m_statBytesWritten += written;
+        m_writeBacklogBytes[track.m_index] -= bytes;
+    }
+
+    void processWrite( WriteRequest& request )
+    {
+        OutputFile& output = *m_outputs[request.m_track];
+        FLACTrackEncoder&      track  = *m_tracks[request.m_track];
+
+        const uint8_t* source    = request.m_bytes.data();
+        std::size_t    remaining = request.m_bytes.size();
+
+        while ( remaining > 0 )
+        {
+            const std::size_t toCopy = std::min( remaining, m_writeBlockBytes - output.m_stagingUsed );
+            std::memcpy( output.m_staging + output.m_stagingUsed, source, toCopy );
+
+            output.m_stagingUsed += toCopy;
+            source               += toCopy;
+            remaining            -= toCopy;
+
+            // only ever write whole blocks while recording, so file offsets stay block-aligned
+            if ( output.m_stagingUsed == m_writeBlockBytes )
+            {
+                writeStagingBlock( output, track, m_writeBlockBytes );
+                output.m_stagingUsed = 0;
+            }
+        }
+
+        if ( request.m_finalise )
+        {
+            writeStagingBlock( output, track, output.m_stagingUsed );
+            output.m_stagingUsed = 0;
+
+            if ( request.m_hasStreamInfo )
+            {
+                if ( fseek( output.m_file, cStreamInfoFileOffset, SEEK_SET ) != 0 ||
+                     fwrite( request.m_streamInfo.data(), 1, cStreamInfoBytes, output.m_file ) != cStreamInfoBytes )
+                {
+                    blog::error::core( FMTX( "FLAC unable to update STREAMINFO for [{}]" ), output.m_filenameU8 );
+                }
+            }
+
+            fclose( output.m_file );
+            output.m_file = nullptr;
+
+            blog::core( FMTX( "FLAC track {} closed, {} bytes written" ), track.m_index, track.m_statBytesWritten.load() );
+        }
+    }
+
+    void writerThreadWorker()
+    {
+        const auto threadName = fmt::format( FMTX( "{}FLAC:Writer" ), OURO_THREAD_PREFIX );
+        OuroveonThreadScope ots( threadName.c_str() );
+
+        for ( ;; )
+        {
+            WriteRequest request;
+            m_writeRequests.wait_dequeue( request );
+
+            if ( request.m_track == cTerminate )
+                break;
+
+            base::instr::ScopedEvent se( "FLAC", "write", base::instr::PresetColour::Amber );
+            processWrite( request );
+        }
+    }
+
+
+    Config                                          m_config;
+    std::size_t                                     m_writeBlockBytes       = 0;
+    uint32_t                                        m_encoderThreadCount    = 1;
+
+    std::vector< std::unique_ptr< FLACTrackEncoder > >         m_tracks;
+    std::vector< std::unique_ptr< OutputFile > >    m_outputs;
+    std::unique_ptr< std::atomic_uint64_t[] >       m_writeBacklogBytes;
+
+    mcc::BlockingConcurrentQueue< uint32_t >        m_readyTracks;
+    std::vector< std::unique_ptr< std::thread > >   m_encoderThreads;
+
+    mcc::BlockingConcurrentQueue< WriteRequest >    m_writeRequests;
+    std::unique_ptr< std::thread >                  m_writerThread;
+    bool                                            m_writeErrorReported    = false;
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// adapter that lets a single track slot into anything expecting a sample stream processor
+struct FLACTrackProcessor final : public ISampleStreamProcessor
+{
+    FLACTrackProcessor( const FLACMultiTrackRecorder::SharedPtr& recorder, const std::size_t trackIndex )
+        : ISampleStreamProcessor( ISampleStreamProcessor::allocateNewInstanceID() )
+        , m_recorder( recorder )
+        , m_trackIndex( trackIndex )
+    {}
+
+    void appendSamples( float* buffer0, float* buffer1, const uint32_t sampleCount ) override
+    {
+        m_recorder->appendSamples( m_trackIndex, buffer0, buffer1, sampleCount );
+    }
+
+    uint64_t getStorageUsageInBytes() const override
+    {
+        return m_recorder->getStorageUsageInBytes( m_trackIndex );
+    }
+
+    FLACMultiTrackRecorder::SharedPtr   m_recorder;
+    std::size_t                         m_trackIndex;
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< FLACMultiTrackRecorder::SharedPtr > FLACMultiTrackRecorder::Create(
+    const std::vector< fs::path >&  outputFiles,
+    const uint32_t                  sampleRate,
+    const Config&                   config )
+{
+    if ( outputFiles.empty() )
+        return absl::InvalidArgumentError( "no output files given" );
+
+    const uint32_t trackCount = static_cast<uint32_t>( outputFiles.size() );
+
+    auto newState = std::make_unique< State >( config );
+
+    newState->m_encoderThreadCount = config.m_encoderThreads;
+    if ( newState->m_encoderThreadCount == 0 )
+        newState->m_encoderThreadCount = std::max( 1U, std::thread::hardware_concurrency() / 4 );
+    newState->m_encoderThreadCount = std::clamp( newState->m_encoderThreadCount, 1U, trackCount );
+
+    newState->m_writeBacklogBytes = std::make_unique< std::atomic_uint64_t[] >( trackCount );
+
+    // stagger buffer lengths so that tracks do not all fill up and queue for encoding on the same callback
+    math::RNG32 bufferSizeShuffleRNG;
+    const float bufferInSeconds = std::max( 0.25f, config.m_bufferInSeconds );
+
+    // if any track fails to start, close everything opened so far and delete those files rather than leave a set of
+    // empty or half-initialised FLACs behind in the output directory
+    std::vector< fs::path > openedFiles;
+    const auto abandonCreate = [&]( absl::Status failure ) -> absl::Status
+    {
+        newState.reset();
+        for ( const auto& openedFile : openedFiles )
+        {
+            std::error_code removeError;
+            if ( !fs::remove( openedFile, removeError ) && removeError )
+                blog::error::core( FMTX( "FLAC unable to remove partial file [{}] ({})" ), openedFile.string(), removeError.message() );
+        }
+        return failure;
+    };
+
+    for ( uint32_t tI = 0; tI < trackCount; tI++ )
+    {
+        const std::string outputFileU8 = utf8::utf16to8( outputFiles[tI].u16string() );
+
+        const uint32_t bufferSizeInSamples = (uint32_t)std::ceil( (float)sampleRate * bufferInSeconds * bufferSizeShuffleRNG.genFloat( 0.75f, 1.25f ) );
+
+        auto track = std::make_unique< FLACTrackEncoder >( tI, bufferSizeInSamples, std::max( 2U, config.m_buffersPerTrack ) );
+
+        bool flacConfig = true;
+        flacConfig &= track->set_verify( config.m_encoder.m_verify );
+        flacConfig &= track->set_compression_level( std::clamp( config.m_encoder.m_compressionLevel, 0, 8 ) );
+        flacConfig &= track->set_channels( 2 );
+        flacConfig &= track->set_bits_per_sample( 24 );
+        flacConfig &= track->set_sample_rate( sampleRate );
+        if ( !flacConfig )
+            return abandonCreate( absl::InternalError( fmt::format( FMTX( "FLAC failed to configure encoder for [{}]" ), outputFileU8 ) ) );
+
+        auto output = std::make_unique< State::OutputFile >();
+        output->m_filenameU8 = outputFileU8;
+        output->m_file       = openOutputFile( outputFiles[tI] );
+        if ( output->m_file == nullptr )
+            return abandonCreate( absl::UnavailableError( fmt::format( FMTX( "FLAC could not open [{}] for writing ({})" ), outputFileU8, std::strerror( errno ) ) ) );
+
+        openedFiles.emplace_back( outputFiles[tI] );
+
+        // the writer batches everything itself, stdio buffering would only split our blocks up again
+        setvbuf( output->m_file, nullptr, _IONBF, 0 );
+        output->m_staging = mem::allocAligned<uint8_t>( cWriteAlignment, newState->m_writeBlockBytes, mem::Tag::Recorder );
+
+        // hand the file to the state straight away so that abandoning the create closes it before deletion
+        newState->m_outputs.emplace_back( std::move( output ) );
+
+        // init writes the stream marker and initial metadata through write_callback; these go out with the first
+        // batch of encoded audio
+        const FLAC__StreamEncoderInitStatus flacInit = track->init();
+        if ( flacInit != FLAC__STREAM_ENCODER_INIT_STATUS_OK )
+            return abandonCreate( absl::InternalError( fmt::format( FMTX( "FLAC unable to begin stream ({}) for file [{}]" ), FLAC__StreamEncoderInitStatusString[flacInit], outputFileU8 ) ) );
+
+        newState->m_tracks.emplace_back( std::move( track ) );
+    }
+
+    newState->launchThreads();
+
+    blog::core( FMTX( "FLAC multitrack recorder : {} tracks, {} encoder threads, level {}{}" ),
+        trackCount,
+        newState->m_encoderThreadCount,
+        config.m_encoder.m_compressionLevel,
+        config.m_encoder.m_verify ? ", verifying" : "" );
+
+    auto recorder = base::protected_make_shared< FLACMultiTrackRecorder >( newState );
+    recorder->m_weakThis = recorder;
+    return recorder;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+FLACMultiTrackRecorder::FLACMultiTrackRecorder( std::unique_ptr< State >& state )
+    : m_state( std::move( state ) )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+FLACMultiTrackRecorder::~FLACMultiTrackRecorder()
+{
+    m_state.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void FLACMultiTrackRecorder::appendSamples( const std::size_t trackIndex, float* buffer0, float* buffer1, const uint32_t sampleCount )
+{
+    ABSL_ASSERT( trackIndex < m_state->m_tracks.size() );
+    FLACTrackEncoder& track = *m_state->m_tracks[trackIndex];
+
+    uint32_t readOffset       = 0;
+    uint32_t samplesRemaining = sampleCount;
+
+    while ( samplesRemaining > 0 )
+    {
+        if ( !track.acquireActiveBuffer() )
+        {
+            // every buffer is waiting on an encoder; drop this block rather than stall the audio thread
+            track.m_statSamplesDropped += samplesRemaining;
+            if ( !track.m_overrunReported )
+            {
+                blog::error::core( FMTX( "FLAC track {} encoder backlog, dropping samples" ), trackIndex );
+                track.m_overrunReported = true;
+            }
+            return;
+        }
+
+        base::IQ24Buffer* activeBuffer = track.m_activeBuffer;
+
+        const uint32_t pageRemaining = activeBuffer->m_maximumSamples - activeBuffer->m_currentSamples;
+        const uint32_t samplesToCopy = std::min( samplesRemaining, pageRemaining );
+
+        float* currentFpPos = &activeBuffer->m_interleavedFloat[activeBuffer->m_currentSamples * 2];
+        for ( size_t idxIn = 0, idxOut = 0; idxIn < samplesToCopy; idxIn++, idxOut += 2 )
+        {
+            currentFpPos[idxOut + 0] = buffer0[readOffset + idxIn];
+            currentFpPos[idxOut + 1] = buffer1[readOffset + idxIn];
+        }
+
+        activeBuffer->m_currentSamples += samplesToCopy;
+        readOffset                     += samplesToCopy;
+        samplesRemaining               -= samplesToCopy;
+
+        // buffer complete, hand it over to the encoder pool
+        if ( activeBuffer->m_currentSamples == activeBuffer->m_maximumSamples )
+        {
+            track.m_filledBuffers.enqueue( activeBuffer );
+            track.m_activeBuffer = nullptr;
+
+            m_state->scheduleEncode( track );
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr< ISampleStreamProcessor > FLACMultiTrackRecorder::getTrackProcessor( const std::size_t trackIndex )
+{
+    ABSL_ASSERT( trackIndex < m_state->m_tracks.size() );
+    return std::make_shared< FLACTrackProcessor >( m_weakThis.lock(), trackIndex );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t FLACMultiTrackRecorder::getTrackCount() const
+{
+    return m_state->m_tracks.size();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint64_t FLACMultiTrackRecorder::getStorageUsageInBytes() const
+{
+    uint64_t usage = 0;
+    for ( const auto& track : m_state->m_tracks )
+        usage += track->m_statBytesEncoded;
+
+    return usage;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint64_t FLACMultiTrackRecorder::getStorageUsageInBytes( const std::size_t trackIndex ) const
+{
+    ABSL_ASSERT( trackIndex < m_state->m_tracks.size() );
+    return m_state->m_tracks[trackIndex]->m_statBytesEncoded;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void FLACMultiTrackRecorder::getTrackStatistics( std::vector< TrackStatistics >& statistics ) const
+{
+    statistics.resize( m_state->m_tracks.size() );
+
+    for ( std::size_t tI = 0; tI < m_state->m_tracks.size(); tI++ )
+    {
+        const FLACTrackEncoder& track = *m_state->m_tracks[tI];
+        TrackStatistics& stats = statistics[tI];
+
+        stats.m_encodeTimeUs        = track.m_statEncodeTimeUs;
+        stats.m_lastEncodeTimeUs    = track.m_statLastEncodeTimeUs;
+        stats.m_samplesEncoded      = track.m_statSamplesEncoded;
+        stats.m_bytesEncoded        = track.m_statBytesEncoded;
+        stats.m_bytesWritten        = track.m_statBytesWritten;
+        stats.m_encodeBacklog       = static_cast<uint32_t>( track.m_filledBuffers.size_approx() );
+        stats.m_writeBacklogBytes   = m_state->m_writeBacklogBytes[tI];
+        stats.m_samplesDropped      = track.m_statSamplesDropped;
+    }
+}
+
+} // namespace ssp
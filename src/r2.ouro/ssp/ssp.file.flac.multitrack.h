@@ -0,0 +1,86 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  multitrack FLAC recorder; rather than one encoder thread and one file stream per track, all tracks share a small
+//  pool of encoder threads (each track's buffers are still encoded strictly in order, one worker at a time) and a
+//  single writer thread that gathers encoded output into large, block-aligned writes per file
+//
+
+#pragma once
+#include "base/construction.h"
+
+#include "ssp/ssp.file.flac.h"
+
+namespace ssp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+class FLACMultiTrackRecorder
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( FLACMultiTrackRecorder );
+
+    using SharedPtr = std::shared_ptr< FLACMultiTrackRecorder >;
+
+    struct Config
+    {
+        FLACEncoderOptions  m_encoder;
+
+        uint32_t            m_encoderThreads        = 0;                // 0 picks a count from the core count, capped at the track count
+        float               m_bufferInSeconds       = 1.0f;             // audio gathered per encode work item, staggered per track
+        uint32_t            m_buffersPerTrack       = 4;                // buffers in rotation; running out means the encoders have fallen behind
+        uint32_t            m_writeBlockBytes       = 1024 * 1024;      // writes are issued in whole blocks of this size, rounded to cWriteAlignment
+    };
+
+    static constexpr uint32_t cWriteAlignment = 4096;
+
+    // per-track counters, safe to read from any thread while recording
+    struct TrackStatistics
+    {
+        uint64_t    m_encodeTimeUs          = 0;    // total time spent in libFLAC
+        uint32_t    m_lastEncodeTimeUs      = 0;    // time taken by the most recent buffer
+        uint64_t    m_samplesEncoded        = 0;
+        uint64_t    m_bytesEncoded          = 0;
+        uint64_t    m_bytesWritten          = 0;    // bytes that have actually reached the file
+        uint32_t    m_encodeBacklog         = 0;    // full buffers waiting for an encoder
+        uint64_t    m_writeBacklogBytes     = 0;    // encoded bytes waiting for the writer
+        uint64_t    m_samplesDropped        = 0;    // samples lost because no free buffer was available
+    };
+
+    // open one FLAC file per entry in outputFiles
+    static absl::StatusOr< SharedPtr > Create(
+        const std::vector< fs::path >&  outputFiles,
+        const uint32_t                  sampleRate,
+        const Config&                   config );
+
+    // flushes any buffered audio, finishes every encoder and closes the files; blocks until all data is on disk
+    ~FLACMultiTrackRecorder();
+
+    // called from the audio thread
+    void appendSamples( const std::size_t trackIndex, float* buffer0, float* buffer1, const uint32_t sampleCount );
+
+    // a sample stream processor that feeds a single track; each keeps the recorder alive, so the recorder finishes
+    // once the last of these (and any direct reference) is released
+    std::shared_ptr< ISampleStreamProcessor > getTrackProcessor( const std::size_t trackIndex );
+
+    ouro_nodiscard std::size_t getTrackCount() const;
+    ouro_nodiscard uint64_t getStorageUsageInBytes() const;
+    ouro_nodiscard uint64_t getStorageUsageInBytes( const std::size_t trackIndex ) const;
+
+    void getTrackStatistics( std::vector< TrackStatistics >& statistics ) const;
+
+private:
+
+    struct State;
+    std::unique_ptr< State >    m_state;
+
+    std::weak_ptr< FLACMultiTrackRecorder > m_weakThis;
+
+protected:
+
+    FLACMultiTrackRecorder( std::unique_ptr< State >& state );
+};
+
+} // namespace ssp
@@ -39,50 +39,85 @@ ouro_nodiscard constexpr const char* getOpusErrorString( const int32_t err )
 
 
 // ---------------------------------------------------------------------------------------------------------------------
-OpusPacketData::OpusPacketData( const uint32_t packetCount )
-    : m_opusDataBufferSize( packetCount * OpusStream::cFrameSize )
+OpusPacketData::OpusPacketData( const uint32_t packetCount, const uint32_t maxPacketBytes )
+    : m_opusDataBufferSize( packetCount * maxPacketBytes )
 {
-    m_opusData = mem::alloc16To< uint8_t >( m_opusDataBufferSize, 0 );
+    m_opusData = mem::alloc16To< uint8_t >( m_opusDataBufferSize, 0, mem::Tag::Recorder );
     m_opusPacketSizes.reserve( packetCount );
 }
 
 OpusPacketData::~OpusPacketData()
 {
     if ( m_opusData != nullptr )
-        mem::free16( m_opusData );
+        mem::free16( m_opusData, mem::Tag::Recorder );
     m_opusData = nullptr;
 }
 
+std::unique_ptr< OpusPacketData > OpusPacketData::clone() const
+{
+    uint32_t usedBytes = 0;
+    for ( const auto packetSize : m_opusPacketSizes )
+        usedBytes += packetSize;
+
+    // one tightly-sized buffer holding just the encoded packets
+    auto result = std::make_unique< OpusPacketData >( 1, std::max( usedBytes, 1U ) );
+
+    std::memcpy( result->m_opusData, m_opusData, usedBytes );
+    result->m_opusPacketSizes   = m_opusPacketSizes;
+    result->m_averagePacketSize = m_averagePacketSize;
+    return result;
+}
+
 
 // ---------------------------------------------------------------------------------------------------------------------
-// 
-struct OpusStream::StreamInstance final : public AsyncBufferProcessorIQ16
+// sink that hands a private copy of each block to a callback, which is then free to consume it at its own pace
+struct CallbackSink final : public IOpusSink
 {
-    StreamInstance()
-        : AsyncBufferProcessorIQ16( OpusStream::cFrameSize * OpusStream::cBufferedFrames, "OPUS" )
+    CallbackSink( const OpusStream::NewDataCallback& callback )
+        : m_callback( callback )
+    {}
+
+    const char* getSinkName() const override { return "callback"; }
+
+    void beginStream( const OpusStreamInfo& ) override {}
+
+    void consumePackets( const OpusPacketData& packets ) override
     {
-        launchProcessorThread();
+        m_callback( packets.clone() );
     }
 
-    ~StreamInstance()
-    {
-        // stop processing thread
-        terminateProcessorThread();
+    OpusStream::NewDataCallback     m_callback;
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// one encoder and the sinks it feeds
+struct EncoderLane
+{
+    DECLARE_NO_COPY_NO_MOVE( EncoderLane );
+
+    EncoderLane( const OpusStream::LaneID laneID )
+        : m_laneID( laneID )
+    {}
 
+    ~EncoderLane()
+    {
         if ( m_opusEncoder != nullptr )
         {
             opus_encoder_destroy( m_opusEncoder );
             m_opusEncoder = nullptr;
         }
-        if ( m_opusRepacketizer != nullptr )
-        {
-            opus_repacketizer_destroy( m_opusRepacketizer );
-            m_opusRepacketizer = nullptr;
-        }
     }
 
-    absl::Status initialiseEncoder( const uint32_t sampleRate )
+    absl::Status initialise( const uint32_t sampleRate, const OpusStream::LaneSetup& setup, const int32_t complexity )
     {
+        m_frameSize = static_cast<uint32_t>( setup.m_frameSize );
+        if ( OpusStream::cBlockSize % m_frameSize != 0 )
+        {
+            return absl::InvalidArgumentError( fmt::format(
+                FMTX( "opus frame size {} does not divide into the {} sample block size" ), m_frameSize, OpusStream::cBlockSize ) );
+        }
+
         int32_t opusError = 0;
         m_opusEncoder = opus_encoder_create( sampleRate, 2, OPUS_APPLICATION_AUDIO, &opusError );
         if ( opusError )
@@ -91,112 +126,210 @@ struct OpusStream::StreamInstance final : public AsyncBufferProcessorIQ16
                 FMTX( "opus_encoder_create failed with error {} ({})" ), opusError, getOpusErrorString( opusError ) ) );
         }
 
-        opus_encoder_ctl( m_opusEncoder, OPUS_SET_COMPLEXITY( 10 ) );
+        opus_encoder_ctl( m_opusEncoder, OPUS_SET_COMPLEXITY( complexity ) );
         opus_encoder_ctl( m_opusEncoder, OPUS_SET_SIGNAL( OPUS_SIGNAL_MUSIC ) );
 
-        opus_encoder_ctl( m_opusEncoder, OPUS_SET_BITRATE( 64000 ) );
-        opus_encoder_ctl( m_opusEncoder, OPUS_GET_BITRATE( &m_compressionSetup.m_bitrate ) );
+        applyCompressionSetup( setup.m_compression );
 
-        opus_encoder_ctl( m_opusEncoder, OPUS_SET_PACKET_LOSS_PERC( 0 ) );
-        opus_encoder_ctl( m_opusEncoder, OPUS_GET_PACKET_LOSS_PERC( &m_compressionSetup.m_expectedPacketLossPercent ) );
+        int32_t lookahead = 0;
+        opus_encoder_ctl( m_opusEncoder, OPUS_GET_LOOKAHEAD( &lookahead ) );
 
-        m_opusRepacketizer = opus_repacketizer_create();
+        m_streamInfo.m_sampleRate   = sampleRate;
+        m_streamInfo.m_channels     = 2;
+        m_streamInfo.m_frameSize    = m_frameSize;
+        m_streamInfo.m_preSkip      = static_cast<uint32_t>( lookahead );
+        m_streamInfo.m_bitrate      = m_compressionSetup.m_bitrate;
 
         return absl::OkStatus();
     }
 
+    void applyCompressionSetup( const OpusStream::CompressionSetup& setup )
+    {
+        opus_encoder_ctl( m_opusEncoder, OPUS_SET_BITRATE( setup.m_bitrate ) );
+        opus_encoder_ctl( m_opusEncoder, OPUS_GET_BITRATE( &m_compressionSetup.m_bitrate ) );
 
-    static constexpr size_t cEncodeBufferSize = 65536;
-    uint8_t threadEncoderBuffer[cEncodeBufferSize] = { 0 };
+        opus_encoder_ctl( m_opusEncoder, OPUS_SET_INBAND_FEC( setup.m_expectedPacketLossPercent > 0 ? 1 : 0 ) );
+        opus_encoder_ctl( m_opusEncoder, OPUS_SET_PACKET_LOSS_PERC( setup.m_expectedPacketLossPercent ) );
+        opus_encoder_ctl( m_opusEncoder, OPUS_GET_PACKET_LOSS_PERC( &m_compressionSetup.m_expectedPacketLossPercent ) );
+    }
 
-    void processBufferedSamplesFromThread( const base::IQ16Buffer& buffer ) override
+    // encode a full block straight into a packet data instance, then hand it to each sink in turn
+    void encodeBlock( const base::IQ16Buffer& buffer )
     {
-        const uint32_t packetsInStream = buffer.m_currentSamples / OpusStream::cFrameSize;
-        auto packetDataInstance = std::make_unique< OpusPacketData >( packetsInStream );
-
-        uint32_t totalPackets = 0;
-        uint32_t totalPacketSizes = 0;
+        const uint32_t packetsInBlock = buffer.m_currentSamples / m_frameSize;
+        if ( packetsInBlock == 0 || m_sinks.empty() )
+            return;
 
-        int64_t remainingSamples = buffer.m_currentSamples;
-        
-        float* fltInput = buffer.m_interleavedFloat;
-        opus_int16* pcmInput = (opus_int16*)(buffer.m_interleavedQuant);
-        uint8_t* opusOut = packetDataInstance->m_opusData;
+        OpusPacketData packetData( packetsInBlock, OpusStream::cMaxPacketBytes );
 
-        memset( threadEncoderBuffer, 0, cEncodeBufferSize );
+        const opus_int16* pcmInput = (const opus_int16*)( buffer.m_interleavedQuant );
+        uint8_t* opusOut = packetData.m_opusData;
 
-        for ( uint32_t pk = 0; pk < packetsInStream; pk ++ )
+        uint32_t totalPacketSizes = 0;
+        for ( uint32_t pk = 0; pk < packetsInBlock; pk++ )
         {
-            int ret = opus_encode( m_opusEncoder, pcmInput, OpusStream::cFrameSize, threadEncoderBuffer, cEncodeBufferSize );
-
-            if ( ret > 0 )
-            {
-                m_opusRepacketizer = opus_repacketizer_init( m_opusRepacketizer );
-
-                int retval = opus_repacketizer_cat( m_opusRepacketizer, threadEncoderBuffer, ret );
-                if ( retval != OPUS_OK ) 
-                {
-                    blog::error::core( "opus_repacketizer_cat(): {}", opus_strerror( retval ) );
-                    break;
-                }
-
-                retval = opus_repacketizer_out( m_opusRepacketizer, opusOut, cEncodeBufferSize );
-                if ( retval < 0 )
-                {
-                    blog::error::core( "opus_repacketizer_cat(): {}", opus_strerror( retval ) );
-                    break;
-                }
-
-                opusOut += retval;
-                packetDataInstance->m_opusPacketSizes.push_back( retval );
-
-                totalPackets++;
-                totalPacketSizes += retval;
-            }
-            else
+            const int32_t encodedBytes = opus_encode( m_opusEncoder, pcmInput, m_frameSize, opusOut, OpusStream::cMaxPacketBytes );
+            if ( encodedBytes <= 0 )
             {
-                blog::error::core( "opus_encode(): {}", opus_strerror( ret ) );
+                blog::error::core( "opus_encode(): {}", opus_strerror( encodedBytes ) );
                 break;
             }
 
-            pcmInput += OpusStream::cFrameSize * 2;
-            fltInput += OpusStream::cFrameSize * 2;
+            opusOut += encodedBytes;
+            packetData.m_opusPacketSizes.push_back( static_cast<uint16_t>( encodedBytes ) );
+            totalPacketSizes += encodedBytes;
 
-            remainingSamples -= OpusStream::cFrameSize;
+            pcmInput += m_frameSize * 2;
         }
-        ABSL_ASSERT( remainingSamples == 0 );
 
+        if ( packetData.m_opusPacketSizes.empty() )
+            return;
 
-        packetDataInstance->m_averagePacketSize = ( totalPacketSizes / totalPackets );
+        packetData.m_averagePacketSize = totalPacketSizes / static_cast<uint32_t>( packetData.m_opusPacketSizes.size() );
 
-        m_newDataCallback( std::move( packetDataInstance ) );
+        for ( const auto& sink : m_sinks )
+            sink->consumePackets( packetData );
     }
 
-    CompressionSetup                m_compressionSetup;
+    OpusStream::LaneID              m_laneID;
+    uint32_t                        m_frameSize             = OpusStream::cFrameSize;
+    OpusStream::CompressionSetup    m_compressionSetup;
+    OpusStreamInfo                  m_streamInfo;
 
     OpusEncoder*                    m_opusEncoder           = nullptr;
-    OpusRepacketizer*               m_opusRepacketizer      = nullptr;
+    std::vector< OpusSinkPtr >      m_sinks;
+};
+using EncoderLanePtr = std::unique_ptr< EncoderLane >;
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+//
+struct OpusStream::StreamInstance final : public AsyncBufferProcessorIQ16
+{
+    StreamInstance( const uint32_t sampleRate )
+        : AsyncBufferProcessorIQ16( OpusStream::cBlockSize, "OPUS" )
+        , m_sampleRate( sampleRate )
+    {
+        launchProcessorThread();
+    }
+
+    ~StreamInstance()
+    {
+        // stop processing thread
+        terminateProcessorThread();
 
+        m_lanes.clear();
+    }
+
+    absl::StatusOr< LaneID > addLane( const LaneSetup& setup )
+    {
+        auto newLane = std::make_unique< EncoderLane >( LaneID( m_nextLaneID++ ) );
+
+        const auto initStatus = newLane->initialise( m_sampleRate, setup, m_complexity );
+        if ( !initStatus.ok() )
+            return initStatus;
+
+        const LaneID newLaneID = newLane->m_laneID;
+
+        std::scoped_lock<std::mutex> laneLock( m_laneMutex );
+        m_lanes.emplace_back( std::move( newLane ) );
+
+        blog::core( FMTX( "OPUS lane {} added ({} bps, {} sample frames)" ), newLaneID.get(), setup.m_compression.m_bitrate, static_cast<uint32_t>( setup.m_frameSize ) );
+        return newLaneID;
+    }
+
+    // call with m_laneMutex held
+    EncoderLane* findLane( const LaneID laneID ) const
+    {
+        for ( const auto& lane : m_lanes )
+        {
+            if ( lane->m_laneID == laneID )
+                return lane.get();
+        }
+        return nullptr;
+    }
 
-    NewDataCallback                 m_newDataCallback       = nullptr;
+    void processBufferedSamplesFromThread( const base::IQ16Buffer& buffer ) override
+    {
+        const auto encodeStart = std::chrono::steady_clock::now();
+
+        {
+            std::scoped_lock<std::mutex> laneLock( m_laneMutex );
+            for ( const auto& lane : m_lanes )
+            {
+                lane->encodeBlock( buffer );
+            }
+            updateAdaptiveComplexity( encodeStart, buffer.m_currentSamples );
+        }
+    }
+
+    // compare how long the block took against how much audio it held; step complexity down a notch when over
+    // budget, back up when comfortably under. one step per block keeps it from oscillating on a single slow block
+    void updateAdaptiveComplexity( const std::chrono::steady_clock::time_point encodeStart, const uint32_t sampleCount )
+    {
+        if ( sampleCount == 0 || m_lanes.empty() )
+            return;
+
+        const double encodeSec = std::chrono::duration<double>( std::chrono::steady_clock::now() - encodeStart ).count();
+        const double audioSec  = (double)sampleCount / (double)m_sampleRate;
+
+        const float encodeLoad = static_cast<float>( encodeSec / audioSec );
+        m_encodeLoad = encodeLoad;
+
+        int32_t newComplexity = m_complexity;
+        if ( encodeLoad > OpusStream::cEncodeBudgetHigh && newComplexity > OpusStream::cComplexityMin )
+            newComplexity--;
+        else if ( encodeLoad < OpusStream::cEncodeBudgetLow && newComplexity < OpusStream::cComplexityMax )
+            newComplexity++;
+
+        if ( newComplexity == m_complexity )
+            return;
+
+        for ( const auto& lane : m_lanes )
+            opus_encoder_ctl( lane->m_opusEncoder, OPUS_SET_COMPLEXITY( newComplexity ) );
+
+        blog::core( FMTX( "OPUS complexity {} -> {} (encode load {:.1f}%)" ), m_complexity.load(), newComplexity, encodeLoad * 100.0f );
+        m_complexity = newComplexity;
+    }
+
+    const uint32_t                  m_sampleRate;
+
+    mutable std::mutex              m_laneMutex;
+    std::vector< EncoderLanePtr >   m_lanes;
+    uint32_t                        m_nextLaneID            = 1;
+
+    std::atomic_int32_t             m_complexity            = OpusStream::cComplexityMax;
+    std::atomic< float >            m_encodeLoad            = 0.0f;
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+OpusStream::PtrOrStatus OpusStream::Create( const uint32_t sampleRate )
+{
+    std::unique_ptr< OpusStream::StreamInstance > newState = std::make_unique< OpusStream::StreamInstance >( sampleRate );
+
+    return PtrOrStatus( base::protected_make_shared<OpusStream>( ISampleStreamProcessor::allocateNewInstanceID(), newState ) );
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 OpusStream::PtrOrStatus OpusStream::Create(
     const NewDataCallback&  newDataCallback,
     const uint32_t          sampleRate )
 {
-    std::unique_ptr< OpusStream::StreamInstance > newState = std::make_unique< OpusStream::StreamInstance >();
+    auto streamOrStatus = Create( sampleRate );
+    if ( !streamOrStatus.ok() )
+        return streamOrStatus;
 
-    const auto encoderStatus = newState->initialiseEncoder( sampleRate );
-    if ( !encoderStatus.ok() )
-    {
-        return encoderStatus;
-    }
+    auto stream = *streamOrStatus;
 
-    newState->m_newDataCallback = newDataCallback;
+    const auto laneOrStatus = stream->addLane( LaneSetup{} );
+    if ( !laneOrStatus.ok() )
+        return laneOrStatus.status();
 
-    return PtrOrStatus( base::protected_make_shared<OpusStream>( ISampleStreamProcessor::allocateNewInstanceID(), newState ) );
+    const auto sinkStatus = stream->attachSink( *laneOrStatus, std::make_shared< CallbackSink >( newDataCallback ) );
+    if ( !sinkStatus.ok() )
+        return sinkStatus;
+
+    return stream;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -208,31 +341,127 @@ void OpusStream::appendSamples( float* buffer0, float* buffer1, const uint32_t s
 // ---------------------------------------------------------------------------------------------------------------------
 uint64_t OpusStream::getStorageUsageInBytes() const
 {
-    return OpusStream::cFrameSize * OpusStream::cBufferedFrames * 2;
+    return OpusStream::cBlockSize * 2;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< OpusStream::LaneID > OpusStream::addLane( const LaneSetup& setup )
+{
+    return m_state->addLane( setup );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status OpusStream::removeLane( const LaneID laneID )
+{
+    std::scoped_lock<std::mutex> laneLock( m_state->m_laneMutex );
+
+    auto& lanes = m_state->m_lanes;
+    const auto it = std::find_if( lanes.begin(), lanes.end(), [laneID]( const EncoderLanePtr& lane ) { return lane->m_laneID == laneID; } );
+    if ( it == lanes.end() )
+        return absl::NotFoundError( fmt::format( FMTX( "OPUS lane {} not found" ), laneID.get() ) );
+
+    lanes.erase( it );
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status OpusStream::attachSink( const LaneID laneID, const OpusSinkPtr& sink )
+{
+    std::scoped_lock<std::mutex> laneLock( m_state->m_laneMutex );
+
+    EncoderLane* lane = m_state->findLane( laneID );
+    if ( lane == nullptr )
+        return absl::NotFoundError( fmt::format( FMTX( "OPUS lane {} not found" ), laneID.get() ) );
+
+    sink->beginStream( lane->m_streamInfo );
+    lane->m_sinks.emplace_back( sink );
+
+    blog::core( FMTX( "OPUS lane {} feeding sink [{}]" ), laneID.get(), sink->getSinkName() );
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status OpusStream::detachSink( const LaneID laneID, const OpusSinkPtr& sink )
+{
+    std::scoped_lock<std::mutex> laneLock( m_state->m_laneMutex );
+
+    EncoderLane* lane = m_state->findLane( laneID );
+    if ( lane == nullptr )
+        return absl::NotFoundError( fmt::format( FMTX( "OPUS lane {} not found" ), laneID.get() ) );
+
+    const auto it = std::find( lane->m_sinks.begin(), lane->m_sinks.end(), sink );
+    if ( it == lane->m_sinks.end() )
+        return absl::NotFoundError( "sink not attached to this lane" );
+
+    lane->m_sinks.erase( it );
+    return absl::OkStatus();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 OpusStream::CompressionSetup OpusStream::getCurrentCompressionSetup() const
 {
-    return m_state->m_compressionSetup;
+    std::scoped_lock<std::mutex> laneLock( m_state->m_laneMutex );
+
+    if ( m_state->m_lanes.empty() )
+        return {};
+
+    return m_state->m_lanes.front()->m_compressionSetup;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 void OpusStream::setCompressionSetup( const OpusStream::CompressionSetup& setup )
 {
-    if ( m_state->m_compressionSetup.m_bitrate != setup.m_bitrate )
+    LaneID firstLaneID = LaneID::invalid();
     {
-        opus_encoder_ctl( m_state->m_opusEncoder, OPUS_SET_BITRATE( setup.m_bitrate ) );
-        blog::core( "OPUS_SET_BITRATE({})", setup.m_bitrate );
+        std::scoped_lock<std::mutex> laneLock( m_state->m_laneMutex );
+        if ( m_state->m_lanes.empty() )
+            return;
+
+        firstLaneID = m_state->m_lanes.front()->m_laneID;
     }
-    if ( m_state->m_compressionSetup.m_expectedPacketLossPercent != setup.m_expectedPacketLossPercent )
+    std::ignore = setCompressionSetup( firstLaneID, setup );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< OpusStream::CompressionSetup > OpusStream::getCurrentCompressionSetup( const LaneID laneID ) const
+{
+    std::scoped_lock<std::mutex> laneLock( m_state->m_laneMutex );
+
+    const EncoderLane* lane = m_state->findLane( laneID );
+    if ( lane == nullptr )
+        return absl::NotFoundError( fmt::format( FMTX( "OPUS lane {} not found" ), laneID.get() ) );
+
+    return lane->m_compressionSetup;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status OpusStream::setCompressionSetup( const LaneID laneID, const CompressionSetup& setup )
+{
+    std::scoped_lock<std::mutex> laneLock( m_state->m_laneMutex );
+
+    EncoderLane* lane = m_state->findLane( laneID );
+    if ( lane == nullptr )
+        return absl::NotFoundError( fmt::format( FMTX( "OPUS lane {} not found" ), laneID.get() ) );
+
+    if ( lane->m_compressionSetup.m_bitrate != setup.m_bitrate ||
+         lane->m_compressionSetup.m_expectedPacketLossPercent != setup.m_expectedPacketLossPercent )
     {
-        opus_encoder_ctl( m_state->m_opusEncoder, OPUS_SET_INBAND_FEC( setup.m_expectedPacketLossPercent > 0 ? 1 : 0 ) );
-        opus_encoder_ctl( m_state->m_opusEncoder, OPUS_SET_PACKET_LOSS_PERC( setup.m_expectedPacketLossPercent ) );
-        blog::core( "OPUS_SET_PACKET_LOSS_PERC({})", setup.m_expectedPacketLossPercent );
+        lane->applyCompressionSetup( setup );
+        blog::core( "OPUS lane {} : bitrate {}, packet loss {}%", laneID.get(), lane->m_compressionSetup.m_bitrate, lane->m_compressionSetup.m_expectedPacketLossPercent );
     }
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t OpusStream::getCurrentComplexity() const
+{
+    return m_state->m_complexity;
+}
 
-    m_state->m_compressionSetup = setup;
+// ---------------------------------------------------------------------------------------------------------------------
+float OpusStream::getEncodeLoad() const
+{
+    return m_state->m_encodeLoad;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -4,7 +4,9 @@
 //  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
 //  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
 //
-//  
+//  opus encoding service; one audio tap feeds any number of encoder 'lanes', each with its own bitrate and frame
+//  size, and each lane fans its packets out to any number of sinks. all encoding happens on the processor's own
+//  worker thread, with encoder complexity stepped up or down based on how long the previous blocks took to encode
 //
 
 #pragma once
@@ -18,9 +20,11 @@ namespace ssp {
 // ---------------------------------------------------------------------------------------------------------------------
 struct OpusPacketData
 {
-    OpusPacketData( const uint32_t packetCount );
+    OpusPacketData( const uint32_t packetCount, const uint32_t maxPacketBytes );
     ~OpusPacketData();
 
+    ouro_nodiscard std::unique_ptr< OpusPacketData > clone() const;
+
     const size_t            m_opusDataBufferSize;
     uint8_t*                m_opusData              = nullptr;
     std::vector<uint16_t>   m_opusPacketSizes;
@@ -35,7 +39,33 @@ using OpusPacketDataInstance = std::unique_ptr< OpusPacketData >;
 
 
 // ---------------------------------------------------------------------------------------------------------------------
-// 
+// fixed details of a lane's output, handed to each sink as it is attached
+struct OpusStreamInfo
+{
+    uint32_t    m_sampleRate    = 48000;
+    uint32_t    m_channels      = 2;
+    uint32_t    m_frameSize     = 0;        // samples per channel per packet
+    uint32_t    m_preSkip       = 0;        // encoder lookahead, in samples at 48 kHz
+    int32_t     m_bitrate       = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// destination for encoded packets; consumePackets() is called from the encoder worker thread once per buffered block
+// and should not block for long, any other sinks on the service are waiting behind it
+struct IOpusSink
+{
+    virtual ~IOpusSink() {}
+
+    ouro_nodiscard virtual const char* getSinkName() const = 0;
+
+    virtual void beginStream( const OpusStreamInfo& streamInfo ) = 0;
+    virtual void consumePackets( const OpusPacketData& packets ) = 0;
+};
+using OpusSinkPtr = std::shared_ptr< IOpusSink >;
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+//
 class OpusStream : public ISampleStreamProcessor
 {
 public:
@@ -55,15 +85,30 @@ public:
         b2880 = 2880,
     };
 
-    // should make this configurable later
+    // samples are buffered in blocks of cFrameSize * cBufferedFrames before being encoded, lane frame sizes must
+    // divide evenly into that
     static constexpr uint32_t   cFrameSize      = 2880;
     static constexpr uint32_t   cBufferedFrames = 25;
+    static constexpr uint32_t   cBlockSize      = cFrameSize * cBufferedFrames;
     static constexpr float      cFrameTimeSec   = ( 1.0f / 48000.0f ) * (float)cFrameSize;
 
+    // largest packet we let the encoder produce; keeps a packet inside a single UDP datagram
+    static constexpr uint32_t   cMaxPacketBytes = 1400;
+
+    // adaptive complexity bounds and the share of real time that all lanes together are allowed to spend encoding
+    static constexpr int32_t    cComplexityMin          = 4;
+    static constexpr int32_t    cComplexityMax          = 10;
+    static constexpr float      cEncodeBudgetHigh       = 0.25f;
+    static constexpr float      cEncodeBudgetLow        = 0.10f;
+
     ~OpusStream();
 
     using NewDataCallback = std::function< void( OpusPacketDataInstance&& ) >;
 
+    // create a service with no lanes
+    static PtrOrStatus Create( const uint32_t sampleRate );
+
+    // create a service with a single default lane (64kbps, cFrameSize) that hands each block of packets to the callback
     static PtrOrStatus Create(
         const NewDataCallback&  newDataCallback,
         const uint32_t          sampleRate );
@@ -77,9 +122,34 @@ public:
         int32_t     m_bitrate                   = 0;
         int32_t     m_expectedPacketLossPercent = 0;
     };
+
+    struct LaneSetup
+    {
+        CompressionSetup    m_compression   = { 64000, 0 };
+        FrameSize           m_frameSize     = FrameSize::b2880;
+    };
+
+    struct _lane_id {};
+    using LaneID = base::id::Simple<_lane_id, uint32_t, 1, 0>;
+
+    // add a new encoder lane; its sinks receive packets from the next complete block onwards
+    absl::StatusOr< LaneID > addLane( const LaneSetup& setup );
+    absl::Status removeLane( const LaneID laneID );
+
+    absl::Status attachSink( const LaneID laneID, const OpusSinkPtr& sink );
+    absl::Status detachSink( const LaneID laneID, const OpusSinkPtr& sink );
+
+    // compression settings for a lane; the overloads without a lane ID address the first lane added
     CompressionSetup getCurrentCompressionSetup() const;
     void setCompressionSetup( const CompressionSetup& setup );
 
+    absl::StatusOr< CompressionSetup > getCurrentCompressionSetup( const LaneID laneID ) const;
+    absl::Status setCompressionSetup( const LaneID laneID, const CompressionSetup& setup );
+
+    // current adaptive complexity and the share of real-time the last block took to encode, across all lanes
+    int32_t getCurrentComplexity() const;
+    float getEncodeLoad() const;
+
 
 private:
 
@@ -91,4 +161,4 @@ protected:
     OpusStream( const StreamProcessorInstanceID instanceID, std::unique_ptr< StreamInstance >& state );
 };
 
-} // namespace ssp
\ No newline at end of file
+} // namespace ssp
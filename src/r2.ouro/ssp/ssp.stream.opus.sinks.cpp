@@ -0,0 +1,352 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+//
+
+#include "pch.h"
+
+#include "ssp/ssp.stream.opus.sinks.h"
+
+#include "base/construction.h"
+
+#include <ogg/ogg.h>
+#include <asio.hpp>
+
+
+namespace ssp {
+
+// opus granule positions and RTP timestamps always run at 48 kHz, whatever the input rate
+static constexpr uint32_t cOpusClockRate = 48000;
+
+ouro_nodiscard static uint32_t frameSizeAt48k( const OpusStreamInfo& streamInfo )
+{
+    return static_cast<uint32_t>( ( (uint64_t)streamInfo.m_frameSize * cOpusClockRate ) / streamInfo.m_sampleRate );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct OggOpusFileSink::State
+{
+    ~State()
+    {
+        finish();
+        ogg_stream_clear( &m_oggStream );
+    }
+
+    void writePage( const ogg_page& page )
+    {
+        m_output.write( reinterpret_cast<const char*>( page.header ), page.header_len );
+        m_output.write( reinterpret_cast<const char*>( page.body ), page.body_len );
+        m_bytesWritten += page.header_len + page.body_len;
+    }
+
+    void flushPages( const bool forceFlush )
+    {
+        ogg_page page;
+        while ( forceFlush ? ogg_stream_flush( &m_oggStream, &page ) : ogg_stream_pageout( &m_oggStream, &page ) )
+            writePage( page );
+    }
+
+    void submitPacket( const uint8_t* data, const uint32_t size, const int64_t granulePosition, const bool endOfStream )
+    {
+        ogg_packet packet;
+        packet.packet       = const_cast<uint8_t*>( data );
+        packet.bytes        = size;
+        packet.b_o_s        = ( m_packetNumber == 0 ) ? 1 : 0;
+        packet.e_o_s        = endOfStream ? 1 : 0;
+        packet.granulepos   = granulePosition;
+        packet.packetno     = m_packetNumber++;
+
+        ogg_stream_packetin( &m_oggStream, &packet );
+    }
+
+    // the header pages; OpusHead and OpusTags must each sit alone on their own page
+    void writeHeaders( const OpusStreamInfo& streamInfo )
+    {
+        std::vector< uint8_t > opusHead;
+        opusHead.reserve( 19 );
+        auto append = [&opusHead]( const void* data, std::size_t bytes )
+        {
+            const uint8_t* bytePtr = static_cast<const uint8_t*>( data );
+            opusHead.insert( opusHead.end(), bytePtr, bytePtr + bytes );
+        };
+
+        const uint8_t  version         = 1;
+        const uint8_t  channels        = static_cast<uint8_t>( streamInfo.m_channels );
+        const uint16_t preSkip         = static_cast<uint16_t>( streamInfo.m_preSkip );
+        const uint32_t inputSampleRate = streamInfo.m_sampleRate;
+        const int16_t  outputGain      = 0;
+        const uint8_t  mappingFamily   = 0;
+
+        append( "OpusHead", 8 );
+        append( &version, 1 );
+        append( &channels, 1 );
+        append( &preSkip, 2 );
+        append( &inputSampleRate, 4 );
+        append( &outputGain, 2 );
+        append( &mappingFamily, 1 );
+
+        submitPacket( opusHead.data(), static_cast<uint32_t>( opusHead.size() ), 0, false );
+        flushPages( true );
+
+        const std::string vendor = fmt::format( FMTX( "OUROVEON {}" ), OURO_FRAMEWORK_VERSION );
+        const uint32_t vendorLength = static_cast<uint32_t>( vendor.size() );
+        const uint32_t commentCount = 0;
+
+        std::vector< uint8_t > opusTags;
+        opusTags.insert( opusTags.end(), { 'O', 'p', 'u', 's', 'T', 'a', 'g', 's' } );
+        opusTags.insert( opusTags.end(), reinterpret_cast<const uint8_t*>( &vendorLength ), reinterpret_cast<const uint8_t*>( &vendorLength ) + 4 );
+        opusTags.insert( opusTags.end(), vendor.begin(), vendor.end() );
+        opusTags.insert( opusTags.end(), reinterpret_cast<const uint8_t*>( &commentCount ), reinterpret_cast<const uint8_t*>( &commentCount ) + 4 );
+
+        submitPacket( opusTags.data(), static_cast<uint32_t>( opusTags.size() ), 0, false );
+        flushPages( true );
+    }
+
+    // the final audio packet is always held back by one so that it can be marked end-of-stream when we close
+    void submitHeldPacket( const bool endOfStream )
+    {
+        if ( m_heldPacket.empty() )
+            return;
+
+        m_granulePosition += m_granuleStep;
+        submitPacket( m_heldPacket.data(), static_cast<uint32_t>( m_heldPacket.size() ), m_granulePosition, endOfStream );
+        m_heldPacket.clear();
+    }
+
+    void finish()
+    {
+        if ( !m_output.is_open() )
+            return;
+
+        if ( m_headersWritten )
+        {
+            submitHeldPacket( true );
+            flushPages( true );
+        }
+
+        m_output.close();
+    }
+
+    std::ofstream           m_output;
+    ogg_stream_state        m_oggStream;
+
+    bool                    m_headersWritten    = false;
+    int64_t                 m_packetNumber      = 0;
+    int64_t                 m_granulePosition   = 0;
+    int64_t                 m_granuleStep       = 0;
+
+    std::vector< uint8_t >  m_heldPacket;
+    uint64_t                m_bytesWritten      = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< OggOpusFileSink::SharedPtr > OggOpusFileSink::Create( const fs::path& outputFile )
+{
+    auto newState = std::make_unique< State >();
+
+    newState->m_output.open( outputFile, std::ios::binary | std::ios::trunc );
+    if ( !newState->m_output.is_open() )
+        return absl::UnavailableError( fmt::format( FMTX( "unable to open [{}] for writing" ), outputFile.string() ) );
+
+    // any non-zero serial will do, it only needs to differ between logical streams in the one file
+    const int32_t streamSerial = static_cast<int32_t>( komihash( outputFile.string().data(), outputFile.string().size(), 0 ) | 1 );
+    if ( ogg_stream_init( &newState->m_oggStream, streamSerial ) != 0 )
+        return absl::InternalError( "ogg_stream_init failed" );
+
+    return base::protected_make_shared< OggOpusFileSink >( newState );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+OggOpusFileSink::OggOpusFileSink( std::unique_ptr< State >& state )
+    : m_state( std::move( state ) )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+OggOpusFileSink::~OggOpusFileSink()
+{
+    m_state.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void OggOpusFileSink::beginStream( const OpusStreamInfo& streamInfo )
+{
+    // a file holds a single stream; being attached to a second lane would interleave garbage
+    ABSL_ASSERT( !m_state->m_headersWritten );
+    if ( m_state->m_headersWritten )
+        return;
+
+    m_state->m_granuleStep      = frameSizeAt48k( streamInfo );
+    m_state->m_granulePosition  = streamInfo.m_preSkip;
+
+    m_state->writeHeaders( streamInfo );
+    m_state->m_headersWritten = true;
+
+    m_bytesWritten = m_state->m_bytesWritten;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void OggOpusFileSink::consumePackets( const OpusPacketData& packets )
+{
+    if ( !m_state->m_headersWritten )
+        return;
+
+    const uint8_t* packetData = packets.m_opusData;
+    for ( const auto packetSize : packets.m_opusPacketSizes )
+    {
+        m_state->submitHeldPacket( false );
+        m_state->m_heldPacket.assign( packetData, packetData + packetSize );
+
+        packetData += packetSize;
+    }
+
+    m_state->flushPages( false );
+    m_bytesWritten = m_state->m_bytesWritten;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct RtpOpusSink::State
+{
+    State()
+        : m_socket( m_ioContext )
+    {}
+
+    asio::io_context        m_ioContext;
+    asio::ip::udp::socket   m_socket;
+    asio::ip::udp::endpoint m_destination;
+
+    uint16_t                m_sequence      = 0;
+    uint32_t                m_timestamp     = 0;
+    uint32_t                m_ssrc          = 0;
+    uint32_t                m_timestampStep = 0;
+    bool                    m_markNext      = false;
+    OpusStreamInfo          m_streamInfo;
+
+    std::vector< uint8_t >  m_datagram;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< RtpOpusSink::SharedPtr > RtpOpusSink::Create( const std::string& address, const uint16_t port )
+{
+    auto newState = std::make_unique< State >();
+
+    asio::error_code ec;
+    const auto destinationAddress = asio::ip::make_address( address, ec );
+    if ( ec )
+        return absl::InvalidArgumentError( fmt::format( FMTX( "invalid RTP destination address [{}] : {}" ), address, ec.message() ) );
+
+    newState->m_destination = asio::ip::udp::endpoint( destinationAddress, port );
+
+    newState->m_socket.open( newState->m_destination.protocol(), ec );
+    if ( ec )
+        return absl::UnavailableError( fmt::format( FMTX( "unable to open RTP socket : {}" ), ec.message() ) );
+
+    // random starting points, as RFC 3550 asks for
+    std::random_device randomDevice;
+    newState->m_ssrc        = randomDevice();
+    newState->m_sequence    = static_cast<uint16_t>( randomDevice() );
+    newState->m_timestamp   = randomDevice();
+
+    newState->m_datagram.reserve( 12 + OpusStream::cMaxPacketBytes );
+
+    blog::core( FMTX( "RTP opus sink sending to {}:{}" ), address, port );
+    return base::protected_make_shared< RtpOpusSink >( newState );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+RtpOpusSink::RtpOpusSink( std::unique_ptr< State >& state )
+    : m_state( std::move( state ) )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+RtpOpusSink::~RtpOpusSink()
+{
+    asio::error_code ec;
+    m_state->m_socket.close( ec );
+    m_state.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RtpOpusSink::beginStream( const OpusStreamInfo& streamInfo )
+{
+    m_state->m_streamInfo       = streamInfo;
+    m_state->m_timestampStep    = frameSizeAt48k( streamInfo );
+    m_state->m_markNext         = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RtpOpusSink::consumePackets( const OpusPacketData& packets )
+{
+    auto& datagram = m_state->m_datagram;
+
+    const uint8_t* packetData = packets.m_opusData;
+    for ( const auto packetSize : packets.m_opusPacketSizes )
+    {
+        const uint16_t sequence  = m_state->m_sequence++;
+        const uint32_t timestamp = m_state->m_timestamp;
+        const uint32_t ssrc      = m_state->m_ssrc;
+        const bool     marker    = m_state->m_markNext;
+        m_state->m_timestamp += m_state->m_timestampStep;
+        m_state->m_markNext   = false;
+
+        // fixed 12 byte RTP header, network byte order
+        datagram.resize( 12 );
+        datagram[0]  = 0x80;                                    // version 2, no padding / extension / CSRCs
+        datagram[1]  = cPayloadType | ( marker ? 0x80 : 0x00 ); // marker on the first packet of a talkspurt (RFC 7587 4.2)
+        datagram[2]  = static_cast<uint8_t>( sequence >> 8 );
+        datagram[3]  = static_cast<uint8_t>( sequence );
+        datagram[4]  = static_cast<uint8_t>( timestamp >> 24 );
+        datagram[5]  = static_cast<uint8_t>( timestamp >> 16 );
+        datagram[6]  = static_cast<uint8_t>( timestamp >> 8 );
+        datagram[7]  = static_cast<uint8_t>( timestamp );
+        datagram[8]  = static_cast<uint8_t>( ssrc >> 24 );
+        datagram[9]  = static_cast<uint8_t>( ssrc >> 16 );
+        datagram[10] = static_cast<uint8_t>( ssrc >> 8 );
+        datagram[11] = static_cast<uint8_t>( ssrc );
+        datagram.insert( datagram.end(), packetData, packetData + packetSize );
+
+        asio::error_code ec;
+        m_state->m_socket.send_to( asio::buffer( datagram ), m_state->m_destination, 0, ec );
+        if ( ec )
+        {
+            // only log the first failure, a missing listener on loopback can otherwise fill the log
+            if ( m_sendErrors++ == 0 )
+                blog::error::core( FMTX( "RTP opus sink send failed : {}" ), ec.message() );
+        }
+        else
+        {
+            m_packetsSent++;
+        }
+
+        packetData += packetSize;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::string RtpOpusSink::getSessionDescription() const
+{
+    const auto& destination = m_state->m_destination;
+    const bool isIPv6 = destination.address().is_v6();
+
+    return fmt::format( FMTX(
+        "v=0\n"
+        "o=- 0 0 IN {0} {1}\n"
+        "s=OUROVEON\n"
+        "c=IN {0} {1}\n"
+        "t=0 0\n"
+        "m=audio {2} RTP/AVP {3}\n"
+        "a=rtpmap:{3} opus/48000/2\n"
+        "a=fmtp:{3} stereo=1; sprop-stereo=1\n" ),
+        isIPv6 ? "IP6" : "IP4",
+        destination.address().to_string(),
+        destination.port(),
+        cPayloadType );
+}
+
+} // namespace ssp
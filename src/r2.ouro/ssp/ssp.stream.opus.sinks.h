@@ -0,0 +1,88 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  stock sinks for the opus encoding service - an Ogg Opus file writer and an RTP-over-UDP sender
+//
+
+#pragma once
+#include "base/construction.h"
+
+#include "ssp/ssp.stream.opus.h"
+
+namespace ssp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// writes a standard .opus file (RFC 7845) playable by anything that understands Ogg Opus
+class OggOpusFileSink : public IOpusSink
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( OggOpusFileSink );
+
+    using SharedPtr = std::shared_ptr< OggOpusFileSink >;
+
+    static absl::StatusOr< SharedPtr > Create( const fs::path& outputFile );
+    ~OggOpusFileSink();
+
+    const char* getSinkName() const override { return "ogg-opus-file"; }
+
+    void beginStream( const OpusStreamInfo& streamInfo ) override;
+    void consumePackets( const OpusPacketData& packets ) override;
+
+    ouro_nodiscard uint64_t getBytesWritten() const { return m_bytesWritten; }
+
+private:
+
+    struct State;
+    std::unique_ptr< State >    m_state;
+
+    std::atomic_uint64_t        m_bytesWritten = 0;
+
+protected:
+
+    OggOpusFileSink( std::unique_ptr< State >& state );
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// sends each packet as an RTP datagram (RFC 7587, dynamic payload type) to a UDP endpoint, by default on loopback.
+// packets leave in a burst once per encoded block, so a receiver needs a jitter buffer at least that long; use
+// getSessionDescription() to produce an .sdp that ffplay / vlc can open to listen in. the first packet after
+// beginStream() carries the marker bit, so a receiver resyncs its playout point on every new stream
+class RtpOpusSink : public IOpusSink
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( RtpOpusSink );
+
+    using SharedPtr = std::shared_ptr< RtpOpusSink >;
+
+    static constexpr uint8_t cPayloadType = 111;
+
+    static absl::StatusOr< SharedPtr > Create( const std::string& address = "127.0.0.1", const uint16_t port = 5004 );
+    ~RtpOpusSink();
+
+    const char* getSinkName() const override { return "rtp-udp"; }
+
+    void beginStream( const OpusStreamInfo& streamInfo ) override;
+    void consumePackets( const OpusPacketData& packets ) override;
+
+    ouro_nodiscard std::string getSessionDescription() const;
+
+    ouro_nodiscard uint64_t getPacketsSent() const { return m_packetsSent; }
+    ouro_nodiscard uint64_t getSendErrors() const { return m_sendErrors; }
+
+private:
+
+    struct State;
+    std::unique_ptr< State >    m_state;
+
+    std::atomic_uint64_t        m_packetsSent = 0;
+    std::atomic_uint64_t        m_sendErrors  = 0;
+
+protected:
+
+    RtpOpusSink( std::unique_ptr< State >& state );
+};
+
+} // namespace ssp
@@ -0,0 +1,397 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  large-block allocator that maps each allocation as its own slab straight from the OS
+//
+
+#include "pch.h"
+#include "sys/slab.h"
+
+#include "base/text.h"
+
+#if OURO_PLATFORM_WIN
+
+#include "win32/errors.h"
+
+#else // LINUX / MAC
+
+#include <sys/mman.h>
+
+#endif
+
+namespace sys {
+
+// ---------------------------------------------------------------------------------------------------------------------
+SlabAllocator::SlabAllocator( const char* name, const mem::Tag memoryTag, const std::size_t retainLimitBytes )
+    : m_name( name )
+    , m_memoryTag( memoryTag )
+    , m_retainLimitBytes( retainLimitBytes )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+SlabAllocator::~SlabAllocator()
+{
+    trim( 0 );
+
+    if ( m_statistics.m_slabsLive > 0 )
+    {
+        blog::error::core( FMTX( "[slab:{}] {} slabs still live at shutdown ({})" ),
+            m_name,
+            m_statistics.m_slabsLive,
+            base::humaniseByteSize( "", m_statistics.m_bytesRequested ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t SlabAllocator::slabSizeFor( const std::size_t bytes )
+{
+    // small slabs go up in powers of two, anything larger is rounded to whole huge pages so it can be backed by them
+    if ( bytes <= cHugePageBytes )
+        return std::max( cMinimumSlabBytes, std::bit_ceil( bytes ) );
+
+    return ( bytes + cHugePageBytes - 1 ) & ~( cHugePageBytes - 1 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void* SlabAllocator::allocate( const std::size_t bytes )
+{
+    if ( bytes == 0 )
+        return nullptr;
+
+    const std::size_t slabBytes = slabSizeFor( bytes );
+
+    Slab        slab{ nullptr, 0 };
+    std::size_t takenSlabBytes = slabBytes;
+    {
+        std::scoped_lock<std::mutex> lock( m_lock );
+
+        if ( takeRetained( slabBytes, takenSlabBytes, slab ) )
+        {
+            m_statistics.m_reuseHits++;
+        }
+        else
+        {
+            slab = osMap( slabBytes );
+            if ( slab.m_base == nullptr )
+                return nullptr;
+
+            m_statistics.m_mapCalls++;
+            m_statistics.m_bytesReserved += slabBytes;
+            m_statistics.m_bytesCommitted += slabBytes;
+        }
+
+        m_statistics.m_slabsLive++;
+        m_statistics.m_bytesRequested += bytes;
+
+        if ( slab.m_flags & HugeExplicit )
+            m_statistics.m_slabsHugeExplicit++;
+        if ( slab.m_flags & HugeTransparent )
+            m_statistics.m_slabsHugeTransparent++;
+
+        m_live.emplace( slab.m_base, LiveSlab{ slab.m_flags, takenSlabBytes, bytes } );
+    }
+
+    mem::trackAlloc( m_memoryTag, takenSlabBytes );
+
+    return slab.m_base;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SlabAllocator::free( void* ptr )
+{
+    if ( ptr == nullptr )
+        return;
+
+    std::scoped_lock<std::mutex> lock( m_lock );
+
+    const auto liveIt = m_live.find( ptr );
+    ABSL_ASSERT( liveIt != m_live.end() );
+    if ( liveIt == m_live.end() )
+        return;
+
+    Slab slab{ ptr, liveIt->second.m_flags };
+    const std::size_t slabBytes    = liveIt->second.m_slabBytes;
+    const std::size_t requestBytes = liveIt->second.m_requestBytes;
+
+    m_live.erase( liveIt );
+
+    mem::trackFree( m_memoryTag, slabBytes );
+
+    m_statistics.m_slabsLive--;
+    m_statistics.m_bytesRequested -= requestBytes;
+
+    if ( slab.m_flags & HugeExplicit )
+        m_statistics.m_slabsHugeExplicit--;
+    if ( slab.m_flags & HugeTransparent )
+        m_statistics.m_slabsHugeTransparent--;
+
+    // hang on to the address space if there's room, handing the memory behind it back to the OS
+    if ( m_retainedBytes + slabBytes <= m_retainLimitBytes )
+    {
+        osDecommit( slab, slabBytes );
+        if ( slab.m_flags & Decommitted )
+            m_statistics.m_bytesCommitted -= slabBytes;
+
+        m_retained[slabBytes].emplace_back( slab );
+        m_retainedBytes += slabBytes;
+        m_statistics.m_slabsRetained++;
+    }
+    else
+    {
+        osUnmap( slab, slabBytes );
+
+        m_statistics.m_bytesReserved -= slabBytes;
+        m_statistics.m_bytesCommitted -= slabBytes;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool SlabAllocator::takeRetained( const std::size_t slabBytes, std::size_t& takenSlabBytes, Slab& slab )
+{
+    const std::size_t slabBytesLimit = slabBytes + ( slabBytes / cReuseSlackDivisor );
+
+    for ( auto retainedIt = m_retained.lower_bound( slabBytes );
+          retainedIt != m_retained.end() && retainedIt->first <= slabBytesLimit;
+          ++retainedIt )
+    {
+        if ( retainedIt->second.empty() )
+            continue;
+
+        Slab candidate = retainedIt->second.back();
+        const bool wasDecommitted = ( candidate.m_flags & Decommitted ) != 0;
+
+        // if the OS won't give the memory back to us, drop the slab entirely and go map a fresh one
+        if ( !osRecommit( candidate, retainedIt->first ) )
+        {
+            retainedIt->second.pop_back();
+            osUnmap( candidate, retainedIt->first );
+
+            m_retainedBytes -= retainedIt->first;
+            m_statistics.m_slabsRetained--;
+            m_statistics.m_bytesReserved -= retainedIt->first;
+            return false;
+        }
+
+        if ( wasDecommitted )
+            m_statistics.m_bytesCommitted += retainedIt->first;
+
+        retainedIt->second.pop_back();
+
+        m_retainedBytes -= retainedIt->first;
+        m_statistics.m_slabsRetained--;
+
+        slab           = candidate;
+        takenSlabBytes = retainedIt->first;
+        return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SlabAllocator::trim( const std::size_t retainBytes )
+{
+    std::scoped_lock<std::mutex> lock( m_lock );
+
+    while ( m_retainedBytes > retainBytes && !m_retained.empty() )
+    {
+        auto largestIt = std::prev( m_retained.end() );
+        const std::size_t slabBytes = largestIt->first;
+
+        if ( largestIt->second.empty() )
+        {
+            m_retained.erase( largestIt );
+            continue;
+        }
+
+        const Slab slab = largestIt->second.back();
+        largestIt->second.pop_back();
+
+        osUnmap( slab, slabBytes );
+
+        m_retainedBytes -= slabBytes;
+        m_statistics.m_slabsRetained--;
+        m_statistics.m_bytesReserved -= slabBytes;
+        if ( ( slab.m_flags & Decommitted ) == 0 )
+            m_statistics.m_bytesCommitted -= slabBytes;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+SlabAllocator::Statistics SlabAllocator::getStatistics() const
+{
+    std::scoped_lock<std::mutex> lock( m_lock );
+    return m_statistics;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SlabAllocator::logStatistics() const
+{
+    const Statistics stats = getStatistics();
+
+    blog::core( FMTX( "[slab:{}] {} live ({} explicit huge, {} transparent huge), {} retained | {} | {} | {}" ),
+        m_name,
+        stats.m_slabsLive,
+        stats.m_slabsHugeExplicit,
+        stats.m_slabsHugeTransparent,
+        stats.m_slabsRetained,
+        base::humaniseByteSize( "requested ", stats.m_bytesRequested ),
+        base::humaniseByteSize( "committed ", stats.m_bytesCommitted ),
+        base::humaniseByteSize( "reserved ", stats.m_bytesReserved ) );
+
+    blog::core( FMTX( "[slab:{}] {} mapped from OS, {} reused" ),
+        m_name,
+        stats.m_mapCalls,
+        stats.m_reuseHits );
+}
+
+
+#if OURO_PLATFORM_WIN
+
+// ---------------------------------------------------------------------------------------------------------------------
+SlabAllocator::Slab SlabAllocator::osMap( const std::size_t slabBytes )
+{
+    // large pages need SeLockMemoryPrivilege, which most accounts don't have; the first refusal stops us asking
+    const std::size_t largePageBytes = ::GetLargePageMinimum();
+    if ( m_hugeExplicitAvailable &&
+         largePageBytes > 0 &&
+         slabBytes >= cHugePageBytes &&
+         ( slabBytes % largePageBytes ) == 0 )
+    {
+        void* largeBase = ::VirtualAlloc( nullptr, slabBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+        if ( largeBase != nullptr )
+            return Slab{ largeBase, HugeExplicit };
+
+        m_hugeExplicitAvailable = false;
+        blog::core( FMTX( "[slab:{}] large pages unavailable ({}), using standard pages" ), m_name, win32::FormatLastErrorCode() );
+    }
+
+    void* base = ::VirtualAlloc( nullptr, slabBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+    if ( base == nullptr )
+    {
+        blog::error::core( FMTX( "[slab:{}] VirtualAlloc of {} bytes failed ({})" ), m_name, slabBytes, win32::FormatLastErrorCode() );
+    }
+    return Slab{ base, 0 };
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool SlabAllocator::osRecommit( Slab& slab, const std::size_t slabBytes )
+{
+    if ( ( slab.m_flags & Decommitted ) == 0 )
+        return true;
+
+    if ( ::VirtualAlloc( slab.m_base, slabBytes, MEM_COMMIT, PAGE_READWRITE ) == nullptr )
+        return false;
+
+    slab.m_flags &= ~Decommitted;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SlabAllocator::osDecommit( Slab& slab, const std::size_t slabBytes )
+{
+    // large pages are locked in memory, they stay as they are
+    if ( slab.m_flags & HugeExplicit )
+        return;
+
+    if ( ::VirtualFree( slab.m_base, slabBytes, MEM_DECOMMIT ) )
+        slab.m_flags |= Decommitted;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SlabAllocator::osUnmap( const Slab& slab, const std::size_t slabBytes )
+{
+    ::VirtualFree( slab.m_base, 0, MEM_RELEASE );
+}
+
+#else // LINUX / MAC
+
+// ---------------------------------------------------------------------------------------------------------------------
+SlabAllocator::Slab SlabAllocator::osMap( const std::size_t slabBytes )
+{
+    static constexpr int cProtection = PROT_READ | PROT_WRITE;
+    static constexpr int cMapping    = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    const bool hugeCandidate = ( slabBytes >= cHugePageBytes );
+
+#if OURO_PLATFORM_LINUX
+    // explicit huge pages only exist if the admin has reserved some (vm.nr_hugepages); if not, the first attempt
+    // fails quickly and we stop trying
+    if ( hugeCandidate && m_hugeExplicitAvailable )
+    {
+        void* hugeBase = ::mmap( nullptr, slabBytes, cProtection, cMapping | MAP_HUGETLB, -1, 0 );
+        if ( hugeBase != MAP_FAILED )
+            return Slab{ hugeBase, HugeExplicit };
+
+        m_hugeExplicitAvailable = false;
+        blog::core( FMTX( "[slab:{}] no explicit huge pages reserved, falling back to transparent huge pages" ), m_name );
+    }
+
+    if ( hugeCandidate )
+    {
+        // THP can only back 2MB-aligned ranges, so over-map by a huge page and trim the mapping down to an aligned slab
+        const std::size_t paddedBytes = slabBytes + cHugePageBytes;
+
+        void* paddedBase = ::mmap( nullptr, paddedBytes, cProtection, cMapping, -1, 0 );
+        if ( paddedBase == MAP_FAILED )
+        {
+            blog::error::core( FMTX( "[slab:{}] mmap of {} bytes failed ({})" ), m_name, paddedBytes, errno );
+            return Slab{ nullptr, 0 };
+        }
+
+        const uintptr_t paddedStart  = reinterpret_cast<uintptr_t>( paddedBase );
+        const uintptr_t alignedStart = ( paddedStart + cHugePageBytes - 1 ) & ~( static_cast<uintptr_t>( cHugePageBytes ) - 1 );
+        const std::size_t headTrim   = alignedStart - paddedStart;
+        const std::size_t tailTrim   = paddedBytes - headTrim - slabBytes;
+
+        if ( headTrim > 0 )
+            ::munmap( paddedBase, headTrim );
+        if ( tailTrim > 0 )
+            ::munmap( reinterpret_cast<void*>( alignedStart + slabBytes ), tailTrim );
+
+        void* alignedBase = reinterpret_cast<void*>( alignedStart );
+
+        const bool transparent = ( ::madvise( alignedBase, slabBytes, MADV_HUGEPAGE ) == 0 );
+        return Slab{ alignedBase, transparent ? HugeTransparent : 0U };
+    }
+#endif // OURO_PLATFORM_LINUX
+
+    void* base = ::mmap( nullptr, slabBytes, cProtection, cMapping, -1, 0 );
+    if ( base == MAP_FAILED )
+    {
+        blog::error::core( FMTX( "[slab:{}] mmap of {} bytes failed ({})" ), m_name, slabBytes, errno );
+        return Slab{ nullptr, 0 };
+    }
+    return Slab{ base, 0 };
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool SlabAllocator::osRecommit( Slab& slab, const std::size_t slabBytes )
+{
+    // decommitted anonymous pages simply fault back in as zeroes on next touch
+    slab.m_flags &= ~Decommitted;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SlabAllocator::osDecommit( Slab& slab, const std::size_t slabBytes )
+{
+    if ( slab.m_flags & HugeExplicit )
+        return;
+
+    if ( ::madvise( slab.m_base, slabBytes, MADV_DONTNEED ) == 0 )
+        slab.m_flags |= Decommitted;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SlabAllocator::osUnmap( const Slab& slab, const std::size_t slabBytes )
+{
+    ::munmap( slab.m_base, slabBytes );
+}
+
+#endif
+
+} // namespace sys
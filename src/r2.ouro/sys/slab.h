@@ -0,0 +1,123 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  large-block allocator that maps each allocation as its own slab straight from the OS, bypassing the general heap.
+//  slabs of 2MB or more are offered huge pages - explicit where the system has them reserved, transparent otherwise -
+//  and freed slabs are decommitted and kept by size for reuse, so the address space stays warm while the memory
+//  itself goes back to the OS
+//
+
+#pragma once
+
+#include "base/construction.h"
+#include "base/memory.h"
+
+namespace sys {
+
+// ---------------------------------------------------------------------------------------------------------------------
+class SlabAllocator
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( SlabAllocator );
+
+    static constexpr std::size_t cMinimumSlabBytes  = 64 * 1024;
+    static constexpr std::size_t cHugePageBytes     = 2 * 1024 * 1024;
+
+    // a retained slab may be handed out for a request up to this much smaller than it, as a ratio of 1/N
+    static constexpr std::size_t cReuseSlackDivisor = 4;
+
+    struct Statistics
+    {
+        std::size_t     m_bytesRequested        = 0;    // sum of live allocation sizes, as asked for
+        std::size_t     m_bytesCommitted        = 0;    // committed slab memory, live or waiting for reuse
+        std::size_t     m_bytesReserved         = 0;    // all address space held, including decommitted slabs
+
+        std::size_t     m_slabsLive             = 0;
+        std::size_t     m_slabsRetained         = 0;
+        std::size_t     m_slabsHugeExplicit     = 0;    // live slabs on explicitly reserved huge pages
+        std::size_t     m_slabsHugeTransparent  = 0;    // live slabs advised for transparent huge pages
+
+        uint64_t        m_mapCalls              = 0;    // fresh slabs requested from the OS
+        uint64_t        m_reuseHits             = 0;    // allocations served from retained slabs
+    };
+
+    // retainLimitBytes caps how much decommitted address space is kept for reuse; slabs released beyond that are
+    // unmapped outright. live slabs are counted against memoryTag
+    SlabAllocator( const char* name, const mem::Tag memoryTag, const std::size_t retainLimitBytes );
+    ~SlabAllocator();
+
+    // returns page-aligned memory, or nullptr if the OS refused
+    ouro_nodiscard void* allocate( const std::size_t bytes );
+
+    template< typename _T >
+    ouro_nodiscard inline _T* allocateArray( const std::size_t numElements )
+    {
+        return reinterpret_cast<_T*>( allocate( sizeof( _T ) * numElements ) );
+    }
+
+    // accepts nullptr
+    void free( void* ptr );
+
+    // unmap retained slabs, largest first, until no more than retainBytes of them remain
+    void trim( const std::size_t retainBytes = 0 );
+
+    ouro_nodiscard Statistics getStatistics() const;
+
+    void logStatistics() const;
+
+private:
+
+    enum SlabFlags : uint32_t
+    {
+        HugeExplicit    = 1 << 0,   // MAP_HUGETLB / MEM_LARGE_PAGES; cannot be decommitted, stays committed when retained
+        HugeTransparent = 1 << 1,
+        Decommitted     = 1 << 2,
+    };
+
+    struct Slab
+    {
+        void*           m_base;
+        uint32_t        m_flags;
+    };
+
+    // bookkeeping for a handed-out slab, kept off to the side rather than in the slab itself so that a request of
+    // exactly N huge pages fits in N of them and the allocation starts on the page boundary
+    struct LiveSlab
+    {
+        uint32_t        m_flags;
+        std::size_t     m_slabBytes;
+        std::size_t     m_requestBytes;
+    };
+
+    ouro_nodiscard static std::size_t slabSizeFor( const std::size_t bytes );
+
+    // platform layer
+    ouro_nodiscard Slab osMap( const std::size_t slabBytes );
+    ouro_nodiscard static bool osRecommit( Slab& slab, const std::size_t slabBytes );
+    static void osDecommit( Slab& slab, const std::size_t slabBytes );
+    static void osUnmap( const Slab& slab, const std::size_t slabBytes );
+
+    // pull a retained slab of at least slabBytes (and not wastefully larger); called with m_lock held
+    ouro_nodiscard bool takeRetained( const std::size_t slabBytes, std::size_t& takenSlabBytes, Slab& slab );
+
+
+    using RetainedSlabs = absl::btree_map< std::size_t, std::vector< Slab > >;
+    using LiveSlabs     = absl::flat_hash_map< void*, LiveSlab >;
+
+    std::string                 m_name;
+    mem::Tag                    m_memoryTag;
+    std::size_t                 m_retainLimitBytes;
+
+    mutable std::mutex          m_lock;
+    LiveSlabs                   m_live;                 // keyed by slab base, which is also the allocation
+    RetainedSlabs               m_retained;             // keyed by slab size
+    std::size_t                 m_retainedBytes         = 0;
+    Statistics                  m_statistics;
+
+    bool                        m_hugeExplicitAvailable = true;     // cleared the first time the OS turns us down
+};
+
+} // namespace sys
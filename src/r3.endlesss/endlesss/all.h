@@ -20,6 +20,7 @@
 #include "endlesss/live.stem.h"
 #include "endlesss/toolkit.exchange.h"
 #include "endlesss/toolkit.jam.sentinel.h"
+#include "endlesss/toolkit.paging.h"
 #include "endlesss/toolkit.population.h"
 #include "endlesss/toolkit.riff.export.h"
 #include "endlesss/toolkit.riff.pipeline.h"
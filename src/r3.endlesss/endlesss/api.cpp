@@ -354,7 +354,7 @@ bool JamChanges::fetch( const NetConfiguration& ncfg, const endlesss::types::Jam
             cMimeApplicationJson );
         });
 
-    return deserializeJson< JamChanges >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "jam_changes" );
+    return deserializeJsonStreaming< JamChanges >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "jam_changes" );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -371,7 +371,7 @@ bool JamChanges::fetchSince( const NetConfiguration& ncfg, const endlesss::types
             cMimeApplicationJson );
         });
 
-    return deserializeJson< JamChanges >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "jam_changes_since" );
+    return deserializeJsonStreaming< JamChanges >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "jam_changes_since" );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -436,7 +436,16 @@ bool RiffDetails::fetch( const NetConfiguration& ncfg, const endlesss::types::Ja
             cMimeApplicationJson );
         });
 
-    return deserializeJson< RiffDetails >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "riff_details" );
+    return deserializeJsonStreaming< RiffDetails >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "riff_details" );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffDetails::applyBatchQuirkFixes( std::string& bodyText )
+{
+    // last minute shit found in Ash's solo jam - the stem playback value "on" would - for ONE RIFF - turn up as a 0 or 1 rather than a bool value like
+    // literally everything else aaaaaaaaaaaaaaaaa
+    bodyText = std::regex_replace( bodyText, std::regex( "\"on\":0," ), "\"on\":false," );
+    bodyText = std::regex_replace( bodyText, std::regex( "\"on\":1," ), "\"on\":true," );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -457,20 +466,13 @@ bool RiffDetails::fetchBatch( const NetConfiguration& ncfg, const endlesss::type
             cMimeApplicationJson );
         });
 
+    // the streaming decoder accepts 0 / 1 for booleans as it goes; the regex version of that fix is only needed if it
+    // has to fall back to the original decoding path
+    std::function< void( std::string& ) > quirkFixes;
     if ( ncfg.api().debugLastMinuteQuirkFixes )
-    {
-        // last minute shit found in Ash's solo jam - the stem playback value "on" would - for ONE RIFF - turn up as a 0 or 1 rather than a bool value like
-        // literally everything else aaaaaaaaaaaaaaaaa
-        return deserializeJson< RiffDetails >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "riff_details_batch", []( std::string& bodyText )
-            {
-                bodyText = std::regex_replace( bodyText, std::regex( "\"on\":0," ), "\"on\":false," );
-                bodyText = std::regex_replace( bodyText, std::regex( "\"on\":1," ), "\"on\":true," );
-            });
-    }
-    else
-    {
-        return deserializeJson< RiffDetails >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "riff_details_batch" );
-    }
+        quirkFixes = &RiffDetails::applyBatchQuirkFixes;
+
+    return deserializeJsonStreaming< RiffDetails >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "riff_details_batch", quirkFixes );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -491,7 +493,7 @@ bool StemTypeCheck::fetchBatch( const NetConfiguration& ncfg, const endlesss::ty
             cMimeApplicationJson );
         });
 
-    return deserializeJson< StemTypeCheck >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "stem_type_check_batch" );
+    return deserializeJsonStreaming< StemTypeCheck >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "stem_type_check_batch" );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -512,7 +514,7 @@ bool StemDetails::fetchBatch( const NetConfiguration& ncfg, const endlesss::type
             cMimeApplicationJson );
         });
 
-    return deserializeJson< StemDetails >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "stem_details_batch" );
+    return deserializeJsonStreaming< StemDetails >( ncfg, res, *this, fmt::format( "{}( {} )", __FUNCTION__, jamDatabaseID_Sanitised ), "stem_details_batch" );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -660,7 +662,9 @@ bool SharedRiffsByUser::commonRequest( const NetConfiguration& ncfg, const std::
     static uint32_t exportIndexDbg = 0;
 #endif // INSANE_LAST_MINUTE_FIXING_THE_SHARED_RIFF_JSON_GLITCHES
 
-    return deserializeJson< SharedRiffsByUser >( ncfg, res, *this, requestContext, "shared_riffs_by_user", [&requestContext]( std::string& bodyText )
+    // the streaming decoder handles all of the nulls described above inline; this processor only runs if it has to
+    // fall back to the original cereal path
+    return deserializeJsonStreaming< SharedRiffsByUser >( ncfg, res, *this, requestContext, "shared_riffs_by_user", [&requestContext]( std::string& bodyText )
         {
 #ifdef INSANE_LAST_MINUTE_FIXING_THE_SHARED_RIFF_JSON_GLITCHES
             exportIndexDbg++;
@@ -13,6 +13,7 @@
 
 #include "endlesss/config.h"
 #include "endlesss/core.types.h"
+#include "endlesss/api.json.h"
 
 namespace endlesss {
 namespace api {
@@ -209,17 +210,11 @@ enum class UserAgent
     WebWithAuth,            // as above but with the user authentication included
 };
 
+namespace detail {
+
 // ---------------------------------------------------------------------------------------------------------------------
-// general boilerplate that takes a httplib response and tries to deserialize it from JSON to
-// the given type, returning false and logging the error if parsing bails
-template< typename _Type >
-inline static bool deserializeJson(
-    const NetConfiguration& netConfig,
-    const httplib::Result& res,
-    _Type& instance,
-    const std::string& functionContext,
-    std::string_view traceContext,
-    const std::function< void( std::string& ) >& bodyTextProcessor = nullptr )
+// check a httplib response is something worth parsing, logging why not if it isn't
+inline bool checkResponse( const httplib::Result& res, const std::string& functionContext )
 {
     if ( res == nullptr )
     {
@@ -231,20 +226,13 @@ inline static bool deserializeJson(
         blog::error::api( "HTTP | request status {} | {} | <context> {}\n", res->status, res->body, functionContext.c_str() );
         return false;
     }
+    return true;
+}
 
-    //
-    // apply horribly inefficient kludge to work around one particular version of Endlesss that decided to start
-    // writing out "length" keys as strings rather than numbers :O *shakes fist*
-    //
-    std::string bodyText = std::regex_replace( res->body, netConfig.getDataFixRegex_lengthTypeMismatch(), "\"length\":$1" );
-
-    // allow custom body modifications pre-parse in case there are any other hilarious json tripmines to work around
-    if ( bodyTextProcessor )
-    {
-        bodyTextProcessor( bodyText );
-    }
-
-    // optional heavy debug verbose output option
+// ---------------------------------------------------------------------------------------------------------------------
+// optional heavy debug verbose output option
+inline void captureBodyText( const NetConfiguration& netConfig, std::string_view traceContext, const std::string& functionContext, const std::string& bodyText )
+{
     if ( netConfig.api().debugVerboseNetDataCapture )
     {
         const auto verboseFilename = netConfig.getVerboseCaptureFilename( traceContext );
@@ -256,16 +244,58 @@ inline static bool deserializeJson(
             fclose( fExport );
         }
     }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// the text passes of the original decoding path; the "length" fix every response gets, then any per-request fixes
+inline std::string applyBodyTextFixups( const NetConfiguration& netConfig, const std::string& body, const std::function< void( std::string& ) >& bodyTextProcessor )
+{
+    //
+    // apply horribly inefficient kludge to work around one particular version of Endlesss that decided to start
+    // writing out "length" keys as strings rather than numbers :O *shakes fist*
+    //
+    std::string bodyText = std::regex_replace( body, netConfig.getDataFixRegex_lengthTypeMismatch(), "\"length\":$1" );
+
+    // allow custom body modifications pre-parse in case there are any other hilarious json tripmines to work around
+    if ( bodyTextProcessor )
+    {
+        bodyTextProcessor( bodyText );
+    }
+    return bodyText;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// full cereal parse of already fixed-up text; throws cereal::Exception on failure
+template< typename _Type >
+inline void decodeWithCereal( const std::string& bodyText, _Type& instance )
+{
+    std::istringstream is( bodyText );
+    cereal::JSONInputArchive archive( is );
+
+    instance.serialize( archive );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// the original decoding path; regex fix-ups over the body text followed by a full cereal parse
+template< typename _Type >
+inline bool decodeWithFixups(
+    const NetConfiguration& netConfig,
+    const httplib::Result& res,
+    _Type& instance,
+    const std::string& functionContext,
+    std::string_view traceContext,
+    const std::function< void( std::string& ) >& bodyTextProcessor )
+{
+    const std::string bodyText = applyBodyTextFixups( netConfig, res->body, bodyTextProcessor );
+
+    captureBodyText( netConfig, traceContext, functionContext, bodyText );
 
     netConfig.metricsActivityRecv( bodyText.size() );
 
     // attempt the parse
     try
     {
-        std::istringstream is( bodyText );
-        cereal::JSONInputArchive archive( is );
-
-        instance.serialize( archive );
+        decodeWithCereal( bodyText, instance );
     }
     catch ( cereal::Exception& cEx )
     {
@@ -291,6 +321,112 @@ inline static bool deserializeJson(
     return true;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+// write an instance back out through cereal, giving a canonical form two decodes can be compared with
+template< typename _Type >
+inline std::string toCanonicalJson( _Type& instance )
+{
+    std::ostringstream os;
+    {
+        cereal::JSONOutputArchive archive( os );
+        instance.serialize( archive );
+    }
+    return os.str();
+}
+
+} // namespace detail
+
+// ---------------------------------------------------------------------------------------------------------------------
+// general boilerplate that takes a httplib response and tries to deserialize it from JSON to
+// the given type, returning false and logging the error if parsing bails
+template< typename _Type >
+inline static bool deserializeJson(
+    const NetConfiguration& netConfig,
+    const httplib::Result& res,
+    _Type& instance,
+    const std::string& functionContext,
+    std::string_view traceContext,
+    const std::function< void( std::string& ) >& bodyTextProcessor = nullptr )
+{
+    if ( !detail::checkResponse( res, functionContext ) )
+        return false;
+
+    return detail::decodeWithFixups( netConfig, res, instance, functionContext, traceContext, bodyTextProcessor );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// as deserializeJson but decoding in a single pass with json::Decoder, which deals with the known data quirks as it
+// goes rather than needing regex passes over the body first; used for the large, frequently fetched document types.
+// 
+// if the decoder rejects a document it is handed on to the original path - with (fallbackBodyTextProcessor) - so
+// anything it doesn't yet cope with still has a chance to parse, and still gets captured to disk if it doesn't
+template< typename _Type >
+inline static bool deserializeJsonStreaming(
+    const NetConfiguration& netConfig,
+    const httplib::Result& res,
+    _Type& instance,
+    const std::string& functionContext,
+    std::string_view traceContext,
+    const std::function< void( std::string& ) >& fallbackBodyTextProcessor = nullptr )
+{
+    if ( !detail::checkResponse( res, functionContext ) )
+        return false;
+
+    json::Decoder decoder;
+    if ( !decoder.decode( res->body, instance ) )
+    {
+        blog::api( FMTX( "JSON | {} | streaming decode failed, {} - trying fix-up path" ), functionContext, decoder.getError() );
+
+        instance = _Type{};
+        return detail::decodeWithFixups( netConfig, res, instance, functionContext, traceContext, fallbackBodyTextProcessor );
+    }
+
+    detail::captureBodyText( netConfig, traceContext, functionContext, res->body );
+
+    netConfig.metricsActivityRecv( res->body.size() );
+
+    // debug option to decode everything both ways and complain about any differences in the results
+    if ( netConfig.api().debugValidateStreamingDecode )
+    {
+        _Type reference;
+        bool referenceValid = false;
+        try
+        {
+            detail::decodeWithCereal( detail::applyBodyTextFixups( netConfig, res->body, fallbackBodyTextProcessor ), reference );
+            referenceValid = true;
+        }
+        catch ( cereal::Exception& cEx )
+        {
+            blog::api( FMTX( "JSON | {} | validation skipped, fix-up path failed ({})" ), functionContext, cEx.what() );
+        }
+
+        if ( referenceValid )
+        {
+            const std::string streamingResult = detail::toCanonicalJson( instance );
+            const std::string referenceResult = detail::toCanonicalJson( reference );
+
+            if ( streamingResult != referenceResult )
+            {
+                const auto exportFilename = netConfig.getVerboseCaptureFilename( "json_decode_mismatch" );
+                if ( !exportFilename.empty() )
+                {
+                    FILE* fExport = fopen( exportFilename.c_str(), "wt" );
+                    fprintf( fExport, "%s\n\n", functionContext.c_str() );
+                    fprintf( fExport, "-- streaming --\n%s\n\n", streamingResult.c_str() );
+                    fprintf( fExport, "-- fix-up --\n%s\n\n", referenceResult.c_str() );
+                    fprintf( fExport, "-- body --\n%s\n", res->body.c_str() );
+                    fclose( fExport );
+                }
+
+                blog::error::api( "JSON | {} | streaming and fix-up decodes differ", functionContext );
+                blog::error::api( "JSON | comparison saved to [{}]", exportFilename );
+            }
+        }
+    }
+
+    return true;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 // leanest parse possible, just the number of results that would have been returned
 struct TotalRowsOnly
@@ -551,6 +687,10 @@ struct ResultRiffDocument
                 }
             } slot;
 
+            // entries are positional, one per slot; should one arrive as null, json::Decoder keeps it as an
+            // empty slot rather than dropping it and shifting the rest along
+            static constexpr bool cJsonKeepNullArrayEntries = true;
+
             template<class Archive>
             inline void serialize( Archive& archive )
             {
@@ -676,6 +816,9 @@ struct JamRiffCount final : public TotalRowsOnly
 // ---------------------------------------------------------------------------------------------------------------------
 struct RiffDetails final : public ResultRowHeader<ResultDocsHeader<ResultRiffDocument, endlesss::types::RiffCouchID>>
 {
+    // text fix-ups fetchBatch applies before a cereal parse when debugLastMinuteQuirkFixes is on
+    static void applyBatchQuirkFixes( std::string& bodyText );
+
     bool fetch( const NetConfiguration& ncfg, const endlesss::types::JamCouchID& jamDatabaseID, const endlesss::types::RiffCouchID& riffDocumentID );
     bool fetchBatch( const NetConfiguration& ncfg, const endlesss::types::JamCouchID& jamDatabaseID, const std::vector< endlesss::types::RiffCouchID >& riffDocumentIDs );
 };
@@ -0,0 +1,356 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+//
+
+#include "pch.h"
+
+#include "cereal/external/rapidjson/error/en.h"
+
+// Daniel Lemire's fast_float version of std::from_chars
+#include "data/fast_float.h"
+
+#include "endlesss/api.json.h"
+
+namespace endlesss {
+namespace api {
+namespace json {
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool parseTextInteger( std::string_view text, bool& negative, uint64_t& magnitude )
+{
+    negative = false;
+    if ( !text.empty() && text.front() == '-' )
+    {
+        negative = true;
+        text.remove_prefix( 1 );
+    }
+
+    // 19 digits always fits in 64 bits, longer than that is not a value we'd ever expect anyway
+    if ( text.empty() || text.size() > 19 )
+        return false;
+
+    magnitude = 0;
+    for ( const char digit : text )
+    {
+        if ( digit < '0' || digit > '9' )
+            return false;
+
+        magnitude = ( magnitude * 10 ) + (uint64_t)( digit - '0' );
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _T >
+static bool parseTextFloatT( const std::string_view text, _T& result )
+{
+    if ( text.empty() )
+        return false;
+
+    const char* textEnd = text.data() + text.size();
+    auto [ptr, errorCode] = fast_float::from_chars( text.data(), textEnd, result );
+
+    return ( errorCode == std::errc() && ptr == textEnd );
+}
+
+bool parseTextFloat( std::string_view text, float& result )     { return parseTextFloatT( text, result ); }
+bool parseTextFloat( std::string_view text, double& result )    { return parseTextFloatT( text, result ); }
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Decoder::run( const std::string& body, const Target& root )
+{
+    m_depth         = 0;
+    m_skipDepth     = 0;
+    m_root          = root;
+    m_rootTaken     = false;
+    m_currentKey    = {};
+    m_error.clear();
+
+    CEREAL_RAPIDJSON_NAMESPACE::Reader reader;
+    CEREAL_RAPIDJSON_NAMESPACE::StringStream stream( body.c_str() );
+
+    try
+    {
+        // default flags match those cereal's JSONInputArchive parses with, so numbers decode identically
+        const CEREAL_RAPIDJSON_NAMESPACE::ParseResult parseResult = reader.Parse( stream, *this );
+        if ( parseResult.IsError() )
+        {
+            // our own handler errors surface as kParseErrorTermination, keep the more useful description
+            if ( m_error.empty() )
+                m_error = CEREAL_RAPIDJSON_NAMESPACE::GetParseError_En( parseResult.Code() );
+
+            m_error += fmt::format( FMTX( " (at offset {})" ), parseResult.Offset() );
+            return false;
+        }
+    }
+    // fix-up code in serialize() functions reports problems this way
+    catch ( cereal::Exception& cEx )
+    {
+        m_error = cEx.what();
+        return false;
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Decoder::Frame& Decoder::pushFrame()
+{
+    if ( m_depth == m_stack.size() )
+        m_stack.emplace_back();
+
+    return m_stack[m_depth++];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::vector< Field >& Decoder::pushObject( void* object, FinaliseFn finalise )
+{
+    Frame& frame = pushFrame();
+
+    frame.m_value           = object;
+    frame.m_isArray         = false;
+    frame.m_finalise        = finalise;
+    frame.m_pendingField    = -1;
+    frame.m_fields.clear();
+
+    return frame.m_fields;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Decoder::pushArray( void* container, AppendFn append, const TargetOps* elementOps, const bool keepNullEntries )
+{
+    Frame& frame = pushFrame();
+
+    frame.m_value           = container;
+    frame.m_isArray         = true;
+    frame.m_append          = append;
+    frame.m_elementOps      = elementOps;
+    frame.m_keepNulls       = keepNullEntries;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Target Decoder::takeTarget( const bool isNull )
+{
+    if ( m_depth == 0 )
+    {
+        if ( m_rootTaken )
+            return {};
+
+        m_rootTaken = true;
+        return m_root;
+    }
+
+    Frame& frame = m_stack[m_depth - 1];
+    if ( frame.m_isArray )
+    {
+        // skip over null entries unless the element type asked for them to be kept as defaults
+        if ( isNull && !frame.m_keepNulls )
+            return {};
+
+        m_currentKey = "<array element>";
+        return { frame.m_append( frame.m_value ), frame.m_elementOps };
+    }
+
+    if ( frame.m_pendingField < 0 )
+        return {};
+
+    Field& field = frame.m_fields[frame.m_pendingField];
+    field.m_seen = true;
+    frame.m_pendingField = -1;
+
+    return field.m_target;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Decoder::typeError( const char* valueKind )
+{
+    m_error = fmt::format( FMTX( "unexpected {} for [{}]" ), valueKind, m_currentKey );
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Decoder::Null()
+{
+    if ( m_skipDepth > 0 )
+        return true;
+
+    // null leaves whatever was there, be it a default value or a whole default object
+    std::ignore = takeTarget( true );
+    return true;
+}
+
+bool Decoder::Bool( bool value )
+{
+    if ( m_skipDepth > 0 )
+        return true;
+
+    const Target target = takeTarget( false );
+    if ( target.m_ops == nullptr )
+        return true;
+    if ( target.m_ops->m_fromBool == nullptr || !target.m_ops->m_fromBool( target.m_value, value ) )
+        return typeError( "bool" );
+    return true;
+}
+
+bool Decoder::Int64( int64_t value )
+{
+    if ( m_skipDepth > 0 )
+        return true;
+
+    const Target target = takeTarget( false );
+    if ( target.m_ops == nullptr )
+        return true;
+    if ( target.m_ops->m_fromInt == nullptr || !target.m_ops->m_fromInt( target.m_value, value ) )
+        return typeError( "integer" );
+    return true;
+}
+
+bool Decoder::Uint64( uint64_t value )
+{
+    if ( m_skipDepth > 0 )
+        return true;
+
+    const Target target = takeTarget( false );
+    if ( target.m_ops == nullptr )
+        return true;
+    if ( target.m_ops->m_fromUint == nullptr || !target.m_ops->m_fromUint( target.m_value, value ) )
+        return typeError( "integer" );
+    return true;
+}
+
+bool Decoder::Double( double value )
+{
+    if ( m_skipDepth > 0 )
+        return true;
+
+    const Target target = takeTarget( false );
+    if ( target.m_ops == nullptr )
+        return true;
+    if ( target.m_ops->m_fromDouble == nullptr || !target.m_ops->m_fromDouble( target.m_value, value ) )
+        return typeError( "number" );
+    return true;
+}
+
+bool Decoder::String( const char* value, CEREAL_RAPIDJSON_NAMESPACE::SizeType length, bool )
+{
+    if ( m_skipDepth > 0 )
+        return true;
+
+    const Target target = takeTarget( false );
+    if ( target.m_ops == nullptr )
+        return true;
+    if ( target.m_ops->m_fromString == nullptr || !target.m_ops->m_fromString( target.m_value, std::string_view( value, length ) ) )
+        return typeError( "string" );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Decoder::StartObject()
+{
+    if ( m_skipDepth > 0 )
+    {
+        m_skipDepth++;
+        return true;
+    }
+
+    const Target target = takeTarget( false );
+    if ( target.m_ops == nullptr )
+    {
+        m_skipDepth = 1;
+        return true;
+    }
+    if ( target.m_ops->m_beginObject == nullptr )
+        return typeError( "object" );
+
+    target.m_ops->m_beginObject( target.m_value, *this );
+    return true;
+}
+
+bool Decoder::Key( const char* value, CEREAL_RAPIDJSON_NAMESPACE::SizeType length, bool )
+{
+    if ( m_skipDepth > 0 )
+        return true;
+
+    Frame& frame = m_stack[m_depth - 1];
+    const std::string_view key( value, length );
+
+    frame.m_pendingField = -1;
+    for ( std::size_t fieldI = 0; fieldI < frame.m_fields.size(); fieldI++ )
+    {
+        if ( key == frame.m_fields[fieldI].m_name )
+        {
+            frame.m_pendingField = (int32_t)fieldI;
+            m_currentKey = frame.m_fields[fieldI].m_name;
+            break;
+        }
+    }
+    return true;
+}
+
+bool Decoder::EndObject( CEREAL_RAPIDJSON_NAMESPACE::SizeType )
+{
+    if ( m_skipDepth > 0 )
+    {
+        m_skipDepth--;
+        return true;
+    }
+
+    Frame& frame = m_stack[m_depth - 1];
+    for ( const Field& field : frame.m_fields )
+    {
+        // match cereal, which refuses documents missing a non-optional key
+        if ( field.m_required && !field.m_seen )
+        {
+            m_error = fmt::format( FMTX( "missing required key [{}]" ), field.m_name );
+            return false;
+        }
+    }
+
+    m_depth--;
+    frame.m_finalise( frame.m_value );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Decoder::StartArray()
+{
+    if ( m_skipDepth > 0 )
+    {
+        m_skipDepth++;
+        return true;
+    }
+
+    const Target target = takeTarget( false );
+    if ( target.m_ops == nullptr )
+    {
+        m_skipDepth = 1;
+        return true;
+    }
+    if ( target.m_ops->m_beginArray == nullptr )
+        return typeError( "array" );
+
+    target.m_ops->m_beginArray( target.m_value, *this );
+    return true;
+}
+
+bool Decoder::EndArray( CEREAL_RAPIDJSON_NAMESPACE::SizeType )
+{
+    if ( m_skipDepth > 0 )
+    {
+        m_skipDepth--;
+        return true;
+    }
+
+    m_depth--;
+    return true;
+}
+
+} // namespace json
+} // namespace api
+} // namespace endlesss
@@ -0,0 +1,408 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  single-pass streaming decoder for API responses; drives rapidjson's SAX reader straight into the api:: result
+//  structs, borrowing their existing cereal serialize() functions to learn which keys bind to which members.
+//
+//  it copes inline with the data quirks that otherwise need regex passes over the whole body before cereal will
+//  accept it -
+//
+//      "length":"13"               numbers written as strings are parsed as numbers
+//      "on":1                      0 / 1 accepted for booleans
+//      "current":null              null leaves the target value (or whole object) at its default
+//      "loops":[null,null,{..}]    null array entries are skipped - or, for element types that declare
+//                                  cJsonKeepNullArrayEntries, kept as default-constructed entries so positions hold
+//
+//  any fix-up code a serialize() function runs after its archive() call is re-run once that object has been filled,
+//  so it sees the same data it would have done under cereal
+//
+
+#pragma once
+
+namespace endlesss {
+namespace api {
+namespace json {
+
+class Decoder;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// per-type table of conversions from SAX events into a value of that type; entries left as nullptr mean that kind of
+// JSON value cannot be stored in the type and decoding will stop with an error
+struct TargetOps
+{
+    bool ( *m_fromBool )    ( void* target, const bool value )              = nullptr;
+    bool ( *m_fromInt )     ( void* target, const int64_t value )           = nullptr;
+    bool ( *m_fromUint )    ( void* target, const uint64_t value )          = nullptr;
+    bool ( *m_fromDouble )  ( void* target, const double value )            = nullptr;
+    bool ( *m_fromString )  ( void* target, const std::string_view value )  = nullptr;
+
+    void ( *m_beginObject ) ( void* target, Decoder& decoder )              = nullptr;
+    void ( *m_beginArray )  ( void* target, Decoder& decoder )              = nullptr;
+};
+
+// destination for the next value; with no m_ops, the value is parsed and discarded
+struct Target
+{
+    void*               m_value = nullptr;
+    const TargetOps*    m_ops   = nullptr;
+};
+
+// one key of an object, as captured from its serialize()
+struct Field
+{
+    const char*         m_name;
+    Target              m_target;
+    bool                m_required;
+    bool                m_seen;
+};
+
+using AppendFn   = void* (*)( void* container );    // add a default element to an array, return its address
+using FinaliseFn = void  (*)( void* object );       // re-run serialize() fix-ups once an object is complete
+
+template< typename _T >
+Target targetFor( _T& value );
+
+// text -> number conversions for values that arrive quoted; false if the whole string isn't a valid number
+ouro_nodiscard bool parseTextInteger( std::string_view text, bool& negative, uint64_t& magnitude );
+ouro_nodiscard bool parseTextFloat( std::string_view text, float& result );
+ouro_nodiscard bool parseTextFloat( std::string_view text, double& result );
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+class Decoder
+{
+public:
+
+    // decode (body) into (instance); returns false with a description in getError() if the JSON is malformed or
+    // does not fit the target. (instance) may be partially filled on failure
+    template< typename _T >
+    ouro_nodiscard bool decode( const std::string& body, _T& instance )
+    {
+        return run( body, targetFor( instance ) );
+    }
+
+    ouro_nodiscard const std::string& getError() const { return m_error; }
+
+
+    // called by TargetOps to open a container; the returned field list is only valid until the next push
+    ouro_nodiscard std::vector< Field >& pushObject( void* object, FinaliseFn finalise );
+    void pushArray( void* container, AppendFn append, const TargetOps* elementOps, const bool keepNullEntries );
+
+
+    // rapidjson SAX handler interface
+    bool Null();
+    bool Bool( bool value );
+    bool Int( int value )                                                       { return Int64( value ); }
+    bool Uint( unsigned value )                                                 { return Uint64( value ); }
+    bool Int64( int64_t value );
+    bool Uint64( uint64_t value );
+    bool Double( double value );
+    bool RawNumber( const char*, CEREAL_RAPIDJSON_NAMESPACE::SizeType, bool )   { return false; }   // kParseNumbersAsStringsFlag not used
+    bool String( const char* value, CEREAL_RAPIDJSON_NAMESPACE::SizeType length, bool );
+    bool StartObject();
+    bool Key( const char* value, CEREAL_RAPIDJSON_NAMESPACE::SizeType length, bool );
+    bool EndObject( CEREAL_RAPIDJSON_NAMESPACE::SizeType );
+    bool StartArray();
+    bool EndArray( CEREAL_RAPIDJSON_NAMESPACE::SizeType );
+
+private:
+
+    struct Frame
+    {
+        void*                   m_value         = nullptr;
+        bool                    m_isArray       = false;
+
+        // objects
+        std::vector< Field >    m_fields;
+        FinaliseFn              m_finalise      = nullptr;
+        int32_t                 m_pendingField  = -1;       // set by Key(), -1 if the key is unknown and its value discarded
+
+        // arrays
+        AppendFn                m_append        = nullptr;
+        const TargetOps*        m_elementOps    = nullptr;
+        bool                    m_keepNulls     = false;
+    };
+
+    ouro_nodiscard bool run( const std::string& body, const Target& root );
+
+    // resolve where the next value is going; consumes the pending key or appends an array element
+    ouro_nodiscard Target takeTarget( const bool isNull );
+
+    ouro_nodiscard Frame& pushFrame();
+
+    bool typeError( const char* valueKind );
+
+
+    std::vector< Frame >        m_stack;                    // grows to the deepest nesting seen, frames are reused
+    std::size_t                 m_depth         = 0;
+    uint32_t                    m_skipDepth     = 0;        // >0 while walking through a discarded object or array
+
+    Target                      m_root;
+    bool                        m_rootTaken     = false;
+    std::string_view            m_currentKey;               // for error reporting
+
+    std::string                 m_error;
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// stand-in cereal archive passed to serialize() to collect the name / member bindings of an object
+class FieldCapture
+{
+public:
+    explicit FieldCapture( std::vector< Field >& fields )
+        : m_fields( fields )
+    {}
+
+    template< typename... _Args >
+    FieldCapture& operator()( _Args&&... args )
+    {
+        ( bind( args ), ... );
+        return *this;
+    }
+
+private:
+
+    template< typename _T >
+    void bind( cereal::NameValuePair< _T >& nvp )
+    {
+        m_fields.push_back( { nvp.name, targetFor( nvp.value ), true, false } );
+    }
+
+    template< typename _T, typename _TV >
+    void bind( cereal::OptionalNameValuePair< _T, _TV >& nvp )
+    {
+        // apply any default up front, a value in the document will simply overwrite it
+        if constexpr ( !std::is_void_v< _TV > )
+            nvp.value = nvp.defaultValue;
+
+        m_fields.push_back( { nvp.name, targetFor( nvp.value ), false, false } );
+    }
+
+    std::vector< Field >&   m_fields;
+};
+
+// ... and one that does nothing, for re-running serialize() purely for the fix-up code that follows archive()
+struct FinaliseArchive
+{
+    template< typename... _Args >
+    FinaliseArchive& operator()( _Args&&... ) { return *this; }
+};
+
+
+namespace detail {
+
+template< typename _T >
+concept IsStringWrapper = requires { typename _T::StringWrapperType; };
+
+template< typename _T >
+concept IsVector = std::is_same_v< _T, std::vector< typename _T::value_type, typename _T::allocator_type > >;
+
+template< typename _T >
+concept KeepsNullArrayEntries = requires { requires _T::cJsonKeepNullArrayEntries; };
+
+template< typename _T >
+concept HasSerialize = requires( _T& value, FieldCapture& archive ) { value.serialize( archive ); };
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct BoolOps
+{
+    static bool fromBool( void* target, const bool value )      { *static_cast<bool*>( target ) = value; return true; }
+
+    // some documents store flags as 0 / 1
+    static bool fromInt( void* target, const int64_t value )
+    {
+        if ( value != 0 && value != 1 )
+            return false;
+        *static_cast<bool*>( target ) = ( value == 1 );
+        return true;
+    }
+    static bool fromUint( void* target, const uint64_t value )
+    {
+        if ( value > 1 )
+            return false;
+        *static_cast<bool*>( target ) = ( value == 1 );
+        return true;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _T >
+struct IntegerOps
+{
+    static bool fromBool( void* target, const bool value )      { *static_cast<_T*>( target ) = value ? 1 : 0; return true; }
+
+    static bool fromInt( void* target, const int64_t value )
+    {
+        if ( !std::in_range< _T >( value ) )
+            return false;
+        *static_cast<_T*>( target ) = static_cast<_T>( value );
+        return true;
+    }
+    static bool fromUint( void* target, const uint64_t value )
+    {
+        if ( !std::in_range< _T >( value ) )
+            return false;
+        *static_cast<_T*>( target ) = static_cast<_T>( value );
+        return true;
+    }
+    static bool fromDouble( void* target, const double value )
+    {
+        // accept 13.0 but not 13.5
+        if ( std::trunc( value ) != value ||
+             value < (double)std::numeric_limits<_T>::lowest() ||
+             value >= (double)std::numeric_limits<_T>::max() + 1.0 )
+            return false;
+        *static_cast<_T*>( target ) = static_cast<_T>( value );
+        return true;
+    }
+    static bool fromString( void* target, const std::string_view value )
+    {
+        bool negative;
+        uint64_t magnitude;
+        if ( !parseTextInteger( value, negative, magnitude ) )
+            return false;
+
+        if ( negative )
+        {
+            if ( magnitude > (uint64_t)std::numeric_limits<int64_t>::max() )
+                return false;
+            return fromInt( target, -(int64_t)magnitude );
+        }
+        return fromUint( target, magnitude );
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _T >
+struct FloatOps
+{
+    static bool fromInt( void* target, const int64_t value )     { *static_cast<_T*>( target ) = static_cast<_T>( value ); return true; }
+    static bool fromUint( void* target, const uint64_t value )   { *static_cast<_T*>( target ) = static_cast<_T>( value ); return true; }
+    static bool fromDouble( void* target, const double value )   { *static_cast<_T*>( target ) = static_cast<_T>( value ); return true; }
+    static bool fromString( void* target, const std::string_view value )
+    {
+        return parseTextFloat( value, *static_cast<_T*>( target ) );
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// strings, or the strongly-typed string wrappers used for IDs; numbers are accepted and written out as text
+template< typename _T >
+struct StringOps
+{
+    static std::string& access( void* target )
+    {
+        if constexpr ( IsStringWrapper< _T > )
+            return static_cast<_T*>( target )->value();
+        else
+            return *static_cast<_T*>( target );
+    }
+
+    static bool fromInt( void* target, const int64_t value )                { access( target ) = fmt::format( FMTX( "{}" ), value ); return true; }
+    static bool fromUint( void* target, const uint64_t value )              { access( target ) = fmt::format( FMTX( "{}" ), value ); return true; }
+    static bool fromDouble( void* target, const double value )              { access( target ) = fmt::format( FMTX( "{}" ), value ); return true; }
+    static bool fromString( void* target, const std::string_view value )    { access( target ).assign( value ); return true; }
+};
+
+template< typename _T >
+constexpr TargetOps makeTargetOps();
+
+template< typename _T >
+inline constexpr TargetOps cTargetOps = makeTargetOps< _T >();
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _T >
+struct ArrayOps
+{
+    using ElementType = typename _T::value_type;
+
+    static void* append( void* container )
+    {
+        return &static_cast<_T*>( container )->emplace_back();
+    }
+    static void beginArray( void* target, Decoder& decoder )
+    {
+        static_cast<_T*>( target )->clear();
+        decoder.pushArray( target, &append, &cTargetOps< ElementType >, KeepsNullArrayEntries< ElementType > );
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _T >
+struct ObjectOps
+{
+    static void finalise( void* object )
+    {
+        FinaliseArchive archive;
+        static_cast<_T*>( object )->serialize( archive );
+    }
+    static void beginObject( void* target, Decoder& decoder )
+    {
+        FieldCapture capture( decoder.pushObject( target, &finalise ) );
+        static_cast<_T*>( target )->serialize( capture );
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _T >
+constexpr TargetOps makeTargetOps()
+{
+    TargetOps ops;
+
+    if constexpr ( std::is_same_v< _T, bool > )
+    {
+        ops.m_fromBool      = &BoolOps::fromBool;
+        ops.m_fromInt       = &BoolOps::fromInt;
+        ops.m_fromUint      = &BoolOps::fromUint;
+    }
+    else if constexpr ( std::is_integral_v< _T > )
+    {
+        ops.m_fromBool      = &IntegerOps<_T>::fromBool;
+        ops.m_fromInt       = &IntegerOps<_T>::fromInt;
+        ops.m_fromUint      = &IntegerOps<_T>::fromUint;
+        ops.m_fromDouble    = &IntegerOps<_T>::fromDouble;
+        ops.m_fromString    = &IntegerOps<_T>::fromString;
+    }
+    else if constexpr ( std::is_floating_point_v< _T > )
+    {
+        ops.m_fromInt       = &FloatOps<_T>::fromInt;
+        ops.m_fromUint      = &FloatOps<_T>::fromUint;
+        ops.m_fromDouble    = &FloatOps<_T>::fromDouble;
+        ops.m_fromString    = &FloatOps<_T>::fromString;
+    }
+    else if constexpr ( std::is_same_v< _T, std::string > || IsStringWrapper< _T > )
+    {
+        ops.m_fromInt       = &StringOps<_T>::fromInt;
+        ops.m_fromUint      = &StringOps<_T>::fromUint;
+        ops.m_fromDouble    = &StringOps<_T>::fromDouble;
+        ops.m_fromString    = &StringOps<_T>::fromString;
+    }
+    else if constexpr ( IsVector< _T > )
+    {
+        ops.m_beginArray    = &ArrayOps<_T>::beginArray;
+    }
+    else
+    {
+        static_assert( HasSerialize< _T >, "json::Decoder cannot bind this type" );
+        ops.m_beginObject   = &ObjectOps<_T>::beginObject;
+    }
+
+    return ops;
+}
+
+} // namespace detail
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _T >
+Target targetFor( _T& value )
+{
+    return { &value, &detail::cTargetOps< _T > };
+}
+
+} // namespace json
+} // namespace api
+} // namespace endlesss
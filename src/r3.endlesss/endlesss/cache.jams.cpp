@@ -21,6 +21,7 @@
 #include "endlesss/api.h"
 #include "endlesss/cache.jams.h"
 #include "endlesss/config.h"
+#include "endlesss/toolkit.paging.h"
 
 using namespace std::chrono_literals;
 
@@ -149,11 +150,12 @@ bool Jams::save( const config::IPathProvider& pathProvider )
 // ---------------------------------------------------------------------------------------------------------------------
 void Jams::asyncCacheRebuild(
     const endlesss::api::NetConfiguration& netConfig,
+    base::WorkScheduler& workScheduler,
+    const base::WorkScheduler::CancellationToken& cancellation,
     const config::endlesss::SyncOptions& syncOptions,
-    tf::Taskflow& taskFlow,
     const AsyncCallback& asyncCallback )
 {
-    taskFlow.emplace( [this, &netConfig, syncOptions, asyncCallback]()
+    workScheduler.submit( base::WorkScheduler::Lane::Sync, [this, &netConfig, &workScheduler, cancellation, syncOptions, asyncCallback]()
     {
         static constexpr std::array< char, 4> busyAscii = { '\\', '|', '/', '-' };
         int32_t busyCounter = 0;
@@ -176,25 +178,55 @@ void Jams::asyncCacheRebuild(
             return;
         }
 
+        if ( cancellation.isCancelled() )
+        {
+            asyncCallback( AsyncFetchState::Failed, "Cancelled" );
+            return;
+        }
+
         if ( syncOptions.sync_collectibles )
         {
-            // fetch all known pages of collectibles
-            std::vector< api::CurrentCollectibleJams::Data > collectedCollectibles;
-            for ( int32_t page = 0; page < 100; page++ )    // just putting some kind of limit on this nonsense, don't know if there's a way to get total pages
+            // fetch all known pages of collectibles; there's no way to ask for a total page count, so keep a few page
+            // requests in flight and stop at the first empty one. the endpoint is slow, so waiting on each in turn took an age.
+            // pages go to the Prefetch lane, as this job may be holding the only Sync place
+            toolkit::PagedFetch::Options pagingOptions;
+            pagingOptions.m_cancellation = cancellation;
+
+            std::vector< api::CurrentCollectibleJams > collectiblePages;
+            const absl::Status pagingStatus = toolkit::PagedFetch::fetch< api::CurrentCollectibleJams >(
+                workScheduler,
+                base::WorkScheduler::Lane::Prefetch,
+                pagingOptions,
+                [&netConfig]( const uint32_t pageIndex, api::CurrentCollectibleJams& collectibles )
+                {
+                    return collectibles.fetch( netConfig, (int32_t)pageIndex );
+                },
+                []( const api::CurrentCollectibleJams& collectibles )
+                {
+                    return !collectibles.ok || collectibles.data.empty();
+                },
+                collectiblePages,
+                [&asyncCallback]( const uint32_t pagesFetched )
+                {
+                    asyncCallback( AsyncFetchState::Working, fmt::format( FMTX( "Fetching collectibles, {} pages ..." ), pagesFetched ) );
+                });
+
+            if ( absl::IsCancelled( pagingStatus ) )
             {
-                asyncCallback( AsyncFetchState::Working, fmt::format( FMTX( "Fetching collectibles, page {} ..." ), page ) );
+                asyncCallback( AsyncFetchState::Failed, "Cancelled" );
+                return;
+            }
 
-                // if the fetch works, bolt the new list onto the existing pile
-                api::CurrentCollectibleJams collectibles;
-                bool fetchOk = collectibles.fetch( netConfig, page );
-                if ( fetchOk && collectibles.ok && !collectibles.data.empty() )
-                {
+            // a failed page or hitting the page limit just truncates the list, as it always has
+            if ( !pagingStatus.ok() )
+                blog::error::cache( FMTX( "collectible jam paging stopped early; {}" ), pagingStatus.ToString() );
+
+            // bolt all the pages together onto one pile
+            std::vector< api::CurrentCollectibleJams::Data > collectedCollectibles;
+            for ( const api::CurrentCollectibleJams& collectibles : collectiblePages )
+            {
+                if ( collectibles.ok )
                     collectedCollectibles.insert( collectedCollectibles.end(), collectibles.data.begin(), collectibles.data.end() );
-                }
-                else
-                {
-                    break;
-                }
             }
             // convert to our cached collectibles type
             {
@@ -298,7 +330,8 @@ void Jams::asyncCacheRebuild(
 
         postProcessNewData();
         asyncCallback( AsyncFetchState::Success, "" );
-    });
+    },
+    cancellation );
 
     asyncCallback( AsyncFetchState::Working, "Fetching data ..." );
 }
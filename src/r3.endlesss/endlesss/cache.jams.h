@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "base/scheduler.h"
+
 #include "endlesss/config.h"
 
 namespace endlesss {
@@ -130,11 +132,14 @@ struct Jams
     };
     using AsyncCallback = std::function< void( const AsyncFetchState state, const std::string& status )>;
 
-    // fetch the users' latest jam membership state + list of active publics from the servers
+    // fetch the users' latest jam membership state + list of active publics from the servers; runs as a job in the
+    // Sync lane of (workScheduler), requesting collectible pages in parallel in the same lane. cancelling (cancellation)
+    // drops the job if it hasn't started yet, or has it give up with a Failed state at the next step
     void asyncCacheRebuild(
         const endlesss::api::NetConfiguration& netConfig,
+        base::WorkScheduler& workScheduler,
+        const base::WorkScheduler::CancellationToken& cancellation,
         const config::endlesss::SyncOptions& syncOptions,
-        tf::Taskflow& taskFlow,
         const AsyncCallback& asyncCallback );
 
     ouro_nodiscard constexpr const std::string& getCacheFileState() const { return m_cacheFileState; }
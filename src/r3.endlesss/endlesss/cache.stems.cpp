@@ -13,6 +13,7 @@
 
 #include "filesys/fsutil.h"
 #include "spacetime/moment.h"
+#include "sys/slab.h"
 
 #include "endlesss/cache.stems.h"
 #include "endlesss/live.stem.h"
@@ -61,12 +62,18 @@ Stems::Stems()
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-absl::Status Stems::initialise( const fs::path& cachePath, const uint32_t targetSampleRate )
+absl::Status Stems::initialise(
+    const fs::path& cachePath,
+    const uint32_t targetSampleRate,
+    const endlesss::live::Stem::SampleStorage sampleStorage,
+    const int32_t progressiveStartBars )
 {
     const fs::path stemSubdir = getCachePathRoot( CacheVersion::Version2 );
 
     m_cacheStemRoot     = cachePath / stemSubdir;
     m_targetSampleRate  = targetSampleRate;
+    m_sampleStorage     = sampleStorage;
+    m_progressiveStartBars = std::max( progressiveStartBars, 0 );
 
     const auto stemRootStatus = filesys::ensureDirectoryExists( m_cacheStemRoot );
     if ( !stemRootStatus.ok() )
@@ -97,7 +104,7 @@ endlesss::live::StemPtr Stems::request( const endlesss::types::Stem& stemData )
         auto stemIter = m_stems.find( stemDocumentID );
         if ( stemIter == m_stems.end() )
         {
-            auto newStem = std::make_shared<endlesss::live::Stem>( stemData, m_targetSampleRate );
+            auto newStem = std::make_shared<endlesss::live::Stem>( stemData, m_targetSampleRate, m_sampleStorage, m_progressiveStartBars > 0 );
 
             m_usages.emplace( stemDocumentID, m_stemGeneration );
             m_stems.emplace( stemDocumentID, newStem );
@@ -188,6 +195,12 @@ void Stems::lockAndPrune( const bool verbose, const uint32_t generationsToKeep )
 
         blog::stem( "stem cache prune trimmed {} entries, took {}", (beforeSize - afterSize), pruneTimer.delta< std::chrono::milliseconds >() );
     }
+
+    // pruned stems have handed their slabs back already, decommitted; release most of that address space too,
+    // keeping a little back for the riffs that are about to load in to replace them
+    auto& sampleAllocator = endlesss::live::Stem::getSampleAllocator();
+    sampleAllocator.trim( cSampleAddressSpaceKeptAfterPrune );
+    sampleAllocator.logStatistics();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -44,7 +44,12 @@ struct Stems
 
     absl::Status initialise( 
         const fs::path& cachePath,          // the root path of where to build the stored stems
-        const uint32_t targetSampleRate     // the chosen sample rate, stems will be resampled to this if they don't match
+        const uint32_t targetSampleRate,    // the chosen sample rate, stems will be resampled to this if they don't match
+        const endlesss::live::Stem::SampleStorage sampleStorage = endlesss::live::Stem::SampleStorage::Float32,
+                                            // how newly loaded stems hold their audio in memory
+        const int32_t progressiveStartBars = 0
+                                            // if > 0, newly loaded stems decode progressively and riffs become playable
+                                            // once this many bars of each stem are ready, rather than all of them
     );
 
     ouro_nodiscard endlesss::live::StemPtr request( const endlesss::types::Stem& stemData );
@@ -54,6 +59,9 @@ struct Stems
 
     ouro_nodiscard fs::path getCacheRootPath() const { return m_cacheStemRoot; }
 
+    // see initialise(); 0 if riffs wait for their stems to completely decode before playing
+    ouro_nodiscard constexpr int32_t getProgressiveStartBars() const { return m_progressiveStartBars; }
+
     // synchronously lock & garbage collect the cache
     void lockAndPrune( const bool verbose, const uint32_t generationsToKeep = 64 );
 
@@ -70,6 +78,9 @@ struct Stems
 
 private:
 
+    // how much retained stem sample address space survives a prune
+    static constexpr std::size_t cSampleAddressSpaceKeptAfterPrune = 64 * 1024 * 1024;
+
     using StemProcessing    = endlesss::live::Stem::Processing::UPtr;
     using StemDictionary    = absl::flat_hash_map< endlesss::types::StemCouchID, endlesss::live::StemPtr >;
     using StemUsage         = absl::flat_hash_map< endlesss::types::StemCouchID, uint32_t >;
@@ -82,6 +93,9 @@ private:
     StemUsage           m_usages;
 
     uint32_t            m_targetSampleRate = 0;
+    endlesss::live::Stem::SampleStorage
+                        m_sampleStorage = endlesss::live::Stem::SampleStorage::Float32;
+    int32_t             m_progressiveStartBars = 0;
     uint32_t            m_stemGeneration = 0;
     std::mutex          m_pruneLock;
 };
@@ -136,6 +136,10 @@ OURO_CONFIG( rAPI )
     // panic mode to enable late fixes to quirks found during the week before service shutdown
     bool                    debugLastMinuteQuirkFixes = false;
 
+    // if true, responses decoded by the streaming JSON decoder are also decoded through the original regex + cereal
+    // path and the two results compared; any differences are logged and written out alongside the response body
+    bool                    debugValidateStreamingDecode = false;
+
     template<class Archive>
     void serialize( Archive& archive )
     {
@@ -151,6 +155,7 @@ OURO_CONFIG( rAPI )
                , CEREAL_OPTIONAL_NVP( hackAllowStemSizeMismatch )
                , CEREAL_OPTIONAL_NVP( debugVerboseNetLog )
                , CEREAL_OPTIONAL_NVP( debugVerboseNetDataCapture )
+               , CEREAL_OPTIONAL_NVP( debugValidateStreamingDecode )
         );
     }
 };
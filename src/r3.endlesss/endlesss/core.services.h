@@ -10,6 +10,7 @@
 #pragma once
 
 #include "base/service.h"
+#include "dsp/timestretch.h"
 
 namespace endlesss {
 
@@ -35,6 +36,7 @@ struct IRiffFetchService
     ouro_nodiscard virtual const endlesss::api::NetConfiguration&   getNetConfiguration() const = 0;    // access keys
     ouro_nodiscard virtual endlesss::cache::Stems&                  getStemCache() = 0;                 // cache storage for stems
     ouro_nodiscard virtual tf::Executor&                            getTaskExecutor() = 0;              // parallelisation
+    ouro_nodiscard virtual dsp::TimeStretch::Preset                 getTimeStretchPreset() const = 0;   // how stems are re-timed to riffs at other tempos
 };
 
 using RiffFetchInstance = base::ServiceInstance<IRiffFetchService>;
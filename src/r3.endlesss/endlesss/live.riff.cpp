@@ -23,6 +23,86 @@ using namespace std::chrono;
 namespace endlesss {
 namespace live {
 
+namespace {
+
+// everything one stretch task works with, held apart from the riff that launched it so the riff can be released
+// while the task is still running; the stem is only weakly held, and the task skips out if it has already gone
+struct StretchTask
+{
+    std::shared_ptr< Riff::StretchedStem >  m_stretched;
+    std::weak_ptr< Stem >                   m_stem;
+    std::shared_ptr< std::atomic_bool >     m_abort;
+    std::string                             m_riffCouchID;
+    std::size_t                             m_stemIndex;
+    double                                  m_timeScale;
+    uint32_t                                m_sampleRate;
+    dsp::TimeStretch::Preset                m_preset;
+
+    // render the stretched stem; runs on the task executor once the stem has finished decoding
+    void operator()() const;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StretchTask::operator()() const
+{
+    base::instr::ScopedEvent wte( "Riff::stretch", base::instr::PresetColour::Lime );
+
+    const StemPtr stem = m_stem.lock();
+    if ( stem == nullptr || stem->hasFailed() || stem->m_sampleCount <= 0 || m_abort->load() )
+        return;
+
+    Riff::StretchedStem* stretched = m_stretched.get();
+
+    const int32_t inputLength  = stem->m_sampleCount;
+    const int32_t outputLength = dsp::TimeStretch::getOutputLength( inputLength, m_timeScale );
+
+    stretched->m_channel[0] = Stem::getSampleAllocator().allocateArray<float>( outputLength );
+    stretched->m_channel[1] = Stem::getSampleAllocator().allocateArray<float>( outputLength );
+    if ( stretched->m_channel[0] == nullptr || stretched->m_channel[1] == nullptr )
+    {
+        blog::error::riff( FMTX( "[R:{}] unable to allocate stretched stem {}" ), m_riffCouchID, m_stemIndex + 1 );
+        return;
+    }
+    stretched->m_sampleCount = outputLength;
+
+    // compact stems are expanded to work from, float stems are read in place
+    std::array< const float*, 2 > input    = { stem->m_channel[0], stem->m_channel[1] };
+    std::array< float*, 2 >       expanded = { nullptr, nullptr };
+    if ( stem->isCompact() )
+    {
+        for ( int32_t channel = 0; channel < 2; channel++ )
+        {
+            expanded[channel] = mem::alloc16<float>( inputLength, mem::Tag::Riffs );
+            stem->readSamples( channel, 0, inputLength, expanded[channel] );
+            input[channel] = expanded[channel];
+        }
+    }
+
+    const dsp::TimeStretch timeStretch( m_preset, m_sampleRate );
+    const bool completed = timeStretch.renderLoop( input, inputLength, m_timeScale, stretched->m_channel, outputLength,
+        [this, stretched]( const int32_t samplesComplete )
+        {
+            stretched->m_samplesAvailable.store( samplesComplete, std::memory_order_release );
+            return !m_abort->load( std::memory_order_relaxed );
+        });
+
+    mem::free16( expanded[0], mem::Tag::Riffs );
+    mem::free16( expanded[1], mem::Tag::Riffs );
+
+    if ( completed )
+    {
+        blog::riff( FMTX( "[R:{}] stem {} stretched by {:.3f} ({} -> {} samples, {})" ),
+            m_riffCouchID,
+            m_stemIndex + 1,
+            m_timeScale,
+            inputLength,
+            outputLength,
+            dsp::TimeStretch::cPresetNames[(std::size_t)m_preset] );
+    }
+}
+
+} // anonymous namespace
+
 // ---------------------------------------------------------------------------------------------------------------------
 endlesss::live::Riff::RiffCIDHash Riff::computeHashForRiffCID( const endlesss::types::RiffCouchID& riffCID )
 {
@@ -36,6 +116,7 @@ Riff::Riff( const endlesss::types::RiffComplete& riffData )
     , m_computedRiffCouchHash( RiffCIDHash::Invalid() )
 {
     m_stemSampleRate = 0;
+    m_stretchAbort   = std::make_shared< std::atomic_bool >( false );
 
     m_stemOwnership.fill( nullptr );
     m_stemPtrs.fill( nullptr );
@@ -55,11 +136,25 @@ Riff::Riff( const endlesss::types::RiffComplete& riffData )
     blog::riff( FMTX( "[R:{}] allocated | H:{:#x}" ), m_riffData.riff.couchID, m_computedRiffCouchHash.getID() );
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+Riff::StretchedStem::~StretchedStem()
+{
+    Stem::getSampleAllocator().free( m_channel[0] );
+    Stem::getSampleAllocator().free( m_channel[1] );
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 Riff::~Riff()
 {
     blog::riff( FMTX( "[R:{}] released | H:{:#x}" ), m_riffData.riff.couchID, m_computedRiffCouchHash.getID() );
 
+    // stretch tasks share ownership of their buffers, so there's nothing to wait for; just tell any still running
+    // to give up, and whichever of us lets go last frees the buffers
+    m_stretchAbort->store( true );
+
+    for ( auto& stretched : m_stemStretched )
+        stretched.reset();
+
     for ( auto& sP : m_stemOwnership )
         sP.reset();
 
@@ -133,10 +228,22 @@ void Riff::fetch( services::RiffFetchProvider& services )
 
         blog::riff( FMTX( "[R:{}..] riff stem resolution ..." ), riffCouchSnip );
 
+        // with progressive decoding on, we only hold the riff back until the first few bars of each stem are ready;
+        // the rest continue decoding (and then get analysed) in the background while playback starts
+        const int32_t progressiveStartBars = services->getStemCache().getProgressiveStartBars();
+
+        // stems recorded at another tempo can be re-timed to ours rather than resampled; each gets a stretch task,
+        // launched as its own async work once the stem is fully decoded - from the end of its load task when we're
+        // loading it progressively, otherwise once loading is over. stems still mid-load on behalf of some other riff
+        // are left on the resample path
+        const dsp::TimeStretch::Preset timeStretchPreset = services->getTimeStretchPreset();
+        tf::Executor& taskExecutor = services->getTaskExecutor();
+
         tf::Taskflow stemLoadFlow;
         tf::Taskflow stemAnalysisFlow;
 
         std::vector< endlesss::live::Stem* > stemsWithAsyncAnalysis;
+        std::vector< StretchTask > stretchTasksAfterLoad;
 
         for ( size_t stemI = 0; stemI < 8; stemI++ )
         {
@@ -150,8 +257,51 @@ void Riff::fetch( services::RiffFetchProvider& services )
 
                 endlesss::live::Stem* loopStemRaw = loopStemPtr.get();
 
+                // stems can be used across riffs with changed tempos, we have to scale to cope
+                const auto stemTimeScale = theRiff.BPS / stemData.BPS;
+
+                const bool stemWantsStretch = timeStretchPreset != dsp::TimeStretch::Preset::Off &&
+                                              stemTimeScale != 1.0f &&
+                                              dsp::TimeStretch::isTimeScaleSupported( stemTimeScale );
+
+                const auto createStretchTask = [&]() -> StretchTask
+                {
+                    m_stemStretched[stemI] = std::make_shared< StretchedStem >();
+
+                    return StretchTask{
+                        m_stemStretched[stemI],
+                        loopStemPtr,
+                        m_stretchAbort,
+                        m_riffData.riff.couchID,
+                        stemI,
+                        (double)stemTimeScale,
+                        m_stemSampleRate,
+                        timeStretchPreset };
+                };
+
                 // if this was a fresh stem, enqueue it for loading via task graph
-                if ( loopStemRaw->m_state == endlesss::live::Stem::State::Empty )
+                if ( loopStemRaw->m_state == endlesss::live::Stem::State::Empty && progressiveStartBars > 0 )
+                {
+                    // this task outlives fetch(), so it can't hold on to (services) or our riff data - only the
+                    // long-lived network config and stem processing state it references
+                    const auto& netConfiguration = services->getNetConfiguration();
+                    const auto  stemCachePath    = services->getStemCache().getCachePathForStem( stemData );
+
+                    std::optional< StretchTask > stretchTask;
+                    if ( stemWantsStretch )
+                        stretchTask = createStretchTask();
+
+                    stemLoadFlow.emplace( [&stemProcessing, &netConfiguration, &taskExecutor, stemCachePath, loopStemRaw, stretchTask]()
+                    {
+                        loopStemRaw->fetch( netConfiguration, stemCachePath );
+                        loopStemRaw->analyse( stemProcessing );
+
+                        if ( stretchTask.has_value() )
+                            taskExecutor.silent_async( *stretchTask );
+                    });
+                    stemsWithAsyncAnalysis.push_back( loopStemRaw );
+                }
+                else if ( loopStemRaw->m_state == endlesss::live::Stem::State::Empty )
                 {
                     stemLoadFlow.emplace( [&stemData, &services, loopStemRaw]()
                     {
@@ -162,25 +312,64 @@ void Riff::fetch( services::RiffFetchProvider& services )
                         loopStemRaw->analyse( stemProcessing );
                     });
                     stemsWithAsyncAnalysis.push_back( loopStemRaw );
+
+                    // analysis runs once loading is over, and so can stretching
+                    if ( stemWantsStretch )
+                        stretchTasksAfterLoad.emplace_back( createStretchTask() );
+                }
+                else if ( stemWantsStretch && loopStemRaw->isFetchFinished() )
+                {
+                    stretchTasksAfterLoad.emplace_back( createStretchTask() );
                 }
                 m_stemPtrs[stemI] = loopStemRaw;
 
-                // stems can be used across riffs with changed tempos, we have to scale to cope
-                const auto stemTimeScale = theRiff.BPS / stemData.BPS;
                 m_stemGains[stemI] = theRiff.gains[stemI];
                 m_stemTimeScales[stemI] = stemTimeScale;
             }
         }
 
-        // spread out stem loading across task system
-        auto stemLoadFuture = services->getTaskExecutor().run( stemLoadFlow );
-        stemLoadFuture.wait();
+        if ( progressiveStartBars > 0 )
+        {
+            // fetch + analysis run as one chain per stem; hand the graph off and have every stem keep hold of its
+            // future, same as the analysis-only future below, so nothing is released out from under the decode
+            std::shared_future<void> stemSharedLoad( taskExecutor.run( std::move(stemLoadFlow) ) );
+            for ( endlesss::live::Stem* rawStem : stemsWithAsyncAnalysis )
+                rawStem->keepFuture( stemSharedLoad );
+
+            // only already-resident stems are left to stretch here, nothing to wait for
+            for ( const StretchTask& stretchTask : stretchTasksAfterLoad )
+                taskExecutor.silent_async( stretchTask );
+
+            // then wait until each stem has enough decoded to start playing; this includes stems that were already
+            // mid-decode on behalf of another riff. anything that can't decode progressively just waits to finish
+            for ( std::size_t stemI = 0; stemI < m_stemPtrs.size(); stemI++ )
+            {
+                const auto* loopStem = m_stemPtrs[stemI];
+                if ( loopStem == nullptr )
+                    continue;
 
-        // with data loaded, enqueue the post-process analysis tasks; shift ownership of the graph and return
-        // a future that all stems can wait() on pre-destruction to ensure the underlying data isn't tossed before the tasks complete
-        std::shared_future<void> stemSharedAnalysis( services->getTaskExecutor().run( std::move(stemAnalysisFlow) ) );
-        for ( endlesss::live::Stem* rawStem : stemsWithAsyncAnalysis )
-            rawStem->keepFuture( stemSharedAnalysis );
+                const double startSeconds = m_timingDetails.m_lengthInSecPerBar * (double)progressiveStartBars;
+                const double startSamples = startSeconds * targetSampleRateD * (double)m_stemTimeScales[stemI];
+
+                loopStem->waitForSamples( (int32_t)std::min( startSamples, (double)INT32_MAX ) );
+            }
+        }
+        else
+        {
+            // spread out stem loading across task system
+            auto stemLoadFuture = taskExecutor.run( stemLoadFlow );
+            stemLoadFuture.wait();
+
+            // with data loaded, enqueue the post-process analysis tasks; shift ownership of the graph and return
+            // a future that all stems can wait() on pre-destruction to ensure the underlying data isn't tossed before the tasks complete
+            std::shared_future<void> stemSharedAnalysis( taskExecutor.run( std::move(stemAnalysisFlow) ) );
+            for ( endlesss::live::Stem* rawStem : stemsWithAsyncAnalysis )
+                rawStem->keepFuture( stemSharedAnalysis );
+
+            // stretching only reads the decoded samples, so it can run alongside the analysis
+            for ( const StretchTask& stretchTask : stretchTasksAfterLoad )
+                taskExecutor.silent_async( stretchTask );
+        }
 
         // once stems are loaded, work out their final lengths so we can determine the shape of the riff
         for ( std::size_t stemI = 0; stemI < m_stemPtrs.size(); stemI++ )
@@ -286,6 +475,10 @@ void Riff::exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, cons
         const float stemGain          = m_stemGains[stemI];
         endlesss::live::Stem* stemPtr = m_stemPtrs[stemI];
 
+        // exports read the whole stem, so any still decoding in the background have to finish first
+        if ( stemPtr != nullptr )
+            stemPtr->waitForFetch();
+
         if ( stemPtr == nullptr   ||
              stemPtr->hasFailed() ||
              stemGain <= 0.0f )
@@ -298,8 +491,8 @@ void Riff::exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, cons
             const int32_t sampleCount = stemPtr->m_sampleCount;
             const int32_t sampleCountTimeScaled = (int32_t)( (double)sampleCount / (double)stemTimeStretch );
 
-            auto exportChannelLeft  = mem::alloc16To<float>( sampleCountTimeScaled, 0.0f );
-            auto exportChannelRight = mem::alloc16To<float>( sampleCountTimeScaled, 0.0f );
+            auto exportChannelLeft  = mem::alloc16To<float>( sampleCountTimeScaled, 0.0f, mem::Tag::Riffs );
+            auto exportChannelRight = mem::alloc16To<float>( sampleCountTimeScaled, 0.0f, mem::Tag::Riffs );
 
             const int32_t sampleOffsetTimeScaled = (int32_t)( (double)sampleOffset * (double)stemTimeStretch );
 
@@ -308,16 +501,16 @@ void Riff::exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, cons
                 const int32_t readSampleTimeScaled           = (int32_t)( (double)sampleWrite * (double)stemTimeStretch );
                 const int32_t readSampleTimeScaledWithOffset = ( readSampleTimeScaled + sampleOffsetTimeScaled ) % sampleCount;
 
-                exportChannelLeft[sampleWrite]  = stemPtr->m_channel[0][readSampleTimeScaledWithOffset] * stemGain;
-                exportChannelRight[sampleWrite] = stemPtr->m_channel[1][readSampleTimeScaledWithOffset] * stemGain;
+                exportChannelLeft[sampleWrite]  = stemPtr->getSample( 0, readSampleTimeScaledWithOffset ) * stemGain;
+                exportChannelRight[sampleWrite] = stemPtr->getSample( 1, readSampleTimeScaledWithOffset ) * stemGain;
             }
 
             // output to disk, force flush immediately
             diskWriter->appendSamples( exportChannelLeft, exportChannelRight, sampleCountTimeScaled );
             diskWriter.reset();
 
-            mem::free16( exportChannelLeft );
-            mem::free16( exportChannelRight );
+            mem::free16( exportChannelLeft, mem::Tag::Riffs );
+            mem::free16( exportChannelRight, mem::Tag::Riffs );
         }
     }
 }
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "base/construction.h"
 #include "base/id.hash.h"
 #include "spacetime/chronicle.h"
 
@@ -114,6 +115,30 @@ struct Riff
     inline const RiffTimingDetails& getTimingDetails() const { return m_timingDetails; }
 
 
+    // a stem re-timed to the riff tempo without changing its pitch; created by fetch() for stems recorded at another
+    // tempo when a time-stretch preset is chosen, then rendered front-to-back on the task executor. mixers read it in
+    // place of the resampled stem wherever it has been rendered up to, and fall back to the stem beyond that. the
+    // stretch task shares ownership, so a riff released mid-stretch doesn't wait for it
+    struct StretchedStem
+    {
+        DECLARE_NO_COPY_NO_MOVE( StretchedStem );
+
+        StretchedStem() = default;
+        ~StretchedStem();
+
+        // m_sampleCount and m_channel are only set up once the source stem has decoded; both are safe to read once
+        // this returns anything above zero
+        ouro_nodiscard int32_t getSamplesAvailable() const { return m_samplesAvailable.load( std::memory_order_acquire ); }
+
+        std::array< float*, 2 >     m_channel       = { nullptr, nullptr };
+        int32_t                     m_sampleCount   = 0;
+        std::atomic_int32_t         m_samplesAvailable = 0;
+    };
+
+    // nullptr if the stem plays at the riff tempo already, or isn't being stretched
+    ouro_nodiscard inline const StretchedStem* getStretchedStem( const std::size_t stemIndex ) const { return m_stemStretched[stemIndex].get(); }
+
+
     enum class SyncState
     {
         Waiting,
@@ -162,6 +187,9 @@ public:
     std::array<int32_t, 8>                  m_stemRepetitions;
     std::array<uint32_t, 8>                 m_stemLengthInSamples;
 
+    std::array<std::shared_ptr<StretchedStem>, 8>
+                                            m_stemStretched;
+
     spacetime::InSeconds                    m_stTimestamp;
 
     // set of handy pre-formatted strings for use in UI rendering
@@ -172,7 +200,10 @@ public:
     std::string                             m_uiPlaybackDebug;          // some playback debugging info (stem repeats, length in sec, ..)
 
 protected:
+
     RiffCIDHash                             m_computedRiffCouchHash;
+
+    std::shared_ptr<std::atomic_bool>       m_stretchAbort;             // shared with our stretch tasks; set on release to have them give up early
 };
 
 using RiffPtr = std::shared_ptr<Riff>;
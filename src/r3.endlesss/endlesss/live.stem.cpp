@@ -14,12 +14,15 @@
 #include "base/instrumentation.h"
 #include "base/utils.h"
 
+#include "buffer/compact.h"
 #include "dsp/fft.util.h"
 #include "dsp/octave.h"
+#include "dsp/resample.h"
 #include "endlesss/live.stem.h"
 #include "filesys/fsutil.h"
 #include "math/rng.h"
 #include "spacetime/moment.h"
+#include "sys/slab.h"
 #include "config/spectrum.h"
 
 // vorbis decode
@@ -32,9 +35,6 @@
 // fft
 #include "pffft.h"
 
-// r8brain
-#include "CDSPResampler.h"
-
 // q
 #include <q/fx/schmitt_trigger.hpp>
 #include <q/fx/signal_conditioner.hpp>
@@ -46,6 +46,9 @@
 namespace endlesss {
 namespace live {
 
+// number of samples at the end of each stem that applyLoopSewingBlend() rewrites
+static constexpr int32_t cLoopSewingWindowSize = 128;
+
 // ---------------------------------------------------------------------------------------------------------------------
 Stem::Processing::~Processing()
 {
@@ -79,14 +82,29 @@ Stem::Processing::UPtr Stem::createStemProcessing( const uint32_t targetSampleRa
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-Stem::Stem( const types::Stem& stemData, const uint32_t targetSampleRate )
-    : m_data( stemData )
+sys::SlabAllocator& Stem::getSampleAllocator()
+{
+    // enough decommitted address space kept back to turn over a few riffs' worth of stems without going to the OS
+    static constexpr std::size_t cRetainedAddressSpace = 256 * 1024 * 1024;
+
+    static sys::SlabAllocator sampleAllocator( "stems", mem::Tag::Stems, cRetainedAddressSpace );
+    return sampleAllocator;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Stem::Stem( const types::Stem& stemData, const uint32_t targetSampleRate, const SampleStorage sampleStorage, const bool progressiveDecode )
+    : m_sampleStorageRequested( sampleStorage )
+    , m_progressiveDecode( progressiveDecode && sampleStorage == SampleStorage::Float32 )
+    , m_data( stemData )
     , m_state( State::Empty )
     , m_sampleRate( targetSampleRate )
     , m_sampleCount( 0 )
     , m_analysisState( AnalysisState::InProgress )
 {
     m_channel.fill( nullptr );
+    m_channelInt16.fill( nullptr );
+    m_channelMantissa.fill( nullptr );
+    m_channelBlockScale.fill( nullptr );
 
     m_colourU32 = ImGui::ParseHexColour( m_data.colour.c_str() );
 
@@ -102,16 +120,206 @@ Stem::~Stem()
 
     blog::stem( FMTX( "[s:{}] released" ), m_data.couchID );
 
-    mem::free16( m_channel[0] );
-    mem::free16( m_channel[1] );
+    auto& sampleAllocator = getSampleAllocator();
+    for ( auto channel = 0; channel < 2; channel++ )
+    {
+        sampleAllocator.free( m_channel[channel] );
+        sampleAllocator.free( m_channelInt16[channel] );
+        sampleAllocator.free( m_channelMantissa[channel] );
+        mem::free16( m_channelBlockScale[channel], mem::Tag::Stems );
+    }
 
     m_sampleCount       = 0;
     m_state             = State::Empty;
     m_stateHttpStatus   = 0;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+// FLAC decode target; decoded frames go straight into the stem's final channel buffers, through this thread's
+// streaming resamplers if the rates differ. with progressive decoding the watermark advances after every block, so
+// the front of the stem can be playing while the rest is still decoding
+//
+struct Stem::DecodeWriter
+{
+    static constexpr int32_t cBlockSamples = dsp::StreamResampler::cBlockSamples;
+
+    DecodeWriter( Stem& stem, const uint32_t sourceSampleRate, const int32_t sourceSampleCount )
+        : m_stem( stem )
+    {
+        if ( sourceSampleRate != stem.m_sampleRate )
+        {
+            m_resampler[0] = &dsp::StreamResampler::acquire( sourceSampleRate, stem.m_sampleRate, 0 );
+            m_resampler[1] = &dsp::StreamResampler::acquire( sourceSampleRate, stem.m_sampleRate, 1 );
+
+            m_outputLength = m_resampler[0]->getOutputLength( sourceSampleCount );
+        }
+        else
+        {
+            m_outputLength = sourceSampleCount;
+        }
+
+        stem.m_channel[0] = getSampleAllocator().allocateArray<float>( m_outputLength );
+        stem.m_channel[1] = getSampleAllocator().allocateArray<float>( m_outputLength );
+
+        // the final length is known up front; it must be set before the first watermark is published
+        stem.m_sampleCount = m_outputLength;
+    }
+
+    ouro_nodiscard constexpr bool isResampling() const { return m_resampler[0] != nullptr; }
+
+    inline void push( const double left, const double right )
+    {
+        m_lastPushed = { left, right };
+
+        if ( isResampling() )
+        {
+            m_resampler[0]->getInputBlock()[m_blockUsed] = left;
+            m_resampler[1]->getInputBlock()[m_blockUsed] = right;
+
+            if ( ++m_blockUsed == cBlockSamples )
+                flushBlock();
+        }
+        // no conversion needed, write directly; anything beyond the declared length is dropped
+        else if ( m_written[0] < m_outputLength )
+        {
+            m_stem.m_channel[0][m_written[0]++] = static_cast<float>( left );
+            m_stem.m_channel[1][m_written[1]++] = static_cast<float>( right );
+
+            if ( ++m_blockUsed == cBlockSamples )
+            {
+                m_blockUsed = 0;
+                publish();
+            }
+        }
+    }
+
+    inline void repeatLast()
+    {
+        push( m_lastPushed[0], m_lastPushed[1] );
+    }
+
+    // write out any partial block and, if resampling, drain the resamplers with silence until the output is full
+    void finish()
+    {
+        if ( isResampling() )
+        {
+            flushBlock();
+
+            // a couple of blocks covers the resampler's filter length many times over; bound it regardless
+            for ( int32_t drain = 0; drain < 16 && ( m_written[0] < m_outputLength || m_written[1] < m_outputLength ); drain++ )
+            {
+                std::fill_n( m_resampler[0]->getInputBlock(), cBlockSamples, 0.0 );
+                std::fill_n( m_resampler[1]->getInputBlock(), cBlockSamples, 0.0 );
+
+                m_blockUsed = cBlockSamples;
+                flushBlock();
+            }
+
+            m_resampler[0]->reset();
+            m_resampler[1]->reset();
+        }
+
+        // anything still short (which should only happen if the stream itself was) is zero-filled
+        for ( std::size_t channel = 0; channel < 2; channel++ )
+        {
+            std::fill( m_stem.m_channel[channel] + m_written[channel], m_stem.m_channel[channel] + m_outputLength, 0.0f );
+            m_written[channel] = m_outputLength;
+        }
+    }
+
+private:
+
+    void flushBlock()
+    {
+        if ( m_blockUsed == 0 )
+            return;
+
+        for ( std::size_t channel = 0; channel < 2; channel++ )
+        {
+            const double* resampled = nullptr;
+            const int32_t resampledCount = m_resampler[channel]->processBlock( m_blockUsed, resampled );
+
+            const int32_t toWrite = std::min( resampledCount, m_outputLength - m_written[channel] );
+
+            float* output = m_stem.m_channel[channel] + m_written[channel];
+            for ( int32_t s = 0; s < toWrite; s++ )
+                output[s] = static_cast<float>( resampled[s] );
+
+            m_written[channel] += toWrite;
+        }
+        m_blockUsed = 0;
+
+        publish();
+    }
+
+    void publish()
+    {
+        if ( !m_stem.m_progressiveDecode )
+            return;
+
+        // hold back the tail that loop sewing rewrites; that only becomes readable once the whole stem is done
+        const int32_t readable = std::min( { m_written[0], m_written[1], m_outputLength - cLoopSewingWindowSize } );
+        if ( readable > m_stem.m_samplesAvailable.load( std::memory_order_relaxed ) )
+        {
+            m_stem.m_samplesAvailable.store( readable, std::memory_order_release );
+            m_stem.notifyFetchProgress();
+        }
+    }
+
+
+    Stem&                                               m_stem;
+    int32_t                                             m_outputLength  = 0;
+
+    std::array< dsp::StreamResampler*, 2 >              m_resampler     = { nullptr, nullptr };
+    int32_t                                             m_blockUsed     = 0;
+    std::array< double, 2 >                             m_lastPushed    = { 0, 0 };
+    std::array< int32_t, 2 >                            m_written       = { 0, 0 };
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
+{
+    fetchAndDecode( ncfg, cachePath );
+
+    // once complete, everything is readable; on failure any partial watermark is left alone, the stem reports
+    // hasFailed() and readers will be ignoring it from here on
+    if ( m_state == State::Complete )
+        m_samplesAvailable.store( m_sampleCount, std::memory_order_release );
+
+    m_fetchFinished.store( true, std::memory_order_release );
+    notifyFetchProgress();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::waitForSamples( const int32_t samplesWanted ) const
+{
+    std::unique_lock< std::mutex > progressLock( m_fetchProgressMutex );
+    m_fetchProgressCVar.wait( progressLock, [&]()
+        {
+            if ( m_fetchFinished.load( std::memory_order_acquire ) )
+                return true;
+
+            // m_sampleCount is set before the first watermark is published, so it is safe to read once there is one
+            const int32_t samplesAvailable = getSamplesAvailable();
+            return ( samplesAvailable > 0 &&
+                     samplesWanted < m_sampleCount &&
+                     samplesAvailable >= std::min( samplesWanted, m_sampleCount - cLoopSewingWindowSize ) );
+        });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::notifyFetchProgress() const
+{
+    // taking the lock orders this after any waiter's last look at the watermark, so the wake can't slip in between
+    // that check and the waiter going to sleep
+    {
+        std::scoped_lock< std::mutex > progressLock( m_fetchProgressMutex );
+    }
+    m_fetchProgressCVar.notify_all();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::fetchAndDecode( const api::NetConfiguration& ncfg, const fs::path& cachePath )
 {
     // ensure we have a space to write the stem back out to
     const absl::Status cachePathAvailable = filesys::ensureDirectoryExists( cachePath );
@@ -274,47 +482,27 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         {
             blog::stem( FMTX( "[s:{}..] resampling ogg data from {}"), stemCouchSnip, oggSampleRate );
 
-            auto* resampleIn = mem::alloc16<double>( m_sampleCount );
+            dsp::StreamResampler& resampler = dsp::StreamResampler::acquire( static_cast<uint32_t>( oggSampleRate ), m_sampleRate );
 
-            r8b::CDSPResampler24 resampler24(
-                (double)oggSampleRate,
-                m_sampleRate,
-                m_sampleCount );
+            const int32_t outputSampleLength = resampler.getOutputLength( m_sampleCount );
 
-            const auto outputSampleLength = resampler24.getMaxOutLen( 0 );
-            double* resampleOut = mem::alloc16<double>( outputSampleLength );
-
-            // resample each channel to the chosen sample rate using r8brain
+            // resample each channel to the chosen sample rate, reading straight out of the interleaved shorts and
+            // writing straight into the final channel storage
             for ( std::size_t channel = 0; channel < 2; channel++ )
             {
-                // convert sint16 to doubles
-                for ( size_t s = 0, readIndex = channel; s < m_sampleCount; s++, readIndex += 2 )
-                {
-                    resampleIn[s] = (double)oggData[readIndex] * shortToDoubleNormalisedRcp;
-                }
+                m_channel[channel] = getSampleAllocator().allocateArray<float>( outputSampleLength );
 
-                // resample stem as one-shot, standalone task
-                resampler24.oneshot( resampleIn, m_sampleCount, resampleOut, outputSampleLength );
-
-                // allocate actual channel data storage and copy across, out of resampling buffer
-                m_channel[channel] = mem::alloc16<float>( outputSampleLength );
-                for ( size_t s = 0; s < outputSampleLength; s++ )
-                {
-                    m_channel[channel][s] = static_cast<float>(resampleOut[s]);
-                }
+                resampler.convert( oggData + channel, 2, m_sampleCount, shortToDoubleNormalisedRcp, m_channel[channel], outputSampleLength );
             }
 
-            mem::free16( resampleOut );
-            mem::free16( resampleIn );
-
             m_sampleCount = outputSampleLength;
         }
         else
         {
             // blog::stem( FMTX( "[s:{}..] stem already at {}" ), stemCouchSnip, m_sampleRate );
 
-            m_channel[0] = mem::alloc16<float>( m_sampleCount );
-            m_channel[1] = mem::alloc16<float>( m_sampleCount );
+            m_channel[0] = getSampleAllocator().allocateArray<float>( m_sampleCount );
+            m_channel[1] = getSampleAllocator().allocateArray<float>( m_sampleCount );
 
             for ( std::size_t s = 0, readIndex = 0; s < m_sampleCount; s++ )
             {
@@ -335,15 +523,14 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
 
         // create working memory buffer for the decoder
         const uint32_t flacWorkingMemorySize = fx_flac_size( FLAC_MAX_BLOCK_SIZE, FLAC_MAX_CHANNEL_COUNT );
-        void* flacWorkingMemory = mem::alloc16< uint8_t >( flacWorkingMemorySize );
+        void* flacWorkingMemory = mem::alloc16< uint8_t >( flacWorkingMemorySize, mem::Tag::Stems );
 
         // instance the decoder with the memory pool
         fx_flac_t* flac = fx_flac_init( flacWorkingMemory, FLAC_MAX_BLOCK_SIZE, FLAC_MAX_CHANNEL_COUNT );
 
-        // prep two channels to append to as we decode frames
-        std::array<double*, 2> flacStreamChannels;
-        flacStreamChannels.fill( nullptr );
-        std::size_t flacStreamChannelsWriteIndex = 0;
+        // decoded frames are streamed into the final channel buffers, resampling on the way if required
+        std::unique_ptr< DecodeWriter > decodeWriter;
+        std::size_t flacSamplesDecoded = 0;
 
         // inner loop decoder buffer, stack local
         static constexpr std::size_t flacDecoderBufferSize = 1024 * 4;
@@ -392,7 +579,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                 rawAudioLen,
                 rawAudioInBytes,
                 flacAudioOutSamples,
-                flacStreamChannelsWriteIndex );
+                flacSamplesDecoded );
 #endif // OURO_FLAC_VERBOSE
 
             switch ( flacState )
@@ -413,7 +600,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                 case FLAC_END_OF_METADATA:
                 {
                     // check we haven't already seen a metadata block, should just be the one (AFAIK)
-                    ABSL_ASSERT( flacStreamChannels[0] == nullptr );
+                    ABSL_ASSERT( decodeWriter == nullptr );
 
                     flacSampleRate      = fx_flac_get_streaminfo( flac, FLAC_KEY_SAMPLE_RATE );
                     flacChannelCount    = fx_flac_get_streaminfo( flac, FLAC_KEY_N_CHANNELS );
@@ -441,8 +628,8 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                     conversionBitShift = 32 - flacSampleSize;
 
                     // prepare storage for the decompressed frames
-                    flacStreamChannels[0] = mem::alloc16<double>( flacSampleCount );
-                    flacStreamChannels[1] = mem::alloc16<double>( flacSampleCount );
+                    if ( m_state == State::WorkEnqueued )
+                        decodeWriter = std::make_unique< DecodeWriter >( *this, static_cast<uint32_t>( flacSampleRate ), static_cast<int32_t>( flacSampleCount ) );
                     break;
                 }
 
@@ -454,7 +641,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                 case FLAC_END_OF_FRAME:
                 {
                     // check we got a metadata block first, otherwise we have nowhere to decode into
-                    if ( flacStreamChannels[0] == nullptr )
+                    if ( decodeWriter == nullptr )
                     {
                         blog::error::stem( FMTX( "[s:{}..] flac decode error - no metadata decoded before frames encountered" ), stemCouchSnip );
                         m_state = State::Failed_Decompression;
@@ -462,7 +649,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                     }
 
                     ABSL_ASSERT( (flacAudioOutSamples % 2) == 0 );
-                    for ( uint32_t sample = 0; sample < flacAudioOutSamples; sample+=2, flacStreamChannelsWriteIndex++ )
+                    for ( uint32_t sample = 0; sample < flacAudioOutSamples; sample+=2, flacSamplesDecoded++ )
                     {
                         /* Quote: Note that this data is always shifted such that it uses the
                             entire 32-bit signed integer; shift to the right to the desired
@@ -472,8 +659,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                         double sampleDoubleL = static_cast<double>( decodeBuffer[sample+0] >> conversionBitShift ) * conversionNegativeRecp;
                         double sampleDoubleR = static_cast<double>( decodeBuffer[sample+1] >> conversionBitShift ) * conversionNegativeRecp;
 
-                        flacStreamChannels[0][flacStreamChannelsWriteIndex] = sampleDoubleL;
-                        flacStreamChannels[1][flacStreamChannelsWriteIndex] = sampleDoubleR;
+                        decodeWriter->push( sampleDoubleL, sampleDoubleR );
                     }
                     break;
                 }
@@ -485,18 +671,21 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         }
 
         // toss the flac decoder instance now we're done with it
-        mem::free16( flacWorkingMemory );
+        mem::free16( flacWorkingMemory, mem::Tag::Stems );
 
         // check if we emerged from the loop with errors
         if ( m_state != State::WorkEnqueued )
         {
-            // clean up the channel buffers before leaving
-            mem::free16( flacStreamChannels[0] );
-            mem::free16( flacStreamChannels[1] );
-
             blog::error::stem( FMTX( "[s:{}..] stem discarded, flac decompression error" ), stemCouchSnip );
             return;
         }
+        // .. or without ever finding anything to decode
+        if ( decodeWriter == nullptr )
+        {
+            blog::error::stem( FMTX( "[s:{}..] stem discarded, no flac metadata found" ), stemCouchSnip );
+            m_state = State::Failed_Decompression;
+            return;
+        }
 
         // we should expect (AFAIK) to have eaten the entire incoming audio stream and produces the 
         // same number of samples as the metadata specified
@@ -507,28 +696,27 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         // with a tiny number of samples missing (in the specific example, just 2 samples). The final frame is a FLAC_SEARCH_FRAME
         // rather than FLAC_END_OF_FRAME. I'm not sure why that happens; to try and support these final quirks, we allow a tiny amount of
         // drift here (but also log it out as an error)
-        ABSL_ASSERT( flacStreamChannelsWriteIndex <= flacSampleCount );
-        if ( flacStreamChannelsWriteIndex != flacSampleCount )
+        ABSL_ASSERT( flacSamplesDecoded <= flacSampleCount );
+        if ( flacSamplesDecoded != flacSampleCount )
         {
-            blog::error::stem( FMTX( "[s:{}..] FLAC decompression sample mismatch ( written {} != declared {} )" ), stemCouchSnip, flacStreamChannelsWriteIndex, flacSampleCount );
+            blog::error::stem( FMTX( "[s:{}..] FLAC decompression sample mismatch ( written {} != declared {} )" ), stemCouchSnip, flacSamplesDecoded, flacSampleCount );
         }
 
         // go backfill those missing samples, just copy them from the last one we got
-        if ( flacStreamChannelsWriteIndex > 1 && flacStreamChannelsWriteIndex < flacSampleCount )
+        if ( flacSamplesDecoded > 1 && flacSamplesDecoded < flacSampleCount )
         {
             // allow a maximum number of missing samples
-            const std::size_t missingSamples = flacSampleCount - flacStreamChannelsWriteIndex;
+            const std::size_t missingSamples = flacSampleCount - flacSamplesDecoded;
             if ( missingSamples < 4 )
             {
                 blog::error::stem( FMTX( "[s:{}..] FLAC fixing {} missing samples" ), stemCouchSnip, missingSamples );
 
                 // .. and 'fix' by just copying the last valid one we have over the gaps to avoid a click
-                for ( std::size_t hackSample = flacStreamChannelsWriteIndex; hackSample < flacSampleCount; hackSample++ )
+                for ( std::size_t hackSample = flacSamplesDecoded; hackSample < flacSampleCount; hackSample++ )
                 {
-                    flacStreamChannels[0][hackSample] = flacStreamChannels[0][flacStreamChannelsWriteIndex - 1];
-                    flacStreamChannels[1][hackSample] = flacStreamChannels[1][flacStreamChannelsWriteIndex - 1];
+                    decodeWriter->repeatLast();
                 }
-                flacStreamChannelsWriteIndex = flacSampleCount;
+                flacSamplesDecoded = flacSampleCount;
             }
             else
             {
@@ -536,58 +724,13 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                 return;
             }
         }
-        m_sampleCount = static_cast<int32_t>( flacSampleCount );
-
-        // similar to OGG, handle sample rate conversion as we create the final data buffers
-        if ( flacSampleRate != m_sampleRate )
-        {
-            blog::stem( FMTX( "[s:{}..] resampling flac from {}" ), stemCouchSnip, flacSampleRate );
-
-            r8b::CDSPResampler24 resampler24(
-                (double)flacSampleRate,
-                m_sampleRate,
-                m_sampleCount );
-
-            const auto outputSampleLength = resampler24.getMaxOutLen( 0 );
-            double* resampleOut = mem::alloc16<double>( outputSampleLength );
-
-            // resample each channel to the chosen sample rate using r8brain
-            for ( std::size_t channel = 0; channel < 2; channel++ )
-            {
-                // resample stem as one-shot, standalone task
-                resampler24.oneshot( flacStreamChannels[channel], m_sampleCount, resampleOut, outputSampleLength);
-
-                // allocate actual channel data storage and copy across, out of resampling buffer
-                m_channel[channel] = mem::alloc16<float>( outputSampleLength );
-                for ( std::size_t s = 0; s < outputSampleLength; s++ )
-                {
-                    m_channel[channel][s] = static_cast<float>(resampleOut[s]);
-                }
-            }
-
-            mem::free16( resampleOut );
-
-            m_sampleCount = outputSampleLength;
-        }
-        // if the sample rate already matches, just copy across verbatim
-        else
-        {
-            // blog::stem( FMTX( "[s:{}..] stem already at {}" ), stemCouchSnip, m_sampleRate );
 
-            m_channel[0] = mem::alloc16<float>( m_sampleCount );
-            m_channel[1] = mem::alloc16<float>( m_sampleCount );
-
-            for ( std::size_t channel = 0; channel < 2; channel++ )
-            {
-                for ( std::size_t s = 0; s < m_sampleCount; s++ )
-                {
-                    m_channel[channel][s] = static_cast<float>(flacStreamChannels[channel][s]);
-                }
-            }
-        }
+        // the channel buffers are filled up to here, the writer just needs to complete the tail
+        if ( decodeWriter->isResampling() )
+            blog::stem( FMTX( "[s:{}..] resampled flac from {}" ), stemCouchSnip, flacSampleRate );
 
-        mem::free16( flacStreamChannels[0] );
-        mem::free16( flacStreamChannels[1] );
+        decodeWriter->finish();
+        decodeWriter.reset();
 
         m_compressionFormat = Compression::FLAC;
 
@@ -601,6 +744,9 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
     // immediate post-processing steps that modify samples
     applyLoopSewingBlend();
 
+    // .. and then possibly pack them down to save memory
+    applySampleStorage();
+
     m_state = State::Complete;
 
     // report on our hard work
@@ -645,16 +791,16 @@ bool Stem::attemptRemoteFetch( const api::NetConfiguration& ncfg, const uint32_t
     if ( precheckError != httplib::Error::Success )
     {
         blog::error::stem( "HEAD [{}] client failure with error : {}", slashedKey, endlesss::api::getHttpLibErrorString(precheckError) );
-        m_state = State::Failed_Http;
         m_stateHttpStatus = precheckResult->status;
+        m_state = State::Failed_Http;
         return false;
     }
 
     if ( precheckResult->status != 200 )
     {
         blog::error::stem( "HEAD [{}] response [{}]", slashedKey, precheckResult->status );
-        m_state = State::Failed_Http;
         m_stateHttpStatus = precheckResult->status;
+        m_state = State::Failed_Http;
         return false;
     }
 
@@ -733,8 +879,8 @@ bool Stem::attemptRemoteFetch( const api::NetConfiguration& ncfg, const uint32_t
     if ( res->status != 200 )
     {
         blog::error::stem( "fetch ogg failed [{}{}] | {}", httpUrl, slashedKey, res->status );
-        m_state = State::Failed_Http;
         m_stateHttpStatus = res->status;
+        m_state = State::Failed_Http;
         return false;
     }
 
@@ -748,7 +894,7 @@ bool Stem::attemptRemoteFetch( const api::NetConfiguration& ncfg, const uint32_t
 //
 void Stem::applyLoopSewingBlend()
 {
-    static constexpr int32_t xfadeWindowSize = 128;
+    static constexpr int32_t xfadeWindowSize = cLoopSewingWindowSize;
     static constexpr double xfadeWindowSizeRecp = 1.0 / (double)xfadeWindowSize;
 
     // 1..0 constant-power blend over the window size
@@ -790,6 +936,131 @@ void Stem::applyLoopSewingBlend()
     }
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::applySampleStorage()
+{
+    if ( m_sampleStorageRequested == SampleStorage::Float32 || m_sampleCount <= 0 )
+        return;
+
+    // only ever run from fetch, before the watermark is published; compact storage never decodes progressively,
+    // so nothing can be reading m_channel while it is swapped out
+    ABSL_ASSERT( !m_progressiveDecode );
+    ABSL_ASSERT( getSamplesAvailable() == 0 );
+
+    // build both channels in the new format before any of it replaces the float data, so the stem is never left
+    // half converted
+    std::array<int16_t*, 2> channelInt16{ nullptr, nullptr };
+    std::array<int8_t*, 2>  channelMantissa{ nullptr, nullptr };
+    std::array<float*, 2>   channelBlockScale{ nullptr, nullptr };
+
+    // decoded stems can run past +/-1.0, so 16-bit storage is scaled to the peak of the stem rather than clipping it;
+    // bfp8 picks its own scale per block
+    float int16FullScale = 1.0f;
+    if ( m_sampleStorageRequested == SampleStorage::Int16 )
+    {
+        int16FullScale = buffer::int16_full_scale_for( std::max(
+            buffer::peak_magnitude( m_sampleCount, m_channel[0] ),
+            buffer::peak_magnitude( m_sampleCount, m_channel[1] ) ) );
+    }
+
+    for ( auto channel = 0; channel < 2; channel++ )
+    {
+        switch ( m_sampleStorageRequested )
+        {
+            case SampleStorage::Int16:
+            {
+                channelInt16[channel] = getSampleAllocator().allocateArray<int16_t>( m_sampleCount );
+                buffer::quantise_float_to_int16( m_sampleCount, m_channel[channel], int16FullScale, channelInt16[channel] );
+            }
+            break;
+
+            case SampleStorage::BlockFloat8:
+            {
+                channelMantissa[channel]   = getSampleAllocator().allocateArray<int8_t>( m_sampleCount );
+                channelBlockScale[channel] = mem::alloc16<float>( buffer::bfp8_block_count( m_sampleCount ), mem::Tag::Stems );
+                buffer::quantise_float_to_bfp8( m_sampleCount, m_channel[channel], channelMantissa[channel], channelBlockScale[channel] );
+            }
+            break;
+
+            default:
+                ABSL_ASSERT( false );
+                return;
+        }
+    }
+
+    // publish the complete set, then release the float data
+    m_channelInt16      = channelInt16;
+    m_int16FullScale    = int16FullScale;
+    m_channelMantissa   = channelMantissa;
+    m_channelBlockScale = channelBlockScale;
+    m_sampleStorage     = m_sampleStorageRequested;
+
+    for ( auto channel = 0; channel < 2; channel++ )
+    {
+        getSampleAllocator().free( m_channel[channel] );
+        m_channel[channel] = nullptr;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t Stem::getSampleStorageBytes() const
+{
+    const std::size_t channelSamples = static_cast<std::size_t>( m_sampleCount ) * 2;
+
+    switch ( m_sampleStorage )
+    {
+        case SampleStorage::Int16:
+            return channelSamples * sizeof( int16_t );
+
+        case SampleStorage::BlockFloat8:
+            return ( channelSamples * sizeof( int8_t ) ) +
+                   ( static_cast<std::size_t>( buffer::bfp8_block_count( m_sampleCount ) ) * 2 * sizeof( float ) );
+
+        default:
+        case SampleStorage::Float32:
+            return channelSamples * sizeof( float );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+float Stem::getSample( const int32_t channel, const int32_t sampleIndex ) const
+{
+    switch ( m_sampleStorage )
+    {
+        case SampleStorage::Int16:
+            return (float)m_channelInt16[channel][sampleIndex] * ( m_int16FullScale * buffer::int16_to_float_scale );
+
+        case SampleStorage::BlockFloat8:
+            return (float)m_channelMantissa[channel][sampleIndex] * m_channelBlockScale[channel][sampleIndex >> buffer::bfp8_block_shift];
+
+        default:
+        case SampleStorage::Float32:
+            return m_channel[channel][sampleIndex];
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::readSamples( const int32_t channel, const int32_t sampleStart, const int32_t sampleCount, float* output ) const
+{
+    ABSL_ASSERT( sampleStart >= 0 && sampleStart + sampleCount <= m_sampleCount );
+
+    switch ( m_sampleStorage )
+    {
+        case SampleStorage::Int16:
+            buffer::expand_int16_to_float( sampleStart, sampleCount, m_channelInt16[channel], m_int16FullScale, output );
+            break;
+
+        case SampleStorage::BlockFloat8:
+            buffer::expand_bfp8_to_float( sampleStart, sampleCount, m_channelMantissa[channel], m_channelBlockScale[channel], output );
+            break;
+
+        default:
+        case SampleStorage::Float32:
+            std::copy_n( m_channel[channel] + sampleStart, sampleCount, output );
+            break;
+    }
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool Stem::analyse( const Processing& processing, StemAnalysisData& result ) const
 {
@@ -803,6 +1074,19 @@ bool Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
         return false;
     }
 
+    // analysis wants the full float signal; compact stems are expanded into temporary buffers for the duration
+    std::array< const float*, 2 > channelData{ m_channel[0], m_channel[1] };
+    std::array< float*, 2 >       channelExpanded{ nullptr, nullptr };
+    if ( isCompact() )
+    {
+        for ( auto channel = 0; channel < 2; channel++ )
+        {
+            channelExpanded[channel] = mem::alloc16<float>( m_sampleCount, mem::Tag::Stems );
+            readSamples( channel, 0, m_sampleCount, channelExpanded[channel] );
+            channelData[channel] = channelExpanded[channel];
+        }
+    }
+
     // default spectrum data for normalising freq data; we could load this from disk potentially
     const config::Spectrum audioSpectrumConfig;
 
@@ -810,12 +1094,12 @@ bool Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
     const int32_t fftTimeSlices = m_sampleCount / fftWindowSize;
 
     // fft output working buffers
-    complexf* fftOutputL  = mem::alloc16<complexf>( fftWindowSize );
-    complexf* fftOutputR  = mem::alloc16<complexf>( fftWindowSize );
+    complexf* fftOutputL  = mem::alloc16<complexf>( fftWindowSize, mem::Tag::Stems );
+    complexf* fftOutputR  = mem::alloc16<complexf>( fftWindowSize, mem::Tag::Stems );
 
     // transient frequency band buffers that then get smoothed afterwards
-    auto* fftOutLowBand   = mem::alloc16<float>( fftTimeSlices );
-    auto* fftOutHighBand  = mem::alloc16<float>( fftTimeSlices );
+    auto* fftOutLowBand   = mem::alloc16<float>( fftTimeSlices, mem::Tag::Stems );
+    auto* fftOutHighBand  = mem::alloc16<float>( fftTimeSlices, mem::Tag::Stems );
 
 
     // prepare the analysis output
@@ -827,8 +1111,8 @@ bool Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
         for ( int64_t sI = 0, fftBandLimit = 0; sI <= m_sampleCount - fftWindowSize; sI += fftWindowSize, fftBandLimit++ )
         {
             // perform FFT on each stereo channel
-            pffft_transform_ordered( processing.m_pffftPlan, &(m_channel[0][sI]), reinterpret_cast<float*>(fftOutputL), nullptr, PFFFT_FORWARD );
-            pffft_transform_ordered( processing.m_pffftPlan, &(m_channel[1][sI]), reinterpret_cast<float*>(fftOutputR), nullptr, PFFFT_FORWARD );
+            pffft_transform_ordered( processing.m_pffftPlan, &(channelData[0][sI]), reinterpret_cast<float*>(fftOutputL), nullptr, PFFFT_FORWARD );
+            pffft_transform_ordered( processing.m_pffftPlan, &(channelData[1][sI]), reinterpret_cast<float*>(fftOutputR), nullptr, PFFFT_FORWARD );
 
             std::array< float, 3 > frequencyBuckets;
             frequencyBuckets.fill( 0 );
@@ -859,8 +1143,8 @@ bool Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
         }
     }
 
-    mem::free16( fftOutputR );
-    mem::free16( fftOutputL );
+    mem::free16( fftOutputR, mem::Tag::Stems );
+    mem::free16( fftOutputL, mem::Tag::Stems );
 
     const cycfi::q::duration beatFollowDuration( processing.m_tuning.m_beatFollowDuration );
     const cycfi::q::duration waveFollowDuration( processing.m_tuning.m_waveFollowDuration );
@@ -906,7 +1190,7 @@ bool Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
                 }
 
                 // don't imagine max() here is terribly scientific
-                const float signalInput     = std::max( m_channel[0][sI], m_channel[1][sI] );
+                const float signalInput     = std::max( channelData[0][sI], channelData[1][sI] );
                 const float signalFollow    = waveFollower( signalInput );
                 const float signalFollowLF  = waveFollowerLF( fftOutLowBand[fftBandIndex] );
                 const float signalFollowHF  = waveFollowerHF( fftOutHighBand[fftBandIndex] );
@@ -939,8 +1223,11 @@ bool Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
 
     #undef PSA_ENCODE
 
-    mem::free16( fftOutHighBand );
-    mem::free16( fftOutLowBand );
+    mem::free16( fftOutHighBand, mem::Tag::Stems );
+    mem::free16( fftOutLowBand, mem::Tag::Stems );
+
+    mem::free16( channelExpanded[1], mem::Tag::Stems );
+    mem::free16( channelExpanded[0], mem::Tag::Stems );
 
     return true;
 }
@@ -966,7 +1253,7 @@ Stem::RawAudioMemory::RawAudioMemory( size_t size )
 // ---------------------------------------------------------------------------------------------------------------------
 Stem::RawAudioMemory::~RawAudioMemory()
 {
-    mem::free16( m_rawAudio );
+    mem::free16( m_rawAudio, mem::Tag::Stems );
     m_rawAudio      = nullptr;
     m_rawReceived   = 0;
 }
@@ -977,10 +1264,10 @@ void Stem::RawAudioMemory::allocate( size_t newSize )
     ABSL_ASSERT( m_rawReceived == 0 );
 
     if ( m_rawAudio == nullptr )
-        mem::free16( m_rawAudio );
+        mem::free16( m_rawAudio, mem::Tag::Stems );
 
     m_rawLength = newSize;
-    m_rawAudio = mem::alloc16To< uint8_t >( m_rawLength + 4, 0 );   // +4 supports header read check in worst case of empty buf
+    m_rawAudio = mem::alloc16To< uint8_t >( m_rawLength + 4, 0, mem::Tag::Stems );   // +4 supports header read check in worst case of empty buf
 }
 
 } // namespace live
@@ -16,6 +16,8 @@
 
 struct PFFFT_Setup;
 
+namespace sys { class SlabAllocator; }
+
 namespace config { namespace endlesss { struct rAPI; } }
 
 namespace endlesss {
@@ -124,6 +126,15 @@ struct Stem
         Failed_CacheDirectory,      // failed to create or interact with the stem cache
     };
 
+    // how decoded audio is held in memory once a fetch completes; the compact modes trade a little decode work in
+    // the mixer for a much smaller resident footprint. values match config::Performance::stemStorageMode
+    enum class SampleStorage : int32_t
+    {
+        Float32,                    // full precision, 4 bytes per sample per channel
+        Int16,                      // 16-bit PCM scaled to the stem's peak, 2 bytes per sample per channel
+        BlockFloat8,                // int8 mantissas sharing a float scale per 32 samples, ~1.125 bytes per sample per channel
+    };
+
     enum class AnalysisState
     {
         InProgress,                 // data is being processed in the background
@@ -162,8 +173,13 @@ struct Stem
 
     static Processing::UPtr createStemProcessing( const uint32_t targetSampleRate );
 
+    // all stem sample buffers are taken from this dedicated allocator rather than the general heap; see sys/slab.h
+    static sys::SlabAllocator& getSampleAllocator();
+
 
-    Stem( const types::Stem& stemData, const uint32_t targetSampleRate );
+    // progressiveDecode lets the stem be played while it is still decoding; see getSamplesAvailable(). it is only
+    // honoured for Float32 storage, as the compact formats are produced from the complete buffer
+    Stem( const types::Stem& stemData, const uint32_t targetSampleRate, const SampleStorage sampleStorage = SampleStorage::Float32, const bool progressiveDecode = false );
     ~Stem();
 
 
@@ -171,6 +187,23 @@ struct Stem
     // note this is a blocking call and is designed to be called from a background thread in most cases
     void fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath );
 
+    // how many samples from the start of the stem are decoded and safe to read; this only reaches m_sampleCount once
+    // the fetch is complete. with progressive decoding it climbs while the stem may already be playing, so readers
+    // must treat anything beyond it as silence
+    ouro_nodiscard int32_t getSamplesAvailable() const { return m_samplesAvailable.load( std::memory_order_acquire ); }
+
+    // block until at least (samplesWanted) samples are available - clamped to the stem length - or the fetch has
+    // finished, successfully or otherwise
+    void waitForSamples( const int32_t samplesWanted ) const;
+
+    // block until the fetch has finished, successfully or otherwise
+    void waitForFetch() const { waitForSamples( std::numeric_limits<int32_t>::max() ); }
+
+    // true once fetch() has returned, successfully or otherwise
+    ouro_nodiscard bool isFetchFinished() const { return m_fetchFinished.load( std::memory_order_acquire ); }
+
+    ouro_nodiscard constexpr bool isProgressiveDecode() const { return m_progressiveDecode; }
+
     // run analysis pass, producing things like onsets / peak-following / etc into the given result;
     // this result is passed as an argument so that we can also run this in debug tools to tune the processing
     bool analyse( const Processing& processing, StemAnalysisData& result ) const;
@@ -185,17 +218,19 @@ struct Stem
         m_analysisFuture = analysisFuture;
     }
 
-    ouro_nodiscard constexpr bool hasFailed() const
+    // safe from any thread, including the mixers while a progressive decode is running
+    ouro_nodiscard bool hasFailed() const
     {
-        return ( m_state == State::Failed_Http           ||
-                 m_state == State::Failed_DataUnderflow  ||
-                 m_state == State::Failed_DataOverflow   ||
-                 m_state == State::Failed_Decompression  ||
-                 m_state == State::Failed_CacheDirectory );
+        const State state = m_state.load( std::memory_order_acquire );
+        return ( state == State::Failed_Http           ||
+                 state == State::Failed_DataUnderflow  ||
+                 state == State::Failed_DataOverflow   ||
+                 state == State::Failed_Decompression  ||
+                 state == State::Failed_CacheDirectory );
     }
 
     // NB this value will be 0 in all cases where we have no useful http status to cache, only useful if the state is Failed_Http
-    ouro_nodiscard constexpr uint32_t httpFailureStatus() const
+    ouro_nodiscard uint32_t httpFailureStatus() const
     {
         return m_stateHttpStatus;
     }
@@ -213,7 +248,7 @@ struct Stem
             return result;
 
         // buffer data
-        result += ( static_cast<std::size_t>(m_sampleCount) * 2 ) * sizeof( float );
+        result += getSampleStorageBytes();
 
         // add analysis chunk if it is ready
         if ( getAnalysisState() == AnalysisState::AnalysisValid )
@@ -223,6 +258,22 @@ struct Stem
         return result;
     }
 
+    ouro_nodiscard constexpr SampleStorage getSampleStorage() const { return m_sampleStorage; }
+
+    // true if samples are held in one of the compact formats, in which case m_channel is empty and audio must be
+    // fetched through getSample() / readSamples()
+    ouro_nodiscard constexpr bool isCompact() const { return m_sampleStorage != SampleStorage::Float32; }
+
+    // bytes of sample data held for both channels in the current storage format
+    ouro_nodiscard std::size_t getSampleStorageBytes() const;
+
+    // single sample lookup, valid for any storage format; prefer readSamples() for anything more than a handful
+    ouro_nodiscard float getSample( const int32_t channel, const int32_t sampleIndex ) const;
+
+    // expand [sampleStart, sampleStart + sampleCount) of one channel into (output) as float, decoding from compact
+    // storage if required. the span must lie within the stem
+    void readSamples( const int32_t channel, const int32_t sampleStart, const int32_t sampleCount, float* output ) const;
+
     ouro_nodiscard inline AnalysisState getAnalysisState() const
     {
         return m_analysisState;
@@ -251,10 +302,24 @@ private:
     // returns false if something broke; sets the m_state appropriately in that case
     ouro_nodiscard bool attemptRemoteFetch( const api::NetConfiguration& ncfg, const uint32_t attemptUID, RawAudioMemory& audioMemory );
 
+    // the body of fetch(); returns having set m_state, fetch() then publishes the final sample watermark
+    void fetchAndDecode( const api::NetConfiguration& ncfg, const fs::path& cachePath );
+
+    // decode + resample the FLAC stream straight into preallocated m_channel buffers, publishing the watermark as it
+    // goes if decoding progressively
+    struct DecodeWriter;
+
     // blend a small window of samples at each end of the stem to reduce clicks on looping
     // (as best we can tell Endlesss also does something like this)
     void applyLoopSewingBlend();
 
+    // once decoding is complete, convert m_channel to the chosen compact format and release the float data; runs
+    // inside fetch() before any samples are published, so the stem is not yet visible to readers
+    void applySampleStorage();
+
+    // wake anything blocked in waitForSamples(); call after moving the watermark or finishing the fetch
+    void notifyFetchProgress() const;
+
 
 
     std::shared_future<void>        m_analysisFuture;
@@ -262,16 +327,29 @@ private:
 
     Compression                     m_compressionFormat = Compression::Unknown;
 
+    SampleStorage                   m_sampleStorageRequested;                   // chosen at construction, applied after decode
+    bool                            m_progressiveDecode;                        // publish samples as they decode, see getSamplesAvailable()
+
+    std::atomic_int32_t             m_samplesAvailable  = 0;                    // watermark of readable samples
+    std::atomic_bool                m_fetchFinished     = false;                // set once fetch() returns, whatever the outcome
+    mutable std::mutex              m_fetchProgressMutex;                       // waitForSamples() sleeps on this until
+    mutable std::condition_variable m_fetchProgressCVar;                        // .. either of the above moves
+    SampleStorage                   m_sampleStorage = SampleStorage::Float32;   // what m_channel* currently holds
+    std::array<int16_t*, 2>         m_channelInt16;         // SampleStorage::Int16
+    float                           m_int16FullScale = 1.0f;  // .. the value +/-32767 stands for; above 1.0 for over-range stems
+    std::array<int8_t*, 2>          m_channelMantissa;      // SampleStorage::BlockFloat8
+    std::array<float*, 2>           m_channelBlockScale;    // .. one per buffer::bfp8_block_size samples
+
     // #TODO move into accessors
 public:
     const types::Stem               m_data;
     ImU32                           m_colourU32;            // converted from m_data and cached
-    State                           m_state;
-    uint32_t                        m_stateHttpStatus = 0;  // saves the HTTP status if m_state is Failed_Http and it makes any sense to save it; 0 otherwise
+    std::atomic< State >            m_state;                // written by the fetching thread, read from anywhere
+    uint32_t                        m_stateHttpStatus = 0;  // saves the HTTP status if m_state is Failed_Http and it makes any sense to save it; 0 otherwise; set before m_state
 
     uint32_t                        m_sampleRate;
     int32_t                         m_sampleCount;
-    std::array<float*, 2>           m_channel;
+    std::array<float*, 2>           m_channel;              // only valid for SampleStorage::Float32, see isCompact()
 
 private:
     StemAnalysisData                m_analysisData;
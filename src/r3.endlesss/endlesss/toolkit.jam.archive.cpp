@@ -0,0 +1,918 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+//
+
+#include "pch.h"
+
+#include "base/fio.h"
+
+#include "endlesss/toolkit.jam.archive.h"
+
+#include "zstd.h"
+
+namespace endlesss {
+namespace toolkit {
+namespace archive {
+
+// column data is written as raw little-endian arrays
+static_assert( std::endian::native == std::endian::little );
+
+namespace {
+
+constexpr uint32_t makeFourCC( const char( &code )[5] )
+{
+    return  static_cast<uint32_t>( code[0] )         |
+           ( static_cast<uint32_t>( code[1] ) << 8 )  |
+           ( static_cast<uint32_t>( code[2] ) << 16 ) |
+           ( static_cast<uint32_t>( code[3] ) << 24 );
+}
+
+static constexpr uint32_t cFileMagic        = makeFourCC( "ORXJ" );
+
+static constexpr uint32_t cBlockMeta        = makeFourCC( "META" );
+static constexpr uint32_t cBlockStrings     = makeFourCC( "STRS" );
+static constexpr uint32_t cBlockRiffs       = makeFourCC( "RIFF" );
+static constexpr uint32_t cBlockStems       = makeFourCC( "STEM" );
+static constexpr uint32_t cBlockEnd         = makeFourCC( "END." );
+
+// reject anything claiming to be bigger than this; a full block of stems is a few hundred KB at most
+static constexpr uint32_t cMaximumBlockSize = 64 * 1024 * 1024;
+
+enum class BlockCodec : uint32_t
+{
+    Raw             = 0,
+    Zstd            = 1,
+    ZstdDictionary  = 2,
+};
+
+struct FileHeader
+{
+    uint32_t    m_magic;
+    uint32_t    m_version;
+    uint32_t    m_dictionaryID;
+    uint32_t    m_reserved;
+};
+static_assert( sizeof( FileHeader ) == 16 );
+
+struct BlockHeader
+{
+    uint32_t    m_blockType;
+    uint32_t    m_rowCount;
+    uint32_t    m_rawSize;
+    uint32_t    m_storedSize;
+    uint64_t    m_checksum;         // see blockChecksum()
+    BlockCodec  m_codec;
+    uint32_t    m_reserved;
+};
+static_assert( sizeof( BlockHeader ) == 32 );
+
+// komihash of the raw payload seeded with the block type; from v3 the seed is instead a hash of the rest of the block
+// header, so a flipped row count or size is caught here rather than left for the column decode to trip over
+uint64_t blockChecksum( const BlockHeader& blockHeader, const std::vector< uint8_t >& payload, const uint32_t formatVersion )
+{
+    uint64_t seed = blockHeader.m_blockType;
+    if ( formatVersion >= 3 )
+    {
+        BlockHeader hashedHeader = blockHeader;
+        hashedHeader.m_checksum = 0;
+
+        seed = komihash( &hashedHeader, sizeof( hashedHeader ), blockHeader.m_blockType );
+    }
+    return komihash( payload.data(), payload.size(), seed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// append-only byte sink used to build block payloads
+struct PayloadWriter
+{
+    PayloadWriter( std::vector< uint8_t >& buffer )
+        : m_buffer( buffer )
+    {
+        m_buffer.clear();
+    }
+
+    template< typename T >
+    void value( const T& v )
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        bytes( &v, sizeof( T ) );
+    }
+
+    template< typename T >
+    void column( const std::vector< T >& values )
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        bytes( values.data(), values.size() * sizeof( T ) );
+    }
+
+    void string( const std::string_view text )
+    {
+        value( static_cast<uint32_t>( text.size() ) );
+        bytes( text.data(), text.size() );
+    }
+
+    void bytes( const void* data, const std::size_t size )
+    {
+        const auto* dataBytes = static_cast<const uint8_t*>( data );
+        m_buffer.insert( m_buffer.end(), dataBytes, dataBytes + size );
+    }
+
+    std::vector< uint8_t >& m_buffer;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// bounds-checked reader over a decoded block payload; any overrun latches m_failed and returns zeroed data
+struct PayloadReader
+{
+    PayloadReader( const std::vector< uint8_t >& buffer )
+        : m_buffer( buffer )
+    {}
+
+    template< typename T >
+    T value()
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        T result{};
+        bytes( &result, sizeof( T ) );
+        return result;
+    }
+
+    // (count) comes from the block header, so it is checked against what is left before anything is allocated
+    template< typename T >
+    void column( std::vector< T >& values, const std::size_t count )
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        if ( m_failed || count > remaining() / sizeof( T ) )
+        {
+            m_failed = true;
+            values.clear();
+            return;
+        }
+        values.resize( count );
+        bytes( values.data(), count * sizeof( T ) );
+    }
+
+    std::string_view string()
+    {
+        const auto length = value<uint32_t>();
+        if ( m_failed || m_offset + length > m_buffer.size() )
+        {
+            m_failed = true;
+            return {};
+        }
+        const std::string_view result( reinterpret_cast<const char*>( m_buffer.data() + m_offset ), length );
+        m_offset += length;
+        return result;
+    }
+
+    void bytes( void* data, const std::size_t size )
+    {
+        if ( m_failed || m_offset + size > m_buffer.size() )
+        {
+            m_failed = true;
+            std::memset( data, 0, size );
+            return;
+        }
+        std::memcpy( data, m_buffer.data() + m_offset, size );
+        m_offset += size;
+    }
+
+    ouro_nodiscard std::size_t remaining() const { return m_failed ? 0 : ( m_buffer.size() - m_offset ); }
+    ouro_nodiscard bool isComplete() const { return !m_failed && m_offset == m_buffer.size(); }
+
+    const std::vector< uint8_t >&   m_buffer;
+    std::size_t                     m_offset = 0;
+    bool                            m_failed = false;
+};
+
+} // anonymous namespace
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// column layouts for riff and stem blocks; visitColumns() defines the on-disk column order for a given format version
+// and is shared by both the writer and reader so the two can't drift apart
+struct RiffColumns
+{
+    std::vector< uint32_t >                 m_couchID;
+    std::vector< uint32_t >                 m_user;
+    std::vector< uint64_t >                 m_creationTime;
+    std::vector< uint8_t >                  m_root;
+    std::vector< uint8_t >                  m_scale;
+    std::vector< float >                    m_BPS;
+    std::vector< float >                    m_BPMrnd;
+    std::vector< float >                    m_barLength;
+    std::vector< uint32_t >                 m_appVersion;
+    std::vector< float >                    m_magnitude;
+    std::array< std::vector< uint32_t >, 8 > m_stems;       // interned stem couch IDs, 0 if the slot is empty
+    std::array< std::vector< float >, 8 >   m_gains;
+    std::vector< uint8_t >                  m_stemsOn;      // one bit per slot; v2+, v1 archives imply it from m_stems
+
+    template< typename TColumns, typename TVisitor >
+    static void visitColumns( TColumns& columns, const uint32_t formatVersion, TVisitor&& visitor )
+    {
+        visitor( columns.m_couchID );
+        visitor( columns.m_user );
+        visitor( columns.m_creationTime );
+        visitor( columns.m_root );
+        visitor( columns.m_scale );
+        visitor( columns.m_BPS );
+        visitor( columns.m_BPMrnd );
+        visitor( columns.m_barLength );
+        visitor( columns.m_appVersion );
+        visitor( columns.m_magnitude );
+        for ( auto& stemColumn : columns.m_stems )
+            visitor( stemColumn );
+        for ( auto& gainColumn : columns.m_gains )
+            visitor( gainColumn );
+        if ( formatVersion >= 2 )
+            visitor( columns.m_stemsOn );
+    }
+
+    ouro_nodiscard std::size_t size() const { return m_couchID.size(); }
+
+    void clear()
+    {
+        visitColumns( *this, cFormatVersion, []( auto& column ) { column.clear(); } );
+    }
+};
+
+struct StemColumns
+{
+    std::vector< uint32_t >                 m_couchID;
+    std::vector< uint32_t >                 m_fileEndpoint;
+    std::vector< uint32_t >                 m_fileBucket;
+    std::vector< uint32_t >                 m_fileKey;
+    std::vector< uint32_t >                 m_fileMIME;
+    std::vector< uint32_t >                 m_preset;
+    std::vector< uint32_t >                 m_user;
+    std::vector< uint32_t >                 m_colour;
+    std::vector< uint32_t >                 m_fileLengthBytes;
+    std::vector< uint32_t >                 m_sampleRate;
+    std::vector< uint64_t >                 m_creationTime;
+    std::vector< float >                    m_BPS;
+    std::vector< float >                    m_BPMrnd;
+    std::vector< float >                    m_length16s;
+    std::vector< float >                    m_originalPitch;
+    std::vector< float >                    m_barLength;
+    std::vector< uint8_t >                  m_instrument;   // same bitmask as the warehouse Instrument column
+
+    template< typename TColumns, typename TVisitor >
+    static void visitColumns( TColumns& columns, TVisitor&& visitor )
+    {
+        visitor( columns.m_couchID );
+        visitor( columns.m_fileEndpoint );
+        visitor( columns.m_fileBucket );
+        visitor( columns.m_fileKey );
+        visitor( columns.m_fileMIME );
+        visitor( columns.m_preset );
+        visitor( columns.m_user );
+        visitor( columns.m_colour );
+        visitor( columns.m_fileLengthBytes );
+        visitor( columns.m_sampleRate );
+        visitor( columns.m_creationTime );
+        visitor( columns.m_BPS );
+        visitor( columns.m_BPMrnd );
+        visitor( columns.m_length16s );
+        visitor( columns.m_originalPitch );
+        visitor( columns.m_barLength );
+        visitor( columns.m_instrument );
+    }
+
+    ouro_nodiscard std::size_t size() const { return m_couchID.size(); }
+
+    void clear()
+    {
+        visitColumns( *this, []( auto& column ) { column.clear(); } );
+    }
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+CompressionDictionary::~CompressionDictionary()
+{
+    ZSTD_freeCDict( m_compressionDict );
+    m_compressionDict = nullptr;
+
+    ZSTD_freeDDict( m_decompressionDict );
+    m_decompressionDict = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status CompressionDictionary::load( const fs::path& dictionaryFile, const int32_t compressionLevel )
+{
+    absl::StatusOr< base::TBinaryFileBuffer > dictionaryData = base::readBinaryFile( dictionaryFile );
+    if ( !dictionaryData.ok() )
+        return dictionaryData.status();
+
+    const auto* dictionaryBytes = std::data( dictionaryData.value() );
+    const auto  dictionarySize  = std::size( dictionaryData.value() );
+
+    // raw content dictionaries have no ID and can't be validated on import, so insist on a trained one
+    const uint32_t dictionaryID = ZSTD_getDictID_fromDict( dictionaryBytes, dictionarySize );
+    if ( dictionaryID == 0 )
+        return absl::InvalidArgumentError( fmt::format( FMTX( "[{}] is not a trained zstd dictionary" ), dictionaryFile.string() ) );
+
+    m_compressionDict   = ZSTD_createCDict( dictionaryBytes, dictionarySize, compressionLevel );
+    m_decompressionDict = ZSTD_createDDict( dictionaryBytes, dictionarySize );
+
+    if ( m_compressionDict == nullptr || m_decompressionDict == nullptr )
+        return absl::InternalError( "unable to create zstd dictionary" );
+
+    m_dictionaryID = dictionaryID;
+    return absl::OkStatus();
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+Writer::Writer( const CompressionDictionaryPtr& dictionary, const int32_t compressionLevel )
+    : m_dictionary( dictionary )
+    , m_compressionLevel( compressionLevel )
+    , m_riffColumns( std::make_unique<RiffColumns>() )
+    , m_stemColumns( std::make_unique<StemColumns>() )
+{
+    m_compressionContext = ZSTD_createCCtx();
+
+    // index 0 is reserved for the empty string, used for unfilled stem slots and optional fields
+    intern( "" );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Writer::~Writer()
+{
+    ZSTD_freeCCtx( m_compressionContext );
+    m_compressionContext = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::open( const fs::path& outputFile, const Header& header )
+{
+    m_output.open( outputFile, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !m_output.is_open() )
+        return absl::UnavailableError( fmt::format( FMTX( "unable to open [{}] for writing" ), outputFile.string() ) );
+
+    const bool bUsingDictionary = m_dictionary != nullptr && m_dictionary->isValid();
+
+    const FileHeader fileHeader{
+        cFileMagic,
+        cFormatVersion,
+        bUsingDictionary ? m_dictionary->getID() : 0,
+        0 };
+    m_output.write( reinterpret_cast<const char*>( &fileHeader ), sizeof( fileHeader ) );
+
+    // META is always stored raw so that readHeader() never needs a dictionary
+    {
+        PayloadWriter payload( m_payloadBuffer );
+        payload.value( header.m_exportTimeUnix );
+        payload.string( header.m_exportOuroVersion );
+        payload.string( header.m_jamName );
+        payload.string( header.m_jamCouchID.value() );
+    }
+    return writeBlock( cBlockMeta, 1, false );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint32_t Writer::intern( std::string_view text )
+{
+    const auto existing = m_internTable.find( text );
+    if ( existing != m_internTable.end() )
+        return existing->second;
+
+    const uint32_t newIndex = m_internNextIndex++;
+    m_internTable.emplace( text, newIndex );
+    m_internPending.emplace_back( text );
+
+    return newIndex;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::appendRiff( const types::Riff& riff )
+{
+    RiffColumns& columns = *m_riffColumns;
+
+    columns.m_couchID.emplace_back( intern( riff.couchID.value() ) );
+    columns.m_user.emplace_back( intern( riff.user ) );
+    columns.m_creationTime.emplace_back( riff.creationTimeUnix );
+    columns.m_root.emplace_back( static_cast<uint8_t>( riff.root ) );
+    columns.m_scale.emplace_back( static_cast<uint8_t>( riff.scale ) );
+    columns.m_BPS.emplace_back( riff.BPS );
+    columns.m_BPMrnd.emplace_back( riff.BPMrnd );
+    columns.m_barLength.emplace_back( riff.barLength );
+    columns.m_appVersion.emplace_back( riff.appVersion );
+    columns.m_magnitude.emplace_back( riff.magnitude );
+
+    // stem IDs are kept even on slots that are switched off, so the riff comes back exactly as it went in
+    uint8_t stemsOnMask = 0;
+    for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+    {
+        columns.m_stems[stemI].emplace_back( riff.stems[stemI].empty() ? 0 : intern( riff.stems[stemI].value() ) );
+        columns.m_gains[stemI].emplace_back( riff.gains[stemI] );
+
+        if ( riff.stemsOn[stemI] )
+            stemsOnMask |= (uint8_t)( 1 << stemI );
+    }
+    columns.m_stemsOn.emplace_back( stemsOnMask );
+
+    if ( columns.size() >= cRowsPerBlock )
+        return flushRiffs();
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::appendStem( const types::Stem& stem )
+{
+    StemColumns& columns = *m_stemColumns;
+
+    uint8_t instrumentMask = 0;
+    if ( stem.isDrum )
+        instrumentMask |= 1 << 1;
+    if ( stem.isNote )
+        instrumentMask |= 1 << 2;
+    if ( stem.isBass )
+        instrumentMask |= 1 << 3;
+    if ( stem.isMic )
+        instrumentMask |= 1 << 4;
+
+    columns.m_couchID.emplace_back( intern( stem.couchID.value() ) );
+    columns.m_fileEndpoint.emplace_back( intern( stem.fileEndpoint ) );
+    columns.m_fileBucket.emplace_back( intern( stem.fileBucket ) );
+    columns.m_fileKey.emplace_back( intern( stem.fileKey ) );
+    columns.m_fileMIME.emplace_back( intern( stem.fileMIME ) );
+    columns.m_preset.emplace_back( intern( stem.preset ) );
+    columns.m_user.emplace_back( intern( stem.user ) );
+    columns.m_colour.emplace_back( intern( stem.colour ) );
+    columns.m_fileLengthBytes.emplace_back( stem.fileLengthBytes );
+    columns.m_sampleRate.emplace_back( stem.sampleRate );
+    columns.m_creationTime.emplace_back( stem.creationTimeUnix );
+    columns.m_BPS.emplace_back( stem.BPS );
+    columns.m_BPMrnd.emplace_back( stem.BPMrnd );
+    columns.m_length16s.emplace_back( stem.length16s );
+    columns.m_originalPitch.emplace_back( stem.originalPitch );
+    columns.m_barLength.emplace_back( stem.barLength );
+    columns.m_instrument.emplace_back( instrumentMask );
+
+    if ( columns.size() >= cRowsPerBlock )
+        return flushStems();
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::flushStrings()
+{
+    if ( m_internPending.empty() )
+        return absl::OkStatus();
+
+    // lengths column followed by all the string bytes back to back
+    {
+        PayloadWriter payload( m_payloadBuffer );
+        for ( const auto& pending : m_internPending )
+            payload.value( static_cast<uint32_t>( pending.size() ) );
+        for ( const auto& pending : m_internPending )
+            payload.bytes( pending.data(), pending.size() );
+    }
+
+    const auto stringCount = static_cast<uint32_t>( m_internPending.size() );
+    m_internPending.clear();
+
+    return writeBlock( cBlockStrings, stringCount, true );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::flushRiffs()
+{
+    const auto rowCount = static_cast<uint32_t>( m_riffColumns->size() );
+    if ( rowCount == 0 )
+        return absl::OkStatus();
+
+    // any strings referenced by this block must be known to the reader before it arrives
+    if ( const auto stringStatus = flushStrings(); !stringStatus.ok() )
+        return stringStatus;
+
+    {
+        PayloadWriter payload( m_payloadBuffer );
+        RiffColumns::visitColumns( *m_riffColumns, cFormatVersion, [&]( const auto& column ) { payload.column( column ); } );
+    }
+    m_riffColumns->clear();
+    m_totalRiffs += rowCount;
+
+    return writeBlock( cBlockRiffs, rowCount, true );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::flushStems()
+{
+    const auto rowCount = static_cast<uint32_t>( m_stemColumns->size() );
+    if ( rowCount == 0 )
+        return absl::OkStatus();
+
+    if ( const auto stringStatus = flushStrings(); !stringStatus.ok() )
+        return stringStatus;
+
+    {
+        PayloadWriter payload( m_payloadBuffer );
+        StemColumns::visitColumns( *m_stemColumns, [&]( const auto& column ) { payload.column( column ); } );
+    }
+    m_stemColumns->clear();
+    m_totalStems += rowCount;
+
+    return writeBlock( cBlockStems, rowCount, true );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::writeBlock( const uint32_t blockType, const uint32_t rowCount, const bool allowCompression )
+{
+    if ( m_payloadBuffer.size() > cMaximumBlockSize )
+        return absl::OutOfRangeError( "archive block too large" );
+
+    BlockHeader blockHeader{
+        blockType,
+        rowCount,
+        static_cast<uint32_t>( m_payloadBuffer.size() ),
+        static_cast<uint32_t>( m_payloadBuffer.size() ),
+        0,
+        BlockCodec::Raw,
+        0 };
+
+    const uint8_t* storedData = m_payloadBuffer.data();
+
+    if ( allowCompression && m_compressionContext != nullptr && !m_payloadBuffer.empty() )
+    {
+        m_compressedBuffer.resize( ZSTD_compressBound( m_payloadBuffer.size() ) );
+
+        const bool bUsingDictionary = m_dictionary != nullptr && m_dictionary->isValid();
+
+        const std::size_t compressedSize = bUsingDictionary ?
+            ZSTD_compress_usingCDict(
+                m_compressionContext,
+                m_compressedBuffer.data(),
+                m_compressedBuffer.size(),
+                m_payloadBuffer.data(),
+                m_payloadBuffer.size(),
+                m_dictionary->m_compressionDict ) :
+            ZSTD_compressCCtx(
+                m_compressionContext,
+                m_compressedBuffer.data(),
+                m_compressedBuffer.size(),
+                m_payloadBuffer.data(),
+                m_payloadBuffer.size(),
+                m_compressionLevel );
+
+        if ( ZSTD_isError( compressedSize ) )
+            return absl::InternalError( fmt::format( FMTX( "zstd compression failed ({})" ), ZSTD_getErrorName( compressedSize ) ) );
+
+        // only keep the compressed version if it actually won us something
+        if ( compressedSize < m_payloadBuffer.size() )
+        {
+            blockHeader.m_storedSize = static_cast<uint32_t>( compressedSize );
+            blockHeader.m_codec      = bUsingDictionary ? BlockCodec::ZstdDictionary : BlockCodec::Zstd;
+            storedData               = m_compressedBuffer.data();
+        }
+    }
+
+    blockHeader.m_checksum = blockChecksum( blockHeader, m_payloadBuffer, cFormatVersion );
+
+    m_output.write( reinterpret_cast<const char*>( &blockHeader ), sizeof( blockHeader ) );
+    m_output.write( reinterpret_cast<const char*>( storedData ), blockHeader.m_storedSize );
+
+    if ( !m_output.good() )
+        return absl::DataLossError( "failed writing archive block to disk" );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Writer::finish()
+{
+    if ( const auto riffStatus = flushRiffs(); !riffStatus.ok() )
+        return riffStatus;
+    if ( const auto stemStatus = flushStems(); !stemStatus.ok() )
+        return stemStatus;
+    if ( const auto stringStatus = flushStrings(); !stringStatus.ok() )
+        return stringStatus;
+
+    // trailer lets the reader confirm it saw everything that was written
+    {
+        PayloadWriter payload( m_payloadBuffer );
+        payload.value( static_cast<uint64_t>( m_totalRiffs ) );
+        payload.value( static_cast<uint64_t>( m_totalStems ) );
+        payload.value( static_cast<uint64_t>( m_internNextIndex ) );
+    }
+    if ( const auto endStatus = writeBlock( cBlockEnd, 0, false ); !endStatus.ok() )
+        return endStatus;
+
+    m_output.close();
+    if ( m_output.fail() )
+        return absl::DataLossError( "failed to close archive file" );
+
+    return absl::OkStatus();
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+Reader::Reader( const CompressionDictionaryPtr& dictionary )
+    : m_dictionary( dictionary )
+    , m_riffColumns( std::make_unique<RiffColumns>() )
+    , m_stemColumns( std::make_unique<StemColumns>() )
+{
+    m_decompressionContext = ZSTD_createDCtx();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Reader::~Reader()
+{
+    ZSTD_freeDCtx( m_decompressionContext );
+    m_decompressionContext = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Reader::open( const fs::path& inputFile )
+{
+    m_input.open( inputFile, std::ios::in | std::ios::binary );
+    if ( !m_input.is_open() )
+        return absl::NotFoundError( fmt::format( FMTX( "unable to open [{}]" ), inputFile.string() ) );
+
+    FileHeader fileHeader;
+    m_input.read( reinterpret_cast<char*>( &fileHeader ), sizeof( fileHeader ) );
+
+    if ( !m_input.good() || fileHeader.m_magic != cFileMagic )
+        return absl::InvalidArgumentError( fmt::format( FMTX( "[{}] is not an ouroveon jam archive" ), inputFile.filename().string() ) );
+    if ( fileHeader.m_version > cFormatVersion )
+        return absl::UnimplementedError( fmt::format( FMTX( "archive is format version {}, this build supports up to {}" ), fileHeader.m_version, cFormatVersion ) );
+
+    m_header.m_dictionaryID = fileHeader.m_dictionaryID;
+    m_formatVersion         = fileHeader.m_version;
+
+    uint32_t blockType, rowCount;
+    if ( const auto metaStatus = readBlock( blockType, rowCount ); !metaStatus.ok() )
+        return metaStatus;
+    if ( blockType != cBlockMeta )
+        return absl::DataLossError( "archive is missing META block" );
+
+    PayloadReader payload( m_payloadBuffer );
+    m_header.m_exportTimeUnix       = payload.value<uint64_t>();
+    m_header.m_exportOuroVersion    = payload.string();
+    m_header.m_jamName              = payload.string();
+    m_header.m_jamCouchID           = types::JamCouchID{ payload.string() };
+
+    if ( !payload.isComplete() )
+        return absl::DataLossError( "archive META block is malformed" );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Reader::readBlock( uint32_t& blockType, uint32_t& rowCount )
+{
+    BlockHeader blockHeader;
+    m_input.read( reinterpret_cast<char*>( &blockHeader ), sizeof( blockHeader ) );
+    if ( !m_input.good() )
+        return absl::DataLossError( "archive truncated; unable to read block header" );
+
+    if ( blockHeader.m_rawSize > cMaximumBlockSize || blockHeader.m_storedSize > cMaximumBlockSize )
+        return absl::DataLossError( "archive block header is corrupt" );
+
+    m_payloadBuffer.resize( blockHeader.m_rawSize );
+
+    if ( blockHeader.m_codec == BlockCodec::Raw )
+    {
+        if ( blockHeader.m_storedSize != blockHeader.m_rawSize )
+            return absl::DataLossError( "archive block header is corrupt" );
+
+        m_input.read( reinterpret_cast<char*>( m_payloadBuffer.data() ), blockHeader.m_rawSize );
+        if ( !m_input.good() )
+            return absl::DataLossError( "archive truncated; unable to read block data" );
+    }
+    else
+    {
+        m_storedBuffer.resize( blockHeader.m_storedSize );
+        m_input.read( reinterpret_cast<char*>( m_storedBuffer.data() ), blockHeader.m_storedSize );
+        if ( !m_input.good() )
+            return absl::DataLossError( "archive truncated; unable to read block data" );
+
+        if ( m_decompressionContext == nullptr )
+            return absl::InternalError( "unable to create zstd decompression context" );
+
+        std::size_t decompressedSize = 0;
+        if ( blockHeader.m_codec == BlockCodec::ZstdDictionary )
+        {
+            if ( m_dictionary == nullptr || m_dictionary->getID() != m_header.m_dictionaryID )
+            {
+                return absl::FailedPreconditionError( fmt::format(
+                    FMTX( "archive was compressed with dictionary {:x}, which is not available" ), m_header.m_dictionaryID ) );
+            }
+
+            decompressedSize = ZSTD_decompress_usingDDict(
+                m_decompressionContext,
+                m_payloadBuffer.data(),
+                m_payloadBuffer.size(),
+                m_storedBuffer.data(),
+                m_storedBuffer.size(),
+                m_dictionary->m_decompressionDict );
+        }
+        else if ( blockHeader.m_codec == BlockCodec::Zstd )
+        {
+            decompressedSize = ZSTD_decompressDCtx(
+                m_decompressionContext,
+                m_payloadBuffer.data(),
+                m_payloadBuffer.size(),
+                m_storedBuffer.data(),
+                m_storedBuffer.size() );
+        }
+        else
+        {
+            return absl::UnimplementedError( fmt::format( FMTX( "unknown archive block codec {}" ), static_cast<uint32_t>( blockHeader.m_codec ) ) );
+        }
+
+        if ( ZSTD_isError( decompressedSize ) )
+            return absl::DataLossError( fmt::format( FMTX( "zstd decompression failed ({})" ), ZSTD_getErrorName( decompressedSize ) ) );
+        if ( decompressedSize != blockHeader.m_rawSize )
+            return absl::DataLossError( "archive block decompressed to unexpected size" );
+    }
+
+    if ( blockChecksum( blockHeader, m_payloadBuffer, m_formatVersion ) != blockHeader.m_checksum )
+        return absl::DataLossError( "archive block failed checksum" );
+
+    blockType = blockHeader.m_blockType;
+    rowCount  = blockHeader.m_rowCount;
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr<bool> Reader::readNextBlock( std::vector< types::Riff >& riffs, std::vector< types::Stem >& stems )
+{
+    riffs.clear();
+    stems.clear();
+
+    // resolve an interned string reference, failing if it points past what we've been sent so far
+    bool bStringRefsValid = true;
+    const auto lookup = [&]( const uint32_t index ) -> const std::string&
+        {
+            if ( index >= m_stringTable.size() )
+            {
+                bStringRefsValid = false;
+                return m_stringTable.front();
+            }
+            return m_stringTable[index];
+        };
+
+    for ( ;; )
+    {
+        uint32_t blockType, rowCount;
+        if ( const auto blockStatus = readBlock( blockType, rowCount ); !blockStatus.ok() )
+            return blockStatus;
+
+        PayloadReader payload( m_payloadBuffer );
+
+        if ( blockType == cBlockStrings )
+        {
+            // the lengths column can only be as long as the payload allows, which bounds the reserve below
+            std::vector< uint32_t > lengths;
+            payload.column( lengths, rowCount );
+            if ( payload.m_failed )
+                return absl::DataLossError( "archive STRS block is malformed" );
+
+            m_stringTable.reserve( m_stringTable.size() + rowCount );
+            for ( const auto length : lengths )
+            {
+                if ( length > payload.remaining() )
+                    return absl::DataLossError( "archive STRS block is malformed" );
+
+                std::string& entry = m_stringTable.emplace_back();
+                entry.resize( length );
+                payload.bytes( entry.data(), length );
+            }
+            if ( !payload.isComplete() )
+                return absl::DataLossError( "archive STRS block is malformed" );
+
+            // keep going until we hit some riff or stem data to hand back
+            continue;
+        }
+
+        // string table always begins with the empty string, used for lookups that fail validation
+        if ( m_stringTable.empty() )
+            return absl::DataLossError( "archive data block arrived before any strings" );
+
+        if ( blockType == cBlockRiffs )
+        {
+            RiffColumns& columns = *m_riffColumns;
+            RiffColumns::visitColumns( columns, m_formatVersion, [&]( auto& column ) { payload.column( column, rowCount ); } );
+            if ( !payload.isComplete() )
+                return absl::DataLossError( "archive RIFF block is malformed" );
+
+            riffs.resize( rowCount );
+            for ( std::size_t row = 0; row < rowCount; row++ )
+            {
+                types::Riff& riff = riffs[row];
+
+                riff.couchID            = types::RiffCouchID{ lookup( columns.m_couchID[row] ) };
+                riff.jamCouchID         = m_header.m_jamCouchID;
+                riff.user               = lookup( columns.m_user[row] );
+                riff.creationTimeUnix   = columns.m_creationTime[row];
+                riff.root               = columns.m_root[row];
+                riff.scale              = columns.m_scale[row];
+                riff.BPS                = columns.m_BPS[row];
+                riff.BPMrnd             = columns.m_BPMrnd[row];
+                riff.barLength          = columns.m_barLength[row];
+                riff.appVersion         = columns.m_appVersion[row];
+                riff.magnitude          = columns.m_magnitude[row];
+
+                for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+                {
+                    riff.stems[stemI]   = types::StemCouchID{ lookup( columns.m_stems[stemI][row] ) };
+                    riff.gains[stemI]   = columns.m_gains[stemI][row];
+
+                    if ( m_formatVersion >= 2 )
+                        riff.stemsOn[stemI] = ( columns.m_stemsOn[row] & ( 1 << stemI ) ) != 0;
+                    else
+                        riff.stemsOn[stemI] = !riff.stems[stemI].empty();
+                }
+            }
+            m_totalRiffs += rowCount;
+        }
+        else if ( blockType == cBlockStems )
+        {
+            StemColumns& columns = *m_stemColumns;
+            StemColumns::visitColumns( columns, [&]( auto& column ) { payload.column( column, rowCount ); } );
+            if ( !payload.isComplete() )
+                return absl::DataLossError( "archive STEM block is malformed" );
+
+            stems.resize( rowCount );
+            for ( std::size_t row = 0; row < rowCount; row++ )
+            {
+                types::Stem& stem = stems[row];
+
+                stem.couchID            = types::StemCouchID{ lookup( columns.m_couchID[row] ) };
+                stem.jamCouchID         = m_header.m_jamCouchID;
+                stem.fileEndpoint       = lookup( columns.m_fileEndpoint[row] );
+                stem.fileBucket         = lookup( columns.m_fileBucket[row] );
+                stem.fileKey            = lookup( columns.m_fileKey[row] );
+                stem.fileMIME           = lookup( columns.m_fileMIME[row] );
+                stem.preset             = lookup( columns.m_preset[row] );
+                stem.user               = lookup( columns.m_user[row] );
+                stem.colour             = lookup( columns.m_colour[row] );
+                stem.fileLengthBytes    = columns.m_fileLengthBytes[row];
+                stem.sampleRate         = columns.m_sampleRate[row];
+                stem.creationTimeUnix   = columns.m_creationTime[row];
+                stem.BPS                = columns.m_BPS[row];
+                stem.BPMrnd             = columns.m_BPMrnd[row];
+                stem.length16s          = columns.m_length16s[row];
+                stem.originalPitch      = columns.m_originalPitch[row];
+                stem.barLength          = columns.m_barLength[row];
+
+                const uint8_t instrumentMask = columns.m_instrument[row];
+                stem.isDrum             = ( instrumentMask & ( 1 << 1 ) ) != 0;
+                stem.isNote             = ( instrumentMask & ( 1 << 2 ) ) != 0;
+                stem.isBass             = ( instrumentMask & ( 1 << 3 ) ) != 0;
+                stem.isMic              = ( instrumentMask & ( 1 << 4 ) ) != 0;
+            }
+            m_totalStems += rowCount;
+        }
+        else if ( blockType == cBlockEnd )
+        {
+            const auto expectedRiffs    = payload.value<uint64_t>();
+            const auto expectedStems    = payload.value<uint64_t>();
+            const auto expectedStrings  = payload.value<uint64_t>();
+
+            if ( !payload.isComplete() ||
+                 expectedRiffs   != m_totalRiffs ||
+                 expectedStems   != m_totalStems ||
+                 expectedStrings != m_stringTable.size() )
+            {
+                return absl::DataLossError( "archive END block does not match the data read" );
+            }
+            return false;
+        }
+        else
+        {
+            // unknown block types from newer minor revisions are skipped
+            blog::database( FMTX( "archive : skipping unknown block type {:08x}" ), blockType );
+            continue;
+        }
+
+        if ( !bStringRefsValid )
+            return absl::DataLossError( "archive data block references unknown strings" );
+
+        return true;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< Header > readHeader( const fs::path& inputFile )
+{
+    Reader headerReader( nullptr );
+    if ( const auto openStatus = headerReader.open( inputFile ); !openStatus.ok() )
+        return openStatus;
+
+    return headerReader.getHeader();
+}
+
+} // namespace archive
+} // namespace toolkit
+} // namespace endlesss
@@ -0,0 +1,181 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  binary columnar jam archive; the replacement for the YAML jam metadata export
+//
+//  file layout is a small fixed header followed by a stream of self-describing blocks -
+//
+//      [ file header ] [ META ] [ STRS ] [ RIFF ] [ STRS ] [ STEM ] ... [ END. ]
+//
+//  every block carries a row count, raw + stored sizes, the codec used to store it and a komihash checksum covering
+//  both those header fields and the raw payload (raw / zstd / zstd + shared dictionary). strings - couch IDs, usernames, stem references, file keys -
+//  are interned into a single table that is streamed out in STRS blocks ahead of any RIFF or STEM block that
+//  references new entries; riff and stem blocks are then plain SoA column arrays of fixed-width values
+//
+
+#pragma once
+
+#include "base/construction.h"
+#include "endlesss/core.types.h"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace endlesss {
+namespace toolkit {
+namespace archive {
+
+struct RiffColumns;
+struct StemColumns;
+
+static constexpr std::string_view   cFileExtension      = "orxj";
+static constexpr uint32_t           cFormatVersion      = 3;     // v2 stores each riff's stems-on flags explicitly
+                                                                 // v3 checksums cover the block header, not just its payload
+
+// rows collected before a RIFF or STEM block is encoded and written
+static constexpr std::size_t        cRowsPerBlock       = 4096;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// identifying data written at the front of every archive, cheap to read without decoding anything else
+struct Header
+{
+    uint64_t            m_exportTimeUnix = 0;
+    std::string         m_exportOuroVersion;
+    std::string         m_jamName;
+    types::JamCouchID   m_jamCouchID;
+
+    // zero if the archive blocks were not compressed against a shared dictionary
+    uint32_t            m_dictionaryID = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// optional pre-trained zstd dictionary shared between export and import; archives record the dictionary ID they were
+// written with so an import on a machine without the matching dictionary fails cleanly instead of producing garbage
+struct CompressionDictionary
+{
+    DECLARE_NO_COPY_NO_MOVE( CompressionDictionary );
+
+    CompressionDictionary() = default;
+    ~CompressionDictionary();
+
+    absl::Status load( const fs::path& dictionaryFile, const int32_t compressionLevel );
+
+    ouro_nodiscard constexpr uint32_t getID() const { return m_dictionaryID; }
+    ouro_nodiscard constexpr bool isValid() const { return m_dictionaryID != 0; }
+
+private:
+    friend class Writer;
+    friend class Reader;
+
+    ZSTD_CDict_s*       m_compressionDict   = nullptr;
+    ZSTD_DDict_s*       m_decompressionDict = nullptr;
+    uint32_t            m_dictionaryID      = 0;
+};
+using CompressionDictionaryPtr = std::shared_ptr< const CompressionDictionary >;
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// streaming archive writer; rows are buffered into columns and flushed as full blocks, so memory use is bounded by the
+// block size plus the string intern table rather than the size of the whole jam
+class Writer
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( Writer );
+
+    Writer( const CompressionDictionaryPtr& dictionary, const int32_t compressionLevel = 6 );
+    ~Writer();
+
+    absl::Status open( const fs::path& outputFile, const Header& header );
+
+    absl::Status appendRiff( const types::Riff& riff );
+    absl::Status appendStem( const types::Stem& stem );
+
+    // flush any partial blocks, write the END block and close the file
+    absl::Status finish();
+
+    ouro_nodiscard constexpr std::size_t getRiffCount() const { return m_totalRiffs; }
+    ouro_nodiscard constexpr std::size_t getStemCount() const { return m_totalStems; }
+
+private:
+
+    uint32_t intern( std::string_view text );
+
+    absl::Status flushStrings();
+    absl::Status flushRiffs();
+    absl::Status flushStems();
+    absl::Status writeBlock( const uint32_t blockType, const uint32_t rowCount, const bool allowCompression );
+
+    CompressionDictionaryPtr                    m_dictionary;
+    int32_t                                     m_compressionLevel;
+    ZSTD_CCtx_s*                                m_compressionContext = nullptr;
+
+    std::ofstream                               m_output;
+
+    absl::flat_hash_map< std::string, uint32_t > m_internTable;
+    std::vector< std::string >                  m_internPending;        // interned strings not yet written out
+    uint32_t                                    m_internNextIndex = 0;
+
+    std::unique_ptr< RiffColumns >              m_riffColumns;
+    std::unique_ptr< StemColumns >              m_stemColumns;
+
+    std::vector< uint8_t >                      m_payloadBuffer;
+    std::vector< uint8_t >                      m_compressedBuffer;
+
+    std::size_t                                 m_totalRiffs = 0;
+    std::size_t                                 m_totalStems = 0;
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// streaming archive reader; call readNextBlock() repeatedly to decode riffs and stems in block-sized batches, each
+// block is checksum-verified before being decoded
+class Reader
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( Reader );
+
+    Reader( const CompressionDictionaryPtr& dictionary );
+    ~Reader();
+
+    absl::Status open( const fs::path& inputFile );
+
+    ouro_nodiscard constexpr const Header& getHeader() const { return m_header; }
+
+    // decode the next data block into the given vectors (which are cleared first); returns false once the END block
+    // has been reached and verified against the running totals
+    absl::StatusOr<bool> readNextBlock( std::vector< types::Riff >& riffs, std::vector< types::Stem >& stems );
+
+private:
+
+    absl::Status readBlock( uint32_t& blockType, uint32_t& rowCount );
+
+    CompressionDictionaryPtr                    m_dictionary;
+    ZSTD_DCtx_s*                                m_decompressionContext = nullptr;
+
+    std::ifstream                               m_input;
+    Header                                      m_header;
+    uint32_t                                    m_formatVersion = 0;
+
+    std::vector< std::string >                  m_stringTable;
+
+    std::unique_ptr< RiffColumns >              m_riffColumns;
+    std::unique_ptr< StemColumns >              m_stemColumns;
+
+    std::vector< uint8_t >                      m_payloadBuffer;
+    std::vector< uint8_t >                      m_storedBuffer;
+
+    std::size_t                                 m_totalRiffs = 0;
+    std::size_t                                 m_totalStems = 0;
+};
+
+// read just the header and META block from an archive, eg. for presenting a list of importable files
+absl::StatusOr< Header > readHeader( const fs::path& inputFile );
+
+} // namespace archive
+} // namespace toolkit
+} // namespace endlesss
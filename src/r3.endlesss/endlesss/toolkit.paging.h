@@ -0,0 +1,165 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  concurrent fetching of numbered result pages from endpoints that don't tell us how many pages there are
+//
+
+#pragma once
+
+#include "base/scheduler.h"
+
+namespace endlesss {
+namespace toolkit {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// rather than waiting on each page before asking for the next, this keeps a bounded number of page requests in flight;
+// pages are requested speculatively past the end of the data and the first final (short / empty) page marks the end,
+// with anything fetched beyond it thrown away. results are always handed back in page order
+//
+// page requests run as jobs in a WorkScheduler lane. the calling thread works through pages as well, so a fetch still
+// finishes - just less concurrently - when the lane has no room left for the extra jobs. a caller that is itself a job
+// should hand pages to a different lane from its own; Sync is capped at a quarter of the slots, which can be just the
+// one the caller is already holding
+//
+struct PagedFetch
+{
+    struct Options
+    {
+        uint32_t    m_concurrency   = 4;        // how many page requests to have in flight at once
+        uint32_t    m_pageLimit     = 100;      // hard cap, for endpoints that may never produce a short page
+
+        // cancel to stop requesting new pages; the fetch then returns a cancelled error
+        base::WorkScheduler::CancellationToken  m_cancellation;
+    };
+
+    // called as each page lands with the total fetched so far; calls are serialised but arrive on worker threads
+    using ProgressCallback = std::function< void( const uint32_t pagesFetched ) >;
+
+    // fetch pages [0 .. n] into (pagesOut), where page n is the first that (isFinalPage) accepts. if the fetch stops
+    // before that, (pagesOut) holds every page up to where it stopped and an error says why - unavailable when
+    // (fetchPage) returns false on a network failure, resource-exhausted when the page limit is reached, cancelled
+    // when the options' token is - so the caller can decide whether a partial result is still useful
+    template< typename _PageType >
+    static absl::Status fetch(
+        base::WorkScheduler&                                        workScheduler,
+        const base::WorkScheduler::Lane::Enum                       workLane,
+        const Options&                                              options,
+        const std::function< bool( const uint32_t, _PageType& ) >&  fetchPage,
+        const std::function< bool( const _PageType& ) >&            isFinalPage,
+        std::vector< _PageType >&                                   pagesOut,
+        const ProgressCallback&                                     onProgress = nullptr );
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _PageType >
+absl::Status PagedFetch::fetch(
+    base::WorkScheduler&                                        workScheduler,
+    const base::WorkScheduler::Lane::Enum                       workLane,
+    const Options&                                              options,
+    const std::function< bool( const uint32_t, _PageType& ) >&  fetchPage,
+    const std::function< bool( const _PageType& ) >&            isFinalPage,
+    std::vector< _PageType >&                                   pagesOut,
+    const ProgressCallback&                                     onProgress )
+{
+    static constexpr uint32_t cNoPage = std::numeric_limits< uint32_t >::max();
+
+    pagesOut.clear();
+
+    const uint32_t pageLimit    = std::max( options.m_pageLimit, 1U );
+    const uint32_t workerCount  = std::clamp( options.m_concurrency, 1U, pageLimit );
+
+    // pages land out of order; slots are added as pages arrive, so a generous page limit costs nothing up front
+    std::vector< std::optional< _PageType > > pageSlots;
+    std::mutex                                pageSlotsMutex;
+
+    std::atomic_uint32_t    nextPage        = 0;
+    std::atomic_uint32_t    finalPageEnd    = cNoPage;      // one past the first final page seen
+    std::atomic_uint32_t    failedPage      = cNoPage;      // lowest page index that failed to fetch
+    std::atomic_uint32_t    pagesFetched    = 0;
+    std::mutex              progressMutex;
+
+    const auto lowerTo = []( std::atomic_uint32_t& value, const uint32_t newValue )
+    {
+        uint32_t current = value.load();
+        while ( newValue < current && !value.compare_exchange_weak( current, newValue ) ) {}
+    };
+
+    const auto pageWorker = [&]()
+    {
+        for ( ;; )
+        {
+            if ( options.m_cancellation.isCancelled() )
+                break;
+
+            const uint32_t pageIndex = nextPage++;
+            if ( pageIndex >= std::min( { finalPageEnd.load(), failedPage.load(), pageLimit } ) )
+                break;
+
+            _PageType page;
+            if ( !fetchPage( pageIndex, page ) )
+            {
+                lowerTo( failedPage, pageIndex );
+                break;
+            }
+
+            if ( isFinalPage( page ) )
+                lowerTo( finalPageEnd, pageIndex + 1 );
+
+            {
+                std::scoped_lock<std::mutex> pageSlotsLock( pageSlotsMutex );
+                if ( pageSlots.size() <= pageIndex )
+                    pageSlots.resize( pageIndex + 1 );
+                pageSlots[pageIndex] = std::move( page );
+            }
+
+            const uint32_t fetchedSoFar = ++pagesFetched;
+            if ( onProgress != nullptr )
+            {
+                std::scoped_lock<std::mutex> progressLock( progressMutex );
+                onProgress( fetchedSoFar );
+            }
+        }
+    };
+
+    // the extra workers are scheduler jobs under a token of our own; once the calling thread runs out of pages, any
+    // that never got to start are dropped and the rest are waited on, as they all point at state on this stack
+    {
+        base::WorkScheduler::CancellationToken workerToken;
+        for ( uint32_t workerIndex = 1; workerIndex < workerCount; workerIndex++ )
+            workScheduler.submit( workLane, pageWorker, workerToken );
+
+        pageWorker();
+
+        workerToken.cancel();
+        workerToken.waitForWork();
+    }
+
+    const uint32_t pageEnd = std::min( { finalPageEnd.load(), failedPage.load(), pageLimit } );
+
+    pagesOut.reserve( pageEnd );
+    for ( uint32_t pageIndex = 0; pageIndex < pageEnd; pageIndex++ )
+    {
+        // only missing if cancelled part-way; keep the unbroken run from the start
+        if ( pageIndex >= pageSlots.size() || !pageSlots[pageIndex].has_value() )
+            break;
+
+        pagesOut.emplace_back( std::move( pageSlots[pageIndex].value() ) );
+    }
+
+    if ( failedPage.load() < std::min( finalPageEnd.load(), pageLimit ) )
+        return absl::UnavailableError( fmt::format( FMTX( "page {} failed to fetch" ), failedPage.load() ) );
+
+    if ( pagesOut.size() < pageEnd || ( finalPageEnd.load() == cNoPage && options.m_cancellation.isCancelled() ) )
+        return absl::CancelledError( fmt::format( FMTX( "paging cancelled after {} pages" ), pagesOut.size() ) );
+
+    if ( finalPageEnd.load() > pageLimit )
+        return absl::ResourceExhaustedError( fmt::format( FMTX( "page limit of {} reached before a final page" ), pageLimit ) );
+
+    return absl::OkStatus();
+}
+
+} // namespace toolkit
+} // namespace endlesss
@@ -24,41 +24,61 @@ namespace toolkit {
 Pipeline::Pipeline(
     base::EventBusClient eventBus,
     endlesss::services::RiffFetchProvider& riffFetchProvider,
+    base::WorkScheduler& workScheduler,
+    const base::WorkScheduler::Lane::Enum workLane,
     const std::size_t liveRiffCacheSize,
     const RiffDataResolver& riffDataResolver,
     const RiffLoadCallback& riffLoadCallback,
     const QueueClearedCallback& queueClearedCallback )
     : m_eventBusClient( eventBus )
     , m_riffFetchProvider( riffFetchProvider )
+    , m_workScheduler( workScheduler )
+    , m_workLane( workLane )
     , m_cacheSize( liveRiffCacheSize )
     , m_resolver( riffDataResolver )
     , m_callbackRiffLoad( riffLoadCallback )
     , m_callbackQueueCleared( queueClearedCallback )
 {
-    m_pipelineThreadRun = true;
-    m_pipelineThread = std::make_unique<std::thread>( &Pipeline::pipelineThread, this );
+    if ( m_cacheSize > 0 )
+    {
+        m_liveRiffMiniCache = std::make_unique< endlesss::live::RiffCacheLRU >( m_cacheSize );
+    }
+    else
+    {
+        blog::api( FMTX( "pipeline started with no internal cache" ) );
+    }
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 Pipeline::~Pipeline()
 {
-    m_pipelineThreadRun = false;
-    m_pipelineThread->join();
-    m_pipelineThread.reset();
+    // any riff mid-load is allowed to finish, anything still queued is abandoned
+    m_workCancellation.cancel();
+    m_workCancellation.waitForWork();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 void Pipeline::requestRiff(const Request& riff)
 {
     m_requests.emplace( riff );
-    m_pipelineRequestSema.signal();
+    scheduleDrain();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 void Pipeline::requestClear()
 {
     m_pipelineClear = true;
-    m_pipelineRequestSema.signal();
+    scheduleDrain();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Pipeline::scheduleDrain()
+{
+    bool drainWasScheduled = false;
+    if ( m_drainScheduled.compare_exchange_strong( drainWasScheduled, true ) )
+    {
+        m_workScheduler.submit( m_workLane, [this]() { drainRequests(); }, m_workCancellation );
+    }
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -219,89 +239,77 @@ bool Pipeline::defaultNetworkResolver(
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void Pipeline::pipelineThread()
+void Pipeline::drainRequests()
 {
-    OuroveonThreadScope ots( OURO_THREAD_PREFIX "Riff-Pipeline" );
-
-    std::unique_ptr< endlesss::live::RiffCacheLRU > liveRiffMiniCache;
-
-    if ( m_cacheSize > 0 )
-    {
-        liveRiffMiniCache = std::make_unique< endlesss::live::RiffCacheLRU >( m_cacheSize );
-    }
-    else
-    {
-        blog::api( FMTX( "pipeline started with no internal cache" ) );
-    }
-
     Request riffRequest;
 
-    for (;;)
+    while ( !m_workCancellation.isCancelled() )
     {
-        if ( !m_pipelineThreadRun )
-            break;
+        base::instr::ScopedEvent se( "riff-load", base::instr::PresetColour::Emerald );
 
-        if ( m_pipelineRequestSema.wait( 100000 ) )
+        // if a purge was requested, drain the whole queue into the bin
+        if ( m_pipelineClear )
         {
-            base::instr::ScopedEvent se( "riff-load", base::instr::PresetColour::Emerald );
+            endlesss::live::RiffPtr nullRiff;
 
-            // if a purge was requested, drain the whole queue into the bin
-            if ( m_pipelineClear )
+            while ( m_requests.try_dequeue( riffRequest ) )
             {
-                endlesss::live::RiffPtr nullRiff;
+                // we still report that a request was "processed", just with a null result as it was skipped
+                // systems using the pipeline may need to know outflow of requests even if they weren't loaded
+                m_callbackRiffLoad( riffRequest.m_riff, nullRiff, riffRequest.m_playback );
 
-                while ( m_requests.try_dequeue( riffRequest ) )
-                {
-                    // we still report that a request was "processed", just with a null result as it was skipped
-                    // systems using the pipeline may need to know outflow of requests even if they weren't loaded
-                    m_callbackRiffLoad( riffRequest.m_riff, nullRiff, riffRequest.m_playback );
+                // emit operation complete
+                m_eventBusClient.Send< ::events::OperationComplete >( riffRequest.m_operationID );
+            }
 
-                    // emit operation complete
-                    m_eventBusClient.Send< ::events::OperationComplete >( riffRequest.m_operationID );
-                }
+            m_pipelineClear = false;
 
-                m_pipelineClear = false;
+            // ping the callback
+            if ( m_callbackQueueCleared )
+                m_callbackQueueCleared();
 
-                // ping the callback
-                if ( m_callbackQueueCleared )
-                    m_callbackQueueCleared();
+            continue;
+        }
 
-                continue;
-            }
+        // pick something off the request queue
+        if ( !m_requests.try_dequeue( riffRequest ) )
+        {
+            // out of work; stand down, then check nothing arrived in the gap before we did
+            m_drainScheduled = false;
 
-            // pick something off the request queue
-            if ( m_requests.try_dequeue( riffRequest ) )
-            {
-                ABSL_ASSERT( riffRequest.m_riff.hasData() );
+            if ( m_requests.size_approx() > 0 || m_pipelineClear )
+                scheduleDrain();
+
+            return;
+        }
 
-                endlesss::live::RiffPtr riffToPlay;
+        ABSL_ASSERT( riffRequest.m_riff.hasData() );
 
-                // rummage through our little local cache of live riff instances to see if we can re-use one
-                if ( liveRiffMiniCache == nullptr || liveRiffMiniCache->search( riffRequest.m_riff.getRiffID(), riffToPlay ) == false )
-                {
-                    endlesss::types::RiffComplete riffComplete;
-                    if ( m_resolver( riffRequest.m_riff, riffComplete ) )
-                    {
-                        riffToPlay = std::make_shared< endlesss::live::Riff >( riffComplete );
-                        riffToPlay->fetch( m_riffFetchProvider );
-
-                        // stash new riff in cache
-                        if ( liveRiffMiniCache != nullptr )
-                            liveRiffMiniCache->store( riffToPlay );
-                    }
-                    else
-                    {
-                        blog::error::api( FMTX( "riff pipeline resolver failed to fetch [{}]" ), riffRequest.m_riff.getRiffID() );
-                    }
-                }
+        endlesss::live::RiffPtr riffToPlay;
 
-                m_callbackRiffLoad( riffRequest.m_riff, riffToPlay, riffRequest.m_playback );
+        // rummage through our little local cache of live riff instances to see if we can re-use one
+        if ( m_liveRiffMiniCache == nullptr || m_liveRiffMiniCache->search( riffRequest.m_riff.getRiffID(), riffToPlay ) == false )
+        {
+            endlesss::types::RiffComplete riffComplete;
+            if ( m_resolver( riffRequest.m_riff, riffComplete ) )
+            {
+                riffToPlay = std::make_shared< endlesss::live::Riff >( riffComplete );
+                riffToPlay->fetch( m_riffFetchProvider );
 
-                // emit operation complete
-                m_eventBusClient.Send< ::events::OperationComplete >( riffRequest.m_operationID );
+                // stash new riff in cache
+                if ( m_liveRiffMiniCache != nullptr )
+                    m_liveRiffMiniCache->store( riffToPlay );
+            }
+            else
+            {
+                blog::error::api( FMTX( "riff pipeline resolver failed to fetch [{}]" ), riffRequest.m_riff.getRiffID() );
             }
         }
-        std::this_thread::yield();
+
+        m_callbackRiffLoad( riffRequest.m_riff, riffToPlay, riffRequest.m_playback );
+
+        // emit operation complete
+        m_eventBusClient.Send< ::events::OperationComplete >( riffRequest.m_operationID );
     }
 }
 
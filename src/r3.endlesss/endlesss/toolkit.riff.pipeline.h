@@ -9,15 +9,18 @@
 
 #pragma once
 #include "base/operations.h"
+#include "base/scheduler.h"
 
 #include "endlesss/core.types.h"
 #include "endlesss/live.riff.h"
 
 namespace endlesss {
+namespace live { struct RiffCacheLRU; }
 namespace toolkit {
 
 // ---------------------------------------------------------------------------------------------------------------------
-// 
+// resolves and loads requested riffs one at a time, in order, as jobs on a WorkScheduler lane - Interactive for
+// playback, Export for batch exports - so that riff loading takes its turn against the rest of the background work
 //
 struct Pipeline
 {
@@ -52,6 +55,8 @@ struct Pipeline
     Pipeline(
         base::EventBusClient                    eventBus,                   // event bus for sending operation-complete events
         endlesss::services::RiffFetchProvider&  riffFetchProvider,          // api required for riff fetching / caching
+        base::WorkScheduler&                    workScheduler,              // where requests are processed
+        const base::WorkScheduler::Lane::Enum   workLane,                   // .. and at what priority
         const std::size_t                       liveRiffCacheSize,          // number of live riffs to hold in the local pipeline cache
         const RiffDataResolver&                 riffDataResolver,           // resolver function that can process a request into riff data
         const RiffLoadCallback&                 riffLoadCallback,           // callback for when a request is processed (successfully or not)
@@ -96,25 +101,33 @@ private:
 
 
 
-    void pipelineThread();
+    // make sure a drain job is queued or running to pick up new requests
+    void scheduleDrain();
+
+    // work through everything currently requested; only ever one of these queued or running at a time
+    void drainRequests();
 
     using RiffIDQueue = mcc::ReaderWriterQueue< Request >;
 
-    base::EventBusClient            m_eventBusClient;
-    services::RiffFetchProvider     m_riffFetchProvider;
+    base::EventBusClient                    m_eventBusClient;
+    services::RiffFetchProvider             m_riffFetchProvider;
+
+    base::WorkScheduler&                    m_workScheduler;
+    base::WorkScheduler::Lane::Enum         m_workLane;
+    base::WorkScheduler::CancellationToken  m_workCancellation;     // cancelled on destruction
+    std::atomic_bool                        m_drainScheduled = false;
 
-    RiffIDQueue                     m_requests;         // riffs to fetch & play - written to by main thread, read from worker
+    RiffIDQueue                             m_requests;             // riffs to fetch & play - written to by main thread, read from drain jobs
 
-    std::size_t                     m_cacheSize = 0;
-    RiffDataResolver                m_resolver;
-    RiffLoadCallback                m_callbackRiffLoad;
-    QueueClearedCallback            m_callbackQueueCleared;
+    std::size_t                             m_cacheSize = 0;
+    RiffDataResolver                        m_resolver;
+    RiffLoadCallback                        m_callbackRiffLoad;
+    QueueClearedCallback                    m_callbackQueueCleared;
 
-    std::unique_ptr< std::thread >  m_pipelineThread;
-    std::atomic_bool                m_pipelineThreadRun = false;
-    mcc::LightweightSemaphore       m_pipelineRequestSema;
+    std::unique_ptr< endlesss::live::RiffCacheLRU >
+                                            m_liveRiffMiniCache;    // only touched by drain jobs
 
-    std::atomic_bool                m_pipelineClear = false;
+    std::atomic_bool                        m_pipelineClear = false;
 };
 
 } // namespace toolkit
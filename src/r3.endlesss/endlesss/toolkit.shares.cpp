@@ -12,6 +12,7 @@
 #include "spacetime/moment.h"
 
 #include "endlesss/api.h"
+#include "endlesss/toolkit.paging.h"
 #include "endlesss/toolkit.shares.h"
 #include "endlesss/config.h"
 
@@ -21,75 +22,107 @@ namespace endlesss {
 namespace toolkit {
 
 // ---------------------------------------------------------------------------------------------------------------------
-tf::Taskflow Shares::taskFetchLatest(
+void Shares::fetchLatest(
     const endlesss::api::NetConfiguration& apiCfg,
+    base::WorkScheduler& workScheduler,
+    const base::WorkScheduler::CancellationToken& cancellation,
     std::string username,
     std::function< void( StatusOrData ) > completionFunc )
 {
-    tf::Taskflow taskResult;
-    taskResult.emplace( [&apiCfg, usernameToFetch = std::move( username ), this, onCompletion = std::move( completionFunc )]()
+    workScheduler.submit( base::WorkScheduler::Lane::Sync, [&apiCfg, &workScheduler, cancellation, usernameToFetch = std::move( username ), this, onCompletion = std::move( completionFunc )]()
     {
-        const int32_t count = 5;    // how many shared riffs to pull each time (5 is what the website uses at time of writing)
-        int32_t offset = 0;
+        static constexpr int32_t count = 5;    // how many shared riffs to pull each time (5 is what the website uses at time of writing)
 
         SharedData newData = std::make_shared<config::endlesss::SharedRiffsCache>();
 
         newData->m_username     = usernameToFetch;
         newData->m_lastSyncTime = spacetime::getUnixTimeNow().count();
 
-        while ( true )
-        {
-            api::SharedRiffsByUser sharedRiffs;
-            if ( sharedRiffs.fetch( apiCfg, usernameToFetch, count, offset ) )
+        // with only a handful of riffs per page, prolific users need hundreds of pages; keep several requests in flight
+        // rather than walking the offsets one at a time, in the Prefetch lane as this job may hold the only Sync place.
+        // the page limit only guards against an endpoint that never returns a short page, result storage grows as
+        // pages arrive
+        toolkit::PagedFetch::Options pagingOptions;
+        pagingOptions.m_concurrency = 8;
+        pagingOptions.m_pageLimit   = cMaxSharedRiffs / count;
+        pagingOptions.m_cancellation = cancellation;
+
+        std::vector< api::SharedRiffsByUser > sharedRiffPages;
+        const absl::Status pagingStatus = toolkit::PagedFetch::fetch< api::SharedRiffsByUser >(
+            workScheduler,
+            base::WorkScheduler::Lane::Prefetch,
+            pagingOptions,
+            [&apiCfg, &usernameToFetch]( const uint32_t pageIndex, api::SharedRiffsByUser& sharedRiffs )
             {
-                for ( const auto& riffData : sharedRiffs.data )
-                {
-                    std::string jamCID = m_riffBandExtractor.estimateJamCouchID( riffData );
-                    
-                    // remove any invalid UTF8 characters from the title string before storage
-                    std::string sanitisedTitle;
-                    utf8::replace_invalid( riffData.title.begin(), riffData.title.end(), back_inserter( sanitisedTitle ) );
-
-                    newData->m_names.emplace_back( sanitisedTitle );
-                    newData->m_images.emplace_back( riffData.image_url );
-                    newData->m_sharedRiffIDs.emplace_back( riffData._id );
-                    newData->m_riffIDs.emplace_back( riffData.doc_id );
-                    newData->m_jamIDs.emplace_back( jamCID );
-                    newData->m_private.emplace_back( riffData.is_private );
-
-                    // public jams are all prefixed 'band'; personal ones are just the usename
-                    const bool bFromPersonalJam = ( jamCID == usernameToFetch || jamCID.rfind( "band", 0 ) != 0 );
-                    newData->m_personal.emplace_back( bFromPersonalJam );
-
-                    const uint64_t timestampUnix = riffData.action_timestamp / 1000; // from unix nano
-                    
-                    newData->m_timestamps.emplace_back( timestampUnix );
-
-                    newData->m_stems.emplace_back( riffData.loops );
-
-                    newData->m_count++;
-                }
-            }
-            else
+                return sharedRiffs.fetch( apiCfg, usernameToFetch, count, (int32_t)pageIndex * count );
+            },
+            []( const api::SharedRiffsByUser& sharedRiffs )
             {
-                // abort on a net failure
-                blog::api( "shared riff fetch() failure, aborting" );
+                // less than we expected, we've fetched all we can
+                return sharedRiffs.data.size() < count;
+            },
+            sharedRiffPages );
 
-                if ( onCompletion != nullptr )
-                    onCompletion( absl::AbortedError( "network fetch failure, aborted" ) );
-                
-                return;
-            }
+        if ( absl::IsResourceExhausted( pagingStatus ) )
+        {
+            blog::api( FMTX( "shared riff fetch() hit the {} riff cap, aborting" ), cMaxSharedRiffs );
 
-            // less than we expected, we've fetched all we can
-            if ( sharedRiffs.data.size() < count )
-                break;
+            if ( onCompletion != nullptr )
+                onCompletion( absl::ResourceExhaustedError( fmt::format( FMTX( "{} or more shared riffs, aborted" ), cMaxSharedRiffs ) ) );
 
-            offset += count;
+            return;
+        }
+        if ( absl::IsCancelled( pagingStatus ) )
+        {
+            if ( onCompletion != nullptr )
+                onCompletion( absl::CancelledError( "shared riff sync cancelled" ) );
+
+            return;
+        }
+        if ( !pagingStatus.ok() )
+        {
+            // abort on a net failure
+            blog::api( FMTX( "shared riff fetch() failure, aborting ({})" ), pagingStatus.ToString() );
+
+            if ( onCompletion != nullptr )
+                onCompletion( absl::AbortedError( "network fetch failure, aborted" ) );
+
+            return;
+        }
+
+        for ( const api::SharedRiffsByUser& sharedRiffs : sharedRiffPages )
+        {
+            for ( const auto& riffData : sharedRiffs.data )
+            {
+                std::string jamCID = m_riffBandExtractor.estimateJamCouchID( riffData );
+
+                // remove any invalid UTF8 characters from the title string before storage
+                std::string sanitisedTitle;
+                utf8::replace_invalid( riffData.title.begin(), riffData.title.end(), back_inserter( sanitisedTitle ) );
+
+                newData->m_names.emplace_back( sanitisedTitle );
+                newData->m_images.emplace_back( riffData.image_url );
+                newData->m_sharedRiffIDs.emplace_back( riffData._id );
+                newData->m_riffIDs.emplace_back( riffData.doc_id );
+                newData->m_jamIDs.emplace_back( jamCID );
+                newData->m_private.emplace_back( riffData.is_private );
+
+                // public jams are all prefixed 'band'; personal ones are just the usename
+                const bool bFromPersonalJam = ( jamCID == usernameToFetch || jamCID.rfind( "band", 0 ) != 0 );
+                newData->m_personal.emplace_back( bFromPersonalJam );
+
+                const uint64_t timestampUnix = riffData.action_timestamp / 1000; // from unix nano
+
+                newData->m_timestamps.emplace_back( timestampUnix );
+
+                newData->m_stems.emplace_back( riffData.loops );
+
+                newData->m_count++;
+            }
         }
 
         // successfully got some data
-        if ( offset > 0 )
+        if ( newData->m_count > 0 )
         {
             if ( onCompletion != nullptr )
                 onCompletion( newData );
@@ -99,9 +132,8 @@ tf::Taskflow Shares::taskFetchLatest(
             if ( onCompletion != nullptr )
                 onCompletion( absl::NotFoundError( "no shared riffs found" ) );
         }
-    });
-
-    return taskResult;
+    },
+    cancellation );
 }
 
 static constexpr auto cRegexBandNameExtract = "/(band[a-f0-9]+)/";
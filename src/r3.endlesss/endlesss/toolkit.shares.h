@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "base/scheduler.h"
+
 #include "endlesss/config.h"
 #include "endlesss/ids.h"
 #include "endlesss/api.h"
@@ -37,10 +39,17 @@ struct Shares
     using SharedData    = std::shared_ptr< config::endlesss::SharedRiffsCache >;
     using StatusOrData  = absl::StatusOr<SharedData>;
 
-    // produce Tf graph to execute; requests a download of new shared riff data for the given Endlesss username;
-    // pulls all the pages of data, crunches them down and calls completionFunc() with the result 
-    tf::Taskflow taskFetchLatest(
+    // stop syncing users once this many shared riffs have been listed; completionFunc() gets a resource-exhausted error
+    static constexpr int32_t cMaxSharedRiffs = 50000;
+
+    // queue a job in the Sync lane of (workScheduler) to download new shared riff data for the given Endlesss username;
+    // pulls all the pages of data, with page requests spread across the same lane, crunches them down and calls
+    // completionFunc() with the result. cancelling (cancellation) drops the job if it hasn't started, or stops the
+    // paging and completes with a cancelled error
+    void fetchLatest(
         const endlesss::api::NetConfiguration& apiCfg,
+        base::WorkScheduler& workScheduler,
+        const base::WorkScheduler::CancellationToken& cancellation,
         std::string username,
         std::function< void( StatusOrData ) > completionFunc );
 
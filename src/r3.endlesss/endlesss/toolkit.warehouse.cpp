@@ -136,13 +136,17 @@ struct JamSliceTask final : Warehouse::ITask
 {
     static constexpr std::string_view Tag = "JAMSLICE";
 
-    JamSliceTask( const types::JamCouchID& jamCID, const Warehouse::JamSliceCallback& callbackOnCompletion )
+    JamSliceTask( Warehouse::JamSliceCache& sliceCache, const types::JamCouchID& jamCID, const Warehouse::ChangeIndex changeIndex, const Warehouse::JamSliceCallback& callbackOnCompletion )
         : ITask()
+        , m_sliceCache( sliceCache )
         , m_jamCID( jamCID )
+        , m_changeIndex( changeIndex )
         , m_reportCallback( callbackOnCompletion )
     {}
 
+    Warehouse::JamSliceCache&       m_sliceCache;
     types::JamCouchID               m_jamCID;
+    Warehouse::ChangeIndex          m_changeIndex;
     Warehouse::JamSliceCallback     m_reportCallback;
 
     const char* getTag() const override { return Tag.data(); }
@@ -150,6 +154,25 @@ struct JamSliceTask final : Warehouse::ITask
     bool Work( TaskQueue& currentTasks ) override;
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+struct ProjectionValidateTask final : Warehouse::ITask
+{
+    static constexpr std::string_view Tag = "PROJECTION";
+
+    ProjectionValidateTask( Warehouse::JamSliceCache& sliceCache, Warehouse::RiffSimilarityIndex& similarityIndex )
+        : ITask()
+        , m_sliceCache( sliceCache )
+        , m_similarityIndex( similarityIndex )
+    {}
+
+    Warehouse::JamSliceCache&           m_sliceCache;
+    Warehouse::RiffSimilarityIndex&     m_similarityIndex;
+
+    const char* getTag() const override { return Tag.data(); }
+    std::string Describe() const override { return fmt::format( "[{}] validating riff projection", Tag ); }
+    bool Work( TaskQueue& currentTasks ) override;
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 struct JamSnapshotTask final : Warehouse::INetworkTask
 {
@@ -237,20 +260,22 @@ struct JamExportTask final : Warehouse::ITask
 {
     static constexpr std::string_view Tag = "EXPORT";
 
-    JamExportTask( base::EventBusClient& eventBus, const types::JamCouchID& jamCID, const fs::path& exportFolder, std::string_view jamName, const base::OperationID opID )
+    JamExportTask( base::EventBusClient& eventBus, const archive::CompressionDictionaryPtr& dictionary, const types::JamCouchID& jamCID, const fs::path& exportFolder, std::string_view jamName, const base::OperationID opID )
         : Warehouse::ITask()
         , m_eventBusClient( eventBus )
+        , m_dictionary( dictionary )
         , m_jamCID( jamCID )
         , m_exportFolder( exportFolder )
         , m_jamName( jamName )
         , m_operationID( opID )
     {}
 
-    base::EventBusClient    m_eventBusClient;
-    types::JamCouchID       m_jamCID;
-    fs::path                m_exportFolder;
-    std::string             m_jamName;
-    base::OperationID       m_operationID;
+    base::EventBusClient                m_eventBusClient;
+    archive::CompressionDictionaryPtr   m_dictionary;
+    types::JamCouchID                   m_jamCID;
+    fs::path                            m_exportFolder;
+    std::string                         m_jamName;
+    base::OperationID                   m_operationID;
 
     const char* getTag() const override { return Tag.data(); }
     std::string Describe() const override { return fmt::format( "[{}] exporting jam to disk", Tag ); }
@@ -262,23 +287,40 @@ struct JamImportTask final : Warehouse::ITask
 {
     static constexpr std::string_view Tag = "IMPORT";
 
-    JamImportTask( base::EventBusClient& eventBus, const fs::path& fileToImport, const base::OperationID opID )
+    JamImportTask( base::EventBusClient& eventBus, const archive::CompressionDictionaryPtr& dictionary, const fs::path& fileToImport, const base::OperationID opID )
         : Warehouse::ITask()
         , m_eventBusClient( eventBus )
+        , m_dictionary( dictionary )
         , m_fileToImport( fileToImport )
         , m_operationID( opID )
     {}
 
-    base::EventBusClient    m_eventBusClient;
-    fs::path                m_fileToImport;
-    base::OperationID       m_operationID;
+    base::EventBusClient                m_eventBusClient;
+    archive::CompressionDictionaryPtr   m_dictionary;
+    fs::path                            m_fileToImport;
+    base::OperationID                   m_operationID;
+    types::JamCouchID                   m_importedJamCID;       // filled in once the header has been read
 
     // rebuild after add
     bool shouldTriggerContentReport() const override { return true; }
 
+    // jam change index up so views and the similarity index pick up the imported riffs
+    bool shouldIncrementJamChangeIndex( types::JamCouchID& jamID ) const override
+    {
+        jamID = m_importedJamCID;
+        return !jamID.empty();
+    }
+
     const char* getTag() const override { return Tag.data(); }
     std::string Describe() const override { return fmt::format( "[{}] importing jam from disk", Tag ); }
     bool Work( TaskQueue& currentTasks ) override;
+
+private:
+
+    bool importArchive();
+    bool importLegacyYaml();
+
+    bool handleFailure( const absl::Status& failureStatus );
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -295,6 +337,13 @@ struct GetRiffDataTask final : Warehouse::INetworkTask
     types::JamCouchID                 m_jamCID;
     std::vector< types::RiffCouchID > m_riffCIDs;
 
+    // the index is also bumped when this task is enqueued, this second bump marks when the riff data actually landed
+    bool shouldIncrementJamChangeIndex( types::JamCouchID& jamID ) const override
+    {
+        jamID = m_jamCID;
+        return true;
+    }
+
     const char* getTag() const override { return Tag.data(); }
     std::string Describe() const override { return fmt::format( "[{}] pulling {} riff details", Tag, m_riffCIDs.size() ); }
     bool Work( TaskQueue& currentTasks ) override;
@@ -341,6 +390,61 @@ struct Warehouse::TaskSchedule
     }
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+// most recently produced slice per jam, kept so that follow-up requests can append only the riffs that have arrived
+// since rather than re-running the full join across the whole jam
+struct Warehouse::JamSliceCache
+{
+    static constexpr std::size_t cMaximumEntries = Warehouse::cJamSliceCacheSize;
+
+    struct Entry
+    {
+        std::shared_ptr< JamSlice >     m_slice;
+        ChangeIndex                     m_changeIndex           = ChangeIndex::invalid();
+
+        // projection revision of the jam when m_slice was produced; an incremental update is only valid if it still
+        // matches, see sql::projection::getRevision()
+        int64_t                         m_projectionRevision    = -1;
+
+        // index of the first row that had stems without user data (as the stems hadn't been synced yet); rows from
+        // here onwards are re-queried on the next update so they pick up the user hashes once they arrive
+        std::size_t                     m_firstUnresolvedRow    = 0;
+
+        uint64_t                        m_lastUsed              = 0;
+    };
+
+    Entry& fetch( const types::JamCouchID& jamCID )
+    {
+        auto entryIt = m_entries.find( jamCID );
+        if ( entryIt == m_entries.end() )
+        {
+            // make room by dropping whichever slice has gone unused the longest
+            if ( m_entries.size() >= cMaximumEntries )
+            {
+                auto oldestIt = m_entries.begin();
+                for ( auto it = m_entries.begin(); it != m_entries.end(); ++it )
+                {
+                    if ( it->second.m_lastUsed < oldestIt->second.m_lastUsed )
+                        oldestIt = it;
+                }
+                m_entries.erase( oldestIt );
+            }
+            entryIt = m_entries.emplace( jamCID, Entry{} ).first;
+        }
+
+        entryIt->second.m_lastUsed = ++m_useCounter;
+        return entryIt->second;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+    }
+
+    absl::flat_hash_map< types::JamCouchID, Entry > m_entries;
+    uint64_t                                        m_useCounter = 0;
+};
+
 namespace sql {
 
 #define DEPRECATE_INDEX     R"( DROP INDEX IF EXISTS )"
@@ -584,6 +688,27 @@ namespace riffs {
         }
     }
 
+    // -----------------------------------------------------------------------------------------------------------------
+    // gains are stored as a JSON array of 8 floats
+    static bool decodeGainsJson( const std::string_view gainsJson, endlesss::types::StemGains& outGains )
+    {
+        try 
+        {
+            nlohmann::json gains = nlohmann::json::parse( gainsJson );
+
+            for ( size_t stemI = 0; stemI < 8; stemI++ )
+            {
+                outGains[stemI] = gains[stemI];
+            }
+        }
+        catch ( const nlohmann::json::exception& je )
+        {
+            blog::error::app( "json parse error [{}] in {}", je.what(), __FUNCTION__ );
+            return false;
+        }
+        return true;
+    }
+
     // -----------------------------------------------------------------------------------------------------------------
     static bool getSingleByID( const types::RiffCouchID& riffCID, endlesss::types::Riff& outRiff )
     {
@@ -631,26 +756,7 @@ namespace riffs {
             outRiff.stemsOn[stemI] = !( outRiff.stems[stemI].empty() );
         }
 
-        try 
-        {
-            nlohmann::json gains = nlohmann::json::parse( gainsJson );
-
-            outRiff.gains[0] = gains[0];
-            outRiff.gains[1] = gains[1];
-            outRiff.gains[2] = gains[2];
-            outRiff.gains[3] = gains[3];
-            outRiff.gains[4] = gains[4];
-            outRiff.gains[5] = gains[5];
-            outRiff.gains[6] = gains[6];
-            outRiff.gains[7] = gains[7];
-        }
-        catch ( const nlohmann::json::parse_error& pe )
-        {
-            blog::error::app( "json parse error [{}] in {}", pe.what(), __FUNCTION__ );
-            return false;
-        }
-
-        return true;
+        return decodeGainsJson( gainsJson, outRiff.gains );
     }
 } // namespace riffs
 
@@ -1054,6 +1160,337 @@ namespace stems {
 
 } // namespace stems
 
+// ---------------------------------------------------------------------------------------------------------------------
+// denormalised riff -> stem user projection, used by jam slice queries; the slice needs the creator of every active
+// stem on every riff, which from the base tables is an 8-way join against Stems - this table holds the result of that
+// join in fixed columns so a slice becomes a single indexed scan
+//
+// the projection is maintained by triggers on Riffs and Stems so every writer (sync, import, conflict handling, purge)
+// keeps it current without having to know it exists. stems often arrive after the riffs that reference them, so any
+// stem slot still missing a user is noted in RiffProjectionPending and patched when that stem's data lands
+//
+namespace projection {
+
+// the canonical projection of a Riffs row, in RiffProjection column order; shared by the triggers, the rebuild and
+// the consistency check so they cannot drift apart
+#define RIFF_PROJECTION_SELECT \
+        "SELECT r.RiffCID, r.OwnerJamCID, r.CreationTime, r.UserName, r.Root, r.Scale, r.BPMrnd, " \
+        "( ( coalesce( r.StemCID_1, '' ) <> '' )      ) | " \
+        "( ( coalesce( r.StemCID_2, '' ) <> '' ) << 1 ) | " \
+        "( ( coalesce( r.StemCID_3, '' ) <> '' ) << 2 ) | " \
+        "( ( coalesce( r.StemCID_4, '' ) <> '' ) << 3 ) | " \
+        "( ( coalesce( r.StemCID_5, '' ) <> '' ) << 4 ) | " \
+        "( ( coalesce( r.StemCID_6, '' ) <> '' ) << 5 ) | " \
+        "( ( coalesce( r.StemCID_7, '' ) <> '' ) << 6 ) | " \
+        "( ( coalesce( r.StemCID_8, '' ) <> '' ) << 7 ), " \
+        "r.StemCID_1, s1.CreatorUserName, " \
+        "r.StemCID_2, s2.CreatorUserName, " \
+        "r.StemCID_3, s3.CreatorUserName, " \
+        "r.StemCID_4, s4.CreatorUserName, " \
+        "r.StemCID_5, s5.CreatorUserName, " \
+        "r.StemCID_6, s6.CreatorUserName, " \
+        "r.StemCID_7, s7.CreatorUserName, " \
+        "r.StemCID_8, s8.CreatorUserName " \
+        "FROM Riffs AS r " \
+        "LEFT JOIN Stems AS s1 ON s1.StemCID = r.StemCID_1 " \
+        "LEFT JOIN Stems AS s2 ON s2.StemCID = r.StemCID_2 " \
+        "LEFT JOIN Stems AS s3 ON s3.StemCID = r.StemCID_3 " \
+        "LEFT JOIN Stems AS s4 ON s4.StemCID = r.StemCID_4 " \
+        "LEFT JOIN Stems AS s5 ON s5.StemCID = r.StemCID_5 " \
+        "LEFT JOIN Stems AS s6 ON s6.StemCID = r.StemCID_6 " \
+        "LEFT JOIN Stems AS s7 ON s7.StemCID = r.StemCID_7 " \
+        "LEFT JOIN Stems AS s8 ON s8.StemCID = r.StemCID_8 " \
+        "WHERE r.AppVersion IS NOT NULL "
+
+// (StemCID, RiffCID) for every active stem slot in RiffProjection that has no user yet
+#define RIFF_PROJECTION_UNRESOLVED( _where ) \
+        "SELECT StemCID_1, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_1, '' ) <> '' AND StemUser_1 IS NULL UNION ALL " \
+        "SELECT StemCID_2, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_2, '' ) <> '' AND StemUser_2 IS NULL UNION ALL " \
+        "SELECT StemCID_3, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_3, '' ) <> '' AND StemUser_3 IS NULL UNION ALL " \
+        "SELECT StemCID_4, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_4, '' ) <> '' AND StemUser_4 IS NULL UNION ALL " \
+        "SELECT StemCID_5, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_5, '' ) <> '' AND StemUser_5 IS NULL UNION ALL " \
+        "SELECT StemCID_6, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_6, '' ) <> '' AND StemUser_6 IS NULL UNION ALL " \
+        "SELECT StemCID_7, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_7, '' ) <> '' AND StemUser_7 IS NULL UNION ALL " \
+        "SELECT StemCID_8, RiffCID FROM RiffProjection WHERE " _where " AND coalesce( StemCID_8, '' ) <> '' AND StemUser_8 IS NULL "
+
+// patch a newly known stem user into any projection rows waiting on it
+#define RIFF_PROJECTION_RESOLVE_STEM \
+        "UPDATE RiffProjection SET " \
+        "StemUser_1 = CASE WHEN StemCID_1 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_1 END, " \
+        "StemUser_2 = CASE WHEN StemCID_2 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_2 END, " \
+        "StemUser_3 = CASE WHEN StemCID_3 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_3 END, " \
+        "StemUser_4 = CASE WHEN StemCID_4 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_4 END, " \
+        "StemUser_5 = CASE WHEN StemCID_5 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_5 END, " \
+        "StemUser_6 = CASE WHEN StemCID_6 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_6 END, " \
+        "StemUser_7 = CASE WHEN StemCID_7 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_7 END, " \
+        "StemUser_8 = CASE WHEN StemCID_8 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_8 END " \
+        "WHERE RiffCID IN ( SELECT RiffCID FROM RiffProjectionPending WHERE StemCID = NEW.StemCID ); " \
+        "DELETE FROM RiffProjectionPending WHERE StemCID = NEW.StemCID; "
+
+// projection rows that have (stem CID) in any slot; there is no per-slot index, so this is a scan of the projection
+#define RIFF_PROJECTION_USES_STEM( _stemCID ) \
+        "( StemCID_1 = " _stemCID " OR StemCID_2 = " _stemCID " OR StemCID_3 = " _stemCID " OR StemCID_4 = " _stemCID " OR " \
+        "  StemCID_5 = " _stemCID " OR StemCID_6 = " _stemCID " OR StemCID_7 = " _stemCID " OR StemCID_8 = " _stemCID " ) "
+
+// step the revision of every jam (_jamCID) selects from (_from); the upsert needs the WHERE to parse inside a trigger
+#define RIFF_PROJECTION_BUMP_REVISION( _jamCID, _from ) \
+        "INSERT INTO RiffProjectionRevision( OwnerJamCID, Revision ) " \
+        "SELECT DISTINCT " _jamCID ", 1 " _from " " \
+        "ON CONFLICT( OwnerJamCID ) DO UPDATE SET Revision = Revision + 1; "
+
+// a stem that already had a user has been given a different one (or had it cleared); every row using it is patched,
+// not just the pending ones, and the owning jams have their revision stepped so cached slices holding the old name
+// are rebuilt
+#define RIFF_PROJECTION_REPATCH_STEM \
+        RIFF_PROJECTION_BUMP_REVISION( "OwnerJamCID", "FROM RiffProjection WHERE " RIFF_PROJECTION_USES_STEM( "NEW.StemCID" ) ) \
+        "UPDATE RiffProjection SET " \
+        "StemUser_1 = CASE WHEN StemCID_1 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_1 END, " \
+        "StemUser_2 = CASE WHEN StemCID_2 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_2 END, " \
+        "StemUser_3 = CASE WHEN StemCID_3 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_3 END, " \
+        "StemUser_4 = CASE WHEN StemCID_4 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_4 END, " \
+        "StemUser_5 = CASE WHEN StemCID_5 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_5 END, " \
+        "StemUser_6 = CASE WHEN StemCID_6 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_6 END, " \
+        "StemUser_7 = CASE WHEN StemCID_7 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_7 END, " \
+        "StemUser_8 = CASE WHEN StemCID_8 = NEW.StemCID THEN NEW.CreatorUserName ELSE StemUser_8 END " \
+        "WHERE " RIFF_PROJECTION_USES_STEM( "NEW.StemCID" ) "; " \
+        "INSERT OR IGNORE INTO RiffProjectionPending( StemCID, RiffCID ) " \
+        "SELECT NEW.StemCID, RiffCID FROM RiffProjection WHERE NEW.CreatorUserName IS NULL AND " RIFF_PROJECTION_USES_STEM( "NEW.StemCID" ) "; "
+
+    static constexpr char createTable[] = R"(
+        CREATE TABLE IF NOT EXISTS "RiffProjection" (
+            "RiffCID"       TEXT NOT NULL UNIQUE,
+            "OwnerJamCID"   TEXT NOT NULL,
+            "CreationTime"  INTEGER,
+            "UserName"      TEXT,
+            "Root"          INTEGER,
+            "Scale"         INTEGER,
+            "BPMrnd"        REAL,
+            "StemMask"      INTEGER,
+            "StemCID_1"     TEXT,
+            "StemUser_1"    TEXT,
+            "StemCID_2"     TEXT,
+            "StemUser_2"    TEXT,
+            "StemCID_3"     TEXT,
+            "StemUser_3"    TEXT,
+            "StemCID_4"     TEXT,
+            "StemUser_4"    TEXT,
+            "StemCID_5"     TEXT,
+            "StemUser_5"    TEXT,
+            "StemCID_6"     TEXT,
+            "StemUser_6"    TEXT,
+            "StemCID_7"     TEXT,
+            "StemUser_7"    TEXT,
+            "StemCID_8"     TEXT,
+            "StemUser_8"    TEXT,
+            PRIMARY KEY("RiffCID")
+        );)";
+    static constexpr char createPendingTable[] = R"(
+        CREATE TABLE IF NOT EXISTS "RiffProjectionPending" (
+            "StemCID"       TEXT NOT NULL,
+            "RiffCID"       TEXT NOT NULL,
+            PRIMARY KEY("StemCID", "RiffCID")
+        ) WITHOUT ROWID;)";
+    // per-jam counter that only ever goes up, stepped whenever rows a cached slice may already hold are removed,
+    // replaced or re-patched, or a row lands anywhere but the end of the jam; see getRevision()
+    static constexpr char createRevisionTable[] = R"(
+        CREATE TABLE IF NOT EXISTS "RiffProjectionRevision" (
+            "OwnerJamCID"   TEXT NOT NULL,
+            "Revision"      INTEGER NOT NULL,
+            PRIMARY KEY("OwnerJamCID")
+        ) WITHOUT ROWID;)";
+    static constexpr char createIndex_0[] = R"(
+        CREATE INDEX        IF NOT EXISTS "RiffProjection_IndexSlice"   ON "RiffProjection" ( "OwnerJamCID", "CreationTime", "RiffCID" );)";
+    static constexpr char createIndex_1[] = R"(
+        CREATE INDEX        IF NOT EXISTS "RiffProjection_IndexPending" ON "RiffProjectionPending" ( "RiffCID" );)";
+
+    // riff written or changed; replace the projected row (or drop it, if the riff has gone back to unpopulated) and
+    // recompute which of its stems are still waiting on user data
+    static constexpr char createTrigger_0[] = { R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_RiffInsert" AFTER INSERT ON "Riffs"
+        BEGIN
+            DELETE FROM RiffProjectionPending WHERE RiffCID = NEW.RiffCID;
+            DELETE FROM RiffProjection WHERE RiffCID = NEW.RiffCID AND NEW.AppVersion IS NULL;
+            INSERT OR REPLACE INTO RiffProjection )" RIFF_PROJECTION_SELECT R"( AND r.RiffCID = NEW.RiffCID;
+            INSERT OR IGNORE INTO RiffProjectionPending( StemCID, RiffCID ) )" RIFF_PROJECTION_UNRESOLVED( "RiffCID = NEW.RiffCID" ) R"(;
+        END;)" };
+    static constexpr char createTrigger_1[] = { R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_RiffUpdate" AFTER UPDATE ON "Riffs"
+        BEGIN
+            DELETE FROM RiffProjectionPending WHERE RiffCID = OLD.RiffCID OR RiffCID = NEW.RiffCID;
+            DELETE FROM RiffProjection WHERE RiffCID = OLD.RiffCID OR ( RiffCID = NEW.RiffCID AND NEW.AppVersion IS NULL );
+            INSERT OR REPLACE INTO RiffProjection )" RIFF_PROJECTION_SELECT R"( AND r.RiffCID = NEW.RiffCID;
+            INSERT OR IGNORE INTO RiffProjectionPending( StemCID, RiffCID ) )" RIFF_PROJECTION_UNRESOLVED( "RiffCID = NEW.RiffCID" ) R"(;
+        END;)" };
+    static constexpr char createTrigger_2[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_RiffDelete" AFTER DELETE ON "Riffs"
+        BEGIN
+            DELETE FROM RiffProjectionPending WHERE RiffCID = OLD.RiffCID;
+            DELETE FROM RiffProjection WHERE RiffCID = OLD.RiffCID;
+        END;)";
+    // stem user arrived, either via a fresh insert (import upserts) or by filling in a placeholder row (sync)
+    static constexpr char createTrigger_3[] = { R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_StemInsert" AFTER INSERT ON "Stems" WHEN NEW.CreatorUserName IS NOT NULL
+        BEGIN )" RIFF_PROJECTION_RESOLVE_STEM R"(
+        END;)" };
+    static constexpr char createTrigger_4[] = { R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_StemUpdate" AFTER UPDATE OF CreatorUserName ON "Stems" WHEN NEW.CreatorUserName IS NOT NULL
+        BEGIN )" RIFF_PROJECTION_RESOLVE_STEM R"(
+        END;)" };
+    // stem user changed after it was already known; rare (a re-import or re-sync with different data), so the
+    // projection scan it costs is acceptable
+    static constexpr char createTrigger_5[] = { R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_StemUserChange" AFTER UPDATE OF CreatorUserName ON "Stems"
+            WHEN OLD.CreatorUserName IS NOT NULL AND OLD.CreatorUserName IS NOT NEW.CreatorUserName
+        BEGIN )" RIFF_PROJECTION_REPATCH_STEM R"(
+        END;)" };
+    // projection rows going away, or being replaced in place by INSERT OR REPLACE (which doesn't fire delete triggers)
+    // both invalidate what came before; a fresh row only does if it sorts before one the jam already has, as anything
+    // after the last row is picked up by an incremental slice update resuming from there
+    static constexpr char createTrigger_6[] = { R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_RowDelete" AFTER DELETE ON "RiffProjection"
+        BEGIN )" RIFF_PROJECTION_BUMP_REVISION( "OLD.OwnerJamCID", "WHERE 1" ) R"(
+        END;)" };
+    static constexpr char createTrigger_7[] = { R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffProjection_RowInsert" BEFORE INSERT ON "RiffProjection"
+        BEGIN )"
+            RIFF_PROJECTION_BUMP_REVISION( "OwnerJamCID", "FROM RiffProjection WHERE RiffCID = NEW.RiffCID" )
+            RIFF_PROJECTION_BUMP_REVISION( "NEW.OwnerJamCID", "WHERE EXISTS ( SELECT 1 FROM RiffProjection WHERE OwnerJamCID = NEW.OwnerJamCID AND "
+                "( CreationTime > NEW.CreationTime OR ( CreationTime = NEW.CreationTime AND RiffCID > NEW.RiffCID ) ) )" ) R"(
+        END;)" };
+
+    static constexpr char rebuild_0[] = R"(
+        DELETE FROM RiffProjectionPending;)";
+    static constexpr char rebuild_1[] = R"(
+        DELETE FROM RiffProjection;)";
+    static constexpr char rebuild_2[] = { "INSERT INTO RiffProjection " RIFF_PROJECTION_SELECT ";" };
+    static constexpr char rebuild_3[] = { "INSERT OR IGNORE INTO RiffProjectionPending( StemCID, RiffCID ) " RIFF_PROJECTION_UNRESOLVED( "1" ) ";" };
+
+    // rows the projection should have but doesn't (or has with stale values), and rows it has that it shouldn't;
+    // compound SELECTs treat NULLs as equal, so this is an exact column-by-column comparison
+    static constexpr char countMissingOrStale[] = { "SELECT count(*) FROM ( " RIFF_PROJECTION_SELECT " EXCEPT SELECT * FROM RiffProjection );" };
+    static constexpr char countOrphaned[]       = { "SELECT count(*) FROM ( SELECT * FROM RiffProjection EXCEPT " RIFF_PROJECTION_SELECT " );" };
+
+#undef RIFF_PROJECTION_REPATCH_STEM
+#undef RIFF_PROJECTION_BUMP_REVISION
+#undef RIFF_PROJECTION_USES_STEM
+#undef RIFF_PROJECTION_RESOLVE_STEM
+#undef RIFF_PROJECTION_UNRESOLVED
+#undef RIFF_PROJECTION_SELECT
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // wipe and regenerate the whole projection from the base tables; expects to be run inside a transaction. every
+    // jam's revision steps as its rows are deleted, so no slice built beforehand can be extended afterwards
+    static void rebuild()
+    {
+        spacetime::ScopedTimer rebuildTiming( "warehouse [projection rebuild]" );
+
+        Warehouse::SqlDB::query<rebuild_0>();
+        Warehouse::SqlDB::query<rebuild_1>();
+        Warehouse::SqlDB::query<rebuild_2>();
+        Warehouse::SqlDB::query<rebuild_3>();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // full comparison of the projection against the join it replaces; returns the number of mismatched rows
+    static int64_t checkConsistency()
+    {
+        int64_t missingOrStale = 0;
+        int64_t orphaned = 0;
+
+        {
+            auto countRow = Warehouse::SqlDB::query<countMissingOrStale>();
+            countRow( missingOrStale );
+        }
+        {
+            auto countRow = Warehouse::SqlDB::query<countOrphaned>();
+            countRow( orphaned );
+        }
+
+        if ( missingOrStale > 0 || orphaned > 0 )
+            blog::error::database( FMTX( "riff projection mismatch; {} missing or stale, {} orphaned" ), missingOrStale, orphaned );
+
+        return missingOrStale + orphaned;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    static int64_t countRowsInJam( const types::JamCouchID& jamCID )
+    {
+        static constexpr char _sqlCountProjectedRiffsInJam[] = R"(
+            select count(*) from RiffProjection where OwnerJamCID is ?1;
+        )";
+
+        auto countRiffsRow = Warehouse::SqlDB::query<_sqlCountProjectedRiffsInJam>( jamCID.value() );
+        int64_t totalRiffsInJam = 0;
+        countRiffsRow( totalRiffsInJam );
+
+        return totalRiffsInJam;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // the jam's projection revision; while it holds, every row of a slice built from the projection is still as it
+    // was, and only rows at or after the end of that slice can have changed. 0 for jams never touched
+    static int64_t getRevision( const types::JamCouchID& jamCID )
+    {
+        static constexpr char _sqlGetRevision[] = R"(
+            select coalesce( max( Revision ), 0 ) from RiffProjectionRevision where OwnerJamCID is ?1;
+        )";
+
+        auto revisionRow = Warehouse::SqlDB::query<_sqlGetRevision>( jamCID.value() );
+        int64_t revision = 0;
+        revisionRow( revision );
+
+        return revision;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // must run after riffs / stems init as the triggers reference both tables
+    static void runInit()
+    {
+        static constexpr char _sqlCountProjected[] = R"(
+            select count(*) from RiffProjection;
+        )";
+        static constexpr char _sqlCountPopulated[] = R"(
+            select count(*) from riffs where AppVersion is not null;
+        )";
+
+        Warehouse::SqlDB::query<createTable>();
+        Warehouse::SqlDB::query<createPendingTable>();
+        Warehouse::SqlDB::query<createRevisionTable>();
+
+        Warehouse::SqlDB::query<createIndex_0>();
+        Warehouse::SqlDB::query<createIndex_1>();
+
+        Warehouse::SqlDB::query<createTrigger_0>();
+        Warehouse::SqlDB::query<createTrigger_1>();
+        Warehouse::SqlDB::query<createTrigger_2>();
+        Warehouse::SqlDB::query<createTrigger_3>();
+        Warehouse::SqlDB::query<createTrigger_4>();
+        Warehouse::SqlDB::query<createTrigger_5>();
+        Warehouse::SqlDB::query<createTrigger_6>();
+        Warehouse::SqlDB::query<createTrigger_7>();
+
+        // cheap sanity check on startup; a fresh projection on an existing database (or one that was edited by
+        // something other than us, with the triggers absent) gets regenerated from scratch
+        int64_t projectedRows = 0;
+        int64_t populatedRiffs = 0;
+        {
+            auto countRow = Warehouse::SqlDB::query<_sqlCountProjected>();
+            countRow( projectedRows );
+        }
+        {
+            auto countRow = Warehouse::SqlDB::query<_sqlCountPopulated>();
+            countRow( populatedRiffs );
+        }
+        if ( projectedRows != populatedRiffs )
+        {
+            blog::database( FMTX( "riff projection has {} rows, expected {}; rebuilding" ), projectedRows, populatedRiffs );
+            rebuild();
+        }
+    }
+
+} // namespace projection
+
+
 // ---------------------------------------------------------------------------------------------------------------------
 namespace ledger {
 
@@ -1121,122 +1558,445 @@ namespace constants {
 } // namespace sql
 
 // ---------------------------------------------------------------------------------------------------------------------
-// add a custom seeded RANDOM function to sqlite, allowing us to feed through specific random sequences
+// in-memory riff lookup for the procedural tools; riffs are bucketed by rounded BPM and root/scale so that a seeded
+// pick is a handful of bucket lookups instead of sqlite sorting every candidate row by a random key
 //
-static void sqlite_SEEDED_RANDOM_dtor( void* p )
+// all the database reads happen on the warehouse worker in update(); the full build once the first sample() asks for
+// it, then a jam at a time as change indices move. the lock is only held to swap finished results in, so a sample()
+// never waits on sqlite unless the index has not been built yet - in which case it waits for the worker to finish
+// the build. refreshes after that are applied as the worker gets to them, a sample taken in between sees the jam as
+// it was. bucket contents are kept sorted by riff ID so a given seed picks the same riffs for the same database
+// contents, regardless of the order in which jams were loaded or refreshed. sample() is safe to call from any thread,
+// everything else is for the worker only
+//
+struct Warehouse::RiffSimilarityIndex
 {
-    math::RNG32* pRNG = static_cast<math::RNG32*>(p);
-    delete pRNG;
-}
+    using BucketKey = uint32_t;
 
-static void sqlite_SEEDED_RANDOM( sqlite3_context* context, int argc, sqlite3_value** argv )
-{
-    if ( argc == 1 && sqlite3_value_type( argv[0] ) == SQLITE_INTEGER )
-    {
-        // fetch the current RNG state from db context
-        math::RNG32* pRNG = static_cast<math::RNG32*>( sqlite3_get_auxdata( context, 0 ) );
-        if ( !pRNG )
-        {
-            // .. first time through, create the RNG state, stash it
-            const int32_t seed = sqlite3_value_int( argv[0] );
-            pRNG = new math::RNG32( static_cast<uint32_t>(seed) );
-            sqlite3_set_auxdata( context, 0, pRNG, sqlite_SEEDED_RANDOM_dtor );
-        }
+    // jam slot in the high half, index into that jam's riff list in the low half
+    using EntryRef  = uint64_t;
 
-        // produce the next number in the sequence
-        const int64_t result = pRNG->genInt32();
+    // nudge the worker so it calls update() without waiting out its idle timer
+    using WakeWorkerFn = std::function< void() >;
 
-        sqlite3_result_int64( context, result );
-    }
-    else
+    // how long sample() waits on the initial build before giving up with no picks
+    static constexpr auto cBuildTimeout = std::chrono::seconds( 30 );
+
+    RiffSimilarityIndex( WakeWorkerFn&& wakeWorker )
+        : m_wakeWorker( std::move( wakeWorker ) )
+    {}
+
+    static constexpr BucketKey makeKey( const uint32_t bpm, const int32_t rootScale )
     {
-        sqlite3_result_error( context, "Invalid", 0 );
+        return ( bpm << 16 ) | static_cast<uint32_t>( rootScale & 0xFFFF );
     }
-}
 
-// ---------------------------------------------------------------------------------------------------------------------
-Warehouse::Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::EventBusClient eventBus )
-    : m_networkConfiguration( networkConfig )
-    , m_eventBusClient( eventBus )
-    , m_workerThreadPaused( false )
-{
-    blog::database( FMTX("sqlite version {}"), SQLITE_VERSION );
+    void invalidateJam( const types::JamCouchID& jamCID )
+    {
+        {
+            std::scoped_lock<std::mutex> indexLock( m_mutex );
+            if ( !m_built )
+                return;
+            m_dirtyJams.emplace( jamCID );
+        }
+        m_wakeWorker();
+    }
 
-    // create the lockless queues that manages the warehouse TODO list
+    void invalidateAll()
     {
-        m_taskSchedule = std::make_unique<TaskSchedule>();
-        m_taskSchedule->signal();
-        m_taskSchedulePriority = std::make_unique<TaskSchedule>();
+        bool rebuild;
+        {
+            std::scoped_lock<std::mutex> indexLock( m_mutex );
+            m_built = false;
+            m_contents = {};
+            m_dirtyJams.clear();
+
+            rebuild = m_buildRequested;
+        }
+        if ( rebuild )
+            m_wakeWorker();
     }
 
-    m_databaseFile = ( storagePaths.cacheCommon / "warehouse.db3" ).string();
-    SqlDB::post_connection_hook = []( sqlite3* db_handle )
+    // worker thread; build the index if it has been asked for, otherwise re-read any jams that changed since last time
+    void update()
     {
-        blog::database( FMTX( "post_connection_hook( 0x{:x} )" ), (uint64_t)db_handle );
+        bool buildNow;
+        absl::flat_hash_set< types::JamCouchID > dirtyJams;
+        {
+            std::scoped_lock<std::mutex> indexLock( m_mutex );
+            buildNow = m_buildRequested && !m_built;
+            dirtyJams.swap( m_dirtyJams );
+        }
 
-        // https://www.sqlite.org/pragma.html#pragma_temp_store
-        sqlite3_exec( db_handle, "pragma temp_store = memory", nullptr, nullptr, nullptr );
+        if ( buildNow )
+        {
+            Contents newContents = buildContents();
+            {
+                std::scoped_lock<std::mutex> indexLock( m_mutex );
+                m_contents = std::move( newContents );
+                m_built = true;
+            }
+            m_builtCVar.notify_all();
+            return;
+        }
 
-        // add our RANDOM variant that takes a seed to allow for deterministic random queries
-        int32_t seededRes = sqlite3_create_function( db_handle, "SEEDED_RANDOM", 1, SQLITE_UTF8, NULL, &sqlite_SEEDED_RANDOM, NULL, NULL );
-        blog::database( FMTX( "sqlite3_create_function(SEEDED_RANDOM) = {} ({})" ), seededRes == SQLITE_OK ? "OK" : "Error", seededRes );
-        
-        // bolt in carray extension
-        int32_t carrayRes = sqlite3_carray_init( db_handle, nullptr, nullptr );
-        blog::database( FMTX( "sqlite3_carray_init = {} ({})" ), carrayRes == SQLITE_OK ? "OK" : "Error", carrayRes );
-    };
+        for ( const auto& jamCID : dirtyJams )
+        {
+            if ( jamCID.value() == cVirtualJamName )
+                continue;
 
-    // set the database up; creating tables & indices if we're starting fresh
-    {
-        Warehouse::SqlDB::TransactionGuard txn;
+            const std::vector< JamRow > jamRows = readJam( jamCID );
 
-        sql::jams::runInit();
-        sql::riffs::runInit();
-        sql::tags::runInit();
-        sql::stems::runInit();
-        sql::ledger::runInit();
+            std::scoped_lock<std::mutex> indexLock( m_mutex );
+            if ( m_built )
+                m_contents.replaceJam( jamCID, jamRows );
+        }
     }
 
-
-    // optimize on startup
+    // choose `count` riffs at the given BPM from any of the given root/scale keys; picks are independent, with
+    // replacement, so a small bucket still fills every slot (the same riff may come back more than once) just as the
+    // per-slot SQL queries this replaced did. the same seed against the same database contents always produces the
+    // same list. returns the number of riffs written to `result`, 0 if there were no candidates
+    std::size_t sample(
+        const absl::InlinedVector< int32_t, 16 >& rootScales,
+        const uint32_t bpm,
+        const int32_t seedValue,
+        const std::size_t count,
+        std::vector< types::RiffCouchID >& result )
     {
-        spacetime::ScopedTimer stemTiming( "warehouse [optimize]" );
-        static constexpr char sqlOptimize[] = R"(pragma optimize;)";
-        SqlDB::query<sqlOptimize>();
-    }
+        std::unique_lock<std::mutex> indexLock( m_mutex );
 
-    m_workerThreadAlive = true;
-    m_workerThread      = std::make_unique<std::thread>( &Warehouse::threadWorker, this );
+        result.clear();
 
-    APP_EVENT_BIND_TO( RiffTagAction );
+        if ( !m_built )
+        {
+            if ( !m_buildRequested )
+            {
+                m_buildRequested = true;
+                m_wakeWorker();
+            }
+            if ( !m_builtCVar.wait_for( indexLock, cBuildTimeout, [this]() { return m_built; } ) )
+            {
+                blog::error::database( FMTX( "similarity index was not built within {}s, no riffs sampled" ), cBuildTimeout.count() );
+                return 0;
+            }
+        }
 
-#if OURO_PLATFORM_WIN
-    ::SetThreadPriority( m_workerThread->native_handle(), THREAD_PRIORITY_BELOW_NORMAL );
-#endif
-}
+        // gather the candidate buckets in a stable order, skipping duplicate keys from overlapping harmonic rules
+        absl::InlinedVector< const std::vector< EntryRef >*, 16 > candidateBuckets;
+        absl::InlinedVector< BucketKey, 16 > candidateKeys;
+        std::size_t totalCandidates = 0;
+        for ( const int32_t rootScale : rootScales )
+        {
+            const BucketKey key = makeKey( bpm, rootScale );
+            if ( absl::c_linear_search( candidateKeys, key ) )
+                continue;
+            candidateKeys.emplace_back( key );
 
-// ---------------------------------------------------------------------------------------------------------------------
-Warehouse::~Warehouse()
-{
-    APP_EVENT_UNBIND( RiffTagAction );
+            const auto bucketIt = m_contents.m_buckets.find( key );
+            if ( bucketIt == m_contents.m_buckets.end() || bucketIt->second.empty() )
+                continue;
 
-    m_workerThreadAlive = false;
+            candidateBuckets.emplace_back( &bucketIt->second );
+            totalCandidates += bucketIt->second.size();
+        }
 
-    // unblock the thread, wait for it to die out
-    m_taskSchedule->signal();
-    m_workerThread->join();
-    m_workerThread.reset();
-}
+        if ( totalCandidates == 0 || count == 0 )
+            return 0;
 
-// ---------------------------------------------------------------------------------------------------------------------
-void Warehouse::setCallbackWorkReport( const WorkUpdateCallback& cb )
-{
-    {
-        std::scoped_lock<std::mutex> cbLock( m_cbMutex );
-        m_cbWorkUpdateToInstall = cb;
-    }
-    m_taskSchedule->signal();
-}
+        math::RNG32 rng( static_cast<uint32_t>( seedValue ) );
+
+        // map flat candidate indices back through the buckets to riff IDs
+        result.reserve( count );
+        for ( std::size_t pickI = 0; pickI < count; pickI++ )
+        {
+            std::size_t flatIndex = rng.genUInt32() % totalCandidates;
+            for ( const auto* bucket : candidateBuckets )
+            {
+                if ( flatIndex < bucket->size() )
+                {
+                    result.emplace_back( m_contents.resolve( (*bucket)[flatIndex] ) );
+                    break;
+                }
+                flatIndex -= bucket->size();
+            }
+        }
+
+        return result.size();
+    }
+
+    // every root/scale combination, for searches that ignore harmonic rules
+    static const absl::InlinedVector< int32_t, 16 >& allRootScales()
+    {
+        static const absl::InlinedVector< int32_t, 16 > everyRootScale = []()
+        {
+            absl::InlinedVector< int32_t, 16 > result;
+            for ( int32_t root = 0; root < static_cast<int32_t>( endlesss::constants::cRootNames.size() ); root++ )
+                for ( int32_t scale = 0; scale < static_cast<int32_t>( endlesss::constants::cScaleNames.size() ); scale++ )
+                    result.emplace_back( ( root << 8 ) | scale );
+            return result;
+        }();
+        return everyRootScale;
+    }
+
+private:
+
+    struct JamRow
+    {
+        types::RiffCouchID  m_riff;
+        BucketKey           m_key;
+    };
+
+    struct JamEntries
+    {
+        std::vector< types::RiffCouchID >   m_riffs;
+        std::vector< BucketKey >            m_keys;
+    };
+
+    static constexpr EntryRef makeRef( const uint32_t jamSlot, const uint32_t riffIndex )
+    {
+        return ( static_cast<uint64_t>( jamSlot ) << 32 ) | riffIndex;
+    }
+
+    // everything a sample reads; built or patched by the worker, then moved in under the lock
+    struct Contents
+    {
+        const types::RiffCouchID& resolve( const EntryRef ref ) const
+        {
+            return m_jams[ static_cast<uint32_t>( ref >> 32 ) ].m_riffs[ static_cast<uint32_t>( ref & 0xFFFFFFFF ) ];
+        }
+
+        void sortBucket( std::vector< EntryRef >& bucket ) const
+        {
+            std::sort( bucket.begin(), bucket.end(), [this]( const EntryRef lhs, const EntryRef rhs )
+                {
+                    return resolve( lhs ).value() < resolve( rhs ).value();
+                });
+        }
+
+        uint32_t getJamSlot( const types::JamCouchID& jamCID )
+        {
+            const auto slotIt = m_jamSlots.find( jamCID );
+            if ( slotIt != m_jamSlots.end() )
+                return slotIt->second;
+
+            const uint32_t newSlot = static_cast<uint32_t>( m_jams.size() );
+            m_jams.emplace_back();
+            m_jamSlots.emplace( jamCID, newSlot );
+            return newSlot;
+        }
+
+        void addRow( const uint32_t jamSlot, const JamRow& row )
+        {
+            JamEntries& entries = m_jams[jamSlot];
+
+            m_buckets[row.m_key].emplace_back( makeRef( jamSlot, static_cast<uint32_t>( entries.m_riffs.size() ) ) );
+            entries.m_riffs.emplace_back( row.m_riff );
+            entries.m_keys.emplace_back( row.m_key );
+        }
+
+        // swap out everything a jam contributed for a fresh read of its rows
+        void replaceJam( const types::JamCouchID& jamCID, const std::vector< JamRow >& jamRows )
+        {
+            const uint32_t jamSlot = getJamSlot( jamCID );
+            JamEntries& entries = m_jams[jamSlot];
+
+            // pull this jam out of every bucket it contributed to
+            absl::flat_hash_set< BucketKey > touchedKeys( entries.m_keys.begin(), entries.m_keys.end() );
+            for ( const BucketKey key : touchedKeys )
+            {
+                auto& bucket = m_buckets[key];
+                std::erase_if( bucket, [jamSlot]( const EntryRef ref ) { return static_cast<uint32_t>( ref >> 32 ) == jamSlot; } );
+            }
+            entries.m_riffs.clear();
+            entries.m_keys.clear();
+
+            // .. and add back whatever it has now
+            for ( const JamRow& row : jamRows )
+            {
+                addRow( jamSlot, row );
+                touchedKeys.emplace( row.m_key );
+            }
+
+            for ( const BucketKey key : touchedKeys )
+                sortBucket( m_buckets[key] );
+        }
+
+        std::vector< JamEntries >                               m_jams;
+        absl::flat_hash_map< types::JamCouchID, uint32_t >      m_jamSlots;
+        absl::flat_hash_map< BucketKey, std::vector< EntryRef > > m_buckets;
+    };
+
+    static Contents buildContents()
+    {
+        static constexpr char _sqlAllRiffs[] = R"(
+            select OwnerJamCID,
+                   RiffCID,
+                   cast( round( BPMrnd ) as integer ),
+                   ( ( Root << 8 ) | Scale )
+            from RiffProjection
+            where OwnerJamCID is not ?1 and BPMrnd is not null;
+        )";
+
+        spacetime::ScopedTimer buildTiming( "warehouse [similarity index build]" );
+
+        Contents contents;
+        {
+            Warehouse::SqlDB::TransactionGuard txn;
+            auto query = Warehouse::SqlDB::query<_sqlAllRiffs>( cVirtualJamName.data() );
+
+            std::string_view jamCID;
+            std::string_view riffCID;
+            int64_t bpm;
+            int32_t rootScale;
+
+            types::JamCouchID lastJamCID;
+            uint32_t lastJamSlot = 0;
+            while ( query( jamCID, riffCID, bpm, rootScale ) )
+            {
+                if ( lastJamCID.value() != jamCID )
+                {
+                    lastJamCID  = types::JamCouchID{ jamCID };
+                    lastJamSlot = contents.getJamSlot( lastJamCID );
+                }
+
+                contents.addRow( lastJamSlot, JamRow{ types::RiffCouchID{ riffCID }, makeKey( static_cast<uint32_t>( bpm ), rootScale ) } );
+            }
+        }
+
+        for ( auto& bucket : contents.m_buckets )
+            contents.sortBucket( bucket.second );
+
+        blog::database( FMTX( "similarity index built; {} jams, {} buckets" ), contents.m_jams.size(), contents.m_buckets.size() );
+        return contents;
+    }
+
+    static std::vector< JamRow > readJam( const types::JamCouchID& jamCID )
+    {
+        static constexpr char _sqlJamRiffs[] = R"(
+            select RiffCID,
+                   cast( round( BPMrnd ) as integer ),
+                   ( ( Root << 8 ) | Scale )
+            from RiffProjection
+            where OwnerJamCID is ?1 and BPMrnd is not null;
+        )";
+
+        std::vector< JamRow > jamRows;
+
+        Warehouse::SqlDB::TransactionGuard txn;
+        auto query = Warehouse::SqlDB::query<_sqlJamRiffs>( jamCID.value() );
+
+        std::string_view riffCID;
+        int64_t bpm;
+        int32_t rootScale;
+
+        while ( query( riffCID, bpm, rootScale ) )
+            jamRows.emplace_back( JamRow{ types::RiffCouchID{ riffCID }, makeKey( static_cast<uint32_t>( bpm ), rootScale ) } );
+
+        return jamRows;
+    }
+
+    const WakeWorkerFn                                      m_wakeWorker;
+
+    std::mutex                                              m_mutex;
+    std::condition_variable                                 m_builtCVar;
+    bool                                                    m_buildRequested = false;   // set by the first sample()
+    bool                                                    m_built = false;
+
+    Contents                                                m_contents;
+    absl::flat_hash_set< types::JamCouchID >                m_dirtyJams;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+Warehouse::Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::WorkScheduler& workScheduler, base::EventBusClient eventBus )
+    : m_networkConfiguration( networkConfig )
+    , m_workScheduler( workScheduler )
+    , m_eventBusClient( eventBus )
+    , m_workerThreadPaused( false )
+{
+    blog::database( FMTX("sqlite version {}"), SQLITE_VERSION );
+
+    // create the lockless queues that manages the warehouse TODO list
+    {
+        m_taskSchedule = std::make_unique<TaskSchedule>();
+        m_taskSchedule->signal();
+        m_taskSchedulePriority = std::make_unique<TaskSchedule>();
+    }
+
+    m_jamSliceCache = std::make_unique<JamSliceCache>();
+    m_riffSimilarityIndex = std::make_unique<RiffSimilarityIndex>( [this]() { m_taskSchedule->signal(); } );
+
+    m_databaseFile = ( storagePaths.cacheCommon / "warehouse.db3" ).string();
+    SqlDB::post_connection_hook = []( sqlite3* db_handle )
+    {
+        blog::database( FMTX( "post_connection_hook( 0x{:x} )" ), (uint64_t)db_handle );
+
+        // https://www.sqlite.org/pragma.html#pragma_temp_store
+        sqlite3_exec( db_handle, "pragma temp_store = memory", nullptr, nullptr, nullptr );
+
+        // bolt in carray extension
+        int32_t carrayRes = sqlite3_carray_init( db_handle, nullptr, nullptr );
+        blog::database( FMTX( "sqlite3_carray_init = {} ({})" ), carrayRes == SQLITE_OK ? "OK" : "Error", carrayRes );
+    };
+
+    // set the database up; creating tables & indices if we're starting fresh
+    {
+        Warehouse::SqlDB::TransactionGuard txn;
+
+        sql::jams::runInit();
+        sql::riffs::runInit();
+        sql::tags::runInit();
+        sql::stems::runInit();
+        sql::ledger::runInit();
+        sql::projection::runInit();
+    }
+
+
+    // optimize on startup
+    {
+        spacetime::ScopedTimer stemTiming( "warehouse [optimize]" );
+        static constexpr char sqlOptimize[] = R"(pragma optimize;)";
+        SqlDB::query<sqlOptimize>();
+    }
+
+    m_workerThreadAlive = true;
+    m_workerThread      = std::make_unique<std::thread>( &Warehouse::threadWorker, this );
+
+#if OURO_DEBUG
+    // full consistency pass on the riff projection; too slow on large databases to do on every release launch
+    requestProjectionValidation();
+#endif // OURO_DEBUG
+
+    APP_EVENT_BIND_TO( RiffTagAction );
+
+#if OURO_PLATFORM_WIN
+    ::SetThreadPriority( m_workerThread->native_handle(), THREAD_PRIORITY_BELOW_NORMAL );
+#endif
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Warehouse::~Warehouse()
+{
+    APP_EVENT_UNBIND( RiffTagAction );
+
+    m_workerThreadAlive = false;
+    m_workCancellation.cancel();
+
+    // unblock the thread, wait for it to die out
+    m_taskSchedule->signal();
+    m_workerThread->join();
+    m_workerThread.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::setCallbackWorkReport( const WorkUpdateCallback& cb )
+{
+    {
+        std::scoped_lock<std::mutex> cbLock( m_cbMutex );
+        m_cbWorkUpdateToInstall = cb;
+    }
+    m_taskSchedule->signal();
+}
 
 // ---------------------------------------------------------------------------------------------------------------------
 void Warehouse::setCallbackContentsReport( const ContentsReportCallback& cb )
@@ -1386,7 +2146,13 @@ void Warehouse::addJamSliceRequest( const types::JamCouchID& jamCouchID, const J
         return;
     }
 
-    m_taskSchedule->enqueueWorkTask<JamSliceTask>( jamCouchID, callbackOnCompletion );
+    m_taskSchedule->enqueueWorkTask<JamSliceTask>( *m_jamSliceCache, jamCouchID, getChangeIndexForJam( jamCouchID ), callbackOnCompletion );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::requestProjectionValidation()
+{
+    m_taskSchedule->enqueueWorkTask<ProjectionValidateTask>( *m_jamSliceCache, *m_riffSimilarityIndex );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -1445,7 +2211,7 @@ base::OperationID Warehouse::requestJamDataExport( const types::JamCouchID& jamC
         return base::OperationID::invalid();
     }
 
-    m_taskSchedule->enqueueWorkTask<JamExportTask>( m_eventBusClient, jamCouchID, exportFolder, jamTitle, operationID );
+    m_taskSchedule->enqueueWorkTask<JamExportTask>( m_eventBusClient, m_archiveDictionary, jamCouchID, exportFolder, jamTitle, operationID );
 
     return operationID;
 }
@@ -1455,11 +2221,26 @@ base::OperationID Warehouse::requestJamDataImport( const fs::path pathToData )
 {
     const auto operationID = base::Operations::newID( OV_ImportAction );
 
-    m_taskSchedule->enqueueWorkTask<JamImportTask>( m_eventBusClient, pathToData, operationID );
+    m_taskSchedule->enqueueWorkTask<JamImportTask>( m_eventBusClient, m_archiveDictionary, pathToData, operationID );
 
     return operationID;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Warehouse::loadArchiveCompressionDictionary( const fs::path& dictionaryFile )
+{
+    auto dictionary = std::make_shared<archive::CompressionDictionary>();
+
+    const auto loadStatus = dictionary->load( dictionaryFile, 9 );
+    if ( !loadStatus.ok() )
+        return loadStatus;
+
+    blog::database( FMTX( "using archive compression dictionary {:x} from [{}]" ), dictionary->getID(), dictionaryFile.string() );
+
+    m_archiveDictionary = std::move( dictionary );
+    return absl::OkStatus();
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool Warehouse::fetchSingleRiffByID( const endlesss::types::RiffCouchID& riffID, endlesss::types::RiffComplete& result ) const
 {
@@ -1673,96 +2454,66 @@ std::size_t Warehouse::filterRiffsByBPM( const endlesss::constants::RootScalePai
 // ---------------------------------------------------------------------------------------------------------------------
 bool Warehouse::fetchRandomRiffBySeed( const endlesss::constants::RootScalePairs& keySearchPairs, const uint32_t BPM, const int32_t seedValue, endlesss::types::RiffComplete& result ) const
 {
-    static constexpr char _randomFilteredRiff[] = R"(
-            select 
-              round(BPMrnd) as BPM,
-              ( ( root << 8 ) | scale ) as rootScale,
-              RiffCID 
-            from 
-              riffs 
-            where 
-              rootScale in carray( ?1, ?2 )
-              and BPM = ?3
-              and (OwnerJamCID is not ?4) 
-            order by 
-              SEEDED_RANDOM(?5) 
-            limit 
-              1
-        )";
-    static constexpr char _randomFilteredRiff_NoRules[] = R"(
-            select 
-              round(BPMrnd) as BPM,
-              RiffCID 
-            from 
-              riffs 
-            where 
-              BPM = ?1
-              and (OwnerJamCID is not ?2) 
-            order by 
-              SEEDED_RANDOM(?3) 
-            limit 
-              1
-        )";
-
+    std::vector< endlesss::types::RiffComplete > results;
+    if ( fetchRandomRiffsBySeed( keySearchPairs, BPM, seedValue, 1, results ) == 0 )
+        return false;
 
-    if ( keySearchPairs.searchMode == endlesss::constants::HarmonicSearch::NoRules )
-    {
-        Warehouse::SqlDB::TransactionGuard txn;
+    result = std::move( results.front() );
+    return true;
+}
 
-        auto query = Warehouse::SqlDB::query<_randomFilteredRiff_NoRules>( BPM, cVirtualJamName.data(), seedValue );
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t Warehouse::fetchRandomRiffsBySeed( const endlesss::constants::RootScalePairs& keySearchPairs, const uint32_t BPM, const int32_t seedValue, const std::size_t count, std::vector< endlesss::types::RiffComplete >& results ) const
+{
+    results.clear();
 
-        float bpmRange;
-        std::string_view riffCID;
+    std::vector< endlesss::types::RiffCouchID > chosenRiffIDs;
 
-        if ( query( bpmRange, riffCID ) )
-        {
-            return fetchSingleRiffByID( endlesss::types::RiffCouchID{ riffCID }, result );
-        }
+    if ( keySearchPairs.searchMode == endlesss::constants::HarmonicSearch::NoRules )
+    {
+        m_riffSimilarityIndex->sample( RiffSimilarityIndex::allRootScales(), BPM, seedValue, count, chosenRiffIDs );
     }
     else
     {
         absl::InlinedVector< int32_t, 16 > rootScaleHashList;
 
-        // create the merged root/scale values to pass in as a search list, matching how they are encoded in the SQL : ((root << 8) | scale)
+        // create the merged root/scale values to search with, matching how they are encoded in the SQL : ((root << 8) | scale)
         for ( const auto rspair : keySearchPairs.pairs )
         {
             const int32_t rshash = (rspair.root << 8) | rspair.scale;
             rootScaleHashList.emplace_back( rshash );
         }
 
-        const int32_t* rootScalePtr = rootScaleHashList.data();
-        const int32_t rootScaleCount = static_cast<int32_t>(rootScaleHashList.size());
+        m_riffSimilarityIndex->sample( rootScaleHashList, BPM, seedValue, count, chosenRiffIDs );
+    }
 
-#if 0
-        for ( const auto& paired : keySearchPairs.pairs )
-        {
-            blog::database( FMTX( "fetchRandomRiffBySeed | {} {}" ),
-                endlesss::constants::cRootNames[paired.root],
-                endlesss::constants::cScaleNames[paired.scale] );
-        }
-        blog::database( FMTX( "                      | {} | {} {}" ),
-            rshash,
-            endlesss::constants::cRootNames[rspair.root],
-            endlesss::constants::cScaleNames[rspair.scale] );
-#endif
+    if ( chosenRiffIDs.empty() )
+        return 0;
 
-        {
-            Warehouse::SqlDB::TransactionGuard txn;
+    // bring all the chosen riffs online in one go
+    {
+        Warehouse::SqlDB::TransactionGuard txn;
 
-            auto query = Warehouse::SqlDB::query<_randomFilteredRiff>( rootScalePtr, rootScaleCount, BPM, cVirtualJamName.data(), seedValue );
+        results.reserve( chosenRiffIDs.size() );
+        for ( const auto& riffID : chosenRiffIDs )
+        {
+            // picks can repeat; copy anything we already pulled out rather than going back to the database
+            const auto fetchedIt = std::find_if( results.begin(), results.end(), [&riffID]( const endlesss::types::RiffComplete& fetched )
+                {
+                    return fetched.riff.couchID == riffID;
+                });
 
-            float bpmRange;
-            int32_t _hash;
-            std::string_view riffCID;
+            endlesss::types::RiffComplete riffComplete;
+            if ( fetchedIt != results.end() )
+                riffComplete = *fetchedIt;
+            else if ( !fetchSingleRiffByID( riffID, riffComplete ) )
+                continue;
 
-            if ( query( bpmRange, _hash, riffCID ) )
-            {
-                return fetchSingleRiffByID( endlesss::types::RiffCouchID{ riffCID }, result );
-            }
+            results.emplace_back( std::move( riffComplete ) );
         }
     }
 
-    return false;
+    return results.size();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -2132,6 +2883,9 @@ void Warehouse::threadWorker()
 
         checkLockAndInstallNewCallbacks();
 
+        // keep the procedural tools' riff index current; reads only, so carries on even while paused
+        m_riffSimilarityIndex->update();
+
         // cycle round if paused
         if ( m_workerThreadPaused )
         {
@@ -2156,6 +2910,12 @@ void Warehouse::threadWorker()
             const auto taskDescription = nextTask->Describe();
             blog::database( taskDescription );
             {
+                // take our turn against the rest of the background work; interactive riff loads go first. only
+                // refused when we're shutting down, in which case the task is abandoned with the rest of the queue
+                const auto syncSlot = m_workScheduler.acquireSlot( base::WorkScheduler::Lane::Sync, m_workCancellation );
+                if ( !syncSlot.isValid() )
+                    continue;
+
                 base::instr::ScopedEvent se( "TASK", nextTask->getTag(), base::instr::PresetColour::Indigo );
 
                 const bool taskOk = nextTask->Work( m_taskSchedule->m_taskQueue );
@@ -2291,6 +3051,8 @@ Warehouse::ChangeIndex Warehouse::getChangeIndexForJam( const endlesss::types::J
 // ---------------------------------------------------------------------------------------------------------------------
 void Warehouse::incrementChangeIndexForJam( const ::endlesss::types::JamCouchID& jamID )
 {
+    m_riffSimilarityIndex->invalidateJam( jamID );
+
     const auto cIt = m_changeIndexMap.find( jamID );
     if ( cIt == m_changeIndexMap.end() )
     {
@@ -2459,141 +3221,209 @@ bool JamSyncAbortTask::Work( TaskQueue& currentTasks )
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-// ref https://randomascii.wordpress.com/2012/03/08/float-precisionfrom-zero-to-100-digits-2/
-//     https://gcc.gnu.org/onlinedocs/gcc/Hex-Floats.html
-//
 bool JamExportTask::Work( TaskQueue& currentTasks )
 {
     OperationCompleteOnScopeExit( m_operationID );
 
-    const std::string exportFilenameYaml = Warehouse::createExportFilenameForJam( m_jamCID, m_jamName, "yaml" );
+    const std::string exportFilename = Warehouse::createExportFilenameForJam( m_jamCID, m_jamName, archive::cFileExtension );
 
-    const fs::path finalOutputFile = m_exportFolder / exportFilenameYaml;
+    const fs::path finalOutputFile = m_exportFolder / exportFilename;
     blog::database( FMTX( "Export process for [{}] to [{}]" ), m_jamName, finalOutputFile.string() );
 
-    std::ofstream yamlOutput;
-    {
-        yamlOutput.open( finalOutputFile );
-    }
-    {
-        yamlOutput << "export_time_unix: " << spacetime::getUnixTimeNow().count() << std::endl;
-        yamlOutput << "export_ouroveon_version: \"" << OURO_FRAMEWORK_VERSION << "\"" << std::endl;
-        yamlOutput << "jam_name: \"" << m_jamName << "\"" << std::endl;
-        yamlOutput << "jam_couch_id: \"" << m_jamCID.value() << "\"" << std::endl;
-    }
-    {
-        // get a list of all the riff IDs for this jam, we decode each one in turn
-        static constexpr char getAllRiffIDs[] = R"( select RiffCID from riffs where OwnerJamCID = ?1 order by CreationTime asc; )";
-        auto query = Warehouse::SqlDB::query<getAllRiffIDs>( m_jamCID.value() );
+    auto handleFailure = [this]( const absl::Status& failureStatus ) -> bool
+        {
+            blog::error::database( FMTX( "Failed to export jam data for [{}] : {}" ), m_jamName, failureStatus.ToString() );
 
-        std::string_view riffCID;
+            m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
+                ICON_FA_BOX " Jam Export Error",
+                failureStatus.ToString() );
 
-        std::string riffEntryLine;
+            return true;
+        };
 
-        yamlOutput << "# riffs schema" << std::endl;
-        yamlOutput << "# couch ID, user, creation unix time, root index, root name, scale index, scale name, BPS (float), BPS (hex float), BPM (float), BPM (hex float), bar length, 8x [ stem couch ID, stem gain (float), stem gain (hex float), stem enabled ], app version" << std::endl;
-        yamlOutput << "riffs:" << std::endl;
-        while ( query( riffCID ) )
-        {
-            // decode an ID into a riff data block
-            const endlesss::types::RiffCouchID riffCouchID( riffCID );
-            endlesss::types::Riff riffData;
+    archive::Header archiveHeader;
+    archiveHeader.m_exportTimeUnix      = spacetime::getUnixTimeNow().count();
+    archiveHeader.m_exportOuroVersion   = OURO_FRAMEWORK_VERSION;
+    archiveHeader.m_jamName             = m_jamName;
+    archiveHeader.m_jamCouchID          = m_jamCID;
 
-            if ( sql::riffs::getSingleByID( riffCouchID, riffData ) )
-            {
-                riffEntryLine = fmt::format( FMTX( " \"{}\": [\"{}\", {}, {}, \"{}\", {}, \"{}\", {:.9g}, \"{:a}\", {:.9g}, \"{:a}\", {}, {}, " ),
-                    riffData.couchID,
-                    riffData.user,
-                    riffData.creationTimeUnix,
-                    riffData.root,
-                    endlesss::constants::cRootNames[riffData.root],
-                    riffData.scale,
-                    endlesss::constants::cScaleNamesFilenameSanitize[riffData.scale],
-                    riffData.BPS,
-                    riffData.BPS,
-                    riffData.BPMrnd,
-                    riffData.BPMrnd,
-                    riffData.barLength,
-                    riffData.appVersion );
-
-                for ( int32_t stemI = 0; stemI < 8; stemI++ )
-                {
-                    riffEntryLine += fmt::format( FMTX( "[\"{}\", {:.9g}, \"{:a}\", {}], " ),
-                        riffData.stems[stemI],
-                        riffData.gains[stemI],
-                        riffData.gains[stemI],
-                        riffData.stemsOn[stemI] );
-                }
+    archive::Writer archiveWriter( m_dictionary );
+    if ( const auto openStatus = archiveWriter.open( finalOutputFile, archiveHeader ); !openStatus.ok() )
+        return handleFailure( openStatus );
 
-                yamlOutput << riffEntryLine << std::setprecision( 9 ) << riffData.magnitude << " ]" << std::endl;
-            }
-            else
-            {
-                m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
-                    ICON_FA_BOX " Jam Export Error",
-                    fmt::format( FMTX( "Unable to decode [R:{}] from database" ), riffCID ) );
-            }
-        }
-    }
-    {
-        // similar process for the stems
-        static constexpr char getAllStemsIDs[] = R"( select StemCID from stems where OwnerJamCID = ?1 order by CreationTime asc; )";
-        auto query = Warehouse::SqlDB::query<getAllStemsIDs>( m_jamCID.value() );
+    // riffs that can't go into the archive are skipped and reported once at the end; those still waiting for their
+    // full data to sync are expected and harmless, rows whose gains won't decode point at a damaged database
+    std::size_t unsyncedRows    = 0;
+    std::size_t undecodableRows = 0;
 
-        std::string_view stemCID;
-
-        std::string stemEntryLine;
+    {
+        // stream every riff for this jam in a single pass rather than re-querying per riff ID
+        static constexpr char getAllRiffs[] = R"(
+            SELECT
+                RiffCID,
+                CreationTime,
+                Root,
+                Scale,
+                BPS,
+                BPMrnd,
+                BarLength,
+                AppVersion,
+                Magnitude,
+                UserName,
+                StemCID_1,
+                StemCID_2,
+                StemCID_3,
+                StemCID_4,
+                StemCID_5,
+                StemCID_6,
+                StemCID_7,
+                StemCID_8,
+                GainsJSON
+            FROM riffs
+            WHERE OwnerJamCID = ?1 
+            ORDER BY CreationTime ASC;
+        )";
+        auto query = Warehouse::SqlDB::query<getAllRiffs>( m_jamCID.value() );
 
-        yamlOutput << "# stems schema" << std::endl;
-        yamlOutput << "# couch ID, file endpoint, file bucket, file key, file MIME, file length in bytes, sample rate, creation unix time, preset, user, colour hex, BPS (float), BPS (hex float), BPM (float), BPM (hex float), length 16ths, original pitch, bar length, is-drum, is-note, is-bass, is-mic" << std::endl;
-        yamlOutput << "stems:" << std::endl;
-        while ( query( stemCID ) )
+        std::string_view riffCID;
+        std::array< std::string_view, 8 > stemCIDs;
+        std::string_view gainsJson;
+
+        endlesss::types::Riff riffData;
+        riffData.jamCouchID = m_jamCID;
+
+        while ( query( riffCID,
+                       riffData.creationTimeUnix,
+                       riffData.root,
+                       riffData.scale,
+                       riffData.BPS,
+                       riffData.BPMrnd,
+                       riffData.barLength,
+                       riffData.appVersion,
+                       riffData.magnitude,
+                       riffData.user,
+                       stemCIDs[0],
+                       stemCIDs[1],
+                       stemCIDs[2],
+                       stemCIDs[3],
+                       stemCIDs[4],
+                       stemCIDs[5],
+                       stemCIDs[6],
+                       stemCIDs[7],
+                       gainsJson ) )
         {
-            // decode an ID into a stem data block
-            const endlesss::types::StemCouchID stemCouchID( stemCID );
-            endlesss::types::Stem stemData;
-
-            if ( sql::stems::getSingleStemByID( stemCouchID, stemData ) )
+            if ( gainsJson.empty() )
             {
-                stemEntryLine = fmt::format( FMTX( " \"{}\": [\"{}\", \"{}\", \"{}\", \"{}\", {}, {}, {}, \"{}\", \"{}\", \"{}\", {:.9g}, \"{:a}\", {:.9g}, \"{:a}\", {}, {}, {}, {}, {}, {}, {}]" ),
-                    stemData.couchID,
-                    stemData.fileEndpoint,
-                    stemData.fileBucket,
-                    stemData.fileKey,
-                    stemData.fileMIME,
-                    stemData.fileLengthBytes,
-                    stemData.sampleRate,
-                    stemData.creationTimeUnix,
-                    stemData.preset,
-                    stemData.user,
-                    stemData.colour,
-                    stemData.BPS,
-                    stemData.BPS,
-                    stemData.BPMrnd,
-                    stemData.BPMrnd,
-                    stemData.length16s,
-                    stemData.originalPitch,
-                    stemData.barLength,
-                    stemData.isDrum,
-                    stemData.isNote,
-                    stemData.isBass,
-                    stemData.isMic
-                );
-
-                yamlOutput << stemEntryLine << std::endl;
+                blog::database( FMTX( "[{}] skipping [R:{}], riff data not yet synced" ), Tag, riffCID );
+                unsyncedRows++;
+                continue;
             }
-            else
+            if ( !sql::riffs::decodeGainsJson( gainsJson, riffData.gains ) )
+            {
+                blog::error::database( FMTX( "[{}] skipping [R:{}], unable to decode gains [{}]" ), Tag, riffCID, gainsJson );
+                undecodableRows++;
+                continue;
+            }
+
+            riffData.couchID = endlesss::types::RiffCouchID{ riffCID };
+            for ( size_t stemI = 0; stemI < 8; stemI++ )
             {
-                m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
-                    ICON_FA_BOX " Jam Export Error",
-                    fmt::format( FMTX( "Unable to decode [S:{}] from database" ), stemCID ) );
+                riffData.stems[stemI]   = endlesss::types::StemCouchID{ stemCIDs[stemI] };
+                riffData.stemsOn[stemI] = !stemCIDs[stemI].empty();
             }
+
+            if ( const auto appendStatus = archiveWriter.appendRiff( riffData ); !appendStatus.ok() )
+                return handleFailure( appendStatus );
         }
     }
+    {
+        // similar process for the stems
+        static constexpr char getAllStems[] = R"(
+            SELECT
+                StemCID,
+                CreationTime,
+                FileEndpoint,
+                FileBucket,
+                FileKey,
+                FileMIME,
+                FileLength,
+                BPS,
+                BPMrnd,
+                Instrument,
+                Length16s,
+                OriginalPitch,
+                BarLength,
+                PresetName,
+                CreatorUserName,
+                SampleRate,
+                PrimaryColour
+            FROM stems
+            WHERE OwnerJamCID = ?1 
+            ORDER BY CreationTime ASC;
+        )";
+        auto query = Warehouse::SqlDB::query<getAllStems>( m_jamCID.value() );
+
+        std::string_view stemCID;
+        int32_t instrumentFlags;
+
+        endlesss::types::Stem stemData;
+        stemData.jamCouchID = m_jamCID;
+
+        while ( query( stemCID,
+                       stemData.creationTimeUnix,
+                       stemData.fileEndpoint,
+                       stemData.fileBucket,
+                       stemData.fileKey,
+                       stemData.fileMIME,
+                       stemData.fileLengthBytes,
+                       stemData.BPS,
+                       stemData.BPMrnd,
+                       instrumentFlags,
+                       stemData.length16s,
+                       stemData.originalPitch,
+                       stemData.barLength,
+                       stemData.preset,
+                       stemData.user,
+                       stemData.sampleRate,
+                       stemData.colour ) )
+        {
+            stemData.couchID = endlesss::types::StemCouchID{ stemCID };
+
+            stemData.isDrum = (instrumentFlags & (1 << 1)) == (1 << 1);
+            stemData.isNote = (instrumentFlags & (1 << 2)) == (1 << 2);
+            stemData.isBass = (instrumentFlags & (1 << 3)) == (1 << 3);
+            stemData.isMic  = (instrumentFlags & (1 << 4)) == (1 << 4);
+
+            if ( const auto appendStatus = archiveWriter.appendStem( stemData ); !appendStatus.ok() )
+                return handleFailure( appendStatus );
+        }
+    }
+
+    if ( const auto finishStatus = archiveWriter.finish(); !finishStatus.ok() )
+        return handleFailure( finishStatus );
+
+    blog::database( FMTX( "Exported {} riffs, {} stems ({} unsynced, {} undecodable skipped)" ),
+        archiveWriter.getRiffCount(),
+        archiveWriter.getStemCount(),
+        unsyncedRows,
+        undecodableRows );
+
+    if ( undecodableRows > 0 )
+    {
+        m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
+            ICON_FA_BOX " Jam Export Error",
+            fmt::format( FMTX( "{} riffs could not be decoded from the database and were not exported, see log for details" ), undecodableRows ) );
+    }
+    if ( unsyncedRows > 0 )
+    {
+        m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Info,
+            ICON_FA_BOX " Jam Export Note",
+            fmt::format( FMTX( "{} riffs not yet synced were left out; sync the jam and export again to include them" ), unsyncedRows ) );
+    }
 
     m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Info,
         ICON_FA_BOX " Jam Export Success",
-        fmt::format( FMTX( "Written to {}" ), exportFilenameYaml ) );
+        fmt::format( FMTX( "Written to {}" ), exportFilename ) );
 
     return true;
 }
@@ -2604,18 +3434,227 @@ bool JamImportTask::Work( TaskQueue& currentTasks )
 {
     OperationCompleteOnScopeExit( m_operationID );
 
-    auto loadStatus = base::readTextFile( m_fileToImport );
+    // older exports were written as YAML, still accept those
+    if ( base::StrToLwrExt( m_fileToImport.extension().string() ) == ".yaml" )
+        return importLegacyYaml();
 
-    auto handleFailure = [this]( const absl::Status& failureStatus ) -> bool
+    return importArchive();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool JamImportTask::handleFailure( const absl::Status& failureStatus )
+{
+    blog::error::database( FMTX( "Failed to import jam data from [{}]" ), m_fileToImport.string() );
+
+    m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
+        ICON_FA_BOX_OPEN " Jam Import Failed",
+        failureStatus.ToString() );
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool JamImportTask::importArchive()
+{
+    archive::Reader archiveReader( m_dictionary );
+    if ( const auto openStatus = archiveReader.open( m_fileToImport ); !openStatus.ok() )
+        return handleFailure( openStatus );
+
+    const archive::Header& archiveHeader = archiveReader.getHeader();
+    {
+        const auto exportTimeUnix = spacetime::InSeconds( std::chrono::seconds( archiveHeader.m_exportTimeUnix ) );
+        const auto exportTimeDelta = spacetime::calculateDeltaFromNow( exportTimeUnix ).asPastTenseString( 3 );
+
+        blog::database( FMTX( "Importing [{}] {}" ), archiveHeader.m_jamName, archiveHeader.m_jamCouchID );
+        blog::database( FMTX( "Export data from v.{}; {}" ), archiveHeader.m_exportOuroVersion, exportTimeDelta );
+    }
+    m_importedJamCID = archiveHeader.m_jamCouchID;
+
+    // single upserts replace the insert-or-ignore + update pairs used by the YAML path; ownership of
+    // existing rows is left untouched, matching the previous behaviour
+    static constexpr char upsertRiff[] = R"(
+        INSERT INTO riffs(
+            RiffCID,
+            OwnerJamCID,
+            CreationTime,
+            Root,
+            Scale,
+            BPS,
+            BPMrnd,
+            BarLength,
+            AppVersion,
+            Magnitude,
+            UserName,
+            StemCID_1,
+            StemCID_2,
+            StemCID_3,
+            StemCID_4,
+            StemCID_5,
+            StemCID_6,
+            StemCID_7,
+            StemCID_8,
+            GainsJSON ) VALUES( ?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15, ?16, ?17, ?18, ?19, ?20 )
+        ON CONFLICT(RiffCID) DO UPDATE SET
+            CreationTime=excluded.CreationTime,
+            Root=excluded.Root,
+            Scale=excluded.Scale,
+            BPS=excluded.BPS,
+            BPMrnd=excluded.BPMrnd,
+            BarLength=excluded.BarLength,
+            AppVersion=excluded.AppVersion,
+            Magnitude=excluded.Magnitude,
+            UserName=excluded.UserName,
+            StemCID_1=excluded.StemCID_1,
+            StemCID_2=excluded.StemCID_2,
+            StemCID_3=excluded.StemCID_3,
+            StemCID_4=excluded.StemCID_4,
+            StemCID_5=excluded.StemCID_5,
+            StemCID_6=excluded.StemCID_6,
+            StemCID_7=excluded.StemCID_7,
+            StemCID_8=excluded.StemCID_8,
+            GainsJSON=excluded.GainsJSON;
+    )";
+
+    static constexpr char upsertStem[] = R"(
+        INSERT INTO stems(
+            StemCID,
+            OwnerJamCID,
+            CreationTime,
+            FileEndpoint,
+            FileBucket,
+            FileKey,
+            FileMIME,
+            FileLength,
+            BPS,
+            BPMrnd,
+            Instrument,
+            Length16s,
+            OriginalPitch,
+            BarLength,
+            PresetName,
+            CreatorUserName,
+            SampleRate,
+            PrimaryColour ) VALUES( ?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15, ?16, ?17, ?18 )
+        ON CONFLICT(StemCID) DO UPDATE SET
+            CreationTime=excluded.CreationTime,
+            FileEndpoint=excluded.FileEndpoint,
+            FileBucket=excluded.FileBucket,
+            FileKey=excluded.FileKey,
+            FileMIME=excluded.FileMIME,
+            FileLength=excluded.FileLength,
+            BPS=excluded.BPS,
+            BPMrnd=excluded.BPMrnd,
+            Instrument=excluded.Instrument,
+            Length16s=excluded.Length16s,
+            OriginalPitch=excluded.OriginalPitch,
+            BarLength=excluded.BarLength,
+            PresetName=excluded.PresetName,
+            CreatorUserName=excluded.CreatorUserName,
+            SampleRate=excluded.SampleRate,
+            PrimaryColour=excluded.PrimaryColour;
+    )";
+
+    const std::string jamCouchID = archiveHeader.m_jamCouchID.value();
+
+    std::vector< types::Riff > riffBatch;
+    std::vector< types::Stem > stemBatch;
+    riffBatch.reserve( archive::cRowsPerBlock );
+    stemBatch.reserve( archive::cRowsPerBlock );
+
+    std::size_t totalRiffs = 0;
+    std::size_t totalStems = 0;
+
+    std::string gainsJsonText;
+
+    for ( ;; )
+    {
+        const auto blockStatus = archiveReader.readNextBlock( riffBatch, stemBatch );
+        if ( !blockStatus.ok() )
+            return handleFailure( blockStatus.status() );
+        if ( !blockStatus.value() )
+            break;
+
+        // each decoded block is committed as its own transaction
+        Warehouse::SqlDB::TransactionGuard txn;
+
+        for ( const types::Riff& riff : riffBatch )
         {
-            blog::error::database( FMTX( "Failed to import jam data from [{}]" ), m_fileToImport.string() );
+            gainsJsonText = fmt::format( R"([ {} ])", fmt::join( riff.gains, ", " ) );
+
+            Warehouse::SqlDB::query<upsertRiff>(
+                riff.couchID.value(),
+                jamCouchID,
+                riff.creationTimeUnix,
+                riff.root,
+                riff.scale,
+                riff.BPS,
+                riff.BPMrnd,
+                riff.barLength,
+                riff.appVersion,
+                riff.magnitude,
+                riff.user,
+                riff.stems[0].value(),
+                riff.stems[1].value(),
+                riff.stems[2].value(),
+                riff.stems[3].value(),
+                riff.stems[4].value(),
+                riff.stems[5].value(),
+                riff.stems[6].value(),
+                riff.stems[7].value(),
+                gainsJsonText
+            );
+        }
+        for ( const types::Stem& stem : stemBatch )
+        {
+            int32_t instrumentMask = 0;
+            if ( stem.isDrum )
+                instrumentMask |= 1 << 1;
+            if ( stem.isNote )
+                instrumentMask |= 1 << 2;
+            if ( stem.isBass )
+                instrumentMask |= 1 << 3;
+            if ( stem.isMic )
+                instrumentMask |= 1 << 4;
 
-            m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
-                ICON_FA_BOX_OPEN " Jam Import Failed",
-                failureStatus.ToString() );
+            Warehouse::SqlDB::query<upsertStem>(
+                stem.couchID.value(),
+                jamCouchID,
+                stem.creationTimeUnix,
+                stem.fileEndpoint,
+                stem.fileBucket,
+                stem.fileKey,
+                stem.fileMIME,
+                stem.fileLengthBytes,
+                stem.BPS,
+                stem.BPMrnd,
+                instrumentMask,
+                stem.length16s,
+                stem.originalPitch,
+                stem.barLength,
+                stem.preset,
+                stem.user,
+                stem.sampleRate,
+                stem.colour
+            );
+        }
 
-            return true;
-        };
+        totalRiffs += riffBatch.size();
+        totalStems += stemBatch.size();
+    }
+
+    blog::database( FMTX( "Imported {} riffs, {} stems" ), totalRiffs, totalStems );
+
+    m_eventBusClient.Send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Info,
+        ICON_FA_BOX " Jam Import Success",
+        fmt::format( FMTX( "Imported data into [{}]" ), archiveHeader.m_jamName ) );
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool JamImportTask::importLegacyYaml()
+{
+    auto loadStatus = base::readTextFile( m_fileToImport );
 
     // helper for parsing a type from the yaml, bailing out in a standard way if it fails
 #define PARSE_AND_CHECK( _valueName, _valueType, ... )                                      \
@@ -2654,6 +3693,7 @@ bool JamImportTask::Work( TaskQueue& currentTasks )
         blog::database( FMTX( "Importing [{}] {}" ), headerJamName.value(), headerJamCouchID.value() );
         blog::database( FMTX( "Export data from v.{}; {}" ), headerExportOuroVer.value(), exportTimeDelta );
     }
+    m_importedJamCID = types::JamCouchID{ headerJamCouchID.value() };
 
     // -----------------------------------------------------------------------------------------------------------------
     ryml::ConstNodeRef yamlRiffsList = yamlTree["riffs"];
@@ -3138,112 +4178,137 @@ bool GetStemData::Work( TaskQueue& currentTasks )
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-bool JamSliceTask::Work( TaskQueue& currentTasks )
+// streams rows from the riff/stem join into a JamSlice, carrying the previous-riff state required to compute the
+// adjacency deltas; can be seeded with an existing row so that a slice can be resumed part-way through
+struct JamSliceRowBuilder
 {
-    spacetime::ScopedTimer stemTiming( "JamSliceTask::Work" );
+    // extract the basic riff information along with the per-stem user data so that we can do identification analysis
+    // in the resulting data slice; this used to be an 8-way join against stems, now it reads the maintained projection
+    // (see sql::projection) and is a straight walk down the RiffProjection_IndexSlice index
+    //
+    // riff CID is used as a tie-breaker on the ordering so that a resumed query produces exactly the same sequence
+    static constexpr char sqlExtractAll[] = R"(
+        select RiffCID,
+               CreationTime,
+               UserName,
+               Root,
+               Scale,
+               BPMrnd,
+               StemCID_1, StemUser_1,
+               StemCID_2, StemUser_2,
+               StemCID_3, StemUser_3,
+               StemCID_4, StemUser_4,
+               StemCID_5, StemUser_5,
+               StemCID_6, StemUser_6,
+               StemCID_7, StemUser_7,
+               StemCID_8, StemUser_8
+        from RiffProjection
+        where OwnerJamCID is ?1
+        order by CreationTime, RiffCID;
+        )";
 
-    // count up riffs and prepare a memory buffer to populate with the results
-    const int64_t riffCount = sql::riffs::countPopulated( m_jamCID, true );
-    auto resultSlice = std::make_unique<Warehouse::JamSlice>( m_jamCID, riffCount );
-
-    // extract the basic riff information and weave in user data from the stems table so that we can 
-    // do identification analysis in the resulting data slice (this does make this query a fair bit slower due to
-    // how I structured the data .. but it's still under half a second for a 45k jam on this machine, in release)
-    static constexpr char _sqlExtractRiffBits[] = R"(
-        select riffs.OwnerJamCID,
-               riffs.RiffCID,
-               riffs.CreationTime,
-               riffs.UserName,
-               riffs.Root,
-               riffs.Scale,
-               riffs.BPMrnd,
-               riffs.StemCID_1, s1.CreatorUserName,
-               riffs.StemCID_2, s2.CreatorUserName,
-               riffs.StemCID_3, s3.CreatorUserName,
-               riffs.StemCID_4, s4.CreatorUserName,
-               riffs.StemCID_5, s5.CreatorUserName,
-               riffs.StemCID_6, s6.CreatorUserName,
-               riffs.StemCID_7, s7.CreatorUserName,
-               riffs.StemCID_8, s8.CreatorUserName
-        from riffs
-        left join stems as s1 on s1.StemCID = riffs.StemCID_1
-        left join stems as s2 on s2.StemCID = riffs.StemCID_2
-        left join stems as s3 on s3.StemCID = riffs.StemCID_3
-        left join stems as s4 on s4.StemCID = riffs.StemCID_4
-        left join stems as s5 on s5.StemCID = riffs.StemCID_5
-        left join stems as s6 on s6.StemCID = riffs.StemCID_6
-        left join stems as s7 on s7.StemCID = riffs.StemCID_7
-        left join stems as s8 on s8.StemCID = riffs.StemCID_8
-        where riffs.OwnerJamCID is ?1 and riffs.AppVersion is not null
-        order by riffs.CreationTime;
+    // as above, but only rows at or after the given (CreationTime, RiffCID) position
+    static constexpr char sqlExtractFrom[] = R"(
+        select RiffCID,
+               CreationTime,
+               UserName,
+               Root,
+               Scale,
+               BPMrnd,
+               StemCID_1, StemUser_1,
+               StemCID_2, StemUser_2,
+               StemCID_3, StemUser_3,
+               StemCID_4, StemUser_4,
+               StemCID_5, StemUser_5,
+               StemCID_6, StemUser_6,
+               StemCID_7, StemUser_7,
+               StemCID_8, StemUser_8
+        from RiffProjection
+        where OwnerJamCID is ?1
+          and ( CreationTime > ?2 or ( CreationTime = ?2 and RiffCID >= ?3 ) )
+        order by CreationTime, RiffCID;
         )";
 
-    auto query = Warehouse::SqlDB::query<_sqlExtractRiffBits>( m_jamCID.value() );
+    struct Row
+    {
+        std::string_view                    riffCID;
+        std::string_view                    username;
+        int64_t                             timestamp;
+        uint8_t                             root;
+        uint8_t                             scale;
+        float                               bpmrnd;
+        std::array< std::string_view, 8 >   stemCIDs;
+        std::array< std::string_view, 8 >   stemUsers;
+    };
 
-    std::string_view jamCID,
-                     riffCID,
-                     username;
-    int64_t          timestamp;
-    uint8_t          root;
-    uint8_t          scale;
-    float            bpmrnd;
-    std::array< std::string_view, 8 > stemCIDs;
-    std::array< std::string_view, 8 > stemUsers;
+    template< typename TQuery >
+    static bool readRow( TQuery& query, Row& row )
+    {
+        return query( row.riffCID,
+                      row.timestamp,
+                      row.username,
+                      row.root,
+                      row.scale,
+                      row.bpmrnd,
+                      row.stemCIDs[0],
+                      row.stemUsers[0],
+                      row.stemCIDs[1],
+                      row.stemUsers[1],
+                      row.stemCIDs[2],
+                      row.stemUsers[2],
+                      row.stemCIDs[3],
+                      row.stemUsers[3],
+                      row.stemCIDs[4],
+                      row.stemUsers[4],
+                      row.stemCIDs[5],
+                      row.stemUsers[5],
+                      row.stemCIDs[6],
+                      row.stemUsers[6],
+                      row.stemCIDs[7],
+                      row.stemUsers[7] );
+    }
 
-    // for tracking data from previous riff in the list
-    // unrolled to the basics - flat inline buffers to store and compare to
-    constexpr static std::size_t stemIDCharSize = 36;
-    std::array< char[stemIDCharSize], 8 > previousStemIDs;
-    for ( auto stemI = 0; stemI < 8; stemI++ )
-        memset( previousStemIDs[stemI], 0, stemIDCharSize );
+    JamSliceRowBuilder()
+    {
+        for ( auto stemI = 0; stemI < 8; stemI++ )
+            memset( previousStemIDs[stemI], 0, stemIDCharSize );
+    }
 
-    // data for comparisons with previous riff
-    spacetime::InSeconds previousRiffTimestamp;
-    int8_t               previousNumberOfActiveStems = 0;
-    int8_t               previousnumberOfUnseenStems = 0;
-    bool                 firstRiffInSequence = true;
+    // adopt the given row as the 'previous' riff without adding it to a slice
+    void seed( const Row& row )
+    {
+        int8_t numberOfActiveStems = 0;
+        for ( const auto& stemCID : row.stemCIDs )
+        {
+            if ( !stemCID.empty() )
+                numberOfActiveStems++;
+        }
 
-    // hashing used for usernames, matching what the apps use too
-    absl::Hash<std::string_view> nameHasher;
+        previousRiffTimestamp       = spacetime::InSeconds{ std::chrono::seconds{ row.timestamp } };
+        previousNumberOfActiveStems = numberOfActiveStems;
+        firstRiffInSequence         = false;
 
-    while ( query( jamCID,
-                   riffCID,
-                   timestamp,
-                   username,
-                   root,
-                   scale,
-                   bpmrnd,
-                   stemCIDs[0],
-                   stemUsers[0],
-                   stemCIDs[1],
-                   stemUsers[1],
-                   stemCIDs[2],
-                   stemUsers[2],
-                   stemCIDs[3],
-                   stemUsers[3],
-                   stemCIDs[4],
-                   stemUsers[4],
-                   stemCIDs[5],
-                   stemUsers[5],
-                   stemCIDs[6],
-                   stemUsers[6],
-                   stemCIDs[7],
-                   stemUsers[7] ) )
-    {
-        const uint64_t hashedUsername = nameHasher(username);
-
-        const auto contextTimestamp = spacetime::InSeconds{ std::chrono::seconds{ timestamp } };
-
-        resultSlice->m_ids.emplace_back( riffCID );
-        resultSlice->m_timestamps.emplace_back( contextTimestamp );
-        resultSlice->m_userhash.emplace_back( hashedUsername );
-        resultSlice->m_roots.emplace_back( root );
-        resultSlice->m_scales.emplace_back( scale );
-        resultSlice->m_bpms.emplace_back( bpmrnd );
+        for ( auto stemI = 0; stemI < 8; stemI++ )
+            strcpy( previousStemIDs[stemI], row.stemCIDs[stemI].data() );
+    }
+
+    // append a row to the slice; returns false if any active stem had no user data available
+    bool append( Warehouse::JamSlice& slice, const Row& row )
+    {
+        const uint64_t hashedUsername = nameHasher( row.username );
+
+        const auto contextTimestamp = spacetime::InSeconds{ std::chrono::seconds{ row.timestamp } };
+
+        slice.m_ids.emplace_back( row.riffCID );
+        slice.m_timestamps.emplace_back( contextTimestamp );
+        slice.m_userhash.emplace_back( hashedUsername );
+        slice.m_roots.emplace_back( row.root );
+        slice.m_scales.emplace_back( row.scale );
+        slice.m_bpms.emplace_back( row.bpmrnd );
 
         int8_t numberOfActiveStems = 0;
         int8_t numberOfUnseenStems = 0;
-        for ( const auto& stemCID : stemCIDs )
+        for ( const auto& stemCID : row.stemCIDs )
         {
             if ( !stemCID.empty() )
                 numberOfActiveStems++;
@@ -3263,46 +4328,215 @@ bool JamSliceTask::Work( TaskQueue& currentTasks )
         }
 
         // encode per-stem user names as their hashes
+        bool allStemUsersResolved = true;
         {
-            Warehouse::JamSlice::StemUserHashes& stemUserHashes = resultSlice->m_stemUserHashes.emplace_back();
+            Warehouse::JamSlice::StemUserHashes& stemUserHashes = slice.m_stemUserHashes.emplace_back();
             for ( auto stemI = 0; stemI < 8; stemI++ )
-                stemUserHashes[stemI] = nameHasher(stemUsers[stemI]);
+            {
+                stemUserHashes[stemI] = nameHasher( row.stemUsers[stemI] );
+
+                if ( !row.stemCIDs[stemI].empty() && row.stemUsers[stemI].empty() )
+                    allStemUsersResolved = false;
+            }
         }
 
         // first riff reports no deltas
         if ( firstRiffInSequence )
         {
-            resultSlice->m_deltaSeconds.push_back( 0 );
-            resultSlice->m_deltaStem.push_back( 0 );
+            slice.m_deltaSeconds.push_back( 0 );
+            slice.m_deltaStem.push_back( 0 );
         }
         // compute deltas from last riff
         else
         {
             const int8_t changeInActiveStems = numberOfActiveStems - previousNumberOfActiveStems;
 
-            resultSlice->m_deltaSeconds.push_back( static_cast<int32_t>( (contextTimestamp - previousRiffTimestamp).count() ) );
-            resultSlice->m_deltaStem.push_back( std::max( numberOfUnseenStems, (int8_t)std::abs(changeInActiveStems) ) );
+            slice.m_deltaSeconds.push_back( static_cast<int32_t>( (contextTimestamp - previousRiffTimestamp).count() ) );
+            slice.m_deltaStem.push_back( std::max( numberOfUnseenStems, (int8_t)std::abs(changeInActiveStems) ) );
         }
         firstRiffInSequence = false;
 
         // stash our current state for deltas
         previousRiffTimestamp = contextTimestamp;
         previousNumberOfActiveStems = numberOfActiveStems;
-        previousnumberOfUnseenStems = numberOfUnseenStems;
 
         // keep unordered set of stem IDs
         for ( auto stemI = 0; stemI < 8; stemI++ )
-            strcpy( previousStemIDs[stemI], stemCIDs[stemI].data() );
+            strcpy( previousStemIDs[stemI], row.stemCIDs[stemI].data() );
+
+        return allStemUsersResolved;
     }
 
-    // move the report out to the callback for it to deal with
+    // for tracking data from previous riff in the list
+    // unrolled to the basics - flat inline buffers to store and compare to
+    constexpr static std::size_t stemIDCharSize = 36;
+    std::array< char[stemIDCharSize], 8 > previousStemIDs;
+
+    // data for comparisons with previous riff
+    spacetime::InSeconds previousRiffTimestamp;
+    int8_t               previousNumberOfActiveStems = 0;
+    bool                 firstRiffInSequence = true;
+
+    // hashing used for usernames, matching what the apps use too
+    absl::Hash<std::string_view> nameHasher;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// run the full query, producing a fresh slice and noting the first row with unresolved stem users
+static std::shared_ptr< Warehouse::JamSlice > buildCompleteJamSlice( const types::JamCouchID& jamCID, std::size_t& firstUnresolvedRow )
+{
+    const int64_t riffCount = sql::projection::countRowsInJam( jamCID );
+    auto resultSlice = std::make_shared<Warehouse::JamSlice>( jamCID, riffCount );
+
+    auto query = Warehouse::SqlDB::query<JamSliceRowBuilder::sqlExtractAll>( jamCID.value() );
+
+    JamSliceRowBuilder builder;
+    JamSliceRowBuilder::Row row;
+
+    firstUnresolvedRow = std::numeric_limits<std::size_t>::max();
+    while ( JamSliceRowBuilder::readRow( query, row ) )
+    {
+        const std::size_t rowIndex = resultSlice->size();
+        if ( !builder.append( *resultSlice, row ) )
+            firstUnresolvedRow = std::min( firstUnresolvedRow, rowIndex );
+    }
+    firstUnresolvedRow = std::min( firstUnresolvedRow, resultSlice->size() );
+
+    return resultSlice;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool JamSliceTask::Work( TaskQueue& currentTasks )
+{
+    spacetime::ScopedTimer stemTiming( "JamSliceTask::Work" );
+
+    // in debug builds, cross-check every incremental update against a complete rebuild
+    static constexpr bool bValidateIncrementalUpdates = OURO_DEBUG;
+
+    Warehouse::JamSliceCache::Entry& cacheEntry = m_sliceCache.fetch( m_jamCID );
+
+    // nothing has changed since we last produced a slice, just hand that back
+    if ( cacheEntry.m_slice != nullptr &&
+         cacheEntry.m_changeIndex.isValid() &&
+         cacheEntry.m_changeIndex == m_changeIndex )
+    {
+        if ( m_reportCallback )
+            m_reportCallback( m_jamCID, cacheEntry.m_slice );
+
+        return true;
+    }
+
+    bool bIncrementalUpdateOk = false;
+
+    // rows we already hold were deleted, replaced or re-patched, or new ones were backfilled among them (an import, a
+    // purge, a stem user changing under resolved rows); only a complete rebuild will pick that up
+    const int64_t projectionRevision = sql::projection::getRevision( m_jamCID );
+
+    // try to extend the existing slice by resuming the query from the last fully-resolved row
+    if ( cacheEntry.m_slice != nullptr && cacheEntry.m_firstUnresolvedRow > 0 && cacheEntry.m_projectionRevision == projectionRevision )
+    {
+        const std::size_t rowsToKeep    = cacheEntry.m_firstUnresolvedRow;
+        const std::size_t seedRowIndex  = rowsToKeep - 1;
+
+        const auto seedTimestamp = static_cast<int64_t>( cacheEntry.m_slice->m_timestamps[seedRowIndex].time_since_epoch().count() );
+        const auto seedRiffCID   = cacheEntry.m_slice->m_ids[seedRowIndex];
+
+        const int64_t riffCount = sql::projection::countRowsInJam( m_jamCID );
+
+        // copy-on-write; if the only reference is ours we can edit in place, otherwise a client is still looking
+        // at the previous version and we take a copy of the rows we're keeping
+        std::shared_ptr< Warehouse::JamSlice > workingSlice;
+        if ( cacheEntry.m_slice.use_count() == 1 )
+        {
+            workingSlice = cacheEntry.m_slice;
+            workingSlice->truncate( rowsToKeep );
+        }
+        else
+        {
+            workingSlice = std::make_shared<Warehouse::JamSlice>( *cacheEntry.m_slice, rowsToKeep, riffCount );
+        }
+
+        auto query = Warehouse::SqlDB::query<JamSliceRowBuilder::sqlExtractFrom>( m_jamCID.value(), seedTimestamp, seedRiffCID.value() );
+
+        JamSliceRowBuilder builder;
+        JamSliceRowBuilder::Row row;
+
+        // first row back must be the one we're resuming from, used to prime the delta calculations
+        if ( JamSliceRowBuilder::readRow( query, row ) && row.riffCID == seedRiffCID.value() )
+        {
+            builder.seed( row );
+
+            std::size_t firstUnresolvedRow = std::numeric_limits<std::size_t>::max();
+            while ( JamSliceRowBuilder::readRow( query, row ) )
+            {
+                const std::size_t rowIndex = workingSlice->size();
+                if ( !builder.append( *workingSlice, row ) )
+                    firstUnresolvedRow = std::min( firstUnresolvedRow, rowIndex );
+            }
+
+            blog::database( FMTX( "[{}] incremental update, {} rows kept, {} rows queried" ), Tag, rowsToKeep, workingSlice->size() - rowsToKeep );
+
+            cacheEntry.m_slice              = std::move( workingSlice );
+            cacheEntry.m_firstUnresolvedRow = std::min( firstUnresolvedRow, cacheEntry.m_slice->size() );
+            bIncrementalUpdateOk            = true;
+        }
+    }
+
+    if ( !bIncrementalUpdateOk )
+    {
+        cacheEntry.m_slice = buildCompleteJamSlice( m_jamCID, cacheEntry.m_firstUnresolvedRow );
+    }
+    else if constexpr ( bValidateIncrementalUpdates )
+    {
+        std::size_t validationUnresolvedRow;
+        const auto validationSlice = buildCompleteJamSlice( m_jamCID, validationUnresolvedRow );
+        if ( !validationSlice->matches( *cacheEntry.m_slice ) || validationUnresolvedRow != cacheEntry.m_firstUnresolvedRow )
+        {
+            blog::error::database( FMTX( "[{}] incremental slice for [{}] does not match full rebuild" ), Tag, m_jamCID );
+            ABSL_ASSERT( false );
+        }
+    }
+    cacheEntry.m_changeIndex        = m_changeIndex;
+    cacheEntry.m_projectionRevision = projectionRevision;
+
+    // share the result out to the callback for it to deal with
     if ( m_reportCallback )
-        m_reportCallback( m_jamCID, std::move(resultSlice) );
+        m_reportCallback( m_jamCID, cacheEntry.m_slice );
 
     return true;
 }
 
 
+// ---------------------------------------------------------------------------------------------------------------------
+bool ProjectionValidateTask::Work( TaskQueue& currentTasks )
+{
+    spacetime::ScopedTimer stemTiming( "ProjectionValidateTask::Work" );
+
+    Warehouse::SqlDB::TransactionGuard txn;
+
+    const int64_t mismatchedRows = sql::projection::checkConsistency();
+    if ( mismatchedRows == 0 )
+    {
+        blog::database( FMTX( "[{}] riff projection is consistent" ), Tag );
+        return true;
+    }
+
+    sql::projection::rebuild();
+
+    // any cached slices (or similarity buckets) were built from the bad data, drop them so the next request starts fresh
+    m_sliceCache.clear();
+    m_similarityIndex.invalidateAll();
+
+    const int64_t remainingMismatches = sql::projection::checkConsistency();
+    if ( remainingMismatches != 0 )
+    {
+        blog::error::database( FMTX( "[{}] riff projection still has {} mismatched rows after rebuild" ), Tag, remainingMismatches );
+        ABSL_ASSERT( false );
+    }
+
+    return true;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool ContentsReportTask::Work( TaskQueue& currentTasks )
 {
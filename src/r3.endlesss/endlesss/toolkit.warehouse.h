@@ -11,10 +11,12 @@
 
 #include "base/text.h"
 #include "base/operations.h"
+#include "base/scheduler.h"
 #include "spacetime/chronicle.h"
 #include "endlesss/core.constants.h"
 #include "endlesss/ids.h"
 #include "endlesss/api.h"
+#include "endlesss/toolkit.jam.archive.h"
 
 namespace app { struct StoragePaths; }
 
@@ -98,6 +100,10 @@ struct Warehouse
 
 
     // SoA extraction of a set of riff data; this is the data returned to the client app when a view on a jam is requested
+    //
+    // slices are shared and immutable once handed out; the warehouse keeps the most recent slice for each jam and
+    // extends it with only the newly arrived riffs when the jam's change index moves on, copying the arrays first
+    // if a client is still holding on to the previous version
     struct JamSlice
     {
         using StemUserHashes = std::array< uint64_t, 8 >;
@@ -110,6 +116,52 @@ struct Warehouse
             reserve( elementsToReserve );
         }
 
+        // copy-on-write duplication of the first `elementsToKeep` rows of an existing slice
+        JamSlice( const JamSlice& source, const size_t elementsToKeep, const size_t elementsToReserve )
+        {
+            reserve( elementsToReserve );
+
+            m_ids.assign(               source.m_ids.begin(),               source.m_ids.begin()            + elementsToKeep );
+            m_timestamps.assign(        source.m_timestamps.begin(),        source.m_timestamps.begin()     + elementsToKeep );
+            m_userhash.assign(          source.m_userhash.begin(),          source.m_userhash.begin()       + elementsToKeep );
+            m_roots.assign(             source.m_roots.begin(),             source.m_roots.begin()          + elementsToKeep );
+            m_scales.assign(            source.m_scales.begin(),            source.m_scales.begin()         + elementsToKeep );
+            m_bpms.assign(              source.m_bpms.begin(),              source.m_bpms.begin()           + elementsToKeep );
+            m_stemUserHashes.assign(    source.m_stemUserHashes.begin(),    source.m_stemUserHashes.begin() + elementsToKeep );
+            m_deltaSeconds.assign(      source.m_deltaSeconds.begin(),      source.m_deltaSeconds.begin()   + elementsToKeep );
+            m_deltaStem.assign(         source.m_deltaStem.begin(),         source.m_deltaStem.begin()      + elementsToKeep );
+        }
+
+        ouro_nodiscard std::size_t size() const { return m_ids.size(); }
+
+        // drop all rows from `elements` onwards, used when re-querying the tail of a slice in place
+        void truncate( const std::size_t elements )
+        {
+            m_ids.resize( elements );
+            m_timestamps.resize( elements );
+            m_userhash.resize( elements );
+            m_roots.resize( elements );
+            m_scales.resize( elements );
+            m_bpms.resize( elements );
+            m_stemUserHashes.resize( elements );
+            m_deltaSeconds.resize( elements );
+            m_deltaStem.resize( elements );
+        }
+
+        // full data comparison, used to validate incremental updates against a complete rebuild
+        ouro_nodiscard bool matches( const JamSlice& other ) const
+        {
+            return m_ids            == other.m_ids          &&
+                   m_timestamps     == other.m_timestamps   &&
+                   m_userhash       == other.m_userhash     &&
+                   m_roots          == other.m_roots        &&
+                   m_scales         == other.m_scales       &&
+                   m_bpms           == other.m_bpms         &&
+                   m_stemUserHashes == other.m_stemUserHashes &&
+                   m_deltaSeconds   == other.m_deltaSeconds &&
+                   m_deltaStem      == other.m_deltaStem;
+        }
+
         // per-riff information
         std::vector< types::RiffCouchID >           m_ids;
         std::vector< spacetime::InSeconds >         m_timestamps;
@@ -159,12 +211,17 @@ struct Warehouse
             blog::app( FMTX( "JamSlice SOA array allocation {}" ), base::humaniseByteSize( "~", memoryUsageEstimation ) );
         }
     };
-    using JamSlicePtr = std::unique_ptr<JamSlice>;
+    using JamSlicePtr = std::shared_ptr<const JamSlice>;
     using JamSliceCallback = std::function<void( const types::JamCouchID& jamCouchID, JamSlicePtr&& resultSlice )>;
 
+    // how many jams have their most recent slice kept for incremental updates; LORE only views one at a time
+    static constexpr std::size_t cJamSliceCacheSize = 4;
+
 
     struct ITask;
     struct INetworkTask;
+    struct JamSliceCache;
+    struct RiffSimilarityIndex;
 
     using WorkUpdateCallback    = std::function<void( const bool tasksRunning, const std::string& currentTask ) >;
 
@@ -173,7 +230,8 @@ struct Warehouse
     using TagRemovedCallback    = std::function<void( const endlesss::types::RiffCouchID& tagRiffID )>;
 
 
-    Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::EventBusClient eventBus );
+    // the worker keeps a thread of its own, but each task it runs waits for a place in the scheduler's Sync lane first
+    Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::WorkScheduler& workScheduler, base::EventBusClient eventBus );
     ~Warehouse();
 
     static std::string  m_databaseFile;
@@ -221,9 +279,14 @@ struct Warehouse
     // insert a jam ID into the warehouse to be queried and filled
     ouro_nodiscard base::OperationID addOrUpdateJamSnapshot( const types::JamCouchID& jamCouchID );
 
-    // fetch the full stack of data for a given jam
+    // fetch the full stack of data for a given jam; repeated requests only query riffs that arrived since the last
+    // slice was produced, as tracked by the jam's change index
     void addJamSliceRequest( const types::JamCouchID& jamCouchID, const JamSliceCallback& callbackOnCompletion );
 
+    // compare the riff projection used by jam slices against the riff/stem tables it is derived from, rebuilding it
+    // if they disagree; runs on the worker thread, results go to the log
+    void requestProjectionValidation();
+
     // erase the given jam from the warehouse database entirely
     void requestJamPurge( const types::JamCouchID& jamCouchID );
 
@@ -240,9 +303,14 @@ struct Warehouse
     static constexpr base::OperationVariant OV_ExportAction{ 0xF1 };
     static constexpr base::OperationVariant OV_ImportAction{ 0xF2 };
 
+    // export writes a binary .orxj archive (see toolkit.jam.archive.h); import accepts those or legacy .yaml exports
     ouro_nodiscard base::OperationID requestJamDataExport( const types::JamCouchID& jamCouchID, const fs::path exportFolder, std::string_view jamTitle );
     ouro_nodiscard base::OperationID requestJamDataImport( const fs::path pathToData );
 
+    // optionally load a trained zstd dictionary used to compress archive blocks; if this isn't called (or fails)
+    // archives are written with plain zstd. must be called before any export/import requests are made
+    absl::Status loadArchiveCompressionDictionary( const fs::path& dictionaryFile );
+
     // produce a common format filename for exported things - database stuff, stem archives, etc
     ouro_nodiscard static std::string createExportFilenameForJam(
         const types::JamCouchID& jamCouchID,
@@ -282,8 +350,18 @@ struct Warehouse
     std::size_t filterRiffsByBPM( const endlesss::constants::RootScalePairs& keySearchPairs, const BPMCountSort sortOn, std::vector< BPMCountTuple >& bpmCounts ) const;
 
 
+    // seeded random selection of riffs at a given BPM that match the root/scale search rules; served from an in-memory
+    // index so repeated calls are cheap. the same seed returns the same riffs for the same database contents. the index
+    // is built on the warehouse worker the first time it is needed, and that first call waits for it
+    //
+    // NB: seeds are not compatible with versions that ran the selection as a seeded sqlite query; a seed noted down
+    // from one of those will pick different riffs now, even against an identical database
     bool fetchRandomRiffBySeed( const endlesss::constants::RootScalePairs& keySearchPairs, const uint32_t BPM, const int32_t seedValue, endlesss::types::RiffComplete& result ) const;
 
+    // batch version of the above, choosing `count` riffs in one pass; picks are made with replacement so every slot is
+    // filled as long as there is at least one candidate, even if that means repeats. returns how many were fetched
+    std::size_t fetchRandomRiffsBySeed( const endlesss::constants::RootScalePairs& keySearchPairs, const uint32_t BPM, const int32_t seedValue, const std::size_t count, std::vector< endlesss::types::RiffComplete >& results ) const;
+
     // get the last known committed riff in the given jam, return the timestamp
     uint32_t getOldestRiffUnixTimestampFromJam( const types::JamCouchID& jamCouchID ) const;
 
@@ -390,12 +468,18 @@ protected:
 
 
     api::NetConfiguration::Shared           m_networkConfiguration;
+    base::WorkScheduler&                    m_workScheduler;
+    base::WorkScheduler::CancellationToken  m_workCancellation;         // cancelled on destruction, so the worker stops waiting for slots
     base::EventBusClient                    m_eventBusClient;
 
     std::unique_ptr<TaskSchedule>           m_taskSchedule;
     std::unique_ptr<TaskSchedule>           m_taskSchedulePriority;     // parallel queue used to stage tasks that should be run before the default queue gets a look in
 
     ChangeIndexMap                          m_changeIndexMap;
+    std::unique_ptr<JamSliceCache>          m_jamSliceCache;            // only touched from the worker thread
+    std::unique_ptr<RiffSimilarityIndex>    m_riffSimilarityIndex;      // internally locked, used by the procedural tools
+
+    archive::CompressionDictionaryPtr       m_archiveDictionary;
 
     WorkUpdateCallback                      m_cbWorkUpdate              = nullptr;
     WorkUpdateCallback                      m_cbWorkUpdateToInstall     = nullptr;
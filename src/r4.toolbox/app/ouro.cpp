@@ -190,7 +190,7 @@ int OuroApp::EntrypointGUI()
     // task / state for fetching metadata 
     auto asyncFetchState = endlesss::cache::Jams::AsyncFetchState::None;
     std::string asyncState;
-    tf::Taskflow taskFlow;
+    base::WorkScheduler::CancellationToken asyncFetchCancellation;
 
     // buffer for changing data storage path; #HDD TODO per platform limits for dataStoragePathBufferSize
     constexpr size_t dataStoragePathBufferSize = 255;
@@ -705,8 +705,9 @@ int OuroApp::EntrypointGUI()
                                 {
                                     m_jamLibrary.asyncCacheRebuild(
                                         *m_networkConfiguration,
+                                        m_workScheduler,
+                                        asyncFetchCancellation,
                                         endlesssAuth.sync_options,
-                                        taskFlow,
                                         [&]( const endlesss::cache::Jams::AsyncFetchState state, const std::string& status )
                                         {
                                             asyncFetchState = state;
@@ -715,7 +716,6 @@ int OuroApp::EntrypointGUI()
                                             if ( state == endlesss::cache::Jams::AsyncFetchState::Success )
                                                 m_jamLibrary.save( *this );
                                         });
-                                    m_taskExecutor.run( taskFlow );
                                 }
                                 ImGui::CompactTooltip( "Sync and update your list of jams\nand current join-ins" );
                             }
@@ -902,6 +902,58 @@ int OuroApp::EntrypointGUI()
                                 "If possible, some riffs are kept alive in memory to speed-up transitions / avoid re-loading from disk.\nThis value controls how many we aim to limit that to.\nIncrease if you got RAM to burn."
                             );
                             ImGui::InputInt( "##riff_live_inst", &m_configPerf.liveRiffInstancePoolSize, 8, 16 );
+
+                            NicerIntEditPreamble(
+                                "Stem Memory Format",
+                                "How loaded stems are held in memory.\n32-bit Float is lossless and the cheapest to play back.\n16-bit PCM halves the memory used per stem; 8-bit Block Float takes it to just over a quarter,\nat the cost of some added noise and a small decode step whenever the mixer reads the stem.\nApplies to stems loaded after the session starts"
+                            );
+                            ImGui::Combo( "##stem_storage",
+                                &m_configPerf.stemStorageMode,
+                                []( void*, int idx, const char** out_text ) -> bool
+                                {
+                                    *out_text = config::Performance::stemStorageModeNames[idx];
+                                    return true;
+                                },
+                                nullptr,
+                                config::Performance::stemStorageModeCount );
+
+                            NicerIntEditPreamble(
+                                "Progressive Stem Start",
+                                "Start playing riffs once this many bars of each stem have been decoded, finishing the rest in the background.\n0 waits for every stem to fully decode first.\nOnly FLAC stems held as 32-bit Float decode progressively.\nApplies after restarting"
+                            );
+                            if ( ImGui::InputInt( " bars##progressive_stems", &m_configPerf.progressiveStemStartBars, 1, 2 ) )
+                            {
+                                m_configPerf.clampLimits();
+                            }
+
+                            NicerIntEditPreamble(
+                                "Tempo Matching",
+                                "How stems are played when a riff uses them at a different tempo to the one they were recorded at.\nResampling is free but changes their pitch; the time-stretch presets keep the pitch,\nre-timing each stem in the background once the riff loads. Higher quality costs more CPU per stem.\nApplies to riffs loaded after the change"
+                            );
+                            ImGui::Combo( "##time_stretch",
+                                &m_configPerf.timeStretchPreset,
+                                []( void*, int idx, const char** out_text ) -> bool
+                                {
+                                    *out_text = dsp::TimeStretch::cPresetNames[idx];
+                                    return true;
+                                },
+                                nullptr,
+                                (int)dsp::TimeStretch::cPresetCount );
+
+                            NicerIntEditPreamble(
+                                "FLAC Compression Level",
+                                "libFLAC compression level used when recording multitrack FLAC, 0 to 8.\nHigher levels make smaller files at the cost of more encoder CPU per track"
+                            );
+                            if ( ImGui::InputInt( "##flac_level", &m_configPerf.flacCompressionLevel, 1, 2 ) )
+                            {
+                                m_configPerf.clampLimits();
+                            }
+
+                            NicerIntEditPreamble(
+                                "FLAC Verification",
+                                "Decode every encoded FLAC frame back and compare it against the input while recording.\nCatches encoder faults as they happen but roughly doubles the encoding cost"
+                            );
+                            ImGui::Checkbox( "##flac_verify", &m_configPerf.flacVerify );
                         }
                         ImGui::PopItemWidth();
 
@@ -1046,6 +1098,10 @@ int OuroApp::EntrypointGUI()
         }
     }
 
+    // a jam rebuild still running reports back into locals above; have it bail out early and wait for it
+    asyncFetchCancellation.cancel();
+    asyncFetchCancellation.waitForWork();
+
     m_taskExecutor.wait_for_all();
 
     if ( m_mdFrontEnd->wasQuitRequested() )
@@ -1088,7 +1144,11 @@ int OuroApp::EntrypointGUI()
             }
 
             // boot stem cache now we have paths & audio configured
-            const auto stemCacheStatus = m_stemCache.initialise( m_storagePaths->cacheCommon, m_mdAudio->getSampleRate() );
+            const auto stemCacheStatus = m_stemCache.initialise(
+                m_storagePaths->cacheCommon,
+                m_mdAudio->getSampleRate(),
+                (endlesss::live::Stem::SampleStorage)m_configPerf.stemStorageMode,
+                m_configPerf.progressiveStemStartBars );
             if ( !stemCacheStatus.ok() )
             {
                 return stemCacheStatus;
@@ -1101,8 +1161,20 @@ int OuroApp::EntrypointGUI()
                 m_warehouse = std::make_unique<endlesss::toolkit::Warehouse>(
                     m_storagePaths.value(),
                     m_networkConfiguration,
+                    m_workScheduler,
                     m_appEventBus );
 
+                // jam archives can be compressed against a shared trained dictionary if one is shipped; otherwise plain zstd is used
+                const auto archiveDictionaryPath = getPath( config::IPathProvider::PathFor::SharedData ) / "dict" / "zstd.jamarchive";
+                if ( fs::exists( archiveDictionaryPath ) )
+                {
+                    const auto dictionaryStatus = m_warehouse->loadArchiveCompressionDictionary( archiveDictionaryPath );
+                    if ( !dictionaryStatus.ok() )
+                    {
+                        blog::error::app( FMTX( "unable to load jam archive dictionary; {}" ), dictionaryStatus.ToString() );
+                    }
+                }
+
                 m_warehouse->upsertJamDictionaryFromCache( m_jamLibrary );              // update warehouse list of jam IDs -> names from the current cache
                 m_warehouse->upsertJamDictionaryFromBNS( m_jamNameService );            // .. and same with the BNS entries
                 m_warehouse->extractJamDictionary( m_jamHistoricalFromWarehouse );      // pull full list of jam IDs -> names from warehouse as "historical" list
@@ -1212,7 +1284,7 @@ int OuroApp::EntrypointGUI()
 
     // run the Clubs data fetch in the background, unbounded; this seems to sometimes take an age and I don't want it
     // slowing down our app startup. anything using this data needs to check if its valid
-    m_taskExecutor.silent_async( "clubs_sync", [this]()
+    m_workScheduler.submit( base::WorkScheduler::Lane::Sync, [this]()
         {
             // assume we have no data by default
             m_clubsIntegrationEnabled = false;
@@ -1264,9 +1336,12 @@ int OuroApp::EntrypointGUI()
     // wrap up any dangling async work before teardown
     ensureStemCacheChecksComplete();
     
-    // ensure executor is drained
+    // ensure executors are drained
+    m_workScheduler.waitForIdle();
     m_taskExecutor.wait_for_all();
 
+    m_workScheduler.logStatistics();
+
     {
         m_warehouse.reset();
     }
@@ -1412,7 +1487,7 @@ void OuroApp::event_BNSCacheMiss( const events::BNSCacheMiss* eventData )
 
     // kick a task that uses a few network calls to go from a band### id to a public name; this uses the permalink
     // endpoint (to get the extended ID) and the public riff API with that ID to snag the names
-    getTaskExecutor().silent_async( [this, jamID = eventData->m_jamID, netCfg = getNetworkConfiguration()]()
+    m_workScheduler.submit( base::WorkScheduler::Lane::Sync, [this, jamID = eventData->m_jamID, netCfg = getNetworkConfiguration()]()
         {
             blog::api( FMTX( "name resolution for {}" ), jamID );
 
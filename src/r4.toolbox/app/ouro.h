@@ -14,6 +14,7 @@
 #include "config/nonet.h"
 #include "discord/config.h"
 #include "endlesss/core.services.h"
+#include "ssp/ssp.file.flac.h"
 
 #if !OURO_HAS_NDLS_ONLINE
 #include "ux/user.selector.h"
@@ -38,11 +39,21 @@ struct OuroApp : public CoreGUI,
     endlesss::toolkit::Warehouse* getWarehouseInstance() { return m_warehouse.get(); }
     const endlesss::toolkit::Warehouse* getWarehouseInstance() const { return m_warehouse.get(); }
 
+    // encoder settings for multitrack FLAC recording, as chosen in the performance configuration
+    ssp::FLACEncoderOptions getFLACEncoderOptions() const
+    {
+        ssp::FLACEncoderOptions options;
+        options.m_compressionLevel  = m_configPerf.flacCompressionLevel;
+        options.m_verify            = m_configPerf.flacVerify;
+        return options;
+    }
+
     // endlesss::services::IRiffFetchService
     int32_t                                 getSampleRate() const override;
     const endlesss::api::NetConfiguration&  getNetConfiguration() const override { return *m_networkConfiguration; }
     endlesss::cache::Stems&                 getStemCache() override { return m_stemCache; }
     tf::Executor&                           getTaskExecutor() override { return m_taskExecutor; }
+    dsp::TimeStretch::Preset                getTimeStretchPreset() const override { return (dsp::TimeStretch::Preset)m_configPerf.timeStretchPreset; }
 
     // endlesss::services::IJamNameCacheServices
     LookupResult lookupJamNameAndTime(
@@ -22,8 +22,8 @@ RiffMixerBase::RiffMixerBase( const int32_t maxBufferSize, const int32_t sampleR
 
     for ( size_t mI = 0; mI < 8; mI++ )
     {
-        m_mixChannelLeft[mI] = mem::alloc16To<float>( m_audioMaxBufferSize, 0.0f );
-        m_mixChannelRight[mI] = mem::alloc16To<float>( m_audioMaxBufferSize, 0.0f );
+        m_mixChannelLeft[mI] = mem::alloc16To<float>( m_audioMaxBufferSize, 0.0f, mem::Tag::Riffs );
+        m_mixChannelRight[mI] = mem::alloc16To<float>( m_audioMaxBufferSize, 0.0f, mem::Tag::Riffs );
     }
 
     m_audioSampleRateRecp = 1.0 / (double)m_audioSampleRate;
@@ -38,8 +38,8 @@ RiffMixerBase::~RiffMixerBase()
 {
     for ( size_t mI = 0; mI < 8; mI++ )
     {
-        mem::free16( m_mixChannelLeft[mI] );
-        mem::free16( m_mixChannelRight[mI] );
+        mem::free16( m_mixChannelLeft[mI], mem::Tag::Riffs );
+        mem::free16( m_mixChannelRight[mI], mem::Tag::Riffs );
     }
     m_mixChannelLeft.fill( nullptr );
     m_mixChannelRight.fill( nullptr );
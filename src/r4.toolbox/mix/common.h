@@ -88,6 +88,10 @@ struct RiffMixerBase
         return m_permutationCurrent;
     }
 
+    // how quickly the layer gains glide towards a newly enqueued permutation
+    void setPermutationChangeRate( const PermutationChangeRate::Enum rate ) { m_permutationChangeRate = rate; }
+    ouro_nodiscard constexpr PermutationChangeRate::Enum getPermutationChangeRate() const { return m_permutationChangeRate; }
+
 protected:
 
     void mixChannelsWriteSilence(
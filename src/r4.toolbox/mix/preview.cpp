@@ -10,15 +10,17 @@
 #include "mix/preview.h"
 
 #include "base/paging.h"
+#include "base/text.h"
 #include "math/rng.h"
 
 #include "app/core.h"
 #include "app/imgui.ext.h"
 #include "app/module.frontend.fonts.h"
 
-#include "ssp/ssp.file.flac.h"
+#include "ssp/ssp.file.flac.multitrack.h"
 #include "ssp/ssp.file.wav.h"
 
+#include "ux/diskrecorder.h"
 #include "ux/stem.beats.h"
 
 #include "endlesss/core.constants.h"
@@ -88,6 +90,7 @@ Preview::Preview( const int32_t maxBufferSize, const int32_t sampleRate, const s
     m_txBlendCacheRight.fill( 0 );
     m_txBlendActiveLeft.fill( 0 );
     m_txBlendActiveRight.fill( 0 );
+    m_midiLayerGated.fill( false );
 
     const auto blendDelta =  1.0 / (double)txBlendBufferSize;
           auto blendValue = -1.0;
@@ -109,6 +112,33 @@ Preview::~Preview()
 
 // ---------------------------------------------------------------------------------------------------------------------
 void Preview::renderCurrentRiff(
+    const uint32_t      outputOffset,
+    const uint32_t      samplesToWrite )
+{
+    const uint32_t segmentEnd   = outputOffset + samplesToWrite;
+    uint32_t       segmentStart = outputOffset;
+
+    while ( m_blockMidiApplied < m_blockMidiCount )
+    {
+        const app::midi::TimedMessage& timedMsg = m_blockMidi[m_blockMidiApplied];
+        if ( timedMsg.m_sampleOffset >= segmentEnd )
+            break;
+
+        // anything due before this span (eg. during silence) is applied at its start
+        const uint32_t applyAt = std::max( timedMsg.m_sampleOffset, segmentStart );
+
+        renderCurrentRiffSegment( segmentStart, applyAt - segmentStart );
+        applyMidiMessage( timedMsg.m_msg );
+
+        segmentStart = applyAt;
+        m_blockMidiApplied++;
+    }
+
+    renderCurrentRiffSegment( segmentStart, segmentEnd - segmentStart );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Preview::renderCurrentRiffSegment(
     const uint32_t      outputOffset,
     const uint32_t      samplesToWrite)
 {
@@ -128,7 +158,7 @@ void Preview::renderCurrentRiff(
     for ( auto stemI = 0U; stemI < 8; stemI++ )
     {
         stemTimeStretch[stemI]  = currentRiff->m_stemTimeScales[stemI];
-        stemGains[stemI]        = currentRiff->m_stemGains[stemI] * m_permutationCurrent.m_layerGainMultiplier[stemI];
+        stemGains[stemI]        = m_midiLayerGated[stemI] ? 0.0f : currentRiff->m_stemGains[stemI] * m_permutationCurrent.m_layerGainMultiplier[stemI];
         stemPtr[stemI]          = currentRiff->m_stemPtrs[stemI];
         stemAnalysed[stemI]     = ( stemPtr[stemI] != nullptr ) && ( stemPtr[stemI]->getAnalysisState() == endlesss::live::Stem::AnalysisState::AnalysisValid );
     }
@@ -178,11 +208,28 @@ void Preview::renderCurrentRiff(
 
         auto& stemAnalysis = stemInst->getAnalysisData();
 
+        // stems still decoding in the background are only readable up to their current watermark; beyond that is silence
+        const int32_t samplesAvailable = stemInst->getSamplesAvailable();
+
+        // tempo-matched stems play from their stretched copy as far as it has been rendered, falling back to the
+        // resampled original past that point
+        const auto*   stretchedStem      = currentRiff->getStretchedStem( stemI );
+        const int32_t stretchedAvailable = ( stretchedStem != nullptr ) ? stretchedStem->getSamplesAvailable() : 0;
+
         for ( auto sI = 0U; sI < samplesToWrite; sI++ )
         {
             const auto sampleCount = stemInst->m_sampleCount;
             uint64_t finalSampleIdx = riffSample;
 
+            // the stretched copy is already at riff tempo, so is indexed directly by riff position
+            uint64_t stretchedIdx = 0;
+            bool     fromStretched = false;
+            if ( stretchedAvailable > 0 )
+            {
+                stretchedIdx  = ( riffSample + m_riffPlaybackNudge ) % (uint64_t)stretchedStem->m_sampleCount;
+                fromStretched = stretchedIdx < (uint64_t)stretchedAvailable;
+            }
+
             int32_t sampleOffset = m_riffPlaybackNudge;
 
             if (stemTimeStretch[stemI] != 1.0f)
@@ -194,7 +241,7 @@ void Preview::renderCurrentRiff(
             finalSampleIdx %= sampleCount;
 
             // contribute data from the stem analysis to amalgamated block of data as we go
-            if ( stemAnalysed[stemI] && permGain > 0 )
+            if ( stemAnalysed[stemI] && permGain > 0 && !m_midiLayerGated[stemI] )
             {
                 const float stemWave = stemAnalysis.getWaveF( finalSampleIdx ) * permGain;
                 const float stemBeat = stemAnalysis.getBeatF( finalSampleIdx ) * permGain;
@@ -207,8 +254,21 @@ void Preview::renderCurrentRiff(
                 m_stemDataAmalgam.m_high[stemI] = std::max( m_stemDataAmalgam.m_high[stemI], stemHigh );
             }
 
-            lastSampleLeft  = stemInst->m_channel[0][finalSampleIdx] * stemGain * permGain;
-            lastSampleRight = stemInst->m_channel[1][finalSampleIdx] * stemGain * permGain;
+            if ( fromStretched )
+            {
+                lastSampleLeft  = stretchedStem->m_channel[0][stretchedIdx] * stemGain * permGain;
+                lastSampleRight = stretchedStem->m_channel[1][stretchedIdx] * stemGain * permGain;
+            }
+            else if ( finalSampleIdx < (uint64_t)samplesAvailable )
+            {
+                lastSampleLeft  = stemInst->getSample( 0, (int32_t)finalSampleIdx ) * stemGain * permGain;
+                lastSampleRight = stemInst->getSample( 1, (int32_t)finalSampleIdx ) * stemGain * permGain;
+            }
+            else
+            {
+                lastSampleLeft  = 0;
+                lastSampleRight = 0;
+            }
             m_mixChannelLeft[stemI][outputOffset + sI]  = lastSampleLeft;
             m_mixChannelRight[stemI][outputOffset + sI] = lastSampleRight;
 
@@ -230,6 +290,34 @@ void Preview::renderCurrentRiff(
     m_stemDataAmalgamSamplesUsed += samplesToWrite;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void Preview::applyMidiMessage( const app::midi::Message& msg )
+{
+    // a note-on with zero velocity is a note-off by another name
+    const bool isNoteOn  = ( msg.m_type == app::midi::Message::Type::NoteOn && msg.m_data1_u7 > 0 );
+    const bool isNoteOff = ( msg.m_type == app::midi::Message::Type::NoteOff ) ||
+                           ( msg.m_type == app::midi::Message::Type::NoteOn && msg.m_data1_u7 == 0 );
+    if ( !isNoteOn && !isNoteOff )
+        return;
+
+    const int32_t layer = (int32_t)msg.m_data0_u7 - (int32_t)cMidiLayerGateFirstKey;
+    if ( layer < 0 || layer >= 8 )
+        return;
+
+    m_midiLayerGated[layer] = isNoteOn;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Preview::applyRemainingBlockMidi()
+{
+    for ( ; m_blockMidiApplied < m_blockMidiCount; m_blockMidiApplied++ )
+        applyMidiMessage( m_blockMidi[m_blockMidiApplied].m_msg );
+
+    m_blockMidi         = nullptr;
+    m_blockMidiCount    = 0;
+    m_blockMidiApplied  = 0;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Preview::applyBlendBuffer( const uint32_t outputOffset, const uint32_t samplesToWrite )
 {
@@ -313,6 +401,18 @@ void Preview::processCommandQueue()
     }
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void Preview::processMidi(
+    const app::midi::TimedMessage*  messages,
+    const std::size_t               messageCount,
+    const uint64_t                  /* samplePosition */ )
+{
+    // held until update() runs, straight after this on the same thread
+    m_blockMidi         = messages;
+    m_blockMidiCount    = messageCount;
+    m_blockMidiApplied  = 0;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Preview::update( 
     const AudioBuffer&  outputBuffer,
@@ -394,8 +494,9 @@ void Preview::update(
     // early out when nothing is happening
     if ( riffEmpty && !riffEnqueued )
     {
-        // keep permutations updating even if we early out
+        // keep permutations and MIDI gates updating even if we early out
         flushPendingPermutations();
+        applyRemainingBlockMidi();
 
         outputBuffer.applySilence();
 
@@ -633,6 +734,8 @@ void Preview::update(
         }
     }
 
+    applyRemainingBlockMidi();
+
     mixChannelsToOutput( outputBuffer, outputSignal, samplesToWrite );
 }
 
@@ -930,6 +1033,13 @@ void Preview::imguiTuning()
         }
         ImGui::EndDisabledControls( disableFormatSwitching );
     }
+
+    // live encoder stats while the FLAC recorder is running
+    if ( auto flacRecorder = m_multiTrackFLAC.lock() )
+    {
+        ImGui::Spacing();
+        ux::widget::FLACRecorderStatistics( *flacRecorder );
+    }
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -940,13 +1050,13 @@ bool Preview::beginRecording( const fs::path& outputPath, const std::string& fil
     if ( isRecording() )
         return false;
 
-    // randomise the write buffer sizes to avoid all outputs flushing outputs simultaneously
-    math::RNG32 writeBufferShuffleRNG;
-
     // set up 8 output streams, one for each Endlesss layer
-    for ( auto i = 0; i < 8; i++ )
+    if ( m_multiTrackOutputFormat == MultiTrackOutputFormat::WAV )
     {
-        if ( m_multiTrackOutputFormat == MultiTrackOutputFormat::WAV )
+        // randomise the write buffer sizes to avoid all outputs flushing outputs simultaneously
+        math::RNG32 writeBufferShuffleRNG;
+
+        for ( auto i = 0; i < 8; i++ )
         {
             auto recordFile = outputPath / fmt::format( "{}_layer-{}.wav", filePrefix, i + 1 );
             m_multiTrackOutputs[i] = ssp::WAVWriter::Create(
@@ -954,18 +1064,32 @@ bool Preview::beginRecording( const fs::path& outputPath, const std::string& fil
                 m_audioSampleRate,
                 writeBufferShuffleRNG.genInt32( 5, 15 ) );
         }
-        else if ( m_multiTrackOutputFormat == MultiTrackOutputFormat::FLAC )
-        {
-            auto recordFile = outputPath / fmt::format( "{}_layer-{}.flac", filePrefix, i + 1 );
-            m_multiTrackOutputs[i] = ssp::FLACWriter::Create(
-                recordFile.string(),
-                m_audioSampleRate,
-                writeBufferShuffleRNG.genFloat( 0.75f, 1.75f ) );
-        }
-        else
+    }
+    else if ( m_multiTrackOutputFormat == MultiTrackOutputFormat::FLAC )
+    {
+        // FLAC tracks share one encoder pool and one disk writer rather than running eight independent streams
+        std::vector< fs::path > recordFiles;
+        for ( auto i = 0; i < 8; i++ )
+            recordFiles.emplace_back( outputPath / fmt::format( "{}_layer-{}.flac", filePrefix, i + 1 ) );
+
+        ssp::FLACMultiTrackRecorder::Config recorderConfig;
+        recorderConfig.m_encoder = m_multiTrackFLACOptions;
+
+        auto recorderResult = ssp::FLACMultiTrackRecorder::Create( recordFiles, m_audioSampleRate, recorderConfig );
+        if ( !recorderResult.ok() )
         {
-            ABSL_ASSERT( false );
+            blog::error::mix( FMTX( "unable to begin 8-track recording : {}" ), recorderResult.status().ToString() );
+            return false;
         }
+
+        for ( auto i = 0; i < 8; i++ )
+            m_multiTrackOutputs[i] = recorderResult.value()->getTrackProcessor( i );
+
+        m_multiTrackFLAC = recorderResult.value();
+    }
+    else
+    {
+        ABSL_ASSERT( false );
     }
 
     // tell the worker thread to begin writing to our streams
@@ -15,8 +15,10 @@
 #include "mix/stem.amalgam.h"
 
 #include "app/module.audio.h"
+#include "ssp/ssp.file.flac.h"
 
 namespace app { struct StoragePaths; }
+namespace ssp { class FLACMultiTrackRecorder; }
 namespace ableton { class Link; }
 
 namespace mix {
@@ -31,6 +33,9 @@ struct Preview final : public app::module::MixerInterface,
 {
     static constexpr base::OperationVariant OV_EnqueueRiff { 0xAA };
 
+    // notes cMidiLayerGateFirstKey .. +7 gate layers 0 .. 7; 36 is where the first pad bank sits on most controllers
+    static constexpr uint8_t cMidiLayerGateFirstKey = 36;
+
     using AudioBuffer           = app::module::Audio::OutputBuffer;
     using AudioSignal           = app::module::Audio::OutputSignal;
 
@@ -44,6 +49,12 @@ struct Preview final : public app::module::MixerInterface,
         const uint32_t      samplesToWrite,
         const uint64_t      samplePosition ) override;
 
+    // holding a note from cMidiLayerGateFirstKey upwards silences the matching layer, from the sample it landed on
+    virtual void processMidi(
+        const app::midi::TimedMessage*  messages,
+        const std::size_t               messageCount,
+        const uint64_t                  samplePosition ) override;
+
     virtual void imgui() override;
 
     const app::AudioPlaybackTimeInfo* getPlaybackTimeInfo() const override { return getTimeInfoPtr(); }
@@ -71,6 +82,9 @@ struct Preview final : public app::module::MixerInterface,
 
     void enableAbletonLink( bool bEnabled );
 
+    // applies to the next FLAC recording started
+    void setFLACEncoderOptions( const ssp::FLACEncoderOptions& options ) { m_multiTrackFLACOptions = options; }
+
     void setLockTransitionToNextBar( bool onOff ) { m_lockTransitionToNextBar = onOff; }
     bool getLockTransitionToNextBar() const       { return m_lockTransitionToNextBar; }
 
@@ -85,10 +99,20 @@ protected:
     void imguiTuning();
 
 
+    // renders in segments split wherever this block's MIDI lands, applying each message at its own sample
     void renderCurrentRiff(
         const uint32_t      outputOffset,
         const uint32_t      samplesToWrite );
 
+    void renderCurrentRiffSegment(
+        const uint32_t      outputOffset,
+        const uint32_t      samplesToWrite );
+
+    void applyMidiMessage( const app::midi::Message& msg );
+
+    // apply whatever MIDI is left for this block, eg. anything landing in stretches of silence
+    void applyRemainingBlockMidi();
+
     void applyBlendBuffer(
         const uint32_t      outputOffset,
         const uint32_t      samplesToWrite );
@@ -140,6 +164,11 @@ protected:
 
     std::atomic_bool                m_drainQueueAndStop         = false;
 
+    const app::midi::TimedMessage*  m_blockMidi                 = nullptr;  // handed over by processMidi(), valid for the following update()
+    std::size_t                     m_blockMidiCount            = 0;
+    std::size_t                     m_blockMidiApplied          = 0;
+    std::array< bool, 8 >           m_midiLayerGated;                       // silenced by held notes, on top of any permutation
+
 
 // ---------------------------------------------------------------------------------------------------------------------
 
@@ -167,6 +196,9 @@ private:
     MultiTrackStreams               m_multiTrackOutputs;                        // currently live recorders
     MultiTrackStreams               m_multiTrackOutputsToDestroyOnMainThread;   // recorders ready to decommission on main thread
 
+    std::weak_ptr< ssp::FLACMultiTrackRecorder >    m_multiTrackFLAC;                   // watched for encoder stats while recording FLAC
+    ssp::FLACEncoderOptions                         m_multiTrackFLACOptions;
+
 public:
 
     rec::IRecordable* getRecordable() override { return this; }
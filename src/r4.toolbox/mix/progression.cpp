@@ -0,0 +1,597 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+
+#include "pch.h"
+
+#include "mix/progression.h"
+
+#include "buffer/mix.h"
+
+#include "endlesss/live.riff.h"
+#include "endlesss/live.stem.h"
+
+#include <ableton/Link.hpp>
+#include <ableton/link/HostTimeFilter.hpp>
+
+namespace mix {
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct ProgressionEngine::AbletonLinkControl
+{
+    AbletonLinkControl()
+        : m_link( 120.0 )
+    {
+    }
+    ~AbletonLinkControl()
+    {
+        m_link.enable( false );
+    }
+
+    using LinkHostTime = ableton::link::HostTimeFilter<ableton::link::platform::Clock>;
+
+    void Transaction_StopPlaying()
+    {
+        // if the current link state is "playing", snag and change the session to stop it
+        if ( m_linkIsPlaying )
+        {
+            auto linkSessionState = m_link.captureAudioSessionState();
+            {
+                linkSessionState.setIsPlaying(
+                    false,
+                    m_hostTimeFilter.sampleTimeToHostTime( m_sampleTime ) );
+
+                m_linkIsPlaying = false;
+            }
+            m_link.commitAudioSessionState( linkSessionState );
+        }
+    }
+
+
+    ableton::Link               m_link;
+    LinkHostTime                m_hostTimeFilter;
+    std::chrono::microseconds   m_outputLatency;
+    double                      m_sampleTime = 0;
+    int32_t                     m_authorativeInterval = -1;
+    bool                        m_linkIsPlaying = false;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+ProgressionEngine::ProgressionEngine( const int32_t maxBufferSize, const int32_t sampleRate, const std::chrono::microseconds outputLatency, base::EventBusClient& eventBusClient )
+    : RiffMixerBase( maxBufferSize, sampleRate, eventBusClient )
+    , m_samplePosition( 0 )
+    , m_riffVoices( maxBufferSize, sampleRate )
+    , m_transitionValue( 0 )
+    , m_transitionPending( false )
+    , m_riffVoicesActive( 0 )
+    , m_stemBeatRate( 4.0f )
+    , m_abletonLinkControl( nullptr )
+    , m_multiTrackInFlux( false )
+    , m_multiTrackWaitingToRecordOnRiffEdge( false )
+    , m_multiTrackRecording( false )
+    , m_repcomRepeatBar( 0 )
+    , m_repcomPausedOnBar( -1 )
+    , m_repcomRepeatLimit( 0 )
+    , m_repcomSampleStart( 0 )
+    , m_repcomSampleEnd( cSampleCountMax )
+    , m_repcomState( RepComState::Unpaused )
+{
+    m_abletonLinkControl = new AbletonLinkControl();
+    m_abletonLinkControl->m_outputLatency = outputLatency;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ProgressionEngine::~ProgressionEngine()
+{
+    delete m_abletonLinkControl;
+    m_abletonLinkControl = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ProgressionEngine::enableAbletonLink( bool bEnabled )
+{
+    m_abletonLinkControl->m_link.enable( bEnabled );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ProgressionEngine::commit(
+    const AudioBuffer&  outputBuffer,
+    const AudioSignal&  outputSignal,
+    const uint32_t      samplesToWrite )
+{
+    buffer::downmix_8channel_stereo(
+        outputSignal.m_linearGain,
+        samplesToWrite,
+        m_mixChannelLeft[0],
+        m_mixChannelLeft[1],
+        m_mixChannelLeft[2],
+        m_mixChannelLeft[3],
+        m_mixChannelLeft[4],
+        m_mixChannelLeft[5],
+        m_mixChannelLeft[6],
+        m_mixChannelLeft[7],
+        m_mixChannelRight[0],
+        m_mixChannelRight[1],
+        m_mixChannelRight[2],
+        m_mixChannelRight[3],
+        m_mixChannelRight[4],
+        m_mixChannelRight[5],
+        m_mixChannelRight[6],
+        m_mixChannelRight[7],
+        outputBuffer.m_workingLR[0],
+        outputBuffer.m_workingLR[1]);
+
+    if ( m_multiTrackRecording )
+    {
+        const bool repComEnabled = isRepComEnabled();
+
+        // repetition compression is being activated or suspended, meaning we need to take just a chunk of the 
+        // presented samples rather than all of it
+        if ( repComEnabled && ( m_repcomState == RepComState::SampleFragmentAndPause ||
+                                m_repcomState == RepComState::SampleFragmentAndResume ) )
+        {
+            const auto fragmentSampleCount = std::min( (uint32_t)m_repcomSampleEnd, samplesToWrite ) - m_repcomSampleStart;
+
+            blog::mix( "[ REPCOM ] Fragmenting ({})  [ {} ] -> [ {} ]  ({} samples)",
+                ( m_repcomState == RepComState::SampleFragmentAndPause ) ? "Pausing" : "Resuming",
+                m_repcomSampleStart,
+                m_repcomSampleStart + fragmentSampleCount,
+                fragmentSampleCount );
+
+            for ( auto i = 0; i < 8; i++ )
+            {
+                m_multiTrackOutputs[i]->appendSamples(
+                    m_mixChannelLeft[i] + m_repcomSampleStart,
+                    m_mixChannelRight[i] + m_repcomSampleStart,
+                    fragmentSampleCount );
+            }
+        }
+        else if ( !repComEnabled || m_repcomState == RepComState::Unpaused )
+        {
+            for ( auto i = 0; i < 8; i++ )
+            {
+                m_multiTrackOutputs[i]->appendSamples( m_mixChannelLeft[i], m_mixChannelRight[i], samplesToWrite );
+            }
+        }
+    }
+    {
+        if ( m_repcomState == RepComState::SampleFragmentAndPause )
+             m_repcomState  = RepComState::Paused;
+        if ( m_repcomState == RepComState::SampleFragmentAndResume )
+        {
+            m_repcomState       = RepComState::Unpaused;
+            m_repcomPausedOnBar = -1;
+        }
+
+        m_repcomSampleStart = 0;
+        m_repcomSampleEnd   = cSampleCountMax;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ProgressionEngine::beginRecording( const fs::path& outputPath, const std::string& filePrefix )
+{
+    // should not be calling this if we're already in the process of streaming out
+    assert( !isRecording() );
+    if ( isRecording() )
+        return false;
+
+    // set up 8 FLAC output streams, one for each Endlesss layer, sharing one pool of encoder threads
+    std::vector< fs::path > recordFiles;
+    for ( auto i = 0; i < 8; i++ )
+        recordFiles.emplace_back( outputPath / fmt::format( "{}beam_channel{}.flac", filePrefix, i ) );
+
+    auto recorderResult = ssp::FLACMultiTrackRecorder::Create( recordFiles, m_audioSampleRate, m_multiTrackConfig );
+    if ( !recorderResult.ok() )
+    {
+        blog::error::app( FMTX( "unable to begin multitrack recording : {}" ), recorderResult.status().ToString() );
+        return false;
+    }
+
+    for ( auto i = 0; i < 8; i++ )
+        m_multiTrackOutputs[i] = recorderResult.value()->getTrackProcessor( i );
+
+    m_multiTrackFLAC = recorderResult.value();
+
+    // tell the worker thread to begin writing to our streams
+    m_commandQueue.enqueue( EngineCommand::BeginRecording );
+    m_multiTrackInFlux = true;
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ProgressionEngine::update(
+    const AudioBuffer&  outputBuffer,
+    const AudioSignal&  outputSignal,
+    const uint32_t      samplesToWrite,
+    const uint64_t      samplePosition )
+{
+    m_samplePosition = samplePosition;
+    m_timeInfo.samplePos = (double)samplePosition;
+
+    stemAmalgamUpdate();
+
+    const double linearTimeStep = (double)samplesToWrite / (double)m_audioSampleRate;
+
+    const auto notifyRepComOfActivity = [&]( uint32_t newStartSample )
+    {
+        assert( m_repcomState != RepComState::SampleFragmentAndResume );
+        if ( m_repcomState == RepComState::Paused )
+        {
+            blog::mix( "[ REPCOM ] UNPAUSE on new activity @ {} -> {}", newStartSample, samplesToWrite );
+
+            m_repcomSampleStart = newStartSample;
+            m_repcomSampleEnd   = cSampleCountMax;
+            m_repcomState       = RepComState::SampleFragmentAndResume;
+        }
+    };
+
+    // make the newest voice the current riff, the one that drives bar timing, recording edges and the UI
+    const auto exchangeLiveRiff = [&]
+    {
+        const auto* newestVoice = m_riffVoices.getNewestVoice();
+        if ( newestVoice != nullptr )
+        {
+            m_riffCurrent.m_riffPtr     = newestVoice->m_riffPtr;
+            m_riffCurrent.m_permutation = newestVoice->m_permutation;
+        }
+        else
+        {
+            m_riffCurrent = {};
+        }
+        m_transitionValue       = 0.0f;
+        m_transitionPending     = false;
+        m_repcomRepeatBar       = 0;
+
+        m_abletonLinkControl->m_authorativeInterval = 1;
+    };
+
+    // process commands from the main thread
+    {
+        EngineCommandData engineCmd;
+        if ( m_commandQueue.try_dequeue( engineCmd ) )
+        {
+            switch ( engineCmd.getCommand() )
+            {
+                // start multitrack on the edge of a riff; the actual recording begins 
+                // when that is detected during the sample loop below
+                case EngineCommand::BeginRecording:
+                {
+                    m_multiTrackWaitingToRecordOnRiffEdge = true;
+                }
+                break;
+
+                // cleanly disengage recording from the mix thread
+                case EngineCommand::StopRecording:
+                {
+                    m_multiTrackWaitingToRecordOnRiffEdge = false;
+                    m_multiTrackRecording                 = false;
+                    m_multiTrackInFlux                    = false;
+
+                    // move recorders over to destroy on the main thread, avoid any stalls
+                    // from whatever may be required to tie off recording
+                    for ( auto i = 0; i < 8; i++ )
+                    {
+                        assert( m_multiTrackOutputsToDestroyOnMainThread[i] == nullptr );
+
+                        m_multiTrackOutputsToDestroyOnMainThread[i] = m_multiTrackOutputs[i];
+                        m_multiTrackOutputs[i].reset();
+                    }
+
+                    blog::mix( "[ Multitrack ] ... Stopped" );
+                }
+                break;
+
+                case EngineCommand::UpdateProgressionConfiguration:
+                {
+                    assert( engineCmd.getPtr() != nullptr );
+                    m_progression = *engineCmd.getPtrAs< ProgressionConfiguration >();
+                    m_riffVoices.setCurve( m_progression.m_blendCurve );
+                }
+                break;
+
+                case EngineCommand::UpdateRepComConfiguration:
+                {
+                    assert( !isRecording() );   // should not be allowed to update if recording is already underway
+                    assert( engineCmd.getPtr() != nullptr );
+                    m_repcom = *engineCmd.getPtrAs< RepComConfiguration >();
+                }
+                break;
+
+                case EngineCommand::ClearCurrentlyPlaying:
+                {
+                    m_riffVoices.clear();
+                    exchangeLiveRiff();
+                }
+                break;
+
+                case EngineCommand::ClearAllScheduledTransitions:
+                {
+                    // purge the queue
+                    RiffAndPermutation dumpRiff;
+                    while ( m_riffQueue.try_dequeue( dumpRiff ) )
+                    { }
+                }
+                break;
+
+                default:
+                case EngineCommand::Invalid:
+                    blog::error::mix( "Unknown or invalid command received" );
+                    break;
+            }
+        }
+    }
+
+    // pull the next riff off the queue and start it blending in; anything already playing or part-way through a
+    // blend fades out from wherever it currently is, so back-to-back arrivals layer rather than wait their turn
+    const auto checkForAndDequeueNextRiff = [&]
+    {
+        if ( m_riffQueue.peek() == nullptr )
+            return false;
+
+        RiffAndPermutation riffNext;
+        if ( !m_riffQueue.try_dequeue( riffNext ) )
+        {
+            assert( false );
+            return false;
+        }
+
+        blog::mix( "[ BLEND ] DEQUEUED new riff" );
+
+        if ( riffNext.m_riffPtr->getSyncState() != endlesss::live::Riff::SyncState::Success )
+        {
+            blog::error::mix( "[ BLEND ] .. new riff invalid, ignoring it" );
+            return false;
+        }
+
+        // hard cut, or nothing playing to blend from
+        if ( m_progression.m_blendTime == ProgressionConfiguration::BlendTime::Zero ||
+             m_riffCurrent.isEmpty() )
+        {
+            blog::mix( "[ BLEND ] hard cut" );
+            m_riffVoices.begin( riffNext.m_riffPtr, riffNext.m_permutation, 0, 0.0 );
+            exchangeLiveRiff();
+        }
+        // pick blend time based on how many bars to take
+        else
+        {
+            const double blendTimeInSeconds = riffNext.m_riffPtr->m_timingDetails.m_lengthInSecPerBar * m_progression.getBlendTimeMultiplier();
+            m_riffVoices.begin( riffNext.m_riffPtr, riffNext.m_permutation, 0, blendTimeInSeconds );
+            m_transitionPending = true;
+
+            blog::mix( "[ BLEND ] begin, {} riffs now audible", m_riffVoices.getVoiceCount() );
+        }
+
+        return true;
+    };
+
+    // in Arbitrary mode, check all the time to see if we could be switching
+    if ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::Arbitrary )
+    {
+        checkForAndDequeueNextRiff();
+    }
+
+    // early out if we have nothing to play or the active riff is 0-length
+    if ( m_riffCurrent.isEmpty() ||
+         m_riffCurrent.m_riffPtr->m_timingDetails.m_lengthInSamples == 0 )
+    {
+        outputBuffer.applySilence();
+
+        // reset computed riff playback variables
+        m_playbackProgression.reset();
+
+        // check if there's something on the horizon
+        if ( m_riffQueue.peek() != nullptr )
+        {
+            if ( checkForAndDequeueNextRiff() )
+            {
+                blog::mix( "[ BLEND ] hard cut to first riff" );
+                notifyRepComOfActivity( 0 );
+            }
+        }
+
+        // deal with LINK session update with nothing playing
+        {
+            m_abletonLinkControl->Transaction_StopPlaying();
+            m_abletonLinkControl->m_sampleTime += static_cast<double>(samplesToWrite);
+        }
+
+        return;
+    }
+
+
+
+    // hold on to the current riff for the duration; a hard cut mid-block may replace m_riffCurrent
+    const endlesss::live::RiffPtr currentRiffPtr = m_riffCurrent.m_riffPtr;
+    const endlesss::live::Riff* currentRiff = currentRiffPtr.get();
+
+    // compute where we are (roughly) for the UI
+    currentRiff->getTimingDetails().ComputeProgressionAtSample( m_samplePosition, m_playbackProgression );
+
+
+
+    // update vst time structure with latest state
+    m_timeInfo.tempo              = currentRiff->m_timingDetails.m_bpm;
+    m_timeInfo.timeSigNumerator   = currentRiff->m_timingDetails.m_quarterBeats;
+    m_timeInfo.timeSigDenominator = 4;
+
+    // the current riff's bars and loop points decide where transitions and recording can begin; between those edges
+    // the voices render whole spans at a time
+    const uint64_t riffLengthInSamples      = currentRiff->m_timingDetails.m_lengthInSamples;
+    const uint64_t segmentLengthInSamples   = currentRiff->m_timingDetails.m_lengthInSamplesPerBar;
+          uint64_t segmentSampleStart       = samplePosition % segmentLengthInSamples;
+
+    uint32_t sI = 0;
+    while ( sI < samplesToWrite )
+    {
+        // get sample position in context of the riff
+        const uint64_t riffSample = ( samplePosition + sI ) % riffLengthInSamples;
+
+        while ( segmentSampleStart >= segmentLengthInSamples )
+        {
+            segmentSampleStart -= segmentLengthInSamples;
+
+            m_playbackProgression.m_playbackBar++;
+            if ( m_playbackProgression.m_playbackBar >= currentRiff->m_timingDetails.m_barCount )
+                m_playbackProgression.m_playbackBar = 0;
+        }
+
+        if ( segmentSampleStart == 0 )
+        {
+//            blog::mix( "[ Edge ] Bar {}", m_riffPlaybackBar + 1 );
+
+            const bool isEvenBarNumber = (m_playbackProgression.m_playbackBar & 1 ) == 0;
+            const bool shouldTriggerTransition =
+                // any bar
+                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::AnyBarStart ) ||
+                // 0, 2, 4, .. 
+                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::AnyEvenBarStart && isEvenBarNumber ) ||
+                // next riff is bar 0
+                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::NextRiffStart && m_playbackProgression.m_playbackBar == 0 );
+
+            if ( shouldTriggerTransition )
+            {
+                bool allowedToTrigger = true;
+
+                if ( isRepComPaused() && m_repcomPausedOnBar != m_playbackProgression.m_playbackBar )
+                    allowedToTrigger = false;
+
+                if ( allowedToTrigger && checkForAndDequeueNextRiff() )
+                {
+                    notifyRepComOfActivity( sI );
+                }
+            }
+
+            if ( m_multiTrackRecording )
+            {
+                m_repcomRepeatBar++;
+
+                const bool repComTriggerPause = isRepComEnabled() &&
+                                                m_repcomRepeatBar >= currentRiff->m_timingDetails.m_longestStemInBars;
+
+                if (    repComTriggerPause
+                     && m_repcomState           == RepComState::Unpaused
+                     && !m_riffVoices.isTransitioning() )
+                {
+                    blog::mix( "[ REPCOM ] Pausing @ bar {}, sample offset {}", m_playbackProgression.m_playbackBar, sI );
+
+                    m_repcomPausedOnBar = m_playbackProgression.m_playbackBar;
+
+                    m_repcomSampleStart = 0;
+                    m_repcomSampleEnd   = sI;
+                    m_repcomState       = RepComState::SampleFragmentAndPause;
+                }
+            }
+        }
+        if ( riffSample == 0 )
+        {
+            blog::mix( "[ Edge ] Riff" );
+
+            // multitrack recording waits till the start of a riff to begin
+            if ( m_multiTrackWaitingToRecordOnRiffEdge )
+            {
+                // begin writing out data
+                m_multiTrackRecording                 = true;
+                m_multiTrackWaitingToRecordOnRiffEdge = false;
+                m_multiTrackInFlux                    = false;
+
+                // reset repcom stats
+                m_repcomRepeatBar                     = 0;
+
+                blog::mix( "[ Multitrack ] Recording ..." );
+            }
+        }
+
+        // run up to whichever edge comes next
+        const uint32_t spanLength = (uint32_t)std::min( {
+            (uint64_t)( samplesToWrite - sI ),
+            segmentLengthInSamples - segmentSampleStart,
+            riffLengthInSamples - riffSample } );
+
+        // every audible voice feeds the amalgam, weighted by where it is in its fade, so visuals follow the blend
+        m_riffVoices.amalgamate( samplePosition + sI, spanLength, m_stemDataAmalgam );
+        m_riffVoices.render( samplePosition + sI, sI, spanLength, m_mixChannelLeft, m_mixChannelRight );
+
+        segmentSampleStart += spanLength;
+        sI                 += spanLength;
+    }
+
+    // once the newest riff has fully blended in it becomes the current one
+    {
+        const auto* newestVoice = m_riffVoices.getNewestVoice();
+        if ( newestVoice != nullptr && m_transitionPending )
+        {
+            if ( newestVoice->isSteady() )
+            {
+                blog::mix( "[ BLEND ] completed" );
+                exchangeLiveRiff();
+            }
+            else
+            {
+                m_transitionValue = newestVoice->m_fade;
+            }
+        }
+        m_riffVoicesActive = (uint32_t)m_riffVoices.getVoiceCount();
+    }
+
+    m_stemDataAmalgamSamplesUsed += samplesToWrite;
+
+    // LINK logic EXTREMELY WIP HACK
+    if ( currentRiff != nullptr )
+    {
+        const auto& timingData = currentRiff->getTimingDetails();
+
+        // compute timing state when update() began
+        endlesss::live::RiffProgression progressionAtEndOfUpdate;
+        currentRiff->getTimingDetails().ComputeProgressionAtSample(
+            m_samplePosition + samplesToWrite,
+            progressionAtEndOfUpdate );
+
+        const double timingQuantum = static_cast<double>(timingData.m_quarterBeats);
+
+        const auto hostTime = m_abletonLinkControl->m_hostTimeFilter.sampleTimeToHostTime( m_abletonLinkControl->m_sampleTime );
+        m_abletonLinkControl->m_sampleTime += static_cast<double>(samplesToWrite);
+
+        const auto bufferBeginAtOutput = hostTime + m_abletonLinkControl->m_outputLatency;
+
+        auto linkSessionState = m_abletonLinkControl->m_link.captureAudioSessionState();
+
+        // always write our tempo. we are the tempo.
+        linkSessionState.setTempo( timingData.m_bpm, bufferBeginAtOutput );
+
+        // on the arrival of a new riff when nothing was playing, tag IsPlaying in the session state and force
+        // a new 0-beat to match
+        if ( !m_abletonLinkControl->m_linkIsPlaying )
+        {
+            linkSessionState.setIsPlaying( true, bufferBeginAtOutput );
+            linkSessionState.forceBeatAtTime( 0, bufferBeginAtOutput, timingQuantum );
+            m_abletonLinkControl->m_linkIsPlaying = true;
+        }
+
+        if ( progressionAtEndOfUpdate.m_playbackBarSegment != m_playbackProgression.m_playbackBarSegment )
+        {
+            std::chrono::microseconds zeroBeatUsOffset( std::llround( progressionAtEndOfUpdate.m_playbackQuarterTimeSec * 1.0e6 ) );
+
+            if ( progressionAtEndOfUpdate.m_playbackBarSegment == 0 || m_abletonLinkControl->m_authorativeInterval >= 0 )
+                linkSessionState.forceBeatAtTime( progressionAtEndOfUpdate.m_playbackBarSegment, bufferBeginAtOutput + zeroBeatUsOffset, timingQuantum );
+            else
+                linkSessionState.requestBeatAtTime( progressionAtEndOfUpdate.m_playbackBarSegment, bufferBeginAtOutput + zeroBeatUsOffset, timingQuantum );
+
+            if ( m_abletonLinkControl->m_authorativeInterval >= 0 )
+            {
+                m_abletonLinkControl->m_authorativeInterval--;
+                blog::mix( FMTX( "authorativeInterval:{}" ), m_abletonLinkControl->m_authorativeInterval );
+            }
+        }
+
+        m_abletonLinkControl->m_link.commitAudioSessionState( linkSessionState );
+    }
+
+    commit( outputBuffer, outputSignal, samplesToWrite );
+}
+
+} // namespace mix
@@ -0,0 +1,359 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+
+#pragma once
+
+#include "base/utils.h"
+
+#include "mix/common.h"
+#include "mix/voices.h"
+
+#include "app/module.audio.h"
+#include "ssp/ssp.file.flac.multitrack.h"
+
+namespace mix {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// BEAM's mixer; riffs arrive on a queue and are blended in on chosen bar or riff edges, with optional multitrack
+// recording that can skip over long stretches of repeated bars ("repetition compression")
+//
+struct ProgressionEngine final : public app::module::MixerInterface,
+                                 public rec::IRecordable,
+                                 public RiffMixerBase
+{
+    using AudioBuffer = app::module::Audio::OutputBuffer;
+    using AudioSignal = app::module::Audio::OutputSignal;
+
+    static constexpr uint32_t cSampleCountMax = std::numeric_limits<uint32_t>::max();
+
+    // 
+    struct ProgressionConfiguration
+    {
+        ProgressionConfiguration()
+            : m_triggerPoint( TriggerPoint::AnyBarStart )
+            , m_blendTime( BlendTime::TwoBars )
+            , m_blendCurve( CrossfadeCurve::EqualPower )
+            , m_greedyMode( false )
+        {}
+
+        bool operator==( ProgressionConfiguration const& ) const = default;
+
+        // choose when to begin blending to the next riff
+        enum class TriggerPoint
+        {
+            Arbitrary,                      // start blending whenever a new riff arrives, yolo
+            NextRiffStart,                  //             .. when a riff loops around to the beginning (ie. once per riff loop)
+            AnyBarStart,                    //             .. when a bar segment is crossed (or near enough) (ie. usually 8 opportunities per riff loop)
+            AnyEvenBarStart,                //             .. when an even-numbered bar is crossed
+        }               m_triggerPoint;
+
+        static constexpr size_t cTriggerPointCount = 4;
+        static constexpr std::array< const char*, cTriggerPointCount > cTriggerPointNames {{
+            "At Any Point",
+            "At Riff Start",
+            "At Any Bar Start",
+            "At Even Bar Start"
+        }};
+        inline static const char* getTriggerPointName( const TriggerPoint tp )
+        {
+            return cTriggerPointNames[(size_t)tp];
+        }
+        inline static bool triggerPointGetter( void* data, int idx, const char** out_text )
+        {
+            *out_text = getTriggerPointName( (TriggerPoint)idx );
+            return true;
+        }
+
+        // how long the blend should take
+        enum class BlendTime
+        {
+            Zero,
+            OneBar,
+            TwoBars,
+            FourBars,
+            EightBars
+        }               m_blendTime;
+
+        static constexpr size_t cBlendTimeCount = 5;
+        static constexpr std::array< const char*, cBlendTimeCount > cBlendTimeNames {{
+            "Instant",
+            "One Bar",
+            "Two Bars",
+            "Four Bars",
+            "Eight Bars"
+        }};
+        inline static const char* getBlendTimeName( const BlendTime bt )
+        {
+            return cBlendTimeNames[(size_t)bt];
+        }
+        inline static bool blendTimeGetter( void* data, int idx, const char** out_text )
+        {
+            *out_text = getBlendTimeName( (BlendTime)idx );
+            return true;
+        }
+        inline float getBlendTimeMultiplier() const
+        {
+            switch ( m_blendTime )
+            {
+            default:
+            case ProgressionConfiguration::BlendTime::OneBar:    return 1.0f;
+            case ProgressionConfiguration::BlendTime::TwoBars:   return 2.0f;
+            case ProgressionConfiguration::BlendTime::FourBars:  return 4.0f;
+            case ProgressionConfiguration::BlendTime::EightBars: return 8.0f;
+            }
+        }
+
+        // shape of the gain curves used when blending
+        CrossfadeCurve
+                        m_blendCurve;
+
+        // custom curves need a table supplied from code, so only offer the built-in shapes
+        static constexpr size_t cBlendCurveCount = 3;
+        inline static bool blendCurveGetter( void* data, int idx, const char** out_text )
+        {
+            *out_text = getCrossfadeCurveName( (CrossfadeCurve)idx );
+            return true;
+        }
+
+        bool            m_greedyMode;       // if on and there are multiple 'next riffs' in the queue when it comes time to begin
+                                            // blending, empty the list and only blend to the most recent one. if off, we will
+                                            // work our way through each enqueued change in turn
+    };
+
+    struct RepComConfiguration
+    {
+        bool            m_enable = false;   // if multi-track is started, use repcom logic
+    };
+
+    enum class EngineCommand
+    {
+        Invalid,
+        BeginRecording,
+        StopRecording,
+        UpdateProgressionConfiguration,     // pass ProgressionConfiguration*
+        UpdateRepComConfiguration,          // pass RepComConfiguration*
+        ClearCurrentlyPlaying,
+        ClearAllScheduledTransitions
+    };
+    struct EngineCommandData : public base::BasicCommandType<EngineCommand> { using BasicCommandType::BasicCommandType; };
+
+    // bundles a riff request - both the riff data and any layer permutations
+    struct RiffAndPermutation
+    {
+        RiffAndPermutation() = default;
+
+        RiffAndPermutation( endlesss::live::RiffPtr riff )
+            : m_riffPtr( std::move( riff ) )
+        {}
+
+        RiffAndPermutation( endlesss::live::RiffPtr riff, const endlesss::types::RiffPlaybackPermutationOpt& permOpt )
+            : m_riffPtr( std::move( riff ) )
+        {
+            if ( permOpt.has_value() )
+            {
+                m_permutation = permOpt.value();
+            }
+        }
+
+        bool isNotEmpty() const { return m_riffPtr != nullptr; }
+        bool isEmpty() const { return m_riffPtr == nullptr; }
+
+        endlesss::live::RiffPtr                     m_riffPtr;
+        endlesss::types::RiffPlaybackPermutation    m_permutation;
+    };
+
+    using CommandQueue  = mcc::ReaderWriterQueue<EngineCommandData>;
+    using RiffQueue     = mcc::ReaderWriterQueue<RiffAndPermutation>;
+
+
+    uint64_t                    m_samplePosition;
+
+
+    RiffAndPermutation          m_riffCurrent;
+    uint32_t                    m_riffLengthInSamples;
+
+    endlesss::live::RiffProgression
+                                m_playbackProgression;
+
+    RiffQueue                   m_riffQueue;
+    CommandQueue                m_commandQueue;
+
+    RiffVoices                  m_riffVoices;               // every riff currently audible, including those blending in or out
+    float                       m_transitionValue;          // fade-in progress of the newest riff, for the UI
+    bool                        m_transitionPending;        // newest riff is still blending in and has not yet become m_riffCurrent
+    std::atomic_uint32_t        m_riffVoicesActive;         // voice count, for the UI
+
+    float                       m_stemBeatRate;
+
+    ProgressionConfiguration    m_progression;
+
+    struct AbletonLinkControl;
+    AbletonLinkControl*         m_abletonLinkControl;
+
+
+    ProgressionEngine( const int32_t maxBufferSize, const int32_t sampleRate, const std::chrono::microseconds outputLatency, base::EventBusClient& eventBusClient );
+    ~ProgressionEngine();
+
+    const app::AudioPlaybackTimeInfo* getPlaybackTimeInfo() const override { return getTimeInfoPtr(); }
+
+
+    inline void addNextRiff( const endlesss::live::RiffPtr& nextRiff )
+    {
+        m_riffQueue.emplace( nextRiff );
+    }
+
+    // add new riff with an optional permutation packet
+    inline void addNextRiff( const endlesss::live::RiffPtr& nextRiff, const endlesss::types::RiffPlaybackPermutationOpt& permOpt )
+    {
+        m_riffQueue.emplace( nextRiff, permOpt );
+    }
+
+
+    inline void updateProgressionConfiguration( const ProgressionConfiguration* pConfig )
+    {
+        m_commandQueue.emplace( EngineCommand::UpdateProgressionConfiguration, (void*) pConfig );
+    }
+
+    void clearAllScheduledTransitions()
+    {
+        m_commandQueue.emplace( EngineCommand::ClearAllScheduledTransitions );
+    }
+
+    inline void updateRepComConfiguration( const RepComConfiguration* pConfig )
+    {
+        m_commandQueue.emplace( EngineCommand::UpdateRepComConfiguration, (void*)pConfig );
+    }
+
+    inline void clearCurrentPlayback()
+    {
+        m_commandQueue.emplace( EngineCommand::ClearCurrentlyPlaying );
+    }
+
+    void enableAbletonLink( bool bEnabled );
+
+
+    inline uint32_t getBarRepetitions() const { return m_repcomRepeatBar; }
+
+    inline bool isRepComEnabled() const { return m_repcom.m_enable; }
+    inline bool isRepComPaused() const { return isRepComEnabled() && ( m_repcomState != RepComState::Unpaused ); }
+    inline int32_t getBarPausedOn() const { return m_repcomPausedOnBar; }
+
+
+    void update(
+        const AudioBuffer&  outputBuffer,
+        const AudioSignal&  outputSignal,
+        const uint32_t      samplesToWrite,
+        const uint64_t      samplePosition ) override;
+
+    void commit(
+        const AudioBuffer&  outputBuffer,
+        const AudioSignal&  outputSignal,
+        const uint32_t      samplesToWrite );
+
+    void mainThreadUpdate( const float dT, endlesss::toolkit::Exchange& beatEx )
+    {
+        for ( auto layer = 0U; layer < 8; layer++ )
+            m_multiTrackOutputsToDestroyOnMainThread[layer].reset();
+    }
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// rec::IRecordable
+
+public:
+
+    // applies to the next multitrack recording started
+    inline void setMultiTrackEncoderOptions( const ssp::FLACEncoderOptions& options )
+    {
+        m_multiTrackConfig.m_encoder = options;
+    }
+
+    // the running FLAC recorder, if any, for displaying encoder statistics
+    inline std::shared_ptr< ssp::FLACMultiTrackRecorder > getMultiTrackRecorder() const
+    {
+        return m_multiTrackFLAC.lock();
+    }
+
+    bool beginRecording( const fs::path& outputPath, const std::string& filePrefix ) override;
+
+    inline void stopRecording() override
+    {
+        // can't stop what hasn't started
+        assert( isRecording() );
+        if ( !isRecording() )
+            return;
+
+        m_commandQueue.enqueue( EngineCommand::StopRecording );
+        m_multiTrackInFlux = true;
+    }
+
+    // either we're fully engaged with writing out the stream or the request to do (or to stop) is still in-flight
+    inline bool isRecording() const override
+    {
+        return m_multiTrackRecording || 
+               m_multiTrackInFlux;
+    }
+
+    inline uint64_t getRecordingDataUsage() const override
+    {
+        if ( !isRecording() )
+            return 0;
+
+        uint64_t usage = 0;
+        for ( auto i = 0; i < 8; i++ )
+            usage += m_multiTrackOutputs[i]->getStorageUsageInBytes();
+
+        return usage;
+    }
+
+    inline std::string_view getRecorderName() const override { return " Multitrack "; }
+    inline const char* getFluxState() const override
+    {
+        if ( m_repcomState != RepComState::Unpaused )
+            return "[PAUSED] ";
+        if ( m_multiTrackInFlux )
+            return " Awaiting Loop Start";
+
+        return nullptr;
+    }
+
+
+private:
+
+    using MultiTrackStreams = std::array < std::shared_ptr<ssp::ISampleStreamProcessor>, 8 >;
+
+    ssp::FLACMultiTrackRecorder::Config             m_multiTrackConfig;
+    std::weak_ptr< ssp::FLACMultiTrackRecorder >    m_multiTrackFLAC;       // watched for encoder stats while recording
+
+    bool                m_multiTrackInFlux;
+    bool                m_multiTrackWaitingToRecordOnRiffEdge;
+    bool                m_multiTrackRecording;
+    MultiTrackStreams   m_multiTrackOutputs;                        // currently live recorders
+    MultiTrackStreams   m_multiTrackOutputsToDestroyOnMainThread;   // recorders ready to decommission on main thread
+
+
+    // multitrack "repetition compression" (RepCom) 
+
+    // repcom config written to via engine command
+    RepComConfiguration m_repcom;
+
+    // repcom internal state
+    int32_t             m_repcomRepeatBar;
+    int32_t             m_repcomPausedOnBar;
+    int32_t             m_repcomRepeatLimit;
+    uint32_t            m_repcomSampleStart;
+    uint32_t            m_repcomSampleEnd;
+    enum class RepComState
+    {
+        Unpaused,
+        SampleFragmentAndPause,
+        Paused,
+        SampleFragmentAndResume
+    }                   m_repcomState;
+};
+
+} // namespace mix
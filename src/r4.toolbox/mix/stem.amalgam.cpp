@@ -9,8 +9,6 @@
 
 #include "mix/stem.amalgam.h"
 
-namespace stdp = std::placeholders;
-
 namespace mix {
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -19,9 +17,10 @@ absl::Status StemDataProcessor::connect( base::EventBusPtr appEventBus )
     if ( m_eventListenerStemDataAmalgam != base::EventListenerID::invalid() )
         return absl::UnknownError( "already connected to stem data event bus" );
 
-    m_eventListenerStemDataAmalgam = appEventBus->addListener(
-        events::StemDataAmalgamGenerated::ID, 
-        std::bind( &StemDataProcessor::handleNewStemAmalgam, this, stdp::_1 ) );
+    m_eventListenerStemDataAmalgam = appEventBus->addHandler< events::StemDataAmalgamGenerated >(
+        this,
+        []( StemDataProcessor* self, const events::StemDataAmalgamGenerated& stemDataEvent ) { self->handleNewStemAmalgam( stemDataEvent ); },
+        base::EventDelivery::worker( "mix" ) );     // sent at audio-block rate, don't tie it to the UI frame
 
     return absl::OkStatus();
 }
@@ -42,14 +41,11 @@ absl::Status StemDataProcessor::disconnect( base::EventBusPtr appEventBus )
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void StemDataProcessor::handleNewStemAmalgam( const base::IEvent& eventPtr )
+void StemDataProcessor::handleNewStemAmalgam( const events::StemDataAmalgamGenerated& stemDataEvent )
 {
-    ABSL_ASSERT( eventPtr.getID() == events::StemDataAmalgamGenerated::ID );
-
-    const events::StemDataAmalgamGenerated* stemDataEvent = dynamic_cast<const events::StemDataAmalgamGenerated*>(&eventPtr);
-    ABSL_ASSERT( stemDataEvent != nullptr );
+    std::scoped_lock<std::mutex> stateLock( m_stateMutex );
 
-    m_stemAmalgam = stemDataEvent->m_stemDataAmalgam;
+    m_stemAmalgam = stemDataEvent.m_stemDataAmalgam;
 
     int32_t simultaneousBeats = 0;
     for ( auto stemI = 0U; stemI < 8; stemI++ )
@@ -12,6 +12,7 @@
 
 #include "endlesss/toolkit.exchange.h"
 
+namespace events { struct StemDataAmalgamGenerated; }
 
 namespace mix {
 
@@ -44,23 +45,29 @@ struct StemDataProcessor
     absl::Status connect( base::EventBusPtr appEventBus );
     absl::Status disconnect( base::EventBusPtr appEventBus );
 
-    constexpr void reset()
+    void reset()
     {
+        std::scoped_lock<std::mutex> stateLock( m_stateMutex );
+
         m_stemAmalgam.reset();
         m_stemAmalgamConsensus = 0.0f;
     }
 
     // tick value decays
-    constexpr void update( const float deltaTime, const float timeToDecayInSec )
+    void update( const float deltaTime, const float timeToDecayInSec )
     {
+        std::scoped_lock<std::mutex> stateLock( m_stateMutex );
+
         const float decayValue = (1.0f / timeToDecayInSec) * deltaTime;
 
         m_stemAmalgamConsensus = std::max( 0.0f, m_stemAmalgamConsensus - decayValue );
     }
 
     // blit the current state into the given exchange data block
-    constexpr void copyToExchangeData( endlesss::toolkit::Exchange& exchangeData )
+    void copyToExchangeData( endlesss::toolkit::Exchange& exchangeData )
     {
+        std::scoped_lock<std::mutex> stateLock( m_stateMutex );
+
         for ( auto stemI = 0U; stemI < 8; stemI++ )
         {
             exchangeData.m_stemBeat[stemI]   = m_stemAmalgam.m_beat[stemI];
@@ -72,18 +79,21 @@ struct StemDataProcessor
     }
 
     // accessors for the current state
-    ouro_nodiscard constexpr const std::array< float, 8 >& getWave() const { return m_stemAmalgam.m_wave; }
-    ouro_nodiscard constexpr const std::array< float, 8 >& getBeat() const { return m_stemAmalgam.m_beat; }
-    ouro_nodiscard constexpr float getConsensus() const { return m_stemAmalgamConsensus; }
+    ouro_nodiscard std::array< float, 8 > getWave() const { std::scoped_lock<std::mutex> stateLock( m_stateMutex ); return m_stemAmalgam.m_wave; }
+    ouro_nodiscard std::array< float, 8 > getBeat() const { std::scoped_lock<std::mutex> stateLock( m_stateMutex ); return m_stemAmalgam.m_beat; }
+    ouro_nodiscard float getConsensus() const { std::scoped_lock<std::mutex> stateLock( m_stateMutex ); return m_stemAmalgamConsensus; }
 
 protected:
 
     base::EventListenerID                   m_eventListenerStemDataAmalgam = base::EventListenerID::invalid();
 
+    // amalgam events arrive on an event bus worker queue, state is read from the main thread
+    mutable std::mutex                      m_stateMutex;
+
     StemDataAmalgam                         m_stemAmalgam;
     float                                   m_stemAmalgamConsensus;
 
-    void handleNewStemAmalgam( const base::IEvent& eventPtr );
+    void handleNewStemAmalgam( const events::StemDataAmalgamGenerated& stemDataEvent );
 };
 
 } // namespace mix
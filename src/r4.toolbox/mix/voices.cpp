@@ -0,0 +1,481 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+
+#include "pch.h"
+
+#include "mix/voices.h"
+#include "mix/stem.amalgam.h"
+#include "buffer/mix.h"
+
+#include "endlesss/live.stem.h"
+
+namespace mix {
+
+// ---------------------------------------------------------------------------------------------------------------------
+RiffVoices::RiffVoices( const int32_t maxBufferSize, const int32_t sampleRate )
+    : m_maxBufferSize( maxBufferSize )
+    , m_sampleRateRecp( 1.0 / (double)sampleRate )
+{
+    m_envelope    = mem::alloc16To<float>( m_maxBufferSize, 0.0f, mem::Tag::Riffs );
+    m_decodeLeft  = mem::alloc16To<float>( m_maxBufferSize, 0.0f, mem::Tag::Riffs );
+    m_decodeRight = mem::alloc16To<float>( m_maxBufferSize, 0.0f, mem::Tag::Riffs );
+
+    // default custom curve is a straight line until someone provides something more interesting
+    for ( std::size_t point = 0; point < cCustomCurvePoints; point++ )
+        m_customCurve[point] = (float)point / (float)( cCustomCurvePoints - 1 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+RiffVoices::~RiffVoices()
+{
+    mem::free16( m_decodeRight, mem::Tag::Riffs );
+    mem::free16( m_decodeLeft, mem::Tag::Riffs );
+    mem::free16( m_envelope, mem::Tag::Riffs );
+    m_envelope = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffVoices::begin(
+    const endlesss::live::RiffPtr&  riff,
+    const Permutation&              permutation,
+    const int64_t                   timeBase,
+    const double                    fadeInSeconds,
+    const uint8_t                   stemMask )
+{
+    const bool hardCut = ( fadeInSeconds <= 0 );
+
+    if ( hardCut )
+    {
+        clear();
+    }
+    else
+    {
+        // existing voices, whether steady or part-way through their own fade, turn around and head for silence; each
+        // starts a full-length fade-out scaled by the gain it had reached, so it runs in step with the new voice and
+        // the complementary curves keep the summed power where it was
+        const float fadeOutRate = (float)( -1.0 / fadeInSeconds );
+        for ( std::size_t index = 0; index < m_voiceCount; index++ )
+        {
+            Voice& voice = m_voices[index];
+
+            voice.m_fadeOutGain = getVoiceGain( index );
+            voice.m_fade        = 1.0f;
+            voice.m_fadeRate    = fadeOutRate;
+        }
+
+        if ( m_voiceCount == cMaxVoices )
+            retireVoice( 0 );
+    }
+
+    Voice& voice        = m_voices[m_voiceCount++];
+    voice.m_riffPtr     = riff;
+    voice.m_permutation = permutation;
+    voice.m_timeBase    = timeBase;
+    voice.m_stemMask    = stemMask;
+    voice.m_fade        = hardCut ? 1.0f : 0.0f;
+    voice.m_fadeRate    = hardCut ? 0.0f : (float)( 1.0 / fadeInSeconds );
+    voice.m_fadeOutGain = 1.0f;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffVoices::clear()
+{
+    for ( std::size_t index = 0; index < m_voiceCount; index++ )
+        m_voices[index] = {};
+
+    m_voiceCount = 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool RiffVoices::isTransitioning() const
+{
+    for ( std::size_t index = 0; index < m_voiceCount; index++ )
+    {
+        if ( m_voices[index].m_fadeRate != 0 )
+            return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const RiffVoices::Voice* RiffVoices::getNewestVoice() const
+{
+    if ( m_voiceCount == 0 )
+        return nullptr;
+
+    return &m_voices[m_voiceCount - 1];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+float RiffVoices::getVoiceGain( const std::size_t index ) const
+{
+    ABSL_ASSERT( index < m_voiceCount );
+
+    const Voice& voice = m_voices[index];
+    if ( voice.isSteady() )
+        return 1.0f;
+
+    float gain = 0;
+    computeEnvelope( voice, 1, &gain );
+
+    return ( voice.m_fadeRate < 0 ) ? ( gain * voice.m_fadeOutGain ) : gain;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffVoices::retireVoice( const std::size_t index )
+{
+    ABSL_ASSERT( index < m_voiceCount );
+
+    for ( std::size_t shift = index; shift + 1 < m_voiceCount; shift++ )
+        m_voices[shift] = std::move( m_voices[shift + 1] );
+
+    m_voices[--m_voiceCount] = {};
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffVoices::computeEnvelope( const Voice& voice, const uint32_t sampleCount, float* envelope ) const
+{
+    const float fadeStep = (float)( (double)voice.m_fadeRate * m_sampleRateRecp );
+
+    // fading in, shape the fade position directly
+    if ( voice.m_fadeRate >= 0 )
+    {
+        buffer::fade_ramp_clamped( (int)sampleCount, voice.m_fade, fadeStep, envelope );
+
+        switch ( m_curve )
+        {
+            default:
+            case CrossfadeCurve::Linear:
+                break;
+            case CrossfadeCurve::EqualPower:
+                buffer::fade_shape_equal_power( (int)sampleCount, envelope );
+                break;
+            case CrossfadeCurve::SCurve:
+                buffer::fade_shape_s_curve( (int)sampleCount, envelope );
+                break;
+            case CrossfadeCurve::Custom:
+                buffer::fade_shape_table( (int)sampleCount, m_customCurve.data(), (int)cCustomCurvePoints, envelope );
+                break;
+        }
+    }
+    // fading out, work from progress through the fade-out (0 at the start, 1 at silence) and apply the complement
+    // of the fade-in curve at the same progress
+    else
+    {
+        buffer::fade_ramp_clamped( (int)sampleCount, 1.0f - voice.m_fade, -fadeStep, envelope );
+
+        switch ( m_curve )
+        {
+            default:
+            case CrossfadeCurve::Linear:
+                buffer::fade_shape_invert( (int)sampleCount, envelope );
+                break;
+            case CrossfadeCurve::EqualPower:
+                buffer::fade_shape_equal_power_out( (int)sampleCount, envelope );
+                break;
+            case CrossfadeCurve::SCurve:
+                buffer::fade_shape_s_curve( (int)sampleCount, envelope );
+                buffer::fade_shape_invert( (int)sampleCount, envelope );
+                break;
+            case CrossfadeCurve::Custom:
+                buffer::fade_shape_invert( (int)sampleCount, envelope );
+                buffer::fade_shape_table( (int)sampleCount, m_customCurve.data(), (int)cCustomCurvePoints, envelope );
+                break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int64_t RiffVoices::getRiffSampleStart( const Voice& voice, const uint64_t samplePosition )
+{
+    const int64_t riffLengthInSamples = (int64_t)voice.m_riffPtr->m_timingDetails.m_lengthInSamples;
+
+    int64_t riffSampleStart = ( (int64_t)samplePosition - voice.m_timeBase ) % riffLengthInSamples;
+    if ( riffSampleStart < 0 )
+        riffSampleStart += riffLengthInSamples;
+
+    return riffSampleStart;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffVoices::renderVoice(
+    const Voice&                    voice,
+    const uint64_t                  samplePosition,
+    const uint32_t                  offset,
+    const uint32_t                  sampleCount,
+    const std::array< float*, 8 >&  channelLeft,
+    const std::array< float*, 8 >&  channelRight )
+{
+    const endlesss::live::Riff* riff = voice.m_riffPtr.get();
+
+    const int64_t riffLengthInSamples = (int64_t)riff->m_timingDetails.m_lengthInSamples;
+    if ( riffLengthInSamples == 0 )
+        return;
+
+    // where the first sample of this block lands inside the riff, given the voice's own time base
+    const int64_t riffSampleStart = getRiffSampleStart( voice, samplePosition );
+
+    const bool  useEnvelope = !voice.isSteady();
+    const float voiceGain   = ( voice.m_fadeRate < 0 ) ? voice.m_fadeOutGain : 1.0f;
+
+    for ( auto stemI = 0U; stemI < 8; stemI++ )
+    {
+        if ( ( voice.m_stemMask & ( 1U << stemI ) ) == 0 )
+            continue;
+
+        // missing stems simply contribute nothing, which is the same as blending them towards silence
+        const endlesss::live::Stem* stemInst = riff->m_stemPtrs[stemI];
+        if ( stemInst == nullptr || stemInst->hasFailed() )
+            continue;
+
+        const float stemGain = riff->m_stemGains[stemI] * voice.m_permutation.m_layerGainMultiplier[stemI] * voiceGain;
+        if ( stemGain == 0 )
+            continue;
+
+        int64_t stemSampleCount = (int64_t)stemInst->m_sampleCount;
+        if ( stemSampleCount <= 0 )
+            continue;
+
+        // a stem still decoding in the background is only readable up to its watermark; anything past it is skipped
+        int64_t stemSamplesAvailable = (int64_t)stemInst->getSamplesAvailable();
+
+        // compact stems have no float data to point at; spans are expanded into the decode buffers instead
+        bool         stemCompact = stemInst->isCompact();
+        const float* stemLeft    = stemInst->m_channel[0];
+        const float* stemRight   = stemInst->m_channel[1];
+        float*       outLeft     = channelLeft[stemI]  + offset;
+        float*       outRight    = channelRight[stemI] + offset;
+
+        float stemTimeStretch = riff->m_stemTimeScales[stemI];
+
+        // a tempo-matched copy is already at riff tempo; once it is fully rendered it replaces the original outright,
+        // until then the original is resampled for whatever the stretch hasn't reached yet
+        const auto*   stretchedStem      = riff->getStretchedStem( stemI );
+        const int64_t stretchedAvailable = ( stretchedStem != nullptr ) ? (int64_t)stretchedStem->getSamplesAvailable() : 0;
+        const int64_t stretchedCount     = ( stretchedAvailable > 0 ) ? (int64_t)stretchedStem->m_sampleCount : 0;
+        if ( stretchedAvailable > 0 && stretchedAvailable == stretchedCount )
+        {
+            stemCompact          = false;
+            stemLeft             = stretchedStem->m_channel[0];
+            stemRight            = stretchedStem->m_channel[1];
+            stemSampleCount      = stretchedCount;
+            stemSamplesAvailable = stretchedCount;
+            stemTimeStretch      = 1.0f;
+        }
+
+        // unstretched stems are read as contiguous spans, broken wherever either the riff or the stem loops around
+        if ( stemTimeStretch == 1.0f )
+        {
+            int64_t  riffSample = riffSampleStart;
+            uint32_t written    = 0;
+
+            while ( written < sampleCount )
+            {
+                const int64_t stemSample = riffSample % stemSampleCount;
+                const int64_t spanLength = std::min( {
+                    (int64_t)( sampleCount - written ),
+                    riffLengthInSamples - riffSample,
+                    stemSampleCount - stemSample } );
+
+                const int64_t readableLength = std::clamp( stemSamplesAvailable - stemSample, (int64_t)0, spanLength );
+
+                if ( readableLength > 0 )
+                {
+                    const float* spanLeft  = stemLeft  + stemSample;
+                    const float* spanRight = stemRight + stemSample;
+                    if ( stemCompact )
+                    {
+                        stemInst->readSamples( 0, (int32_t)stemSample, (int32_t)readableLength, m_decodeLeft );
+                        stemInst->readSamples( 1, (int32_t)stemSample, (int32_t)readableLength, m_decodeRight );
+                        spanLeft  = m_decodeLeft;
+                        spanRight = m_decodeRight;
+                    }
+
+                    if ( useEnvelope )
+                    {
+                        buffer::accumulate_stereo_enveloped(
+                            (int)readableLength,
+                            stemGain,
+                            m_envelope + written,
+                            spanLeft,
+                            spanRight,
+                            outLeft + written,
+                            outRight + written );
+                    }
+                    else
+                    {
+                        buffer::accumulate_stereo_scaled(
+                            (int)readableLength,
+                            stemGain,
+                            spanLeft,
+                            spanRight,
+                            outLeft + written,
+                            outRight + written );
+                    }
+                }
+
+                written    += (uint32_t)spanLength;
+                riffSample += spanLength;
+                if ( riffSample >= riffLengthInSamples )
+                    riffSample -= riffLengthInSamples;
+            }
+        }
+        // stretched stems need a per-sample lookup
+        else
+        {
+            int64_t riffSample = riffSampleStart;
+            for ( uint32_t sI = 0; sI < sampleCount; sI++ )
+            {
+                const uint64_t stemSample = (uint64_t)( (double)riffSample * stemTimeStretch ) % (uint64_t)stemSampleCount;
+                const float    gain       = useEnvelope ? ( stemGain * m_envelope[sI] ) : stemGain;
+
+                const int64_t  stretchedSample = ( stretchedCount > 0 ) ? ( riffSample % stretchedCount ) : 0;
+
+                if ( stretchedSample < stretchedAvailable )
+                {
+                    outLeft[sI]  += stretchedStem->m_channel[0][stretchedSample] * gain;
+                    outRight[sI] += stretchedStem->m_channel[1][stretchedSample] * gain;
+                }
+                else if ( (int64_t)stemSample >= stemSamplesAvailable )
+                {
+                    // not decoded yet, contributes nothing
+                }
+                else if ( stemCompact )
+                {
+                    outLeft[sI]  += stemInst->getSample( 0, (int32_t)stemSample ) * gain;
+                    outRight[sI] += stemInst->getSample( 1, (int32_t)stemSample ) * gain;
+                }
+                else
+                {
+                    outLeft[sI]  += stemLeft[stemSample]  * gain;
+                    outRight[sI] += stemRight[stemSample] * gain;
+                }
+
+                if ( ++riffSample >= riffLengthInSamples )
+                    riffSample = 0;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffVoices::render(
+    const uint64_t                  samplePosition,
+    const uint32_t                  offset,
+    const uint32_t                  sampleCount,
+    const std::array< float*, 8 >&  channelLeft,
+    const std::array< float*, 8 >&  channelRight )
+{
+    ABSL_ASSERT( offset + sampleCount <= (uint32_t)m_maxBufferSize );
+
+    if ( sampleCount == 0 )
+        return;
+
+    for ( auto stemI = 0U; stemI < 8; stemI++ )
+    {
+        std::fill_n( channelLeft[stemI]  + offset, sampleCount, 0.0f );
+        std::fill_n( channelRight[stemI] + offset, sampleCount, 0.0f );
+    }
+
+    for ( std::size_t index = 0; index < m_voiceCount; index++ )
+    {
+        const Voice& voice = m_voices[index];
+
+        if ( !voice.isSteady() )
+            computeEnvelope( voice, sampleCount, m_envelope );
+
+        renderVoice( voice, samplePosition, offset, sampleCount, channelLeft, channelRight );
+    }
+
+    // move envelopes on, retiring anything that has reached silence
+    const double blockSeconds = (double)sampleCount * m_sampleRateRecp;
+
+    std::size_t index = 0;
+    while ( index < m_voiceCount )
+    {
+        Voice& voice = m_voices[index];
+        if ( voice.m_fadeRate != 0 )
+        {
+            voice.m_fade += (float)( (double)voice.m_fadeRate * blockSeconds );
+
+            if ( voice.m_fade >= 1.0f )
+            {
+                voice.m_fade     = 1.0f;
+                voice.m_fadeRate = 0;
+            }
+            else if ( voice.m_fade <= 0.0f )
+            {
+                retireVoice( index );
+                continue;
+            }
+        }
+        index++;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffVoices::amalgamate(
+    const uint64_t                  samplePosition,
+    const uint32_t                  sampleCount,
+    StemDataAmalgam&                amalgam ) const
+{
+    for ( std::size_t index = 0; index < m_voiceCount; index++ )
+    {
+        const Voice& voice = m_voices[index];
+        const endlesss::live::Riff* riff = voice.m_riffPtr.get();
+
+        const uint64_t riffLengthInSamples = riff->m_timingDetails.m_lengthInSamples;
+        if ( riffLengthInSamples == 0 )
+            continue;
+
+        // the gain at the start of the span is plenty for analysis data that only feeds visuals and the beat exchange
+        const float    voiceGain       = getVoiceGain( index );
+        const uint64_t riffSampleStart = (uint64_t)getRiffSampleStart( voice, samplePosition );
+
+        for ( auto stemI = 0U; stemI < 8; stemI++ )
+        {
+            if ( ( voice.m_stemMask & ( 1U << stemI ) ) == 0 )
+                continue;
+
+            const endlesss::live::Stem* stemInst = riff->m_stemPtrs[stemI];
+            if ( stemInst == nullptr || stemInst->hasFailed() )
+                continue;
+
+            if ( stemInst->getAnalysisState() != endlesss::live::Stem::AnalysisState::AnalysisValid )
+                continue;
+
+            const float stemGain = voice.m_permutation.m_layerGainMultiplier[stemI] * voiceGain;
+            if ( stemGain == 0 )
+                continue;
+
+            const auto& stemAnalysis    = stemInst->getAnalysisData();
+            const auto  stemSampleCount = (uint64_t)stemInst->m_sampleCount;
+            const float stemTimeStretch = riff->m_stemTimeScales[stemI];
+            if ( stemSampleCount == 0 )
+                continue;
+
+            uint64_t riffSample = riffSampleStart;
+            for ( uint32_t sI = 0; sI < sampleCount; sI++ )
+            {
+                uint64_t stemSample = riffSample;
+                if ( stemTimeStretch != 1.0f )
+                    stemSample = (uint64_t)( (double)riffSample * stemTimeStretch );
+                stemSample %= stemSampleCount;
+
+                amalgam.m_wave[stemI] = std::max( amalgam.m_wave[stemI], stemAnalysis.getWaveF( stemSample ) * stemGain );
+                amalgam.m_beat[stemI] = std::max( amalgam.m_beat[stemI], stemAnalysis.getBeatF( stemSample ) * stemGain );
+                amalgam.m_low[stemI]  = std::max( amalgam.m_low[stemI],  stemAnalysis.getLowFreqF( stemSample ) * stemGain );
+                amalgam.m_high[stemI] = std::max( amalgam.m_high[stemI], stemAnalysis.getHighFreqF( stemSample ) * stemGain );
+
+                if ( ++riffSample >= riffLengthInSamples )
+                    riffSample = 0;
+            }
+        }
+    }
+}
+
+} // namespace mix
@@ -0,0 +1,154 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  N-voice riff renderer; each voice is a playing riff with its own time base, stem mask and gain envelope. starting
+//  a new voice fades it in while every other voice fades out over the same time on the complementary curve, so a riff
+//  that arrives while a transition is already underway layers over the existing blend rather than cutting it off
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+#include "endlesss/core.types.h"
+#include "endlesss/live.riff.h"
+
+namespace mix {
+
+struct StemDataAmalgam;
+
+// ---------------------------------------------------------------------------------------------------------------------
+enum class CrossfadeCurve : uint32_t
+{
+    Linear,
+    EqualPower,
+    SCurve,
+    Custom                  // evaluated from a table supplied with RiffVoices::setCustomCurve
+};
+
+static constexpr std::size_t cCrossfadeCurveCount = 4;
+static constexpr std::array< const char*, cCrossfadeCurveCount > cCrossfadeCurveNames{ {
+    "Linear",
+    "Equal Power",
+    "S-Curve",
+    "Custom"
+} };
+inline const char* getCrossfadeCurveName( const CrossfadeCurve cc )
+{
+    return cCrossfadeCurveNames[(size_t)cc];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+class RiffVoices
+{
+public:
+    DECLARE_NO_COPY_NO_MOVE( RiffVoices );
+
+    using Permutation   = endlesss::types::RiffPlaybackPermutation;
+
+    static constexpr std::size_t cMaxVoices         = 8;
+    static constexpr std::size_t cCustomCurvePoints = 33;
+    using CustomCurve   = std::array< float, cCustomCurvePoints >;
+
+    struct Voice
+    {
+        endlesss::live::RiffPtr     m_riffPtr;
+        Permutation                 m_permutation;
+        int64_t                     m_timeBase  = 0;        // sample position that lines up with sample 0 of the riff
+        uint8_t                     m_stemMask  = 0xFF;     // one bit per layer, cleared layers are not rendered
+        float                       m_fade      = 0;        // position along the crossfade curve; 0 silent, 1 full
+        float                       m_fadeRate  = 0;        // change in m_fade per second, negative when fading out
+        float                       m_fadeOutGain = 1.0f;   // gain the voice had when its fade-out began, scaling the fade-out curve
+
+        ouro_nodiscard constexpr bool isSteady() const { return m_fadeRate == 0 && m_fade >= 1.0f; }
+    };
+
+    RiffVoices( const int32_t maxBufferSize, const int32_t sampleRate );
+    ~RiffVoices();
+
+    void setCurve( const CrossfadeCurve curve ) { m_curve = curve; }
+    ouro_nodiscard constexpr CrossfadeCurve getCurve() const { return m_curve; }
+
+    // fade-in gain at evenly spaced positions from 0 to 1; fade-outs run the same table backwards
+    // (every other curve fades out along its complement; equal power fades in on sin() and out on cos())
+    void setCustomCurve( const CustomCurve& curve ) { m_customCurve = curve; }
+
+    // start playing a riff; every existing voice begins fading out from its current gain, reaching silence as this
+    // one reaches full volume. a fade time of zero is a hard cut and drops all other voices. if all voices are in use,
+    // the oldest is dropped to make room
+    void begin(
+        const endlesss::live::RiffPtr&  riff,
+        const Permutation&              permutation,
+        const int64_t                   timeBase,
+        const double                    fadeInSeconds,
+        const uint8_t                   stemMask = 0xFF );
+
+    // drop everything immediately
+    void clear();
+
+    ouro_nodiscard constexpr std::size_t getVoiceCount() const { return m_voiceCount; }
+    ouro_nodiscard constexpr bool isEmpty() const { return m_voiceCount == 0; }
+
+    // true if any voice envelope is still moving
+    ouro_nodiscard bool isTransitioning() const;
+
+    // most recently started voice, or nullptr
+    ouro_nodiscard const Voice* getNewestVoice() const;
+
+    // the gain a voice is currently playing at, after the crossfade curve is applied; oldest voice is index 0
+    ouro_nodiscard float getVoiceGain( const std::size_t index ) const;
+
+    // write every voice into [offset, offset + sampleCount) of the 8 layer channels, replacing what was there;
+    // samplePosition is the global position of the first sample written. envelopes are advanced afterwards and any
+    // voice that has finished fading out is retired
+    void render(
+        const uint64_t                  samplePosition,
+        const uint32_t                  offset,
+        const uint32_t                  sampleCount,
+        const std::array< float*, 8 >&  channelLeft,
+        const std::array< float*, 8 >&  channelRight );
+
+    // fold the stem analysis of every audible voice into the amalgam across the same span a render() would cover,
+    // each voice weighted by its current gain; call before render(), which moves the envelopes on
+    void amalgamate(
+        const uint64_t                  samplePosition,
+        const uint32_t                  sampleCount,
+        StemDataAmalgam&                amalgam ) const;
+
+private:
+
+    // fill envelope with the gain curve for the next sampleCount samples of this voice, not including m_fadeOutGain
+    void computeEnvelope( const Voice& voice, const uint32_t sampleCount, float* envelope ) const;
+
+    // where the first sample of a block starting at samplePosition lands inside the voice's riff
+    static int64_t getRiffSampleStart( const Voice& voice, const uint64_t samplePosition );
+
+    void renderVoice(
+        const Voice&                    voice,
+        const uint64_t                  samplePosition,
+        const uint32_t                  offset,
+        const uint32_t                  sampleCount,
+        const std::array< float*, 8 >&  channelLeft,
+        const std::array< float*, 8 >&  channelRight );
+
+    void retireVoice( const std::size_t index );
+
+
+    int32_t                             m_maxBufferSize;
+    double                              m_sampleRateRecp;
+
+    std::array< Voice, cMaxVoices >     m_voices;           // oldest first
+    std::size_t                         m_voiceCount        = 0;
+
+    CrossfadeCurve                      m_curve             = CrossfadeCurve::EqualPower;
+    CustomCurve                         m_customCurve;
+
+    float*                              m_envelope          = nullptr;
+    float*                              m_decodeLeft        = nullptr;  // span expansion for compact stem storage
+    float*                              m_decodeRight       = nullptr;
+};
+
+} // namespace mix
@@ -91,6 +91,16 @@ void modalRiffPushClientConnection(
                 {
                     connectionAttemptStatus = client.disconnect();
                 }
+                ImGui::SameLine();
+
+                const char* protocolName = "...";
+                switch ( client.getProtocol() )
+                {
+                    case net::bond::RiffPushProtocol::Negotiating:  protocolName = "negotiating";   break;
+                    case net::bond::RiffPushProtocol::Binary:       protocolName = "binary";        break;
+                    case net::bond::RiffPushProtocol::Json:         protocolName = "json";          break;
+                }
+                ImGui::TextDisabled( " %s, %zu pending", protocolName, client.getPendingPushCount() );
             }
             break;
         }
@@ -18,6 +18,8 @@
 #include <websocketpp/client.hpp>
 #include <websocketpp/server.hpp>
 
+#include <random>
+
 namespace net {
 namespace bond {
 
@@ -26,6 +28,191 @@ using ConnectionSet     = std::set<ConnectionHandle, std::owner_less<ConnectionH
 using ServerEndpoint    = websocketpp::server<websocketpp::config::asio>;
 using ClientEndpoint    = websocketpp::client<websocketpp::config::asio>;
 
+// ---------------------------------------------------------------------------------------------------------------------
+// binary riff-push framing; every frame starts with the same fixed header, little-endian throughout
+//
+//  [ 'V3RP' ] [ u16 version ] [ u16 message type ] [ u32 sequence ] [ u32 entry count ] [ entries ... ]
+//
+// push entries are
+//
+//  [ u8 flags ] [ u16 length, jam ID bytes ] [ u16 length, riff ID bytes ] [ f32 x 8 stem gains, if flagged ]
+//
+namespace protocol {
+
+static constexpr std::string_view   cBinaryMagic        = "V3RP";
+static constexpr std::string_view   cJsonMagic          = "V2RP";
+static constexpr uint16_t           cVersion            = 1;
+
+static constexpr std::size_t        cHeaderSize         = 4 + 2 + 2 + 4 + 4;
+
+static constexpr uint32_t           cMaxEntriesPerFrame = 32;
+static constexpr std::size_t        cMaxFramesInFlight  = 4;
+static constexpr long               cHelloTimeoutMs     = 750;
+
+enum class MessageType : uint16_t
+{
+    Hello       = 1,        // client -> server, sequence holds the highest protocol version the client speaks,
+                            //                   followed by a u64 client session ID
+    HelloAck    = 2,        // server -> client, sequence holds the version the server chose
+    Push        = 3,        // client -> server, a batch of riff pushes
+    Ack         = 4,        // server -> client, sequence of the push frame that was processed
+};
+
+enum EntryFlags : uint8_t
+{
+    EF_HasGains = 1 << 0,
+};
+
+struct PushEntry
+{
+    endlesss::types::JamCouchID                 m_jamID;
+    endlesss::types::RiffCouchID                m_riffID;
+    endlesss::types::RiffPlaybackPermutationOpt m_permutation;
+};
+
+struct Header
+{
+    uint16_t        m_version;
+    MessageType     m_type;
+    uint32_t        m_sequence;
+    uint32_t        m_entryCount;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct FrameWriter
+{
+    FrameWriter( const MessageType type, const uint32_t sequence, const uint32_t entryCount )
+    {
+        m_buffer.reserve( cHeaderSize + ( entryCount * 64 ) );
+        m_buffer.append( cBinaryMagic );
+        write( cVersion );
+        write( static_cast<uint16_t>( type ) );
+        write( sequence );
+        write( entryCount );
+    }
+
+    template< typename _Type >
+    void write( const _Type value )
+    {
+        static_assert( std::is_trivially_copyable_v<_Type> );
+        m_buffer.append( reinterpret_cast<const char*>( &value ), sizeof( _Type ) );
+    }
+
+    void write( std::string_view text )
+    {
+        ABSL_ASSERT( text.size() <= std::numeric_limits<uint16_t>::max() );
+        write( static_cast<uint16_t>( text.size() ) );
+        m_buffer.append( text );
+    }
+
+    void write( const PushEntry& entry )
+    {
+        write( static_cast<uint8_t>( entry.m_permutation.has_value() ? EF_HasGains : 0 ) );
+        write( std::string_view( entry.m_jamID.value() ) );
+        write( std::string_view( entry.m_riffID.value() ) );
+        if ( entry.m_permutation.has_value() )
+        {
+            for ( const float gain : entry.m_permutation->m_layerGainMultiplier )
+                write( gain );
+        }
+    }
+
+    std::string     m_buffer;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// bounds-checked reader; any read past the end of the frame flips m_ok and returns zeroes from then on
+struct FrameReader
+{
+    FrameReader( std::string_view frame )
+        : m_frame( frame )
+    {}
+
+    template< typename _Type >
+    _Type read()
+    {
+        _Type value{};
+        if ( m_ok && m_cursor + sizeof( _Type ) <= m_frame.size() )
+        {
+            std::memcpy( &value, m_frame.data() + m_cursor, sizeof( _Type ) );
+            m_cursor += sizeof( _Type );
+        }
+        else
+        {
+            m_ok = false;
+        }
+        return value;
+    }
+
+    std::string_view readString()
+    {
+        const uint16_t length = read<uint16_t>();
+        if ( !m_ok || m_cursor + length > m_frame.size() )
+        {
+            m_ok = false;
+            return {};
+        }
+        std::string_view result = m_frame.substr( m_cursor, length );
+        m_cursor += length;
+        return result;
+    }
+
+    std::optional< Header > readHeader()
+    {
+        if ( !m_frame.starts_with( cBinaryMagic ) )
+            return std::nullopt;
+        m_cursor = cBinaryMagic.size();
+
+        Header header;
+        header.m_version    = read<uint16_t>();
+        header.m_type       = static_cast<MessageType>( read<uint16_t>() );
+        header.m_sequence   = read<uint32_t>();
+        header.m_entryCount = read<uint32_t>();
+
+        if ( !m_ok )
+            return std::nullopt;
+        return header;
+    }
+
+    bool readEntry( PushEntry& entry )
+    {
+        const uint8_t flags = read<uint8_t>();
+        entry.m_jamID       = endlesss::types::JamCouchID( readString() );
+        entry.m_riffID      = endlesss::types::RiffCouchID( readString() );
+        entry.m_permutation.reset();
+
+        if ( flags & EF_HasGains )
+        {
+            endlesss::types::RiffPlaybackPermutation permutation;
+            for ( auto& gain : permutation.m_layerGainMultiplier )
+                gain = read<float>();
+            entry.m_permutation.emplace( permutation );
+        }
+        return m_ok && !entry.m_jamID.empty() && !entry.m_riffID.empty();
+    }
+
+    std::string_view    m_frame;
+    std::size_t         m_cursor    = 0;
+    bool                m_ok        = true;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// the original text form, still understood by both ends
+inline std::string encodeJson( const PushEntry& entry )
+{
+    nlohmann::json msg = {
+        { "jam" , entry.m_jamID.value() },
+        { "riff" , entry.m_riffID.value() }
+    };
+    if ( entry.m_permutation.has_value() )
+    {
+        msg.emplace( "gains", entry.m_permutation->m_layerGainMultiplier );
+    }
+    return std::string( cJsonMagic ) + msg.dump();
+}
+
+} // namespace protocol
+
 
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -50,60 +237,18 @@ struct RiffPushServer::State
         {
             blog::app( "rp server closing connection" );
             m_connections.erase( hdl );
+            m_connectionSessions.erase( hdl );
         });
         m_server.set_message_handler( [this]( ConnectionHandle hdl, ServerEndpoint::message_ptr msg )
         {
-            const auto message = msg->get_payload();
-            blog::app( "rp server msg : {}", message );
-
-            if ( message.starts_with("V2RP") && message.length() > 4 )
-            {
-                std::string_view jsonSubstr( message.begin() + 4, message.end() );
-                auto riffPushData = nlohmann::json::parse( jsonSubstr, nullptr, false );
-                if ( riffPushData.is_discarded() )
-                {
-                    blog::error::app( "V2RP failed to parse" );
-                    return;
-                }
-
-                const auto jsJamID      = riffPushData.at( "jam" );
-                const auto jsRiffID     = riffPushData.at( "riff" );
-
-                std::string jamIDString;
-                std::string riffIDString;
-                jsJamID.get_to( jamIDString );
-                jsRiffID.get_to( riffIDString );
-
-                // gain data is optional, check and construct the std::opt if its present and correct
-                endlesss::types::RiffPlaybackPermutationOpt permutationOpt;
-                if ( riffPushData.contains( "gains" ) )
-                {
-                    std::vector< float > stemGains;
-                    const auto jsStemGains = riffPushData.at( "gains" );
-                    jsStemGains.get_to( stemGains );
-
-                    endlesss::types::RiffPlaybackPermutation resolvedPermutation;
-                    if ( stemGains.size() == 8 )
-                    {
-                        for ( std::size_t idx = 0; idx < 8; idx++ )
-                            resolvedPermutation.m_layerGainMultiplier[idx] = stemGains[idx];
-
-                        permutationOpt.emplace( resolvedPermutation );
-                    }
-                    else
-                    {
-                        blog::error::app( "invalid stem gains ({}) received over V2RP", stemGains.size() );
-                    }
-                }
-
-                if ( m_riffPushCallback )
-                {
-                    m_riffPushCallback( 
-                        endlesss::types::JamCouchID( jamIDString ),
-                        endlesss::types::RiffCouchID( riffIDString ),
-                        permutationOpt );
-                }
-            }
+            const auto& message = msg->get_payload();
+
+            if ( msg->get_opcode() == websocketpp::frame::opcode::binary )
+                onBinaryMessage( hdl, message );
+            else if ( message.starts_with( protocol::cJsonMagic ) && message.length() > protocol::cJsonMagic.size() )
+                onJsonMessage( message );
+            else
+                blog::error::app( "rp server received unrecognised message ({} bytes)", message.size() );
         });
     }
 
@@ -166,8 +311,184 @@ struct RiffPushServer::State
         m_riffPushCallback = nullptr;
     }
 
+    ouro_nodiscard Statistics getStatistics() const
+    {
+        Statistics result;
+        result.m_framesReceived     = m_statFramesReceived.load( std::memory_order_relaxed );
+        result.m_framesDuplicated   = m_statFramesDuplicated.load( std::memory_order_relaxed );
+        result.m_pushesApplied      = m_statPushesApplied.load( std::memory_order_relaxed );
+        return result;
+    }
+
+    void dropAcknowledgements( const uint32_t frameCount )
+    {
+        m_acksToDrop = frameCount;
+    }
+
 private:
 
+    // what we know about each client, kept across its reconnects so resent frames can be recognised
+    struct Session
+    {
+        uint32_t    m_lastAppliedSequence = 0;      // client sequences start at 1
+    };
+
+    // sessions are keyed by the ID the client sent in its hello; clients that didn't send one get a key unique to
+    // the connection, which still catches duplicates within it
+    static constexpr uint64_t cConnectionSessionBit = 1ULL << 63;
+
+    void onBinaryMessage( ConnectionHandle hdl, std::string_view message )
+    {
+        protocol::FrameReader reader( message );
+        const auto header = reader.readHeader();
+        if ( !header.has_value() )
+        {
+            blog::error::app( "V3RP frame header invalid" );
+            return;
+        }
+
+        switch ( header->m_type )
+        {
+            case protocol::MessageType::Hello:
+            {
+                const uint16_t chosenVersion = static_cast<uint16_t>( std::min<uint32_t>( header->m_sequence, protocol::cVersion ) );
+                blog::app( "rp server negotiated binary protocol v{}", chosenVersion );
+
+                uint64_t sessionID = reader.read<uint64_t>();
+                if ( !reader.m_ok || sessionID == 0 )
+                    sessionID = cConnectionSessionBit | m_nextConnectionSession++;
+                else
+                    sessionID &= ~cConnectionSessionBit;
+
+                m_connectionSessions[hdl] = sessionID;
+
+                protocol::FrameWriter reply( protocol::MessageType::HelloAck, chosenVersion, 0 );
+                sendBinary( hdl, reply.m_buffer );
+            }
+            break;
+
+            case protocol::MessageType::Push:
+            {
+                if ( header->m_version != protocol::cVersion ||
+                     header->m_entryCount > protocol::cMaxEntriesPerFrame )
+                {
+                    blog::error::app( "V3RP push frame rejected (version {}, {} entries)", header->m_version, header->m_entryCount );
+                    return;
+                }
+
+                // decode the whole frame before acting on any of it, a truncated frame is dropped entirely
+                std::array< protocol::PushEntry, protocol::cMaxEntriesPerFrame > entries;
+                for ( uint32_t entryIndex = 0; entryIndex < header->m_entryCount; entryIndex++ )
+                {
+                    if ( !reader.readEntry( entries[entryIndex] ) )
+                    {
+                        blog::error::app( "V3RP push frame #{} malformed at entry {}", header->m_sequence, entryIndex );
+                        return;
+                    }
+                }
+
+                const auto sessionIt = m_connectionSessions.find( hdl );
+                if ( sessionIt == m_connectionSessions.end() )
+                {
+                    blog::error::app( "V3RP push frame #{} arrived before hello", header->m_sequence );
+                    return;
+                }
+                Session& session = m_sessions[sessionIt->second];
+
+                m_statFramesReceived.fetch_add( 1, std::memory_order_relaxed );
+
+                // a frame at or behind the last one applied is a resend after a lost ack; it is acknowledged again
+                // but its pushes have already been played
+                if ( static_cast<int32_t>( header->m_sequence - session.m_lastAppliedSequence ) <= 0 )
+                {
+                    blog::app( "V3RP push frame #{} already applied, skipping", header->m_sequence );
+                    m_statFramesDuplicated.fetch_add( 1, std::memory_order_relaxed );
+                }
+                else
+                {
+                    session.m_lastAppliedSequence = header->m_sequence;
+
+                    if ( m_riffPushCallback )
+                    {
+                        for ( uint32_t entryIndex = 0; entryIndex < header->m_entryCount; entryIndex++ )
+                            m_riffPushCallback( entries[entryIndex].m_jamID, entries[entryIndex].m_riffID, entries[entryIndex].m_permutation );
+                    }
+                    m_statPushesApplied.fetch_add( header->m_entryCount, std::memory_order_relaxed );
+                }
+
+                if ( m_acksToDrop > 0 )
+                {
+                    m_acksToDrop--;
+                    return;
+                }
+
+                protocol::FrameWriter reply( protocol::MessageType::Ack, header->m_sequence, 0 );
+                sendBinary( hdl, reply.m_buffer );
+            }
+            break;
+
+            default:
+                blog::error::app( "V3RP unexpected message type {}", static_cast<uint16_t>( header->m_type ) );
+                break;
+        }
+    }
+
+    void onJsonMessage( std::string_view message )
+    {
+        blog::app( "rp server msg : {}", message );
+
+        std::string_view jsonSubstr = message.substr( protocol::cJsonMagic.size() );
+        auto riffPushData = nlohmann::json::parse( jsonSubstr, nullptr, false );
+        if ( riffPushData.is_discarded() || !riffPushData.contains( "jam" ) || !riffPushData.contains( "riff" ) )
+        {
+            blog::error::app( "V2RP failed to parse" );
+            return;
+        }
+
+        std::string jamIDString;
+        std::string riffIDString;
+        riffPushData.at( "jam" ).get_to( jamIDString );
+        riffPushData.at( "riff" ).get_to( riffIDString );
+
+        // gain data is optional, check and construct the std::opt if its present and correct
+        endlesss::types::RiffPlaybackPermutationOpt permutationOpt;
+        if ( riffPushData.contains( "gains" ) )
+        {
+            std::vector< float > stemGains;
+            riffPushData.at( "gains" ).get_to( stemGains );
+
+            endlesss::types::RiffPlaybackPermutation resolvedPermutation;
+            if ( stemGains.size() == 8 )
+            {
+                for ( std::size_t idx = 0; idx < 8; idx++ )
+                    resolvedPermutation.m_layerGainMultiplier[idx] = stemGains[idx];
+
+                permutationOpt.emplace( resolvedPermutation );
+            }
+            else
+            {
+                blog::error::app( "invalid stem gains ({}) received over V2RP", stemGains.size() );
+            }
+        }
+
+        if ( m_riffPushCallback )
+        {
+            m_riffPushCallback( 
+                endlesss::types::JamCouchID( jamIDString ),
+                endlesss::types::RiffCouchID( riffIDString ),
+                permutationOpt );
+        }
+        m_statPushesApplied.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    void sendBinary( ConnectionHandle hdl, const std::string& frame )
+    {
+        websocketpp::lib::error_code ec;
+        m_server.send( hdl, frame, websocketpp::frame::opcode::binary, ec );
+        if ( ec )
+            blog::error::app( "rp server send failed; {}", ec.message() );
+    }
+
     void serverThread()
     {
         OuroveonThreadScope ots( OURO_THREAD_PREFIX "RiffPushServer" );
@@ -217,6 +538,18 @@ private:
 
     ServerEndpoint  m_server;
     ConnectionSet   m_connections;
+
+    // server thread only
+    std::map< ConnectionHandle, uint64_t, std::owner_less<ConnectionHandle> >
+                                        m_connectionSessions;
+    absl::flat_hash_map< uint64_t, Session >
+                                        m_sessions;
+    uint64_t                            m_nextConnectionSession = 1;
+
+    std::atomic_uint32_t                m_acksToDrop            = 0;
+    std::atomic_uint64_t                m_statFramesReceived    = 0;
+    std::atomic_uint64_t                m_statFramesDuplicated  = 0;
+    std::atomic_uint64_t                m_statPushesApplied     = 0;
 };
 
 RiffPushServer::RiffPushServer()
@@ -255,6 +588,16 @@ void RiffPushServer::clearRiffPushedCallback()
     m_state->clearRiffPushedCallback();
 }
 
+RiffPushServer::Statistics RiffPushServer::getStatistics() const
+{
+    return m_state->getStatistics();
+}
+
+void RiffPushServer::dropAcknowledgements( const uint32_t frameCount )
+{
+    m_state->dropAcknowledgements( frameCount );
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 
 
@@ -265,6 +608,12 @@ struct RiffPushClient::State
 
     State( const std::string& appName )
     {
+        // any non-zero value will do as long as it is unlikely to match another client the server has seen
+        std::random_device randomDevice;
+        m_sessionID  = ( static_cast<uint64_t>( randomDevice() ) << 32 ) | randomDevice();
+        m_sessionID ^= static_cast<uint64_t>( std::chrono::steady_clock::now().time_since_epoch().count() );
+        m_sessionID  = std::max<uint64_t>( m_sessionID, 1 );
+
         m_client.set_user_agent( fmt::format("{}/{}", appName, OURO_FRAMEWORK_VERSION) );
 
         m_client.clear_access_channels( websocketpp::log::alevel::all );
@@ -278,26 +627,25 @@ struct RiffPushClient::State
         {
             blog::app( "[RiffPushClient] -> connection opened" );
             m_clientState = BondState::Connected;
+
+            beginNegotiation();
         });
         m_client.set_close_handler( [this]( ConnectionHandle hdl )
         {
             blog::app( "[RiffPushClient] <- connection closed" );
-
-            m_clientConnectionPtr.reset();
-            m_clientConnectionHandle.reset();
-            m_clientState = BondState::Disconnected;
+            onConnectionLost();
         });
         m_client.set_fail_handler( [this]( ConnectionHandle hdl )
         {
             blog::app( "[RiffPushClient] <- connection failed" );
-
-            m_clientConnectionPtr.reset();
-            m_clientConnectionHandle.reset();
-            m_clientState = BondState::Disconnected;
+            onConnectionLost();
         });
-        m_client.set_message_handler( []( ConnectionHandle hdl, ServerEndpoint::message_ptr msg )
+        m_client.set_message_handler( [this]( ConnectionHandle hdl, ClientEndpoint::message_ptr msg )
         {
-            blog::app( "[RiffPushClient] >> client msg : {}", msg->get_payload() );
+            if ( msg->get_opcode() == websocketpp::frame::opcode::binary )
+                onBinaryMessage( msg->get_payload() );
+            else
+                blog::app( "[RiffPushClient] >> client msg : {}", msg->get_payload() );
         });
     }
 
@@ -361,30 +709,237 @@ struct RiffPushClient::State
         return m_clientState;
     }
 
-    void sendRiffID(
+    ouro_nodiscard RiffPushProtocol getProtocol() const
+    {
+        return m_protocol;
+    }
+
+    ouro_nodiscard std::size_t getPendingPushCount() const
+    {
+        std::scoped_lock<std::mutex> queueLock( m_queueMutex );
+        return m_pendingPushes.size() + m_inFlightEntryCount;
+    }
+
+    absl::Status queueRiffID(
         const endlesss::types::JamCouchID& jamID,
         const endlesss::types::RiffCouchID& riffID,
         const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt )
     {
-        nlohmann::json msg = {
-            { "jam" , jamID.value() },
-            { "riff" , riffID.value() }
-        };
-        if ( permutationOpt.has_value() )
         {
-            msg.emplace( "gains", permutationOpt->m_layerGainMultiplier );
+            std::scoped_lock<std::mutex> queueLock( m_queueMutex );
+
+            if ( m_pendingPushes.size() + m_inFlightEntryCount >= cRiffPushQueueCapacity )
+            {
+                return absl::ResourceExhaustedError( fmt::format( FMTX( "riff push queue full ({} waiting)" ), cRiffPushQueueCapacity ) );
+            }
+
+            m_pendingPushes.emplace_back( protocol::PushEntry{ jamID, riffID, permutationOpt } );
         }
 
-        const std::string riffPushJson = "V2RP" + msg.dump();
-        m_client.send( 
-            m_clientConnectionHandle,
-            riffPushJson,
-            websocketpp::frame::opcode::text );
+        postFlush();
+        return absl::OkStatus();
     }
 
 
 private:
 
+    struct InFlightFrame
+    {
+        uint32_t                                m_sequence;
+        std::vector< protocol::PushEntry >      m_entries;
+        bool                                    m_sent = false;     // cleared on reconnect, to resend as-is
+    };
+
+    static std::string encodeFrame( const InFlightFrame& frame )
+    {
+        protocol::FrameWriter writer( protocol::MessageType::Push, frame.m_sequence, static_cast<uint32_t>( frame.m_entries.size() ) );
+        for ( const auto& entry : frame.m_entries )
+            writer.write( entry );
+        return std::move( writer.m_buffer );
+    }
+
+    // hop onto the network thread to send whatever is queued; multiple posts before it runs collapse into one flush,
+    // which is where batching comes from when pushes arrive in bursts
+    void postFlush()
+    {
+        if ( m_flushPosted.exchange( true ) )
+            return;
+
+        websocketpp::lib::asio::post( m_client.get_io_service(), [this]()
+            {
+                m_flushPosted = false;
+                flushQueue();
+            });
+    }
+
+    // network thread only
+    void flushQueue()
+    {
+        if ( m_clientState != BondState::Connected )
+            return;
+
+        const RiffPushProtocol protocolInUse = m_protocol;
+        if ( protocolInUse == RiffPushProtocol::Negotiating )
+            return;
+
+        std::scoped_lock<std::mutex> queueLock( m_queueMutex );
+
+        if ( protocolInUse == RiffPushProtocol::Json )
+        {
+            // frames left over from a binary connection can't be resent as they were, unpack them back into the queue
+            while ( !m_inFlight.empty() )
+            {
+                auto& frame = m_inFlight.back();
+                m_pendingPushes.insert( m_pendingPushes.begin(),
+                    std::make_move_iterator( frame.m_entries.begin() ),
+                    std::make_move_iterator( frame.m_entries.end() ) );
+                m_inFlight.pop_back();
+            }
+            m_inFlightEntryCount = 0;
+
+            // no acknowledgements in the old protocol, entries are done with as soon as they're handed to the socket
+            while ( !m_pendingPushes.empty() )
+            {
+                if ( !sendFrame( protocol::encodeJson( m_pendingPushes.front() ), websocketpp::frame::opcode::text ) )
+                    break;
+                m_pendingPushes.pop_front();
+            }
+            return;
+        }
+
+        // frames that never got an ack before a reconnect go first, unchanged, so the server can spot any it applied
+        for ( auto& frame : m_inFlight )
+        {
+            if ( frame.m_sent )
+                continue;
+            if ( !sendFrame( encodeFrame( frame ), websocketpp::frame::opcode::binary ) )
+                return;
+            frame.m_sent = true;
+        }
+
+        while ( !m_pendingPushes.empty() && m_inFlight.size() < protocol::cMaxFramesInFlight )
+        {
+            const std::size_t batchSize = std::min<std::size_t>( m_pendingPushes.size(), protocol::cMaxEntriesPerFrame );
+
+            InFlightFrame frame;
+            frame.m_sequence = m_nextSequence;
+            frame.m_entries.assign(
+                m_pendingPushes.begin(),
+                m_pendingPushes.begin() + batchSize );
+
+            // left in the queue if the send fails, they will go again on the next flush or after a reconnect
+            if ( !sendFrame( encodeFrame( frame ), websocketpp::frame::opcode::binary ) )
+                break;
+
+            frame.m_sent = true;
+            m_nextSequence++;
+
+            m_pendingPushes.erase( m_pendingPushes.begin(), m_pendingPushes.begin() + batchSize );
+            m_inFlightEntryCount += batchSize;
+            m_inFlight.emplace_back( std::move( frame ) );
+        }
+    }
+
+    bool sendFrame( const std::string& payload, websocketpp::frame::opcode::value opcode )
+    {
+        websocketpp::lib::error_code ec;
+        m_client.send( m_clientConnectionHandle, payload, opcode, ec );
+        if ( ec )
+        {
+            blog::error::app( "[RiffPushClient] send failed; {}", ec.message() );
+            return false;
+        }
+        return true;
+    }
+
+    void beginNegotiation()
+    {
+        m_protocol = RiffPushProtocol::Negotiating;
+
+        // a flush posted before a previous disconnect may never have run; negotiation ends in a flush regardless
+        m_flushPosted = false;
+
+        protocol::FrameWriter hello( protocol::MessageType::Hello, protocol::cVersion, 0 );
+        hello.write( m_sessionID );
+        sendFrame( hello.m_buffer, websocketpp::frame::opcode::binary );
+
+        // servers that predate the binary protocol ignore the hello entirely
+        m_client.set_timer( protocol::cHelloTimeoutMs, [this]( const websocketpp::lib::error_code& ec )
+            {
+                if ( ec || m_protocol != RiffPushProtocol::Negotiating )
+                    return;
+
+                blog::app( "[RiffPushClient] no binary protocol response, falling back to JSON" );
+                m_protocol = RiffPushProtocol::Json;
+                flushQueue();
+            });
+    }
+
+    void onBinaryMessage( std::string_view message )
+    {
+        protocol::FrameReader reader( message );
+        const auto header = reader.readHeader();
+        if ( !header.has_value() )
+        {
+            blog::error::app( "[RiffPushClient] invalid frame from server" );
+            return;
+        }
+
+        switch ( header->m_type )
+        {
+            case protocol::MessageType::HelloAck:
+            {
+                if ( header->m_sequence != protocol::cVersion )
+                {
+                    blog::error::app( "[RiffPushClient] server chose unsupported protocol v{}, using JSON", header->m_sequence );
+                    m_protocol = RiffPushProtocol::Json;
+                }
+                else
+                {
+                    blog::app( "[RiffPushClient] using binary protocol v{}", header->m_sequence );
+                    m_protocol = RiffPushProtocol::Binary;
+                }
+                flushQueue();
+            }
+            break;
+
+            case protocol::MessageType::Ack:
+            {
+                {
+                    std::scoped_lock<std::mutex> queueLock( m_queueMutex );
+
+                    // acks arrive in order, so everything up to and including this sequence has been delivered
+                    while ( !m_inFlight.empty() &&
+                            static_cast<int32_t>( header->m_sequence - m_inFlight.front().m_sequence ) >= 0 )
+                    {
+                        m_inFlightEntryCount -= m_inFlight.front().m_entries.size();
+                        m_inFlight.pop_front();
+                    }
+                }
+                flushQueue();
+            }
+            break;
+
+            default:
+                blog::error::app( "[RiffPushClient] unexpected message type {}", static_cast<uint16_t>( header->m_type ) );
+                break;
+        }
+    }
+
+    void onConnectionLost()
+    {
+        m_clientConnectionPtr.reset();
+        m_clientConnectionHandle.reset();
+        m_clientState = BondState::Disconnected;
+        m_protocol    = RiffPushProtocol::Negotiating;
+
+        // anything sent but not acknowledged is kept, sequence numbers and all, to be resent first on the next
+        // connection; if the server had processed it and only the ack was lost, it skips the repeat
+        std::scoped_lock<std::mutex> queueLock( m_queueMutex );
+        for ( auto& frame : m_inFlight )
+            frame.m_sent = false;
+    }
+
     void clientThreadStart()
     {
         // already running?
@@ -447,6 +1002,16 @@ private:
     ClientEndpoint                  m_client;
     ClientEndpoint::connection_ptr  m_clientConnectionPtr;
     ConnectionHandle                m_clientConnectionHandle;
+
+    std::atomic< RiffPushProtocol > m_protocol          = RiffPushProtocol::Negotiating;
+    std::atomic_bool                m_flushPosted       = false;
+    uint64_t                        m_sessionID         = 0;
+
+    mutable std::mutex                      m_queueMutex;
+    std::deque< protocol::PushEntry >       m_pendingPushes;
+    std::deque< InFlightFrame >             m_inFlight;
+    std::size_t                             m_inFlightEntryCount = 0;
+    uint32_t                                m_nextSequence = 1;
 };
 
 RiffPushClient::RiffPushClient( const std::string& appName )
@@ -475,12 +1040,22 @@ BondState RiffPushClient::getState() const
     return m_state->getState();
 }
 
-void RiffPushClient::pushRiffById(
+RiffPushProtocol RiffPushClient::getProtocol() const
+{
+    return m_state->getProtocol();
+}
+
+std::size_t RiffPushClient::getPendingPushCount() const
+{
+    return m_state->getPendingPushCount();
+}
+
+absl::Status RiffPushClient::pushRiffById(
     const endlesss::types::JamCouchID& jamID,
     const endlesss::types::RiffCouchID& riffID,
     const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt )
 {
-    m_state->sendRiffID( jamID, riffID, permutationOpt );
+    return m_state->queueRiffID( jamID, riffID, permutationOpt );
 }
 
 } // namespace bond
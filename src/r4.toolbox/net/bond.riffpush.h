@@ -4,7 +4,16 @@
 //  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
 //  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
 //
-//  
+//  riff-push between OUROVEON apps; a client (LORE, the weaver) tells a server (BEAM) which riff to play next
+//
+//  clients open with a binary hello; a server that understands it answers and the pair then exchange versioned
+//  binary frames carrying batches of riff pushes, each frame stamped with a sequence number that the server
+//  acknowledges. servers that only know the original "V2RP" JSON text messages never answer the hello, in which
+//  case the client falls back to sending JSON, one push per message, without acknowledgements
+//
+//  the hello also carries a session ID the client picks once for its lifetime; frames that were sent but not
+//  acknowledged before a reconnect go again with their original sequence numbers, and the server uses the session's
+//  last applied sequence to acknowledge (but not re-apply) any it had already processed
 //
 
 #pragma once
@@ -21,6 +30,18 @@ enum BondState
     Connected
 };
 
+// which wire format a client ended up using after connecting
+enum class RiffPushProtocol
+{
+    Negotiating,
+    Binary,
+    Json
+};
+
+// pushes are queued on the client and flushed from the network thread; once this many are waiting (or sent but not
+// yet acknowledged) further pushes are refused until the server catches up
+static constexpr std::size_t cRiffPushQueueCapacity = 256;
+
 // ---------------------------------------------------------------------------------------------------------------------
 struct RiffPushServer
 {
@@ -38,6 +59,18 @@ struct RiffPushServer
     void setRiffPushedCallback( const RiffPushCallback& cb );
     void clearRiffPushedCallback();
 
+    struct Statistics
+    {
+        uint64_t    m_framesReceived    = 0;    // binary push frames that decoded successfully
+        uint64_t    m_framesDuplicated  = 0;    // .. of which were resends of frames already applied
+        uint64_t    m_pushesApplied     = 0;    // riff pushes handed to the callback, from either protocol
+    };
+    ouro_nodiscard Statistics getStatistics() const;
+
+    // testing aid; the next (frameCount) binary push frames are applied as normal but not acknowledged, as if the
+    // acks had been lost on the way back to the client
+    void dropAcknowledgements( const uint32_t frameCount );
+
 private:
     struct State;
     std::unique_ptr< State >    m_state;
@@ -54,15 +87,21 @@ struct RiffPushClient
     ouro_nodiscard absl::Status connect( const std::string& uri );
     ouro_nodiscard absl::Status disconnect();
     ouro_nodiscard BondState getState() const;
+    ouro_nodiscard RiffPushProtocol getProtocol() const;
+
+    // number of pushes queued or in flight, ie. not yet acknowledged by the server
+    ouro_nodiscard std::size_t getPendingPushCount() const;
 
-    inline void pushRiff(
+    // queue a riff to be pushed; returns ResourceExhaustedError if the send queue is full, in which case the caller
+    // should back off rather than keep pushing
+    inline absl::Status pushRiff(
         const endlesss::types::RiffComplete& riff,
         const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt )
     {
-        pushRiffById( riff.jam.couchID, riff.riff.couchID, permutationOpt );
+        return pushRiffById( riff.jam.couchID, riff.riff.couchID, permutationOpt );
     }
 
-    void pushRiffById( 
+    absl::Status pushRiffById( 
         const endlesss::types::JamCouchID& jamID,
         const endlesss::types::RiffCouchID& riffID,
         const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt );
@@ -10,11 +10,13 @@
 #include "spacetime/chronicle.h"
 #include "base/text.h"
 
+#include "ssp/ssp.file.flac.multitrack.h"
+
 namespace ux {
 namespace widget {
 
 // ---------------------------------------------------------------------------------------------------------------------
-void DiskRecorder( rec::IRecordable& recordable, const fs::path& recordingRootPath )
+inline void DiskRecorder( rec::IRecordable& recordable, const fs::path& recordingRootPath )
 {
     const ImVec2 commonButtonSize = ImVec2( 26.0f, ImGui::GetFrameHeight() );
 
@@ -101,5 +103,36 @@ void DiskRecorder( rec::IRecordable& recordable, const fs::path& recordingRootPa
     ImGui::PopID();
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+// live per-track encoder counters from a running multitrack FLAC recorder
+inline void FLACRecorderStatistics( const ssp::FLACMultiTrackRecorder& recorder )
+{
+    static std::vector< ssp::FLACMultiTrackRecorder::TrackStatistics > trackStats;
+    recorder.getTrackStatistics( trackStats );
+
+    if ( ImGui::BeginTable( "##flac_track_stats", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg ) )
+    {
+        ImGui::TableSetupColumn( "Layer", ImGuiTableColumnFlags_WidthFixed, 40.0f );
+        ImGui::TableSetupColumn( "Encode" );
+        ImGui::TableSetupColumn( "Written" );
+        ImGui::TableSetupColumn( "Backlog" );
+        ImGui::TableSetupColumn( "Dropped" );
+        ImGui::TableHeadersRow();
+
+        for ( std::size_t tI = 0; tI < trackStats.size(); tI++ )
+        {
+            const auto& stats = trackStats[tI];
+
+            ImGui::TableNextColumn(); ImGui::Text( "%zu", tI + 1 );
+            ImGui::TableNextColumn(); ImGui::Text( "%u ms (%" PRIu64 " ms)", stats.m_lastEncodeTimeUs / 1000, stats.m_encodeTimeUs / 1000 );
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( base::humaniseByteSize( "", stats.m_bytesWritten ).c_str() );
+            ImGui::TableNextColumn(); ImGui::Text( "%u buf, %" PRIu64 " KB", stats.m_encodeBacklog, stats.m_writeBacklogBytes / 1024 );
+            ImGui::TableNextColumn(); ImGui::Text( "%" PRIu64, stats.m_samplesDropped );
+        }
+
+        ImGui::EndTable();
+    }
+}
+
 } // namespace widget
 } // namespace ux
@@ -10,6 +10,7 @@
 #include "pch.h"
 #include "ux/jam.precache.h"
 
+#include "base/scheduler.h"
 #include "spacetime/chronicle.h"
 
 #include "app/imgui.ext.h"
@@ -54,7 +55,7 @@ struct JamPrecacheState
     void imgui(
         const endlesss::toolkit::Warehouse& warehouse,
         endlesss::services::RiffFetchProvider& fetchProvider,
-        tf::Executor& taskExecutor );
+        base::WorkScheduler& workScheduler );
 
     endlesss::types::JamCouchID     m_jamCouchID;
     endlesss::types::StemCouchIDs   m_stemIDs;
@@ -86,6 +87,8 @@ struct JamPrecacheState
     std::atomic_uint32_t            m_statsStemsFailedToDownloadTerminal = 0;   // 403 errors - the stem is gone forever
 
     std::atomic_uint32_t            m_downloadsDispatched = 0;
+    base::WorkScheduler::CancellationToken
+                                    m_downloadCancellation;     // cancelled on close, dropping downloads not yet started
 
     spacetime::Moment               m_syncTimer;
     base::RollingAverage< cSyncSamples >
@@ -105,7 +108,7 @@ void modalJamPrecache(
     JamPrecacheState& jamPrecacheState,
     const struct endlesss::toolkit::Warehouse& warehouse,
     endlesss::services::RiffFetchProvider& fetchProvider,
-    tf::Executor& taskExecutor )
+    base::WorkScheduler& workScheduler )
 {
     const ImVec2 configWindowSize = ImVec2( 830.0f, 260.0f );
     ImGui::SetNextWindowContentSize( configWindowSize );
@@ -114,7 +117,7 @@ void modalJamPrecache(
 
     if ( ImGui::BeginPopupModal( title, nullptr, ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoResize ) )
     {
-        jamPrecacheState.imgui( warehouse, fetchProvider, taskExecutor );
+        jamPrecacheState.imgui( warehouse, fetchProvider, workScheduler );
 
         ImGui::EndPopup();
     }
@@ -125,7 +128,7 @@ void modalJamPrecache(
 void JamPrecacheState::imgui(
     const endlesss::toolkit::Warehouse& warehouse,
     endlesss::services::RiffFetchProvider& fetchProvider,
-    tf::Executor& taskExecutor )
+    base::WorkScheduler& workScheduler )
 {
     const ImVec2 buttonSize( 240.0f, 32.0f );
 
@@ -242,7 +245,7 @@ void JamPrecacheState::imgui(
 
             if ( m_currentStemIndex >= stemCount )
             {
-                taskExecutor.wait_for_all();
+                m_downloadCancellation.waitForWork();
                 m_state = State::Complete;
                 break;
             }
@@ -292,11 +295,12 @@ void JamPrecacheState::imgui(
                                 ++m_averageSyncMeasurements;
                             }
 
-                            // kick out an untethered async task to initialise a live Stem object
+                            // queue a background job to initialise a live Stem object
                             // doing so will go through the default machinery of downloading / validating it, same as
                             // when we do this for playing riffs back in the rest of the app - difference being that 
-                            // we don't keep the live Stem around, it's just immediately tossed
-                            taskExecutor.silent_async( [=, this]()
+                            // we don't keep the live Stem around, it's just immediately tossed. the Prefetch lane keeps
+                            // these behind any riffs the user asks to play in the meantime
+                            workScheduler.submit( base::WorkScheduler::Lane::Prefetch, [=, this]()
                                 {
                                     auto stemLivePtr = std::make_shared<endlesss::live::Stem>( stemData, 8000 );   // any sample rate is fine, we aren't keeping the data
                                     stemLivePtr->fetch(
@@ -334,7 +338,8 @@ void JamPrecacheState::imgui(
 
                                     // tag that we are done with this task so that the cycle can kick more off
                                     --m_downloadsDispatched;
-                                });
+                                },
+                                m_downloadCancellation );
                         }
                     }
                 }
@@ -416,7 +421,8 @@ void JamPrecacheState::imgui(
 
     if ( ImGui::BottomRightAlignedButton( "Close", buttonSize ) )
     {
-        taskExecutor.wait_for_all();
+        m_downloadCancellation.cancel();
+        m_downloadCancellation.waitForWork();
         ImGui::CloseCurrentPopup();
     }
 }
@@ -14,6 +14,8 @@
 
 #include "spacetime/moment.h"
 
+namespace base { class WorkScheduler; }
+
 namespace endlesss { namespace toolkit { struct Warehouse; } }
 
 namespace ux {
@@ -27,6 +29,6 @@ namespace ux {
         JamPrecacheState& jamPrecacheState,                     // UI state 
         const endlesss::toolkit::Warehouse& warehouse,          // warehouse access to pull stem data
         endlesss::services::RiffFetchProvider& fetchProvider,   // network fetch services
-        tf::Executor& taskExecutor );                           // async support via tf
+        base::WorkScheduler& workScheduler );                   // downloads run in its Prefetch lane
 
 } // namespace ux
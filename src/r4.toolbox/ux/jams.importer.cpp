@@ -68,8 +68,8 @@ struct JamImporterState
         {
             for ( auto& item : m_importablesList )
             {
-                if ( item->m_importOperationYAML == eventData->m_id )
-                    item->m_importOperationYAML = base::OperationID::invalid();
+                if ( item->m_importOperationMetadata == eventData->m_id )
+                    item->m_importOperationMetadata = base::OperationID::invalid();
                 if ( item->m_importOperationTAR == eventData->m_id )
                     item->m_importOperationTAR = base::OperationID::invalid();
             }
@@ -78,20 +78,20 @@ struct JamImporterState
 
 
 
-    // captures a bundle of data for importing a jam, both the TAR stems and YAML metadata
+    // captures a bundle of data for importing a jam, both the TAR stems and the metadata (.orxj archive or legacy .yaml)
     struct ImportableJamBundle
     {
         fs::path                    m_fileTAR;
-        fs::path                    m_fileYAML;
-        std::string                 m_jamNameFromYAML;          // parsed public jam name from YAML
-        std::string                 m_jamNameToSortWith;        // lowercased m_jamNameFromYAML for alphabetical sorting 
+        fs::path                    m_fileMetadata;
+        std::string                 m_jamNameFromMetadata;      // parsed public jam name from metadata
+        std::string                 m_jamNameToSortWith;        // lowercased m_jamNameFromMetadata for alphabetical sorting
         endlesss::types::JamCouchID m_jamCouchID;
 
-        base::OperationID           m_importOperationYAML = base::OperationID::invalid();
+        base::OperationID           m_importOperationMetadata = base::OperationID::invalid();
         base::OperationID           m_importOperationTAR = base::OperationID::invalid();
 
         bool                        m_import = true;
-        bool                        m_bYamlParseOk = false;
+        bool                        m_bMetadataParseOk = false;
     };
     using ImportableJamBundlePtr    = std::shared_ptr< ImportableJamBundle >;
     using ImportableJamMap          = absl::flat_hash_map< std::string, ImportableJamBundlePtr >;
@@ -107,12 +107,59 @@ struct JamImporterState
     fs::path                m_importPath;
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+// pull the jam name and couch ID out of either a binary jam archive or a legacy YAML export
+static absl::Status readImportMetadata( const fs::path& metadataFile, std::string& jamName, endlesss::types::JamCouchID& jamCouchID )
+{
+    if ( base::StrToLwrExt( metadataFile.extension().string() ) != ".yaml" )
+    {
+        const auto headerStatus = endlesss::toolkit::archive::readHeader( metadataFile );
+        if ( !headerStatus.ok() )
+            return headerStatus.status();
+
+        jamName    = headerStatus.value().m_jamName;
+        jamCouchID = headerStatus.value().m_jamCouchID;
+        return absl::OkStatus();
+    }
+
+    // load the text from disk or fail out immediately
+    auto loadStatus = base::readTextFile( metadataFile );
+    if ( !loadStatus.ok() )
+        return loadStatus.status();
+
+    ryml::Tree yamlTree;
+    ryml::Parser yamlParser;
+
+    std::string parseName = metadataFile.filename().string();
+
+    // map it
+    auto nameView = ryml::csubstr( std::data( parseName ), std::size( parseName ) );
+    auto bufferView = ryml::substr( std::data( loadStatus.value() ), std::size( loadStatus.value() ) );
+
+    // parse it
+    yamlParser.parse_in_place( nameView, bufferView, &yamlTree );
+
+    // try to read out our principal keys
+    const auto jamNameReadStatus = data::parseYamlValue<std::string>( yamlTree, "jam_name" );
+    if ( !jamNameReadStatus.ok() )
+        return jamNameReadStatus.status();
+
+    const auto jamBandReadStatus = data::parseYamlValue<std::string>( yamlTree, "jam_couch_id" );
+    if ( !jamBandReadStatus.ok() )
+        return jamBandReadStatus.status();
+
+    jamName    = jamNameReadStatus.value();
+    jamCouchID = endlesss::types::JamCouchID{ jamBandReadStatus.value() };
+    return absl::OkStatus();
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void JamImporterState::refreshAvailableJams( endlesss::toolkit::Warehouse* warehousePtr )
 {
-    static constexpr std::string_view cOrxPre  = "orx.";
-    static constexpr std::string_view cYamlExt = ".yaml";
-    static constexpr std::string_view cTarExt  = ".tar";
+    static constexpr std::string_view cOrxPre     = "orx.";
+    static constexpr std::string_view cArchiveExt = ".orxj";
+    static constexpr std::string_view cYamlExt    = ".yaml";
+    static constexpr std::string_view cTarExt     = ".tar";
 
     // local map of importable data we will populate and then eventually sort into a vector for display
     ImportableJamMap  importablesMap;
@@ -139,7 +186,8 @@ void JamImporterState::refreshAvailableJams( endlesss::toolkit::Warehouse* wareh
         if ( entryStem.rfind( cOrxPre, 0 ) == 0 )
         {
             // an extension we expect?
-            if ( entryExtensionLower == cYamlExt ||
+            if ( entryExtensionLower == cArchiveExt ||
+                 entryExtensionLower == cYamlExt    ||
                  entryExtensionLower == cTarExt )
             {
                 // create or find an existing import bundle based on the filename stem, eg. `orx.after_easter__.band9b6acbcd75`
@@ -154,76 +202,41 @@ void JamImporterState::refreshAvailableJams( endlesss::toolkit::Warehouse* wareh
                     importablesMap.emplace( entryStem, importBundle );
                 }
 
-                if ( entryExtensionLower == cYamlExt )
+                if ( entryExtensionLower == cArchiveExt ||
+                     entryExtensionLower == cYamlExt )
                 {
-                    ABSL_ASSERT( importBundle->m_fileYAML.empty() );
-                    importBundle->m_fileYAML = entryFullFilename;
+                    // binary archives supersede YAML exports of the same jam if both are present
+                    const bool bAlreadyHaveArchive = base::StrToLwrExt( importBundle->m_fileMetadata.extension().string() ) == cArchiveExt;
+                    if ( entryExtensionLower == cYamlExt && bAlreadyHaveArchive )
+                        continue;
 
-                    // we now check the YAML is approximately what we want to deal with ahead of time
+                    importBundle->m_fileMetadata = entryFullFilename;
+
+                    // we now check the metadata is approximately what we want to deal with ahead of time
                     // and fetch the readible jam name + jam couch ID out as part of that process
+                    const auto metadataStatus = readImportMetadata( entryFullFilename, importBundle->m_jamNameFromMetadata, importBundle->m_jamCouchID );
+                    if ( !metadataStatus.ok() )
                     {
-                        ryml::Tree yamlTree;
-                        ryml::Parser yamlParser;
+                        blog::error::app( FMTX( "[JamImporter] unable to read metadata from `{}` : {}" ), entryFullFilename.filename().string(), metadataStatus.ToString() );
+                        importBundle->m_bMetadataParseOk = false;
+                        importBundle->m_import = false;
+                    }
+                    else
+                    {
+                        // got what we wanted, consider this import valid for now
+                        importBundle->m_jamNameToSortWith = base::StrToLwrExt( importBundle->m_jamNameFromMetadata );
+                        importBundle->m_bMetadataParseOk = true;
+                        importBundle->m_import = true;
 
-                        // load the text from disk or fail out immediately
-                        auto loadStatus = base::readTextFile( importBundle->m_fileYAML );
-                        if ( loadStatus.ok() )
-                        {
-                            std::string parseName = importBundle->m_fileYAML.filename().string();
-
-                            // map it
-                            auto nameView = ryml::csubstr( std::data( parseName ), std::size( parseName ) );
-                            auto bufferView = ryml::substr( std::data( loadStatus.value() ), std::size( loadStatus.value() ) );
-
-                            // parse it
-                            yamlParser.parse_in_place( nameView, bufferView, &yamlTree );
-
-                            // try to read out our principal keys
-                            const auto jamNameReadStatus = data::parseYamlValue<std::string>( yamlTree, "jam_name" );
-                            if ( !jamNameReadStatus.ok() )
-                            {
-                                blog::error::app( FMTX( "[JamImporter] unable to parse jam_name from source YAML `{}`" ), entryFullFilename.filename().string() );
-                                importBundle->m_bYamlParseOk = false;
-                                importBundle->m_import = false;
-                            }
-                            else
-                            {
-                                // got the jam name, couch ID next
-                                importBundle->m_jamNameFromYAML = jamNameReadStatus.value();
-                                importBundle->m_jamNameToSortWith = base::StrToLwrExt( importBundle->m_jamNameFromYAML );
-
-                                const auto jamBandReadStatus = data::parseYamlValue<std::string>( yamlTree, "jam_couch_id" );
-                                if ( !jamBandReadStatus.ok() )
-                                {
-                                    blog::error::app( FMTX( "[JamImporter] unable to parse jam_couch_id from source YAML `{}`" ), entryFullFilename.filename().string() );
-                                    importBundle->m_bYamlParseOk = false;
-                                    importBundle->m_import = false;
-                                }
-                                else
-                                {
-                                    // got what we wanted, consider this import valid for now
-                                    importBundle->m_jamCouchID = endlesss::types::JamCouchID{ jamBandReadStatus.value() };
-                                    importBundle->m_bYamlParseOk = true;
-
-                                    blog::app( FMTX( "[JamImporter] successful YAML header check for `{}`" ), entryFullFilename.filename().string() );
-
-                                    // if there are any references to that new jam ID already in the database, mark it as not to import
-                                    // by default, just in case the user doesn't want to re-do it
-                                    if ( warehousePtr->anyReferencesToJamFound( importBundle->m_jamCouchID ) )
-                                    {
-                                        importBundle->m_import = false;
-                                    }
-                                }
-                            }
-                        }
-                        else
+                        blog::app( FMTX( "[JamImporter] successful metadata header check for `{}`" ), entryFullFilename.filename().string() );
+
+                        // if there are any references to that new jam ID already in the database, mark it as not to import
+                        // by default, just in case the user doesn't want to re-do it
+                        if ( warehousePtr->anyReferencesToJamFound( importBundle->m_jamCouchID ) )
                         {
-                            blog::error::app( FMTX( "[JamImporter] failed to load YAML text from `{}`" ), entryFullFilename.filename().string() );
-                            importBundle->m_bYamlParseOk = false;
                             importBundle->m_import = false;
                         }
                     }
-
                 }
                 if ( entryExtensionLower == cTarExt )
                 {
@@ -273,17 +286,17 @@ void JamImporterState::launchImportTasks( app::OuroApp& ouroApplication )
     for ( auto& item : m_importablesList )
     {
         if ( item->m_import && 
-             item->m_bYamlParseOk &&
+             item->m_bMetadataParseOk &&
              item->m_fileTAR.empty() == false &&
-             item->m_fileYAML.empty() == false )
+             item->m_fileMetadata.empty() == false )
         {
             // copy in the name in case it wasn't in our BNS etc
             ouroApplication.emplaceJamNameResolutionIntoQueue(
                 item->m_jamCouchID,
-                item->m_jamNameFromYAML );
+                item->m_jamNameFromMetadata );
 
             // kick the async tasks off
-            item->m_importOperationYAML = ouroApplication.getWarehouseInstance()->requestJamDataImport( item->m_fileYAML );
+            item->m_importOperationMetadata = ouroApplication.getWarehouseInstance()->requestJamDataImport( item->m_fileMetadata );
             item->m_importOperationTAR  = ouroApplication.enqueueJamStemArchiveImportAsync( item->m_fileTAR, taskflow );
 
             std::this_thread::yield();
@@ -356,10 +369,10 @@ void JamImporterState::imgui( app::OuroApp& ouroApplication )
 
             for ( size_t jamIdx = 0; jamIdx < m_importablesList.size(); jamIdx++ )
             {
-                const bool bHasValidYaml    = m_importablesList[jamIdx]->m_bYamlParseOk;
-                const bool bHasFileTAR      = m_importablesList[jamIdx]->m_fileTAR.empty() == false;
-                const bool bHasFileYAML     = m_importablesList[jamIdx]->m_fileYAML.empty() == false;
-                const bool bHasBothFiles    = bHasFileTAR && bHasFileYAML;
+                const bool bHasValidMetadata    = m_importablesList[jamIdx]->m_bMetadataParseOk;
+                const bool bHasFileTAR          = m_importablesList[jamIdx]->m_fileTAR.empty() == false;
+                const bool bHasFileMetadata     = m_importablesList[jamIdx]->m_fileMetadata.empty() == false;
+                const bool bHasBothFiles        = bHasFileTAR && bHasFileMetadata;
 
                 ImGui::PushID( (int32_t)jamIdx );
                 ImGui::TableNextColumn();
@@ -369,7 +382,7 @@ void JamImporterState::imgui( app::OuroApp& ouroApplication )
                     ImGui::TextUnformatted( "  " );
                     ImGui::SameLine();
 
-                    if ( bHasValidYaml && bHasBothFiles )
+                    if ( bHasValidMetadata && bHasBothFiles )
                     {
                         ImGui::Checkbox( "##import", &m_importablesList[jamIdx]->m_import );
                     }
@@ -381,25 +394,25 @@ void JamImporterState::imgui( app::OuroApp& ouroApplication )
                 }
                 {
                     ImGui::AlignTextToFramePadding();
-                    if ( !bHasFileYAML )
+                    if ( !bHasFileMetadata )
                     {
-                        ImGui::TextColored( colour::shades::errors.neutral(), "No matching .YAML file found" );
+                        ImGui::TextColored( colour::shades::errors.neutral(), "No matching .ORXJ or .YAML file found" );
                         ImGui::CompactTooltip( m_importablesList[jamIdx]->m_fileTAR.string().c_str() );
                     }
-                    else if ( !bHasValidYaml )
+                    else if ( !bHasValidMetadata )
                     {
-                        ImGui::TextColored( colour::shades::errors.neutral(), "YAML file failed to parse" );
-                        ImGui::CompactTooltip( m_importablesList[jamIdx]->m_fileYAML.string().c_str() );
+                        ImGui::TextColored( colour::shades::errors.neutral(), "Jam metadata failed to parse" );
+                        ImGui::CompactTooltip( m_importablesList[jamIdx]->m_fileMetadata.string().c_str() );
                     }
                     else if ( !bHasFileTAR )
                     {
                         ImGui::TextColored( colour::shades::errors.neutral(), "No matching .TAR file found" );
-                        ImGui::CompactTooltip( m_importablesList[jamIdx]->m_fileYAML.string().c_str() );
+                        ImGui::CompactTooltip( m_importablesList[jamIdx]->m_fileMetadata.string().c_str() );
                     }
                     else
                     {
                         ImGui::TextColored( colour::shades::sea_green.neutral(), "%s",
-                            m_importablesList[jamIdx]->m_jamNameFromYAML.c_str() );
+                            m_importablesList[jamIdx]->m_jamNameFromMetadata.c_str() );
 
                         if ( m_importablesList[jamIdx]->m_import )
                             potentialExportsCount++;
@@ -407,9 +420,9 @@ void JamImporterState::imgui( app::OuroApp& ouroApplication )
                     ImGui::TableNextColumn();
                 }
                 {
-                    if ( m_importablesList[jamIdx]->m_importOperationYAML.isValid() )
+                    if ( m_importablesList[jamIdx]->m_importOperationMetadata.isValid() )
                     {
-                        ImGui::Spinner( "##yaml_working", true, ImGui::GetTextLineHeight() * 0.4f, 3.0f, 1.5f, ImGui::GetColorU32( ImGuiCol_Text ) );
+                        ImGui::Spinner( "##meta_working", true, ImGui::GetTextLineHeight() * 0.4f, 3.0f, 1.5f, ImGui::GetColorU32( ImGuiCol_Text ) );
                         anyProcessingHappening = true;
                     }
 
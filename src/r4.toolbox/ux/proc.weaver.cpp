@@ -26,8 +26,6 @@
 
 #include "ux/proc.weaver.h"
 
-#include "zstd.h"
-
 using namespace endlesss;
 
 namespace ux {
@@ -65,87 +63,14 @@ struct Weaver::State
             blog::app( FMTX( "weaver : unable to load {}" ), m_weaverConfig.StorageFilename );
         }
 
-        // setup compression system for undo/redo packing; don't need high compression, ~6 + the trained dictionary
-        // gives us an average return of 4:1 compression in, uh, 0ms (in debug). given the size of our data, diminishing returns as the rate goes up
-        initCompressionSupport( pathProvider, 6 );
     }
 
     ~State()
     {
-        termCompressionSupport();
         APP_EVENT_UNBIND( MixerRiffChange );
     }
 
 
-// ---------------------------------------------------------------------------------------------------------------------
-private:
-
-    static constexpr std::size_t cCompressionBufferSize = 32 * 1024;    // average generated json is 3-4k so we're giving enormous range here
-
-    // create zstd contexts, load our pre-trained dictionary for packing generated riff results
-    void initCompressionSupport( const config::IPathProvider& pathProvider, int32_t compressionLevel )
-    {
-        // work buffers considerably larger than any json we can ever generate
-        m_zstdCompressionBuffer   = static_cast<int8_t*>( rpmalloc( cCompressionBufferSize ) );
-        m_zstdDecompressionBuffer = static_cast<int8_t*>( rpmalloc( cCompressionBufferSize ) );
-
-        // load the Zstd trained codec dictionary if we can
-        const auto zstdDictionaryPath = pathProvider.getPath( config::IPathProvider::PathFor::SharedData ) / "dict" / "zstd.weaver";
-        absl::StatusOr< base::TBinaryFileBuffer > zstdDictionaryData = base::readBinaryFile( zstdDictionaryPath );
-
-        if ( zstdDictionaryData.ok() )
-        {
-            m_zstdCompressionContext    = ZSTD_createCCtx();
-            m_zstdDecompressionContext  = ZSTD_createDCtx();
-
-            m_zstdCompressionDict       = ZSTD_createCDict( std::data( zstdDictionaryData.value() ), std::size( zstdDictionaryData.value() ), compressionLevel );
-            m_zstdDecompressionDict     = ZSTD_createDDict( std::data( zstdDictionaryData.value() ), std::size( zstdDictionaryData.value() ) );
-        }
-        else
-        {
-            blog::app( FMTX( "weaver : cannot load compression dictionary [{}]" ), zstdDictionaryPath.string() );
-        }
-        if ( m_zstdCompressionContext   == nullptr ||
-             m_zstdCompressionDict      == nullptr ||
-             m_zstdDecompressionContext == nullptr ||
-             m_zstdDecompressionDict    == nullptr )
-        {
-            blog::app( FMTX( "weaver : unable to setup zstd" ) );
-            termCompressionSupport();
-        }
-        else
-        {
-            blog::app( FMTX( "weaver : using zstd {} compression" ), ZSTD_versionString() );
-        }
-    }
-
-    void termCompressionSupport()
-    {
-        rpfree( m_zstdCompressionBuffer );
-        m_zstdCompressionBuffer = nullptr;
-
-        rpfree( m_zstdDecompressionBuffer );
-        m_zstdDecompressionBuffer = nullptr;
-
-        ZSTD_freeCDict( m_zstdCompressionDict );
-        m_zstdCompressionDict = nullptr;
-
-        ZSTD_freeDDict( m_zstdDecompressionDict );
-        m_zstdCompressionDict = nullptr;
-
-        ZSTD_freeDCtx( m_zstdDecompressionContext );
-        m_zstdDecompressionContext = nullptr;
-
-        ZSTD_freeCCtx( m_zstdCompressionContext );
-        m_zstdCompressionContext = nullptr;
-    }
-
-    bool hasCompressionSupport() const
-    {
-        return m_zstdCompressionBuffer != nullptr;
-    }
-
-
 public:
 
     void event_MixerRiffChange( const events::MixerRiffChange* eventData );
@@ -172,13 +97,21 @@ public:
         }
     }
 
-    // run the generation code, produce a new virtual riff, enqueue and play it / send over bond etc if required
+    // run the generation code, produce a new virtual riff, enqueue and play it / send over bond etc if required;
+    // with a batch size above 1, that many candidates are generated in parallel and the best one (as judged by the
+    // candidate scorer, if one is set) is chosen, with the rest kept around to audition
     void generateNewRiff(
         app::CoreGUI& coreGUI,
         net::bond::RiffPushClient& bondClient,
         endlesss::toolkit::Warehouse& warehouse,
         int32_t generateSingleChannelAtIndex = -1 );    // dynamic mask - can ask to just re-roll a single channel without modifying the other flags
 
+    // swap in one of the candidates from the last batch generation
+    void auditionCandidate(
+        app::CoreGUI& coreGUI,
+        endlesss::toolkit::Warehouse& warehouse,
+        std::size_t candidateIndex );
+
     void buildVirtualRiffFromLive(
         const endlesss::live::Riff* liveRiff );
 
@@ -256,90 +189,194 @@ public:
         }
     };
 
+    // default scorer; prefers candidates that filled more channels from a wider spread of source jams
+    static float scoreForVariety( const Candidate& candidate )
+    {
+        absl::InlinedVector< endlesss::types::JamCouchID, 8 > sourceJams;
+
+        float score = 0;
+        for ( std::size_t chI = 0; chI < 8; chI++ )
+        {
+            const auto& identity = candidate.m_identities[chI];
+            if ( !identity.hasData() )
+                continue;
+
+            score += 1.0f;
+            if ( !absl::c_linear_search( sourceJams, identity.getJamID() ) )
+            {
+                sourceJams.emplace_back( identity.getJamID() );
+                score += 0.5f;
+            }
+        }
+        return score;
+    }
+
+    // everything the generator reads from the UI state, captured on the main thread before kicking off the workers
+    struct GenerationRequest
+    {
+        GeneratedResult                         m_base;                 // current result, locked channels carry over
+        std::array< bool, 8 >                   m_channelLock;
+        std::array< bool, 8 >                   m_channelClearOut;
+        endlesss::constants::RootScalePairs     m_searchPairs;
+        uint32_t                                m_searchRoot            = 0;
+        uint32_t                                m_searchScale           = 0;
+        uint32_t                                m_searchBPM             = 0;
+        float                                   m_riffBPM               = 0;
+        int32_t                                 m_singleChannelIndex    = -1;
+        bool                                    m_ignoreAnnoyingPresets = true;
+    };
+
+    // build a single candidate from the request; touches no member state other than the read-only preset list
+    GeneratedResult generateCandidate(
+        const GenerationRequest& request,
+        math::RNG32& rng,
+        const endlesss::toolkit::Warehouse& warehouse ) const;
+
 private:
 
-    // undo/redo is conceptually pretty simple; we serialize the current result out to JSON
-    // (not binary as there are issues with cereal), then compress it with zstd and stash the result in a fixed length deque
-    // each one will take around 1kb compressed, max, not including housekeeping bits for the containing std::vector
-    static constexpr std::size_t    cMaxUndoRedoSteps = 512;
+    // undo/redo snapshots; the generated result is written as a set of binary sections - the riff-wide data, then
+    // one section per channel - and each step only keeps the sections that differ from its newer neighbour. the newest
+    // step in each deque is always stored complete, so dropping the oldest step when the deque fills up never breaks
+    // the chain. most edits touch one or two channels, so a typical step is a couple of hundred bytes
+    static constexpr std::size_t    cMaxUndoRedoSteps   = 512;
+    static constexpr std::size_t    cSnapshotSections   = 9;
+    static constexpr uint16_t       cAllSections        = ( 1 << cSnapshotSections ) - 1;
+
+    using SnapshotBytes     = std::vector< uint8_t >;
+    using SnapshotSections  = std::array< SnapshotBytes, cSnapshotSections >;
 
-    void serializeToCompressionDeque( bool bToUndoDeque )
+    struct UndoStep
     {
-        if ( !hasCompressionSupport() )
-            return;
+        uint16_t        m_sectionMask = 0;      // which sections are present in m_data
+        SnapshotBytes   m_data;                 // each present section as [u32 length][bytes], in section order
+    };
+
+    static SnapshotSections captureSnapshot( const GeneratedResult& result );
+    static bool restoreSnapshot( const SnapshotSections& sections, GeneratedResult& result );
 
-        try
+    static UndoStep packStep( const SnapshotSections& sections, const uint16_t sectionMask )
+    {
+        UndoStep step;
+        step.m_sectionMask = sectionMask;
+        for ( std::size_t sI = 0; sI < cSnapshotSections; sI++ )
         {
-            std::ostringstream iss;
-            {
-                cereal::JSONOutputArchive archive( iss, cereal::JSONOutputArchive::Options::NoIndent() );
-                m_generatedResult.serialize( archive );
-            }
-            std::string serialisedResult = iss.str();
+            if ( ( sectionMask & ( 1 << sI ) ) == 0 )
+                continue;
 
-            const std::size_t compSize = ZSTD_compress_usingCDict(
-                m_zstdCompressionContext,
-                m_zstdCompressionBuffer,
-                cCompressionBufferSize,
-                std::data( serialisedResult ),
-                std::size( serialisedResult ) + 1,
-                m_zstdCompressionDict );
+            const uint32_t sectionLength = static_cast<uint32_t>( sections[sI].size() );
+            const auto* lengthBytes = reinterpret_cast<const uint8_t*>( &sectionLength );
+            step.m_data.insert( step.m_data.end(), lengthBytes, lengthBytes + sizeof( sectionLength ) );
+            step.m_data.insert( step.m_data.end(), sections[sI].begin(), sections[sI].end() );
+        }
+        return step;
+    }
 
-            std::deque< CompressedChunk >& dequeToUse = bToUndoDeque ? m_generationUndoBuffer : m_generationRedoBuffer;
+    // overwrite the sections present in the step; returns false if the step data is malformed
+    static bool unpackStep( const UndoStep& step, SnapshotSections& sections )
+    {
+        std::size_t readOffset = 0;
+        for ( std::size_t sI = 0; sI < cSnapshotSections; sI++ )
+        {
+            if ( ( step.m_sectionMask & ( 1 << sI ) ) == 0 )
+                continue;
+
+            uint32_t sectionLength = 0;
+            if ( readOffset + sizeof( sectionLength ) > step.m_data.size() )
+                return false;
+            std::memcpy( &sectionLength, step.m_data.data() + readOffset, sizeof( sectionLength ) );
+            readOffset += sizeof( sectionLength );
+
+            if ( readOffset + sectionLength > step.m_data.size() )
+                return false;
+            sections[sI].assign( step.m_data.begin() + readOffset, step.m_data.begin() + readOffset + sectionLength );
+            readOffset += sectionLength;
+        }
+        return readOffset == step.m_data.size();
+    }
 
-            dequeToUse.emplace_back( m_zstdCompressionBuffer, m_zstdCompressionBuffer + compSize );
-            if ( dequeToUse.size() >= cMaxUndoRedoSteps )
+    // push a complete snapshot; the previous top of the deque is re-encoded as a delta against it
+    static void pushStep( std::deque< UndoStep >& dequeToUse, SnapshotSections&& sections )
+    {
+        if ( !dequeToUse.empty() )
+        {
+            SnapshotSections previousSections;
+            ABSL_ASSERT( dequeToUse.back().m_sectionMask == cAllSections );
+            if ( unpackStep( dequeToUse.back(), previousSections ) )
+            {
+                uint16_t changedMask = 0;
+                for ( std::size_t sI = 0; sI < cSnapshotSections; sI++ )
+                {
+                    if ( previousSections[sI] != sections[sI] )
+                        changedMask |= ( 1 << sI );
+                }
+                dequeToUse.back() = packStep( previousSections, changedMask );
+            }
+            else
             {
-                dequeToUse.pop_front();
+                // shouldn't happen, but a broken chain is no use to anyone
+                dequeToUse.clear();
             }
         }
-        catch ( cereal::Exception& cEx )
+
+        dequeToUse.emplace_back( packStep( sections, cAllSections ) );
+        if ( dequeToUse.size() > cMaxUndoRedoSteps )
         {
-            blog::app( FMTX( "{} serialise failed {}" ), bToUndoDeque ? "undo" : "redo", cEx.what() );
+            dequeToUse.pop_front();
         }
     }
 
-    bool deserializeFromCompressionDeque( bool bFromUndoDeque )
+    // pop the complete snapshot off the top, re-expanding the step beneath it so the invariant holds
+    static bool popStep( std::deque< UndoStep >& dequeToUse, SnapshotSections& sections )
     {
-        std::deque< CompressedChunk >& dequeToUse = bFromUndoDeque ? m_generationUndoBuffer : m_generationRedoBuffer;
-
-        // shouldn't be calling this if we don't have anything in the undo buffer
-        ABSL_ASSERT( !dequeToUse.empty() );
         if ( dequeToUse.empty() )
             return false;
 
-        const CompressedChunk& compressedDataFromDeque = dequeToUse.back();
-
-        const std::size_t dSize = ZSTD_decompress_usingDDict(
-            m_zstdDecompressionContext,
-            m_zstdDecompressionBuffer,
-            cCompressionBufferSize,
-            std::data( compressedDataFromDeque ),
-            std::size( compressedDataFromDeque ),
-            m_zstdDecompressionDict );
-
+        const bool topUnpacked = unpackStep( dequeToUse.back(), sections );
         dequeToUse.pop_back();
 
-        if ( dSize == 0 )
+        if ( !topUnpacked )
+        {
+            dequeToUse.clear();
             return false;
+        }
 
-        // save current data to the opposing queue
-        serializeToCompressionDeque( !bFromUndoDeque );
-
-        try
+        if ( !dequeToUse.empty() )
         {
-            std::istringstream is( (char*)m_zstdDecompressionBuffer );
-            cereal::JSONInputArchive archive( is );
+            SnapshotSections expandedSections = sections;
+            if ( unpackStep( dequeToUse.back(), expandedSections ) )
+                dequeToUse.back() = packStep( expandedSections, cAllSections );
+            else
+                dequeToUse.clear();
+        }
+        return true;
+    }
+
+    bool restoreFromDeque( bool bFromUndoDeque )
+    {
+        std::deque< UndoStep >& dequeToUse = bFromUndoDeque ? m_generationUndoBuffer : m_generationRedoBuffer;
 
-            m_generatedResult.serialize( archive );
+        // shouldn't be calling this if we don't have anything in the undo buffer
+        ABSL_ASSERT( !dequeToUse.empty() );
 
-            return true;
+        SnapshotSections restoredSections;
+        if ( !popStep( dequeToUse, restoredSections ) )
+        {
+            blog::app( FMTX( "{} step could not be decoded" ), bFromUndoDeque ? "undo" : "redo" );
+            return false;
         }
-        catch ( cereal::Exception& cEx )
+
+        GeneratedResult restoredResult;
+        if ( !restoreSnapshot( restoredSections, restoredResult ) )
         {
-            blog::app( FMTX( "{} deserialise failed {}" ), bFromUndoDeque ? "undo" : "redo", cEx.what());
+            blog::app( FMTX( "{} deserialise failed" ), bFromUndoDeque ? "undo" : "redo" );
+            return false;
         }
-        return false;
+
+        // save current data to the opposing queue
+        pushStep( bFromUndoDeque ? m_generationRedoBuffer : m_generationUndoBuffer, captureSnapshot( m_generatedResult ) );
+
+        m_generatedResult = std::move( restoredResult );
+        return true;
     }
 
 public:
@@ -347,7 +384,7 @@ public:
     void saveToUndo()
     {
         std::lock_guard<std::mutex> locked( m_generationUndoRedoMutex );
-        serializeToCompressionDeque( true );
+        pushStep( m_generationUndoBuffer, captureSnapshot( m_generatedResult ) );
 
         // changes made, invalidating redo sequence
         if ( !m_generationRedoBuffer.empty() )
@@ -359,28 +396,18 @@ public:
 
     bool doUndo()
     {
-        return deserializeFromCompressionDeque( true );
+        return restoreFromDeque( true );
     }
 
     bool doRedo()
     {
-        return deserializeFromCompressionDeque( false );
+        return restoreFromDeque( false );
     }
 
 
     config::Weaver                  m_weaverConfig;
 
 
-    // zstd support for packing/unpacking undo/redo steps
-    ZSTD_CCtx*                      m_zstdCompressionContext    = nullptr;
-    ZSTD_CDict*                     m_zstdCompressionDict       = nullptr;
-    int8_t*                         m_zstdCompressionBuffer     = nullptr;
-    ZSTD_DCtx*                      m_zstdDecompressionContext  = nullptr;
-    ZSTD_DDict*                     m_zstdDecompressionDict     = nullptr;
-    int8_t*                         m_zstdDecompressionBuffer   = nullptr;
-    using CompressedChunk           = std::vector< int8_t >;
-
-
     base::EventBusClient            m_eventBusClient;
 
     endlesss::types::RiffCouchID    m_currentlyPlayingRiffID;
@@ -391,8 +418,8 @@ public:
 
 
     std::mutex                      m_generationUndoRedoMutex;
-    std::deque< CompressedChunk >   m_generationUndoBuffer;
-    std::deque< CompressedChunk >   m_generationRedoBuffer;
+    std::deque< UndoStep >          m_generationUndoBuffer;
+    std::deque< UndoStep >          m_generationRedoBuffer;
 
 
     int32_t                         m_searchOrdering = 1;
@@ -412,6 +439,23 @@ public:
 
     GeneratedResult                 m_generatedResult;
 
+    // the candidates from one batch generation; the generation tasks fill in a fresh one of these that nothing else can
+    // see, and it only replaces m_batch once the final task has scored them all and picked the winner
+    struct CandidateBatch
+    {
+        std::vector< GeneratedResult >  m_candidates;
+        std::vector< float >            m_scores;
+        std::size_t                     m_chosenIndex = 0;
+    };
+    using CandidateBatchPtr = std::shared_ptr< CandidateBatch >;
+
+    static constexpr int32_t        cMaxBatchSize = 32;
+    int32_t                         m_batchSize = 1;
+    bool                            m_scoreCandidates = true;               // use a scorer to choose between batch candidates, otherwise take the first
+    CandidateScorer                 m_customScorer;                         // set through Weaver::setCandidateScorer, scoreForVariety if empty
+    std::mutex                      m_batchMutex;                           // guards m_batch and edits to the batch it points at
+    CandidateBatchPtr               m_batch;                                // last completed batch, if any
+
     std::array< bool, 8 >           m_generatedChannelLock;
     std::array< bool, 8 >           m_generatedChannelClearOut;
 
@@ -441,197 +485,476 @@ void Weaver::State::event_MixerRiffChange( const events::MixerRiffChange* eventD
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void Weaver::State::generateNewRiff(
-    app::CoreGUI& coreGUI,
-    net::bond::RiffPushClient& bondClient,
-    endlesss::toolkit::Warehouse& warehouse,
-    int32_t generateSingleChannelAtIndex /*= -1*/ )
+// minimal little-endian byte stream used for undo snapshots; we only ever read back what we wrote in the same session
+// so there's no versioning, just enough bounds checking to fail cleanly on a damaged step
+namespace {
+
+struct SnapshotWriter
 {
-    const auto newSeed = absl::Hash<std::string>{}(m_proceduralSeed);
-    blog::app( FMTX( "Procedural generation seeded from '{}' => {}" ), m_proceduralSeed, newSeed );
+    std::vector< uint8_t >& m_bytes;
 
-    saveToUndo();
+    template< typename T >
+    void write( const T& value )
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        const auto* valueBytes = reinterpret_cast<const uint8_t*>( &value );
+        m_bytes.insert( m_bytes.end(), valueBytes, valueBytes + sizeof( T ) );
+    }
 
-    m_generationInProgress = true;
-    coreGUI.getTaskExecutor().silent_async( [this, newSeed, generateSingleChannelAtIndex, &warehouse]
+    void write( std::string_view text )
+    {
+        write( static_cast<uint32_t>( text.size() ) );
+        m_bytes.insert( m_bytes.end(), text.begin(), text.end() );
+    }
+
+    void write( const std::string& text )
+    {
+        write( std::string_view{ text } );
+    }
+};
+
+struct SnapshotReader
+{
+    const std::vector< uint8_t >&   m_bytes;
+    std::size_t                     m_offset = 0;
+    bool                            m_ok = true;
+
+    template< typename T >
+    void read( T& value )
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        if ( !m_ok || m_offset + sizeof( T ) > m_bytes.size() )
         {
-            math::RNG32 rng( base::reduce64To32( newSeed ) );
+            m_ok = false;
+            return;
+        }
+        std::memcpy( &value, m_bytes.data() + m_offset, sizeof( T ) );
+        m_offset += sizeof( T );
+    }
 
-            // stash current seed to display on screen, re-roll it automatically
-            m_proceduralPreviousSeed = m_proceduralSeed;
-            regenerateSeedText( rng );
+    void read( std::string& text )
+    {
+        uint32_t textLength = 0;
+        read( textLength );
+        if ( !m_ok || m_offset + textLength > m_bytes.size() )
+        {
+            m_ok = false;
+            return;
+        }
+        text.assign( reinterpret_cast<const char*>( m_bytes.data() + m_offset ), textLength );
+        m_offset += textLength;
+    }
+
+    template< typename TCouchID >
+    void readID( TCouchID& couchID )
+    {
+        std::string idText;
+        read( idText );
+        couchID = TCouchID{ idText };
+    }
 
-            // choose how many stems to pick to scatter about
-            int32_t channelsToFill = rng.genInt32( 2, 8 );
+    // weaver identities only ever carry the jam / riff IDs, custom naming isn't used here
+    void read( endlesss::types::RiffIdentity& identity )
+    {
+        endlesss::types::JamCouchID jamCID;
+        endlesss::types::RiffCouchID riffCID;
+        readID( jamCID );
+        readID( riffCID );
+        identity = { std::move( jamCID ), std::move( riffCID ) };
+    }
 
-            // .. just generating one?
-            if ( generateSingleChannelAtIndex >= 0 )
-                channelsToFill = 1;
+    bool finished() const { return m_ok && m_offset == m_bytes.size(); }
+};
 
-            // setup new vriff basis
-            m_generatedResult.m_virtualRiff.user = "[weaver]";
-            m_generatedResult.m_virtualRiff.root = m_searchRoot;
-            m_generatedResult.m_virtualRiff.scale = m_searchScale;
-            m_generatedResult.m_virtualRiff.barLength = 4;
-            m_generatedResult.m_virtualRiff.BPMrnd = static_cast<float>(m_bpmCounts[m_bpmSelection].m_BPM);
+void writeIdentity( SnapshotWriter& writer, const endlesss::types::RiffIdentity& identity )
+{
+    writer.write( identity.getJamID().value() );
+    writer.write( identity.getRiffID().value() );
+}
 
-            // overwrite with locked BPM value, if applied
-            if ( m_searchLockedBPM > 0 )
-                m_generatedResult.m_virtualRiff.BPMrnd = static_cast<float>(m_searchLockedBPM);
+} // anonymous namespace
 
-            // clean out any unlocked channels
-            for ( uint32_t chI = 0; chI < 8; chI++ )
+// ---------------------------------------------------------------------------------------------------------------------
+Weaver::State::SnapshotSections Weaver::State::captureSnapshot( const GeneratedResult& result )
+{
+    SnapshotSections sections;
+
+    // riff-wide data
+    {
+        SnapshotWriter writer{ sections[0] };
+        writer.write( result.m_virtualRiff.user );
+        writer.write( result.m_virtualRiff.root );
+        writer.write( result.m_virtualRiff.scale );
+        writer.write( result.m_virtualRiff.barLength );
+        writer.write( result.m_virtualRiff.BPMrnd );
+        writeIdentity( writer, result.m_virtualIdentity );
+    }
+    // .. then each channel
+    for ( std::size_t chI = 0; chI < 8; chI++ )
+    {
+        SnapshotWriter writer{ sections[chI + 1] };
+        writer.write( static_cast<uint8_t>( result.m_virtualRiff.stemsOn[chI] ? 1 : 0 ) );
+        writer.write( result.m_virtualRiff.stems[chI].value() );
+        writer.write( result.m_virtualRiff.gains[chI] );
+        writer.write( result.m_virtualRiff.stemBarLengths[chI] );
+        writeIdentity( writer, result.m_identities[chI] );
+        writer.write( result.m_stemRef[chI] );
+        writer.write( result.m_stemJamName[chI] );
+        writer.write( result.m_stemTimeDelta[chI] );
+        writer.write( result.m_stemRoot[chI] );
+        writer.write( result.m_stemScale[chI] );
+    }
+
+    return sections;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Weaver::State::restoreSnapshot( const SnapshotSections& sections, GeneratedResult& result )
+{
+    {
+        SnapshotReader reader{ sections[0] };
+        reader.read( result.m_virtualRiff.user );
+        reader.read( result.m_virtualRiff.root );
+        reader.read( result.m_virtualRiff.scale );
+        reader.read( result.m_virtualRiff.barLength );
+        reader.read( result.m_virtualRiff.BPMrnd );
+        reader.read( result.m_virtualIdentity );
+
+        if ( !reader.finished() )
+            return false;
+    }
+    for ( std::size_t chI = 0; chI < 8; chI++ )
+    {
+        SnapshotReader reader{ sections[chI + 1] };
+
+        uint8_t stemOn = 0;
+        reader.read( stemOn );
+        result.m_virtualRiff.stemsOn[chI] = ( stemOn != 0 );
+        reader.readID( result.m_virtualRiff.stems[chI] );
+        reader.read( result.m_virtualRiff.gains[chI] );
+        reader.read( result.m_virtualRiff.stemBarLengths[chI] );
+        reader.read( result.m_identities[chI] );
+        reader.read( result.m_stemRef[chI] );
+        reader.read( result.m_stemJamName[chI] );
+        reader.read( result.m_stemTimeDelta[chI] );
+        reader.read( result.m_stemRoot[chI] );
+        reader.read( result.m_stemScale[chI] );
+
+        if ( !reader.finished() )
+            return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Weaver::State::GeneratedResult Weaver::State::generateCandidate(
+    const GenerationRequest& request,
+    math::RNG32& rng,
+    const endlesss::toolkit::Warehouse& warehouse ) const
+{
+    GeneratedResult result = request.m_base;
+    result.m_virtualIdentity = {};      // assigned when the candidate is first played
+
+    const int32_t generateSingleChannelAtIndex = request.m_singleChannelIndex;
+
+    // choose how many stems to pick to scatter about
+    int32_t channelsToFill = rng.genInt32( 2, 8 );
+
+    // .. just generating one?
+    if ( generateSingleChannelAtIndex >= 0 )
+        channelsToFill = 1;
+
+    // setup new vriff basis
+    result.m_virtualRiff.user = "[weaver]";
+    result.m_virtualRiff.root = request.m_searchRoot;
+    result.m_virtualRiff.scale = request.m_searchScale;
+    result.m_virtualRiff.barLength = 4;
+    result.m_virtualRiff.BPMrnd = request.m_riffBPM;
+
+    // clean out any unlocked channels
+    for ( uint32_t chI = 0; chI < 8; chI++ )
+    {
+        bool clearOutChannel = false;
+        // force clear out of a specific channel?
+        if ( generateSingleChannelAtIndex >= 0 )
+        {
+            if ( generateSingleChannelAtIndex == chI )
+                clearOutChannel = true;
+        }
+        // clean it if we aren't locking this channel or the specific clear-out flag is set
+        else
+        {
+            clearOutChannel = ( request.m_channelLock[chI] == false || request.m_channelClearOut[chI] == true );
+        }
+
+        if ( clearOutChannel )
+        {
+            result.clearChannel( chI );
+        }
+        // if not removing them, still reconsider bar length of any locked ones
+        else
+        {
+            result.m_virtualRiff.barLength = std::max(
+                result.m_virtualRiff.barLength,
+                result.m_virtualRiff.stemBarLengths[chI]
+            );
+        }
+    }
+
+    endlesss::types::StemCouchIDSet usedStemIDs;
+    endlesss::types::StemCouchIDs   potentialStemIDs;
+    std::vector< float >            potentialStemGains;
+    std::vector< float >            potentialStemBarLength;
+
+    // pull all the candidate riffs we might need in one go
+    std::vector< endlesss::types::RiffComplete > randomRiffs;
+    warehouse.fetchRandomRiffsBySeed(
+        request.m_searchPairs,
+        request.m_searchBPM,
+        rng.genInt32(),
+        8,
+        randomRiffs );
+
+    for ( uint32_t chI = 0; chI < 8; chI++ )
+    {
+        if ( chI < randomRiffs.size() )
+        {
+            const endlesss::types::RiffComplete& randomRiff = randomRiffs[chI];
+
+            potentialStemIDs.clear();
+            potentialStemGains.clear();
+            potentialStemBarLength.clear();
+
+            for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+            {
+                if ( randomRiff.riff.stemsOn[stemI] &&
+                     usedStemIDs.contains( randomRiff.riff.stems[stemI] ) == false )
+                {
+                    if ( request.m_ignoreAnnoyingPresets && m_dreadfulPresetsThatIHate.contains( randomRiff.stems[stemI].preset ) )
+                    {
+                        blog::app( FMTX( "weaver : ignoring shit preset: {}" ), randomRiff.stems[stemI].preset );
+                        continue;
+                    }
+
+                    potentialStemIDs.emplace_back( randomRiff.riff.stems[stemI] );
+                    potentialStemGains.emplace_back( randomRiff.riff.gains[stemI] );
+                    potentialStemBarLength.emplace_back( randomRiff.stems[stemI].barLength );
+                }
+            }
+
+            int32_t chosenStemIndex = 0;
+            if ( potentialStemIDs.size() > 1 )
+            {
+                chosenStemIndex = rng.genInt32( 0, (int32_t)potentialStemIDs.size() - 1 );
+            }
+
+            if ( !potentialStemIDs.empty() )
             {
-                bool clearOutChannel = false;
-                // force clear out of a specific channel?
+                int32_t availableChannelIndex = -1;
+
+                // with a specific channel choice, just target that one (assuming 'clear out' isn't selected on it, leave it blank if so)
                 if ( generateSingleChannelAtIndex >= 0 )
                 {
-                    if ( generateSingleChannelAtIndex == chI )
-                        clearOutChannel = true;
+                    if ( request.m_channelClearOut[generateSingleChannelAtIndex] == false )
+                        availableChannelIndex = generateSingleChannelAtIndex;
                 }
-                // clean it if we aren't locking this channel or the specific clear-out flag is set
+                // go find an available unlocked channel to write a new random choice into
                 else
                 {
-                    clearOutChannel = ( m_generatedChannelLock[chI] == false || m_generatedChannelClearOut[chI] == true );
+                    for ( int32_t chI = 0; chI < 8; chI++ )
+                    {
+                        if ( result.m_virtualRiff.stems[chI].empty() &&
+                            request.m_channelClearOut[chI] == false &&
+                            request.m_channelLock[chI] == false )     // allow the lock value to keep an empty channel empty too
+                        {
+                            availableChannelIndex = chI;
+                            break;
+                        }
+                    }
                 }
 
-                if ( clearOutChannel )
+                // .. if we have a free slot
+                if ( availableChannelIndex != -1 )
                 {
-                    m_generatedResult.clearChannel( chI );
-                }
-                // if not removing them, still reconsider bar length of any locked ones
-                else
-                {
-                    m_generatedResult.m_virtualRiff.barLength = std::max(
-                        m_generatedResult.m_virtualRiff.barLength,
-                        m_generatedResult.m_virtualRiff.stemBarLengths[chI]
+                    result.m_virtualRiff.barLength = std::max(
+                        result.m_virtualRiff.barLength,
+                        potentialStemBarLength[chosenStemIndex]
                     );
+
+                    // write new stem
+                    result.m_virtualRiff.stemsOn[availableChannelIndex] = true;
+                    result.m_virtualRiff.stems[availableChannelIndex] = potentialStemIDs[chosenStemIndex];
+                    result.m_virtualRiff.stemBarLengths[availableChannelIndex] = potentialStemBarLength[chosenStemIndex];
+                    result.m_virtualRiff.gains[availableChannelIndex] = rng.genFloat(
+                        potentialStemGains[chosenStemIndex] * 0.8f,
+                        potentialStemGains[chosenStemIndex] );
+
+                    result.m_identities[availableChannelIndex] = { randomRiff.jam.couchID, randomRiff.riff.couchID };
+
+                    usedStemIDs.emplace( potentialStemIDs[chosenStemIndex] );
+
+                    // stash data about it for display on the UI
+                    result.m_stemRef[availableChannelIndex] = fmt::format( FMTX( "[R:{}]\n[S:{}]" ),
+                        randomRiff.riff.couchID,
+                        result.m_virtualRiff.stems[availableChannelIndex] );
+
+                    result.m_stemJamName[availableChannelIndex] = randomRiff.jam.displayName;
+
+                    const auto exportTimeUnix = spacetime::InSeconds( std::chrono::seconds( static_cast<uint64_t>(randomRiff.riff.creationTimeUnix) ) );
+                    result.m_stemTimeDelta[availableChannelIndex] = spacetime::calculateDeltaFromNow( exportTimeUnix ).asPastTenseString( 2 );
+
+                    result.m_stemRoot[availableChannelIndex] = randomRiff.riff.root;
+                    result.m_stemScale[availableChannelIndex] = randomRiff.riff.scale;
                 }
             }
+        }
 
-            endlesss::types::StemCouchIDSet usedStemIDs;
-            endlesss::types::StemCouchIDs   potentialStemIDs;
-            std::vector< float >            potentialStemGains;
-            std::vector< float >            potentialStemBarLength;
+        channelsToFill--;
+        if ( channelsToFill <= 0 )
+            break;
+    }
 
-            // setup a search query
-            endlesss::constants::RootScalePair initialRootScale{ m_generatedResult.m_virtualRiff.root, m_generatedResult.m_virtualRiff.scale };
-            endlesss::constants::RootScalePairs adjacents;
-            {
-                adjacents.searchMode = m_harmonicSearch;
-                adjacents.pairs.emplace_back( initialRootScale );
-                endlesss::constants::computeTonalAdjacents(
-                    initialRootScale,
-                    adjacents );
-            }
+    return result;
+}
 
-            for ( uint32_t chI = 0; chI < 8; chI++ )
-            {
-                endlesss::types::RiffComplete randomRiff;
-                if ( warehouse.fetchRandomRiffBySeed(
-                    adjacents,
-                    m_bpmCounts[m_bpmSelection].m_BPM,
-                    rng.genInt32(),
-                    randomRiff ) )
-                {
-                    potentialStemIDs.clear();
-                    potentialStemGains.clear();
-                    potentialStemBarLength.clear();
+// ---------------------------------------------------------------------------------------------------------------------
+void Weaver::State::generateNewRiff(
+    app::CoreGUI& coreGUI,
+    net::bond::RiffPushClient& bondClient,
+    endlesss::toolkit::Warehouse& warehouse,
+    int32_t generateSingleChannelAtIndex /*= -1*/ )
+{
+    const auto newSeed = absl::Hash<std::string>{}(m_proceduralSeed);
+    blog::app( FMTX( "Procedural generation seeded from '{}' => {}" ), m_proceduralSeed, newSeed );
 
-                    for ( std::size_t stemI = 0; stemI < 8; stemI++ )
-                    {
-                        if ( randomRiff.riff.stemsOn[stemI] &&
-                             usedStemIDs.contains( randomRiff.riff.stems[stemI] ) == false )
-                        {
-                            if ( m_ignoreAnnoyingPresets && m_dreadfulPresetsThatIHate.contains( randomRiff.stems[stemI].preset ) )
-                            {
-                                blog::app( FMTX( "weaver : ignoring shit preset: {}" ), randomRiff.stems[stemI].preset );
-                                continue;
-                            }
+    saveToUndo();
 
-                            potentialStemIDs.emplace_back( randomRiff.riff.stems[stemI] );
-                            potentialStemGains.emplace_back( randomRiff.riff.gains[stemI] );
-                            potentialStemBarLength.emplace_back( randomRiff.stems[stemI].barLength );
-                        }
-                    }
+    math::RNG32 rng( base::reduce64To32( newSeed ) );
+
+    // stash current seed to display on screen, re-roll it automatically
+    m_proceduralPreviousSeed = m_proceduralSeed;
+    regenerateSeedText( rng );
+
+    // snapshot everything the generator needs so the workers don't read UI state that may change under them
+    auto request = std::make_shared<GenerationRequest>();
+    request->m_base                  = m_generatedResult;
+    request->m_channelLock           = m_generatedChannelLock;
+    request->m_channelClearOut       = m_generatedChannelClearOut;
+    request->m_searchPairs           = getRootScalePairsForCurrentSearch();
+    request->m_searchRoot            = m_searchRoot;
+    request->m_searchScale           = m_searchScale;
+    request->m_searchBPM             = m_bpmCounts[m_bpmSelection].m_BPM;
+    request->m_riffBPM               = static_cast<float>( m_bpmCounts[m_bpmSelection].m_BPM );
+    request->m_singleChannelIndex    = generateSingleChannelAtIndex;
+    request->m_ignoreAnnoyingPresets = m_ignoreAnnoyingPresets;
+
+    // overwrite with locked BPM value, if applied
+    if ( m_searchLockedBPM > 0 )
+        request->m_riffBPM = static_cast<float>( m_searchLockedBPM );
+
+    // single-channel re-rolls are always a batch of one
+    const std::size_t candidateCount = ( generateSingleChannelAtIndex >= 0 ) ? 1 : static_cast<std::size_t>( std::clamp( m_batchSize, 1, cMaxBatchSize ) );
+
+    auto batch = std::make_shared<CandidateBatch>();
+    batch->m_candidates.resize( candidateCount );
+    batch->m_scores.assign( candidateCount, 0.0f );
+
+    CandidateScorer candidateScorer;
+    if ( m_scoreCandidates && candidateCount > 1 )
+    {
+        if ( m_customScorer )
+            candidateScorer = m_customScorer;
+        else
+            candidateScorer = &State::scoreForVariety;
+    }
 
-                    int32_t chosenStemIndex = 0;
-                    if ( potentialStemIDs.size() > 1 )
-                    {
-                        chosenStemIndex = rng.genInt32( 0, (int32_t)potentialStemIDs.size() - 1 );
-                    }
+    m_generationInProgress = true;
 
-                    if ( !potentialStemIDs.empty() )
-                    {
-                        int32_t availableChannelIndex = -1;
+    // one task per candidate, each with its own RNG seeded in sequence from the main one, then a final task to pick
+    // the winner and hand it off for playback
+    tf::Taskflow generationFlow;
 
-                        // with a specific channel choice, just target that one (assuming 'clear out' isn't selected on it, leave it blank if so)
-                        if ( generateSingleChannelAtIndex >= 0 )
-                        {
-                            if ( m_generatedChannelClearOut[generateSingleChannelAtIndex] == false )
-                                availableChannelIndex = generateSingleChannelAtIndex;
-                        }
-                        // go find an available unlocked channel to write a new random choice into
-                        else
-                        {
-                            for ( int32_t chI = 0; chI < 8; chI++ )
-                            {
-                                if ( m_generatedResult.m_virtualRiff.stems[chI].empty() &&
-                                    m_generatedChannelClearOut[chI] == false &&
-                                    m_generatedChannelLock[chI] == false )     // allow the lock value to keep an empty channel empty too
-                                {
-                                    availableChannelIndex = chI;
-                                    break;
-                                }
-                            }
-                        }
+    tf::Task chooseTask = generationFlow.emplace( [this, batch, candidateScorer, &warehouse]()
+        {
+            if ( candidateScorer )
+            {
+                const auto bestIt = std::max_element( batch->m_scores.begin(), batch->m_scores.end() );
+                batch->m_chosenIndex = static_cast<std::size_t>( std::distance( batch->m_scores.begin(), bestIt ) );
 
-                        // .. if we have a free slot
-                        if ( availableChannelIndex != -1 )
-                        {
-                            m_generatedResult.m_virtualRiff.barLength = std::max(
-                                m_generatedResult.m_virtualRiff.barLength,
-                                potentialStemBarLength[chosenStemIndex]
-                            );
+                blog::app( FMTX( "weaver : chose candidate {} of {} (score {})" ), batch->m_chosenIndex + 1, batch->m_candidates.size(), *bestIt );
+            }
 
-                            // write new stem
-                            m_generatedResult.m_virtualRiff.stemsOn[availableChannelIndex] = true;
-                            m_generatedResult.m_virtualRiff.stems[availableChannelIndex] = potentialStemIDs[chosenStemIndex];
-                            m_generatedResult.m_virtualRiff.stemBarLengths[availableChannelIndex] = potentialStemBarLength[chosenStemIndex];
-                            m_generatedResult.m_virtualRiff.gains[availableChannelIndex] = rng.genFloat(
-                                potentialStemGains[chosenStemIndex] * 0.8f,
-                                potentialStemGains[chosenStemIndex] );
+            GeneratedResult& chosenCandidate = batch->m_candidates[batch->m_chosenIndex];
 
-                            m_generatedResult.m_identities[availableChannelIndex] = { randomRiff.jam.couchID, randomRiff.riff.couchID };
+            // stamp a new ID for our generated data
+            chosenCandidate.m_virtualIdentity = warehouse.createNewVirtualRiff( chosenCandidate.m_virtualRiff );
+            m_generatedResult = chosenCandidate;
 
-                            usedStemIDs.emplace( potentialStemIDs[chosenStemIndex] );
+            // every candidate task has finished, the batch is complete and can be shown
+            {
+                std::scoped_lock<std::mutex> batchLock( m_batchMutex );
+                m_batch = batch;
+            }
 
-                            // stash data about it for display on the UI
-                            m_generatedResult.m_stemRef[availableChannelIndex] = fmt::format( FMTX( "[R:{}]\n[S:{}]" ),
-                                randomRiff.riff.couchID,
-                                m_generatedResult.m_virtualRiff.stems[availableChannelIndex] );
+            enqeuePlaybackVirtualRiff( warehouse );
 
-                            m_generatedResult.m_stemJamName[availableChannelIndex] = randomRiff.jam.displayName;
+            m_generationInProgress = false;
+        });
 
-                            const auto exportTimeUnix = spacetime::InSeconds( std::chrono::seconds( static_cast<uint64_t>(randomRiff.riff.creationTimeUnix) ) );
-                            m_generatedResult.m_stemTimeDelta[availableChannelIndex] = spacetime::calculateDeltaFromNow( exportTimeUnix ).asPastTenseString( 2 );
+    for ( std::size_t candidateI = 0; candidateI < candidateCount; candidateI++ )
+    {
+        const uint32_t candidateSeed = rng.genUInt32();
 
-                            m_generatedResult.m_stemRoot[availableChannelIndex] = randomRiff.riff.root;
-                            m_generatedResult.m_stemScale[availableChannelIndex] = randomRiff.riff.scale;
-                        }
-                    }
+        generationFlow.emplace( [this, batch, request, candidateI, candidateSeed, candidateScorer, &warehouse]()
+            {
+                math::RNG32 candidateRng( candidateSeed );
+
+                batch->m_candidates[candidateI] = generateCandidate( *request, candidateRng, warehouse );
+                if ( candidateScorer )
+                {
+                    const GeneratedResult& candidate = batch->m_candidates[candidateI];
+                    batch->m_scores[candidateI] = candidateScorer( Candidate{ candidate.m_virtualRiff, candidate.m_identities } );
                 }
+            }).precede( chooseTask );
+    }
+
+    coreGUI.getTaskExecutor().run( std::move( generationFlow ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Weaver::State::auditionCandidate(
+    app::CoreGUI& coreGUI,
+    endlesss::toolkit::Warehouse& warehouse,
+    std::size_t candidateIndex )
+{
+    CandidateBatchPtr batch;
+    GeneratedResult candidate;
+    {
+        std::scoped_lock<std::mutex> batchLock( m_batchMutex );
+
+        ABSL_ASSERT( m_batch != nullptr && candidateIndex < m_batch->m_candidates.size() );
+        batch = m_batch;
+        batch->m_chosenIndex = candidateIndex;
+        candidate = batch->m_candidates[candidateIndex];
+    }
+
+    saveToUndo();
+
+    m_generationInProgress = true;
+    coreGUI.getTaskExecutor().silent_async( [this, batch, candidate = std::move( candidate ), candidateIndex, &warehouse]() mutable
+        {
+            // candidates that haven't been played yet need writing into the warehouse first
+            if ( !candidate.m_virtualIdentity.hasData() )
+            {
+                candidate.m_virtualIdentity = warehouse.createNewVirtualRiff( candidate.m_virtualRiff );
 
-                channelsToFill--;
-                if ( channelsToFill <= 0 )
-                    break;
+                std::scoped_lock<std::mutex> batchLock( m_batchMutex );
+                batch->m_candidates[candidateIndex].m_virtualIdentity = candidate.m_virtualIdentity;
             }
 
-            // stamp a new ID for our generated data
-            m_generatedResult.m_virtualIdentity = warehouse.createNewVirtualRiff( m_generatedResult.m_virtualRiff );
+            m_generatedResult = std::move( candidate );
 
             enqeuePlaybackVirtualRiff( warehouse );
-
             m_generationInProgress = false;
         });
 }
@@ -748,10 +1071,14 @@ void Weaver::State::imgui(
         m_enqueuedRiffIDToAutoSendToBOND.erase( m_currentlyPlayingRiffID );
         if ( BONDConnectionLive )
         {
-            bondClient.pushRiffById( 
+            const auto pushStatus = bondClient.pushRiffById( 
                 endlesss::types::JamCouchID{ endlesss::toolkit::Warehouse::cVirtualJamName },
                 m_currentlyPlayingRiffID,
                 std::nullopt );
+            if ( !pushStatus.ok() )
+            {
+                blog::error::app( FMTX( "weaver auto-send to BOND failed; {}" ), pushStatus.ToString() );
+            }
         }
     }
 
@@ -972,6 +1299,16 @@ void Weaver::State::imgui(
                     math::RNG32 ndrng;
                     regenerateSeedText( ndrng );
                 }
+
+                ImGui::SameLine( 0, 12.0f );
+                ImGui::SetNextItemWidth( 110.0f );
+                ImGui::SliderInt( "##batch_size", &m_batchSize, 1, cMaxBatchSize, "%d variants" );
+                ImGui::CompactTooltip( "Generate this many candidate riffs in parallel; the best is played, the rest can be auditioned below" );
+                ImGui::SameLine();
+                ImGui::Checkbox( "Score", &m_scoreCandidates );
+                ImGui::CompactTooltip( m_customScorer
+                    ? "Choose the batch candidate the installed scorer rates highest,\notherwise just take the first"
+                    : "Choose the batch candidate that fills the most channels from the widest spread of jams,\notherwise just take the first" );
             }
             {
                 const float cSeedButtonWidth = 261.0f;
@@ -984,6 +1321,42 @@ void Weaver::State::imgui(
             }
 
 
+            // audition buttons for the other candidates from the last batch generation
+            std::size_t candidateCount = 0;
+            std::size_t chosenCandidate = 0;
+            std::vector< float > candidateScores;
+            {
+                std::scoped_lock<std::mutex> batchLock( m_batchMutex );
+                if ( m_batch != nullptr )
+                {
+                    candidateCount  = m_batch->m_candidates.size();
+                    chosenCandidate = m_batch->m_chosenIndex;
+                    candidateScores = m_batch->m_scores;
+                }
+            }
+            if ( candidateCount > 1 )
+            {
+                ImGui::Scoped::Disabled sd( m_generationInProgress.load() );
+
+                ImGui::AlignTextToFramePadding();
+                ImGui::TextUnformatted( " Candidates :" );
+                for ( std::size_t candidateI = 0; candidateI < candidateCount; candidateI++ )
+                {
+                    ImGui::PushID( (int32_t)candidateI );
+                    ImGui::SameLine( 0, 4.0f );
+                    {
+                        ImGui::Scoped::ToggleButton tb( candidateI == chosenCandidate );
+                        if ( ImGui::Button( fmt::format( FMTX( "{:2}" ), candidateI + 1 ).c_str() ) )
+                        {
+                            auditionCandidate( coreGUI, warehouse, candidateI );
+                        }
+                    }
+                    if ( m_scoreCandidates )
+                        ImGui::CompactTooltip( fmt::format( FMTX( "score {:.1f}" ), candidateScores[candidateI] ) );
+                    ImGui::PopID();
+                }
+            }
+
             ImGui::Spacing();
             ImGui::Spacing();
 
@@ -1248,6 +1621,12 @@ Weaver::~Weaver()
 {
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void Weaver::setCandidateScorer( CandidateScorer scorer )
+{
+    m_state->m_customScorer = std::move( scorer );
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Weaver::imgui(
     app::CoreGUI& coreGUI,
@@ -53,6 +53,22 @@ struct Weaver
         net::bond::RiffPushClient& bondClient,
         endlesss::toolkit::Warehouse& warehouse );
 
+    // what a scorer gets to see of one batch candidate; the riff that would be played, and where each channel came from
+    struct Candidate
+    {
+        const endlesss::types::VirtualRiff&                     m_virtualRiff;
+        const std::array< endlesss::types::RiffIdentity, 8 >&   m_identities;
+    };
+
+    // judge for batch generation, higher scores win. called from the generation workers, several candidates at once,
+    // so it must be safe to run concurrently
+    using CandidateScorer = std::function< float( const Candidate& ) >;
+
+    // replace the scorer used to choose between batch candidates; an empty function puts back the default, which
+    // prefers candidates that fill more channels from a wider spread of source jams. takes effect from the next batch;
+    // call from the same thread as imgui()
+    void setCandidateScorer( CandidateScorer scorer );
+
 private:
 
     struct State;
@@ -51,6 +51,10 @@ struct SharedRiffView::State
 
     ~State()
     {
+        // a sync still running calls back into us; stop its paging early and let it finish
+        m_fetchCancellation.cancel();
+        m_fetchCancellation.waitForWork();
+
         APP_EVENT_UNBIND( OperationComplete );
         APP_EVENT_UNBIND( BNSWasUpdated );
         APP_EVENT_UNBIND( MixerRiffChange );
@@ -135,6 +139,8 @@ struct SharedRiffView::State
     base::EventBusClient            m_eventBusClient;
 
     std::atomic_bool                m_fetchInProgress = false;
+    base::WorkScheduler::CancellationToken
+                                    m_fetchCancellation;        // cancelled on destruction
     int8_t                          m_busySpinnerIndex = 0;
 
     endlesss::types::RiffCouchID    m_currentlyPlayingRiffID;
@@ -434,16 +440,16 @@ void SharedRiffView::State::imgui(
                 {
                     m_fetchInProgress = true;
 
-                    coreGUI.getTaskExecutor().run( 
-                        m_sharesCache.taskFetchLatest(
-                            *m_networkConfiguration,
-                            m_user.getUsername(),
-                            [this]( toolkit::Shares::StatusOrData newData )
-                            {
-                                onNewDataFetched( newData );
-                                m_fetchInProgress = false;
-                            } )
-                    );
+                    m_sharesCache.fetchLatest(
+                        *m_networkConfiguration,
+                        coreGUI.getWorkScheduler(),
+                        m_fetchCancellation,
+                        m_user.getUsername(),
+                        [this]( toolkit::Shares::StatusOrData newData )
+                        {
+                            onNewDataFetched( newData );
+                            m_fetchInProgress = false;
+                        } );
                 }
             }
             ImGui::SameLine();
@@ -97,7 +97,20 @@ void StemAnalysis( endlesss::live::RiffPtr& liveRiff, const int32_t audioSampleR
             ImPlot::SetupAxis( ImAxis_Y1, nullptr, ImPlotAxisFlags_NoDecorations | ImPlotAxisFlags_LockMin );
 
             ImPlot::SetNextFillStyle( colour::shades::blue_gray.dark(), 0.8f );
-            ImPlot::PlotBars( "##waveform", liveStem->m_channel[0], steppedSampleCount, 0.67, 0, 0, 0, sizeof(float) * sampleStep );
+            if ( liveStem->isCompact() )
+            {
+                // no float data to stride through directly, decode each plotted point instead
+                ImPlot::PlotBarsG( "##waveform", []( int index, void* data )
+                    {
+                        const auto* stem = static_cast<const endlesss::live::Stem*>( data );
+                        return ImPlotPoint( index, stem->getSample( 0, index * sampleStep ) );
+                    },
+                    (void*)liveStem, steppedSampleCount, 0.67 );
+            }
+            else
+            {
+                ImPlot::PlotBars( "##waveform", liveStem->m_channel[0], steppedSampleCount, 0.67, 0, 0, 0, sizeof(float) * sampleStep );
+            }
 
             ImPlot::EndPlot();
         }
@@ -4,6 +4,8 @@
 #include "math/rng.h"
 #include "buffer/mix.h"
 #include "mix/common.h"
+#include "mix/progression.h"
+#include "mix/voices.h"
 
 #include "spacetime/moment.h"
 
@@ -18,7 +20,7 @@
 #include "ux/stem.beats.h"
 #include "ux/riff.tagline.h"
 
-#include "ssp/ssp.file.flac.h"
+#include "ssp/ssp.file.flac.multitrack.h"
 
 #include "discord/discord.bot.ui.h"
 
@@ -28,993 +30,12 @@
 #include "effect/effect.stack.h"
 #include "net/bond.riffpush.h"
 
-#include <ableton/Link.hpp>
-#include <ableton/link/HostTimeFilter.hpp>
-
 
 #define OUROVEON_BEAM           "BEAM"
 #define OUROVEON_BEAM_VERSION   OURO_FRAMEWORK_VERSION "-beta"
 
 using namespace std::chrono_literals;
 
-// ---------------------------------------------------------------------------------------------------------------------
-struct BeamAbletonLinkControl
-{
-    BeamAbletonLinkControl()
-        : m_link( 120.0 )
-    {
-    }
-    ~BeamAbletonLinkControl()
-    {
-        m_link.enable( false );
-    }
-
-    using LinkHostTime = ableton::link::HostTimeFilter<ableton::link::platform::Clock>;
-
-    void Transaction_StopPlaying()
-    {
-        // if the current link state is "playing", snag and change the session to stop it
-        if ( m_linkIsPlaying )
-        {
-            auto linkSessionState = m_link.captureAudioSessionState();
-            {
-                linkSessionState.setIsPlaying(
-                    false,
-                    m_hostTimeFilter.sampleTimeToHostTime( m_sampleTime ) );
-
-                m_linkIsPlaying = false;
-            }
-            m_link.commitAudioSessionState( linkSessionState );
-        }
-    }
-
-
-    ableton::Link               m_link;
-    LinkHostTime                m_hostTimeFilter;
-    std::chrono::microseconds   m_outputLatency;
-    double                      m_sampleTime = 0;
-    int32_t                     m_authorativeInterval = -1;
-    bool                        m_linkIsPlaying = false;
-};
-
-// ---------------------------------------------------------------------------------------------------------------------
-struct MixEngine final : public app::module::MixerInterface,
-                         public rec::IRecordable,
-                         public mix::RiffMixerBase
-{
-    using AudioBuffer = app::module::Audio::OutputBuffer;
-    using AudioSignal = app::module::Audio::OutputSignal;
-
-    static constexpr uint32_t cSampleCountMax = std::numeric_limits<uint32_t>::max();
-
-    // 
-    struct ProgressionConfiguration
-    {
-        ProgressionConfiguration()
-            : m_triggerPoint( TriggerPoint::AnyBarStart )
-            , m_blendTime( BlendTime::TwoBars )
-            , m_greedyMode( false )
-        {}
-
-        bool operator==( ProgressionConfiguration const& ) const = default;
-
-        // choose when to begin blending to the next riff
-        enum class TriggerPoint
-        {
-            Arbitrary,                      // start blending whenever a new riff arrives, yolo
-            NextRiffStart,                  //             .. when a riff loops around to the beginning (ie. once per riff loop)
-            AnyBarStart,                    //             .. when a bar segment is crossed (or near enough) (ie. usually 8 opportunities per riff loop)
-            AnyEvenBarStart,                //             .. when an even-numbered bar is crossed
-        }               m_triggerPoint;
-
-        static constexpr size_t cTriggerPointCount = 4;
-        static constexpr std::array< const char*, cTriggerPointCount > cTriggerPointNames {{
-            "At Any Point",
-            "At Riff Start",
-            "At Any Bar Start",
-            "At Even Bar Start"
-        }};
-        inline static const char* getTriggerPointName( const TriggerPoint tp )
-        {
-            return cTriggerPointNames[(size_t)tp];
-        }
-        inline static bool triggerPointGetter( void* data, int idx, const char** out_text )
-        {
-            *out_text = getTriggerPointName( (TriggerPoint)idx );
-            return true;
-        }
-
-        // how long the blend should take
-        enum class BlendTime
-        {
-            Zero,
-            OneBar,
-            TwoBars,
-            FourBars,
-            EightBars
-        }               m_blendTime;
-
-        static constexpr size_t cBlendTimeCount = 5;
-        static constexpr std::array< const char*, cBlendTimeCount > cBlendTimeNames {{
-            "Instant",
-            "One Bar",
-            "Two Bars",
-            "Four Bars",
-            "Eight Bars"
-        }};
-        inline static const char* getBlendTimeName( const BlendTime bt )
-        {
-            return cBlendTimeNames[(size_t)bt];
-        }
-        inline static bool blendTimeGetter( void* data, int idx, const char** out_text )
-        {
-            *out_text = getBlendTimeName( (BlendTime)idx );
-            return true;
-        }
-        inline float getBlendTimeMultiplier() const
-        {
-            switch ( m_blendTime )
-            {
-            default:
-            case ProgressionConfiguration::BlendTime::OneBar:    return 1.0f;
-            case ProgressionConfiguration::BlendTime::TwoBars:   return 2.0f;
-            case ProgressionConfiguration::BlendTime::FourBars:  return 4.0f;
-            case ProgressionConfiguration::BlendTime::EightBars: return 8.0f;
-            }
-        }
-
-        bool            m_greedyMode;       // if on and there are multiple 'next riffs' in the queue when it comes time to begin
-                                            // blending, empty the list and only blend to the most recent one. if off, we will
-                                            // work our way through each enqueued change in turn
-    };
-
-    struct RepComConfiguration
-    {
-        bool            m_enable = false;   // if multi-track is started, use repcom logic
-    };
-
-    enum class EngineCommand
-    {
-        Invalid,
-        BeginRecording,
-        StopRecording,
-        UpdateProgressionConfiguration,     // pass ProgressionConfiguration*
-        UpdateRepComConfiguration,          // pass RepComConfiguration*
-        ClearCurrentlyPlaying,
-        ClearAllScheduledTransitions
-    };
-    struct EngineCommandData : public base::BasicCommandType<EngineCommand> { using BasicCommandType::BasicCommandType; };
-
-    // bundles a riff request - both the riff data and any layer permutations
-    struct RiffAndPermutation
-    {
-        RiffAndPermutation() = default;
-
-        RiffAndPermutation( endlesss::live::RiffPtr riff )
-            : m_riffPtr( std::move( riff ) )
-        {}
-
-        RiffAndPermutation( endlesss::live::RiffPtr riff, const endlesss::types::RiffPlaybackPermutationOpt& permOpt )
-            : m_riffPtr( std::move( riff ) )
-        {
-            if ( permOpt.has_value() )
-            {
-                m_permutation = permOpt.value();
-            }
-        }
-
-        bool isNotEmpty() const { return m_riffPtr != nullptr; }
-        bool isEmpty() const { return m_riffPtr == nullptr; }
-
-        endlesss::live::RiffPtr                     m_riffPtr;
-        endlesss::types::RiffPlaybackPermutation    m_permutation;
-    };
-
-    using CommandQueue  = mcc::ReaderWriterQueue<EngineCommandData>;
-    using RiffQueue     = mcc::ReaderWriterQueue<RiffAndPermutation>;
-
-
-    uint64_t                    m_samplePosition;
-
-
-    RiffAndPermutation          m_riffCurrent;
-    uint32_t                    m_riffLengthInSamples;
-
-    endlesss::live::RiffProgression
-                                m_playbackProgression;
-
-    RiffQueue                   m_riffQueue;
-    CommandQueue                m_commandQueue;
-
-    RiffAndPermutation          m_riffNext;
-    float                       m_transitionValue;
-
-    float                       m_stemBeatRate;
-    double                      m_transitionRate;
-
-    ProgressionConfiguration    m_progression;
-
-    BeamAbletonLinkControl      m_abletonLinkControl;
-
-
-    MixEngine( const int32_t maxBufferSize, const int32_t sampleRate, const std::chrono::microseconds outputLatency, base::EventBusClient& eventBusClient )
-        : RiffMixerBase( maxBufferSize, sampleRate, eventBusClient )
-        , m_samplePosition( 0 )
-        , m_transitionValue( 0 )
-        , m_stemBeatRate( 4.0f )
-        , m_transitionRate( 0.25 )
-        , m_multiTrackInFlux( false )
-        , m_multiTrackWaitingToRecordOnRiffEdge( false )
-        , m_multiTrackRecording( false )
-        , m_repcomRepeatBar( 0 )
-        , m_repcomPausedOnBar( -1 )
-        , m_repcomRepeatLimit( 0 )
-        , m_repcomSampleStart( 0 )
-        , m_repcomSampleEnd( cSampleCountMax )
-        , m_repcomState( RepComState::Unpaused )
-    {
-        m_abletonLinkControl.m_outputLatency = outputLatency;
-    }
-
-    virtual ~MixEngine()
-    {
-    }
-
-    const app::AudioPlaybackTimeInfo* getPlaybackTimeInfo() const override { return getTimeInfoPtr(); }
-
-
-    inline void addNextRiff( const endlesss::live::RiffPtr& nextRiff )
-    {
-        m_riffQueue.emplace( nextRiff );
-    }
-
-    // add new riff with an optional permutation packet
-    inline void addNextRiff( const endlesss::live::RiffPtr& nextRiff, const endlesss::types::RiffPlaybackPermutationOpt& permOpt )
-    {
-        m_riffQueue.emplace( nextRiff, permOpt );
-    }
-
-
-    inline void updateProgressionConfiguration( const ProgressionConfiguration* pConfig )
-    {
-        m_commandQueue.emplace( EngineCommand::UpdateProgressionConfiguration, (void*) pConfig );
-    }
-
-    void clearAllScheduledTransitions()
-    {
-        m_commandQueue.emplace( EngineCommand::ClearAllScheduledTransitions );
-    }
-
-    inline void updateRepComConfiguration( const RepComConfiguration* pConfig )
-    {
-        m_commandQueue.emplace( EngineCommand::UpdateRepComConfiguration, (void*)pConfig );
-    }
-
-    inline void clearCurrentPlayback()
-    {
-        m_commandQueue.emplace( EngineCommand::ClearCurrentlyPlaying );
-    }
-
-    void enableAbletonLink( bool bEnabled )
-    {
-        m_abletonLinkControl.m_link.enable( bEnabled );
-    }
-
-
-    inline uint32_t getBarRepetitions() const { return m_repcomRepeatBar; }
-
-    inline bool isRepComEnabled() const { return m_repcom.m_enable; }
-    inline bool isRepComPaused() const { return isRepComEnabled() && ( m_repcomState != RepComState::Unpaused ); }
-    inline int32_t getBarPausedOn() const { return m_repcomPausedOnBar; }
-
-
-    void update(
-        const AudioBuffer&  outputBuffer,
-        const AudioSignal&  outputSignal,
-        const uint32_t      samplesToWrite,
-        const uint64_t      samplePosition ) override;
-
-    void commit(
-        const AudioBuffer&  outputBuffer,
-        const AudioSignal&  outputSignal,
-        const uint32_t      samplesToWrite )
-    {
-        buffer::downmix_8channel_stereo(
-            outputSignal.m_linearGain,
-            samplesToWrite,
-            m_mixChannelLeft[0],
-            m_mixChannelLeft[1],
-            m_mixChannelLeft[2],
-            m_mixChannelLeft[3],
-            m_mixChannelLeft[4],
-            m_mixChannelLeft[5],
-            m_mixChannelLeft[6],
-            m_mixChannelLeft[7],
-            m_mixChannelRight[0],
-            m_mixChannelRight[1],
-            m_mixChannelRight[2],
-            m_mixChannelRight[3],
-            m_mixChannelRight[4],
-            m_mixChannelRight[5],
-            m_mixChannelRight[6],
-            m_mixChannelRight[7],
-            outputBuffer.m_workingLR[0],
-            outputBuffer.m_workingLR[1]);
-
-        if ( m_multiTrackRecording )
-        {
-            const bool repComEnabled = isRepComEnabled();
-
-            // repetition compression is being activated or suspended, meaning we need to take just a chunk of the 
-            // presented samples rather than all of it
-            if ( repComEnabled && ( m_repcomState == RepComState::SampleFragmentAndPause ||
-                                    m_repcomState == RepComState::SampleFragmentAndResume ) )
-            {
-                const auto fragmentSampleCount = std::min( (uint32_t)m_repcomSampleEnd, samplesToWrite ) - m_repcomSampleStart;
-
-                blog::mix( "[ REPCOM ] Fragmenting ({})  [ {} ] -> [ {} ]  ({} samples)",
-                    ( m_repcomState == RepComState::SampleFragmentAndPause ) ? "Pausing" : "Resuming",
-                    m_repcomSampleStart,
-                    m_repcomSampleStart + fragmentSampleCount,
-                    fragmentSampleCount );
-
-                for ( auto i = 0; i < 8; i++ )
-                {
-                    m_multiTrackOutputs[i]->appendSamples(
-                        m_mixChannelLeft[i] + m_repcomSampleStart,
-                        m_mixChannelRight[i] + m_repcomSampleStart,
-                        fragmentSampleCount );
-                }
-            }
-            else if ( !repComEnabled || m_repcomState == RepComState::Unpaused )
-            {
-                for ( auto i = 0; i < 8; i++ )
-                {
-                    m_multiTrackOutputs[i]->appendSamples( m_mixChannelLeft[i], m_mixChannelRight[i], samplesToWrite );
-                }
-            }
-        }
-        {
-            if ( m_repcomState == RepComState::SampleFragmentAndPause )
-                 m_repcomState  = RepComState::Paused;
-            if ( m_repcomState == RepComState::SampleFragmentAndResume )
-            {
-                m_repcomState       = RepComState::Unpaused;
-                m_repcomPausedOnBar = -1;
-            }
-
-            m_repcomSampleStart = 0;
-            m_repcomSampleEnd   = cSampleCountMax;
-        }
-    }
-
-    void mainThreadUpdate( const float dT, endlesss::toolkit::Exchange& beatEx )
-    {
-        for ( auto layer = 0U; layer < 8; layer++ )
-            m_multiTrackOutputsToDestroyOnMainThread[layer].reset();
-    }
-
-
-// ---------------------------------------------------------------------------------------------------------------------
-// rec::IRecordable
-
-public:
-
-    inline bool beginRecording( const fs::path& outputPath, const std::string& filePrefix ) override
-    {
-        // should not be calling this if we're already in the process of streaming out
-        assert( !isRecording() );
-        if ( isRecording() )
-            return false;
-
-        math::RNG32 writeBufferShuffleRNG;
-
-        // set up 8 WAV output streams, one for each Endlesss layer
-        for ( auto i = 0; i < 8; i++ )
-        {
-            auto recordFile = outputPath / fmt::format( "{}beam_channel{}.flac", filePrefix, i );
-            m_multiTrackOutputs[i] = ssp::FLACWriter::Create(
-                recordFile.string(),
-                m_audioSampleRate,
-                writeBufferShuffleRNG.genFloat( 0.75f, 1.75f ) );   // randomise the write buffer sizes to avoid all
-                                                                    // outputs flushing outputs simultaneously
-        }
-
-        // tell the worker thread to begin writing to our streams
-        m_commandQueue.enqueue( EngineCommand::BeginRecording );
-        m_multiTrackInFlux = true;
-
-        return true;
-    }
-
-    inline void stopRecording() override
-    {
-        // can't stop what hasn't started
-        assert( isRecording() );
-        if ( !isRecording() )
-            return;
-
-        m_commandQueue.enqueue( EngineCommand::StopRecording );
-        m_multiTrackInFlux = true;
-    }
-
-    // either we're fully engaged with writing out the stream or the request to do (or to stop) is still in-flight
-    inline bool isRecording() const override
-    {
-        return m_multiTrackRecording || 
-               m_multiTrackInFlux;
-    }
-
-    inline uint64_t getRecordingDataUsage() const override
-    {
-        if ( !isRecording() )
-            return 0;
-
-        uint64_t usage = 0;
-        for ( auto i = 0; i < 8; i++ )
-            usage += m_multiTrackOutputs[i]->getStorageUsageInBytes();
-
-        return usage;
-    }
-
-    inline std::string_view getRecorderName() const override { return " Multitrack "; }
-    inline const char* getFluxState() const override
-    {
-        if ( m_repcomState != RepComState::Unpaused )
-            return "[PAUSED] ";
-        if ( m_multiTrackInFlux )
-            return " Awaiting Loop Start";
-
-        return nullptr;
-    }
-
-
-private:
-
-    using MultiTrackStreams = std::array < std::shared_ptr<ssp::FLACWriter>, 8 >;
-
-    bool                m_multiTrackInFlux;
-    bool                m_multiTrackWaitingToRecordOnRiffEdge;
-    bool                m_multiTrackRecording;
-    MultiTrackStreams   m_multiTrackOutputs;                        // currently live recorders
-    MultiTrackStreams   m_multiTrackOutputsToDestroyOnMainThread;   // recorders ready to decommission on main thread
-
-
-    // multitrack "repetition compression" (RepCom) 
-
-    // repcom config written to via engine command
-    RepComConfiguration m_repcom;
-
-    // repcom internal state
-    int32_t             m_repcomRepeatBar;
-    int32_t             m_repcomPausedOnBar;
-    int32_t             m_repcomRepeatLimit;
-    uint32_t            m_repcomSampleStart;
-    uint32_t            m_repcomSampleEnd;
-    enum class RepComState
-    {
-        Unpaused,
-        SampleFragmentAndPause,
-        Paused,
-        SampleFragmentAndResume
-    }                   m_repcomState;
-};
-
-// ---------------------------------------------------------------------------------------------------------------------
-void MixEngine::update(
-    const AudioBuffer&  outputBuffer,
-    const AudioSignal&  outputSignal,
-    const uint32_t      samplesToWrite,
-    const uint64_t      samplePosition )
-{
-    m_samplePosition = samplePosition;
-    m_timeInfo.samplePos = (double)samplePosition;
-
-    stemAmalgamUpdate();
-
-    const double linearTimeStep = (double)samplesToWrite / (double)m_audioSampleRate;
-
-    const auto notifyRepComOfActivity = [&]( uint32_t newStartSample )
-    {
-        assert( m_repcomState != RepComState::SampleFragmentAndResume );
-        if ( m_repcomState == RepComState::Paused )
-        {
-            blog::mix( "[ REPCOM ] UNPAUSE on new activity @ {} -> {}", newStartSample, samplesToWrite );
-
-            m_repcomSampleStart = newStartSample;
-            m_repcomSampleEnd   = cSampleCountMax;
-            m_repcomState       = RepComState::SampleFragmentAndResume;
-        }
-    };
-
-    // flag to indicate that the local data buffers need updating with m_riffCurrent data
-    // .. this is reset mid-cycle in the case we have to handle a transition event where the
-    // riff might change underneith us (via exchangeLiveRiff)
-    bool riffUnpackRequired = true;
-
-    // swap in the Next riff, mark transition/unpack flags as appropriate
-    const auto exchangeLiveRiff = [&]
-    {
-        m_riffCurrent           = m_riffNext;
-        m_riffNext              = {};
-        m_transitionValue       = 0.0f;
-        m_repcomRepeatBar       = 0;
-
-        m_abletonLinkControl.m_authorativeInterval = 1;
-
-        riffUnpackRequired      = true;
-    };
-
-    // process commands from the main thread
-    {
-        EngineCommandData engineCmd;
-        if ( m_commandQueue.try_dequeue( engineCmd ) )
-        {
-            switch ( engineCmd.getCommand() )
-            {
-                // start multitrack on the edge of a riff; the actual recording begins 
-                // when that is detected during the sample loop below
-                case EngineCommand::BeginRecording:
-                {
-                    m_multiTrackWaitingToRecordOnRiffEdge = true;
-                }
-                break;
-
-                // cleanly disengage recording from the mix thread
-                case EngineCommand::StopRecording:
-                {
-                    m_multiTrackWaitingToRecordOnRiffEdge = false;
-                    m_multiTrackRecording                 = false;
-                    m_multiTrackInFlux                    = false;
-
-                    // move recorders over to destroy on the main thread, avoid any stalls
-                    // from whatever may be required to tie off recording
-                    for ( auto i = 0; i < 8; i++ )
-                    {
-                        assert( m_multiTrackOutputsToDestroyOnMainThread[i] == nullptr );
-
-                        m_multiTrackOutputsToDestroyOnMainThread[i] = m_multiTrackOutputs[i];
-                        m_multiTrackOutputs[i].reset();
-                    }
-
-                    blog::mix( "[ Multitrack ] ... Stopped" );
-                }
-                break;
-
-                case EngineCommand::UpdateProgressionConfiguration:
-                {
-                    assert( engineCmd.getPtr() != nullptr );
-                    m_progression = *engineCmd.getPtrAs< ProgressionConfiguration >();
-                }
-                break;
-
-                case EngineCommand::UpdateRepComConfiguration:
-                {
-                    assert( !isRecording() );   // should not be allowed to update if recording is already underway
-                    assert( engineCmd.getPtr() != nullptr );
-                    m_repcom = *engineCmd.getPtrAs< RepComConfiguration >();
-                }
-                break;
-
-                case EngineCommand::ClearCurrentlyPlaying:
-                {
-                    m_riffNext = {};
-                    exchangeLiveRiff();
-                }
-                break;
-
-                case EngineCommand::ClearAllScheduledTransitions:
-                {
-                    // purge the queue
-                    RiffAndPermutation dumpRiff;
-                    while ( m_riffQueue.try_dequeue( dumpRiff ) )
-                    { }
-                }
-                break;
-
-                default:
-                case EngineCommand::Invalid:
-                    blog::error::mix( "Unknown or invalid command received" );
-                    break;
-            }
-        }
-    }
-
-    const auto checkForAndDequeueNextRiff = [&]
-    {
-        if ( m_riffNext.isEmpty() )
-        {
-            if ( m_riffQueue.peek() != nullptr &&
-                 m_transitionValue == 0 )
-            {
-                if ( !m_riffQueue.try_dequeue( m_riffNext ) )
-                {
-                    assert( false );
-                    return false;
-                }
-
-                blog::mix( "[ BLEND ] DEQUEUED new riff" );
-
-                if ( m_riffNext.m_riffPtr->getSyncState() != endlesss::live::Riff::SyncState::Success )
-                {
-                    blog::error::mix( "[ BLEND ] .. new riff invalid, ignoring it" );
-                    m_riffNext = {};
-                }
-
-                // hard cut
-                if ( m_progression.m_blendTime == ProgressionConfiguration::BlendTime::Zero )
-                {
-                    blog::mix( "[ BLEND ] hard cut" );
-                    exchangeLiveRiff();
-                }
-                // pick blend rate based on how many bars to take
-                else
-                {
-                    ABSL_ASSERT( m_riffNext.isNotEmpty() );
-                    m_transitionRate = 1.0 / ( m_riffNext.m_riffPtr->m_timingDetails.m_lengthInSecPerBar * m_progression.getBlendTimeMultiplier() );
-                }
-            }
-        }
-
-        return ( m_riffNext.isNotEmpty() );
-    };
-
-    // in Arbitrary mode, check all the time to see if we could be switching
-    if ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::Arbitrary )
-    {
-        checkForAndDequeueNextRiff();
-    }
-
-    // update the transition, if one is active; and swap in the next riff if one has completed
-    if ( m_riffNext.isNotEmpty() )
-    {
-        m_transitionValue += (float)(linearTimeStep * m_transitionRate);
-
-        if ( m_transitionValue >= 1.0f )
-        {
-            blog::mix( "[ BLEND ] completed" );
-            exchangeLiveRiff();
-        }
-    }
-
-    // early out if we have nothing to play or the active riff is 0-length
-    if ( m_riffCurrent.isEmpty() ||
-         m_riffCurrent.m_riffPtr->m_timingDetails.m_lengthInSamples == 0 )
-    {
-        outputBuffer.applySilence();
-
-        // reset computed riff playback variables
-        m_playbackProgression.reset();
-
-        // check if there's something on the horizon
-        if ( m_riffQueue.peek() != nullptr )
-        {
-            if ( checkForAndDequeueNextRiff() )
-            {
-                blog::mix( "[ BLEND ] hard cut to first riff" );
-                exchangeLiveRiff();
-                notifyRepComOfActivity( 0 );
-            }
-        }
-
-        // deal with LINK session update with nothing playing
-        {
-            m_abletonLinkControl.Transaction_StopPlaying();
-            m_abletonLinkControl.m_sampleTime += static_cast<double>(samplesToWrite);
-        }
-
-        return;
-    }
-
-
-
-    const endlesss::live::Riff* currentRiff = m_riffCurrent.m_riffPtr.get();
-    const endlesss::types::RiffPlaybackPermutation& currentPermutation = m_riffCurrent.m_permutation;
-
-    // compute where we are (roughly) for the UI
-    currentRiff->getTimingDetails().ComputeProgressionAtSample( m_samplePosition, m_playbackProgression );
-
-
-
-    // update vst time structure with latest state
-    m_timeInfo.tempo              = currentRiff->m_timingDetails.m_bpm;
-    m_timeInfo.timeSigNumerator   = currentRiff->m_timingDetails.m_quarterBeats;
-    m_timeInfo.timeSigDenominator = 4;
-
-
-    std::array< bool,  16 >         stemHasBeat;
-    std::array< float, 16 >         stemEnergy;
-    std::array< float, 16 >         stemTimeStretch;
-    std::array< float, 16 >         stemGains;
-    std::array< endlesss::live::Stem*, 16 >   stemPtr;
-
-    // keep note of where we are mixing in terms of the 0..N sample count of the current riff
-    std::array< uint32_t, 2 >       riffLengthInSamples;
-    std::array< uint32_t, 2 >       riffWrappedSampleStart;
-    
-    stemHasBeat.fill( false );
-    stemEnergy.fill( 0.0f );
-    stemTimeStretch.fill( 0.0f );
-    stemGains.fill( 0.0f );
-    stemPtr.fill( nullptr );
-
-    riffLengthInSamples.fill( 0 );
-    riffWrappedSampleStart.fill( 0 );
-
-    // unpack our primary foreground riff into the local data buffers used during sample filling
-    const auto decodeForegroundRiffData = [&]
-    {
-        riffLengthInSamples[0]      = currentRiff->m_timingDetails.m_lengthInSamples;
-        riffWrappedSampleStart[0]   = samplePosition % riffLengthInSamples[0];
-
-        for (auto stemI = 0U; stemI < 8; stemI++)
-        {
-            stemTimeStretch[stemI]  = currentRiff->m_stemTimeScales[stemI];
-            stemGains[stemI]        = currentRiff->m_stemGains[stemI] * currentPermutation.m_layerGainMultiplier[stemI];
-            stemPtr[stemI]          = currentRiff->m_stemPtrs[stemI];
-        }
-    };
-    decodeForegroundRiffData();
-
-    // unpack transitional riff? can be called mid-loop if we pull a new riff off the pile
-    const auto decodeTransitionalRiffData = [&]
-    {
-        if ( m_transitionValue > 0 )
-        {
-            const auto* nextRiff        = m_riffNext.m_riffPtr.get();
-            const auto& nextPermutation = m_riffNext.m_permutation;
-
-            riffLengthInSamples[1]      = nextRiff->m_timingDetails.m_lengthInSamples;
-            riffWrappedSampleStart[1]   = samplePosition % riffLengthInSamples[1];
-
-            for ( auto stemI = 0U; stemI < 8; stemI++ )
-            {
-                stemTimeStretch[ 8 + stemI ]  = nextRiff->m_stemTimeScales[stemI];
-                stemGains[ 8 + stemI ]        = nextRiff->m_stemGains[stemI] * nextPermutation.m_layerGainMultiplier[stemI];
-                stemPtr[ 8 + stemI ]          = nextRiff->m_stemPtrs[stemI];
-            }
-        }
-    };
-    decodeTransitionalRiffData();
-
-
-    const auto segmentLengthInSamples   = currentRiff->m_timingDetails.m_lengthInSamplesPerBar;
-          auto segmentSampleStart       = samplePosition % segmentLengthInSamples;
-
-    for ( auto sI = 0U; sI < samplesToWrite; sI++ )
-    {
-        const uint64_t sample = samplePosition + sI;
-
-        // get sample position in context of the riff
-        uint64_t riffSample   = riffWrappedSampleStart[0] + sI;
-        if ( riffSample >= riffLengthInSamples[0] )
-            riffSample -= riffLengthInSamples[0];
-
-        while ( segmentSampleStart >= segmentLengthInSamples )
-        {
-            segmentSampleStart -= segmentLengthInSamples;
-
-            m_playbackProgression.m_playbackBar++;
-            if ( m_playbackProgression.m_playbackBar >= currentRiff->m_timingDetails.m_barCount )
-                m_playbackProgression.m_playbackBar = 0;
-        }
-
-        const uint64_t segmentSample = segmentSampleStart++;
-
-
-        if ( segmentSample == 0 )
-        {
-//            blog::mix( "[ Edge ] Bar {}", m_riffPlaybackBar + 1 );
-
-            const bool isEvenBarNumber = (m_playbackProgression.m_playbackBar & 1 ) == 0;
-            const bool shouldTriggerTransition =
-                // any bar
-                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::AnyBarStart ) ||
-                // 0, 2, 4, .. 
-                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::AnyEvenBarStart && isEvenBarNumber ) ||
-                // next riff is bar 0
-                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::NextRiffStart && m_playbackProgression.m_playbackBar == 0 );
-
-            if ( shouldTriggerTransition )
-            {
-                bool allowedToTrigger = true;
-
-                if ( isRepComPaused() && m_repcomPausedOnBar != m_playbackProgression.m_playbackBar )
-                    allowedToTrigger = false;
-
-                if ( allowedToTrigger && checkForAndDequeueNextRiff() )
-                {
-                    if ( riffUnpackRequired )
-                        decodeForegroundRiffData();
-                    decodeTransitionalRiffData();
-                    notifyRepComOfActivity( sI );
-                }
-            }
-
-            if ( m_multiTrackRecording )
-            {
-                m_repcomRepeatBar++;
-
-                const bool repComTriggerPause = isRepComEnabled() &&
-                                                m_repcomRepeatBar >= currentRiff->m_timingDetails.m_longestStemInBars;
-
-                if (    repComTriggerPause
-                     && m_repcomState           == RepComState::Unpaused
-                     && m_riffNext.m_riffPtr    == nullptr
-                     && m_transitionValue       == 0 )
-                {
-                    blog::mix( "[ REPCOM ] Pausing @ bar {}, sample offset {}", m_playbackProgression.m_playbackBar, sI );
-
-                    m_repcomPausedOnBar = m_playbackProgression.m_playbackBar;
-
-                    m_repcomSampleStart = 0;
-                    m_repcomSampleEnd   = sI;
-                    m_repcomState       = RepComState::SampleFragmentAndPause;
-                }
-            }
-        }
-        if ( riffSample == 0 )
-        {
-            blog::mix( "[ Edge ] Riff" );
-
-            // multitrack recording waits till the start of a riff to begin
-            if ( m_multiTrackWaitingToRecordOnRiffEdge )
-            {
-                // begin writing out data
-                m_multiTrackRecording                 = true;
-                m_multiTrackWaitingToRecordOnRiffEdge = false;
-                m_multiTrackInFlux                    = false;
-
-                // reset repcom stats
-                m_repcomRepeatBar                     = 0;
-
-                blog::mix( "[ Multitrack ] Recording ..." );
-            }
-        }
-
-
-        for ( auto stemI = 0U; stemI < 8; stemI++ )
-        {
-            const endlesss::live::Stem* stemInst = stemPtr[stemI];
-            const float       stemGain = stemGains[stemI];
-
-            if ( stemInst == nullptr || stemInst->hasFailed() )
-            {
-                m_mixChannelLeft[stemI][sI] = 0;
-                m_mixChannelRight[stemI][sI] = 0;
-
-                m_stemDataAmalgam.m_wave[stemI] = 0;
-                m_stemDataAmalgam.m_beat[stemI] = 0;
-                m_stemDataAmalgam.m_low[stemI]  = 0;
-                m_stemDataAmalgam.m_high[stemI] = 0;
-                continue;
-            }
-
-            const auto sampleCount = stemInst->m_sampleCount;
-            uint64_t finalSampleIdx = riffSample;
-
-            if (stemTimeStretch[stemI] != 1.0f)
-            {
-                double scaleSample = (double)finalSampleIdx * stemTimeStretch[stemI];
-                finalSampleIdx = (uint64_t)scaleSample;
-            }
-            finalSampleIdx %= sampleCount;
-
-
-            if ( stemInst->getAnalysisState() == endlesss::live::Stem::AnalysisState::AnalysisValid )
-            {
-                const float permGain = currentPermutation.m_layerGainMultiplier[stemI];
-
-                const auto& stemAnalysis = stemInst->getAnalysisData();
-
-                const float stemWave = stemAnalysis.getWaveF( finalSampleIdx ) * permGain;
-                const float stemBeat = stemAnalysis.getBeatF( finalSampleIdx ) * permGain;
-                const float stemLow  = stemAnalysis.getLowFreqF( finalSampleIdx ) * permGain;
-                const float stemHigh = stemAnalysis.getHighFreqF( finalSampleIdx ) * permGain;
-
-                m_stemDataAmalgam.m_wave[stemI] = std::max( m_stemDataAmalgam.m_wave[stemI], stemWave );
-                m_stemDataAmalgam.m_beat[stemI] = std::max( m_stemDataAmalgam.m_beat[stemI], stemBeat );
-                m_stemDataAmalgam.m_low[stemI]  = std::max( m_stemDataAmalgam.m_low[stemI],  stemLow  );
-                m_stemDataAmalgam.m_high[stemI] = std::max( m_stemDataAmalgam.m_high[stemI], stemHigh );
-            }
-
-            m_mixChannelLeft[stemI][sI]  = stemInst->m_channel[0][finalSampleIdx] * stemGain;
-            m_mixChannelRight[stemI][sI] = stemInst->m_channel[1][finalSampleIdx] * stemGain;
-        }
-
-        if ( m_transitionValue > 0 )
-        {
-            riffSample = riffWrappedSampleStart[1] + sI;
-            if ( riffSample >= riffLengthInSamples[1] )
-                riffSample -= riffLengthInSamples[1];
-
-            for ( auto stemI = 0U; stemI < 8; stemI++ )
-            {
-                const endlesss::live::Stem* stemInst = stemPtr[ 8 + stemI ];
-                const float       stemGain = stemGains[ 8 + stemI ];
-        
-                // when transitioning, a missing/muted stem means we need to transition down to silence, not just skip entirely
-                if ( stemInst == nullptr || stemInst->hasFailed() )
-                {
-                    m_mixChannelLeft[stemI][sI]     = base::lerp( m_mixChannelLeft[stemI][sI],  0.0f, m_transitionValue );
-                    m_mixChannelRight[stemI][sI]    = base::lerp( m_mixChannelRight[stemI][sI], 0.0f, m_transitionValue );
-
-                    continue;
-                }
-        
-                const auto sampleCount = stemInst->m_sampleCount;
-                uint64_t finalSampleIdx = riffSample;
-        
-                if ( stemTimeStretch[ 8 + stemI ] != 1.0f )
-                {
-                    double scaleSample = (double)finalSampleIdx * stemTimeStretch[ 8 + stemI ];
-                    finalSampleIdx = (uint64_t)scaleSample;
-                }
-                finalSampleIdx %= sampleCount;
-
-                m_mixChannelLeft[stemI][sI]         = base::lerp( m_mixChannelLeft[stemI][sI],  stemInst->m_channel[0][finalSampleIdx] * stemGain, m_transitionValue );
-                m_mixChannelRight[stemI][sI]        = base::lerp( m_mixChannelRight[stemI][sI], stemInst->m_channel[1][finalSampleIdx] * stemGain, m_transitionValue );
-            }
-        }
-    }
-
-    m_stemDataAmalgamSamplesUsed += samplesToWrite;
-
-    // LINK logic EXTREMELY WIP HACK
-    if ( currentRiff != nullptr )
-    {
-        const auto& timingData = currentRiff->getTimingDetails();
-
-        // compute timing state when update() began
-        endlesss::live::RiffProgression progressionAtEndOfUpdate;
-        currentRiff->getTimingDetails().ComputeProgressionAtSample(
-            m_samplePosition + samplesToWrite,
-            progressionAtEndOfUpdate );
-
-        const double timingQuantum = static_cast<double>(timingData.m_quarterBeats);
-
-        const auto hostTime = m_abletonLinkControl.m_hostTimeFilter.sampleTimeToHostTime( m_abletonLinkControl.m_sampleTime );
-        m_abletonLinkControl.m_sampleTime += static_cast<double>(samplesToWrite);
-
-        const auto bufferBeginAtOutput = hostTime + m_abletonLinkControl.m_outputLatency;
-
-        auto linkSessionState = m_abletonLinkControl.m_link.captureAudioSessionState();
-
-        // always write our tempo. we are the tempo.
-        linkSessionState.setTempo( timingData.m_bpm, bufferBeginAtOutput );
-
-        // on the arrival of a new riff when nothing was playing, tag IsPlaying in the session state and force
-        // a new 0-beat to match
-        if ( !m_abletonLinkControl.m_linkIsPlaying )
-        {
-            linkSessionState.setIsPlaying( true, bufferBeginAtOutput );
-            linkSessionState.forceBeatAtTime( 0, bufferBeginAtOutput, timingQuantum );
-            m_abletonLinkControl.m_linkIsPlaying = true;
-        }
-
-        if ( progressionAtEndOfUpdate.m_playbackBarSegment != m_playbackProgression.m_playbackBarSegment )
-        {
-            std::chrono::microseconds zeroBeatUsOffset( std::llround( progressionAtEndOfUpdate.m_playbackQuarterTimeSec * 1.0e6 ) );
-
-            if ( progressionAtEndOfUpdate.m_playbackBarSegment == 0 || m_abletonLinkControl.m_authorativeInterval >= 0 )
-                linkSessionState.forceBeatAtTime( progressionAtEndOfUpdate.m_playbackBarSegment, bufferBeginAtOutput + zeroBeatUsOffset, timingQuantum );
-            else
-                linkSessionState.requestBeatAtTime( progressionAtEndOfUpdate.m_playbackBarSegment, bufferBeginAtOutput + zeroBeatUsOffset, timingQuantum );
-
-            if ( m_abletonLinkControl.m_authorativeInterval >= 0 )
-            {
-                m_abletonLinkControl.m_authorativeInterval--;
-                blog::mix( FMTX( "authorativeInterval:{}" ), m_abletonLinkControl.m_authorativeInterval );
-            }
-        }
-
-        m_abletonLinkControl.m_link.commitAudioSessionState( linkSessionState );
-    }
-
-    commit( outputBuffer, outputSignal, samplesToWrite );
-}
-
-
 
 // ---------------------------------------------------------------------------------------------------------------------
 struct BeamApp : public app::OuroApp,
@@ -1071,10 +92,10 @@ protected:
 
     endlesss::types::JamCouchID             m_trackedJamCouchID;
 
-    MixEngine::ProgressionConfiguration     m_mixProgressionConfig;
-    MixEngine::ProgressionConfiguration     m_mixProgressionConfigCommitted;
+    mix::ProgressionEngine::ProgressionConfiguration     m_mixProgressionConfig;
+    mix::ProgressionEngine::ProgressionConfiguration     m_mixProgressionConfigCommitted;
 
-    MixEngine::RepComConfiguration          m_repComConfig;
+    mix::ProgressionEngine::RepComConfiguration          m_repComConfig;
 
     std::unique_ptr< ux::TagLine >          m_uxTagLine;
 
@@ -1095,11 +116,12 @@ int BeamApp::EntrypointOuro()
 
 
     // create and install the mixer engine
-    MixEngine mixEngine(
+    mix::ProgressionEngine mixEngine(
         m_mdAudio->getMaximumBufferSize(),
         m_mdAudio->getSampleRate(),
         m_mdAudio->getOutputLatencyMs(),
         m_appEventBusClient.value() );
+    mixEngine.setMultiTrackEncoderOptions( getFLACEncoderOptions() );
     m_mdAudio->blockUntil( m_mdAudio->installMixer( &mixEngine ) );
 
     // LINK controls for the mixer
@@ -1140,6 +162,8 @@ int BeamApp::EntrypointOuro()
     endlesss::toolkit::Pipeline riffPipeline(
         m_appEventBus,
         riffFetchProvider,
+        m_workScheduler,
+        base::WorkScheduler::Lane::Interactive,
         32,
         [this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result) -> bool
         {
@@ -1277,6 +301,13 @@ int BeamApp::EntrypointOuro()
                 ux::widget::DiskRecorder( mixEngine, m_storagePaths->outputApp );
             }
             ImGui::EndChild();
+
+            // live encoder stats while the multitrack recorder is running
+            if ( auto multiTrackRecorder = mixEngine.getMultiTrackRecorder() )
+            {
+                ImGui::Spacing();
+                ux::widget::FLACRecorderStatistics( *multiTrackRecorder );
+            }
             
             ImGui::Spacing();
             ImGui::SeparatorBreak();
@@ -1444,8 +475,8 @@ int BeamApp::EntrypointOuro()
                 const auto progressBarHeight = ImVec2( -1.0f, currentLineHeight * 1.25f );
 
                 {
-                    const auto* progTrigger = MixEngine::ProgressionConfiguration::getTriggerPointName( mixEngine.m_progression.m_triggerPoint );
-                    const auto* progBlend = MixEngine::ProgressionConfiguration::getBlendTimeName( mixEngine.m_progression.m_blendTime );
+                    const auto* progTrigger = mix::ProgressionEngine::ProgressionConfiguration::getTriggerPointName( mixEngine.m_progression.m_triggerPoint );
+                    const auto* progBlend = mix::ProgressionEngine::ProgressionConfiguration::getBlendTimeName( mixEngine.m_progression.m_blendTime );
 
                     ImGui::Text( "Trigger %s, %s %s",
                         progTrigger,
@@ -1457,8 +488,12 @@ int BeamApp::EntrypointOuro()
                 {
                     ImGui::PushStyleColor( ImGuiCol_PlotHistogram, ImGui::GetStyleColorVec4( ImGuiCol_NavHighlight ) );
 
+                    const uint32_t riffsAudible = mixEngine.m_riffVoicesActive;
+
                     if ( itemsInRiffQueue )
                         ImGui::ProgressBar( mixEngine.m_transitionValue, progressBarHeight, " Transition Scheduled ... " );
+                    else if ( riffsAudible > 2 )
+                        ImGui::ProgressBar( mixEngine.m_transitionValue, progressBarHeight, fmt::format( FMTX( " Transitioning, {} riffs layered ... " ), riffsAudible ).c_str() );
                     else if ( mixEngine.m_transitionValue > 0 )
                         ImGui::ProgressBar( mixEngine.m_transitionValue, progressBarHeight, " Transitioning ... " );
                     else
@@ -1489,8 +524,9 @@ int BeamApp::EntrypointOuro()
 
                 ImGui::PushItemWidth( 180.0f );
 
-                ImGui::Combo( " Trigger Point", (int32_t*)&m_mixProgressionConfig.m_triggerPoint, &MixEngine::ProgressionConfiguration::triggerPointGetter, nullptr, MixEngine::ProgressionConfiguration::cTriggerPointCount );
-                ImGui::Combo( " Transition Time",  (int32_t*)&m_mixProgressionConfig.m_blendTime, &MixEngine::ProgressionConfiguration::blendTimeGetter,    nullptr, MixEngine::ProgressionConfiguration::cBlendTimeCount );
+                ImGui::Combo( " Trigger Point", (int32_t*)&m_mixProgressionConfig.m_triggerPoint, &mix::ProgressionEngine::ProgressionConfiguration::triggerPointGetter, nullptr, mix::ProgressionEngine::ProgressionConfiguration::cTriggerPointCount );
+                ImGui::Combo( " Transition Time",  (int32_t*)&m_mixProgressionConfig.m_blendTime, &mix::ProgressionEngine::ProgressionConfiguration::blendTimeGetter,    nullptr, mix::ProgressionEngine::ProgressionConfiguration::cBlendTimeCount );
+                ImGui::Combo( " Transition Curve", (int32_t*)&m_mixProgressionConfig.m_blendCurve, &mix::ProgressionEngine::ProgressionConfiguration::blendCurveGetter, nullptr, mix::ProgressionEngine::ProgressionConfiguration::cBlendCurveCount );
                 //ImGui::Checkbox( "Empty Riff Queue On Transition", &m_mixProgressionConfig.m_greedyMode );
 
                 const bool progressionIsUpToDate = ( m_mixProgressionConfigCommitted == m_mixProgressionConfig );
@@ -0,0 +1,1054 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  headless benchmark runner for the core data and audio hot paths. everything it touches - FLAC stems, riffs, a
+//  populated warehouse database - is synthesised up-front from fixed seeds into a scratch directory, so numbers are
+//  comparable between machines and between commits. results are logged and written out as JSON
+//
+//  also hosts the mixer regression harness, see bench.mixcheck.h, and the data-side checks in bench.selfcheck.h
+//
+//  usage : bench [results.json]
+//          bench --mixcheck <golden directory> [--update] [--tolerance <value>]
+//          bench --selfcheck
+//
+
+#include "pch.h"
+
+#include "base/utils.h"
+#include "base/eventbus.h"
+#include "base/operations.h"
+
+#include "buffer/buffer.iquant.h"
+#include "dsp/timestretch.h"
+#include "filesys/fsutil.h"
+#include "math/rng.h"
+#include "spacetime/moment.h"
+
+#include "app/core.h"
+#include "app/module.audio.h"
+
+#include "endlesss/all.h"
+#include "endlesss/toolkit.jam.archive.h"
+
+#include "mix/common.h"
+#include "mix/preview.h"
+#include "mix/stem.amalgam.h"
+
+#include "bench.env.h"
+#include "bench.mixcheck.h"
+#include "bench.selfcheck.h"
+
+namespace bench {
+
+// stems of the benchmark riff are a mix of loop lengths to exercise the repeat logic
+static constexpr std::array< uint32_t, 8 >
+                            cStemBars               = { 8, 4, 2, 8, 4, 8, 2, 1 };
+
+static constexpr uint32_t   cMixBlockSize           = 256;          // samples per Preview::update, a typical device buffer
+static constexpr uint32_t   cMixSecondsPerIteration = 30;
+
+static constexpr uint32_t   cQuantiseSampleCount    = cTargetSampleRate;    // one second of stereo per quantise
+
+static constexpr std::size_t cWarehouseJamCount     = 6;            // more than the slice cache holds, so every slice request is a full query
+static constexpr std::size_t cWarehouseRiffsPerJam  = 4000;
+static constexpr std::size_t cWarehouseStemsPerJam  = 1500;
+static constexpr std::size_t cWarehouseUserCount    = 24;
+static constexpr std::size_t cWarehouseTagsPerBatch = 250;
+static constexpr std::size_t cWarehouseTagLookups   = 1000;
+
+static_assert( cWarehouseJamCount > endlesss::toolkit::Warehouse::cJamSliceCacheSize, "benchmark jams must be able to evict each other from the slice cache" );
+
+// ---------------------------------------------------------------------------------------------------------------------
+// timings for one benchmark; per-iteration times are summarised, throughput is derived from the median
+struct Result
+{
+    std::string     m_name;
+    uint32_t        m_iterations        = 0;
+    double          m_medianMs          = 0;
+    double          m_meanMs            = 0;
+    double          m_minMs             = 0;
+    double          m_maxMs             = 0;
+    double          m_throughput        = 0;
+    std::string     m_throughputUnit;
+
+    template<class Archive>
+    void serialize( Archive& archive )
+    {
+        archive( cereal::make_nvp( "name",              m_name )
+               , cereal::make_nvp( "iterations",        m_iterations )
+               , cereal::make_nvp( "median_ms",         m_medianMs )
+               , cereal::make_nvp( "mean_ms",           m_meanMs )
+               , cereal::make_nvp( "min_ms",            m_minMs )
+               , cereal::make_nvp( "max_ms",            m_maxMs )
+               , cereal::make_nvp( "throughput",        m_throughput )
+               , cereal::make_nvp( "throughput_unit",   m_throughputUnit )
+        );
+    }
+};
+
+// memory / accuracy side of one stem storage format; the decode cost is recorded as a normal Result alongside
+struct StorageResult
+{
+    std::string     m_format;
+    uint64_t        m_storageBytes      = 0;
+    double          m_bytesPerSample    = 0;
+    double          m_peakErrorDb       = 0;        // worst difference from the float32 decode of the same stems
+
+    template<class Archive>
+    void serialize( Archive& archive )
+    {
+        archive( cereal::make_nvp( "format",            m_format )
+               , cereal::make_nvp( "storage_bytes",     m_storageBytes )
+               , cereal::make_nvp( "bytes_per_sample",  m_bytesPerSample )
+               , cereal::make_nvp( "peak_error_db",     m_peakErrorDb )
+        );
+    }
+};
+
+struct Report
+{
+    uint32_t                        m_seed              = cSeed;
+    uint32_t                        m_targetSampleRate  = cTargetSampleRate;
+    uint32_t                        m_hardwareThreads   = std::thread::hardware_concurrency();
+    std::vector< Result >           m_results;
+    std::vector< StorageResult >    m_stemStorage;
+
+    template<class Archive>
+    void serialize( Archive& archive )
+    {
+        archive( cereal::make_nvp( "seed",              m_seed )
+               , cereal::make_nvp( "target_sample_rate",m_targetSampleRate )
+               , cereal::make_nvp( "hardware_threads",  m_hardwareThreads )
+               , cereal::make_nvp( "results",           m_results )
+               , cereal::make_nvp( "stem_storage",      m_stemStorage )
+        );
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// run (fn) once untimed to warm caches and allocators, then (iterations) more times under the clock.
+// unitsPerIteration / throughputUnit describe how much work one call represents, eg. seconds of audio
+template< typename _Fn >
+Result measure( std::string_view name, const uint32_t iterations, const double unitsPerIteration, std::string_view throughputUnit, _Fn&& fn )
+{
+    fn();
+
+    std::vector< double > timingsMs;
+    timingsMs.reserve( iterations );
+
+    for ( uint32_t iteration = 0; iteration < iterations; iteration++ )
+    {
+        spacetime::Moment iterationTiming;
+        fn();
+        timingsMs.push_back( (double)iterationTiming.delta< std::chrono::nanoseconds >().count() / 1000000.0 );
+    }
+
+    std::sort( timingsMs.begin(), timingsMs.end() );
+
+    Result result;
+    result.m_name           = name;
+    result.m_iterations     = iterations;
+    result.m_medianMs       = timingsMs[ timingsMs.size() / 2 ];
+    result.m_meanMs         = std::accumulate( timingsMs.begin(), timingsMs.end(), 0.0 ) / (double)timingsMs.size();
+    result.m_minMs          = timingsMs.front();
+    result.m_maxMs          = timingsMs.back();
+    result.m_throughput     = ( result.m_medianMs > 0 ) ? ( unitsPerIteration / ( result.m_medianMs / 1000.0 ) ) : 0;
+    result.m_throughputUnit = throughputUnit;
+
+    blog::core( FMTX( "  {:<36} | median {:10.3f} ms | min {:10.3f} ms | max {:10.3f} ms | {:12.2f} {}" ),
+        result.m_name,
+        result.m_medianMs,
+        result.m_minMs,
+        result.m_maxMs,
+        result.m_throughput,
+        result.m_throughputUnit );
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct Benchmarks
+{
+    Benchmarks( Environment& environment )
+        : m_env( environment )
+    {
+    }
+
+    int Run( const fs::path& resultsFile );
+
+protected:
+
+    absl::Status generateStems();
+    absl::Status generateWarehouseArchives( std::vector< fs::path >& archiveFiles );
+
+    absl::Status benchStemFetch();
+    absl::Status benchStemAnalyse();
+    absl::Status benchStemStretch();
+    absl::Status benchStemStorage();
+    absl::Status benchPreviewRender();
+    absl::Status benchQuantise();
+    absl::Status benchWarehouse();
+    absl::Status checkIncrementalJamSlice( endlesss::toolkit::Warehouse& warehouse, const std::vector< endlesss::types::JamCouchID >& otherJamIDs );
+    absl::Status benchWorkScheduler();
+
+
+    Environment&                            m_env;
+    endlesss::types::RiffComplete           m_riffData;
+
+    Report                                  m_report;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// write the 8 stems of the benchmark riff into the stem cache, shaped exactly as if they had been downloaded
+absl::Status Benchmarks::generateStems()
+{
+    math::RNG32 rng( cSeed );
+
+    const endlesss::types::Jam jam( endlesss::types::JamCouchID{ "band" + generateCouchID( rng ).substr( 0, 10 ) }, "Benchmark" );
+
+    std::vector< endlesss::types::Stem > stems( cStemBars.size() );
+    for ( std::size_t stemI = 0; stemI < cStemBars.size(); stemI++ )
+    {
+        endlesss::types::Stem& stem = stems[stemI];
+
+        if ( const auto stemStatus = m_env.generateStem( jam.couchID, rng, cStemBars[stemI], stem ); !stemStatus.ok() )
+            return stemStatus;
+
+        stem.isDrum = ( stemI < 2 );
+        stem.isBass = ( stemI == 2 );
+        stem.isNote = ( stemI > 2 );
+    }
+
+    m_riffData = m_env.generateRiff( jam, rng, stems, cRiffBPS );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// build one jam archive per benchmark jam, to be pulled into a fresh warehouse through the normal import path
+absl::Status Benchmarks::generateWarehouseArchives( std::vector< fs::path >& archiveFiles )
+{
+    namespace archive = endlesss::toolkit::archive;
+
+    math::RNG32 rng( cSeed ^ 0xDA7A );
+
+    std::vector< std::string > userNames;
+    for ( std::size_t userI = 0; userI < cWarehouseUserCount; userI++ )
+        userNames.emplace_back( fmt::format( FMTX( "bench_user_{:02}" ), userI ) );
+
+    for ( std::size_t jamI = 0; jamI < cWarehouseJamCount; jamI++ )
+    {
+        archive::Header header;
+        header.m_exportTimeUnix     = 1700000000;
+        header.m_exportOuroVersion  = "bench";
+        header.m_jamName            = fmt::format( FMTX( "Benchmark Jam {}" ), jamI );
+        header.m_jamCouchID         = endlesss::types::JamCouchID{ fmt::format( FMTX( "band{:08x}" ), rng.genUInt32() ) };
+
+        const fs::path archiveFile = m_env.m_workingRoot / fmt::format( FMTX( "{}.{}" ), header.m_jamCouchID, archive::cFileExtension );
+
+        archive::Writer writer( nullptr );
+        if ( const auto openStatus = writer.open( archiveFile, header ); !openStatus.ok() )
+            return openStatus;
+
+        std::vector< endlesss::types::StemCouchID > stemPool;
+        stemPool.reserve( cWarehouseStemsPerJam );
+
+        for ( std::size_t stemI = 0; stemI < cWarehouseStemsPerJam; stemI++ )
+        {
+            endlesss::types::Stem stem;
+            stem.couchID            = endlesss::types::StemCouchID{ generateCouchID( rng ) };
+            stem.jamCouchID         = header.m_jamCouchID;
+            stem.fileEndpoint       = "localhost";
+            stem.fileKey            = fmt::format( FMTX( "attachments/oggAudio/{}" ), stem.couchID );
+            stem.fileMIME           = "audio/ogg";
+            stem.fileLengthBytes    = 100000 + (uint32_t)rng.genInt32( 0, 900000 );
+            stem.sampleRate         = cStemSourceSampleRate;
+            stem.creationTimeUnix   = 1600000000 + ( stemI * 60 );
+            stem.user               = userNames[ rng.genInt32( 0, (int32_t)cWarehouseUserCount - 1 ) ];
+            stem.colour             = "ff8c00";
+            stem.BPS                = cRiffBPS;
+            stem.BPMrnd             = cRiffBPS * 60.0f;
+            stem.barLength          = cRiffBarLength;
+            stem.length16s          = 128.0f;
+            stem.isNote             = true;
+
+            stemPool.push_back( stem.couchID );
+
+            if ( const auto appendStatus = writer.appendStem( stem ); !appendStatus.ok() )
+                return appendStatus;
+        }
+
+        for ( std::size_t riffI = 0; riffI < cWarehouseRiffsPerJam; riffI++ )
+        {
+            endlesss::types::Riff riff;
+            riff.couchID            = endlesss::types::RiffCouchID{ generateCouchID( rng ) };
+            riff.jamCouchID         = header.m_jamCouchID;
+            riff.user               = userNames[ rng.genInt32( 0, (int32_t)cWarehouseUserCount - 1 ) ];
+            riff.creationTimeUnix   = 1600000000 + ( riffI * 37 );
+            riff.root               = (uint32_t)rng.genInt32( 0, 11 );
+            riff.scale              = (uint32_t)rng.genInt32( 0, 5 );
+            riff.BPS                = cRiffBPS;
+            riff.BPMrnd             = cRiffBPS * 60.0f;
+            riff.barLength          = cRiffBarLength;
+            riff.appVersion         = 1;
+            riff.magnitude          = 1.0f;
+
+            for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+            {
+                riff.stemsOn[stemI] = ( rng.genFloat() < 0.7f );
+                riff.stems[stemI]   = riff.stemsOn[stemI] ? stemPool[ rng.genInt32( 0, (int32_t)cWarehouseStemsPerJam - 1 ) ] : endlesss::types::StemCouchID{};
+                riff.gains[stemI]   = riff.stemsOn[stemI] ? rng.genFloat() : 0.0f;
+            }
+
+            if ( const auto appendStatus = writer.appendRiff( riff ); !appendStatus.ok() )
+                return appendStatus;
+        }
+
+        if ( const auto finishStatus = writer.finish(); !finishStatus.ok() )
+            return finishStatus;
+
+        archiveFiles.push_back( archiveFile );
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Benchmarks::benchStemFetch()
+{
+    double stemSecondsTotal = 0;
+    for ( const auto stemBars : cStemBars )
+        stemSecondsTotal += cSecondsPerBar * (double)stemBars;
+
+    // decode straight through at the source rate, then again with r8brain resampling up to the playback rate
+    for ( const uint32_t targetSampleRate : { cStemSourceSampleRate, cTargetSampleRate } )
+    {
+        bool anyFailed = false;
+
+        m_report.m_results.emplace_back( measure(
+            ( targetSampleRate == cStemSourceSampleRate ) ? "stem.fetch.flac" : "stem.fetch.flac.resample",
+            8,
+            stemSecondsTotal,
+            "audio-sec/s",
+            [&]()
+            {
+                for ( const auto& stemData : m_riffData.stems )
+                {
+                    endlesss::live::Stem stem( stemData, targetSampleRate );
+                    stem.fetch( *m_env.m_networkConfiguration, m_env.m_stemCache.getCachePathForStem( stemData ) );
+
+                    anyFailed |= ( stem.m_state != endlesss::live::Stem::State::Complete );
+                }
+            }) );
+
+        if ( anyFailed )
+            return absl::InternalError( "stem fetch failed during benchmark" );
+    }
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Benchmarks::benchStemAnalyse()
+{
+    const auto stemProcessing = endlesss::live::Stem::createStemProcessing( cTargetSampleRate );
+
+    std::vector< std::unique_ptr< endlesss::live::Stem > > stems;
+    double stemSecondsTotal = 0;
+
+    for ( const auto& stemData : m_riffData.stems )
+    {
+        auto& stem = stems.emplace_back( std::make_unique< endlesss::live::Stem >( stemData, cTargetSampleRate ) );
+        stem->fetch( *m_env.m_networkConfiguration, m_env.m_stemCache.getCachePathForStem( stemData ) );
+
+        if ( stem->m_state != endlesss::live::Stem::State::Complete )
+            return absl::InternalError( "stem fetch failed while preparing analysis benchmark" );
+
+        stemSecondsTotal += (double)stem->m_sampleCount / (double)cTargetSampleRate;
+    }
+
+    bool anyFailed = false;
+
+    m_report.m_results.emplace_back( measure( "stem.analyse", 8, stemSecondsTotal, "audio-sec/s", [&]()
+        {
+            for ( const auto& stem : stems )
+            {
+                endlesss::live::StemAnalysisData analysisResult;
+                anyFailed |= !stem->analyse( *stemProcessing, analysisResult );
+            }
+        }) );
+
+    if ( anyFailed )
+        return absl::InternalError( "stem analysis failed during benchmark" );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// re-time every stem of the benchmark riff at each time-stretch preset, as Riff::fetch would for a riff played back
+// at a different tempo to the one its stems were recorded at
+absl::Status Benchmarks::benchStemStretch()
+{
+    static constexpr double cTimeScale = 1.125;     // eg. stems recorded at 120bpm in a 135bpm riff
+
+    static constexpr std::array< std::pair< dsp::TimeStretch::Preset, const char* >, 3 > cPresets{ {
+        { dsp::TimeStretch::Preset::Fast,       "stem.stretch.fast"     },
+        { dsp::TimeStretch::Preset::Balanced,   "stem.stretch.balanced" },
+        { dsp::TimeStretch::Preset::High,       "stem.stretch.high"     },
+    } };
+
+    std::vector< std::unique_ptr< endlesss::live::Stem > > stems;
+    double stemSecondsTotal = 0;
+
+    for ( const auto& stemData : m_riffData.stems )
+    {
+        auto& stem = stems.emplace_back( std::make_unique< endlesss::live::Stem >( stemData, cTargetSampleRate ) );
+        stem->fetch( *m_env.m_networkConfiguration, m_env.m_stemCache.getCachePathForStem( stemData ) );
+
+        if ( stem->m_state != endlesss::live::Stem::State::Complete )
+            return absl::InternalError( "stem fetch failed while preparing stretch benchmark" );
+
+        stemSecondsTotal += (double)stem->m_sampleCount / (double)cTargetSampleRate;
+    }
+
+    std::vector< float > outputLeft;
+    std::vector< float > outputRight;
+
+    for ( const auto& [ preset, resultName ] : cPresets )
+    {
+        const dsp::TimeStretch timeStretch( preset, cTargetSampleRate );
+
+        m_report.m_results.emplace_back( measure( resultName, 4, stemSecondsTotal, "audio-sec/s", [&]()
+            {
+                for ( const auto& stem : stems )
+                {
+                    const int32_t outputLength = dsp::TimeStretch::getOutputLength( stem->m_sampleCount, cTimeScale );
+                    outputLeft.resize( outputLength );
+                    outputRight.resize( outputLength );
+
+                    timeStretch.renderLoop(
+                        { stem->m_channel[0], stem->m_channel[1] },
+                        stem->m_sampleCount,
+                        cTimeScale,
+                        { outputLeft.data(), outputRight.data() },
+                        outputLength,
+                        nullptr );
+                }
+            }) );
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// fetch the benchmark riff's stems into each in-memory storage format, then read them back in mixer-sized blocks as the
+// mixers do; the memory used and the error against the float32 decode go into the report next to the read timings
+absl::Status Benchmarks::benchStemStorage()
+{
+    using SampleStorage = endlesss::live::Stem::SampleStorage;
+    using StemList      = std::vector< std::unique_ptr< endlesss::live::Stem > >;
+
+    static constexpr std::array< std::pair< SampleStorage, const char* >, 3 > cFormats{ {
+        { SampleStorage::Float32,       "float32"   },
+        { SampleStorage::Int16,         "int16"     },
+        { SampleStorage::BlockFloat8,   "bfp8"      },
+    } };
+
+    const auto fetchStems = [this]( const SampleStorage sampleStorage, StemList& stems ) -> absl::Status
+    {
+        for ( const auto& stemData : m_riffData.stems )
+        {
+            auto& stem = stems.emplace_back( std::make_unique< endlesss::live::Stem >( stemData, cTargetSampleRate, sampleStorage ) );
+            stem->fetch( *m_env.m_networkConfiguration, m_env.m_stemCache.getCachePathForStem( stemData ) );
+
+            if ( stem->m_state != endlesss::live::Stem::State::Complete )
+                return absl::InternalError( "stem fetch failed while preparing storage benchmark" );
+        }
+        return absl::OkStatus();
+    };
+
+    StemList referenceStems;
+    if ( const auto fetchStatus = fetchStems( SampleStorage::Float32, referenceStems ); !fetchStatus.ok() )
+        return fetchStatus;
+
+    double stemSecondsTotal = 0;
+    for ( const auto& stem : referenceStems )
+        stemSecondsTotal += (double)stem->m_sampleCount / (double)cTargetSampleRate;
+
+    std::vector< float > decoded( cMixBlockSize );
+    std::vector< float > reference( cMixBlockSize );
+
+    for ( const auto& [ sampleStorage, formatName ] : cFormats )
+    {
+        StemList stems;
+        if ( const auto fetchStatus = fetchStems( sampleStorage, stems ); !fetchStatus.ok() )
+            return fetchStatus;
+
+        StorageResult storageResult;
+        storageResult.m_format = formatName;
+
+        double  errorPeak       = 0;
+        double  channelSamples  = 0;
+
+        for ( std::size_t stemI = 0; stemI < stems.size(); stemI++ )
+        {
+            const auto& stem = stems[stemI];
+
+            if ( stem->getSampleStorage() != sampleStorage )
+                return absl::InternalError( fmt::format( FMTX( "stem did not end up in {} storage" ), formatName ) );
+
+            storageResult.m_storageBytes += stem->getSampleStorageBytes();
+            channelSamples += (double)stem->m_sampleCount * 2.0;
+
+            for ( int32_t channel = 0; channel < 2; channel++ )
+            {
+                for ( int32_t blockStart = 0; blockStart < stem->m_sampleCount; blockStart += (int32_t)cMixBlockSize )
+                {
+                    const int32_t blockLength = std::min( (int32_t)cMixBlockSize, stem->m_sampleCount - blockStart );
+
+                    stem->readSamples( channel, blockStart, blockLength, decoded.data() );
+                    referenceStems[stemI]->readSamples( channel, blockStart, blockLength, reference.data() );
+
+                    for ( int32_t s = 0; s < blockLength; s++ )
+                        errorPeak = std::max( errorPeak, (double)std::abs( decoded[s] - reference[s] ) );
+                }
+            }
+        }
+
+        storageResult.m_bytesPerSample  = ( channelSamples > 0 ) ? ( (double)storageResult.m_storageBytes / channelSamples ) : 0;
+        storageResult.m_peakErrorDb     = ( errorPeak > 0 ) ? ( 20.0 * std::log10( errorPeak ) ) : -999.0;
+
+        // keeps the read loop honest under optimisation
+        volatile float decodeSink = 0;
+
+        m_report.m_results.emplace_back( measure( fmt::format( FMTX( "stem.storage.{}.read" ), formatName ), 8, stemSecondsTotal, "audio-sec/s", [&]()
+            {
+                for ( const auto& stem : stems )
+                {
+                    for ( int32_t channel = 0; channel < 2; channel++ )
+                    {
+                        for ( int32_t blockStart = 0; blockStart < stem->m_sampleCount; blockStart += (int32_t)cMixBlockSize )
+                        {
+                            const int32_t blockLength = std::min( (int32_t)cMixBlockSize, stem->m_sampleCount - blockStart );
+                            stem->readSamples( channel, blockStart, blockLength, decoded.data() );
+
+                            decodeSink = decoded[blockLength - 1];
+                        }
+                    }
+                }
+            }) );
+
+        blog::core( FMTX( "  {:<36} | {:5.3f} bytes/sample | peak error {:7.1f} dB | {}" ),
+            formatName,
+            storageResult.m_bytesPerSample,
+            storageResult.m_peakErrorDb,
+            base::humaniseByteSize( "", storageResult.m_storageBytes ) );
+
+        m_report.m_stemStorage.emplace_back( std::move( storageResult ) );
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// drive the Preview mixer as the audio callback would, in device-sized blocks; steady-state playback of a single riff
+// spends effectively all its time in renderCurrentRiff()
+absl::Status Benchmarks::benchPreviewRender()
+{
+    auto riffLoad = m_env.loadRiff( m_riffData );
+    if ( !riffLoad.ok() )
+        return riffLoad.status();
+
+    endlesss::live::RiffPtr riffPtr = riffLoad.value();
+
+    mix::Preview preview( cMixBlockSize, cTargetSampleRate, std::chrono::microseconds( 0 ), *m_env.m_appEventBusClient );
+
+    app::module::Audio::OutputBuffer outputBuffer( cMixBlockSize );
+    app::module::Audio::OutputSignal outputSignal;
+
+    if ( preview.enqueueRiff( riffPtr ) == base::OperationID::invalid() )
+        return absl::InternalError( "mixer refused benchmark riff" );
+
+    const uint32_t blocksPerIteration = ( cMixSecondsPerIteration * cTargetSampleRate ) / cMixBlockSize;
+    uint64_t samplePosition = 0;
+
+    m_report.m_results.emplace_back( measure( "preview.render", 8, (double)cMixSecondsPerIteration, "x realtime", [&]()
+        {
+            for ( uint32_t block = 0; block < blocksPerIteration; block++ )
+            {
+                preview.update( outputBuffer, outputSignal, cMixBlockSize, samplePosition );
+                samplePosition += cMixBlockSize;
+            }
+        }) );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Benchmarks::benchQuantise()
+{
+    static constexpr uint32_t cQuantisePasses = 64;
+
+    base::IQ16Buffer quantise16( cQuantiseSampleCount );
+    base::IQ24Buffer quantise24( cQuantiseSampleCount );
+
+    // deliberately runs a little hot so the clamping path is exercised
+    math::RNG32 rng( cSeed );
+    for ( uint32_t sampleI = 0; sampleI < cQuantiseSampleCount * 2; sampleI++ )
+    {
+        const float value = rng.genFloat( -1.1f, 1.1f );
+        quantise16.m_interleavedFloat[sampleI] = value;
+        quantise24.m_interleavedFloat[sampleI] = value;
+    }
+    quantise16.m_currentSamples = cQuantiseSampleCount;
+    quantise24.m_currentSamples = cQuantiseSampleCount;
+
+    const double megaSamplesPerIteration = (double)( cQuantiseSampleCount * 2 * cQuantisePasses ) / 1000000.0;
+
+    m_report.m_results.emplace_back( measure( "iquant.quantise.16", 16, megaSamplesPerIteration, "Msamples/s", [&]()
+        {
+            for ( uint32_t pass = 0; pass < cQuantisePasses; pass++ )
+                quantise16.quantise();
+        }) );
+    m_report.m_results.emplace_back( measure( "iquant.quantise.24", 16, megaSamplesPerIteration, "Msamples/s", [&]()
+        {
+            for ( uint32_t pass = 0; pass < cQuantisePasses; pass++ )
+                quantise24.quantise();
+        }) );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Benchmarks::benchWarehouse()
+{
+    using Warehouse = endlesss::toolkit::Warehouse;
+
+    std::vector< fs::path > archiveFiles;
+    if ( const auto archiveStatus = generateWarehouseArchives( archiveFiles ); !archiveStatus.ok() )
+        return archiveStatus;
+
+    std::vector< endlesss::types::JamCouchID > jamIDs;
+    for ( const auto& archiveFile : archiveFiles )
+    {
+        const auto archiveHeader = endlesss::toolkit::archive::readHeader( archiveFile );
+        if ( !archiveHeader.ok() )
+            return archiveHeader.status();
+
+        jamIDs.push_back( archiveHeader.value().m_jamCouchID );
+    }
+
+    auto warehouseResult = m_env.createWarehouse();
+    if ( !warehouseResult.ok() )
+        return warehouseResult.status();
+
+    Warehouse& warehouse = *warehouseResult.value();
+
+    const auto fetchSlice = [&warehouse]( const endlesss::types::JamCouchID& jamID ) -> std::size_t
+    {
+        const auto resultSlice = Environment::fetchJamSlice( warehouse, jamID );
+        return resultSlice ? resultSlice->size() : 0;
+    };
+
+    {
+        spacetime::Moment importTiming;
+
+        for ( const auto& archiveFile : archiveFiles )
+            std::ignore = warehouse.requestJamDataImport( archiveFile );
+
+        if ( fetchSlice( jamIDs.back() ) != cWarehouseRiffsPerJam )
+            return absl::InternalError( "warehouse import did not produce the expected riffs" );
+
+        blog::core( FMTX( "  warehouse populated with {} jams, {} riffs in {}" ),
+            jamIDs.size(),
+            jamIDs.size() * cWarehouseRiffsPerJam,
+            importTiming.delta< std::chrono::milliseconds >() );
+    }
+
+    // cycle through more jams than the slice cache holds so every request does the full query
+    std::size_t sliceJamIndex = 0;
+    bool sliceMismatch = false;
+    m_report.m_results.emplace_back( measure( "warehouse.jam_slice", 12, (double)cWarehouseRiffsPerJam, "riffs/s", [&]()
+        {
+            sliceMismatch |= ( fetchSlice( jamIDs[ sliceJamIndex++ % jamIDs.size() ] ) != cWarehouseRiffsPerJam );
+        }) );
+
+    if ( sliceMismatch )
+        return absl::InternalError( "jam slice returned unexpected riff count" );
+
+    if ( const auto incrementalStatus = checkIncrementalJamSlice( warehouse, jamIDs ); !incrementalStatus.ok() )
+        return incrementalStatus;
+
+
+    const endlesss::types::JamCouchID& tagJamID = jamIDs.front();
+
+    // tag a deterministic subset of the first jam's riffs, then time the lookups LORE makes against them
+    std::vector< endlesss::types::RiffTag > riffTags;
+    std::vector< endlesss::types::RiffCouchID > riffLookups;
+    {
+        const Warehouse::JamSlicePtr tagSlice = Environment::fetchJamSlice( warehouse, tagJamID );
+        if ( tagSlice == nullptr || tagSlice->size() < cWarehouseTagsPerBatch )
+            return absl::InternalError( "unable to fetch jam slice for tag benchmark" );
+
+        math::RNG32 rng( cSeed ^ 0x7A65 );
+        for ( std::size_t tagI = 0; tagI < cWarehouseTagsPerBatch; tagI++ )
+        {
+            const std::size_t riffIndex = (std::size_t)rng.genInt32( 0, (int32_t)tagSlice->size() - 1 );
+            riffTags.emplace_back(
+                tagJamID,
+                tagSlice->m_ids[riffIndex],
+                (int32_t)tagI,
+                1600000000 + riffIndex,
+                1,
+                "" );
+        }
+        for ( std::size_t lookupI = 0; lookupI < cWarehouseTagLookups; lookupI++ )
+            riffLookups.push_back( tagSlice->m_ids[ (std::size_t)rng.genInt32( 0, (int32_t)tagSlice->size() - 1 ) ] );
+    }
+
+    m_report.m_results.emplace_back( measure( "warehouse.tags.batch_update", 8, (double)riffTags.size(), "tags/s", [&]()
+        {
+            warehouse.batchUpdateTags( riffTags );
+        }) );
+
+    std::vector< endlesss::types::RiffTag > fetchedTags;
+    m_report.m_results.emplace_back( measure( "warehouse.tags.fetch_for_jam", 32, 1.0, "queries/s", [&]()
+        {
+            fetchedTags.clear();
+            std::ignore = warehouse.fetchTagsForJam( tagJamID, fetchedTags );
+        }) );
+
+    std::size_t taggedCount = 0;
+    m_report.m_results.emplace_back( measure( "warehouse.tags.is_riff_tagged", 8, (double)riffLookups.size(), "queries/s", [&]()
+        {
+            taggedCount = 0;
+            for ( const auto& riffID : riffLookups )
+                taggedCount += warehouse.isRiffTagged( riffID ) ? 1 : 0;
+        }) );
+
+    if ( fetchedTags.empty() || taggedCount == 0 )
+        return absl::InternalError( "tag queries returned no results" );
+
+    warehouse.clearAllCallbacks();
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// import a jam in two halves, so the slice for the first half has riffs waiting on stems that only arrive with the
+// second; the incremental update that follows must land on exactly what a full rebuild of the jam produces. then the
+// earliest riff is rewritten in place, which leaves the row count alone, and the next update has to notice from the
+// projection revision alone. release builds never run the validation in JamSliceTask, so this is the only place the
+// two paths get compared outside debug
+absl::Status Benchmarks::checkIncrementalJamSlice( endlesss::toolkit::Warehouse& warehouse, const std::vector< endlesss::types::JamCouchID >& otherJamIDs )
+{
+    namespace archive = endlesss::toolkit::archive;
+    using Warehouse = endlesss::toolkit::Warehouse;
+
+    static constexpr std::size_t cStemsPerHalf      = 300;
+    static constexpr std::size_t cRiffsPerHalf      = 1200;
+    static constexpr std::size_t cResolvedRiffs     = 700;     // riffs in the first half that only use first-half stems
+
+    math::RNG32 rng( cSeed ^ 0x1C5E );
+
+    archive::Header header;
+    header.m_exportTimeUnix     = 1700000000;
+    header.m_exportOuroVersion  = "bench";
+    header.m_jamName            = "Benchmark Incremental Jam";
+    header.m_jamCouchID         = endlesss::types::JamCouchID{ fmt::format( FMTX( "band{:08x}" ), rng.genUInt32() ) };
+
+    std::vector< endlesss::types::StemCouchID > stemPool;
+    for ( std::size_t stemI = 0; stemI < cStemsPerHalf * 2; stemI++ )
+        stemPool.emplace_back( generateCouchID( rng ) );
+
+    std::size_t riffTimeIndex = 0;
+
+    endlesss::types::Riff earliestRiff;
+
+    // half 0 carries the first pool of stems, half 1 the rest; riffs in half 0 past (cResolvedRiffs) can pick from
+    // either pool, leaving some of them unresolved until half 1 is imported
+    const auto writeHalf = [&]( const std::size_t half, fs::path& archiveFile ) -> absl::Status
+    {
+        archiveFile = m_env.m_workingRoot / fmt::format( FMTX( "{}.{}.{}" ), header.m_jamCouchID, half, archive::cFileExtension );
+
+        archive::Writer writer( nullptr );
+        if ( const auto openStatus = writer.open( archiveFile, header ); !openStatus.ok() )
+            return openStatus;
+
+        for ( std::size_t stemI = half * cStemsPerHalf; stemI < ( half + 1 ) * cStemsPerHalf; stemI++ )
+        {
+            endlesss::types::Stem stem;
+            stem.couchID            = stemPool[stemI];
+            stem.jamCouchID         = header.m_jamCouchID;
+            stem.fileEndpoint       = "localhost";
+            stem.fileKey            = fmt::format( FMTX( "attachments/oggAudio/{}" ), stem.couchID );
+            stem.fileMIME           = "audio/ogg";
+            stem.fileLengthBytes    = 100000 + (uint32_t)rng.genInt32( 0, 900000 );
+            stem.sampleRate         = cStemSourceSampleRate;
+            stem.creationTimeUnix   = 1600000000 + ( stemI * 60 );
+            stem.user               = fmt::format( FMTX( "bench_user_{:02}" ), rng.genInt32( 0, (int32_t)cWarehouseUserCount - 1 ) );
+            stem.colour             = "ff8c00";
+            stem.BPS                = cRiffBPS;
+            stem.BPMrnd             = cRiffBPS * 60.0f;
+            stem.barLength          = cRiffBarLength;
+            stem.length16s          = 128.0f;
+            stem.isNote             = true;
+
+            if ( const auto appendStatus = writer.appendStem( stem ); !appendStatus.ok() )
+                return appendStatus;
+        }
+
+        for ( std::size_t riffI = 0; riffI < cRiffsPerHalf; riffI++ )
+        {
+            const bool firstPoolOnly = ( half == 0 && riffI < cResolvedRiffs );
+            const int32_t stemRange  = (int32_t)( firstPoolOnly ? cStemsPerHalf : stemPool.size() ) - 1;
+
+            endlesss::types::Riff riff;
+            riff.couchID            = endlesss::types::RiffCouchID{ generateCouchID( rng ) };
+            riff.jamCouchID         = header.m_jamCouchID;
+            riff.user               = fmt::format( FMTX( "bench_user_{:02}" ), rng.genInt32( 0, (int32_t)cWarehouseUserCount - 1 ) );
+            riff.creationTimeUnix   = 1600000000 + ( riffTimeIndex++ * 37 );
+            riff.root               = (uint32_t)rng.genInt32( 0, 11 );
+            riff.scale              = (uint32_t)rng.genInt32( 0, 5 );
+            riff.BPS                = cRiffBPS;
+            riff.BPMrnd             = cRiffBPS * 60.0f;
+            riff.barLength          = cRiffBarLength;
+            riff.appVersion         = 1;
+            riff.magnitude          = 1.0f;
+
+            for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+            {
+                riff.stemsOn[stemI] = ( rng.genFloat() < 0.7f );
+                riff.stems[stemI]   = riff.stemsOn[stemI] ? stemPool[ rng.genInt32( 0, stemRange ) ] : endlesss::types::StemCouchID{};
+                riff.gains[stemI]   = riff.stemsOn[stemI] ? rng.genFloat() : 0.0f;
+            }
+
+            if ( half == 0 && riffI == 0 )
+                earliestRiff = riff;
+
+            if ( const auto appendStatus = writer.appendRiff( riff ); !appendStatus.ok() )
+                return appendStatus;
+        }
+
+        return writer.finish();
+    };
+
+    const endlesss::types::JamCouchID& jamID = header.m_jamCouchID;
+
+    // JamSliceRequests capture the change index when they are queued, so after an import we block on a slice for a
+    // different jam to be sure the import has run before asking for the one we care about
+    const auto flushImports = [&]()
+    {
+        std::ignore = Environment::fetchJamSlice( warehouse, otherJamIDs.front() );
+    };
+
+    fs::path firstHalfFile, secondHalfFile;
+    if ( const auto writeStatus = writeHalf( 0, firstHalfFile ); !writeStatus.ok() )
+        return writeStatus;
+    if ( const auto writeStatus = writeHalf( 1, secondHalfFile ); !writeStatus.ok() )
+        return writeStatus;
+
+    std::ignore = warehouse.requestJamDataImport( firstHalfFile );
+    flushImports();
+
+    // held across the second import, forcing the incremental update down its copy-on-write path
+    const Warehouse::JamSlicePtr firstHalfSlice = Environment::fetchJamSlice( warehouse, jamID );
+    if ( firstHalfSlice == nullptr || firstHalfSlice->size() != cRiffsPerHalf )
+        return absl::InternalError( "incremental slice check; first half import did not produce the expected riffs" );
+
+    std::ignore = warehouse.requestJamDataImport( secondHalfFile );
+    flushImports();
+
+    const Warehouse::JamSlicePtr incrementalSlice = Environment::fetchJamSlice( warehouse, jamID );
+    if ( incrementalSlice == nullptr || incrementalSlice->size() != cRiffsPerHalf * 2 )
+        return absl::InternalError( "incremental slice check; updated slice has the wrong riff count" );
+    if ( incrementalSlice == firstHalfSlice || firstHalfSlice->size() != cRiffsPerHalf )
+        return absl::InternalError( "incremental slice check; slice held by a client was modified in place" );
+
+    // re-import the earliest riff with a different root; the jam keeps its riff count, so only the projection revision
+    // tells the next update that a row it already holds has changed
+    {
+        earliestRiff.root = ( earliestRiff.root + 1 ) % 12;
+
+        const fs::path rewriteFile = m_env.m_workingRoot / fmt::format( FMTX( "{}.rewrite.{}" ), header.m_jamCouchID, archive::cFileExtension );
+
+        archive::Writer writer( nullptr );
+        if ( const auto openStatus = writer.open( rewriteFile, header ); !openStatus.ok() )
+            return openStatus;
+        if ( const auto appendStatus = writer.appendRiff( earliestRiff ); !appendStatus.ok() )
+            return appendStatus;
+        if ( const auto finishStatus = writer.finish(); !finishStatus.ok() )
+            return finishStatus;
+
+        std::ignore = warehouse.requestJamDataImport( rewriteFile );
+        flushImports();
+    }
+
+    const Warehouse::JamSlicePtr rewrittenSlice = Environment::fetchJamSlice( warehouse, jamID );
+    if ( rewrittenSlice == nullptr || rewrittenSlice->size() != cRiffsPerHalf * 2 )
+        return absl::InternalError( "incremental slice check; rewritten slice has the wrong riff count" );
+    if ( rewrittenSlice->m_roots.front() != earliestRiff.root )
+        return absl::InternalError( "incremental slice check; riff rewritten without changing the riff count was missed" );
+
+    // push the jam out of the slice cache so the next request has to rebuild it from scratch
+    for ( std::size_t evictI = 0; evictI < Warehouse::cJamSliceCacheSize; evictI++ )
+        std::ignore = Environment::fetchJamSlice( warehouse, otherJamIDs[ evictI % otherJamIDs.size() ] );
+
+    const Warehouse::JamSlicePtr rebuiltSlice = Environment::fetchJamSlice( warehouse, jamID );
+    if ( rebuiltSlice == nullptr || rebuiltSlice == rewrittenSlice )
+        return absl::InternalError( "incremental slice check; jam was not evicted from the slice cache" );
+
+    if ( !rebuiltSlice->matches( *rewrittenSlice ) )
+        return absl::InternalError( "incremental slice check; incremental update does not match a full rebuild" );
+
+    blog::core( FMTX( "  incremental jam slice matches full rebuild ({} riffs)" ), rebuiltSlice->size() );
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// how long an interactive riff load waits to start while the background lanes are flooded with blocking work, as they
+// are during a jam sync with a precache running; anything much beyond the job itself means the reserved slot isn't
+absl::Status Benchmarks::benchWorkScheduler()
+{
+    using Lane = base::WorkScheduler::Lane;
+
+    static constexpr uint32_t                   cBackgroundJobsPerLane  = 64;
+    static constexpr std::chrono::milliseconds  cBackgroundJobTime{ 4 };    // stand-in for a network or disk round-trip
+    static constexpr uint32_t                   cInteractiveLoads       = 16;
+
+    // a private scheduler, sized like the app's, so the flood can't disturb the environment
+    base::WorkScheduler workScheduler( m_env.m_workScheduler.getSlotCount() );
+
+    std::atomic_uint32_t interactiveLoads = 0;
+
+    m_report.m_results.emplace_back( measure( "scheduler.interactive.loaded", 8, (double)cInteractiveLoads, "loads/s", [&]()
+        {
+            base::WorkScheduler::CancellationToken background;
+            for ( uint32_t jobI = 0; jobI < cBackgroundJobsPerLane; jobI++ )
+            {
+                workScheduler.submit( Lane::Sync,     [] { std::this_thread::sleep_for( cBackgroundJobTime ); }, background );
+                workScheduler.submit( Lane::Prefetch, [] { std::this_thread::sleep_for( cBackgroundJobTime ); }, background );
+            }
+
+            // loads go one at a time, as a user clicking through riffs would make them
+            for ( uint32_t loadI = 0; loadI < cInteractiveLoads; loadI++ )
+            {
+                base::WorkScheduler::CancellationToken interactive;
+                workScheduler.submit( Lane::Interactive, [&] { interactiveLoads++; }, interactive );
+                interactive.waitForWork();
+            }
+
+            background.cancel();
+            background.waitForWork();
+        }) );
+
+    const auto interactiveMetrics = workScheduler.getLaneMetrics( Lane::Interactive );
+    workScheduler.logStatistics();
+
+    if ( interactiveLoads != interactiveMetrics.m_completed ||
+         interactiveMetrics.m_cancelled != 0 )
+    {
+        return absl::InternalError( "work scheduler lost interactive jobs" );
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int Benchmarks::Run( const fs::path& resultsFile )
+{
+    const auto checkStep = []( std::string_view stepName, const absl::Status& status )
+    {
+        if ( !status.ok() )
+            blog::error::core( FMTX( "benchmark step [{}] failed; {}" ), stepName, status.ToString() );
+
+        return status.ok();
+    };
+
+    blog::core( FMTX( "OUROVEON benchmarks | seed {:#x} | {} Hz | {} hardware threads" ), cSeed, cTargetSampleRate, m_report.m_hardwareThreads );
+
+    if ( !checkStep( "environment", m_env.initialise( "benchmark" ) ) ||
+         !checkStep( "stem generation", generateStems() ) )
+    {
+        return 1;
+    }
+
+    bool allPassed = true;
+    allPassed &= checkStep( "stem fetch",       benchStemFetch() );
+    allPassed &= checkStep( "stem analyse",     benchStemAnalyse() );
+    allPassed &= checkStep( "stem stretch",     benchStemStretch() );
+    allPassed &= checkStep( "stem storage",     benchStemStorage() );
+    allPassed &= checkStep( "preview render",   benchPreviewRender() );
+    allPassed &= checkStep( "quantise",         benchQuantise() );
+    allPassed &= checkStep( "warehouse",        benchWarehouse() );
+    allPassed &= checkStep( "work scheduler",   benchWorkScheduler() );
+
+    m_env.m_taskExecutor.wait_for_all();
+
+    try
+    {
+        std::ofstream resultsStream( resultsFile );
+        cereal::JSONOutputArchive archive( resultsStream );
+
+        archive( cereal::make_nvp( "benchmark", m_report ) );
+    }
+    catch ( cereal::Exception& cEx )
+    {
+        blog::error::core( FMTX( "unable to write results to [{}]; {}" ), resultsFile.string(), cEx.what() );
+        return 1;
+    }
+    blog::core( FMTX( "results written to [{}]" ), resultsFile.string() );
+
+    return allPassed ? 0 : 1;
+}
+
+} // namespace bench
+
+// ---------------------------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    bench::Environment environment;
+
+    if ( argc > 1 && std::string_view( argv[1] ) == "--mixcheck" )
+    {
+        if ( argc < 3 )
+        {
+            blog::error::core( "usage : bench --mixcheck <golden directory> [--update] [--tolerance <value>]" );
+            return 1;
+        }
+
+        bench::MixCheckOptions mixCheckOptions;
+        mixCheckOptions.m_goldenDirectory = fs::path( argv[2] );
+
+        for ( int argI = 3; argI < argc; argI++ )
+        {
+            const std::string_view arg( argv[argI] );
+
+            if ( arg == "--update" )
+            {
+                mixCheckOptions.m_updateGoldens = true;
+            }
+            else if ( arg == "--tolerance" && argI + 1 < argc )
+            {
+                mixCheckOptions.m_tolerance = std::strtod( argv[++argI], nullptr );
+            }
+            else
+            {
+                blog::error::core( FMTX( "unknown argument [{}]" ), arg );
+                return 1;
+            }
+        }
+
+        return bench::runMixCheck( environment, mixCheckOptions );
+    }
+    if ( argc > 1 && std::string_view( argv[1] ) == "--selfcheck" )
+    {
+        return bench::runSelfCheck( environment );
+    }
+
+    const fs::path resultsFile = ( argc > 1 ) ? fs::path( argv[1] ) : fs::path( "bench.results.json" );
+
+    bench::Benchmarks benchmarks( environment );
+    return benchmarks.Run( resultsFile );
+}
@@ -0,0 +1,263 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+
+#include "pch.h"
+
+#include "base/operations.h"
+#include "config/data.h"
+#include "filesys/fsutil.h"
+#include "math/rng.h"
+
+#include "endlesss/api.h"
+#include "endlesss/live.stem.h"
+
+#include "mix/common.h"
+#include "mix/stem.amalgam.h"
+
+#include "FLAC++/encoder.h"
+
+#include "bench.env.h"
+
+namespace bench {
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::string generateCouchID( math::RNG32& rng )
+{
+    return fmt::format( FMTX( "{:08x}{:08x}{:08x}{:08x}" ), rng.genUInt32(), rng.genUInt32(), rng.genUInt32(), rng.genUInt32() );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status writeSyntheticFLAC( const fs::path& outputFile, const uint32_t sampleRate, const uint32_t sampleCount, const uint32_t seed )
+{
+    static constexpr uint32_t   cEncodeBlockFrames  = 4096;
+    static constexpr double     cTwoPi              = 2.0 * 3.14159265358979323846;
+
+    FLAC::Encoder::File encoder;
+
+    bool flacConfig = true;
+    flacConfig &= encoder.set_channels( 2 );
+    flacConfig &= encoder.set_bits_per_sample( 16 );
+    flacConfig &= encoder.set_sample_rate( sampleRate );
+    flacConfig &= encoder.set_compression_level( 5 );
+    flacConfig &= encoder.set_total_samples_estimate( sampleCount );
+    if ( !flacConfig )
+        return absl::InternalError( "FLAC failed to configure encoder" );
+
+    const FLAC__StreamEncoderInitStatus flacInit = encoder.init( outputFile.string() );
+    if ( flacInit != FLAC__STREAM_ENCODER_INIT_STATUS_OK )
+        return absl::InternalError( fmt::format( FMTX( "FLAC unable to begin stream ({}) for file [{}]" ), FLAC__StreamEncoderInitStatusString[flacInit], outputFile.string() ) );
+
+    math::RNG32 rng( seed );
+
+    const double fundamental    = 55.0 * (double)( 1 + ( seed % 5 ) );
+    const double beatLength     = 1.0 / (double)cRiffBPS;
+    const double sampleRateRecp = 1.0 / (double)sampleRate;
+
+    std::vector< FLAC__int32 > interleaved( cEncodeBlockFrames * 2 );
+
+    for ( uint32_t blockStart = 0; blockStart < sampleCount; blockStart += cEncodeBlockFrames )
+    {
+        const uint32_t blockFrames = std::min( cEncodeBlockFrames, sampleCount - blockStart );
+
+        for ( uint32_t frame = 0; frame < blockFrames; frame++ )
+        {
+            const double t     = (double)( blockStart + frame ) * sampleRateRecp;
+            const double decay = std::exp( -6.0 * std::fmod( t, beatLength ) );
+            const double tone  = std::sin( t * cTwoPi * fundamental ) +
+                                 std::sin( t * cTwoPi * fundamental * 1.26 ) * 0.5 +
+                                 std::sin( t * cTwoPi * fundamental * 1.5 ) * 0.25;
+
+            const double signal = tone * 0.35 * decay;
+
+            interleaved[ ( frame * 2 ) + 0 ] = (FLAC__int32)( std::clamp( signal + ( rng.genFloat( -1.0f, 1.0f ) * 0.01 ), -1.0, 1.0 ) * 32767.0 );
+            interleaved[ ( frame * 2 ) + 1 ] = (FLAC__int32)( std::clamp( signal + ( rng.genFloat( -1.0f, 1.0f ) * 0.01 ), -1.0, 1.0 ) * 32767.0 );
+        }
+
+        if ( !encoder.process_interleaved( interleaved.data(), blockFrames ) )
+            return absl::InternalError( fmt::format( FMTX( "FLAC encoding failed for [{}]" ), outputFile.string() ) );
+    }
+
+    if ( !encoder.finish() )
+        return absl::InternalError( fmt::format( FMTX( "FLAC could not finalise [{}]" ), outputFile.string() ) );
+
+    return absl::OkStatus();
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+Environment::Environment()
+    : app::CoreStart()
+    , m_networkConfiguration( std::make_shared<endlesss::api::NetConfiguration>() )
+    , m_taskExecutor( std::clamp( std::thread::hardware_concurrency(), 2U, OURO_THREAD_LIMIT ) )
+    , m_workScheduler( std::clamp( std::thread::hardware_concurrency(), 4U, 8U ) )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Environment::~Environment()
+{
+    m_taskExecutor.wait_for_all();
+    m_appEventBusClient = std::nullopt;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Environment::initialise( std::string_view scratchName )
+{
+    // always start from an empty scratch directory so nothing cached from a previous run skews the results
+    m_workingRoot = fs::temp_directory_path() / "ouroveon-bench" / scratchName;
+
+    std::error_code removeError;
+    fs::remove_all( m_workingRoot, removeError );
+
+    if ( const auto rootStatus = filesys::ensureDirectoryExists( m_workingRoot ); !rootStatus.ok() )
+        return rootStatus;
+
+    // event bus for the systems under test; nothing listens, but they expect their events to be registered
+    m_appEventBus       = std::make_shared<base::EventBus>( m_taskExecutor );
+    m_appEventBusClient = base::EventBusClient( m_appEventBus );
+
+    APP_EVENT_REGISTER( AddToastNotification );
+    APP_EVENT_REGISTER_SPECIFIC( OperationComplete, 64 * 1024 );
+    APP_EVENT_REGISTER( RiffTagAction );
+    APP_EVENT_REGISTER( MixerRiffChange );
+    APP_EVENT_REGISTER( StemDataAmalgamGenerated );
+
+    if ( const auto cacheStatus = m_stemCache.initialise( m_workingRoot / "cache", cTargetSampleRate ); !cacheStatus.ok() )
+        return cacheStatus;
+
+    return m_stemCacheCompact.initialise( m_workingRoot / "cache", cTargetSampleRate, endlesss::live::Stem::SampleStorage::BlockFloat8 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Environment::generateStem( const endlesss::types::JamCouchID& jamCID, math::RNG32& rng, const uint32_t bars, endlesss::types::Stem& stem )
+{
+    stem = {};
+    stem.couchID            = endlesss::types::StemCouchID{ generateCouchID( rng ) };
+    stem.jamCouchID         = jamCID;
+    stem.fileEndpoint       = "localhost";
+    stem.fileKey            = fmt::format( FMTX( "attachments/oggAudio/{}" ), stem.couchID );
+    stem.fileMIME           = "audio/flac";
+    stem.sampleRate         = cStemSourceSampleRate;
+    stem.creationTimeUnix   = 1600000000;
+    stem.user               = "bench_user";
+    stem.colour             = "ff8c00";
+    stem.BPS                = cRiffBPS;
+    stem.BPMrnd             = cRiffBPS * 60.0f;
+    stem.barLength          = cRiffBarLength;
+    stem.length16s          = (float)( bars * 16 );
+    stem.isNote             = true;
+
+    const uint32_t sampleCount = (uint32_t)( cSecondsPerBar * (double)bars * (double)cStemSourceSampleRate );
+
+    const fs::path stemCachePath = m_stemCache.getCachePathForStem( stem );
+    if ( const auto dirStatus = filesys::ensureDirectoryExists( stemCachePath ); !dirStatus.ok() )
+        return dirStatus;
+
+    const fs::path stemFile = stemCachePath / stem.couchID.value();
+    if ( const auto writeStatus = writeSyntheticFLAC( stemFile, cStemSourceSampleRate, sampleCount, rng.genUInt32() ); !writeStatus.ok() )
+        return writeStatus;
+
+    // matching the file size means Stem::fetch takes the file straight from the cache
+    stem.fileLengthBytes = (uint32_t)fs::file_size( stemFile );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+endlesss::types::RiffComplete Environment::generateRiff(
+    const endlesss::types::Jam&                 jam,
+    math::RNG32&                                rng,
+    const std::vector< endlesss::types::Stem >& stems,
+    const float                                 riffBPS )
+{
+    ABSL_ASSERT( stems.size() <= 8 );
+
+    endlesss::types::RiffComplete riffData;
+    riffData.jam = jam;
+
+    endlesss::types::Riff& riff = riffData.riff;
+    riff.couchID            = endlesss::types::RiffCouchID{ generateCouchID( rng ) };
+    riff.jamCouchID         = jam.couchID;
+    riff.user               = "bench_user";
+    riff.creationTimeUnix   = 1600000000;
+    riff.BPS                = riffBPS;
+    riff.BPMrnd             = riffBPS * 60.0f;
+    riff.barLength          = cRiffBarLength;
+    riff.appVersion         = 1;
+    riff.magnitude          = 1.0f;
+
+    riff.stemsOn.fill( false );
+    riff.gains.fill( 0 );
+
+    for ( std::size_t stemI = 0; stemI < stems.size(); stemI++ )
+    {
+        riffData.stems[stemI] = stems[stemI];
+
+        riff.stemsOn[stemI] = true;
+        riff.stems[stemI]   = stems[stemI].couchID;
+        riff.gains[stemI]   = 0.6f + ( rng.genFloat() * 0.4f );
+    }
+
+    return riffData;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< endlesss::live::RiffPtr > Environment::loadRiff( const endlesss::types::RiffComplete& riffData, const bool compactStems )
+{
+    endlesss::services::RiffFetchInstance riffFetchService( this );
+    endlesss::services::RiffFetchProvider riffFetchProvider = riffFetchService.makeBound();
+
+    // stems are requested from the cache during fetch, so the choice only needs to hold across the call
+    m_fetchStemCache = compactStems ? &m_stemCacheCompact : &m_stemCache;
+
+    endlesss::live::RiffPtr riffPtr = std::make_shared< endlesss::live::Riff >( riffData );
+    riffPtr->fetch( riffFetchProvider );
+
+    m_fetchStemCache = &m_stemCache;
+
+    // let the async stem analysis finish so the mixer sees the riff as it would in normal use
+    m_taskExecutor.wait_for_all();
+
+    if ( riffPtr->getSyncState() != endlesss::live::Riff::SyncState::Success )
+        return absl::InternalError( fmt::format( FMTX( "riff [{}] failed to sync" ), riffData.riff.couchID ) );
+
+    return riffPtr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< std::unique_ptr< endlesss::toolkit::Warehouse > > Environment::createWarehouse()
+{
+    config::Data configData;
+    configData.storageRoot = m_workingRoot.string();
+
+    const app::StoragePaths storagePaths( configData, "bench" );
+    if ( !storagePaths.tryToCreateAndValidate() )
+        return absl::InternalError( "unable to create warehouse storage paths" );
+
+    auto warehouse = std::make_unique< endlesss::toolkit::Warehouse >( storagePaths, m_networkConfiguration, m_workScheduler, *m_appEventBusClient );
+    warehouse->setCallbackTagUpdate(
+        []( const endlesss::types::RiffTag& ) {},
+        []( bool ) {} );
+
+    return warehouse;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+endlesss::toolkit::Warehouse::JamSlicePtr Environment::fetchJamSlice( endlesss::toolkit::Warehouse& warehouse, const endlesss::types::JamCouchID& jamID )
+{
+    std::promise< endlesss::toolkit::Warehouse::JamSlicePtr > slicePromise;
+    auto sliceFuture = slicePromise.get_future();
+
+    warehouse.addJamSliceRequest( jamID, [&slicePromise]( const endlesss::types::JamCouchID&, endlesss::toolkit::Warehouse::JamSlicePtr&& resultSlice )
+        {
+            slicePromise.set_value( std::move( resultSlice ) );
+        });
+
+    return sliceFuture.get();
+}
+
+} // namespace bench
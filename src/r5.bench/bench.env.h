@@ -0,0 +1,102 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  shared headless environment for the BENCH tools; owns the task executor, event bus and stem cache that the
+//  systems under test expect to find, and synthesises stems and riffs from fixed seeds into a scratch directory
+//
+
+#pragma once
+
+#include "base/eventbus.h"
+
+#include "app/core.h"
+
+#include "endlesss/cache.stems.h"
+#include "endlesss/core.services.h"
+#include "endlesss/core.types.h"
+#include "endlesss/live.riff.h"
+#include "endlesss/toolkit.warehouse.h"
+
+namespace math { class RNG32; }
+
+namespace bench {
+
+static constexpr uint32_t   cSeed                   = 0x0B5EED;
+
+static constexpr uint32_t   cStemSourceSampleRate   = 44100;        // what Endlesss stems are typically stored at
+static constexpr uint32_t   cTargetSampleRate       = 48000;        // what we play back at, forcing a resample pass
+
+// default riff shape; 120 BPM 4/4 gives 2 second bars
+static constexpr float      cRiffBPS                = 2.0f;
+static constexpr float      cRiffBarLength          = 16.0f;
+static constexpr double     cSecondsPerBar          = ( 1.0 / cRiffBPS ) * ( cRiffBarLength / 4.0f );
+
+// couch IDs are 32 hex characters; the code under test slices and hashes them, so keep them shaped the same
+std::string generateCouchID( math::RNG32& rng );
+
+// encode a stereo 16-bit FLAC file of a decaying chord on every beat with a little noise on top; close enough to real
+// stem material that the decoder and the analysis passes do representative work
+absl::Status writeSyntheticFLAC( const fs::path& outputFile, const uint32_t sampleRate, const uint32_t sampleCount, const uint32_t seed );
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct Environment final : public app::CoreStart,
+                           public endlesss::services::IRiffFetchService
+{
+    DECLARE_NO_COPY_NO_MOVE( Environment );
+
+    Environment();
+    ~Environment();
+
+    // wipe and recreate <temp>/ouroveon-bench/<scratchName>, bring up the event bus and the stem cache
+    absl::Status initialise( std::string_view scratchName );
+
+    // write a stem of (bars) bars at the default tempo into the stem cache, filling in (stem) to match it exactly so
+    // that Stem::fetch takes it straight from the cache
+    absl::Status generateStem( const endlesss::types::JamCouchID& jamCID, math::RNG32& rng, const uint32_t bars, endlesss::types::Stem& stem );
+
+    // assemble a riff from previously generated stems; slots beyond stems.size() are off
+    endlesss::types::RiffComplete generateRiff(
+        const endlesss::types::Jam&                 jam,
+        math::RNG32&                                rng,
+        const std::vector< endlesss::types::Stem >& stems,
+        const float                                 riffBPS );
+
+    // fetch a riff through the stem cache as the apps do, waiting for stem analysis to finish too; compactStems loads
+    // it through a second cache over the same files that holds its stems in block-float storage
+    absl::StatusOr< endlesss::live::RiffPtr > loadRiff( const endlesss::types::RiffComplete& riffData, const bool compactStems = false );
+
+    // a warehouse stored under the scratch directory. sqlite fixes the database file the first time it is opened, so
+    // every warehouse created within one run shares the same database
+    absl::StatusOr< std::unique_ptr< endlesss::toolkit::Warehouse > > createWarehouse();
+
+    // blocking slice request; the worker runs tasks in order, so this also waits out anything queued before it
+    static endlesss::toolkit::Warehouse::JamSlicePtr fetchJamSlice( endlesss::toolkit::Warehouse& warehouse, const endlesss::types::JamCouchID& jamID );
+
+
+    // endlesss::services::IRiffFetchService
+    int32_t                                 getSampleRate() const override          { return cTargetSampleRate; }
+    const endlesss::api::NetConfiguration&  getNetConfiguration() const override    { return *m_networkConfiguration; }
+    endlesss::cache::Stems&                 getStemCache() override                 { return *m_fetchStemCache; }
+    tf::Executor&                           getTaskExecutor() override              { return m_taskExecutor; }
+    dsp::TimeStretch::Preset                getTimeStretchPreset() const override   { return m_timeStretchPreset; }
+
+
+    endlesss::api::NetConfiguration::Shared m_networkConfiguration;
+    tf::Executor                            m_taskExecutor;
+    base::WorkScheduler                     m_workScheduler;
+    dsp::TimeStretch::Preset                m_timeStretchPreset = dsp::TimeStretch::Preset::Off;   // riffs keep their stems on the resample path unless changed
+
+    base::EventBusPtr                       m_appEventBus;
+    std::optional< base::EventBusClient >   m_appEventBusClient;
+
+    fs::path                                m_workingRoot;
+    endlesss::cache::Stems                  m_stemCache;
+    endlesss::cache::Stems                  m_stemCacheCompact;
+    endlesss::cache::Stems*                 m_fetchStemCache = &m_stemCache;        // the one loadRiff is currently using
+};
+
+} // namespace bench
@@ -0,0 +1,34 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  mixer regression harness; renders scripted scenarios (riff changes, bar-locked transitions, permutation glides,
+//  crossfades across tempo changes, BEAM's progression engine) through the mixers offline and compares the 24-bit output against golden files
+//  recorded from a reference build; plays Preview and BEAM's engine side by side with frozen copies of themselves from
+//  before the harness (bench.mixcheck.reference.h) and holds them to that output; also watches a progressive stem decode to check that nothing below the published
+//  sample watermark ever changes after the mixers could have read it, compares the streaming stem resampler with a
+//  whole-stream r8brain conversion, checks that the time-stretcher holds length, pitch and onset timing, and replays
+//  recorded MIDI timing, and a fixture .mid file through FileReplay, to check where messages land in a block and that
+//  Preview's layer gates switch on that sample
+//
+
+#pragma once
+
+namespace bench {
+
+struct Environment;
+
+struct MixCheckOptions
+{
+    fs::path            m_goldenDirectory;
+    bool                m_updateGoldens     = false;    // re-record every golden rather than comparing against them
+    double              m_tolerance         = 1e-5;     // largest per-sample difference accepted when hashes disagree
+};
+
+// returns a process exit code; 0 if every scenario matched (or was recorded, with m_updateGoldens). a scenario with no
+// golden fails unless m_updateGoldens is set; goldens live in src/r5.bench/goldens, see the README there
+int runMixCheck( Environment& environment, const MixCheckOptions& options );
+
+} // namespace bench
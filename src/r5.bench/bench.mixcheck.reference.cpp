@@ -0,0 +1,647 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+
+#include "pch.h"
+
+#include "base/mathematics.h"
+
+#include "endlesss/live.riff.h"
+#include "endlesss/live.stem.h"
+
+#include "bench.mixcheck.reference.h"
+
+namespace bench {
+namespace reference {
+
+// float accumulation in the current engine's per-block fade position drifts a little over a long blend
+static constexpr double     cBlendDrift         = 1e-3;
+
+// a riff the reference has already swapped out can be heard for up to one more block in the current engine; two leaves
+// room for the fade drift above
+static constexpr uint32_t   cRetiredBlocks      = 2;
+
+// ---------------------------------------------------------------------------------------------------------------------
+BeamMixEngine::BeamMixEngine( const int32_t maxBufferSize, const int32_t sampleRate, base::EventBusClient& eventBusClient )
+    : RiffMixerBase( maxBufferSize, sampleRate, eventBusClient )
+    , m_samplePosition( 0 )
+    , m_riffRetiredBlocks( 0 )
+    , m_riffRetiredBlendError( 0 )
+    , m_transitionValue( 0 )
+    , m_transitionRate( 0.25 )
+{
+    m_slack[0] = mem::alloc16To<float>( maxBufferSize, 0.0f, mem::Tag::Riffs );
+    m_slack[1] = mem::alloc16To<float>( maxBufferSize, 0.0f, mem::Tag::Riffs );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+BeamMixEngine::~BeamMixEngine()
+{
+    mem::free16( m_slack[1], mem::Tag::Riffs );
+    mem::free16( m_slack[0], mem::Tag::Riffs );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+float BeamMixEngine::sampleLayer(
+    const RiffAndPermutation&   riff,
+    const std::size_t           stemIndex,
+    const int32_t               channel,
+    const uint64_t              riffSample )
+{
+    const endlesss::live::Riff* riffData = riff.m_riffPtr.get();
+    if ( riffData == nullptr )
+        return 0;
+
+    const endlesss::live::Stem* stemInst = riffData->m_stemPtrs[stemIndex];
+    if ( stemInst == nullptr || stemInst->hasFailed() )
+        return 0;
+
+    const auto sampleCount = stemInst->m_sampleCount;
+    uint64_t finalSampleIdx = riffSample;
+
+    const float stemTimeStretch = riffData->m_stemTimeScales[stemIndex];
+    if ( stemTimeStretch != 1.0f )
+    {
+        double scaleSample = (double)finalSampleIdx * stemTimeStretch;
+        finalSampleIdx = (uint64_t)scaleSample;
+    }
+    finalSampleIdx %= sampleCount;
+
+    const float stemGain = riffData->m_stemGains[stemIndex] * riff.m_permutation.m_layerGainMultiplier[stemIndex];
+
+    return stemInst->getSample( channel, (int32_t)finalSampleIdx ) * stemGain;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BeamMixEngine::accumulateSlack(
+    const RiffAndPermutation&   riffA,
+    const RiffAndPermutation&   riffB,
+    const uint64_t              samplePosition,
+    const uint32_t              sampleIndex,
+    const float                 blendError )
+{
+    const uint64_t riffSampleA = riffA.isEmpty() ? 0 : ( ( samplePosition + sampleIndex ) % riffA.m_riffPtr->m_timingDetails.m_lengthInSamples );
+    const uint64_t riffSampleB = riffB.isEmpty() ? 0 : ( ( samplePosition + sampleIndex ) % riffB.m_riffPtr->m_timingDetails.m_lengthInSamples );
+
+    for ( int32_t channel = 0; channel < 2; channel++ )
+    {
+        float layerGap = 0;
+        for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+            layerGap += std::abs( sampleLayer( riffB, stemI, channel, riffSampleB ) - sampleLayer( riffA, stemI, channel, riffSampleA ) );
+
+        m_slack[channel][sampleIndex] += blendError * layerGap;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BeamMixEngine::update(
+    const AudioBuffer&  outputBuffer,
+    const AudioSignal&  outputSignal,
+    const uint32_t      samplesToWrite,
+    const uint64_t      samplePosition )
+{
+    m_samplePosition = samplePosition;
+
+    std::fill_n( m_slack[0], samplesToWrite, 0.0f );
+    std::fill_n( m_slack[1], samplesToWrite, 0.0f );
+
+    const double linearTimeStep = (double)samplesToWrite / (double)m_audioSampleRate;
+
+    // the blend position steps once per block here, the current engine moves it every sample and starts it on the
+    // bar line itself; either way round they are never more than a block's worth of blend apart
+    const auto blendError = [&]
+    {
+        return (float)( ( (double)( m_audioMaxBufferSize + 1 ) * m_audioSampleRateRecp * m_transitionRate ) + cBlendDrift );
+    };
+
+    // set when a hard cut swaps m_riffCurrent; a cut taken part-way through the block only lands on the next one
+    bool hardCutTaken = false;
+
+    // swap in the Next riff, mark transition/unpack flags as appropriate
+    const auto exchangeLiveRiff = [&]
+    {
+        m_riffCurrent           = m_riffNext;
+        m_riffNext              = {};
+        m_transitionValue       = 0.0f;
+    };
+
+    // process commands from the main thread
+    {
+        EngineCommandData engineCmd;
+        if ( m_commandQueue.try_dequeue( engineCmd ) )
+        {
+            switch ( engineCmd.getCommand() )
+            {
+                case EngineCommand::UpdateProgressionConfiguration:
+                {
+                    ABSL_ASSERT( engineCmd.getPtr() != nullptr );
+                    m_progression = *engineCmd.getPtrAs< ProgressionConfiguration >();
+                }
+                break;
+
+                case EngineCommand::ClearCurrentlyPlaying:
+                {
+                    m_riffNext = {};
+                    exchangeLiveRiff();
+
+                    m_riffRetired       = {};
+                    m_riffRetiredBlocks = 0;
+                }
+                break;
+
+                case EngineCommand::ClearAllScheduledTransitions:
+                {
+                    // purge the queue
+                    RiffAndPermutation dumpRiff;
+                    while ( m_riffQueue.try_dequeue( dumpRiff ) )
+                    { }
+                }
+                break;
+
+                // recording and repcom commands have nothing to act on here
+                default:
+                    ABSL_ASSERT( false );
+                    break;
+            }
+        }
+    }
+
+    const auto checkForAndDequeueNextRiff = [&]
+    {
+        if ( m_riffNext.isEmpty() )
+        {
+            if ( m_riffQueue.peek() != nullptr &&
+                 m_transitionValue == 0 )
+            {
+                if ( !m_riffQueue.try_dequeue( m_riffNext ) )
+                {
+                    ABSL_ASSERT( false );
+                    return false;
+                }
+
+                if ( m_riffNext.m_riffPtr->getSyncState() != endlesss::live::Riff::SyncState::Success )
+                {
+                    m_riffNext = {};
+                }
+
+                // hard cut
+                if ( m_progression.m_blendTime == ProgressionConfiguration::BlendTime::Zero )
+                {
+                    exchangeLiveRiff();
+                    hardCutTaken = true;
+                }
+                // pick blend rate based on how many bars to take
+                else
+                {
+                    ABSL_ASSERT( m_riffNext.isNotEmpty() );
+                    m_transitionRate = 1.0 / ( m_riffNext.m_riffPtr->m_timingDetails.m_lengthInSecPerBar * m_progression.getBlendTimeMultiplier() );
+                }
+            }
+        }
+
+        return ( m_riffNext.isNotEmpty() );
+    };
+
+    // in Arbitrary mode, check all the time to see if we could be switching
+    if ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::Arbitrary )
+    {
+        checkForAndDequeueNextRiff();
+    }
+
+    // update the transition, if one is active; and swap in the next riff if one has completed
+    if ( m_riffNext.isNotEmpty() )
+    {
+        m_transitionValue += (float)( linearTimeStep * m_transitionRate );
+
+        if ( m_transitionValue >= 1.0f )
+        {
+            m_riffRetired           = m_riffCurrent;
+            m_riffRetiredBlocks     = cRetiredBlocks;
+            m_riffRetiredBlendError = blendError();
+
+            exchangeLiveRiff();
+        }
+    }
+
+    // early out if we have nothing to play or the active riff is 0-length
+    if ( m_riffCurrent.isEmpty() ||
+         m_riffCurrent.m_riffPtr->m_timingDetails.m_lengthInSamples == 0 )
+    {
+        outputBuffer.applySilence();
+
+        // reset computed riff playback variables
+        m_playbackProgression.reset();
+
+        // check if there's something on the horizon
+        if ( m_riffQueue.peek() != nullptr )
+        {
+            if ( checkForAndDequeueNextRiff() )
+                exchangeLiveRiff();
+        }
+        return;
+    }
+
+    // the layers unpacked for this block; a hard cut mid-block changes m_riffCurrent but not these
+    const RiffAndPermutation        riffForeground  = m_riffCurrent;
+    const endlesss::live::Riff*     currentRiff     = riffForeground.m_riffPtr.get();
+
+    // nothing can be dequeued while a blend is underway, so whether this block blends is fixed here
+    const bool                      blending        = ( m_transitionValue > 0 );
+    const float                     blendSlack      = blending ? blendError() : 0.0f;
+
+    currentRiff->getTimingDetails().ComputeProgressionAtSample( m_samplePosition, m_playbackProgression );
+
+    const uint64_t riffLengthInSamples      = currentRiff->m_timingDetails.m_lengthInSamples;
+    const uint64_t riffWrappedSampleStart   = samplePosition % riffLengthInSamples;
+
+    const uint64_t nextLengthInSamples      = blending ? m_riffNext.m_riffPtr->m_timingDetails.m_lengthInSamples : 0;
+    const uint64_t nextWrappedSampleStart   = blending ? ( samplePosition % nextLengthInSamples ) : 0;
+
+    const auto segmentLengthInSamples   = currentRiff->m_timingDetails.m_lengthInSamplesPerBar;
+          auto segmentSampleStart       = samplePosition % segmentLengthInSamples;
+
+    uint32_t hardCutAt  = samplesToWrite;
+    uint32_t blendAt    = samplesToWrite;
+
+    for ( auto sI = 0U; sI < samplesToWrite; sI++ )
+    {
+        // get sample position in context of the riff
+        uint64_t riffSample   = riffWrappedSampleStart + sI;
+        if ( riffSample >= riffLengthInSamples )
+            riffSample -= riffLengthInSamples;
+
+        while ( segmentSampleStart >= segmentLengthInSamples )
+        {
+            segmentSampleStart -= segmentLengthInSamples;
+
+            m_playbackProgression.m_playbackBar++;
+            if ( m_playbackProgression.m_playbackBar >= currentRiff->m_timingDetails.m_barCount )
+                m_playbackProgression.m_playbackBar = 0;
+        }
+
+        const uint64_t segmentSample = segmentSampleStart++;
+
+        if ( segmentSample == 0 )
+        {
+            const bool isEvenBarNumber = (m_playbackProgression.m_playbackBar & 1 ) == 0;
+            const bool shouldTriggerTransition =
+                // any bar
+                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::AnyBarStart ) ||
+                // 0, 2, 4, ..
+                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::AnyEvenBarStart && isEvenBarNumber ) ||
+                // next riff is bar 0
+                ( m_progression.m_triggerPoint == ProgressionConfiguration::TriggerPoint::NextRiffStart && m_playbackProgression.m_playbackBar == 0 );
+
+            if ( shouldTriggerTransition )
+            {
+                const bool wasBlending = m_riffNext.isNotEmpty();
+
+                hardCutTaken = false;
+                checkForAndDequeueNextRiff();
+
+                if ( hardCutTaken && hardCutAt == samplesToWrite )
+                    hardCutAt = sI;
+                // the reference holds a blend dequeued here back until the next block
+                else if ( !wasBlending && !blending && m_riffNext.isNotEmpty() && blendAt == samplesToWrite )
+                    blendAt = sI;
+            }
+        }
+
+        for ( auto stemI = 0U; stemI < 8; stemI++ )
+        {
+            float sampleLeft  = sampleLayer( riffForeground, stemI, 0, riffSample );
+            float sampleRight = sampleLayer( riffForeground, stemI, 1, riffSample );
+
+            // when transitioning, a missing/muted stem means we need to transition down to silence, not just skip entirely
+            if ( blending )
+            {
+                uint64_t nextSample = nextWrappedSampleStart + sI;
+                if ( nextSample >= nextLengthInSamples )
+                    nextSample -= nextLengthInSamples;
+
+                sampleLeft  = base::lerp( sampleLeft,  sampleLayer( m_riffNext, stemI, 0, nextSample ), m_transitionValue );
+                sampleRight = base::lerp( sampleRight, sampleLayer( m_riffNext, stemI, 1, nextSample ), m_transitionValue );
+            }
+
+            m_mixChannelLeft[stemI][sI]  = sampleLeft;
+            m_mixChannelRight[stemI][sI] = sampleRight;
+        }
+
+        if ( blending )
+            accumulateSlack( riffForeground, m_riffNext, samplePosition, sI, blendSlack );
+        if ( sI >= blendAt )
+            accumulateSlack( riffForeground, m_riffNext, samplePosition, sI, blendError() );
+        if ( sI >= hardCutAt )
+            accumulateSlack( riffForeground, m_riffCurrent, samplePosition, sI, 1.0f );
+        if ( m_riffRetiredBlocks > 0 )
+            accumulateSlack( m_riffRetired, riffForeground, samplePosition, sI, (float)m_riffRetiredBlendError );
+    }
+
+    if ( m_riffRetiredBlocks > 0 && --m_riffRetiredBlocks == 0 )
+        m_riffRetired = {};
+
+    mixChannelsToOutput( outputBuffer, outputSignal, samplesToWrite );
+
+    const float slackGain = std::abs( outputSignal.m_linearGain );
+    for ( auto sI = 0U; sI < samplesToWrite; sI++ )
+    {
+        m_slack[0][sI] *= slackGain;
+        m_slack[1][sI] *= slackGain;
+    }
+}
+
+
+// =====================================================================================================================
+// only the single-bar lock is kept; the beat offset and bar-count variants were not reachable from the preview API
+
+// ---------------------------------------------------------------------------------------------------------------------
+PreviewMixer::PreviewMixer( const int32_t maxBufferSize, const int32_t sampleRate, base::EventBusClient& eventBusClient )
+    : RiffMixerBase( maxBufferSize, sampleRate, eventBusClient )
+{
+    m_txBlendCacheLeft.fill( 0 );
+    m_txBlendCacheRight.fill( 0 );
+    m_txBlendActiveLeft.fill( 0 );
+    m_txBlendActiveRight.fill( 0 );
+
+    const auto blendDelta =  1.0 / (double)txBlendBufferSize;
+          auto blendValue = -1.0;
+
+    // precompute the lerp values for each blend sample in the buffer; based on constant-power fade through
+    for ( std::size_t bI = 0; bI < txBlendBufferSize; bI++, blendValue += blendDelta * 2.0 )
+        m_txBlendInterp[bI] = (float)std::sqrt( 0.5 * (1.0 - blendValue) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void PreviewMixer::renderCurrentRiff(
+    const uint32_t      outputOffset,
+    const uint32_t      samplesToWrite )
+{
+    if ( samplesToWrite == 0 )
+        return;
+
+    std::array< float, 8 >                  stemTimeStretch;
+    std::array< float, 8 >                  stemGains;
+    std::array< endlesss::live::Stem*, 8 >  stemPtr;
+
+    const endlesss::live::Riff* currentRiff = m_riffCurrent.get();
+
+    // unzip the riff and stem data into stack-local items
+    for ( auto stemI = 0U; stemI < 8; stemI++ )
+    {
+        stemTimeStretch[stemI]  = currentRiff->m_stemTimeScales[stemI];
+        stemGains[stemI]        = currentRiff->m_stemGains[stemI] * m_permutationCurrent.m_layerGainMultiplier[stemI];
+        stemPtr[stemI]          = currentRiff->m_stemPtrs[stemI];
+    }
+
+    // keep note of where we are mixing in terms of the 0..N sample count of the current riff
+    const auto riffLengthInSamples      = currentRiff->m_timingDetails.m_lengthInSamples;
+
+    // ensure the current playback sample position for the riff isn't off the end
+    while ( m_riffPlaybackSample >= riffLengthInSamples )
+    {
+        m_riffPlaybackSample -= riffLengthInSamples;
+    }
+
+    const auto riffWrappedSampleStart   = m_riffPlaybackSample;
+
+    for ( auto stemI = 0U; stemI < 8; stemI++ )
+    {
+        const auto  stemInst = stemPtr[stemI];
+        const float stemGain = stemGains[stemI];
+
+        float permGain = m_permutationCurrent.m_layerGainMultiplier[stemI];
+
+        m_txBlendCacheLeft[stemI]  = 0;
+        m_txBlendCacheRight[stemI] = 0;
+
+        // any stem problem -> silence
+        if ( stemInst == nullptr ||
+             stemInst->hasFailed() )
+        {
+            for ( auto sI = 0U; sI < samplesToWrite; sI++ )
+            {
+                m_mixChannelLeft[stemI][outputOffset + sI] = 0;
+                m_mixChannelRight[stemI][outputOffset + sI] = 0;
+            }
+
+            permGain += m_permutationSampleGainDelta[stemI] * samplesToWrite;
+            m_permutationCurrent.m_layerGainMultiplier[stemI] = permGain - m_permutationSampleGainDelta[stemI];
+
+            continue;
+        }
+
+        // get sample position in context of the riff
+        uint64_t riffSample = riffWrappedSampleStart;
+
+        float lastSampleLeft  = 0;
+        float lastSampleRight = 0;
+
+        for ( auto sI = 0U; sI < samplesToWrite; sI++ )
+        {
+            const auto sampleCount = stemInst->m_sampleCount;
+            uint64_t finalSampleIdx = riffSample;
+
+            if (stemTimeStretch[stemI] != 1.0f)
+            {
+                finalSampleIdx  = (uint64_t)( (double)finalSampleIdx * stemTimeStretch[stemI] );
+            }
+            finalSampleIdx %= sampleCount;
+
+            lastSampleLeft  = stemInst->getSample( 0, (int32_t)finalSampleIdx ) * stemGain * permGain;
+            lastSampleRight = stemInst->getSample( 1, (int32_t)finalSampleIdx ) * stemGain * permGain;
+            m_mixChannelLeft[stemI][outputOffset + sI]  = lastSampleLeft;
+            m_mixChannelRight[stemI][outputOffset + sI] = lastSampleRight;
+
+            riffSample++;
+            if ( riffSample >= riffLengthInSamples )
+                riffSample -= riffLengthInSamples;
+
+            permGain += m_permutationSampleGainDelta[stemI];
+        }
+
+        m_txBlendCacheLeft[stemI]  = lastSampleLeft;
+        m_txBlendCacheRight[stemI] = lastSampleRight;
+
+        m_permutationCurrent.m_layerGainMultiplier[stemI] = permGain - m_permutationSampleGainDelta[stemI];
+    }
+
+    m_riffPlaybackSample += samplesToWrite;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void PreviewMixer::applyBlendBuffer( const uint32_t outputOffset, const uint32_t samplesToWrite )
+{
+    if ( m_txBlendSamplesRemaining <= 0 || samplesToWrite == 0 )
+        return;
+
+    ABSL_ASSERT( m_txBlendSamplesRemaining <= txBlendBufferSize );
+
+    // work out minimum number of values to walk
+    const auto maxSamplesToWrite = std::min( samplesToWrite, m_txBlendSamplesRemaining );
+
+    // find where to read from our blend-amount array, offset how many samples we've already used (in previous update()s)
+    const auto txIntepIndex = txBlendBufferSize - m_txBlendSamplesRemaining;
+
+    for ( auto stemI = 0U; stemI < 8; stemI++ )
+    {
+        for ( auto sI = 0U; sI < maxSamplesToWrite; sI++ )
+        {
+            const float existingLeft  = m_mixChannelLeft[stemI][outputOffset + sI];
+            const float existingRight = m_mixChannelRight[stemI][outputOffset + sI];
+
+            m_mixChannelLeft[stemI][outputOffset + sI]  = std::lerp( existingLeft,  m_txBlendActiveLeft[stemI],  m_txBlendInterp[txIntepIndex + sI] );
+            m_mixChannelRight[stemI][outputOffset + sI] = std::lerp( existingRight, m_txBlendActiveRight[stemI], m_txBlendInterp[txIntepIndex + sI] );
+        }
+    }
+
+    m_txBlendSamplesRemaining -= maxSamplesToWrite;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void PreviewMixer::update(
+    const AudioBuffer&  outputBuffer,
+    const AudioSignal&  outputSignal,
+    const uint32_t      samplesToWrite )
+{
+    // "drain and stop"; empty the request queue and play nothing
+    if ( m_drainQueueAndStop )
+    {
+        mix::RiffPtrOperation riffOperation;
+        while ( m_riffQueue.try_dequeue( riffOperation ) )
+        { }
+
+        m_riffCurrent = nullptr;
+        m_drainQueueAndStop = false;
+    }
+
+    bool        riffEnqueued = ( m_riffQueue.peek() != nullptr );
+    const auto dequeNextRiff = [this, &riffEnqueued]()
+    {
+        mix::RiffPtrOperation riffOperation;
+        if ( !m_riffQueue.try_dequeue( riffOperation ) )
+        {
+            ABSL_ASSERT( false );
+        }
+
+        m_riffCurrent = riffOperation.m_value;
+
+        // update enqueued state now we just removed something from the pile
+        riffEnqueued = ( m_riffQueue.peek() != nullptr );
+    };
+
+    const auto addTxBlend = [this]
+    {
+        for ( auto stemI = 0U; stemI < 8; stemI++ )
+        {
+            m_txBlendActiveLeft[stemI]  = m_txBlendCacheLeft[stemI];
+            m_txBlendActiveRight[stemI] = m_txBlendCacheRight[stemI];
+        }
+        m_txBlendSamplesRemaining = txBlendBufferSize;
+    };
+
+    const bool riffEmpty = ( m_riffCurrent == nullptr ||
+                             m_riffCurrent->m_timingDetails.m_lengthInSamples == 0 );
+
+    updatePermutations( samplesToWrite, riffEmpty ? 1.0 : m_riffCurrent->m_timingDetails.m_lengthInSecPerBar );
+
+    // early out when nothing is happening
+    if ( riffEmpty && !riffEnqueued )
+    {
+        // keep permutations updating even if we early out
+        flushPendingPermutations();
+
+        outputBuffer.applySilence();
+
+        // blank out tx cache
+        m_txBlendCacheLeft.fill( 0 );
+        m_txBlendCacheRight.fill( 0 );
+
+        // the first riff enqueued after being idle starts from scratch
+        m_riffPlaybackSample = 0;
+        return;
+    }
+
+    uint32_t txOffset = 0;
+    uint32_t txSampleLimit = samplesToWrite;
+
+    // instant transition mode; or if we have no current riff, default to just grabbing one instantly
+    if ( m_lockTransitionToNextBar == false || riffEmpty )
+    {
+        flushPendingPermutations();
+
+        // in instant mode, any time a riff is enqueued we pull it for playing immediately
+        if ( riffEnqueued )
+        {
+            dequeNextRiff();
+            addTxBlend();
+
+            if ( m_riffCurrent == nullptr )
+            {
+                mixChannelsWriteSilence( 0, samplesToWrite );
+            }
+            else
+            {
+                renderCurrentRiff( 0, samplesToWrite );
+            }
+        }
+        // .. nothing to do, just keep rendering samples
+        else
+        {
+            renderCurrentRiff( 0, samplesToWrite );
+        }
+    }
+    // bar transition mode
+    else
+    {
+        const auto segmentLengthInSamples = (int64_t)m_riffCurrent->m_timingDetails.m_lengthInSamplesPerBar;
+
+        // work out how many samples we have to render before we hit a transition point
+        const auto samplesUntilNextSegment = (uint32_t)(segmentLengthInSamples - (m_riffPlaybackSample % segmentLengthInSamples));
+
+        // no transition in this update, just blit out the current riff
+        if ( samplesUntilNextSegment > samplesToWrite )
+        {
+            renderCurrentRiff( 0, samplesToWrite );
+        }
+        // .. otherwise render up to the transition point, switch riffs there, then continue
+        else
+        {
+            if ( samplesUntilNextSegment > 0 )
+                renderCurrentRiff( 0, samplesUntilNextSegment );
+
+            const auto samplesRemainingToWrite = samplesToWrite - samplesUntilNextSegment;
+
+            if ( riffEnqueued )
+            {
+                dequeNextRiff();
+                addTxBlend();
+            }
+
+            flushPendingPermutations();
+
+            if ( m_riffCurrent == nullptr )
+            {
+                mixChannelsWriteSilence( samplesUntilNextSegment, samplesRemainingToWrite );
+            }
+            else
+            {
+                renderCurrentRiff( samplesUntilNextSegment, samplesRemainingToWrite );
+            }
+
+            // set the transition blending to start at this point in the buffer
+            txOffset = samplesUntilNextSegment;
+            txSampleLimit = samplesRemainingToWrite;
+        }
+    }
+
+    // if we have some cached transition smoothing values in play, weave them in
+    applyBlendBuffer( txOffset, txSampleLimit );
+
+    mixChannelsToOutput( outputBuffer, outputSignal, samplesToWrite );
+}
+
+} // namespace reference
+} // namespace bench
@@ -0,0 +1,174 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  mixers as they stood before the mixcheck harness existed, frozen here as references for mixcheck to hold the live
+//  ones to; BEAM's engine from before riffs were rendered through mix::RiffVoices - two riffs at most, the incoming
+//  one lerped in at a rate stepped once per block - and mix::Preview from before compact storage, progressive decode,
+//  time-stretch and MIDI gating were added. recording, repetition compression, Link and the stem amalgam are left out;
+//  none of them touch the mixed output. stems are read through Stem::getSample() so that either storage format plays.
+//  do not "fix" anything in here, the point is that it doesn't move
+//
+
+#pragma once
+
+#include "mix/common.h"
+#include "mix/progression.h"
+
+namespace bench {
+namespace reference {
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct BeamMixEngine final : public mix::RiffMixerBase
+{
+    using AudioBuffer               = app::module::Audio::OutputBuffer;
+    using AudioSignal               = app::module::Audio::OutputSignal;
+
+    // the engine's configuration and queue types carry over unchanged; the blend curve is the one thing the reference
+    // has no notion of, it only ever blended linearly
+    using ProgressionConfiguration  = mix::ProgressionEngine::ProgressionConfiguration;
+    using RiffAndPermutation        = mix::ProgressionEngine::RiffAndPermutation;
+    using EngineCommand             = mix::ProgressionEngine::EngineCommand;
+    using EngineCommandData         = mix::ProgressionEngine::EngineCommandData;
+    using CommandQueue              = mix::ProgressionEngine::CommandQueue;
+    using RiffQueue                 = mix::ProgressionEngine::RiffQueue;
+
+    BeamMixEngine( const int32_t maxBufferSize, const int32_t sampleRate, base::EventBusClient& eventBusClient );
+    ~BeamMixEngine();
+
+    inline void addNextRiff( const endlesss::live::RiffPtr& nextRiff )
+    {
+        m_riffQueue.emplace( nextRiff );
+    }
+    inline void addNextRiff( const endlesss::live::RiffPtr& nextRiff, const endlesss::types::RiffPlaybackPermutationOpt& permOpt )
+    {
+        m_riffQueue.emplace( nextRiff, permOpt );
+    }
+    inline void updateProgressionConfiguration( const ProgressionConfiguration* pConfig )
+    {
+        m_commandQueue.emplace( EngineCommand::UpdateProgressionConfiguration, (void*)pConfig );
+    }
+    inline void clearAllScheduledTransitions()
+    {
+        m_commandQueue.emplace( EngineCommand::ClearAllScheduledTransitions );
+    }
+    inline void clearCurrentPlayback()
+    {
+        m_commandQueue.emplace( EngineCommand::ClearCurrentlyPlaying );
+    }
+
+    void update(
+        const AudioBuffer&  outputBuffer,
+        const AudioSignal&  outputSignal,
+        const uint32_t      samplesToWrite,
+        const uint64_t      samplePosition );
+
+    // how far the current engine may stray from the reference at each sample of the last update(), per channel, on
+    // top of the usual tolerance. zero while a single riff plays; non-zero only where the reference is known to
+    // differ by design - through a blend, where it steps the blend once per block rather than per sample and starts
+    // it a block late on bar edges, and across the rest of a block holding a hard cut, which it only makes on the
+    // following block. the bound is the blend position error allowed, times the gap between the two riffs
+    ouro_nodiscard constexpr const float* getSlack( const std::size_t channel ) const { return m_slack[channel]; }
+
+private:
+
+    // one layer of one riff at a riff-relative sample, gained as the reference mixes it; 0 for missing layers
+    static float sampleLayer(
+        const RiffAndPermutation&   riff,
+        const std::size_t           stemIndex,
+        const int32_t               channel,
+        const uint64_t              riffSample );
+
+    // add ( blendError * |b - a| ) summed over every layer, for each channel at one sample of the block
+    void accumulateSlack(
+        const RiffAndPermutation&   riffA,
+        const RiffAndPermutation&   riffB,
+        const uint64_t              samplePosition,
+        const uint32_t              sampleIndex,
+        const float                 blendError );
+
+    uint64_t                    m_samplePosition;
+
+    RiffAndPermutation          m_riffCurrent;
+    RiffAndPermutation          m_riffNext;
+    RiffAndPermutation          m_riffRetired;              // blended out at the top of a recent block
+    uint32_t                    m_riffRetiredBlocks;        // blocks left that m_riffRetired may still be audible in the current engine
+    double                      m_riffRetiredBlendError;
+
+    endlesss::live::RiffProgression
+                                m_playbackProgression;
+
+    RiffQueue                   m_riffQueue;
+    CommandQueue                m_commandQueue;
+
+    float                       m_transitionValue;
+    double                      m_transitionRate;
+
+    ProgressionConfiguration    m_progression;
+
+    std::array< float*, 2 >     m_slack;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// mix::Preview's render path as of the commit before the mixcheck harness; riff changes land instantly or on the next
+// bar line, either way smoothed over with a short constant-power blend from the last sample of each layer
+struct PreviewMixer final : public mix::RiffMixerBase
+{
+    using AudioBuffer               = app::module::Audio::OutputBuffer;
+    using AudioSignal               = app::module::Audio::OutputSignal;
+
+    PreviewMixer( const int32_t maxBufferSize, const int32_t sampleRate, base::EventBusClient& eventBusClient );
+
+    inline void enqueueRiff( const endlesss::live::RiffPtr& nextRiff )
+    {
+        if ( nextRiff->getSyncState() != endlesss::live::Riff::SyncState::Success )
+            return;
+
+        m_riffQueue.emplace( base::OperationID::invalid(), nextRiff );
+    }
+    inline void stop()
+    {
+        m_drainQueueAndStop = true;
+    }
+    inline void setLockTransitionToNextBar( const bool onOff )
+    {
+        m_lockTransitionToNextBar = onOff;
+    }
+
+    void update(
+        const AudioBuffer&  outputBuffer,
+        const AudioSignal&  outputSignal,
+        const uint32_t      samplesToWrite );
+
+private:
+
+    static constexpr size_t     txBlendBufferSize = 128;
+    using TxBlendInterpArray    = std::array< float, txBlendBufferSize >;
+
+    void renderCurrentRiff(
+        const uint32_t      outputOffset,
+        const uint32_t      samplesToWrite );
+
+    void applyBlendBuffer(
+        const uint32_t      outputOffset,
+        const uint32_t      samplesToWrite );
+
+    mix::RiffOperationQueue     m_riffQueue;
+    endlesss::live::RiffPtr     m_riffCurrent;
+    int64_t                     m_riffPlaybackSample        = 0;
+
+    std::array< float, 8 >      m_txBlendCacheLeft;
+    std::array< float, 8 >      m_txBlendCacheRight;
+    std::array< float, 8 >      m_txBlendActiveLeft;
+    std::array< float, 8 >      m_txBlendActiveRight;
+    TxBlendInterpArray          m_txBlendInterp;
+    uint32_t                    m_txBlendSamplesRemaining   = 0;
+
+    bool                        m_lockTransitionToNextBar   = false;
+    bool                        m_drainQueueAndStop         = false;
+};
+
+} // namespace reference
+} // namespace bench
@@ -0,0 +1,1658 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+
+#include "pch.h"
+
+#include "base/construction.h"
+#include "base/memory.h"
+#include "base/utils.h"
+#include "buffer/compact.h"
+#include "filesys/fsutil.h"
+#include "math/rng.h"
+
+#include "endlesss/api.h"
+#include "endlesss/toolkit.jam.archive.h"
+#include "endlesss/toolkit.paging.h"
+
+#include "net/bond.riffpush.h"
+
+#include "ssp/ssp.stream.opus.h"
+#include "ssp/ssp.stream.opus.sinks.h"
+
+#include "bench.env.h"
+#include "bench.selfcheck.h"
+
+#include <asio.hpp>
+
+namespace bench {
+
+static constexpr uint32_t   cSelfCheckSeed          = cSeed ^ 0x5E1F;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// field-by-field comparisons that name the first thing that differs
+static absl::Status compareRiffs( const endlesss::types::Riff& expected, const endlesss::types::Riff& actual )
+{
+    const auto mismatch = [&]( std::string_view field )
+    {
+        return absl::DataLossError( fmt::format( FMTX( "riff [{}] differs in {}" ), expected.couchID, field ) );
+    };
+
+    if ( expected.couchID           != actual.couchID )             return mismatch( "couchID" );
+    if ( expected.jamCouchID        != actual.jamCouchID )          return mismatch( "jamCouchID" );
+    if ( expected.user              != actual.user )                return mismatch( "user" );
+    if ( expected.creationTimeUnix  != actual.creationTimeUnix )    return mismatch( "creationTimeUnix" );
+    if ( expected.root              != actual.root )                return mismatch( "root" );
+    if ( expected.scale             != actual.scale )               return mismatch( "scale" );
+    if ( expected.BPS               != actual.BPS )                 return mismatch( "BPS" );
+    if ( expected.BPMrnd            != actual.BPMrnd )              return mismatch( "BPMrnd" );
+    if ( expected.barLength         != actual.barLength )           return mismatch( "barLength" );
+    if ( expected.appVersion        != actual.appVersion )          return mismatch( "appVersion" );
+    if ( expected.magnitude         != actual.magnitude )           return mismatch( "magnitude" );
+
+    for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+    {
+        if ( expected.stems[stemI]   != actual.stems[stemI] )       return mismatch( fmt::format( FMTX( "stems[{}]" ), stemI ) );
+        if ( expected.stemsOn[stemI] != actual.stemsOn[stemI] )     return mismatch( fmt::format( FMTX( "stemsOn[{}]" ), stemI ) );
+        if ( expected.gains[stemI]   != actual.gains[stemI] )       return mismatch( fmt::format( FMTX( "gains[{}]" ), stemI ) );
+    }
+    return absl::OkStatus();
+}
+
+static absl::Status compareStems( const endlesss::types::Stem& expected, const endlesss::types::Stem& actual )
+{
+    const auto mismatch = [&]( std::string_view field )
+    {
+        return absl::DataLossError( fmt::format( FMTX( "stem [{}] differs in {}" ), expected.couchID, field ) );
+    };
+
+    if ( expected.couchID           != actual.couchID )             return mismatch( "couchID" );
+    if ( expected.jamCouchID        != actual.jamCouchID )          return mismatch( "jamCouchID" );
+    if ( expected.fileEndpoint      != actual.fileEndpoint )        return mismatch( "fileEndpoint" );
+    if ( expected.fileBucket        != actual.fileBucket )          return mismatch( "fileBucket" );
+    if ( expected.fileKey           != actual.fileKey )             return mismatch( "fileKey" );
+    if ( expected.fileMIME          != actual.fileMIME )            return mismatch( "fileMIME" );
+    if ( expected.fileLengthBytes   != actual.fileLengthBytes )     return mismatch( "fileLengthBytes" );
+    if ( expected.sampleRate        != actual.sampleRate )          return mismatch( "sampleRate" );
+    if ( expected.creationTimeUnix  != actual.creationTimeUnix )    return mismatch( "creationTimeUnix" );
+    if ( expected.preset            != actual.preset )              return mismatch( "preset" );
+    if ( expected.user              != actual.user )                return mismatch( "user" );
+    if ( expected.colour            != actual.colour )              return mismatch( "colour" );
+    if ( expected.BPS               != actual.BPS )                 return mismatch( "BPS" );
+    if ( expected.BPMrnd            != actual.BPMrnd )              return mismatch( "BPMrnd" );
+    if ( expected.length16s         != actual.length16s )           return mismatch( "length16s" );
+    if ( expected.originalPitch     != actual.originalPitch )       return mismatch( "originalPitch" );
+    if ( expected.barLength         != actual.barLength )           return mismatch( "barLength" );
+    if ( expected.isDrum            != actual.isDrum ||
+         expected.isNote            != actual.isNote ||
+         expected.isBass            != actual.isBass ||
+         expected.isMic             != actual.isMic )               return mismatch( "instrument" );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// shared by every check; the warehouse is only created if a check asks for it, and then shared between them all, as
+// sqlite can only ever open one database file per process
+struct SelfCheckContext
+{
+    DECLARE_NO_COPY_NO_MOVE( SelfCheckContext );
+
+    SelfCheckContext( Environment& environment )
+        : m_env( environment )
+    {
+    }
+
+    ~SelfCheckContext()
+    {
+        if ( m_warehouse != nullptr )
+            m_warehouse->clearAllCallbacks();
+    }
+
+    absl::StatusOr< endlesss::toolkit::Warehouse* > getWarehouse()
+    {
+        if ( m_warehouse == nullptr )
+        {
+            auto warehouseResult = m_env.createWarehouse();
+            if ( !warehouseResult.ok() )
+                return warehouseResult.status();
+
+            m_warehouse = std::move( warehouseResult.value() );
+        }
+        return m_warehouse.get();
+    }
+
+    Environment&                                        m_env;
+    std::unique_ptr< endlesss::toolkit::Warehouse >     m_warehouse;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct ArchiveContents
+{
+    endlesss::toolkit::archive::Header      m_header;
+    std::vector< endlesss::types::Riff >    m_riffs;
+    std::vector< endlesss::types::Stem >    m_stems;
+};
+
+// a jam's worth of riffs and stems, with creation times in ascending order as the warehouse exports them. with
+// (keepOffStemIDs) some switched-off slots still name the stem that was there, which the archive must preserve but
+// the warehouse has no column for
+static ArchiveContents generateArchiveContents( math::RNG32& rng, const std::size_t riffCount, const std::size_t stemCount, const bool keepOffStemIDs )
+{
+    ArchiveContents contents;
+
+    auto& header = contents.m_header;
+    header.m_exportTimeUnix     = 1700000000;
+    header.m_exportOuroVersion  = "selfcheck";
+    header.m_jamName            = fmt::format( FMTX( "Self Check {:04x}" ), rng.genUInt32() & 0xFFFF );
+    header.m_jamCouchID         = endlesss::types::JamCouchID{ "band" + generateCouchID( rng ).substr( 0, 10 ) };
+
+    uint64_t creationTime = 1600000000;
+
+    contents.m_stems.resize( stemCount );
+    for ( auto& stem : contents.m_stems )
+    {
+        stem.couchID            = endlesss::types::StemCouchID{ generateCouchID( rng ) };
+        stem.jamCouchID         = header.m_jamCouchID;
+        stem.fileEndpoint       = "localhost";
+        stem.fileBucket         = ( rng.genFloat() < 0.3f ) ? "bucket" : "";
+        stem.fileKey            = fmt::format( FMTX( "attachments/oggAudio/{}" ), stem.couchID );
+        stem.fileMIME           = ( rng.genFloat() < 0.5f ) ? "audio/ogg" : "audio/flac";
+        stem.fileLengthBytes    = (uint32_t)rng.genInt32( 1000, 2000000 );
+        stem.sampleRate         = ( rng.genFloat() < 0.5f ) ? 44100 : 48000;
+        stem.creationTimeUnix   = ( creationTime += (uint64_t)rng.genInt32( 1, 90 ) );
+        stem.preset             = ( rng.genFloat() < 0.5f ) ? fmt::format( FMTX( "preset {}" ), rng.genInt32( 0, 99 ) ) : "";
+        stem.user               = fmt::format( FMTX( "user_{:02}" ), rng.genInt32( 0, 15 ) );
+        stem.colour             = fmt::format( FMTX( "{:06x}" ), rng.genUInt32() & 0xFFFFFF );
+        stem.BPS                = rng.genFloat( 1.0f, 3.0f );
+        stem.BPMrnd             = stem.BPS * 60.0f;
+        stem.length16s          = (float)rng.genInt32( 1, 256 );
+        stem.originalPitch      = rng.genFloat( -12.0f, 12.0f );
+        stem.barLength          = 16.0f;
+
+        const uint32_t instrument = rng.genUInt32();
+        stem.isDrum             = ( instrument & 1 ) != 0;
+        stem.isNote             = ( instrument & 2 ) != 0;
+        stem.isBass             = ( instrument & 4 ) != 0;
+        stem.isMic              = ( instrument & 8 ) != 0;
+    }
+
+    creationTime = 1600000000;
+
+    contents.m_riffs.resize( riffCount );
+    for ( auto& riff : contents.m_riffs )
+    {
+        riff.couchID            = endlesss::types::RiffCouchID{ generateCouchID( rng ) };
+        riff.jamCouchID         = header.m_jamCouchID;
+        riff.user               = fmt::format( FMTX( "user_{:02}" ), rng.genInt32( 0, 15 ) );
+        riff.creationTimeUnix   = ( creationTime += (uint64_t)rng.genInt32( 1, 90 ) );
+        riff.root               = (uint32_t)rng.genInt32( 0, 11 );
+        riff.scale              = (uint32_t)rng.genInt32( 0, 17 );
+        riff.BPS                = rng.genFloat( 1.0f, 3.0f );
+        riff.BPMrnd             = riff.BPS * 60.0f;
+        riff.barLength          = 16.0f;
+        riff.appVersion         = (uint32_t)rng.genInt32( 1, 100000 );
+        riff.magnitude          = rng.genFloat();
+
+        for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+        {
+            // slots can be empty, on, or (optionally) off while still naming the stem that was there
+            const float slotRoll = rng.genFloat();
+            if ( slotRoll < 0.2f || ( !keepOffStemIDs && slotRoll < 0.4f ) )
+                continue;
+
+            riff.stems[stemI]   = contents.m_stems[ rng.genInt32( 0, (int32_t)stemCount - 1 ) ].couchID;
+            riff.stemsOn[stemI] = ( slotRoll >= 0.4f );
+            riff.gains[stemI]   = rng.genFloat();
+        }
+    }
+
+    return contents;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static absl::Status writeArchive( const fs::path& archiveFile, const ArchiveContents& contents )
+{
+    endlesss::toolkit::archive::Writer writer( nullptr );
+    if ( const auto openStatus = writer.open( archiveFile, contents.m_header ); !openStatus.ok() )
+        return openStatus;
+
+    for ( const auto& stem : contents.m_stems )
+    {
+        if ( const auto appendStatus = writer.appendStem( stem ); !appendStatus.ok() )
+            return appendStatus;
+    }
+    for ( const auto& riff : contents.m_riffs )
+    {
+        if ( const auto appendStatus = writer.appendRiff( riff ); !appendStatus.ok() )
+            return appendStatus;
+    }
+    return writer.finish();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// read (archiveFile) back and check it holds exactly (expected), in the same order
+static absl::Status verifyArchive( const fs::path& archiveFile, const ArchiveContents& expected )
+{
+    endlesss::toolkit::archive::Reader reader( nullptr );
+    if ( const auto openStatus = reader.open( archiveFile ); !openStatus.ok() )
+        return openStatus;
+
+    if ( reader.getHeader().m_jamName    != expected.m_header.m_jamName ||
+         reader.getHeader().m_jamCouchID != expected.m_header.m_jamCouchID )
+    {
+        return absl::DataLossError( "archive header did not survive the round trip" );
+    }
+
+    std::vector< endlesss::types::Riff > readRiffs;
+    std::vector< endlesss::types::Stem > readStems;
+    std::size_t riffIndex = 0;
+    std::size_t stemIndex = 0;
+
+    for ( ;; )
+    {
+        const auto blockResult = reader.readNextBlock( readRiffs, readStems );
+        if ( !blockResult.ok() )
+            return blockResult.status();
+        if ( !blockResult.value() )
+            break;
+
+        for ( const auto& riff : readRiffs )
+        {
+            if ( riffIndex >= expected.m_riffs.size() )
+                return absl::DataLossError( "archive holds more riffs than expected" );
+            if ( const auto riffStatus = compareRiffs( expected.m_riffs[riffIndex++], riff ); !riffStatus.ok() )
+                return riffStatus;
+        }
+        for ( const auto& stem : readStems )
+        {
+            if ( stemIndex >= expected.m_stems.size() )
+                return absl::DataLossError( "archive holds more stems than expected" );
+            if ( const auto stemStatus = compareStems( expected.m_stems[stemIndex++], stem ); !stemStatus.ok() )
+                return stemStatus;
+        }
+    }
+
+    if ( riffIndex != expected.m_riffs.size() || stemIndex != expected.m_stems.size() )
+    {
+        return absl::DataLossError( fmt::format( FMTX( "archive held {} / {} riffs, {} / {} stems" ),
+            riffIndex, expected.m_riffs.size(), stemIndex, expected.m_stems.size() ) );
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// archive writer -> reader, with enough rows to span several blocks; then a corrupted block header
+static absl::Status checkJamArchiveRoundTrip( SelfCheckContext& context )
+{
+    namespace archive = endlesss::toolkit::archive;
+
+    math::RNG32 rng( cSelfCheckSeed ^ 0xA4C1 );
+
+    const ArchiveContents contents = generateArchiveContents( rng, ( archive::cRowsPerBlock * 2 ) + 17, archive::cRowsPerBlock + 5, true );
+
+    const fs::path archiveFile = context.m_env.m_workingRoot / fmt::format( FMTX( "roundtrip.{}" ), archive::cFileExtension );
+    if ( const auto writeStatus = writeArchive( archiveFile, contents ); !writeStatus.ok() )
+        return writeStatus;
+
+    if ( const auto verifyStatus = verifyArchive( archiveFile, contents ); !verifyStatus.ok() )
+        return verifyStatus;
+
+    // a block header claiming far more rows than its payload holds has to be rejected as corrupt before anything is
+    // sized from it; patch the row count of the first block after META (16 byte file header, 32 byte block headers)
+    {
+        std::fstream patchStream( archiveFile, std::ios::in | std::ios::out | std::ios::binary );
+
+        uint32_t metaStoredSize = 0;
+        patchStream.seekg( 16 + 12 );
+        patchStream.read( reinterpret_cast<char*>( &metaStoredSize ), sizeof( metaStoredSize ) );
+
+        const uint32_t hugeRowCount = 0x7fffffff;
+        patchStream.seekp( 16 + 32 + metaStoredSize + 4 );
+        patchStream.write( reinterpret_cast<const char*>( &hugeRowCount ), sizeof( hugeRowCount ) );
+
+        if ( !patchStream.good() )
+            return absl::InternalError( "unable to patch archive block header" );
+    }
+
+    archive::Reader reader( nullptr );
+    if ( const auto openStatus = reader.open( archiveFile ); !openStatus.ok() )
+        return openStatus;
+
+    std::vector< endlesss::types::Riff > readRiffs;
+    std::vector< endlesss::types::Stem > readStems;
+    if ( const auto blockResult = reader.readNextBlock( readRiffs, readStems ); !absl::IsDataLoss( blockResult.status() ) )
+        return absl::InternalError( fmt::format( FMTX( "patched row count; expected data loss, got {}" ), blockResult.status().ToString() ) );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// import an archive into the warehouse, export the jam again and check the export matches what went in
+static absl::Status checkJamExportImportRoundTrip( SelfCheckContext& context )
+{
+    namespace archive = endlesss::toolkit::archive;
+    using Warehouse = endlesss::toolkit::Warehouse;
+
+    auto warehouseResult = context.getWarehouse();
+    if ( !warehouseResult.ok() )
+        return warehouseResult.status();
+    Warehouse& warehouse = *warehouseResult.value();
+
+    math::RNG32 rng( cSelfCheckSeed ^ 0xE1B0 );
+
+    const ArchiveContents contents = generateArchiveContents( rng, archive::cRowsPerBlock + 100, 600, false );
+
+    const fs::path sourceFile = context.m_env.m_workingRoot / fmt::format( FMTX( "import.{}" ), archive::cFileExtension );
+    if ( const auto writeStatus = writeArchive( sourceFile, contents ); !writeStatus.ok() )
+        return writeStatus;
+
+    const fs::path exportFolder = context.m_env.m_workingRoot / "export";
+    if ( const auto dirStatus = filesys::ensureDirectoryExists( exportFolder ); !dirStatus.ok() )
+        return dirStatus;
+
+    std::ignore = warehouse.requestJamDataImport( sourceFile );
+    std::ignore = warehouse.requestJamDataExport( contents.m_header.m_jamCouchID, exportFolder, contents.m_header.m_jamName );
+
+    const auto jamSlice = Environment::fetchJamSlice( warehouse, contents.m_header.m_jamCouchID );
+    if ( jamSlice == nullptr || jamSlice->size() != contents.m_riffs.size() )
+        return absl::DataLossError( "import did not produce the expected riffs" );
+
+    const fs::path exportFile = exportFolder / Warehouse::createExportFilenameForJam( contents.m_header.m_jamCouchID, contents.m_header.m_jamName, archive::cFileExtension );
+
+    return verifyArchive( exportFile, contents );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// check the stem user hashes in a jam slice against the users the riffs' stems should have
+static absl::Status verifySliceStemUsers( const endlesss::toolkit::Warehouse::JamSlice& slice, const ArchiveContents& contents, const absl::flat_hash_map< std::string, std::string >& stemUsers )
+{
+    const absl::Hash< std::string_view > nameHasher;
+
+    absl::flat_hash_map< std::string, const endlesss::types::Riff* > riffsByID;
+    for ( const auto& riff : contents.m_riffs )
+        riffsByID.emplace( riff.couchID.value(), &riff );
+
+    for ( std::size_t sliceI = 0; sliceI < slice.size(); sliceI++ )
+    {
+        const auto riffIt = riffsByID.find( slice.m_ids[sliceI].value() );
+        if ( riffIt == riffsByID.end() )
+            return absl::DataLossError( fmt::format( FMTX( "slice holds unknown riff [{}]" ), slice.m_ids[sliceI] ) );
+
+        const endlesss::types::Riff& riff = *riffIt->second;
+        for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+        {
+            const auto userIt = stemUsers.find( riff.stems[stemI].value() );
+            const std::string_view expectedUser = ( userIt != stemUsers.end() ) ? std::string_view( userIt->second ) : std::string_view();
+
+            if ( slice.m_stemUserHashes[sliceI][stemI] != nameHasher( expectedUser ) )
+            {
+                return absl::DataLossError( fmt::format( FMTX( "riff [{}] slot {} does not carry user '{}'" ), riff.couchID, stemI, expectedUser ) );
+            }
+        }
+    }
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// re-import a jam's stems with some of their users changed; the riff projection has to re-patch rows it had already
+// resolved, and the slice cache has to notice and throw away the slice it built from the old names
+static absl::Status checkRiffProjectionStemUserChange( SelfCheckContext& context )
+{
+    namespace archive = endlesss::toolkit::archive;
+    using Warehouse = endlesss::toolkit::Warehouse;
+
+    auto warehouseResult = context.getWarehouse();
+    if ( !warehouseResult.ok() )
+        return warehouseResult.status();
+    Warehouse& warehouse = *warehouseResult.value();
+
+    math::RNG32 rng( cSelfCheckSeed ^ 0x5753 );
+
+    const ArchiveContents contents = generateArchiveContents( rng, 800, 200, false );
+    const endlesss::types::JamCouchID& jamID = contents.m_header.m_jamCouchID;
+
+    absl::flat_hash_map< std::string, std::string > stemUsers;
+    for ( const auto& stem : contents.m_stems )
+        stemUsers.emplace( stem.couchID.value(), stem.user );
+
+    const fs::path originalFile = context.m_env.m_workingRoot / fmt::format( FMTX( "users.0.{}" ), archive::cFileExtension );
+    if ( const auto writeStatus = writeArchive( originalFile, contents ); !writeStatus.ok() )
+        return writeStatus;
+
+    std::ignore = warehouse.requestJamDataImport( originalFile );
+
+    const Warehouse::JamSlicePtr originalSlice = Environment::fetchJamSlice( warehouse, jamID );
+    if ( originalSlice == nullptr || originalSlice->size() != contents.m_riffs.size() )
+        return absl::DataLossError( "import did not produce the expected riffs" );
+    if ( const auto userStatus = verifySliceStemUsers( *originalSlice, contents, stemUsers ); !userStatus.ok() )
+        return userStatus;
+
+    // second archive carries only stems, so no riff rows are rewritten and only the stem triggers can fix things up
+    ArchiveContents renamed;
+    renamed.m_header = contents.m_header;
+    for ( const auto& stem : contents.m_stems )
+    {
+        if ( rng.genFloat() < 0.25f )
+        {
+            auto& renamedStem = renamed.m_stems.emplace_back( stem );
+            renamedStem.user = fmt::format( FMTX( "renamed_{}" ), stem.user );
+            stemUsers[ stem.couchID.value() ] = renamedStem.user;
+        }
+    }
+
+    const fs::path renamedFile = context.m_env.m_workingRoot / fmt::format( FMTX( "users.1.{}" ), archive::cFileExtension );
+    if ( const auto writeStatus = writeArchive( renamedFile, renamed ); !writeStatus.ok() )
+        return writeStatus;
+
+    std::ignore = warehouse.requestJamDataImport( renamedFile );
+
+    // slice requests capture the jam's change index when queued; the first one waits out the import, the second sees
+    // the change index it left behind
+    std::ignore = Environment::fetchJamSlice( warehouse, jamID );
+    const Warehouse::JamSlicePtr renamedSlice = Environment::fetchJamSlice( warehouse, jamID );
+    if ( renamedSlice == nullptr || renamedSlice->size() != contents.m_riffs.size() )
+        return absl::DataLossError( "stem re-import changed the riff count" );
+
+    return verifySliceStemUsers( *renamedSlice, contents, stemUsers );
+}
+// ---------------------------------------------------------------------------------------------------------------------
+// seeded riff picks for the weaver must fill every slot even when the BPM bucket is smaller than the request, and the
+// same seed must keep producing the same picks
+static absl::Status checkSeededRiffSampling( SelfCheckContext& context )
+{
+    namespace archive = endlesss::toolkit::archive;
+    using Warehouse = endlesss::toolkit::Warehouse;
+
+    // a BPM none of the other generated jams can reach, so this jam's riffs are the only candidates
+    static constexpr uint32_t       cSamplingBPM        = 251;
+    static constexpr std::size_t    cSamplingRiffs      = 3;
+    static constexpr std::size_t    cSamplingSlots      = 8;
+
+    auto warehouseResult = context.getWarehouse();
+    if ( !warehouseResult.ok() )
+        return warehouseResult.status();
+    Warehouse& warehouse = *warehouseResult.value();
+
+    math::RNG32 rng( cSelfCheckSeed ^ 0x5A3B );
+
+    ArchiveContents contents = generateArchiveContents( rng, cSamplingRiffs, 16, false );
+    for ( auto& riff : contents.m_riffs )
+    {
+        riff.BPMrnd = (float)cSamplingBPM;
+        riff.BPS    = riff.BPMrnd / 60.0f;
+    }
+
+    const fs::path sourceFile = context.m_env.m_workingRoot / fmt::format( FMTX( "sampling.{}" ), archive::cFileExtension );
+    if ( const auto writeStatus = writeArchive( sourceFile, contents ); !writeStatus.ok() )
+        return writeStatus;
+
+    std::ignore = warehouse.requestJamDataImport( sourceFile );
+    if ( const auto jamSlice = Environment::fetchJamSlice( warehouse, contents.m_header.m_jamCouchID ); jamSlice == nullptr || jamSlice->size() != cSamplingRiffs )
+        return absl::DataLossError( "import did not produce the expected riffs" );
+
+    endlesss::constants::RootScalePairs searchPairs;
+    searchPairs.searchMode = endlesss::constants::HarmonicSearch::NoRules;
+
+    const auto samplePicks = [&]( const int32_t seedValue, std::vector< endlesss::types::RiffCouchID >& picks ) -> absl::Status
+    {
+        std::vector< endlesss::types::RiffComplete > riffs;
+        const std::size_t fetched = warehouse.fetchRandomRiffsBySeed( searchPairs, cSamplingBPM, seedValue, cSamplingSlots, riffs );
+        if ( fetched != cSamplingSlots )
+            return absl::DataLossError( fmt::format( FMTX( "seed {} filled {} of {} slots from a bucket of {}" ), seedValue, fetched, cSamplingSlots, cSamplingRiffs ) );
+
+        picks.clear();
+        for ( const auto& riff : riffs )
+        {
+            const bool fromBucket = std::any_of( contents.m_riffs.begin(), contents.m_riffs.end(), [&]( const endlesss::types::Riff& candidate )
+                {
+                    return candidate.couchID == riff.riff.couchID;
+                });
+            if ( !fromBucket )
+                return absl::DataLossError( fmt::format( FMTX( "seed {} picked riff [{}] from outside the bucket" ), seedValue, riff.riff.couchID ) );
+
+            picks.emplace_back( riff.riff.couchID );
+        }
+        return absl::OkStatus();
+    };
+
+    std::vector< endlesss::types::RiffCouchID > firstPicks, repeatPicks;
+    for ( int32_t seedI = 0; seedI < 32; seedI++ )
+    {
+        const int32_t seedValue = rng.genInt32();
+
+        if ( const auto pickStatus = samplePicks( seedValue, firstPicks ); !pickStatus.ok() )
+            return pickStatus;
+        if ( const auto pickStatus = samplePicks( seedValue, repeatPicks ); !pickStatus.ok() )
+            return pickStatus;
+
+        if ( firstPicks != repeatPicks )
+            return absl::DataLossError( fmt::format( FMTX( "seed {} picked different riffs on a second run" ), seedValue ) );
+    }
+
+    return absl::OkStatus();
+}
+// ---------------------------------------------------------------------------------------------------------------------
+// poll (predicate) until it holds or (timeout) passes; for checks that watch other threads make progress
+template< typename _Predicate >
+static bool waitUntil( _Predicate predicate, const std::chrono::milliseconds timeout )
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while ( !predicate() )
+    {
+        if ( std::chrono::steady_clock::now() > deadline )
+            return false;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// riff-push client and server talking over localhost; pushes queued before connecting must be batched into frames,
+// acknowledged, and - when acks go missing across a reconnect - resent without the server playing them twice. uses
+// the fixed BOND port, so will fail if a BEAM instance is already serving on this machine
+static absl::Status checkRiffPushLoopback( SelfCheckContext& context )
+{
+    static constexpr std::size_t    cEntriesPerFrame    = 32;       // the binary protocol's per-frame limit
+    static constexpr std::size_t    cBatchedPushes      = 70;       // spans three frames
+    static constexpr std::size_t    cResentPushes       = 40;       // two frames, both resent
+    static constexpr auto           cTimeout            = std::chrono::milliseconds( 5000 );
+
+    math::RNG32 rng( cSelfCheckSeed ^ 0xB04D );
+
+    const endlesss::types::JamCouchID jamID{ "band" + generateCouchID( rng ).substr( 0, 10 ) };
+
+    std::vector< endlesss::types::RiffCouchID > sentRiffs;
+    for ( std::size_t pushI = 0; pushI < cBatchedPushes + cResentPushes; pushI++ )
+        sentRiffs.emplace_back( generateCouchID( rng ) );
+
+    std::mutex receivedMutex;
+    std::vector< endlesss::types::RiffCouchID > receivedRiffs;
+
+    const auto receivedCount = [&]()
+    {
+        std::scoped_lock<std::mutex> receivedLock( receivedMutex );
+        return receivedRiffs.size();
+    };
+
+    net::bond::RiffPushServer server;
+    server.setRiffPushedCallback( [&]( const endlesss::types::JamCouchID&, const endlesss::types::RiffCouchID& riffID, const endlesss::types::RiffPlaybackPermutationOpt& )
+        {
+            std::scoped_lock<std::mutex> receivedLock( receivedMutex );
+            receivedRiffs.emplace_back( riffID );
+        });
+    if ( const auto startStatus = server.start(); !startStatus.ok() )
+        return startStatus;
+
+    net::bond::RiffPushClient client( "selfcheck" );
+
+    // the client's network thread winds down after a disconnect; keep trying until it will take a new connection
+    const auto connectClient = [&]() -> absl::Status
+    {
+        absl::Status connectStatus;
+        const bool connected = waitUntil( [&]()
+            {
+                connectStatus = client.connect( "ws://localhost:9002" );
+                return connectStatus.ok();
+            }, cTimeout );
+        return connected ? absl::OkStatus() : connectStatus;
+    };
+    const auto disconnectClient = [&]() -> absl::Status
+    {
+        std::ignore = client.disconnect();
+        if ( !waitUntil( [&]() { return client.getState() == net::bond::BondState::Disconnected; }, cTimeout ) )
+            return absl::DeadlineExceededError( "client did not disconnect" );
+        return absl::OkStatus();
+    };
+
+    const auto runChecks = [&]() -> absl::Status
+    {
+        // server needs a moment to start listening
+        if ( !waitUntil( [&]() { return server.getState() == net::bond::BondState::Connected; }, cTimeout ) )
+            return absl::DeadlineExceededError( "server did not start" );
+
+        // queue everything up front so the flush after negotiation has to batch it
+        for ( std::size_t pushI = 0; pushI < cBatchedPushes; pushI++ )
+        {
+            if ( const auto pushStatus = client.pushRiffById( jamID, sentRiffs[pushI], std::nullopt ); !pushStatus.ok() )
+                return pushStatus;
+        }
+        if ( const auto connectStatus = connectClient(); !connectStatus.ok() )
+            return connectStatus;
+
+        if ( !waitUntil( [&]() { return client.getPendingPushCount() == 0; }, cTimeout ) )
+            return absl::DeadlineExceededError( fmt::format( FMTX( "batched pushes never acknowledged, {} still pending" ), client.getPendingPushCount() ) );
+        if ( client.getProtocol() != net::bond::RiffPushProtocol::Binary )
+            return absl::FailedPreconditionError( "client did not negotiate the binary protocol" );
+
+        const auto batchedStats = server.getStatistics();
+        const std::size_t expectedFrames = ( cBatchedPushes + cEntriesPerFrame - 1 ) / cEntriesPerFrame;
+        if ( batchedStats.m_framesReceived != expectedFrames )
+            return absl::InternalError( fmt::format( FMTX( "{} pushes arrived in {} frames, expected {}" ), cBatchedPushes, batchedStats.m_framesReceived, expectedFrames ) );
+
+        // queue the next lot while disconnected, then have the server swallow the acks for them
+        if ( const auto disconnectStatus = disconnectClient(); !disconnectStatus.ok() )
+            return disconnectStatus;
+
+        for ( std::size_t pushI = cBatchedPushes; pushI < sentRiffs.size(); pushI++ )
+        {
+            if ( const auto pushStatus = client.pushRiffById( jamID, sentRiffs[pushI], std::nullopt ); !pushStatus.ok() )
+                return pushStatus;
+        }
+
+        server.dropAcknowledgements( std::numeric_limits<uint32_t>::max() );
+        if ( const auto connectStatus = connectClient(); !connectStatus.ok() )
+            return connectStatus;
+
+        if ( !waitUntil( [&]() { return receivedCount() == sentRiffs.size(); }, cTimeout ) )
+            return absl::DeadlineExceededError( fmt::format( FMTX( "server applied {} of {} pushes" ), receivedCount(), sentRiffs.size() ) );
+        if ( client.getPendingPushCount() != cResentPushes )
+            return absl::InternalError( fmt::format( FMTX( "expected {} unacknowledged pushes, client has {}" ), cResentPushes, client.getPendingPushCount() ) );
+
+        // reconnect with acks flowing again; the held frames go again and must only be acknowledged
+        server.dropAcknowledgements( 0 );
+        if ( const auto disconnectStatus = disconnectClient(); !disconnectStatus.ok() )
+            return disconnectStatus;
+        if ( const auto connectStatus = connectClient(); !connectStatus.ok() )
+            return connectStatus;
+
+        if ( !waitUntil( [&]() { return client.getPendingPushCount() == 0; }, cTimeout ) )
+            return absl::DeadlineExceededError( "resent pushes never acknowledged" );
+
+        const auto resentStats = server.getStatistics();
+        if ( resentStats.m_framesDuplicated == 0 )
+            return absl::InternalError( "server did not see the resent frames" );
+        if ( resentStats.m_pushesApplied != sentRiffs.size() )
+            return absl::InternalError( fmt::format( FMTX( "server applied {} pushes for {} sent" ), resentStats.m_pushesApplied, sentRiffs.size() ) );
+
+        std::scoped_lock<std::mutex> receivedLock( receivedMutex );
+        if ( receivedRiffs != sentRiffs )
+            return absl::DataLossError( "server received pushes out of order or more than once" );
+
+        return absl::OkStatus();
+    };
+
+    const absl::Status checkStatus = runChecks();
+
+    std::ignore = client.disconnect();
+    server.clearRiffPushedCallback();
+    std::ignore = server.stop();
+
+    return checkStatus;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// one API response body, decoded through both the streaming decoder and the original regex + cereal path
+struct JsonCorpusEntry
+{
+    std::string     m_name;
+    std::string     m_body;
+    std::string     m_cerealEquivalent;     // empty if the fix-up path reads m_body itself; otherwise m_body is one it
+                                            // rejects, and this is the body it would need to agree with the decoder
+    bool            m_rejected = false;     // malformed, both paths must refuse it
+};
+
+// every entry must decode to the same canonical JSON both ways; entries with a cereal equivalent also pin down that
+// the fix-up path still refuses the original, so a quirk is noticed if the two paths ever start to agree on it
+template< typename _Type >
+static absl::Status checkJsonCorpus(
+    const endlesss::api::NetConfiguration&          netConfig,
+    const std::function< void( std::string& ) >&    bodyTextFixups,
+    const std::vector< JsonCorpusEntry >&           corpus )
+{
+    namespace api = endlesss::api;
+
+    const auto decodeWithFixups = [&]( const std::string& body, _Type& instance ) -> absl::Status
+    {
+        try
+        {
+            api::detail::decodeWithCereal( api::detail::applyBodyTextFixups( netConfig, body, bodyTextFixups ), instance );
+        }
+        catch ( cereal::Exception& cEx )
+        {
+            return absl::InvalidArgumentError( cEx.what() );
+        }
+        return absl::OkStatus();
+    };
+
+    for ( const auto& entry : corpus )
+    {
+        _Type streamed{};
+        api::json::Decoder decoder;
+        const bool streamedOk = decoder.decode( entry.m_body, streamed );
+
+        _Type reference{};
+        const absl::Status referenceStatus = decodeWithFixups( entry.m_body, reference );
+
+        if ( entry.m_rejected )
+        {
+            if ( streamedOk )
+                return absl::InternalError( fmt::format( FMTX( "[{}] streaming decode accepted a malformed document" ), entry.m_name ) );
+            if ( referenceStatus.ok() )
+                return absl::InternalError( fmt::format( FMTX( "[{}] fix-up decode accepted a malformed document" ), entry.m_name ) );
+            continue;
+        }
+
+        if ( !streamedOk )
+            return absl::InternalError( fmt::format( FMTX( "[{}] streaming decode failed; {}" ), entry.m_name, decoder.getError() ) );
+
+        if ( !entry.m_cerealEquivalent.empty() )
+        {
+            if ( referenceStatus.ok() )
+                return absl::InternalError( fmt::format( FMTX( "[{}] fix-up decode now accepts this body, the quirk entry is out of date" ), entry.m_name ) );
+
+            reference = _Type{};
+            if ( const auto equivalentStatus = decodeWithFixups( entry.m_cerealEquivalent, reference ); !equivalentStatus.ok() )
+                return absl::InternalError( fmt::format( FMTX( "[{}] fix-up decode of the equivalent failed; {}" ), entry.m_name, equivalentStatus.ToString() ) );
+        }
+        else if ( !referenceStatus.ok() )
+        {
+            return absl::InternalError( fmt::format( FMTX( "[{}] fix-up decode failed; {}" ), entry.m_name, referenceStatus.ToString() ) );
+        }
+
+        const std::string streamedJson  = api::detail::toCanonicalJson( streamed );
+        const std::string referenceJson = api::detail::toCanonicalJson( reference );
+        if ( streamedJson != referenceJson )
+        {
+            return absl::DataLossError( fmt::format( FMTX( "[{}] decodes differ\n-- streaming --\n{}\n-- fix-up --\n{}" ),
+                entry.m_name, streamedJson, referenceJson ) );
+        }
+    }
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// hand-written bodies covering each data quirk json::Decoder deals with inline, plus a large seeded riff batch written
+// out by cereal itself, all decoded both ways
+static absl::Status checkStreamingJsonDecode( SelfCheckContext& context )
+{
+    namespace api = endlesss::api;
+
+    static constexpr std::size_t cGeneratedRiffs = 200;
+
+    // {0} is the playback array, {1} the userName value, {2} anything else to add to the document
+    const auto riffDocument = []( std::string_view playback, std::string_view userName, std::string_view extra )
+    {
+        return fmt::format( FMTX( R"({{"id":"riff0001","doc":{{"_id":"riff0001","_rev":"3-9c1d","type":"Loop",)"
+            R"("state":{{"bps":2.25,"barLength":16,"playback":[{}]}},"userName":{},"created":1600000000123,"root":3,"scale":2{}}}}})" ),
+            playback, userName, extra );
+    };
+    const auto riffBatch = [&]( std::string_view playback, std::string_view userName, std::string_view extra = {} )
+    {
+        return fmt::format( FMTX( R"({{"total_rows":4000,"rows":[{}]}})" ), riffDocument( playback, userName, extra ) );
+    };
+
+    static constexpr std::string_view cSlotOn      = R"({"slot":{"current":{"on":true,"currentLoop":"stem0001","gain":0.75}}})";
+    static constexpr std::string_view cSlotOff     = R"({"slot":{"current":{"on":false,"currentLoop":"stem0002","gain":0}}})";
+    static constexpr std::string_view cSlotOnInt   = R"({"slot":{"current":{"on":1,"currentLoop":"stem0001","gain":0.75}}})";
+    static constexpr std::string_view cSlotEmpty   = R"({"slot":{}})";
+
+    std::vector< JsonCorpusEntry > riffCorpus = {
+        { "riff_plain",
+            riffBatch( fmt::format( FMTX( "{},{}" ), cSlotOn, cSlotOff ), R"("ishani")", R"(,"app_version":1,"magnitude":0.5,"unknown":{"nested":[1,{"a":null}]})" ) },
+
+        { "riff_on_as_integer",
+            riffBatch( fmt::format( FMTX( "{},{}" ), cSlotOnInt, cSlotOff ), R"("ishani")" ) },
+
+        // slots are positional; a null one must hold its place as an empty slot
+        { "riff_null_playback_slot",
+            riffBatch( fmt::format( FMTX( "{},null,{}" ), cSlotOn, cSlotOff ), R"("ishani")" ),
+            riffBatch( fmt::format( FMTX( "{},{},{}" ), cSlotOn, cSlotEmpty, cSlotOff ), R"("ishani")" ) },
+
+        // a null currentLoop leaves it empty, and the fix-up after archive() then turns the slot off
+        { "riff_null_current_loop",
+            riffBatch( R"({"slot":{"current":{"on":true,"currentLoop":null,"gain":1}}})", R"("ishani")" ),
+            riffBatch( R"({"slot":{"current":{"on":true,"currentLoop":"","gain":1}}})", R"("ishani")" ) },
+
+        // null satisfies a required key; the decoder counts the key as present and leaves the default where cereal
+        // refuses the document outright
+        { "riff_null_required_key",
+            riffBatch( cSlotOn, "null" ),
+            riffBatch( cSlotOn, R"("")" ) },
+
+        // a required key that is absent altogether is still an error
+        { "riff_missing_required_key",
+            R"({"total_rows":1,"rows":[{"id":"riff0002","doc":{"_id":"riff0002","state":{"bps":2,"barLength":16,"playback":[]},"userName":"ishani","created":1,"scale":2}}]})",
+            {}, true },
+
+        { "riff_truncated",
+            riffBatch( cSlotOn, R"("ishani")" ).substr( 0, 120 ),
+            {}, true },
+    };
+
+    // a large batch written out by cereal, so the corpus also covers whatever cereal itself produces
+    {
+        math::RNG32 rng( cSelfCheckSeed ^ 0x1500 );
+
+        api::RiffDetails generated;
+        generated.total_rows = (uint32_t)cGeneratedRiffs;
+        for ( std::size_t riffI = 0; riffI < cGeneratedRiffs; riffI++ )
+        {
+            auto& row = generated.rows.emplace_back();
+            row.id                      = endlesss::types::RiffCouchID{ generateCouchID( rng ) };
+            row.doc._id                 = row.id;
+            row.doc.userName            = fmt::format( FMTX( "user_{:02}" ), rng.genInt32( 0, 15 ) );
+            row.doc.created             = 1600000000000ULL + (uint64_t)rng.genInt32( 0, 1 << 30 );
+            row.doc.root                = rng.genInt32( 0, 11 );
+            row.doc.scale               = rng.genInt32( 0, 17 );
+            row.doc.app_version         = rng.genInt32( 1, 100000 );
+            row.doc.magnitude           = rng.genFloat();
+            row.doc.state.bps           = rng.genFloat( 1.0f, 3.0f );
+            row.doc.state.barLength     = 16.0f;
+
+            for ( std::size_t slotI = 0; slotI < 8; slotI++ )
+            {
+                auto& current = row.doc.state.playback.emplace_back().slot.current;
+                if ( rng.genFloat() < 0.3f )
+                    continue;
+
+                current.on          = ( rng.genFloat() < 0.8f );
+                current.currentLoop = generateCouchID( rng );
+                current.gain        = rng.genFloat();
+            }
+        }
+        riffCorpus.push_back( { "riff_generated_batch", api::detail::toCanonicalJson( generated ) } );
+    }
+
+    const std::vector< JsonCorpusEntry > stemCorpus = {
+        // quoted lengths, plus an endpoint carrying a scheme and bucket that the OGG fix-up strips off
+        { "stem_quoted_length",
+            R"({"total_rows":1,"rows":[{"id":"stem0001","doc":{"_id":"stem0001","cdn_attachments":{)"
+            R"("oggAudio":{"endpoint":"https://ndls-att0/ndls-att0.fra1.digitaloceanspaces.com","key":"attachments/oggAudio/band0001/stem0001","url":"https://ndls-att0.fra1.digitaloceanspaces.com/attachments/oggAudio/band0001/stem0001","length":"37747"},)"
+            R"("flacAudio":{"endpoint":"endlesss-dev.fra1.digitaloceanspaces.com","key":"attachments/flacAudio/band0001/stem0001","url":"https://endlesss-dev.fra1.digitaloceanspaces.com/attachments/flacAudio/band0001/stem0001","length":"412800"}},)"
+            R"("bps":2.25,"length16ths":64,"originalPitch":0,"barLength":16,"presetName":"Drums","creatorUserName":"ishani","primaryColour":"ff8c00ff",)"
+            R"("sampleRate":44100,"created":1600000000456,"isDrum":true,"isNote":false,"isBass":false,"isMic":false}}]})" },
+    };
+
+    const std::vector< JsonCorpusEntry > typeCheckCorpus = {
+        // one good stem, one removed for moderation and one deleted, whose doc arrives as null
+        { "type_check_mixed_rows",
+            R"({"total_rows":3,"rows":[)"
+            R"({"key":"stem0001","value":{"rev":"1-ab"},"doc":{"_id":"stem0001","type":"Loop","cdn_attachments":{"oggAudio":{"endpoint":"ndls-att0.fra1.digitaloceanspaces.com"}},"app_version":3}},)"
+            R"({"key":"stem0002","error":"not_found"},)"
+            R"({"key":"stem0003","value":{"rev":"2-cd","deleted":true},"doc":null}]})" },
+    };
+
+    const std::vector< JsonCorpusEntry > changesCorpus = {
+        { "jam_changes",
+            R"({"results":[{"seq":"1-g1AAAA","id":"riff0001","changes":[{"rev":"1-ab"}]},{"seq":"2-g1AAAB","id":"stem0001","changes":[{"rev":"2-cd"}],"deleted":true}],"last_seq":"2-g1AAAB","pending":0})" },
+    };
+
+    const api::NetConfiguration& netConfig = *context.m_env.m_networkConfiguration;
+
+    if ( const auto status = checkJsonCorpus< api::RiffDetails >( netConfig, &api::RiffDetails::applyBatchQuirkFixes, riffCorpus ); !status.ok() )
+        return status;
+    if ( const auto status = checkJsonCorpus< api::StemDetails >( netConfig, nullptr, stemCorpus ); !status.ok() )
+        return status;
+    if ( const auto status = checkJsonCorpus< api::StemTypeCheck >( netConfig, nullptr, typeCheckCorpus ); !status.ok() )
+        return status;
+    if ( const auto status = checkJsonCorpus< api::JamChanges >( netConfig, nullptr, changesCorpus ); !status.ok() )
+        return status;
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// allocate and free through every mem:: tag, from several threads at once, and expect each tag's live counters to come
+// back exactly to where they started. counters are read raw rather than through takeSnapshot() so that sqlite's own
+// books, folded into the Warehouse tag there, can't move underneath the comparison
+static absl::Status checkMemoryTagAccounting( SelfCheckContext& context )
+{
+    static constexpr std::size_t    cTasksPerTag        = 4;
+    static constexpr std::size_t    cBlocksPerTask      = 64;
+
+    struct LiveCounts
+    {
+        int64_t     m_bytes         = 0;
+        int64_t     m_allocations   = 0;
+
+        bool operator==( const LiveCounts& rhs ) const { return m_bytes == rhs.m_bytes && m_allocations == rhs.m_allocations; }
+        bool operator!=( const LiveCounts& rhs ) const { return !( *this == rhs ); }
+    };
+    const auto readCounts = []()
+    {
+        std::array< LiveCounts, mem::cTagCount > result;
+        for ( std::size_t tagI = 0; tagI < mem::cTagCount; tagI++ )
+        {
+            result[tagI].m_bytes        = mem::detail::gTagCounters[tagI].m_bytes.load( std::memory_order_relaxed );
+            result[tagI].m_allocations  = mem::detail::gTagCounters[tagI].m_allocations.load( std::memory_order_relaxed );
+        }
+        return result;
+    };
+    const auto describe = []( const std::size_t tagI, const LiveCounts& expected, const LiveCounts& actual )
+    {
+        return fmt::format( FMTX( "tag {} has {} bytes in {} allocations, expected {} bytes in {}" ),
+            mem::cTagNames[tagI], actual.m_bytes, actual.m_allocations, expected.m_bytes, expected.m_allocations );
+    };
+
+    // each allocator pairs with free16 under the same tag; vary the sizes so rpmalloc's size classes all get a look
+    const auto allocateAndFree = []( const mem::Tag tag, const uint32_t seed )
+    {
+        math::RNG32 rng( seed );
+
+        std::array< void*, cBlocksPerTask > blocks;
+        for ( std::size_t blockI = 0; blockI < cBlocksPerTask; blockI++ )
+        {
+            const std::size_t elements = (std::size_t)rng.genInt32( 1, 64 * 1024 );
+            switch ( blockI % 3 )
+            {
+                case 0:  blocks[blockI] = mem::alloc16< float >( elements, tag );                   break;
+                case 1:  blocks[blockI] = mem::alloc16To< uint8_t >( elements, 0xAA, tag );        break;
+                default: blocks[blockI] = mem::allocAligned< double >( 64, elements, tag );         break;
+            }
+        }
+        for ( void* block : blocks )
+            mem::free16( block, tag );
+    };
+
+    const auto baseline = readCounts();
+
+    // every tag from several threads at once, the counters must be exact once it all settles
+    {
+        tf::Taskflow taskflow;
+        for ( std::size_t tagI = 0; tagI < mem::cTagCount; tagI++ )
+        {
+            for ( std::size_t taskI = 0; taskI < cTasksPerTag; taskI++ )
+            {
+                const uint32_t taskSeed = cSelfCheckSeed ^ (uint32_t)( ( tagI << 8 ) | taskI );
+                taskflow.emplace( [=]() { allocateAndFree( (mem::Tag)tagI, taskSeed ); } );
+            }
+        }
+        context.m_env.m_taskExecutor.run( taskflow ).wait();
+
+        const auto afterChurn = readCounts();
+        for ( std::size_t tagI = 0; tagI < mem::cTagCount; tagI++ )
+        {
+            if ( afterChurn[tagI] != baseline[tagI] )
+                return absl::InternalError( fmt::format( FMTX( "after concurrent churn, {}" ), describe( tagI, baseline[tagI], afterChurn[tagI] ) ) );
+        }
+    }
+
+    // one allocation per tag, held; only that tag moves, by at least what was asked for
+    for ( std::size_t tagI = 0; tagI < mem::cTagCount; tagI++ )
+    {
+        static constexpr std::size_t cHeldBytes = 3000;
+
+        const auto before = readCounts();
+        uint8_t* held = mem::alloc16< uint8_t >( cHeldBytes, (mem::Tag)tagI );
+        const auto during = readCounts();
+
+        for ( std::size_t otherI = 0; otherI < mem::cTagCount; otherI++ )
+        {
+            if ( otherI == tagI )
+                continue;
+            if ( during[otherI] != before[otherI] )
+                return absl::InternalError( fmt::format( FMTX( "allocating as {} moved {}" ), mem::cTagNames[tagI], describe( otherI, before[otherI], during[otherI] ) ) );
+        }
+        if ( during[tagI].m_allocations != before[tagI].m_allocations + 1 ||
+             during[tagI].m_bytes < before[tagI].m_bytes + (int64_t)cHeldBytes )
+        {
+            mem::free16( held, (mem::Tag)tagI );
+            return absl::InternalError( fmt::format( FMTX( "while held, {}" ), describe( tagI, before[tagI], during[tagI] ) ) );
+        }
+
+        mem::free16( held, (mem::Tag)tagI );
+        if ( const auto after = readCounts(); after[tagI] != before[tagI] )
+            return absl::InternalError( fmt::format( FMTX( "after free, {}" ), describe( tagI, before[tagI], after[tagI] ) ) );
+    }
+
+    // the tag on free16 must be the one used to allocate; a mismatched pair leaves the allocating tag charged and the
+    // freeing tag short by the same amount, which is exactly what this accounting is meant to make visible
+    {
+        static constexpr mem::Tag cAllocTag = mem::Tag::Stems;
+        static constexpr mem::Tag cFreeTag  = mem::Tag::Recorder;
+
+        const auto before = readCounts();
+        float* block = mem::alloc16< float >( 1024, cAllocTag );
+        const int64_t blockBytes = readCounts()[(size_t)cAllocTag].m_bytes - before[(size_t)cAllocTag].m_bytes;
+
+        mem::free16( block, cFreeTag );
+        const auto after = readCounts();
+
+        // square the books again before judging, so a failure here doesn't knock on into anything run later
+        mem::trackFree( cAllocTag, (std::size_t)blockBytes );
+        mem::trackAlloc( cFreeTag, (std::size_t)blockBytes );
+
+        const LiveCounts expectedAlloc{ before[(size_t)cAllocTag].m_bytes + blockBytes, before[(size_t)cAllocTag].m_allocations + 1 };
+        const LiveCounts expectedFree { before[(size_t)cFreeTag].m_bytes  - blockBytes, before[(size_t)cFreeTag].m_allocations  - 1 };
+
+        if ( after[(size_t)cAllocTag] != expectedAlloc )
+            return absl::InternalError( fmt::format( FMTX( "mismatched free, {}" ), describe( (size_t)cAllocTag, expectedAlloc, after[(size_t)cAllocTag] ) ) );
+        if ( after[(size_t)cFreeTag] != expectedFree )
+            return absl::InternalError( fmt::format( FMTX( "mismatched free, {}" ), describe( (size_t)cFreeTag, expectedFree, after[(size_t)cFreeTag] ) ) );
+    }
+
+    const auto settled = readCounts();
+    for ( std::size_t tagI = 0; tagI < mem::cTagCount; tagI++ )
+    {
+        if ( settled[tagI] != baseline[tagI] )
+            return absl::InternalError( fmt::format( FMTX( "at the end, {}" ), describe( tagI, baseline[tagI], settled[tagI] ) ) );
+    }
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// stands in for an endpoint that pages results without saying how many there are; numbered items are served a page at
+// a time after a short, page-dependent delay so that requests really do overlap, with one page optionally failing
+struct StubPageServer
+{
+    static constexpr uint32_t cEndless = std::numeric_limits< uint32_t >::max();
+
+    struct Page
+    {
+        uint32_t                m_index = 0;
+        std::vector< uint32_t > m_items;
+    };
+
+    StubPageServer( const uint32_t pageSize, const uint32_t itemCount, const uint32_t failPage = cEndless )
+        : m_pageSize( pageSize )
+        , m_itemCount( itemCount )
+        , m_failPage( failPage )
+    {}
+
+    bool fetch( const uint32_t pageIndex, Page& page )
+    {
+        m_requests++;
+
+        const uint32_t inFlight = ++m_inFlight;
+        uint32_t peak = m_inFlightPeak.load();
+        while ( inFlight > peak && !m_inFlightPeak.compare_exchange_weak( peak, inFlight ) ) {}
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 + ( pageIndex * 7 ) % 4 ) );
+        m_inFlight--;
+
+        if ( pageIndex == m_failPage )
+            return false;
+
+        page.m_index = pageIndex;
+
+        const uint64_t firstItem = (uint64_t)pageIndex * m_pageSize;
+        for ( uint64_t item = firstItem; item < firstItem + m_pageSize && item < m_itemCount; item++ )
+            page.m_items.emplace_back( (uint32_t)item );
+
+        return true;
+    }
+
+    bool isFinal( const Page& page ) const { return page.m_items.size() < m_pageSize; }
+
+    absl::Status fetchAll(
+        base::WorkScheduler& workScheduler,
+        const base::WorkScheduler::Lane::Enum workLane,
+        const endlesss::toolkit::PagedFetch::Options& options,
+        std::vector< Page >& pagesOut,
+        const endlesss::toolkit::PagedFetch::ProgressCallback& onProgress = nullptr )
+    {
+        return endlesss::toolkit::PagedFetch::fetch< Page >(
+            workScheduler,
+            workLane,
+            options,
+            [this]( const uint32_t pageIndex, Page& page ) { return fetch( pageIndex, page ); },
+            [this]( const Page& page ) { return isFinal( page ); },
+            pagesOut,
+            onProgress );
+    }
+
+    const uint32_t          m_pageSize;
+    const uint32_t          m_itemCount;
+    const uint32_t          m_failPage;
+
+    std::atomic_uint32_t    m_requests      = 0;
+    std::atomic_uint32_t    m_inFlight      = 0;
+    std::atomic_uint32_t    m_inFlightPeak  = 0;
+};
+
+// pages must come back in order, each holding the run of items the server numbered for it
+static absl::Status verifyStubPages( const std::vector< StubPageServer::Page >& pages, const std::size_t expectedPages, const StubPageServer& server )
+{
+    if ( pages.size() != expectedPages )
+        return absl::InternalError( fmt::format( FMTX( "expected {} pages, got {}" ), expectedPages, pages.size() ) );
+
+    uint32_t nextItem = 0;
+    for ( std::size_t pageI = 0; pageI < pages.size(); pageI++ )
+    {
+        if ( pages[pageI].m_index != pageI )
+            return absl::InternalError( fmt::format( FMTX( "page {} holds page {}" ), pageI, pages[pageI].m_index ) );
+
+        for ( const uint32_t item : pages[pageI].m_items )
+        {
+            if ( item != nextItem )
+                return absl::InternalError( fmt::format( FMTX( "page {} has item {}, expected {}" ), pageI, item, nextItem ) );
+            nextItem++;
+        }
+    }
+    if ( server.m_itemCount != StubPageServer::cEndless && nextItem != std::min( server.m_itemCount, (uint32_t)( expectedPages * server.m_pageSize ) ) )
+        return absl::InternalError( fmt::format( FMTX( "{} items returned" ), nextItem ) );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// PagedFetch against a stub server, on a private scheduler so lane limits can be set per case; covers both shapes of
+// final page, a failing page, an endpoint that never ends, cancellation, a fetch made from inside a full lane, and the
+// way the app fetches - from a Sync job with that lane at its narrowest, paging through Prefetch
+static absl::Status checkPagedFetch( SelfCheckContext& context )
+{
+    static constexpr uint32_t cPageSize = 5;
+
+    using Page    = StubPageServer::Page;
+    using Options = endlesss::toolkit::PagedFetch::Options;
+    using Lane    = base::WorkScheduler::Lane;
+
+    base::WorkScheduler workScheduler( std::max( context.m_env.m_workScheduler.getSlotCount(), 6U ) );
+    workScheduler.configureLane( base::WorkScheduler::Lane::Sync, { 0, 4 } );
+
+    Options options;
+    options.m_concurrency = 4;
+
+    // item count an exact multiple of the page size, so the end is marked by an empty page
+    {
+        StubPageServer server( cPageSize, 40 );
+        std::vector< Page > pages;
+        if ( const auto fetchStatus = server.fetchAll( workScheduler, Lane::Sync, options, pages ); !fetchStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "exact multiple; {}" ), fetchStatus.ToString() ) );
+        if ( const auto pagesStatus = verifyStubPages( pages, 9, server ); !pagesStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "exact multiple; {}" ), pagesStatus.ToString() ) );
+        if ( server.m_inFlightPeak.load() < 2 )
+            return absl::InternalError( "exact multiple; page requests never overlapped" );
+    }
+    // .. and the usual short last page
+    {
+        StubPageServer server( cPageSize, 42 );
+        std::vector< Page > pages;
+        if ( const auto fetchStatus = server.fetchAll( workScheduler, Lane::Sync, options, pages ); !fetchStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "short final page; {}" ), fetchStatus.ToString() ) );
+        if ( const auto pagesStatus = verifyStubPages( pages, 9, server ); !pagesStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "short final page; {}" ), pagesStatus.ToString() ) );
+    }
+    // a failed page keeps everything before it and reports unavailable
+    {
+        StubPageServer server( cPageSize, 100, 6 );
+        std::vector< Page > pages;
+        if ( const auto fetchStatus = server.fetchAll( workScheduler, Lane::Sync, options, pages ); !absl::IsUnavailable( fetchStatus ) )
+            return absl::InternalError( fmt::format( FMTX( "failed page; expected unavailable, got {}" ), fetchStatus.ToString() ) );
+        if ( const auto pagesStatus = verifyStubPages( pages, 6, server ); !pagesStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "failed page; {}" ), pagesStatus.ToString() ) );
+    }
+    // a server that never runs dry stops at the page limit, with an error rather than a quietly truncated result
+    {
+        Options limitedOptions = options;
+        limitedOptions.m_pageLimit = 30;
+
+        StubPageServer server( cPageSize, StubPageServer::cEndless );
+        std::vector< Page > pages;
+        if ( const auto fetchStatus = server.fetchAll( workScheduler, Lane::Sync, limitedOptions, pages ); !absl::IsResourceExhausted( fetchStatus ) )
+            return absl::InternalError( fmt::format( FMTX( "page limit; expected resource exhausted, got {}" ), fetchStatus.ToString() ) );
+        if ( const auto pagesStatus = verifyStubPages( pages, limitedOptions.m_pageLimit, server ); !pagesStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "page limit; {}" ), pagesStatus.ToString() ) );
+        if ( server.m_requests.load() > limitedOptions.m_pageLimit )
+            return absl::InternalError( fmt::format( FMTX( "page limit; {} pages requested" ), server.m_requests.load() ) );
+    }
+    // cancelling part-way returns the unbroken run fetched so far
+    {
+        Options cancelOptions = options;
+        cancelOptions.m_pageLimit    = 1000;
+        cancelOptions.m_cancellation = {};     // tokens are shared handles; don't cancel the one (options) holds
+
+        StubPageServer server( cPageSize, StubPageServer::cEndless );
+        std::vector< Page > pages;
+        const auto fetchStatus = server.fetchAll( workScheduler, Lane::Sync, cancelOptions, pages, [&]( const uint32_t pagesFetched )
+            {
+                if ( pagesFetched == 10 )
+                    cancelOptions.m_cancellation.cancel();
+            });
+        if ( !absl::IsCancelled( fetchStatus ) )
+            return absl::InternalError( fmt::format( FMTX( "cancelled; expected cancelled, got {}" ), fetchStatus.ToString() ) );
+        if ( pages.empty() || pages.size() >= cancelOptions.m_pageLimit )
+            return absl::InternalError( fmt::format( FMTX( "cancelled; {} pages returned" ), pages.size() ) );
+        if ( const auto pagesStatus = verifyStubPages( pages, pages.size(), server ); !pagesStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "cancelled; {}" ), pagesStatus.ToString() ) );
+    }
+    // fetching from a job that already holds the only place in the lane; the calling thread has to do every page
+    {
+        struct SaturatedRun
+        {
+            StubPageServer          m_server{ cPageSize, 42 };
+            std::vector< Page >     m_pages;
+            absl::Status            m_status;
+            std::atomic_bool        m_finished = false;
+        };
+        auto run = std::make_shared< SaturatedRun >();
+
+        workScheduler.configureLane( base::WorkScheduler::Lane::Sync, { 0, 1 } );
+        workScheduler.submit( base::WorkScheduler::Lane::Sync, [run, &workScheduler, options]()
+            {
+                run->m_status   = run->m_server.fetchAll( workScheduler, Lane::Sync, options, run->m_pages );
+                run->m_finished = true;
+            });
+
+        if ( !waitUntil( [&]() { return run->m_finished.load(); }, std::chrono::seconds( 10 ) ) )
+            return absl::DeadlineExceededError( "saturated lane; fetch did not finish" );
+        if ( !run->m_status.ok() )
+            return absl::InternalError( fmt::format( FMTX( "saturated lane; {}" ), run->m_status.ToString() ) );
+        if ( const auto pagesStatus = verifyStubPages( run->m_pages, 9, run->m_server ); !pagesStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "saturated lane; {}" ), pagesStatus.ToString() ) );
+    }
+    // the collectibles and shared riff syncs; a Sync job holding the lane's only place pages through Prefetch, so the
+    // page requests still overlap rather than falling back to the calling thread alone
+    {
+        struct NestedRun
+        {
+            StubPageServer          m_server{ cPageSize, 42 };
+            std::vector< Page >     m_pages;
+            absl::Status            m_status;
+            std::atomic_bool        m_finished = false;
+        };
+        auto run = std::make_shared< NestedRun >();
+
+        workScheduler.configureLane( Lane::Sync, { 0, 1 } );
+        workScheduler.configureLane( Lane::Prefetch, { 1, 4 } );
+        workScheduler.submit( Lane::Sync, [run, &workScheduler, options]()
+            {
+                run->m_status   = run->m_server.fetchAll( workScheduler, Lane::Prefetch, options, run->m_pages );
+                run->m_finished = true;
+            });
+
+        if ( !waitUntil( [&]() { return run->m_finished.load(); }, std::chrono::seconds( 10 ) ) )
+            return absl::DeadlineExceededError( "nested in Sync; fetch did not finish" );
+        if ( !run->m_status.ok() )
+            return absl::InternalError( fmt::format( FMTX( "nested in Sync; {}" ), run->m_status.ToString() ) );
+        if ( const auto pagesStatus = verifyStubPages( run->m_pages, 9, run->m_server ); !pagesStatus.ok() )
+            return absl::InternalError( fmt::format( FMTX( "nested in Sync; {}" ), pagesStatus.ToString() ) );
+        if ( run->m_server.m_inFlightPeak.load() < 2 )
+            return absl::InternalError( "nested in Sync; page requests never overlapped" );
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// a tone through an opus lane into both shipped sinks at once; the .opus file is walked page by page for the RFC 7845
+// header layout and granule positions, and the RTP datagrams are caught on a loopback socket to check the RFC 3550 /
+// RFC 7587 header fields of every packet in order
+static absl::Status checkOpusSinks( SelfCheckContext& context )
+{
+    static constexpr uint32_t   cSampleRate         = 48000;
+    static constexpr uint32_t   cFrameSize          = 960;
+    static constexpr uint32_t   cBlocks             = 2;
+    static constexpr uint32_t   cChunkSamples       = 2880;     // fed in pieces, as an audio callback would
+    static constexpr double     cTwoPi              = 2.0 * 3.14159265358979323846;
+    static constexpr uint64_t   cExpectedPackets    = ( ssp::OpusStream::cBlockSize / cFrameSize ) * cBlocks;
+    static constexpr auto       cTimeout            = std::chrono::milliseconds( 5000 );
+
+    // loopback listener on whichever port is free
+    asio::io_context ioContext;
+    asio::ip::udp::socket receiver( ioContext );
+    {
+        asio::error_code ec;
+        receiver.open( asio::ip::udp::v4(), ec );
+        if ( !ec )
+            receiver.bind( asio::ip::udp::endpoint( asio::ip::address_v4::loopback(), 0 ), ec );
+        if ( !ec )
+            receiver.non_blocking( true, ec );
+        if ( ec )
+            return absl::UnavailableError( fmt::format( FMTX( "unable to open RTP listener : {}" ), ec.message() ) );
+
+        // a whole block arrives as one burst; don't let the default buffer drop the tail of it
+        receiver.set_option( asio::socket_base::receive_buffer_size( 1024 * 1024 ), ec );
+    }
+    const uint16_t receiverPort = receiver.local_endpoint().port();
+
+    std::vector< std::vector< uint8_t > > datagrams;
+    const auto drainDatagrams = [&]()
+    {
+        std::array< uint8_t, 2048 > datagram;
+        for ( ;; )
+        {
+            asio::error_code ec;
+            const std::size_t received = receiver.receive( asio::buffer( datagram ), 0, ec );
+            if ( ec )
+                break;
+            datagrams.emplace_back( datagram.begin(), datagram.begin() + received );
+        }
+    };
+
+    const fs::path opusFile = context.m_env.m_workingRoot / "sinks.opus";
+
+    auto streamOrStatus = ssp::OpusStream::Create( cSampleRate );
+    if ( !streamOrStatus.ok() )
+        return streamOrStatus.status();
+    auto stream = *streamOrStatus;
+
+    const auto laneOrStatus = stream->addLane( ssp::OpusStream::LaneSetup{ { 64000, 0 }, ssp::OpusStream::FrameSize::b960 } );
+    if ( !laneOrStatus.ok() )
+        return laneOrStatus.status();
+
+    auto oggSinkOrStatus = ssp::OggOpusFileSink::Create( opusFile );
+    if ( !oggSinkOrStatus.ok() )
+        return oggSinkOrStatus.status();
+    auto rtpSinkOrStatus = ssp::RtpOpusSink::Create( "127.0.0.1", receiverPort );
+    if ( !rtpSinkOrStatus.ok() )
+        return rtpSinkOrStatus.status();
+
+    ssp::OggOpusFileSink::SharedPtr oggSink = *oggSinkOrStatus;
+    ssp::RtpOpusSink::SharedPtr     rtpSink = *rtpSinkOrStatus;
+
+    if ( const auto attachStatus = stream->attachSink( *laneOrStatus, oggSink ); !attachStatus.ok() )
+        return attachStatus;
+    if ( const auto attachStatus = stream->attachSink( *laneOrStatus, rtpSink ); !attachStatus.ok() )
+        return attachStatus;
+
+    // a block is only handed to the encoder once the sample after it arrives, so feed one block at a time and wait
+    // for it to come out the other side before starting the next
+    {
+        std::array< float, cChunkSamples > toneLeft, toneRight;
+        uint64_t samplesFed = 0;
+        for ( uint32_t blockI = 0; blockI < cBlocks; blockI++ )
+        {
+            while ( samplesFed <= (uint64_t)ssp::OpusStream::cBlockSize * ( blockI + 1 ) )
+            {
+                for ( uint32_t sampleI = 0; sampleI < cChunkSamples; sampleI++ )
+                {
+                    const double phase = (double)( samplesFed + sampleI ) * ( 440.0 / (double)cSampleRate );
+                    toneLeft[sampleI]  = 0.25f * (float)std::sin( phase * cTwoPi );
+                    toneRight[sampleI] = 0.25f * (float)std::cos( phase * cTwoPi );
+                }
+                stream->appendSamples( toneLeft.data(), toneRight.data(), cChunkSamples );
+                samplesFed += cChunkSamples;
+            }
+
+            const uint64_t packetsDue = ( cExpectedPackets / cBlocks ) * ( blockI + 1 );
+            if ( !waitUntil( [&]() { drainDatagrams(); return datagrams.size() >= packetsDue; }, cTimeout ) )
+            {
+                return absl::DeadlineExceededError( fmt::format( FMTX( "block {}; {} packets sent, {} send errors, {} datagrams received of {}" ),
+                    blockI, rtpSink->getPacketsSent(), rtpSink->getSendErrors(), datagrams.size(), packetsDue ) );
+            }
+        }
+    }
+
+    // detaching drops the stream's references; releasing ours finishes the file
+    std::ignore = stream->detachSink( *laneOrStatus, oggSink );
+    std::ignore = stream->detachSink( *laneOrStatus, rtpSink );
+    oggSink.reset();
+    drainDatagrams();
+
+    // -- RTP
+    if ( rtpSink->getSendErrors() != 0 )
+        return absl::InternalError( fmt::format( FMTX( "RTP sink reported {} send errors" ), rtpSink->getSendErrors() ) );
+    if ( datagrams.size() != cExpectedPackets || rtpSink->getPacketsSent() != cExpectedPackets )
+        return absl::DataLossError( fmt::format( FMTX( "RTP sent {}, received {}, expected {}" ), rtpSink->getPacketsSent(), datagrams.size(), cExpectedPackets ) );
+
+    const auto readBE16 = []( const uint8_t* data ) { return (uint16_t)( ( data[0] << 8 ) | data[1] ); };
+    const auto readBE32 = []( const uint8_t* data ) { return ( (uint32_t)data[0] << 24 ) | ( (uint32_t)data[1] << 16 ) | ( (uint32_t)data[2] << 8 ) | (uint32_t)data[3]; };
+
+    for ( std::size_t datagramI = 0; datagramI < datagrams.size(); datagramI++ )
+    {
+        const auto& datagram = datagrams[datagramI];
+        if ( datagram.size() <= 12 )
+            return absl::DataLossError( fmt::format( FMTX( "RTP datagram {} carries no payload ({} bytes)" ), datagramI, datagram.size() ) );
+        if ( datagram[0] != 0x80 )
+            return absl::DataLossError( fmt::format( FMTX( "RTP datagram {} has first byte {:#x}, expected version 2 with no padding / extension / CSRCs" ), datagramI, datagram[0] ) );
+        if ( ( datagram[1] & 0x7F ) != ssp::RtpOpusSink::cPayloadType )
+            return absl::DataLossError( fmt::format( FMTX( "RTP datagram {} has payload type {}" ), datagramI, datagram[1] & 0x7F ) );
+
+        const bool marker = ( datagram[1] & 0x80 ) != 0;
+        if ( marker != ( datagramI == 0 ) )
+            return absl::DataLossError( fmt::format( FMTX( "RTP datagram {} has marker {}, expected it on the first datagram only" ), datagramI, marker ) );
+
+        if ( datagramI == 0 )
+            continue;
+
+        const auto& previous = datagrams[datagramI - 1];
+        if ( readBE16( &datagram[2] ) != (uint16_t)( readBE16( &previous[2] ) + 1 ) )
+            return absl::DataLossError( fmt::format( FMTX( "RTP datagram {} has sequence {} after {}" ), datagramI, readBE16( &datagram[2] ), readBE16( &previous[2] ) ) );
+        if ( readBE32( &datagram[4] ) != readBE32( &previous[4] ) + cFrameSize )
+            return absl::DataLossError( fmt::format( FMTX( "RTP datagram {} has timestamp {} after {}" ), datagramI, readBE32( &datagram[4] ), readBE32( &previous[4] ) ) );
+        if ( readBE32( &datagram[8] ) != readBE32( &previous[8] ) )
+            return absl::DataLossError( fmt::format( FMTX( "RTP datagram {} changed SSRC" ), datagramI ) );
+    }
+
+    // -- Ogg
+    std::vector< uint8_t > fileData;
+    {
+        std::ifstream fileInput( opusFile, std::ios::binary );
+        if ( !fileInput.is_open() )
+            return absl::NotFoundError( fmt::format( FMTX( "unable to open [{}]" ), opusFile.string() ) );
+        fileData.assign( std::istreambuf_iterator<char>( fileInput ), std::istreambuf_iterator<char>() );
+    }
+
+    const auto readLE16 = []( const uint8_t* data ) { return (uint16_t)( data[0] | ( data[1] << 8 ) ); };
+    const auto readLE32 = []( const uint8_t* data ) { return (uint32_t)data[0] | ( (uint32_t)data[1] << 8 ) | ( (uint32_t)data[2] << 16 ) | ( (uint32_t)data[3] << 24 ); };
+    const auto readLE64 = [&]( const uint8_t* data ) { return (int64_t)( (uint64_t)readLE32( data ) | ( (uint64_t)readLE32( data + 4 ) << 32 ) ); };
+
+    struct OggPage
+    {
+        uint8_t                 m_flags;
+        int64_t                 m_granule;
+        uint32_t                m_serial;
+        uint32_t                m_sequence;
+        std::vector< uint32_t > m_packetSizes;      // packets that end on this page, including any continued from the last
+        const uint8_t*          m_body;
+        std::size_t             m_bodySize;
+    };
+    std::vector< OggPage > pages;
+    {
+        std::size_t offset = 0;
+        uint32_t    carriedBytes = 0;
+        while ( offset < fileData.size() )
+        {
+            if ( fileData.size() - offset < 27 || std::memcmp( &fileData[offset], "OggS", 4 ) != 0 || fileData[offset + 4] != 0 )
+                return absl::DataLossError( fmt::format( FMTX( "no Ogg page header at byte {}" ), offset ) );
+
+            const uint8_t* header = &fileData[offset];
+            const std::size_t segmentCount = header[26];
+            if ( fileData.size() - offset < 27 + segmentCount )
+                return absl::DataLossError( fmt::format( FMTX( "Ogg page at byte {} has a truncated lacing table" ), offset ) );
+
+            OggPage page;
+            page.m_flags    = header[5];
+            page.m_granule  = readLE64( header + 6 );
+            page.m_serial   = readLE32( header + 14 );
+            page.m_sequence = readLE32( header + 18 );
+
+            std::size_t bodySize = 0;
+            for ( std::size_t segmentI = 0; segmentI < segmentCount; segmentI++ )
+            {
+                const uint8_t lacing = header[27 + segmentI];
+                bodySize     += lacing;
+                carriedBytes += lacing;
+                if ( lacing < 255 )
+                {
+                    page.m_packetSizes.push_back( carriedBytes );
+                    carriedBytes = 0;
+                }
+            }
+            if ( fileData.size() - offset - 27 - segmentCount < bodySize )
+                return absl::DataLossError( fmt::format( FMTX( "Ogg page at byte {} has a truncated body" ), offset ) );
+
+            page.m_body     = header + 27 + segmentCount;
+            page.m_bodySize = bodySize;
+            pages.emplace_back( std::move( page ) );
+
+            offset += 27 + segmentCount + bodySize;
+        }
+    }
+
+    static constexpr uint8_t cOggBeginOfStream  = 0x02;
+    static constexpr uint8_t cOggEndOfStream    = 0x04;
+
+    if ( pages.size() < 3 )
+        return absl::DataLossError( fmt::format( FMTX( "Ogg file holds {} pages, expected headers and audio" ), pages.size() ) );
+
+    const OggPage& headPage = pages[0];
+    if ( headPage.m_flags != cOggBeginOfStream || headPage.m_granule != 0 )
+        return absl::DataLossError( fmt::format( FMTX( "OpusHead page has flags {:#x} granule {}, expected BOS only and 0" ), headPage.m_flags, headPage.m_granule ) );
+    if ( headPage.m_packetSizes.size() != 1 || headPage.m_bodySize != 19 || std::memcmp( headPage.m_body, "OpusHead", 8 ) != 0 )
+        return absl::DataLossError( "first page does not hold a lone 19 byte OpusHead" );
+    if ( headPage.m_body[8] != 1 || headPage.m_body[9] != 2 )
+        return absl::DataLossError( fmt::format( FMTX( "OpusHead version {} channels {}, expected 1 and 2" ), headPage.m_body[8], headPage.m_body[9] ) );
+    if ( readLE32( headPage.m_body + 12 ) != cSampleRate )
+        return absl::DataLossError( fmt::format( FMTX( "OpusHead input rate {}, expected {}" ), readLE32( headPage.m_body + 12 ), cSampleRate ) );
+
+    const int64_t preSkip = readLE16( headPage.m_body + 10 );
+
+    const OggPage& tagsPage = pages[1];
+    if ( tagsPage.m_flags != 0 || tagsPage.m_granule != 0 )
+        return absl::DataLossError( fmt::format( FMTX( "OpusTags page has flags {:#x} granule {}, expected 0 and 0" ), tagsPage.m_flags, tagsPage.m_granule ) );
+    if ( tagsPage.m_packetSizes.size() != 1 || tagsPage.m_bodySize < 16 || std::memcmp( tagsPage.m_body, "OpusTags", 8 ) != 0 )
+        return absl::DataLossError( "second page does not hold a lone OpusTags" );
+
+    uint64_t audioPackets  = 0;
+    int64_t  lastGranule   = 0;
+    for ( std::size_t pageI = 0; pageI < pages.size(); pageI++ )
+    {
+        const OggPage& page = pages[pageI];
+        if ( page.m_serial != headPage.m_serial || page.m_sequence != pageI )
+            return absl::DataLossError( fmt::format( FMTX( "Ogg page {} has serial {:#x} sequence {}" ), pageI, page.m_serial, page.m_sequence ) );
+        if ( pageI < 2 )
+            continue;
+
+        const bool lastPage = ( pageI == pages.size() - 1 );
+        if ( ( page.m_flags & cOggBeginOfStream ) != 0 || ( ( page.m_flags & cOggEndOfStream ) != 0 ) != lastPage )
+            return absl::DataLossError( fmt::format( FMTX( "Ogg page {} of {} has flags {:#x}" ), pageI, pages.size(), page.m_flags ) );
+
+        audioPackets += page.m_packetSizes.size();
+
+        // a page that finishes no packet carries -1
+        if ( page.m_packetSizes.empty() )
+            continue;
+
+        const int64_t expectedGranule = preSkip + (int64_t)( audioPackets * cFrameSize );
+        if ( page.m_granule != expectedGranule || page.m_granule <= lastGranule )
+            return absl::DataLossError( fmt::format( FMTX( "Ogg page {} has granule {}, expected {} after {}" ), pageI, page.m_granule, expectedGranule, lastGranule ) );
+        lastGranule = page.m_granule;
+    }
+
+    if ( audioPackets != cExpectedPackets )
+        return absl::DataLossError( fmt::format( FMTX( "Ogg file holds {} audio packets, expected {}" ), audioPackets, cExpectedPackets ) );
+    if ( lastGranule != preSkip + (int64_t)( cExpectedPackets * cFrameSize ) )
+        return absl::DataLossError( fmt::format( FMTX( "final granule {}, expected {}" ), lastGranule, preSkip + (int64_t)( cExpectedPackets * cFrameSize ) ) );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// decoded stems can run past +/-1.0; put a loud passage peaking well over full scale and a quiet one through both
+// compact storage kernels and expect every sample back to within half a quantisation step of the format it landed in
+static absl::Status checkCompactStorageRange( SelfCheckContext& context )
+{
+    static constexpr int32_t    cSampleCount    = 48000;
+    static constexpr float      cLoudPeak       = 2.5f;
+    static constexpr float      cQuietPeak      = 0.05f;
+    static constexpr float      cStepSlack      = 1.001f;   // room for float rounding on top of the half step
+
+    math::RNG32 rng( cSelfCheckSeed ^ 0xC0DE );
+
+    std::vector< float > input( cSampleCount );
+    for ( int32_t i = 0; i < cSampleCount; i++ )
+        input[i] = rng.genFloat( -1.0f, 1.0f ) * ( ( i < cSampleCount / 2 ) ? cLoudPeak : cQuietPeak );
+    input[0] = cLoudPeak;
+
+    std::vector< float > decoded( cSampleCount );
+
+    // int16, against a full scale wide enough for the loudest sample
+    {
+        if ( buffer::int16_full_scale_for( cQuietPeak ) != 1.0f )
+            return absl::InternalError( "in-range audio was given a full scale other than 1.0" );
+
+        const float fullScale = buffer::int16_full_scale_for( buffer::peak_magnitude( cSampleCount, input.data() ) );
+        if ( fullScale != cLoudPeak )
+            return absl::InternalError( fmt::format( FMTX( "int16 full scale {}, expected {}" ), fullScale, cLoudPeak ) );
+
+        std::vector< int16_t > pcm( cSampleCount );
+        buffer::quantise_float_to_int16( cSampleCount, input.data(), fullScale, pcm.data() );
+        buffer::expand_int16_to_float( 0, cSampleCount, pcm.data(), fullScale, decoded.data() );
+
+        const float errorLimit = fullScale * buffer::int16_to_float_scale * 0.5f * cStepSlack;
+        for ( int32_t i = 0; i < cSampleCount; i++ )
+        {
+            if ( std::abs( decoded[i] - input[i] ) > errorLimit )
+                return absl::DataLossError( fmt::format( FMTX( "int16 sample {} decoded as {}, stored {}" ), i, decoded[i], input[i] ) );
+        }
+    }
+
+    // bfp8, which scales each block to its own peak; read back from an unaligned start as well to cover the span walk
+    {
+        std::vector< int8_t > mantissa( cSampleCount );
+        std::vector< float >  blockScale( buffer::bfp8_block_count( cSampleCount ) );
+        buffer::quantise_float_to_bfp8( cSampleCount, input.data(), mantissa.data(), blockScale.data() );
+        buffer::expand_bfp8_to_float( 0, cSampleCount, mantissa.data(), blockScale.data(), decoded.data() );
+
+        for ( int32_t i = 0; i < cSampleCount; i++ )
+        {
+            const float errorLimit = blockScale[i >> buffer::bfp8_block_shift] * 0.5f * cStepSlack;
+            if ( std::abs( decoded[i] - input[i] ) > errorLimit )
+                return absl::DataLossError( fmt::format( FMTX( "bfp8 sample {} decoded as {}, stored {}" ), i, decoded[i], input[i] ) );
+        }
+
+        static constexpr int32_t cUnalignedStart = buffer::bfp8_block_size + 7;
+
+        std::vector< float > decodedSpan( cSampleCount - cUnalignedStart );
+        buffer::expand_bfp8_to_float( cUnalignedStart, (int32_t)decodedSpan.size(), mantissa.data(), blockScale.data(), decodedSpan.data() );
+
+        if ( !std::equal( decodedSpan.begin(), decodedSpan.end(), decoded.begin() + cUnalignedStart ) )
+            return absl::DataLossError( "bfp8 span read from an unaligned start differs from the full decode" );
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int runSelfCheck( Environment& environment )
+{
+    using CheckFn = absl::Status (*)( SelfCheckContext& );
+
+    static constexpr std::array< std::pair< const char*, CheckFn >, 10 > cChecks{ {
+        { "jam_archive_round_trip",         checkJamArchiveRoundTrip },
+        { "jam_export_import_round_trip",   checkJamExportImportRoundTrip },
+        { "projection_stem_user_change",    checkRiffProjectionStemUserChange },
+        { "seeded_riff_sampling",           checkSeededRiffSampling },
+        { "riff_push_loopback",             checkRiffPushLoopback },
+        { "memory_tag_accounting",          checkMemoryTagAccounting },
+        { "streaming_json_decode",          checkStreamingJsonDecode },
+        { "paged_fetch",                    checkPagedFetch },
+        { "opus_sinks",                     checkOpusSinks },
+        { "compact_storage_range",          checkCompactStorageRange },
+    } };
+
+    blog::core( FMTX( "OUROVEON self check | seed {:#x}" ), cSelfCheckSeed );
+
+    if ( const auto envStatus = environment.initialise( "selfcheck" ); !envStatus.ok() )
+    {
+        blog::error::core( FMTX( "unable to prepare environment; {}" ), envStatus.ToString() );
+        return 1;
+    }
+
+    std::size_t failures = 0;
+    {
+        SelfCheckContext context( environment );
+
+        for ( const auto& [ checkName, checkFn ] : cChecks )
+        {
+            const auto checkStatus = checkFn( context );
+            environment.m_taskExecutor.wait_for_all();
+
+            if ( checkStatus.ok() )
+            {
+                blog::core( FMTX( "  [ OK       ] {}" ), checkName );
+            }
+            else
+            {
+                blog::error::core( FMTX( "  [ FAILED   ] {} | {}" ), checkName, checkStatus.ToString() );
+                failures++;
+            }
+        }
+    }
+
+    if ( failures > 0 )
+    {
+        blog::error::core( FMTX( "self check failed; {} check(s) failed" ), failures );
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
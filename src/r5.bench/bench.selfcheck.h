@@ -0,0 +1,20 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  correctness checks for the data-side systems that have no audio to compare against golden files; each check builds
+//  its inputs from fixed seeds, exercises one system headlessly and reports pass or fail, like the mix check does
+//
+
+#pragma once
+
+namespace bench {
+
+struct Environment;
+
+// returns a process exit code; 0 if every check passed
+int runSelfCheck( Environment& environment );
+
+} // namespace bench
@@ -1965,7 +1965,14 @@ protected:
     {
         if ( static_cast<TagExtraTools>(id) == SendViaBOND )
         {
-            m_rpClient.pushRiff( currentRiffPtr->m_riffData, m_riffPlaybackAbstraction.asPermutation() );
+            const auto pushStatus = m_rpClient.pushRiff( currentRiffPtr->m_riffData, m_riffPlaybackAbstraction.asPermutation() );
+            if ( !pushStatus.ok() )
+            {
+                m_appEventBus->send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
+                    ICON_FA_CIRCLE_NODES " Riff Push Failed",
+                    pushStatus.ToString() );
+                return;
+            }
 
             m_appEventBus->send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Info,
                 ICON_FA_CIRCLE_NODES " Riff Pushed To Server",
@@ -2099,6 +2106,7 @@ int LoreApp::EntrypointOuro()
         m_mdAudio->getSampleRate(),
         m_mdAudio->getOutputLatencyMs(),
         m_appEventBusClient.value() );
+    mixPreview.setFLACEncoderOptions( getFLACEncoderOptions() );
     m_mdAudio->blockUntil( m_mdAudio->installMixer( &mixPreview ) );
 
     // LINK controls for the mixer
@@ -2149,6 +2157,8 @@ int LoreApp::EntrypointOuro()
     m_riffPipeline = std::make_unique< endlesss::toolkit::Pipeline >(
         m_appEventBus,
         riffFetchProvider,
+        m_workScheduler,
+        base::WorkScheduler::Lane::Interactive,
         m_configPerf.liveRiffInstancePoolSize,
         [this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result) -> bool
         {
@@ -2197,6 +2207,8 @@ int LoreApp::EntrypointOuro()
     m_riffExportPipeline = std::make_unique< endlesss::toolkit::Pipeline >(
         m_appEventBus,
         riffFetchProvider,
+        m_workScheduler,
+        base::WorkScheduler::Lane::Export,
         0, // no internal cache - we don't want riffs saved as we can modify jam/riff descriptions during batch exports which would then be ignored
         [this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result ) -> bool
         {
@@ -3736,7 +3748,7 @@ int LoreApp::EntrypointOuro()
                                 fileDialog->OpenDialog(
                                     "ImpFileDlg",
                                     "Choose exported LORE metadata",
-                                    ".yaml",
+                                    "Jam metadata{.orxj,.yaml}",
                                     cWarehouseImportPath.string().c_str(),
                                     1,
                                     nullptr,
@@ -4125,7 +4137,7 @@ int LoreApp::EntrypointOuro()
                                             &riffFetchProvider,
                                             state = ux::createJamPrecacheState( iterCurrentJamID )](const char* title)
                                         {
-                                            ux::modalJamPrecache( title, *state, *m_warehouse, riffFetchProvider, getTaskExecutor() );
+                                            ux::modalJamPrecache( title, *state, *m_warehouse, riffFetchProvider, getWorkScheduler() );
                                         });
                                 }
                                 ImGui::CompactTooltip( "Open a utility that allows you to download all stems for this jam,\nallowing for fully offline browsing and archival" );
@@ -4163,7 +4175,7 @@ int LoreApp::EntrypointOuro()
                                         bExportData = true;
                                         bExportStems = true;
                                     }
-                                    ImGui::CompactTooltip( "Begin the process to bundle up both the data and all stems from this jam into a paired .tar archive + .yaml" );
+                                    ImGui::CompactTooltip( "Begin the process to bundle up both the data and all stems from this jam into a paired .tar archive + .orxj" );
                                 }
 
                                 if ( bExportData )
@@ -4198,8 +4210,8 @@ int LoreApp::EntrypointOuro()
                                         const auto exportOperationID = base::Operations::newID( endlesss::toolkit::Warehouse::OV_ExportAction );
                                         addOperationToJam( iterCurrentJamID, exportOperationID );
 
-                                        // spin up a background task to archive the stems into a .tar archive
-                                        getTaskExecutor().silent_async( [this, inputPath, outputPath, exportFile = std::move( exportFilenameTar ), exportOperationID]()
+                                        // queue a background task to archive the stems into a .tar archive
+                                        m_workScheduler.submit( base::WorkScheduler::Lane::Export, [this, inputPath, outputPath, exportFile = std::move( exportFilenameTar ), exportOperationID]()
                                             {
                                                 base::EventBusClient m_eventBusClient( m_appEventBus );
                                                 OperationCompleteOnScopeExit( exportOperationID );
@@ -0,0 +1,376 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  OUROGAIN - a deliberately trivial stereo gain + one-pole lowpass CLAP effect, built from the tree so the CLAP
+//  host, effect chains and parameter automation can be tested without any third party plugins installed. uses only
+//  the CLAP C API; no sdk code is linked in
+//
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "clap/clap.h"
+
+namespace ourogain {
+
+// ---------------------------------------------------------------------------------------------------------------------
+enum ParamID : clap_id
+{
+    Gain    = 0,
+    Cutoff  = 1,
+
+    Count
+};
+
+static constexpr double cGainMinDb      = -60.0;
+static constexpr double cGainMaxDb      =  12.0;
+static constexpr double cCutoffMinHz    =  20.0;
+static constexpr double cCutoffMaxHz    =  20000.0;
+
+// per-block smoothing factor for gain changes, enough to stop zipper noise from automation
+static constexpr float  cGainSmoothing  = 0.005f;
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct Plugin
+{
+    clap_plugin                 m_plugin;
+    const clap_host*            m_host          = nullptr;
+
+    double                      m_sampleRate    = 44100.0;
+
+    // written from the audio thread (events) or main thread (flush while inactive), read from either
+    std::atomic< double >       m_paramValues[ParamID::Count];
+
+    float                       m_gainCurrent   = 1.0f;
+    float                       m_filterState[2] = { 0, 0 };
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+static Plugin* fromClap( const clap_plugin* plugin )
+{
+    return static_cast< Plugin* >( plugin->plugin_data );
+}
+
+static float decibelsToLinear( const double db )
+{
+    return static_cast< float >( std::pow( 10.0, db / 20.0 ) );
+}
+
+static float cutoffToCoefficient( const double cutoffHz, const double sampleRate )
+{
+    return static_cast< float >( 1.0 - std::exp( -2.0 * 3.14159265358979323846 * cutoffHz / sampleRate ) );
+}
+
+static void applyParamEvent( Plugin* self, const clap_event_header* header )
+{
+    if ( header->space_id != CLAP_CORE_EVENT_SPACE_ID ||
+         header->type != CLAP_EVENT_PARAM_VALUE )
+        return;
+
+    const auto* paramEvent = reinterpret_cast< const clap_event_param_value* >( header );
+    if ( paramEvent->param_id < ParamID::Count )
+        self->m_paramValues[paramEvent->param_id] = paramEvent->value;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+namespace audio_ports {
+
+static uint32_t count( const clap_plugin* plugin, bool isInput ) noexcept
+{
+    return 1;
+}
+
+static bool get( const clap_plugin* plugin, uint32_t index, bool isInput, clap_audio_port_info* info ) noexcept
+{
+    if ( index != 0 )
+        return false;
+
+    info->id            = 0;
+    info->channel_count = 2;
+    info->flags         = CLAP_AUDIO_PORT_IS_MAIN;
+    info->port_type     = CLAP_PORT_STEREO;
+    info->in_place_pair = CLAP_INVALID_ID;
+    std::snprintf( info->name, sizeof( info->name ), "%s", isInput ? "Input" : "Output" );
+    return true;
+}
+
+static const clap_plugin_audio_ports extension = { count, get };
+
+} // namespace audio_ports
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+namespace params {
+
+static uint32_t count( const clap_plugin* plugin ) noexcept
+{
+    return ParamID::Count;
+}
+
+static bool get_info( const clap_plugin* plugin, uint32_t paramIndex, clap_param_info* info ) noexcept
+{
+    std::memset( info, 0, sizeof( clap_param_info ) );
+    info->flags = CLAP_PARAM_IS_AUTOMATABLE;
+
+    switch ( paramIndex )
+    {
+        case ParamID::Gain:
+            info->id            = ParamID::Gain;
+            info->min_value     = cGainMinDb;
+            info->max_value     = cGainMaxDb;
+            info->default_value = 0.0;
+            std::snprintf( info->name, sizeof( info->name ), "Gain" );
+            return true;
+
+        case ParamID::Cutoff:
+            info->id            = ParamID::Cutoff;
+            info->min_value     = cCutoffMinHz;
+            info->max_value     = cCutoffMaxHz;
+            info->default_value = cCutoffMaxHz;
+            std::snprintf( info->name, sizeof( info->name ), "Cutoff" );
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+static bool get_value( const clap_plugin* plugin, clap_id paramID, double* outValue ) noexcept
+{
+    if ( paramID >= ParamID::Count )
+        return false;
+
+    *outValue = fromClap( plugin )->m_paramValues[paramID];
+    return true;
+}
+
+static bool value_to_text( const clap_plugin* plugin, clap_id paramID, double value, char* outBuffer, uint32_t outBufferCapacity ) noexcept
+{
+    switch ( paramID )
+    {
+        case ParamID::Gain:     std::snprintf( outBuffer, outBufferCapacity, "%.1f dB", value ); return true;
+        case ParamID::Cutoff:   std::snprintf( outBuffer, outBufferCapacity, "%.0f Hz", value ); return true;
+        default:
+            return false;
+    }
+}
+
+static bool text_to_value( const clap_plugin* plugin, clap_id paramID, const char* paramValueText, double* outValue ) noexcept
+{
+    if ( paramID >= ParamID::Count )
+        return false;
+
+    char* parseEnd = nullptr;
+    *outValue = std::strtod( paramValueText, &parseEnd );
+    return parseEnd != paramValueText;
+}
+
+static void flush( const clap_plugin* plugin, const clap_input_events* in, const clap_output_events* out ) noexcept
+{
+    Plugin* self = fromClap( plugin );
+
+    const uint32_t eventCount = in->size( in );
+    for ( uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++ )
+        applyParamEvent( self, in->get( in, eventIndex ) );
+}
+
+static const clap_plugin_params extension = { count, get_info, get_value, value_to_text, text_to_value, flush };
+
+} // namespace params
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+namespace plugin {
+
+static bool init( const clap_plugin* plugin ) noexcept
+{
+    Plugin* self = fromClap( plugin );
+    self->m_paramValues[ParamID::Gain]   = 0.0;
+    self->m_paramValues[ParamID::Cutoff] = cCutoffMaxHz;
+    return true;
+}
+
+static void destroy( const clap_plugin* plugin ) noexcept
+{
+    delete fromClap( plugin );
+}
+
+static bool activate( const clap_plugin* plugin, double sampleRate, uint32_t minFramesCount, uint32_t maxFramesCount ) noexcept
+{
+    Plugin* self = fromClap( plugin );
+    self->m_sampleRate  = sampleRate;
+    self->m_gainCurrent = decibelsToLinear( self->m_paramValues[ParamID::Gain] );
+    return true;
+}
+
+static void deactivate( const clap_plugin* plugin ) noexcept
+{
+}
+
+static bool start_processing( const clap_plugin* plugin ) noexcept
+{
+    return true;
+}
+
+static void stop_processing( const clap_plugin* plugin ) noexcept
+{
+}
+
+static void reset( const clap_plugin* plugin ) noexcept
+{
+    Plugin* self = fromClap( plugin );
+    self->m_filterState[0] = 0;
+    self->m_filterState[1] = 0;
+}
+
+static clap_process_status process( const clap_plugin* plugin, const clap_process* process ) noexcept
+{
+    Plugin* self = fromClap( plugin );
+
+    if ( process->audio_inputs_count < 1 || process->audio_outputs_count < 1 )
+        return CLAP_PROCESS_ERROR;
+
+    const clap_audio_buffer& input  = process->audio_inputs[0];
+    const clap_audio_buffer& output = process->audio_outputs[0];
+    if ( input.data32 == nullptr || output.data32 == nullptr || input.channel_count < 2 || output.channel_count < 2 )
+        return CLAP_PROCESS_ERROR;
+
+    // parameter changes are applied at block granularity; the gain smoothing covers the step
+    const uint32_t eventCount = process->in_events->size( process->in_events );
+    for ( uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++ )
+        applyParamEvent( self, process->in_events->get( process->in_events, eventIndex ) );
+
+    const float gainTarget   = decibelsToLinear( self->m_paramValues[ParamID::Gain] );
+    const float filterCoeff  = cutoffToCoefficient( self->m_paramValues[ParamID::Cutoff], self->m_sampleRate );
+    const bool  filterActive = self->m_paramValues[ParamID::Cutoff] < cCutoffMaxHz;
+
+    float gain = self->m_gainCurrent;
+    for ( uint32_t frame = 0; frame < process->frames_count; frame++ )
+    {
+        gain += ( gainTarget - gain ) * cGainSmoothing;
+
+        for ( uint32_t channel = 0; channel < 2; channel++ )
+        {
+            float sample = input.data32[channel][frame];
+            if ( filterActive )
+            {
+                self->m_filterState[channel] += ( sample - self->m_filterState[channel] ) * filterCoeff;
+                sample = self->m_filterState[channel];
+            }
+            output.data32[channel][frame] = sample * gain;
+        }
+    }
+    self->m_gainCurrent = gain;
+
+    return CLAP_PROCESS_CONTINUE;
+}
+
+static const void* get_extension( const clap_plugin* plugin, const char* id ) noexcept
+{
+    if ( std::strcmp( id, CLAP_EXT_AUDIO_PORTS ) == 0 )
+        return &audio_ports::extension;
+    if ( std::strcmp( id, CLAP_EXT_PARAMS ) == 0 )
+        return &params::extension;
+    return nullptr;
+}
+
+static void on_main_thread( const clap_plugin* plugin ) noexcept
+{
+}
+
+} // namespace plugin
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+static const char* const cFeatures[] = { CLAP_PLUGIN_FEATURE_AUDIO_EFFECT, CLAP_PLUGIN_FEATURE_STEREO, nullptr };
+
+static const clap_plugin_descriptor cDescriptor =
+{
+    CLAP_VERSION_INIT,
+    "org.ishani.ouroveon.ourogain",
+    "OUROGAIN",
+    "ishani",
+    "https://ishani.org/shelf/ouroveon/",
+    "",
+    "",
+    "1.0.0",
+    "stereo gain with a one-pole lowpass, for testing the OUROVEON CLAP host",
+    cFeatures
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+namespace factory {
+
+static uint32_t get_plugin_count( const clap_plugin_factory* factory ) noexcept
+{
+    return 1;
+}
+
+static const clap_plugin_descriptor* get_plugin_descriptor( const clap_plugin_factory* factory, uint32_t index ) noexcept
+{
+    return ( index == 0 ) ? &cDescriptor : nullptr;
+}
+
+static const clap_plugin* create_plugin( const clap_plugin_factory* factory, const clap_host* host, const char* pluginID ) noexcept
+{
+    if ( !clap_version_is_compatible( host->clap_version ) ||
+         std::strcmp( pluginID, cDescriptor.id ) != 0 )
+        return nullptr;
+
+    Plugin* self = new Plugin();
+    self->m_host = host;
+
+    self->m_plugin.desc             = &cDescriptor;
+    self->m_plugin.plugin_data      = self;
+    self->m_plugin.init             = plugin::init;
+    self->m_plugin.destroy          = plugin::destroy;
+    self->m_plugin.activate         = plugin::activate;
+    self->m_plugin.deactivate       = plugin::deactivate;
+    self->m_plugin.start_processing = plugin::start_processing;
+    self->m_plugin.stop_processing  = plugin::stop_processing;
+    self->m_plugin.reset            = plugin::reset;
+    self->m_plugin.process          = plugin::process;
+    self->m_plugin.get_extension    = plugin::get_extension;
+    self->m_plugin.on_main_thread   = plugin::on_main_thread;
+
+    return &self->m_plugin;
+}
+
+static const clap_plugin_factory instance = { get_plugin_count, get_plugin_descriptor, create_plugin };
+
+} // namespace factory
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool entryInit( const char* pluginPath ) noexcept
+{
+    return true;
+}
+
+static void entryDeinit() noexcept
+{
+}
+
+static const void* entryGetFactory( const char* factoryID ) noexcept
+{
+    if ( std::strcmp( factoryID, CLAP_PLUGIN_FACTORY_ID ) == 0 )
+        return &factory::instance;
+    return nullptr;
+}
+
+} // namespace ourogain
+
+extern "C" CLAP_EXPORT const clap_plugin_entry clap_entry =
+{
+    CLAP_VERSION_INIT,
+    ourogain::entryInit,
+    ourogain::entryDeinit,
+    ourogain::entryGetFactory,
+};